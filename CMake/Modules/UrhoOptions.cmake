@@ -135,13 +135,14 @@ _option(URHO3D_CONTAINER_ADAPTERS "Enable EASTL-to-Urho container adapters for e
 
 if (WIN32)
     set(URHO3D_GRAPHICS_API D3D11 CACHE STRING "Graphics API")
-    set_property(CACHE URHO3D_GRAPHICS_API PROPERTY STRINGS D3D9 D3D11 OpenGL)
+    set_property(CACHE URHO3D_GRAPHICS_API PROPERTY STRINGS D3D9 D3D11 OpenGL Null)
     _option(URHO3D_WIN32_CONSOLE "Show log messages in win32 console"                     OFF)
 elseif (IOS OR ANDROID)
     set(URHO3D_GRAPHICS_API GLES2 CACHE STRING "Graphics API")
     set_property(CACHE URHO3D_GRAPHICS_API PROPERTY STRINGS GLES2 GLES3)
 else ()
-    set(URHO3D_GRAPHICS_API OpenGL)
+    set(URHO3D_GRAPHICS_API OpenGL CACHE STRING "Graphics API")
+    set_property(CACHE URHO3D_GRAPHICS_API PROPERTY STRINGS OpenGL Null)
 endif ()
 string(TOUPPER "${URHO3D_GRAPHICS_API}" URHO3D_GRAPHICS_API)
 set (URHO3D_${URHO3D_GRAPHICS_API} ON)
@@ -165,6 +166,10 @@ elseif (URHO3D_TOOLS)
     set (URHO3D_LOGGING ON)
     set (URHO3D_HASH_DEBUG ON)
 endif ()
+if (URHO3D_NULL)
+    # Null graphics backend has no window or device for the debug UI
+    set (URHO3D_SYSTEMUI OFF)
+endif ()
 
 if (WEB OR MOBILE)
     if (URHO3D_CSHARP)
@@ -0,0 +1,399 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/AnimatedModel.h>
+#include <Urho3D/Graphics/Animation.h>
+#include <Urho3D/Graphics/AnimationState.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <BenchmarkApplication.h>
+
+namespace Urho3D
+{
+
+/// Animation length in seconds.
+static const float ANIMATION_LENGTH = 10.0f;
+/// Time step of one frame.
+static const float TIME_STEP = 1.0f / 60.0f;
+/// Number of characters skinned by one work item.
+static const unsigned SKINNING_BATCH_SIZE = 16;
+
+/// Poses of all characters and the time taken to sample them.
+struct SampledPoses
+{
+    /// Bone positions of all characters.
+    ea::vector<Vector3> positions_;
+    /// Bone rotations of all characters.
+    ea::vector<Quaternion> rotations_;
+    /// Bone scales of all characters.
+    ea::vector<Vector3> scales_;
+    /// Sampling time in microseconds.
+    long long time_{};
+};
+
+/// Keyframe lookup as it was before the binary search: walk linearly from the previous index.
+static void GetKeyFrameIndexLinear(const AnimationTrack& track, float time, unsigned& index)
+{
+    if (time < 0.0f)
+        time = 0.0f;
+
+    if (index >= track.keyFrames_.size())
+        index = track.keyFrames_.size() - 1;
+
+    while (index && time < track.keyFrames_[index].time_)
+        --index;
+
+    while (index < track.keyFrames_.size() - 1 && time >= track.keyFrames_[index + 1].time_)
+        ++index;
+}
+
+/// Samples a procedural many-bone animation on many characters, both in sequential playback and when seeking, with the per-track
+/// keyframe layout and with the keyframe arrays, then animates and skins all of them per frame with increasing numbers of threads,
+/// and prints the throughput.
+class AnimationBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(AnimationBenchmark, BenchmarkApplication);
+public:
+    explicit AnimationBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--characters", numCharacters_, "Number of animated characters.");
+        cmd.add_option("--bones", numBones_, "Number of bones in the skeleton.");
+        cmd.add_option("--keyframes", numKeyFrames_, "Number of keyframes per track.");
+        cmd.add_option("--frames", numFrames_, "Number of measured frames.");
+    }
+
+    void RunBenchmark() override
+    {
+        numBones_ = Max(numBones_, 1U);
+        numKeyFrames_ = Max(numKeyFrames_, 2U);
+        numFrames_ = Max(numFrames_, 1U);
+        CreateResources();
+        CreateScene();
+
+        PrintLine(Format("Animation benchmark: {} characters, {} bones, {} keyframes per track, {} frames", numCharacters_,
+            numBones_, numKeyFrames_, numFrames_));
+        RunKeyFrameLookup();
+        RunSampling();
+        CheckTrackArraysRebuild();
+        RunSkinning();
+    }
+
+private:
+    void CreateResources()
+    {
+        // Skeleton is a chain of bones branching every few bones, like limbs and fingers
+        Skeleton skeleton;
+        ea::vector<Bone>& bones = skeleton.GetModifiableBones();
+        bones.resize(numBones_);
+        for (unsigned i = 0; i < numBones_; ++i)
+        {
+            Bone& bone = bones[i];
+            bone.name_ = Format("Bone{}", i);
+            bone.nameHash_ = bone.name_;
+            bone.parentIndex_ = i ? (i % 4 ? i - 1 : i / 2) : 0;
+            bone.initialPosition_ = Vector3(0.0f, 0.1f, 0.0f);
+        }
+        skeleton.SetRootBoneIndex(0);
+
+        model_ = new Model(context_);
+        model_->SetSkeleton(skeleton);
+
+        // Every track has all channels, keyframes at uniform intervals
+        SetRandomSeed(1);
+        animation_ = new Animation(context_);
+        animation_->SetLength(ANIMATION_LENGTH);
+        for (unsigned i = 0; i < numBones_; ++i)
+        {
+            AnimationTrack* track = animation_->CreateTrack(bones[i].name_);
+            track->channelMask_ = CHANNEL_POSITION | CHANNEL_ROTATION | CHANNEL_SCALE;
+            for (unsigned j = 0; j < numKeyFrames_; ++j)
+            {
+                AnimationKeyFrame keyFrame;
+                keyFrame.time_ = ANIMATION_LENGTH * j / numKeyFrames_;
+                keyFrame.position_ = Vector3(Random(-0.1f, 0.1f), Random(0.0f, 0.2f), Random(-0.1f, 0.1f));
+                keyFrame.rotation_ = Quaternion(Random(-45.0f, 45.0f), Random(-45.0f, 45.0f), Random(-45.0f, 45.0f));
+                keyFrame.scale_ = Vector3::ONE * Random(0.9f, 1.1f);
+                track->AddKeyFrame(keyFrame);
+            }
+        }
+    }
+
+    void CreateScene()
+    {
+        scene_ = new Scene(context_);
+        octree_ = scene_->CreateComponent<Octree>();
+        for (unsigned i = 0; i < numCharacters_; ++i)
+        {
+            Node* node = scene_->CreateChild("Character");
+            auto* model = node->CreateComponent<AnimatedModel>();
+            model->SetModel(model_);
+            AnimationState* state = model->AddAnimationState(animation_);
+            state->SetWeight(1.0f);
+            state->SetLooped(true);
+            state->SetTime(Random(ANIMATION_LENGTH));
+            models_.push_back(model);
+            states_.push_back(state);
+        }
+    }
+
+    void RunKeyFrameLookup()
+    {
+        const ea::vector<AnimationTrack*> tracks = GetTracks();
+        ea::vector<unsigned> linearIndices(tracks.size());
+        ea::vector<unsigned> searchIndices(tracks.size());
+        ea::vector<float> times(numCharacters_);
+        for (float& time : times)
+            time = Random(ANIMATION_LENGTH);
+
+        PrintLine("Keyframe lookup   | Linear walk M lookups/s | Hinted binary search M lookups/s");
+        for (bool seeking : {false, true})
+        {
+            long long linearTime = 0;
+            long long searchTime = 0;
+            HiresTimer timer;
+            for (unsigned frame = 0; frame < numFrames_; ++frame)
+            {
+                AdvanceTimes(times, seeking);
+
+                timer.Reset();
+                for (float time : times)
+                {
+                    for (unsigned i = 0; i < tracks.size(); ++i)
+                        GetKeyFrameIndexLinear(*tracks[i], time, linearIndices[i]);
+                }
+                linearTime += timer.GetUSec(true);
+
+                for (float time : times)
+                {
+                    for (unsigned i = 0; i < tracks.size(); ++i)
+                        tracks[i]->GetKeyFrameIndex(time, searchIndices[i]);
+                }
+                searchTime += timer.GetUSec(false);
+
+                if (linearIndices != searchIndices)
+                    ErrorExit("Keyframe lookups differ between the linear walk and the binary search\n");
+            }
+
+            const double lookups = static_cast<double>(numFrames_) * numCharacters_ * tracks.size();
+            PrintLine(Format("{:17} | {:23.1f} | {:32.1f}", seeking ? "Seeking" : "Sequential",
+                lookups / Max(linearTime, 1LL), lookups / Max(searchTime, 1LL)));
+        }
+    }
+
+    /// Sample all states per frame with the per-track layout, then again with the keyframe arrays of the animation over the same
+    /// times, and check that both produce the same poses. The arrays stay built for the skinning frames.
+    void RunSampling()
+    {
+        ea::vector<float> startTimes(numCharacters_);
+        for (unsigned i = 0; i < numCharacters_; ++i)
+            startTimes[i] = states_[i]->GetTime();
+
+        animation_->SetUseTrackArrays(false);
+        SampledPoses trackPoses[2];
+        for (bool seeking : {false, true})
+            SampleStates(startTimes, seeking, trackPoses[seeking]);
+
+        animation_->SetUseTrackArrays(true);
+        if (!animation_->GetTrackArrays())
+            ErrorExit("Keyframe arrays were not built\n");
+
+        SampledPoses arrayPoses[2];
+        for (bool seeking : {false, true})
+            SampleStates(startTimes, seeking, arrayPoses[seeking]);
+
+        PrintLine("State sampling    | Layout       | ms per frame | M bones/s");
+        for (bool seeking : {false, true})
+        {
+            const SampledPoses& lhs = trackPoses[seeking];
+            const SampledPoses& rhs = arrayPoses[seeking];
+
+            // Both layouts interpolate with the same functions, so the poses must be identical
+            if (lhs.positions_ != rhs.positions_ || lhs.rotations_ != rhs.rotations_ || lhs.scales_ != rhs.scales_)
+                ErrorExit("Sampled poses differ between the layouts\n");
+
+            const double bones = static_cast<double>(numFrames_) * numCharacters_ * numBones_;
+            const char* playback = seeking ? "Seeking" : "Sequential";
+            PrintLine(Format("{:17} | Per-track    | {:12.3f} | {:9.1f}", playback, lhs.time_ / 1000.0 / numFrames_,
+                bones / Max(lhs.time_, 1LL)));
+            PrintLine(Format("{:17} | Track arrays | {:12.3f} | {:9.1f}", playback, rhs.time_ / 1000.0 / numFrames_,
+                bones / Max(rhs.time_, 1LL)));
+        }
+    }
+
+    /// Check that editing a keyframe through a track pointer kept from earlier rebuilds the keyframe arrays on the next sample.
+    void CheckTrackArraysRebuild()
+    {
+        AnimationTrack* track = GetTracks().front();
+        const AnimationKeyFrame originalKeyFrame = *track->GetKeyFrame(0);
+        animation_->GetTrackArrays();
+
+        AnimationKeyFrame keyFrame = originalKeyFrame;
+        keyFrame.position_ += Vector3::ONE;
+        track->SetKeyFrame(0, keyFrame);
+
+        const AnimationTrackArrays* trackArrays = animation_->GetTrackArrays();
+        const unsigned numTracks = trackArrays->tracks_.size();
+        ea::vector<Vector3> positions(numTracks);
+        ea::vector<Quaternion> rotations(numTracks);
+        ea::vector<Vector3> scales(numTracks);
+        unsigned index = 0;
+        trackArrays->Sample(0.0f, ANIMATION_LENGTH, true, index, positions.data(), rotations.data(), scales.data());
+
+        const unsigned arrayIndex = ea::find(trackArrays->tracks_.begin(), trackArrays->tracks_.end(), track) -
+            trackArrays->tracks_.begin();
+        if (arrayIndex >= numTracks || positions[arrayIndex] != keyFrame.position_)
+            ErrorExit("Keyframe arrays were not rebuilt after editing a keyframe\n");
+
+        track->SetKeyFrame(0, originalKeyFrame);
+    }
+
+    /// Apply all states from the start times for the measured frames, then apply one more frame outside the measurement and
+    /// keep the bone node transforms of all characters.
+    void SampleStates(const ea::vector<float>& startTimes, bool seeking, SampledPoses& result)
+    {
+        ea::vector<float> times = startTimes;
+
+        // Same random jumps for both layouts
+        SetRandomSeed(2);
+        HiresTimer timer;
+        for (unsigned frame = 0; frame < numFrames_; ++frame)
+        {
+            AdvanceTimes(times, seeking);
+
+            timer.Reset();
+            for (unsigned i = 0; i < numCharacters_; ++i)
+            {
+                states_[i]->SetTime(times[i]);
+                states_[i]->Apply();
+            }
+            result.time_ += timer.GetUSec(false);
+        }
+
+        AdvanceTimes(times, seeking);
+        for (unsigned i = 0; i < numCharacters_; ++i)
+        {
+            states_[i]->SetTime(times[i]);
+            states_[i]->Apply();
+            for (const Bone& bone : models_[i]->GetSkeleton().GetBones())
+            {
+                result.positions_.push_back(bone.node_->GetPosition());
+                result.rotations_.push_back(bone.node_->GetRotation());
+                result.scales_.push_back(bone.node_->GetScale());
+            }
+        }
+    }
+
+    /// Run whole frames of animation and skinning the way the renderer does: animation in the parallel drawable update of
+    /// the octree, skinning in parallel geometry updates.
+    void RunSkinning()
+    {
+        PrintLine("Threads | Animation ms per frame | Skinning ms per frame | M bones/s");
+        for (unsigned numThreads : GetThreadCounts())
+        {
+            WorkQueue* queue = CreateWorkQueue(numThreads);
+
+            FrameInfo frame{};
+            frame.timeStep_ = TIME_STEP;
+
+            long long animationTime = 0;
+            long long skinningTime = 0;
+            HiresTimer timer;
+            for (unsigned i = 0; i < numFrames_; ++i)
+            {
+                ++frame.frameNumber_;
+                for (AnimationState* state : states_)
+                    state->AddTime(TIME_STEP);
+
+                timer.Reset();
+                octree_->Update(frame);
+                animationTime += timer.GetUSec(true);
+
+                queue->ParallelFor(models_.size(), SKINNING_BATCH_SIZE, [&](unsigned begin, unsigned end, unsigned)
+                {
+                    for (unsigned j = begin; j < end; ++j)
+                        models_[j]->UpdateGeometry(frame);
+                });
+                skinningTime += timer.GetUSec(false);
+            }
+
+            const double bones = static_cast<double>(numFrames_) * numCharacters_ * numBones_;
+            PrintLine(Format("{:7} | {:22.3f} | {:21.3f} | {:9.1f}", numThreads, animationTime / 1000.0 / numFrames_,
+                skinningTime / 1000.0 / numFrames_, bones / Max(animationTime + skinningTime, 1LL)));
+        }
+    }
+
+    /// Advance the times by one frame, or jump to random times when seeking.
+    void AdvanceTimes(ea::vector<float>& times, bool seeking) const
+    {
+        for (float& time : times)
+            time = seeking ? Random(ANIMATION_LENGTH) : fmodf(time + TIME_STEP, ANIMATION_LENGTH);
+    }
+
+    ea::vector<AnimationTrack*> GetTracks() const
+    {
+        ea::vector<AnimationTrack*> tracks;
+        for (unsigned i = 0; i < animation_->GetNumTracks(); ++i)
+            tracks.push_back(animation_->GetTrack(i));
+        return tracks;
+    }
+
+    /// Number of animated characters.
+    unsigned numCharacters_ = 1000;
+    /// Number of bones in the skeleton.
+    unsigned numBones_ = 200;
+    /// Number of keyframes per track.
+    unsigned numKeyFrames_ = 300;
+    /// Number of measured frames.
+    unsigned numFrames_ = 100;
+    /// Character model.
+    SharedPtr<Model> model_;
+    /// Animation of all bones.
+    SharedPtr<Animation> animation_;
+    /// Benchmark scene.
+    SharedPtr<Scene> scene_;
+    /// Octree of the scene.
+    Octree* octree_{};
+    /// Animated models of the characters.
+    ea::vector<AnimatedModel*> models_;
+    /// Animation states of the characters.
+    ea::vector<AnimationState*> states_;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::AnimationBenchmark);
@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Audio/Audio.h>
+#include <Urho3D/Audio/Sound.h>
+#include <Urho3D/Audio/SoundListener.h>
+#include <Urho3D/Audio/SoundSource3D.h>
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <BenchmarkApplication.h>
+
+namespace Urho3D
+{
+
+/// Mixing rate.
+static const int MIX_RATE = 44100;
+/// Number of samples mixed per call, same as a typical audio device buffer.
+static const unsigned MIX_SAMPLES = 1024;
+/// Far distance of the 3D sound sources, also the radius of the area they are placed in.
+static const float FAR_DISTANCE = 100.0f;
+
+/// Mixes hundreds of 3D sound sources without an audio device by driving Audio::MixOutput directly, with and without a voice limit, and prints the mixing cost per second of output.
+class AudioBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(AudioBenchmark, BenchmarkApplication);
+public:
+    explicit AudioBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--voices", maxSources_, "Maximum number of playing sound sources.");
+        cmd.add_option("--voice-limit", voiceLimit_, "Maximum number of mixed voices in the limited runs.");
+        cmd.add_option("--seconds", numSeconds_, "Seconds of audio mixed per measurement.");
+    }
+
+    void RunBenchmark() override
+    {
+        auto* audio = GetSubsystem<Audio>();
+        if (!audio->SetOfflineMode(MIX_RATE, true))
+            ErrorExit("Failed to set offline audio mode\n");
+
+        CreateScene();
+
+        PrintLine(Format("Audio benchmark: {} Hz stereo, {} s of output per measurement, {} samples per mix", MIX_RATE,
+            numSeconds_, MIX_SAMPLES));
+        PrintLine("Sources | Voice limit | Virtual | ms per output second | x realtime");
+        for (unsigned numSources = 32; numSources <= maxSources_; numSources *= 4)
+        {
+            for (unsigned limit : {0U, voiceLimit_})
+                RunMix(numSources, limit);
+        }
+    }
+
+private:
+    void CreateScene()
+    {
+        scene_ = new Scene(context_);
+        Node* listenerNode = scene_->CreateChild("Listener");
+        GetSubsystem<Audio>()->SetListener(listenerNode->CreateComponent<SoundListener>());
+
+        // Half of the sources play a mono sound at the mixing rate, the other half a stereo one which has to be resampled
+        SharedPtr<Sound> monoSound = CreateSound(MIX_RATE, false);
+        SharedPtr<Sound> stereoSound = CreateSound(MIX_RATE / 2, true);
+
+        // Fixed seed, so that every run places the same sources. Some are beyond the far distance and inaudible
+        SetRandomSeed(1);
+        for (unsigned i = 0; i < maxSources_; ++i)
+        {
+            Node* node = scene_->CreateChild("Source");
+            node->SetPosition(Vector3(Random(-1.0f, 1.0f), Random(-0.1f, 0.1f), Random(-1.0f, 1.0f)) * FAR_DISTANCE);
+            auto* source = node->CreateComponent<SoundSource3D>();
+            source->SetDistanceAttenuation(1.0f, FAR_DISTANCE, 1.0f);
+            source->Play(i % 2 ? stereoSound : monoSound);
+            // Vary the pitch, so that not all sources take the same resampling path
+            source->SetFrequency(source->GetFrequency() * Random(0.8f, 1.2f));
+            sources_.push_back(source);
+        }
+    }
+
+    SharedPtr<Sound> CreateSound(unsigned frequency, bool stereo)
+    {
+        const unsigned channels = stereo ? 2 : 1;
+        ea::vector<short> data(frequency * channels);
+        for (unsigned i = 0; i < data.size(); ++i)
+            data[i] = static_cast<short>(8192.0f * Sin(i * 440.0f * 360.0f / frequency) + Random(-1024.0f, 1024.0f));
+
+        SharedPtr<Sound> sound(new Sound(context_));
+        sound->SetData(data.data(), data.size() * sizeof(short));
+        sound->SetFormat(frequency, true, stereo);
+        sound->SetLooped(true);
+        return sound;
+    }
+
+    void RunMix(unsigned numSources, unsigned limit)
+    {
+        auto* audio = GetSubsystem<Audio>();
+        audio->SetMaxVoices(limit);
+        for (unsigned i = 0; i < sources_.size(); ++i)
+        {
+            SoundSource* source = sources_[i];
+            if (i >= numSources)
+                source->Stop();
+            else if (!source->IsPlaying())
+                source->Play(source->GetSound());
+        }
+        // Update the 3D attenuation and panning of the sources
+        audio->Update(0.0f);
+
+        ea::vector<short> output(MIX_SAMPLES * 2);
+        const unsigned numMixes = numSeconds_ * MIX_RATE / MIX_SAMPLES;
+        HiresTimer timer;
+        for (unsigned i = 0; i < numMixes; ++i)
+        {
+            // Lock the mutex like the audio device callback does
+            MutexLock lock(audio->GetMutex());
+            audio->MixOutput(output.data(), MIX_SAMPLES);
+        }
+        const long long usec = Max(timer.GetUSec(false), 1LL);
+
+        const double outputSeconds = static_cast<double>(numMixes) * MIX_SAMPLES / MIX_RATE;
+        PrintLine(Format("{:7} | {:11} | {:7} | {:20.3f} | {:10.1f}", numSources, limit ? ea::to_string(limit) : "none",
+            audio->GetNumVirtualVoices(), usec / 1000.0 / outputSeconds, outputSeconds * 1000000.0 / usec));
+    }
+
+    /// Maximum number of playing sound sources.
+    unsigned maxSources_ = 512;
+    /// Maximum number of mixed voices in the limited runs.
+    unsigned voiceLimit_ = 64;
+    /// Seconds of audio mixed per measurement.
+    unsigned numSeconds_ = 10;
+    /// Benchmark scene.
+    SharedPtr<Scene> scene_;
+    /// Sound sources.
+    ea::vector<SoundSource3D*> sources_;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::AudioBenchmark);
@@ -0,0 +1,243 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Graphics/Batch.h>
+#include <Urho3D/Math/Random.h>
+
+#include <BenchmarkApplication.h>
+
+#include <EASTL/sort.h>
+
+namespace Urho3D
+{
+
+/// Batch as sorted by the reference implementation.
+struct ReferenceBatch
+{
+    /// Sort key, rewritten by the ID remapping.
+    unsigned long long sortKey_;
+    /// Sort key of the source batch.
+    unsigned long long sourceSortKey_;
+    /// Distance from camera.
+    float distance_;
+    /// Render order.
+    unsigned char renderOrder_;
+};
+
+/// Number of distinct shaders.
+static const unsigned NUM_SHADERS = 200;
+/// Number of distinct lights.
+static const unsigned NUM_LIGHTS = 16;
+/// Number of distinct materials.
+static const unsigned NUM_MATERIALS = 500;
+/// Number of distinct geometries.
+static const unsigned NUM_GEOMETRIES = 1000;
+
+/// Return a batch with random state and distance. Distances are rounded so that ties occur.
+static Batch CreateRandomBatch()
+{
+    Batch batch;
+    const unsigned shaderID = (Rand() % NUM_SHADERS) | (Rand() % 4 ? 0x8000u : 0u);
+    batch.sortKey_ = ((unsigned long long)shaderID << 48u) | ((unsigned long long)(Rand() % NUM_LIGHTS) << 32u) |
+        ((unsigned long long)(Rand() % NUM_MATERIALS) << 16u) | (Rand() % NUM_GEOMETRIES);
+    batch.distance_ = Round(Random(1.0f, 1000.0f) * 10.0f) / 10.0f;
+    batch.renderOrder_ = Rand() % 4 ? DEFAULT_RENDER_ORDER : DEFAULT_RENDER_ORDER + 1;
+    batch.isBase_ = (shaderID & 0x8000u) == 0;
+    return batch;
+}
+
+/// Compare reference batches by render order, state and distance.
+static bool CompareBatchesState(const ReferenceBatch& lhs, const ReferenceBatch& rhs)
+{
+    if (lhs.renderOrder_ != rhs.renderOrder_)
+        return lhs.renderOrder_ < rhs.renderOrder_;
+    else if (lhs.sortKey_ != rhs.sortKey_)
+        return lhs.sortKey_ < rhs.sortKey_;
+    else
+        return lhs.distance_ < rhs.distance_;
+}
+
+/// Compare reference batches by render order, distance and state.
+static bool CompareBatchesFrontToBack(const ReferenceBatch& lhs, const ReferenceBatch& rhs)
+{
+    if (lhs.renderOrder_ != rhs.renderOrder_)
+        return lhs.renderOrder_ < rhs.renderOrder_;
+    else if (lhs.distance_ != rhs.distance_)
+        return lhs.distance_ < rhs.distance_;
+    else
+        return lhs.sortKey_ < rhs.sortKey_;
+}
+
+/// Compare reference batches by render order, reverse distance and state.
+static bool CompareBatchesBackToFront(const ReferenceBatch& lhs, const ReferenceBatch& rhs)
+{
+    if (lhs.renderOrder_ != rhs.renderOrder_)
+        return lhs.renderOrder_ < rhs.renderOrder_;
+    else if (lhs.distance_ != rhs.distance_)
+        return lhs.distance_ > rhs.distance_;
+    else
+        return lhs.sortKey_ < rhs.sortKey_;
+}
+
+/// Copy batches for the reference sort.
+static void GetReferenceBatches(const ea::vector<Batch>& batches, ea::vector<ReferenceBatch>& dest)
+{
+    dest.resize(batches.size());
+    for (unsigned i = 0; i < batches.size(); ++i)
+        dest[i] = ReferenceBatch{batches[i].sortKey_, batches[i].sortKey_, batches[i].distance_, batches[i].renderOrder_};
+}
+
+/// Replace a 16-bit ID in the sort keys with IDs assigned in the order of appearance. Bits outside the mask are kept.
+static void RemapReferenceIDs(ea::vector<ReferenceBatch>& batches, unsigned shift, unsigned mask)
+{
+    ea::unordered_map<unsigned, unsigned> remapping;
+    for (ReferenceBatch& batch : batches)
+    {
+        const auto id = (unsigned)(batch.sortKey_ >> shift) & 0xffffu;
+        auto it = remapping.find(id);
+        if (it == remapping.end())
+            it = remapping.emplace(id, Min((unsigned)remapping.size(), mask) | (id & ~mask)).first;
+        batch.sortKey_ = (batch.sortKey_ & ~(0xffffull << shift)) | ((unsigned long long)it->second << shift);
+    }
+}
+
+/// Sort back to front with comparison sort.
+static void SortReferenceBackToFront(ea::vector<ReferenceBatch>& batches)
+{
+    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesBackToFront);
+}
+
+/// Sort front to back while maintaining state sorting, like the desktop path of the batch queue, with comparison sort.
+static void SortReferenceFrontToBack(ea::vector<ReferenceBatch>& batches)
+{
+    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesFrontToBack);
+    RemapReferenceIDs(batches, 48, 0x7fffu);
+    RemapReferenceIDs(batches, 32, 0xffffu);
+    RemapReferenceIDs(batches, 16, 0xffffu);
+    RemapReferenceIDs(batches, 0, 0xffffu);
+    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesState);
+}
+
+/// Exit with an error if the sorted batches are not in the reference order.
+static void ValidateOrder(const char* name, const ea::vector<Batch*>& sorted, const ea::vector<ReferenceBatch>& reference)
+{
+    if (sorted.size() != reference.size())
+        ErrorExit(Format("{}: sorted {} batches, expected {}\n", name, sorted.size(), reference.size()));
+
+    for (unsigned i = 0; i < sorted.size(); ++i)
+    {
+        const Batch* batch = sorted[i];
+        const ReferenceBatch& expected = reference[i];
+        if (batch->renderOrder_ != expected.renderOrder_ || batch->sortKey_ != expected.sourceSortKey_ ||
+            batch->distance_ != expected.distance_)
+            ErrorExit(Format("{}: batch {} differs from the comparison sort\n", name, i));
+    }
+}
+
+/// Run a sort repeatedly and return the average time in microseconds.
+template <class T> static double MeasureSort(unsigned repeats, T sort)
+{
+    HiresTimer timer;
+    for (unsigned i = 0; i < repeats; ++i)
+        sort();
+    return (double)timer.GetUSec(false) / repeats;
+}
+
+/// Print a result row.
+static void PrintResult(const char* name, double referenceTime, double radixTime)
+{
+    PrintLine(Format("{:14} | {:13.3f} | {:13.3f} | {:6.2f}x", name, referenceTime / 1000.0, radixTime / 1000.0,
+        referenceTime / Max(radixTime, 1.0)));
+}
+
+/// Sorts a random batch queue back to front and front to back with the radix sort of the batch queue and with comparison
+/// sort, checks that the orders match and prints the times.
+class BatchBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(BatchBenchmark, BenchmarkApplication);
+public:
+    explicit BatchBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--batches", numBatches_, "Number of batches in the queue.");
+        cmd.add_option("--repeats", repeats_, "Number of times each sort is repeated.");
+    }
+
+    void RunBenchmark() override
+    {
+        numBatches_ = Max(numBatches_, 1U);
+        repeats_ = Max(repeats_, 1U);
+
+        SetRandomSeed(1);
+        ea::vector<Batch> batches(numBatches_);
+        for (Batch& batch : batches)
+            batch = CreateRandomBatch();
+
+        PrintLine(Format("Batch benchmark: {} batches, {} repeats, {} shaders, {} lights, {} materials, {} geometries",
+            numBatches_, repeats_, NUM_SHADERS, NUM_LIGHTS, NUM_MATERIALS, NUM_GEOMETRIES));
+        PrintLine("Sort           | Quick sort ms | Radix sort ms | Speedup");
+
+        BatchQueue queue;
+        queue.batches_ = batches;
+        ea::vector<ReferenceBatch> reference;
+
+        const double referenceBackToFront = MeasureSort(repeats_, [&]()
+        {
+            GetReferenceBatches(batches, reference);
+            SortReferenceBackToFront(reference);
+        });
+        const double radixBackToFront = MeasureSort(repeats_, [&]() { queue.SortBackToFront(); });
+        ValidateOrder("Back to front", queue.sortedBatches_, reference);
+        PrintResult("Back to front", referenceBackToFront, radixBackToFront);
+
+        const double referenceFrontToBack = MeasureSort(repeats_, [&]()
+        {
+            GetReferenceBatches(batches, reference);
+            SortReferenceFrontToBack(reference);
+        });
+        const double radixFrontToBack = MeasureSort(repeats_, [&]() { queue.SortFrontToBack(); });
+        ValidateOrder("Front to back", queue.sortedBatches_, reference);
+        PrintResult("Front to back", referenceFrontToBack, radixFrontToBack);
+    }
+
+private:
+    /// Number of batches in the queue.
+    unsigned numBatches_ = 50000;
+    /// Number of times each sort is repeated.
+    unsigned repeats_ = 20;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::BatchBenchmark);
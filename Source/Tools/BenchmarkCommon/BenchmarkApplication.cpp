@@ -0,0 +1,87 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/Input/InputEvents.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Math/MathDefs.h>
+
+#include "BenchmarkApplication.h"
+
+namespace Urho3D
+{
+
+BenchmarkApplication::BenchmarkApplication(Context* context)
+    : Application(context)
+{
+}
+
+void BenchmarkApplication::Setup()
+{
+    engineParameters_[EP_HEADLESS] = true;
+    engineParameters_[EP_SOUND] = false;
+    engineParameters_[EP_LOG_LEVEL] = LOG_WARNING;
+    engineParameters_[EP_RESOURCE_PATHS] = "CoreData";
+    engineParameters_[EP_RESOURCE_PREFIX_PATHS] = ";..;../..";
+
+    auto& cmd = GetCommandLineParser();
+    cmd.add_option("--max-threads", maxThreads_, "Maximum number of threads including the main thread.");
+}
+
+void BenchmarkApplication::Start()
+{
+    RunBenchmark();
+    if (!runOverFrames_)
+        FinishBenchmark();
+}
+
+ea::vector<unsigned> BenchmarkApplication::GetThreadCounts() const
+{
+    ea::vector<unsigned> threadCounts;
+    for (unsigned numThreads = 1; numThreads <= Max(maxThreads_, 1U); numThreads *= 2)
+        threadCounts.push_back(numThreads);
+    return threadCounts;
+}
+
+WorkQueue* BenchmarkApplication::CreateWorkQueue(unsigned numThreads)
+{
+    auto* workQueue = new WorkQueue(context_);
+    context_->RegisterSubsystem(workQueue);
+    workQueue->CreateThreads(numThreads - 1);
+    return workQueue;
+}
+
+void BenchmarkApplication::FinishBenchmark()
+{
+    // Engine::Exit() only closes the window, which a headless engine does not have
+    SendEvent(E_EXITREQUESTED);
+}
+
+void BenchmarkApplication::ErrorExit(const ea::string& message)
+{
+    Urho3D::ErrorExit(message);
+}
+
+}
@@ -0,0 +1,66 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Engine/Application.h>
+
+namespace Urho3D
+{
+
+class WorkQueue;
+
+/// Base of the benchmark tools. Runs the engine headless without sound, runs the benchmark once and exits. Benchmarks that
+/// render frames turn headless mode off in their setup and run over engine frames instead.
+class BenchmarkApplication : public Application
+{
+    URHO3D_OBJECT(BenchmarkApplication, Application);
+public:
+    /// Construct.
+    explicit BenchmarkApplication(Context* context);
+
+    /// Set up the engine parameters and the common command line options. Derived tools add their own options after calling this.
+    void Setup() override;
+    /// Run the benchmark and exit, unless the benchmark runs over engine frames.
+    void Start() override;
+
+protected:
+    /// Run the benchmark. The application exits when this returns.
+    virtual void RunBenchmark() = 0;
+
+    /// Return the thread counts to measure, including the main thread: powers of two up to the maximum.
+    ea::vector<unsigned> GetThreadCounts() const;
+    /// Replace the work queue subsystem with one using the specified number of threads, including the main thread. Worker threads can be created only once per queue.
+    WorkQueue* CreateWorkQueue(unsigned numThreads);
+    /// Exit at the end of the current frame. Benchmarks running over engine frames call this after the last frame.
+    void FinishBenchmark();
+    /// Print the error and terminate immediately with a failure exit code, unlike Application::ErrorExit() which returns.
+    void ErrorExit(const ea::string& message = EMPTY_STRING);
+
+    /// Maximum number of threads including the main thread.
+    unsigned maxThreads_ = 32;
+    /// Whether the benchmark runs over engine frames: RunBenchmark() only sets it up and the benchmark calls FinishBenchmark() itself.
+    bool runOverFrames_ = false;
+};
+
+}
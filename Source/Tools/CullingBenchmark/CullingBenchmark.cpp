@@ -0,0 +1,256 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Graphics/Drawable.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/OctreeQuery.h>
+#include <Urho3D/Math/Frustum.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <BenchmarkApplication.h>
+
+#include <EASTL/sort.h>
+
+namespace Urho3D
+{
+
+/// Half size of the world the boxes are placed in.
+static const float WORLD_HALF_SIZE = 1000.0f;
+/// Far clip distance of the query frustums.
+static const float FAR_CLIP = 400.0f;
+/// Number of octree subdivision levels.
+static const unsigned OCTREE_LEVELS = 8;
+
+/// Drawable with an explicitly set world bounding box.
+class BenchmarkDrawable : public Drawable
+{
+    URHO3D_OBJECT(BenchmarkDrawable, Drawable);
+
+public:
+    /// Construct.
+    explicit BenchmarkDrawable(Context* context) :
+        Drawable(context, DRAWABLE_GEOMETRY)
+    {
+    }
+
+    /// Set world bounding box. Queues an octree update like a moved drawable would.
+    void SetBox(const BoundingBox& box)
+    {
+        box_ = box;
+        OnMarkedDirty(nullptr);
+    }
+
+protected:
+    /// Recalculate the world-space bounding box.
+    void OnWorldBoundingBoxUpdate() override { worldBoundingBox_ = box_; }
+
+private:
+    /// World bounding box.
+    BoundingBox box_;
+};
+
+/// Frustum query that tests the live bounding box of every drawable, as done before the octants packed their bounds.
+class LiveFrustumOctreeQuery : public FrustumOctreeQuery
+{
+public:
+    /// Construct with frustum and query parameters.
+    LiveFrustumOctreeQuery(ea::vector<Drawable*>& result, const Frustum& frustum, DrawableFlags drawableFlags) :
+        FrustumOctreeQuery(result, frustum, drawableFlags)
+    {
+    }
+
+    /// Intersection test for drawables with packed bounds.
+    void TestPackedDrawables(Drawable** drawables, const PackedDrawableBounds& bounds, bool inside) override
+    {
+        TestDrawables(drawables, drawables + bounds.Size(), inside);
+    }
+};
+
+/// Return a random box inside the world.
+static BoundingBox CreateRandomBox()
+{
+    const Vector3 center(Random(-WORLD_HALF_SIZE, WORLD_HALF_SIZE), Random(-WORLD_HALF_SIZE, WORLD_HALF_SIZE),
+        Random(-WORLD_HALF_SIZE, WORLD_HALF_SIZE));
+    const Vector3 halfSize(Random(0.25f, 2.0f), Random(0.25f, 2.0f), Random(0.25f, 2.0f));
+    return BoundingBox(center - halfSize, center + halfSize);
+}
+
+/// Run the queries and return the sorted result of each, and the elapsed time in microseconds.
+template <class T> static long long RunQueries(Octree* octree, const ea::vector<Frustum>& frustums, ea::vector<ea::vector<Drawable*> >& results)
+{
+    results.resize(frustums.size());
+    HiresTimer timer;
+    for (unsigned i = 0; i < frustums.size(); ++i)
+    {
+        T query(results[i], frustums[i], DRAWABLE_GEOMETRY);
+        octree->GetDrawables(query);
+    }
+    const long long elapsed = timer.GetUSec(false);
+
+    for (ea::vector<Drawable*>& result : results)
+        ea::quick_sort(result.begin(), result.end());
+    return elapsed;
+}
+
+/// Return the sorted drawables inside each frustum by testing every live bounding box.
+static void GetReferenceResults(const ea::vector<SharedPtr<BenchmarkDrawable> >& drawables, const ea::vector<Frustum>& frustums,
+    ea::vector<ea::vector<Drawable*> >& results)
+{
+    results.resize(frustums.size());
+    for (unsigned i = 0; i < frustums.size(); ++i)
+    {
+        results[i].clear();
+        for (BenchmarkDrawable* drawable : drawables)
+        {
+            if (frustums[i].IsInsideFast(drawable->GetWorldBoundingBox()) != OUTSIDE)
+                results[i].push_back(drawable);
+        }
+        ea::quick_sort(results[i].begin(), results[i].end());
+    }
+}
+
+/// Culls random boxes in an octree with frustum queries testing the live drawable bounds and the packed octant bounds, also
+/// while drawable updates are queued, checks the results against testing every box and prints the query times.
+class CullingBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(CullingBenchmark, BenchmarkApplication);
+public:
+    explicit CullingBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--min-boxes", minBoxes_, "Smallest number of boxes.");
+        cmd.add_option("--max-boxes", maxBoxes_, "Largest number of boxes.");
+        cmd.add_option("--queries", numQueries_, "Number of frustum queries per measurement.");
+        cmd.add_option("--moved", movedPercent_, "Percentage of boxes moved before the queued update test.");
+    }
+
+    void RunBenchmark() override
+    {
+        minBoxes_ = Max(minBoxes_, 1U);
+        maxBoxes_ = Max(maxBoxes_, 1U);
+        numQueries_ = Max(numQueries_, 1U);
+        movedPercent_ = Min(movedPercent_, 100U);
+
+        PrintLine(Format("Culling benchmark: {} frustum queries per measurement, {}% of the boxes moved for the queued update test",
+            numQueries_, movedPercent_));
+        PrintLine("Boxes   | Visible | Live ms/query | Packed ms/query | Speedup | Queued ms/query");
+        for (unsigned numBoxes = minBoxes_; numBoxes <= maxBoxes_; numBoxes *= 10)
+            RunBoxes(numBoxes);
+    }
+
+private:
+    void RunBoxes(unsigned numBoxes)
+    {
+        SetRandomSeed(numBoxes);
+
+        SharedPtr<Scene> scene(new Scene(context_));
+        auto* octree = scene->CreateComponent<Octree>();
+        octree->SetSize(BoundingBox(-WORLD_HALF_SIZE, WORLD_HALF_SIZE), OCTREE_LEVELS);
+
+        ea::vector<SharedPtr<BenchmarkDrawable> > drawables(numBoxes);
+        for (SharedPtr<BenchmarkDrawable>& drawable : drawables)
+        {
+            drawable = new BenchmarkDrawable(context_);
+            // Manual drawables are added to the root octant. Setting the box afterwards queues their reinsertion
+            octree->AddManualDrawable(drawable);
+            drawable->SetBox(CreateRandomBox());
+        }
+        FrameInfo frame{};
+        octree->Update(frame);
+
+        ea::vector<Frustum> frustums(numQueries_);
+        for (Frustum& frustum : frustums)
+        {
+            const Vector3 position(Random(-WORLD_HALF_SIZE, WORLD_HALF_SIZE), Random(-WORLD_HALF_SIZE, WORLD_HALF_SIZE),
+                Random(-WORLD_HALF_SIZE, WORLD_HALF_SIZE));
+            const Quaternion rotation(Random(-90.0f, 90.0f), Random(360.0f), 0.0f);
+            frustum.Define(60.0f, 16.0f / 9.0f, 1.0f, 0.1f, FAR_CLIP, Matrix3x4(position, rotation, 1.0f));
+        }
+
+        ea::vector<ea::vector<Drawable*> > referenceResults;
+        ea::vector<ea::vector<Drawable*> > liveResults;
+        ea::vector<ea::vector<Drawable*> > packedResults;
+
+        // Warm up the caches, then measure
+        RunQueries<FrustumOctreeQuery>(octree, frustums, packedResults);
+        const long long liveTime = RunQueries<LiveFrustumOctreeQuery>(octree, frustums, liveResults);
+        const long long packedTime = RunQueries<FrustumOctreeQuery>(octree, frustums, packedResults);
+
+        GetReferenceResults(drawables, frustums, referenceResults);
+        if (liveResults != referenceResults || packedResults != referenceResults)
+            ErrorExit(Format("Culling results differ from testing every box with {} boxes\n", numBoxes));
+
+        // Move some boxes without updating the octree. The packed bounds of their octants are now out of date, and the packed test
+        // must give the same result as testing the live bounding boxes of the drawables in the same octants
+        const unsigned numMoved = numBoxes * movedPercent_ / 100;
+        for (unsigned i = 0; i < numMoved; ++i)
+            drawables[Rand() % numBoxes]->SetBox(CreateRandomBox());
+
+        const long long queuedTime = RunQueries<FrustumOctreeQuery>(octree, frustums, packedResults);
+        RunQueries<LiveFrustumOctreeQuery>(octree, frustums, liveResults);
+        if (packedResults != liveResults)
+            ErrorExit(Format("Culling results with queued updates differ from testing the live boxes with {} boxes\n", numBoxes));
+
+        // Reinsert the moved boxes and check again
+        octree->Update(frame);
+        RunQueries<FrustumOctreeQuery>(octree, frustums, packedResults);
+        GetReferenceResults(drawables, frustums, referenceResults);
+        if (packedResults != referenceResults)
+            ErrorExit(Format("Culling results after octree update differ from testing every box with {} boxes\n", numBoxes));
+
+        unsigned long long numVisible = 0;
+        for (const ea::vector<Drawable*>& result : referenceResults)
+            numVisible += result.size();
+
+        const double numQueries = numQueries_;
+        PrintLine(Format("{:7} | {:7.0f} | {:13.3f} | {:15.3f} | {:6.2f}x | {:15.3f}", numBoxes, numVisible / numQueries,
+            liveTime / numQueries / 1000.0, packedTime / numQueries / 1000.0, (double)liveTime / Max(packedTime, 1LL),
+            queuedTime / numQueries / 1000.0));
+
+        drawables.clear();
+    }
+
+    /// Smallest number of boxes.
+    unsigned minBoxes_ = 10000;
+    /// Largest number of boxes.
+    unsigned maxBoxes_ = 1000000;
+    /// Number of frustum queries per measurement.
+    unsigned numQueries_ = 100;
+    /// Percentage of boxes moved before the queued update test.
+    unsigned movedPercent_ = 1;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::CullingBenchmark);
@@ -21,6 +21,7 @@
 //
 
 #include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/IO/Log.h>
 #include "Project.h"
 #include "Editor.h"
 #include "Pipeline/Commands/BuildAssets.h"
@@ -45,6 +46,8 @@ void BuildAssets::RegisterCommandLine(CLI::App& cli)
         GetSubsystem<Editor>()->GetEngineParameters()[EP_HEADLESS] = true;
     });
     cli.add_flag("--full", full_, "Disable out-of-date checks and rebuild cache completely.");
+    cli.add_option("--import-cache", importCacheDir_, "Directory where import byproducts are cached by source content and importer settings. Disabled by default.");
+    cli.add_option("--import-cache-size", importCacheSize_, "Maximum size of the import cache in megabytes, least recently used entries are removed after the build. 0 for unlimited.");
     cli.add_option("flavor", flavor_, "Flavor to build.");
 }
 
@@ -62,8 +65,20 @@ void BuildAssets::Execute()
         flags |= PipelineBuildFlag::SKIP_UP_TO_DATE;
 
     auto* pipeline = GetSubsystem<Pipeline>();
+    ImportCache* importCache = pipeline->GetImportCache();
+    importCache->SetCacheDir(importCacheDir_);
+    importCache->SetMaxSize(importCacheSize_ * 1024ull * 1024ull);
+    importCache->ResetStatistics();
+
     pipeline->BuildCache(pipeline->GetFlavor(flavor_), flags);
     pipeline->WaitForCompletion();
+
+    if (importCache->IsEnabled())
+    {
+        const unsigned numRemoved = importCache->Trim();
+        URHO3D_LOGINFO("Import cache '{}': {} hits, {} misses, {} stored, {} removed.", importCache->GetCacheDir(),
+            importCache->GetNumHits(), importCache->GetNumMisses(), importCache->GetNumStored(), numRemoved);
+    }
 }
 
 }
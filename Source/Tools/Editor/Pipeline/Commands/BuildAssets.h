@@ -44,6 +44,10 @@ public:
 protected:
     ///
     int full_ = 0;
+    /// Directory of the import cache. Import cache is disabled when empty.
+    ea::string importCacheDir_{};
+    /// Maximum size of the import cache in megabytes. Zero means unlimited.
+    unsigned importCacheSize_ = 4096;
     ///
     ea::string flavor_{Flavor::DEFAULT};
 };
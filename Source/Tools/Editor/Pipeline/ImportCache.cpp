@@ -0,0 +1,314 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <EASTL/sort.h>
+
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+
+#include "Pipeline/Asset.h"
+#include "Pipeline/Flavor.h"
+#include "Pipeline/ImportCache.h"
+#include "Pipeline/Importers/AssetImporter.h"
+
+namespace Urho3D
+{
+
+/// Version of cache entry layout and key calculation. Bump to invalidate all existing entries.
+static const unsigned IMPORT_CACHE_VERSION = 3;
+/// Name of the file that lists byproducts of a cache entry. It is written last, so an entry is complete once it exists.
+static const char* IMPORT_CACHE_MANIFEST = "Byproducts.txt";
+/// Subdirectory of a cache entry which holds byproduct files.
+static const char* IMPORT_CACHE_FILES = "Files/";
+/// Size of blocks in which source files are read when hashing.
+static const unsigned HASH_BLOCK_SIZE = 64 * 1024;
+/// Age in seconds after which a temporary entry directory is considered abandoned by an interrupted import.
+static const unsigned STALE_TEMP_DIR_AGE = 60 * 60;
+
+static unsigned long long HashString(unsigned long long hash, const ea::string& value, unsigned long long& totalSize)
+{
+    // Include terminator so that consecutive strings can not alias each other.
+    totalSize += value.length() + 1;
+    return UpdateHash64(hash, value.c_str(), value.length() + 1);
+}
+
+ImportCache::ImportCache(Context* context)
+    : Object(context)
+{
+}
+
+void ImportCache::SetCacheDir(const ea::string& cacheDir)
+{
+    cacheDir_ = cacheDir.empty() ? cacheDir : AddTrailingSlash(cacheDir);
+    if (!cacheDir_.empty())
+        context_->GetFileSystem()->CreateDirsRecursive(cacheDir_);
+}
+
+bool ImportCache::HashFile(const ea::string& fileName, unsigned long long& hash) const
+{
+    if (!context_->GetFileSystem()->FileExists(fileName))
+        return false;
+
+    File file(context_);
+    if (!file.Open(fileName, FILE_READ))
+        return false;
+
+    const unsigned long long size = file.GetSize();
+    hash = UpdateHash64(HASH64_SEED, &size, sizeof(size));
+
+    ea::vector<unsigned char> buffer(HASH_BLOCK_SIZE);
+    while (!file.IsEof())
+    {
+        unsigned numRead = file.Read(buffer.data(), HASH_BLOCK_SIZE);
+        if (numRead == 0)
+            return false;
+        hash = UpdateHash64(hash, buffer.data(), numRead);
+    }
+    hash = FinishHash64(hash, sizeof(size) + size);
+    return true;
+}
+
+ea::string ImportCache::GetKey(unsigned long long sourceHash, Asset* asset, AssetImporter* importer, Flavor* flavor) const
+{
+    unsigned long long hash = UpdateHash64(HASH64_SEED, &sourceHash, sizeof(sourceHash));
+    hash = UpdateHash64(hash, &IMPORT_CACHE_VERSION, sizeof(IMPORT_CACHE_VERSION));
+    unsigned long long totalSize = sizeof(sourceHash) + sizeof(IMPORT_CACHE_VERSION);
+    hash = HashString(hash, asset->GetName(), totalSize);
+    hash = HashString(hash, flavor->GetName(), totalSize);
+    hash = HashString(hash, importer->GetTypeName(), totalSize);
+
+    unsigned importerVersion = importer->GetImporterVersion();
+    hash = UpdateHash64(hash, &importerVersion, sizeof(importerVersion));
+    unsigned attributeHash = importer->HashEffectiveAttributeValues();
+    hash = UpdateHash64(hash, &attributeHash, sizeof(attributeHash));
+    totalSize += sizeof(importerVersion) + sizeof(attributeHash);
+
+    return Format("{:016x}", FinishHash64(hash, totalSize));
+}
+
+bool ImportCache::Contains(const ea::string& key) const
+{
+    return IsEnabled() && context_->GetFileSystem()->FileExists(GetEntryDir(key) + IMPORT_CACHE_MANIFEST);
+}
+
+bool ImportCache::Restore(const ea::string& key, const ea::string& outputDir, StringVector& byproducts)
+{
+    auto* fs = context_->GetFileSystem();
+    const ea::string entryDir = GetEntryDir(key);
+
+    if (!Contains(key))
+        return false;
+
+    File manifest(context_);
+    if (!manifest.Open(entryDir + IMPORT_CACHE_MANIFEST, FILE_READ))
+        return false;
+
+    StringVector names;
+    while (!manifest.IsEof())
+    {
+        ea::string name = manifest.ReadLine();
+        if (!name.empty())
+            names.push_back(name);
+    }
+
+    for (const ea::string& name : names)
+    {
+        const ea::string destination = outputDir + name;
+        fs->CreateDirsRecursive(GetPath(destination));
+        if (!fs->Copy(entryDir + IMPORT_CACHE_FILES + name, destination))
+        {
+            URHO3D_LOGWARNING("Import cache entry {} is damaged, byproduct '{}' could not be restored.", key, name);
+            return false;
+        }
+    }
+
+    // Modification time of the manifest tracks last use of the entry for Trim().
+    fs->SetLastModifiedTime(entryDir + IMPORT_CACHE_MANIFEST, Time::GetTimeSinceEpoch());
+
+    byproducts = ea::move(names);
+    ++numHits_;
+    return true;
+}
+
+bool ImportCache::Store(const ea::string& key, const ea::string& outputDir, const StringVector& byproducts)
+{
+    if (!IsEnabled() || byproducts.empty())
+        return false;
+
+    if (Contains(key))
+        return true;
+
+    auto* fs = context_->GetFileSystem();
+    const ea::string entryDir = GetEntryDir(key);
+
+    // Populate a uniquely named directory and move it into place once complete, so concurrent readers and writers (other threads
+    // or other machines sharing the cache directory) never observe a partially written entry.
+    const ea::string tempDir = Format("{}{}.{}.{}.tmp/", cacheDir_, key, Time::GetSystemTime(), tempCounter_++);
+    for (const ea::string& name : byproducts)
+    {
+        const ea::string destination = tempDir + IMPORT_CACHE_FILES + name;
+        fs->CreateDirsRecursive(GetPath(destination));
+        if (!fs->Copy(outputDir + name, destination))
+        {
+            fs->RemoveDir(tempDir, true);
+            return false;
+        }
+    }
+
+    File manifest(context_);
+    if (!manifest.Open(tempDir + IMPORT_CACHE_MANIFEST, FILE_WRITE))
+    {
+        fs->RemoveDir(tempDir, true);
+        return false;
+    }
+    for (const ea::string& name : byproducts)
+        manifest.WriteLine(name);
+    manifest.Close();
+
+    fs->CreateDirsRecursive(GetParentPath(entryDir));
+    if (!fs->Rename(RemoveTrailingSlash(tempDir), RemoveTrailingSlash(entryDir)))
+    {
+        // Another writer may have stored the same entry in the meantime.
+        fs->RemoveDir(tempDir, true);
+        return Contains(key);
+    }
+
+    ++numStored_;
+    return true;
+}
+
+unsigned ImportCache::Trim()
+{
+    if (!IsEnabled())
+        return 0;
+
+    RemoveStaleTempDirs();
+
+    if (maxSize_ == 0)
+        return 0;
+
+    struct EntryInfo
+    {
+        ea::string dir_;
+        unsigned lastUsed_{};
+        unsigned long long size_{};
+    };
+
+    auto* fs = context_->GetFileSystem();
+    ea::vector<EntryInfo> entries;
+    unsigned long long totalSize = 0;
+
+    StringVector prefixes;
+    fs->ScanDir(prefixes, cacheDir_, "*", SCAN_DIRS, false);
+    for (const ea::string& prefix : prefixes)
+    {
+        // Skips "." and ".." as well as temporary directories of entries being stored.
+        if (prefix.length() != 2 || prefix.starts_with("."))
+            continue;
+
+        StringVector keys;
+        fs->ScanDir(keys, cacheDir_ + prefix + "/", "*", SCAN_DIRS, false);
+        for (const ea::string& key : keys)
+        {
+            if (key.starts_with("."))
+                continue;
+
+            EntryInfo entry;
+            entry.dir_ = GetEntryDir(key);
+            const ea::string manifestName = entry.dir_ + IMPORT_CACHE_MANIFEST;
+            if (!fs->FileExists(manifestName))
+                continue;
+            entry.lastUsed_ = fs->GetLastModifiedTime(manifestName);
+
+            StringVector files;
+            fs->ScanDir(files, entry.dir_, "*", SCAN_FILES, true);
+            for (const ea::string& name : files)
+            {
+                File file(context_);
+                if (file.Open(entry.dir_ + name, FILE_READ))
+                    entry.size_ += file.GetSize();
+            }
+
+            totalSize += entry.size_;
+            entries.push_back(ea::move(entry));
+        }
+    }
+
+    if (totalSize <= maxSize_)
+        return 0;
+
+    ea::quick_sort(entries.begin(), entries.end(), [](const EntryInfo& a, const EntryInfo& b) { return a.lastUsed_ < b.lastUsed_; });
+
+    unsigned numRemoved = 0;
+    for (const EntryInfo& entry : entries)
+    {
+        if (totalSize <= maxSize_)
+            break;
+
+        if (fs->RemoveDir(entry.dir_, true))
+        {
+            totalSize -= entry.size_;
+            ++numRemoved;
+        }
+    }
+    return numRemoved;
+}
+
+void ImportCache::RemoveStaleTempDirs()
+{
+    auto* fs = context_->GetFileSystem();
+
+    // Temporary directories of other writers sharing the cache may still be in use, so only old enough ones are removed.
+    const unsigned now = Time::GetTimeSinceEpoch();
+    StringVector tempDirs;
+    fs->ScanDir(tempDirs, cacheDir_, "*", SCAN_DIRS, false);
+    for (const ea::string& name : tempDirs)
+    {
+        if (!name.ends_with(".tmp"))
+            continue;
+
+        const ea::string tempDir = cacheDir_ + name;
+        const unsigned modifiedTime = fs->GetLastModifiedTime(tempDir);
+        if (modifiedTime == 0 || now < modifiedTime + STALE_TEMP_DIR_AGE)
+            continue;
+
+        if (fs->RemoveDir(tempDir, true))
+            URHO3D_LOGDEBUG("Removed stale import cache directory '{}'.", name);
+    }
+}
+
+void ImportCache::ResetStatistics()
+{
+    numHits_ = 0;
+    numMisses_ = 0;
+    numStored_ = 0;
+}
+
+ea::string ImportCache::GetEntryDir(const ea::string& key) const
+{
+    // Spread entries over subdirectories to keep directory sizes manageable.
+    return Format("{}{}/{}/", cacheDir_, key.substr(0, 2), key);
+}
+
+}
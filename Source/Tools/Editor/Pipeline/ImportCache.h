@@ -0,0 +1,102 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+
+#include <atomic>
+
+#include <Urho3D/Core/Object.h>
+
+
+namespace Urho3D
+{
+
+class Asset;
+class AssetImporter;
+class Flavor;
+
+/// Persistent content-addressed cache of importer byproducts. Byproducts are stored under a key derived from source file contents,
+/// resource name, importer type, importer version and effective importer settings. Cached byproducts remain valid when file
+/// modification times change, and a cache directory may be shared between checkouts and branches.
+class ImportCache : public Object
+{
+    URHO3D_OBJECT(ImportCache, Object);
+public:
+    /// Construct.
+    explicit ImportCache(Context* context);
+    /// Set directory where byproducts are stored. Empty path disables the cache.
+    void SetCacheDir(const ea::string& cacheDir);
+    /// Returns directory where byproducts are stored.
+    const ea::string& GetCacheDir() const { return cacheDir_; }
+    /// Returns true when cache directory is set.
+    bool IsEnabled() const { return !cacheDir_.empty(); }
+    /// Compute a hash of file contents. Returns false if file can not be read. Thread-safe.
+    bool HashFile(const ea::string& fileName, unsigned long long& hash) const;
+    /// Returns cache key of byproducts produced by importer from a source file with specified content hash. Thread-safe.
+    ea::string GetKey(unsigned long long sourceHash, Asset* asset, AssetImporter* importer, Flavor* flavor) const;
+    /// Returns true when byproducts are stored under specified key. Thread-safe.
+    bool Contains(const ea::string& key) const;
+    /// Copy byproducts stored under specified key into `outputDir` and return their names. Thread-safe.
+    bool Restore(const ea::string& key, const ea::string& outputDir, StringVector& byproducts);
+    /// Copy byproducts located in `outputDir` into the cache under specified key. Thread-safe.
+    bool Store(const ea::string& key, const ea::string& outputDir, const StringVector& byproducts);
+    /// Set maximum total size of cached byproducts in bytes. Zero means unlimited.
+    void SetMaxSize(unsigned long long maxSize) { maxSize_ = maxSize; }
+    /// Returns maximum total size of cached byproducts in bytes.
+    unsigned long long GetMaxSize() const { return maxSize_; }
+    /// Remove temporary directories left behind by interrupted imports, then remove least recently used entries until total size of
+    /// cached byproducts does not exceed the maximum size. Returns number of removed entries. Must not be called while imports are
+    /// running.
+    unsigned Trim();
+    /// Register a cache miss. Thread-safe.
+    void AddMiss() { ++numMisses_; }
+    /// Reset hit, miss and store counters.
+    void ResetStatistics();
+    /// Returns number of imports satisfied from the cache.
+    unsigned GetNumHits() const { return numHits_; }
+    /// Returns number of imports that had to execute the importer.
+    unsigned GetNumMisses() const { return numMisses_; }
+    /// Returns number of imports whose byproducts were added to the cache.
+    unsigned GetNumStored() const { return numStored_; }
+
+protected:
+    /// Returns directory of a cache entry.
+    ea::string GetEntryDir(const ea::string& key) const;
+    /// Remove temporary entry directories which were not moved into place because the import storing them was interrupted.
+    void RemoveStaleTempDirs();
+
+    /// Directory where byproducts are stored.
+    ea::string cacheDir_;
+    /// Maximum total size of cached byproducts in bytes.
+    unsigned long long maxSize_{};
+    /// Number of imports satisfied from the cache.
+    std::atomic<unsigned> numHits_{0};
+    /// Number of imports that had to execute the importer.
+    std::atomic<unsigned> numMisses_{0};
+    /// Number of imports whose byproducts were added to the cache.
+    std::atomic<unsigned> numStored_{0};
+    /// Counter used to give temporary entry directories unique names.
+    std::atomic<unsigned> tempCounter_{0};
+};
+
+}
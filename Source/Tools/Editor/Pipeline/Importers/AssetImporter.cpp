@@ -26,6 +26,7 @@
 #include "EditorEvents.h"
 #include "Project.h"
 #include "Pipeline/Importers/AssetImporter.h"
+#include "Pipeline/ImportCache.h"
 #include "Pipeline/Pipeline.h"
 #include "Pipeline/Asset.h"
 
@@ -72,6 +73,23 @@ bool AssetImporter::Execute(Urho3D::Asset* input, const ea::string& outputPath)
     return true;
 }
 
+bool AssetImporter::RestoreFromCache(ImportCache* cache, const ea::string& key)
+{
+    if (!cache->Contains(key))
+        return false;
+
+    ClearByproducts();
+
+    StringVector byproducts;
+    if (!cache->Restore(key, GetSubsystem<Project>()->GetCachePath(), byproducts))
+        return false;
+
+    lastAttributeHash_ = HashEffectiveAttributeValues();
+    for (const ea::string& byproduct : byproducts)
+        AddByproduct(byproduct);
+    return true;
+}
+
 bool AssetImporter::Serialize(Archive& archive, ArchiveBlock& block)
 {
     if (!BaseClassName::Serialize(archive, block))
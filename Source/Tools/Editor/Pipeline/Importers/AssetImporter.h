@@ -32,6 +32,7 @@ namespace Urho3D
 
 class Asset;
 class Flavor;
+class ImportCache;
 
 enum class AssetImporterFlag : unsigned
 {
@@ -73,6 +74,12 @@ public:
     Variant GetInstanceDefault(const ea::string& name) const override;
     /// Returns flavor this importer belongs to.
     Flavor* GetFlavor() const { return flavor_; }
+    /// Returns version of the importer implementation. Increment it when importer output changes, so that byproducts stored in the import cache are not reused.
+    virtual unsigned GetImporterVersion() const { return 1; }
+    /// Replace byproducts with ones stored in the import cache under specified key. Used instead of Execute() when cache has matching byproducts. May be called from non-main thread.
+    bool RestoreFromCache(ImportCache* cache, const ea::string& key);
+    /// Returns a hash of all attribute values that are in effect (including unset/default/inherited values). Used for detecting a change in settings.
+    unsigned HashEffectiveAttributeValues() const;
 
 protected:
     /// Sets needed asset information. Called after creating every importer.
@@ -85,8 +92,6 @@ protected:
     void RemoveByproduct(const ea::string& byproduct);
     /// Returns true if user has modified the attribute even if attribute value is equal to default value.
     bool SaveDefaultAttributes(const AttributeInfo& attr) const override;
-    /// Returns a hash of all attribute values that are in effect (including unset/default/inherited values). Used for detecting a change in settings.
-    unsigned HashEffectiveAttributeValues() const;
     /// Returns true if user explicitly modified a specific attribute and did not reset it to default value.
     bool IsAttributeSet(const eastl::string& name) const;
 
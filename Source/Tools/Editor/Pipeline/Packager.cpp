@@ -22,6 +22,7 @@
 
 #include <EASTL/sort.h>
 
+#include <Urho3D/Core/ProcessUtils.h>
 #include <Urho3D/Core/WorkQueue.h>
 #include <Urho3D/Core/Thread.h>
 #include <Urho3D/IO/Log.h>
@@ -37,11 +38,32 @@
 namespace Urho3D
 {
 
+/// Maximum amount of file data that is read and compressed in parallel before it is written to the package.
+static const unsigned long long MAX_PACKAGER_BATCH_SIZE = 256 * 1024 * 1024;
+
+/// Thread that helps the packager prepare files.
+class PackagerThread : public Thread
+{
+public:
+    /// Construct.
+    explicit PackagerThread(const std::function<void()>& function)
+        : Thread("Packager")
+        , function_(function)
+    {
+    }
+
+    /// Execute the function.
+    void ThreadFunction() override { function_(); }
+
+private:
+    /// Function to execute.
+    std::function<void()> function_;
+};
+
 Packager::Packager(Context* context)
     : Object(context)
     , output_(context)
 {
-    compressBuffer_.resize(LZ4_compressBound(blockSize_));
 }
 
 Packager::~Packager()
@@ -112,6 +134,8 @@ void Packager::WritePackage()
     const ea::string& resourcePath = project->GetResourcePath();
     ea::string cachePath = flavor_->GetCachePath();
 
+    // Collect the files first, data is read and compressed in parallel batches afterwards.
+    unsigned assetsWithoutFiles = 0;
     for (Asset* asset : queuedAssets_)
     {
         // Asset may be importing at this time. We have to wait. Can not package another asset in this time because we want reproducible
@@ -119,28 +143,68 @@ void Packager::WritePackage()
         while (asset->IsImporting())
             Time::Sleep(1);
 
-        bool writtenAny = false;
+        bool addedAny = false;
         for (AssetImporter* importer : asset->GetImporters(flavor_))
         {
             for (const ea::string& byproduct : importer->GetByproducts())   // Byproducts are sorted on import
-            {
-                AddFile(cachePath, byproduct);
-                writtenAny = true;
-            }
+                addedAny |= AddFile(cachePath, byproduct, 0);
         }
 
         // Raw assets are only written to default flavor pak
-        if (!writtenAny && flavor_->IsDefault())
-            AddFile(resourcePath, asset->GetResourcePath());
-
-        filesDone_++;
+        if (!addedAny && flavor_->IsDefault())
+            addedAny = AddFile(resourcePath, asset->GetResourcePath(), 0);
+
+        // Asset is done when its last file is written
+        if (addedAny)
+            pendingFiles_.back().assetsDone_++;
+        else
+            assetsWithoutFiles++;
     }
 
     // Has to be done here in case any resources were imported during packaging.
     project->GetPipeline()->CookSettings(); // TODO: Thread safety
     project->GetPipeline()->CookCacheInfo();// TODO: Thread safety
-    AddFile(cachePath, "CacheInfo.json");   filesDone_++;
-    AddFile(cachePath, "Settings.json");    filesDone_++;
+    if (!AddFile(cachePath, "CacheInfo.json", 1))
+        assetsWithoutFiles++;
+    if (!AddFile(cachePath, "Settings.json", 1))
+        assetsWithoutFiles++;
+    filesDone_ += assetsWithoutFiles;
+
+    const unsigned numThreads = Max(GetNumLogicalCPUs(), 1U);
+    for (unsigned batchStart = 0; batchStart < pendingFiles_.size();)
+    {
+        unsigned batchEnd = batchStart;
+        unsigned long long batchSize = 0;
+        do
+            batchSize += pendingFiles_[batchEnd++].entry_.size_;
+        while (batchEnd < pendingFiles_.size() && batchSize < MAX_PACKAGER_BATCH_SIZE);
+
+        // Packaging runs in a worker thread of the work queue, which can not distribute work itself, so use dedicated helper threads.
+        std::atomic<unsigned> nextFile{batchStart};
+        auto prepareFiles = [&]()
+        {
+            for (unsigned index = nextFile++; index < batchEnd; index = nextFile++)
+                PrepareFile(pendingFiles_[index]);
+        };
+
+        ea::vector<ea::unique_ptr<PackagerThread>> threads;
+        for (unsigned i = 1; i < Min(numThreads, batchEnd - batchStart); ++i)
+        {
+            threads.emplace_back(new PackagerThread(prepareFiles));
+            threads.back()->Run();
+        }
+        prepareFiles();
+        for (auto& thread : threads)
+            thread->Stop();
+
+        // Files are written in order, so packages stay reproducible.
+        for (unsigned i = batchStart; i < batchEnd; ++i)
+            WriteFile(pendingFiles_[i]);
+
+        batchStart = batchEnd;
+    }
+    pendingFiles_.clear();
+    checksum_ = static_cast<unsigned>(FinishHash64(packageHash_, packageHashSize_));
 
     entriesOffset_ = output_.GetSize();
 
@@ -150,6 +214,17 @@ void Packager::WritePackage()
         output_.WriteUInt(entry.offset_);
         output_.WriteUInt(entry.size_);
         output_.WriteUInt(entry.checksum_);
+        if (compress_)
+        {
+            // Zero block size marks an entry stored uncompressed
+            output_.WriteVLE(entry.compressed_ ? blockSize_ : 0);
+            if (entry.compressed_)
+            {
+                output_.WriteVLE(entry.blockSizes_.size());
+                for (unsigned blockSize : entry.blockSizes_)
+                    output_.WriteVLE(blockSize);
+            }
+        }
     }
     // Write package size to the end of file to allow finding it linked to an executable file
     unsigned currentSize = output_.GetSize();
@@ -166,96 +241,131 @@ void Packager::WriteHeaders()
     output_.WriteFileID(compress_ ? "RLZ4" : "RPAK");
     output_.WriteUInt(entries_.size());
     output_.WriteUInt(checksum_);
-    output_.WriteUInt(0);                                   // Version. Reserved for future use.
+    output_.WriteUInt(PACKAGE_FORMAT_VERSION);
     output_.WriteInt64(entriesOffset_);
 }
 
-bool Packager::AddFile(const ea::string& root, const ea::string& path)
+bool Packager::AddFile(const ea::string& root, const ea::string& path, unsigned assetsDone)
 {
     assert(root.ends_with("/"));
 
-    FileEntry entry{};
-    ea::string fileFullPath;
+    PendingFile file{};
+    FileEntry& entry = file.entry_;
 
     if (IsAbsolutePath(path))
     {
         assert(root.starts_with(root));
-        fileFullPath = path;
+        file.fullPath_ = path;
         entry.name_ = path.substr(root.length());
     }
     else
     {
-        fileFullPath = root + path;
+        file.fullPath_ = root + path;
         entry.name_ = path;
     }
-    entry.checksum_ = 0;
-    entry.offset_ = 0;
-    entry.size_ = File(context_, fileFullPath).GetSize();
+    entry.size_ = File(context_, file.fullPath_).GetSize();
     if (!entry.size_)
     {
-        logger_.Warning("Skipped empty/missing file '{}'.", fileFullPath);
+        logger_.Warning("Skipped empty/missing file '{}'.", file.fullPath_);
         return false;
     }
 
-    unsigned lastOffset = entry.offset_ = output_.GetSize();
+    file.assetsDone_ = assetsDone;
+    pendingFiles_.push_back(ea::move(file));
+    return true;
+}
+
+void Packager::PrepareFile(PendingFile& file) const
+{
+    FileEntry& entry = file.entry_;
 
-    File srcFile(context_, fileFullPath);
+    File srcFile(context_, file.fullPath_);
     if (!srcFile.IsOpen())
     {
-        logger_.Error("Could not open file {}. Skipped!", fileFullPath);
-        return false;
+        logger_.Error("Could not open file {}. Skipped!", file.fullPath_);
+        file.failed_ = true;
+        return;
     }
 
-    unsigned dataSize = entry.size_;
-    buffer_.resize(dataSize);
-
-    if (srcFile.Read(&buffer_[0], dataSize) != dataSize)
+    const unsigned dataSize = entry.size_;
+    ea::vector<uint8_t> buffer(dataSize);
+    if (srcFile.Read(buffer.data(), dataSize) != dataSize)
     {
-        logger_.Error("Could not read file {}. Skipped!", fileFullPath);
-        return false;
+        logger_.Error("Could not read file {}. Skipped!", file.fullPath_);
+        file.failed_ = true;
+        return;
     }
     srcFile.Close();
 
-    for (unsigned j = 0; j < dataSize; ++j)
-    {
-        checksum_ = SDBMHash(checksum_, buffer_[j]);
-        entry.checksum_ = SDBMHash(entry.checksum_, buffer_[j]);
-    }
+    file.hash_ = FinishHash64(UpdateHash64(HASH64_SEED, buffer.data(), dataSize), dataSize);
+    entry.checksum_ = static_cast<unsigned>(file.hash_);
 
-    entries_.push_back(entry);
-    if (!compress_)
+    if (compress_)
     {
-        logger_.Info("Added {} size {}", entry.name_, dataSize);
-        output_.Write(&buffer_[0], entry.size_);
-    }
-    else
-    {
-        unsigned pos = 0;
-
-        // TODO: This could be parallelized.
-        while (pos < dataSize)
+        file.data_.reserve(dataSize);
+        for (unsigned pos = 0; pos < dataSize;)
         {
-            int unpackedSize = blockSize_;
-            if (pos + unpackedSize > dataSize)
-                unpackedSize = static_cast<int>(dataSize) - pos;
-
-            auto packedSize = (unsigned) LZ4_compress_HC((const char*) &buffer_[pos], (char*) compressBuffer_.data(), unpackedSize,
-                LZ4_compressBound(unpackedSize), 0);
+            const int unpackedSize = Min(blockSize_, static_cast<int>(dataSize - pos));
+            const int boundSize = LZ4_compressBound(unpackedSize);
+
+            // Block header is followed by compressed data
+            const unsigned blockStart = file.data_.size();
+            file.data_.resize(blockStart + 2 * sizeof(unsigned short) + boundSize);
+            auto packedSize = (unsigned) LZ4_compress_HC((const char*) &buffer[pos],
+                (char*) &file.data_[blockStart + 2 * sizeof(unsigned short)], unpackedSize, boundSize, 0);
             if (!packedSize)
+            {
                 logger_.Error("LZ4 compression failed for file {} at offset {}.", entry.name_, pos);
+                file.failed_ = true;
+                return;
+            }
 
-            output_.WriteUShort((unsigned short) unpackedSize);
-            output_.WriteUShort((unsigned short) packedSize);
-            output_.Write(compressBuffer_.data(), packedSize);
+            const unsigned short blockHeader[2] = { static_cast<unsigned short>(unpackedSize), static_cast<unsigned short>(packedSize) };
+            memcpy(&file.data_[blockStart], blockHeader, sizeof blockHeader);
+            file.data_.resize(blockStart + sizeof blockHeader + packedSize);
+            entry.blockSizes_.push_back(packedSize + sizeof blockHeader);
 
             pos += unpackedSize;
         }
 
-        unsigned totalPackedBytes = output_.GetSize() - lastOffset;
-        logger_.Info("{} in: {} out: {} ratio: {}", entry.name_, dataSize, totalPackedBytes,
-            totalPackedBytes ? 1.f * dataSize / totalPackedBytes : 0.f);
+        // Already compressed data (textures, audio) is stored as is, so that reading it does not pay for decompression
+        entry.compressed_ = file.data_.size() < dataSize;
+        if (entry.compressed_)
+            return;
+        entry.blockSizes_.clear();
     }
-    return true;
+
+    file.data_ = ea::move(buffer);
+}
+
+void Packager::WriteFile(PendingFile& file)
+{
+    if (!file.failed_)
+    {
+        FileEntry& entry = file.entry_;
+        const unsigned dataSize = entry.size_;
+        const unsigned writtenSize = file.data_.size();
+
+        entry.offset_ = output_.GetSize();
+        output_.Write(file.data_.data(), writtenSize);
+        packageHash_ = UpdateHash64(packageHash_, &file.hash_, sizeof file.hash_);
+        packageHashSize_ += sizeof file.hash_;
+
+        if (!entry.compressed_)
+            logger_.Info("Added {} size {}", entry.name_, dataSize);
+        else
+        {
+            logger_.Info("{} in: {} out: {} ratio: {}", entry.name_, dataSize, writtenSize,
+                writtenSize ? 1.f * dataSize / writtenSize : 0.f);
+        }
+
+        entries_.push_back(ea::move(entry));
+    }
+
+    // Release file data as soon as possible, batches may be big
+    file.data_.clear();
+    file.data_.shrink_to_fit();
+    filesDone_ += file.assetsDone_;
 }
 
 }
@@ -42,12 +42,18 @@ struct FileEntry
     unsigned size_{};
     /// Checksum of file data.
     unsigned checksum_{};
+    /// Compressed size of each block, including the block header. Empty if package is not compressed.
+    ea::vector<unsigned> blockSizes_{};
+    /// Whether file data is compressed. Files that do not shrink are stored as is even in compressed packages.
+    bool compressed_{};
 };
 
 ///
 /// rbfx uses modified Urho3D pak file format. File header is modified and extended. Version field was added to facilitate easy modification
 /// of file structure in the future. Package entry list was moved to the end of the file (much like in a zip file) in order to allow
 /// creation of package files without knowing full list of files before-hand.
+/// Format version 1 stores a block index with each entry of a compressed package, so that reads can seek directly to any block.
+/// It stores entries of a compressed package that do not shrink uncompressed, and checksums entries with UpdateHash64().
 ///
 
 /// %Packager is responsible for creating a package for specified flavor. Package will use new file format and have RPAK/RLZ4 file id.
@@ -73,8 +79,29 @@ public:
     Flavor* GetFlavor() const { return flavor_; }
 
 protected:
-    /// Add a file to the package. This is a blocking operation.
-    bool AddFile(const ea::string& root, const ea::string& path);
+    /// File that is read, hashed and compressed before it is written to the package.
+    struct PendingFile
+    {
+        /// Package entry of the file.
+        FileEntry entry_{};
+        /// Full path to the source file.
+        ea::string fullPath_{};
+        /// Number of queued assets that are done once this file is written.
+        unsigned assetsDone_{};
+        /// 64-bit hash of file data.
+        unsigned long long hash_{};
+        /// Data to be written to the package, compressed or not.
+        ea::vector<uint8_t> data_{};
+        /// Whether reading or compressing the file failed.
+        bool failed_{};
+    };
+
+    /// Queue a file for adding to the package. Returns false if file is empty or missing.
+    bool AddFile(const ea::string& root, const ea::string& path, unsigned assetsDone);
+    /// Read, hash and compress a queued file. May be called from any thread.
+    void PrepareFile(PendingFile& file) const;
+    /// Write a prepared file to the package.
+    void WriteFile(PendingFile& file);
     /// Writes file headter to the start of the file.
     void WriteHeaders();
     /// A worker running in another thread that will handle writing the package.
@@ -88,6 +115,8 @@ protected:
     File output_;
     /// List of files that will be present in the package.
     ea::vector<FileEntry> entries_{};
+    /// List of files that are yet to be written to the package.
+    ea::vector<PendingFile> pendingFiles_{};
     /// Flavor that is being compressed.
     WeakPtr<Flavor> flavor_;
     /// A list of assets that are to be written into the package.
@@ -96,14 +125,14 @@ protected:
     bool compress_ = false;
     /// Checksum of all file data (uncompressed).
     unsigned checksum_ = 0;
+    /// Hash of file data hashes in the order they are written to the package.
+    unsigned long long packageHash_ = HASH64_SEED;
+    /// Number of bytes hashed into packageHash_.
+    unsigned long long packageHashSize_ = 0;
     /// Offset to the list of file entries in this package.
     int64_t entriesOffset_ = 0;
     /// LZ4 block size for data compression.
     const int blockSize_ = 32768;
-    /// Buffer that holds data that was read from file. It will be written to package or used in compression.
-    ea::vector<uint8_t> buffer_{};
-    /// Buffer that holds compressed file data.
-    ea::vector<uint8_t> compressBuffer_{};
     /// Total number of assets to be processed. This number may be less than files written to the package as each asset may carry multiple byproducts.
     unsigned filesTotal_ = 0;
     /// A number of already completed written assets.
@@ -54,6 +54,7 @@ namespace Urho3D
 Pipeline::Pipeline(Context* context)
     : Object(context)
     , watcher_(context)
+    , importCache_(context->CreateObject<ImportCache>())
 {
     if (context_->GetEngine()->IsHeadless())
         return;
@@ -304,6 +305,12 @@ bool Pipeline::ExecuteImport(Asset* asset, Flavor* flavor, PipelineBuildFlags fl
     if (!flavor->IsDefault())
         outputPath += AddTrailingSlash(flavor->GetName());
 
+    // Source file is hashed at most once, and only when some importer is going to run. Imports run on worker threads, so hashing
+    // of different assets happens in parallel.
+    bool sourceHashed = false;
+    bool useImportCache = importCache_->IsEnabled() && !asset->IsMetaAsset();
+    unsigned long long sourceHash = 0;
+
     for (AssetImporter* importer : asset->importers_[SharedPtr(flavor)])
     {
         // Skip optional importers (importing default flavor when editor is running most likely)
@@ -313,10 +320,37 @@ bool Pipeline::ExecuteImport(Asset* asset, Flavor* flavor, PipelineBuildFlags fl
         if (!importer->Accepts(asset->GetResourcePath()))
             continue;
 
-        if (importer->Execute(asset, outputPath))
+        if (useImportCache && !sourceHashed)
+        {
+            useImportCache = importCache_->HashFile(asset->GetResourcePath(), sourceHash);
+            sourceHashed = true;
+        }
+
+        ea::string cacheKey;
+        bool imported = false;
+        if (useImportCache)
+        {
+            cacheKey = importCache_->GetKey(sourceHash, asset, importer, flavor);
+            if (importer->RestoreFromCache(importCache_, cacheKey))
+            {
+                logger_.Info("{} restored 'res://{}' from import cache.", importer->GetTypeName(), asset->GetName());
+                imported = true;
+            }
+            else
+                importCache_->AddMiss();
+        }
+
+        if (!imported && importer->Execute(asset, outputPath))
         {
             logger_.Info("{} imported 'res://{}'.", importer->GetTypeName(), asset->GetName());
+            imported = true;
 
+            if (useImportCache)
+                importCache_->Store(cacheKey, project->GetCachePath(), importer->GetByproducts());
+        }
+
+        if (imported)
+        {
             importedAnything = true;
             for (const ea::string& byproduct : importer->GetByproducts())
             {
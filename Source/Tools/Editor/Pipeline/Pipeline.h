@@ -38,6 +38,7 @@
 #include "Pipeline/Importers/SceneConverter.h"
 #include "Pipeline/Importers/TextureImporter.h"
 #include "Pipeline/Asset.h"
+#include "Pipeline/ImportCache.h"
 #include "Pipeline/Packager.h"
 #include "Pipeline/Flavor.h"
 
@@ -101,6 +102,8 @@ public:
     bool CookCacheInfo() const;
     /// Watch directory for changed assets and automatically convert them.
     void EnableWatcher();
+    /// Returns content-addressed cache of importer byproducts. It is disabled until a cache directory is set.
+    ImportCache* GetImportCache() const { return importCache_; }
 
 protected:
     /// Handles file watchers.
@@ -142,6 +145,8 @@ protected:
     Logger logger_ = Log::GetLogger("pipeline");
     /// Flavor that is to be removed (settings window).
     WeakPtr<Flavor> flavorPendingRemoval_;
+    /// Content-addressed cache of importer byproducts.
+    SharedPtr<ImportCache> importCache_;
 
     friend class Project;
     friend class Asset;
@@ -0,0 +1,172 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+
+#include <BenchmarkApplication.h>
+
+namespace Urho3D
+{
+
+/// Regular event sent by the benchmark.
+URHO3D_EVENT(E_BENCHMARKEVENT, BenchmarkEvent)
+{
+    URHO3D_PARAM(P_INDEX, Index);                  // unsigned
+    URHO3D_PARAM(P_VALUE, Value);                  // float
+}
+
+/// Typed event sent by the benchmark.
+URHO3D_TYPED_EVENT(BenchmarkEventArgs)
+{
+    /// Index of the event.
+    unsigned index_{};
+    /// Value of the event.
+    float value_{};
+};
+
+/// Subscriber counts to measure.
+static const unsigned subscriberCounts[] = { 1, 10, 100 };
+
+/// Object receiving the benchmark events.
+class BenchmarkReceiver : public Object
+{
+    URHO3D_OBJECT(BenchmarkReceiver, Object);
+
+public:
+    /// Construct.
+    explicit BenchmarkReceiver(Context* context) : Object(context) { }
+
+    /// Subscribe to both kinds of benchmark events.
+    void Subscribe()
+    {
+        SubscribeToEvent(E_BENCHMARKEVENT, URHO3D_HANDLER(BenchmarkReceiver, HandleEvent));
+        SubscribeToTypedEvent(&BenchmarkReceiver::HandleTypedEvent);
+    }
+
+    /// Handle regular event.
+    void HandleEvent(StringHash eventType, VariantMap& eventData)
+    {
+        using namespace BenchmarkEvent;
+        sum_ += static_cast<double>(eventData[P_INDEX].GetUInt()) + eventData[P_VALUE].GetFloat();
+        ++numCalls_;
+    }
+
+    /// Handle typed event.
+    void HandleTypedEvent(BenchmarkEventArgs& args)
+    {
+        sum_ += static_cast<double>(args.index_) + args.value_;
+        ++numCalls_;
+    }
+
+    /// Sum of received values.
+    double sum_{};
+    /// Number of handler calls.
+    unsigned numCalls_{};
+};
+
+/// Sends regular and typed events to increasing numbers of subscribers and prints the time per send.
+class EventBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(EventBenchmark, BenchmarkApplication);
+public:
+    explicit EventBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--calls", numCalls_, "Number of handler calls per measurement.");
+    }
+
+    void RunBenchmark() override
+    {
+        numCalls_ = Max(numCalls_, 100U);
+
+        PrintLine("Subscribers | SendEvent ns/send | SendTypedEvent ns/send | Speedup");
+        for (unsigned numSubscribers : subscriberCounts)
+            RunSubscribers(numSubscribers);
+    }
+
+private:
+    void RunSubscribers(unsigned numSubscribers)
+    {
+        SharedPtr<Object> sender(new BenchmarkReceiver(context_));
+        ea::vector<SharedPtr<BenchmarkReceiver>> receivers;
+        for (unsigned i = 0; i < numSubscribers; ++i)
+        {
+            auto* receiver = new BenchmarkReceiver(context_);
+            receiver->Subscribe();
+            receivers.emplace_back(receiver);
+        }
+
+        const unsigned numSends = numCalls_ / numSubscribers;
+        HiresTimer timer;
+
+        // Regular events fill the event data on every send, as engine senders do
+        for (unsigned i = 0; i < numSends; ++i)
+        {
+            using namespace BenchmarkEvent;
+            VariantMap& eventData = sender->GetEventDataMap();
+            eventData[P_INDEX] = i;
+            eventData[P_VALUE] = 0.5f;
+            sender->SendEvent(E_BENCHMARKEVENT, eventData);
+        }
+        const long long eventUSec = timer.GetUSec(true);
+
+        for (unsigned i = 0; i < numSends; ++i)
+        {
+            BenchmarkEventArgs args;
+            args.index_ = i;
+            args.value_ = 0.5f;
+            sender->SendTypedEvent(args);
+        }
+        const long long typedEventUSec = timer.GetUSec(false);
+
+        // Both kinds of events must reach every receiver with the same data
+        const double expectedSum = 2.0 * (static_cast<double>(numSends) * (numSends - 1) / 2.0 + 0.5 * numSends);
+        for (BenchmarkReceiver* receiver : receivers)
+        {
+            if (receiver->numCalls_ != 2 * numSends || receiver->sum_ != expectedSum)
+                ErrorExit("Events were not delivered to all receivers\n");
+        }
+
+        const double eventNSec = eventUSec * 1000.0 / numSends;
+        const double typedEventNSec = typedEventUSec * 1000.0 / numSends;
+        PrintLine(Format("{:11} | {:17.1f} | {:22.1f} | {:6.2f}x", numSubscribers, eventNSec, typedEventNSec,
+            eventNSec / Max(typedEventNSec, 0.001)));
+    }
+
+    /// Number of handler calls per measurement.
+    unsigned numCalls_ = 10000000;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::EventBenchmark);
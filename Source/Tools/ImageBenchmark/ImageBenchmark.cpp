@@ -0,0 +1,468 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Resource/Compress.h>
+#include <Urho3D/Resource/Decompress.h>
+#include <Urho3D/Resource/Image.h>
+
+#include <BenchmarkApplication.h>
+
+namespace Urho3D
+{
+
+/// Number of pixels processed per measurement. Small images are processed repeatedly.
+static const unsigned PIXELS_PER_MEASUREMENT = 16 * 1024 * 1024;
+/// Number of pixels compressed per measurement.
+static const unsigned PIXELS_PER_COMPRESSION = 4 * 1024 * 1024;
+
+/// Image operation to measure.
+using ImageOperation = SharedPtr<Image>(*)(Image* image);
+
+/// Block compressed format to measure.
+struct BlockFormat
+{
+    /// Name of the format.
+    const char* name_;
+    /// Format.
+    CompressedFormat format_;
+    /// Size of compressed data of 16 pixels.
+    unsigned bytesPer16Pixels_;
+};
+
+/// Compressed formats to measure encoding of.
+static const BlockFormat encodeFormats[] =
+{
+    { "DXT1", CF_DXT1, 8 },
+    { "DXT5", CF_DXT5, 16 },
+    { "ETC1", CF_ETC1, 8 },
+};
+
+/// Compression quality presets to measure.
+static const ea::pair<const char*, CompressionQuality> compressionQualities[] =
+{
+    { "fast", COMPRESSION_FAST },
+    { "normal", COMPRESSION_NORMAL },
+    { "high", COMPRESSION_HIGH },
+};
+
+/// Compressed formats to measure decoding of.
+static const BlockFormat decodeFormats[] =
+{
+    { "DXT1", CF_DXT1, 8 },
+    { "DXT3", CF_DXT3, 16 },
+    { "DXT5", CF_DXT5, 16 },
+    { "ETC1", CF_ETC1, 8 },
+    { "ETC2 RGBA", CF_ETC2_RGBA, 16 },
+    { "PVRTC 4bpp", CF_PVRTC_RGBA_4BPP, 8 },
+    { "PVRTC 2bpp", CF_PVRTC_RGBA_2BPP, 4 },
+};
+
+/// Create image of specified size filled with pseudo-random pixels.
+static SharedPtr<Image> CreateImage(Context* context, int width, int height, unsigned components, unsigned seed)
+{
+    SharedPtr<Image> image(new Image(context));
+    image->SetSize(width, height, components);
+    unsigned char* data = image->GetData();
+    const unsigned dataSize = width * height * components;
+    for (unsigned i = 0; i < dataSize; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        data[i] = static_cast<unsigned char>(seed >> 24u);
+    }
+    return image;
+}
+
+/// Create RGBA image with gradients, a wave pattern, hard edges and a little noise, roughly resembling texture content.
+static SharedPtr<Image> CreateTextureImage(Context* context, int size)
+{
+    SharedPtr<Image> image(new Image(context));
+    image->SetSize(size, size, 4);
+    unsigned char* data = image->GetData();
+    unsigned seed = size;
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            const int noise = static_cast<int>(seed >> 29u) - 4;
+            const float wave = sinf((x + y) * 0.05f);
+            const bool checker = ((x / 32) ^ (y / 32)) & 1;
+            *data++ = static_cast<unsigned char>(Clamp(x * 255 / size + noise, 0, 255));
+            *data++ = static_cast<unsigned char>(Clamp(y * 255 / size + noise, 0, 255));
+            *data++ = static_cast<unsigned char>(Clamp(static_cast<int>(128.0f + 100.0f * wave) + noise, 0, 255));
+            *data++ = checker ? 255 : static_cast<unsigned char>(96 + x * 64 / size);
+        }
+    }
+    return image;
+}
+
+/// Return peak signal-to-noise ratio in dB between two RGBA images, optionally ignoring alpha.
+static double GetPSNR(const unsigned char* lhs, const unsigned char* rhs, unsigned numPixels, bool compareAlpha)
+{
+    const unsigned numChannels = compareAlpha ? 4 : 3;
+    double sumSquaredError = 0.0;
+    for (unsigned i = 0; i < numPixels; ++i)
+    {
+        for (unsigned c = 0; c < numChannels; ++c)
+        {
+            const double error = static_cast<double>(lhs[i * 4 + c]) - rhs[i * 4 + c];
+            sumSquaredError += error * error;
+        }
+    }
+
+    const double meanSquaredError = sumSquaredError / (numPixels * numChannels);
+    return meanSquaredError > 0.0 ? 10.0 * log10(255.0 * 255.0 / meanSquaredError) : M_INFINITY;
+}
+
+/// Return a copy of the image.
+static SharedPtr<Image> CloneImage(Image* image)
+{
+    SharedPtr<Image> clone(new Image(image->GetContext()));
+    clone->SetSize(image->GetWidth(), image->GetHeight(), image->GetComponents());
+    clone->SetData(image->GetData());
+    return clone;
+}
+
+/// Return whether images have the same size and data.
+static bool CompareImages(Image* lhs, Image* rhs)
+{
+    return lhs->GetWidth() == rhs->GetWidth() && lhs->GetHeight() == rhs->GetHeight() &&
+        lhs->GetComponents() == rhs->GetComponents() &&
+        !memcmp(lhs->GetData(), rhs->GetData(), lhs->GetWidth() * lhs->GetHeight() * lhs->GetComponents());
+}
+
+/// Scalar box filter mip generation, as done per pixel before vectorization.
+static SharedPtr<Image> ReferenceNextLevel(Image* image)
+{
+    const int width = image->GetWidth();
+    const unsigned components = image->GetComponents();
+    const int widthOut = Max(width / 2, 1);
+    const int heightOut = Max(image->GetHeight() / 2, 1);
+
+    SharedPtr<Image> mipImage(new Image(image->GetContext()));
+    mipImage->SetSize(widthOut, heightOut, components);
+    for (int y = 0; y < heightOut; ++y)
+    {
+        const unsigned char* inUpper = image->GetData() + (y * 2) * width * components;
+        const unsigned char* inLower = image->GetData() + (y * 2 + 1) * width * components;
+        unsigned char* out = mipImage->GetData() + y * widthOut * components;
+        for (unsigned x = 0; x < widthOut * components; ++x)
+        {
+            const unsigned i = (x / components) * components * 2 + x % components;
+            out[x] = (unsigned char)(((unsigned)inUpper[i] + inUpper[i + components] + inLower[i] + inLower[i + components]) >> 2);
+        }
+    }
+    return mipImage;
+}
+
+/// Scalar resize to three quarters of the size through GetPixel() and Color, as done before vectorization.
+static SharedPtr<Image> ReferenceResize(Image* image)
+{
+    const int srcWidth = image->GetWidth();
+    const int srcHeight = image->GetHeight();
+    const int width = srcWidth * 3 / 4;
+    const int height = srcHeight * 3 / 4;
+    const unsigned components = image->GetComponents();
+
+    SharedPtr<Image> result(new Image(image->GetContext()));
+    result->SetSize(width, height, components);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const float xF = (srcWidth > 1) ? (float)x / (float)(width - 1) : 0.0f;
+            const float yF = (srcHeight > 1) ? (float)y / (float)(height - 1) : 0.0f;
+
+            const float xS = Clamp(xF * srcWidth - 0.5f, 0.0f, (float)(srcWidth - 1));
+            const float yS = Clamp(yF * srcHeight - 0.5f, 0.0f, (float)(srcHeight - 1));
+            const auto xI = (int)xS;
+            const auto yI = (int)yS;
+            const Color topColor = image->GetPixel(xI, yI).Lerp(image->GetPixel(xI + 1, yI), Fract(xS));
+            const Color bottomColor = image->GetPixel(xI, yI + 1).Lerp(image->GetPixel(xI + 1, yI + 1), Fract(xS));
+            const unsigned uintColor = topColor.Lerp(bottomColor, Fract(yS)).ToUInt();
+            memcpy(result->GetData() + (y * width + x) * components, &uintColor, components);
+        }
+    }
+    return result;
+}
+
+/// Scalar conversion to RGBA.
+static SharedPtr<Image> ReferenceConvertToRGBA(Image* image)
+{
+    const unsigned components = image->GetComponents();
+    const unsigned numPixels = image->GetWidth() * image->GetHeight();
+
+    SharedPtr<Image> result(new Image(image->GetContext()));
+    result->SetSize(image->GetWidth(), image->GetHeight(), 4);
+    const unsigned char* src = image->GetData();
+    unsigned char* dest = result->GetData();
+    for (unsigned i = 0; i < numPixels; ++i, src += components, dest += 4)
+    {
+        dest[0] = src[0];
+        dest[1] = components >= 3 ? src[1] : src[0];
+        dest[2] = components >= 3 ? src[2] : src[0];
+        dest[3] = components == 2 ? src[1] : components == 4 ? src[3] : 255;
+    }
+    return result;
+}
+
+/// Scalar horizontal flip.
+static SharedPtr<Image> ReferenceFlipHorizontal(Image* image)
+{
+    const int width = image->GetWidth();
+    const unsigned components = image->GetComponents();
+
+    SharedPtr<Image> result(new Image(image->GetContext()));
+    result->SetSize(width, image->GetHeight(), components);
+    for (int y = 0; y < image->GetHeight(); ++y)
+    {
+        const unsigned char* src = image->GetData() + y * width * components;
+        unsigned char* dest = result->GetData() + y * width * components;
+        for (int x = 0; x < width; ++x)
+            memcpy(dest + x * components, src + (width - x - 1) * components, components);
+    }
+    return result;
+}
+
+/// Generate next mip level with the engine.
+static SharedPtr<Image> NextLevel(Image* image)
+{
+    return image->GetNextLevel();
+}
+
+/// Resize copy of the image to three quarters of the size with the engine.
+static SharedPtr<Image> Resize(Image* image)
+{
+    SharedPtr<Image> result = CloneImage(image);
+    result->Resize(image->GetWidth() * 3 / 4, image->GetHeight() * 3 / 4);
+    return result;
+}
+
+/// Convert image to RGBA with the engine.
+static SharedPtr<Image> ConvertToRGBA(Image* image)
+{
+    return image->ConvertToRGBA();
+}
+
+/// Flip copy of the image horizontally with the engine.
+static SharedPtr<Image> FlipHorizontal(Image* image)
+{
+    SharedPtr<Image> result = CloneImage(image);
+    result->FlipHorizontal();
+    return result;
+}
+
+/// Decode compressed data to RGBA the same way CompressedLevel::Decompress() does.
+static void Decode(unsigned char* rgba, const unsigned char* blocks, CompressedFormat format, int size, WorkQueue* workQueue)
+{
+    switch (format)
+    {
+    case CF_DXT1:
+    case CF_DXT3:
+    case CF_DXT5:
+        DecompressImageDXT(rgba, blocks, size, size, 1, format, workQueue);
+        break;
+
+    case CF_ETC1:
+    case CF_ETC2_RGB:
+    case CF_ETC2_RGBA:
+        DecompressImageETC(rgba, blocks, size, size, format == CF_ETC2_RGBA, workQueue);
+        break;
+
+    default:
+        DecompressImagePVRTC(rgba, blocks, size, size, format);
+        break;
+    }
+}
+
+/// Runs the image kernels against their scalar versions, decodes block compressed formats with one and with all threads,
+/// compresses generated texture content at all quality presets, checks the results and prints the throughput.
+class ImageBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(ImageBenchmark, BenchmarkApplication);
+public:
+    explicit ImageBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--min-size", minSize_, "Smallest image size.");
+        cmd.add_option("--max-size", maxSize_, "Largest image size.");
+        cmd.add_option("--max-compress-size", maxCompressSize_, "Largest image size for compression.");
+        cmd.add_option("--threads", numThreads_, "Number of worker threads.");
+    }
+
+    void RunBenchmark() override
+    {
+        minSize_ = Max(NextPowerOfTwo(minSize_), 4U);
+        maxSize_ = Max(NextPowerOfTwo(maxSize_), 4U);
+        maxCompressSize_ = Max(NextPowerOfTwo(maxCompressSize_), 4U);
+        CreateWorkQueue(numThreads_ + 1);
+
+        PrintLine(Format("Image benchmark: {} worker threads, times are per image", numThreads_));
+        PrintLine("Operation      | Size      | Comp | Scalar ms | Engine ms | Speedup");
+        for (int size = minSize_; size <= maxSize_; size *= 2)
+        {
+            for (unsigned components = 1; components <= 4; ++components)
+                RunOperation("GetNextLevel", NextLevel, ReferenceNextLevel, size, components);
+            RunOperation("Resize", Resize, ReferenceResize, size, 4);
+            RunOperation("ConvertToRGBA", ConvertToRGBA, ReferenceConvertToRGBA, size, 1);
+            RunOperation("ConvertToRGBA", ConvertToRGBA, ReferenceConvertToRGBA, size, 2);
+            RunOperation("FlipHorizontal", FlipHorizontal, ReferenceFlipHorizontal, size, 4);
+        }
+
+        PrintLine("");
+        PrintLine("Format     | Size      | 1 thread MB/s | Worker threads MB/s");
+        for (int size = minSize_; size <= maxSize_; size *= 2)
+        {
+            for (const BlockFormat& format : decodeFormats)
+                RunDecoding(format, size);
+        }
+
+        PrintLine("");
+        PrintLine("Format | Quality | Size      | MPix/s  | PSNR dB");
+        for (int size = minSize_; size <= Min(maxSize_, maxCompressSize_); size *= 2)
+        {
+            for (const BlockFormat& format : encodeFormats)
+            {
+                for (const auto& quality : compressionQualities)
+                    RunEncoding(format, quality.second, quality.first, size);
+            }
+        }
+    }
+
+private:
+    void RunOperation(const char* name, ImageOperation operation, ImageOperation reference, int size, unsigned components)
+    {
+        const unsigned numIterations = Max(PIXELS_PER_MEASUREMENT / (size * size), 1U);
+
+        // Images cache their next mip level, so every iteration works on its own copy
+        ea::vector<SharedPtr<Image>> images;
+        images.push_back(CreateImage(context_, size, size, components, size + components));
+        for (unsigned i = 1; i < numIterations; ++i)
+            images.push_back(CloneImage(images[0]));
+
+        HiresTimer timer;
+        SharedPtr<Image> expected;
+        for (unsigned i = 0; i < numIterations; ++i)
+            expected = reference(images[i]);
+        const long long referenceUSec = timer.GetUSec(true);
+
+        SharedPtr<Image> result;
+        for (unsigned i = 0; i < numIterations; ++i)
+            result = operation(images[i]);
+        const long long operationUSec = timer.GetUSec(false);
+
+        if (!result || !CompareImages(result, expected))
+            ErrorExit(Format("{} of {}x{} image with {} components differs from the scalar path\n", name, size, size, components));
+
+        const double referenceMSec = referenceUSec / 1000.0 / numIterations;
+        const double operationMSec = operationUSec / 1000.0 / numIterations;
+        PrintLine(Format("{:14} | {:9} | {:4} | {:9.3f} | {:9.3f} | {:6.2f}x", name, Format("{}x{}", size, size), components,
+            referenceMSec, operationMSec, referenceMSec / Max(operationMSec, 0.001)));
+    }
+
+    void RunDecoding(const BlockFormat& format, int size)
+    {
+        const unsigned numIterations = Max(PIXELS_PER_MEASUREMENT / (size * size), 1U);
+        const unsigned numPixels = size * size;
+
+        // Any bit pattern is a valid block, so random data exercises all block modes
+        ea::vector<unsigned char> blocks(numPixels / 16 * format.bytesPer16Pixels_);
+        unsigned seed = size;
+        for (unsigned char& value : blocks)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            value = static_cast<unsigned char>(seed >> 24u);
+        }
+
+        ea::vector<unsigned char> singleThreaded(numPixels * 4);
+        ea::vector<unsigned char> multiThreaded(numPixels * 4);
+
+        HiresTimer timer;
+        for (unsigned i = 0; i < numIterations; ++i)
+            Decode(singleThreaded.data(), blocks.data(), format.format_, size, nullptr);
+        const long long singleThreadedUSec = timer.GetUSec(true);
+
+        for (unsigned i = 0; i < numIterations; ++i)
+            Decode(multiThreaded.data(), blocks.data(), format.format_, size, context_->GetWorkQueue());
+        const long long multiThreadedUSec = timer.GetUSec(false);
+
+        if (singleThreaded != multiThreaded)
+            ErrorExit(Format("{} decoding of {}x{} image differs between single- and multi-threaded paths\n", format.name_, size, size));
+
+        // Throughput is measured in decoded RGBA bytes
+        const double totalMB = numIterations * numPixels * 4.0 / (1024.0 * 1024.0);
+        PrintLine(Format("{:10} | {:9} | {:13.0f} | {:19.0f}", format.name_, Format("{}x{}", size, size),
+            totalMB * 1000000.0 / Max(singleThreadedUSec, 1LL), totalMB * 1000000.0 / Max(multiThreadedUSec, 1LL)));
+    }
+
+    void RunEncoding(const BlockFormat& format, CompressionQuality quality, const char* qualityName, int size)
+    {
+        const unsigned numIterations = Max(PIXELS_PER_COMPRESSION / (size * size), 1U);
+        const unsigned numPixels = size * size;
+
+        SharedPtr<Image> image = CreateTextureImage(context_, size);
+        ea::vector<unsigned char> blocks(numPixels / 16 * format.bytesPer16Pixels_);
+
+        HiresTimer timer;
+        for (unsigned i = 0; i < numIterations; ++i)
+        {
+            if (format.format_ == CF_ETC1)
+                CompressImageETC1(blocks.data(), image->GetData(), size, size, quality, context_->GetWorkQueue());
+            else
+                CompressImageDXT(blocks.data(), image->GetData(), size, size, format.format_, quality, context_->GetWorkQueue());
+        }
+        const long long encodeUSec = timer.GetUSec(false);
+
+        // Quality is measured on the output of the engine decoders, alpha only counts for formats that store it
+        ea::vector<unsigned char> decoded(numPixels * 4);
+        Decode(decoded.data(), blocks.data(), format.format_, size, context_->GetWorkQueue());
+        const double psnr = GetPSNR(image->GetData(), decoded.data(), numPixels, format.format_ == CF_DXT5);
+
+        PrintLine(Format("{:6} | {:7} | {:9} | {:7.2f} | {:7.2f}", format.name_, qualityName, Format("{}x{}", size, size),
+            static_cast<double>(numIterations) * numPixels / Max(encodeUSec, 1LL), psnr));
+    }
+
+    /// Smallest image size.
+    int minSize_ = 256;
+    /// Largest image size.
+    int maxSize_ = 8192;
+    /// Largest image size for compression, which is much slower than the other operations.
+    int maxCompressSize_ = 2048;
+    /// Number of worker threads.
+    unsigned numThreads_ = GetNumLogicalCPUs() - 1;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::ImageBenchmark);
@@ -0,0 +1,207 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+
+#include <BenchmarkApplication.h>
+
+#include <thread>
+
+namespace Urho3D
+{
+
+/// Start logging threads, each writing the given number of info messages.
+static ea::vector<std::thread> StartLogging(unsigned numThreads, unsigned numMessages)
+{
+    ea::vector<std::thread> threads;
+    for (unsigned i = 0; i < numThreads; ++i)
+    {
+        threads.emplace_back([i, numMessages]
+        {
+            for (unsigned j = 0; j < numMessages; ++j)
+                URHO3D_LOGINFO("Thread {} message {}", i, j);
+        });
+    }
+    return threads;
+}
+
+/// Wait until the logging threads finish.
+static void JoinThreads(ea::vector<std::thread>& threads)
+{
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+/// Logs from increasing numbers of threads synchronously and asynchronously, checks that no messages are lost and prints the
+/// message throughput.
+class LogBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(LogBenchmark, BenchmarkApplication);
+public:
+    explicit LogBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+        maxThreads_ = 8;
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+        // The measured messages are info messages, which must not be filtered out or printed
+        engineParameters_[EP_LOG_LEVEL] = LOG_INFO;
+        engineParameters_[EP_LOG_QUIET] = true;
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--messages", numMessages_, "Number of messages logged by each thread.");
+        cmd.add_option("--file", fileName_, "Log file written during the benchmark.");
+    }
+
+    void RunBenchmark() override
+    {
+        numMessages_ = Max(numMessages_, 1U);
+
+        if (!RunTests())
+            ErrorExit("Asynchronous logging tests failed\n");
+
+        PrintLine(Format("Log benchmark: {} messages per thread", numMessages_));
+        PrintLine("Threads | Synchronous msg/s | Async logging msg/s | Async written msg/s");
+        for (unsigned numThreads : GetThreadCounts())
+            RunThreads(numThreads);
+
+        auto* log = GetSubsystem<Log>();
+        log->Close();
+        GetSubsystem<FileSystem>()->Delete(fileName_);
+    }
+
+private:
+    bool RunTests()
+    {
+        auto* log = context_->GetSubsystem<Log>();
+        bool success = true;
+
+        // Error messages are flushed to the file before the logging call returns
+        {
+            OpenLogFile();
+            log->SetAsync(true);
+            URHO3D_LOGERROR("Error message");
+            const unsigned numLines = CountLogFileLines();
+            log->SetAsync(false);
+
+            if (numLines != 1)
+            {
+                PrintLine("Synchronous error flush: FAILED", true);
+                success = false;
+            }
+        }
+
+        // Messages logged while asynchronous mode is being switched off must not be lost
+        {
+            const unsigned numThreads = 4;
+            OpenLogFile();
+            log->SetAsync(true);
+            ea::vector<std::thread> threads = StartLogging(numThreads, numMessages_);
+            std::this_thread::yield();
+            log->SetAsync(false);
+            JoinThreads(threads);
+            log->Close();
+            log->PumpThreadMessages();
+
+            if (CountLogFileLines() != numThreads * numMessages_)
+            {
+                PrintLine("Messages logged while stopping asynchronous mode: FAILED", true);
+                success = false;
+            }
+        }
+
+        return success;
+    }
+
+    void RunThreads(unsigned numThreads)
+    {
+        auto* log = context_->GetSubsystem<Log>();
+        const double totalMessages = static_cast<double>(numThreads) * numMessages_;
+        const auto messagesPerSecond = [totalMessages](long long usec) { return totalMessages * 1000000.0 / Max(usec, 1LL); };
+        HiresTimer timer;
+
+        OpenLogFile();
+        timer.Reset();
+        ea::vector<std::thread> threads = StartLogging(numThreads, numMessages_);
+        JoinThreads(threads);
+        const long long syncUSec = timer.GetUSec(false);
+        log->PumpThreadMessages();
+
+        // Logging threads return once their messages are queued; stopping asynchronous mode waits until they are written
+        OpenLogFile();
+        log->SetAsync(true);
+        timer.Reset();
+        threads = StartLogging(numThreads, numMessages_);
+        JoinThreads(threads);
+        const long long asyncLoggingUSec = timer.GetUSec(false);
+        log->SetAsync(false);
+        const long long asyncWrittenUSec = timer.GetUSec(false);
+        log->PumpThreadMessages();
+
+        if (CountLogFileLines() != numThreads * numMessages_)
+            ErrorExit("Asynchronous log lost messages\n");
+
+        PrintLine(Format("{:7} | {:17.0f} | {:19.0f} | {:19.0f}", numThreads, messagesPerSecond(syncUSec),
+            messagesPerSecond(asyncLoggingUSec), messagesPerSecond(asyncWrittenUSec)));
+    }
+
+    /// Start writing a new, empty log file.
+    void OpenLogFile()
+    {
+        auto* log = context_->GetSubsystem<Log>();
+        log->Close();
+        context_->GetSubsystem<FileSystem>()->Delete(fileName_);
+        log->Open(fileName_);
+    }
+
+    /// Return number of lines written into the log file so far.
+    unsigned CountLogFileLines() const
+    {
+        File file(context_, fileName_);
+        unsigned numLines = 0;
+        while (!file.IsEof())
+        {
+            if (!file.ReadLine().empty())
+                ++numLines;
+        }
+        return numLines;
+    }
+
+    /// Number of messages logged by each thread.
+    unsigned numMessages_ = 50000;
+    /// Log file written during the benchmark.
+    ea::string fileName_ = "LogBenchmark.log";
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::LogBenchmark);
@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Navigation/Navigable.h>
+#include <Urho3D/Navigation/NavigationMesh.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <BenchmarkApplication.h>
+
+namespace Urho3D
+{
+
+/// Builds the navigation mesh of a procedurally generated level with increasing numbers of worker threads and prints the tile throughput.
+class NavigationBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(NavigationBenchmark, BenchmarkApplication);
+public:
+    explicit NavigationBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--tiles", numTiles_, "Number of navigation mesh tiles along each axis.");
+        cmd.add_option("--tile-size", tileSize_, "Navigation mesh tile size in cells.");
+        cmd.add_option("--obstacles", numObstacles_, "Number of obstacles in the level.");
+    }
+
+    void RunBenchmark() override
+    {
+        CreateScene();
+
+        PrintLine(Format("Navigation mesh benchmark: {}x{} tiles of {} cells, {} obstacles", numTiles_, numTiles_, tileSize_,
+            numObstacles_));
+        PrintLine("Threads | Build time ms | Tiles/s");
+
+        for (unsigned numThreads : GetThreadCounts())
+        {
+            CreateWorkQueue(numThreads);
+
+            HiresTimer timer;
+            if (!navMesh_->Build())
+                ErrorExit("Failed to build the navigation mesh\n");
+            const long long usec = Max(timer.GetUSec(false), 1LL);
+
+            const unsigned numBuiltTiles = GetNumBuiltTiles();
+            if (!numBuiltTiles)
+                ErrorExit("No navigation mesh tiles were built\n");
+            PrintLine(Format("{:7} | {:13.1f} | {:7.1f}", numThreads, usec / 1000.0, numBuiltTiles * 1000000.0 / usec));
+        }
+    }
+
+private:
+    /// Return number of tiles that are present in the navigation mesh after the build. Tiles that failed to build are not counted.
+    unsigned GetNumBuiltTiles() const
+    {
+        const IntVector2 tiles = navMesh_->GetNumTiles();
+        unsigned numBuiltTiles = 0;
+        for (int z = 0; z < tiles.y_; ++z)
+        {
+            for (int x = 0; x < tiles.x_; ++x)
+            {
+                if (navMesh_->HasTile(IntVector2(x, z)))
+                    ++numBuiltTiles;
+            }
+        }
+        return numBuiltTiles;
+    }
+
+    void CreateScene()
+    {
+        auto* cache = GetSubsystem<ResourceCache>();
+        Model* boxModel = cache->GetResource<Model>("Models/Box.mdl");
+
+        scene_ = new Scene(context_);
+        scene_->CreateComponent<Octree>();
+        scene_->CreateComponent<Navigable>();
+        navMesh_ = scene_->CreateComponent<NavigationMesh>();
+        navMesh_->SetTileSize(tileSize_);
+        navMesh_->SetCellSize(CELL_SIZE);
+
+        // Floor spans exactly the requested number of tiles
+        const float extent = numTiles_ * tileSize_ * CELL_SIZE;
+        Node* floorNode = scene_->CreateChild("Floor");
+        floorNode->SetPosition(Vector3(0.0f, -0.5f, 0.0f));
+        floorNode->SetScale(Vector3(extent, 1.0f, extent));
+        floorNode->CreateComponent<StaticModel>()->SetModel(boxModel);
+
+        // Fixed seed, so that every run builds the same level
+        SetRandomSeed(1);
+        for (int i = 0; i < numObstacles_; ++i)
+        {
+            const Vector3 size(Random(0.5f, 4.0f), Random(0.5f, 6.0f), Random(0.5f, 4.0f));
+            const float x = Random(-0.5f, 0.5f) * (extent - 4.0f);
+            const float z = Random(-0.5f, 0.5f) * (extent - 4.0f);
+
+            Node* node = scene_->CreateChild("Obstacle");
+            node->SetPosition(Vector3(x, 0.5f * size.y_, z));
+            node->SetRotation(Quaternion(Random(0.0f, 360.0f), Vector3::UP));
+            node->SetScale(size);
+            node->CreateComponent<StaticModel>()->SetModel(boxModel);
+        }
+    }
+
+    /// Navigation mesh cell size.
+    static constexpr float CELL_SIZE = 0.3f;
+
+    /// Number of tiles along each axis.
+    int numTiles_ = 64;
+    /// Tile size in cells.
+    int tileSize_ = 32;
+    /// Number of obstacles.
+    int numObstacles_ = 8192;
+
+    /// Benchmark scene.
+    SharedPtr<Scene> scene_;
+    /// Navigation mesh.
+    WeakPtr<NavigationMesh> navMesh_;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::NavigationBenchmark);
@@ -0,0 +1,403 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/OcclusionBuffer.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Math/Ray.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <BenchmarkApplication.h>
+
+namespace Urho3D
+{
+
+/// Occluder triangles, occludee boxes and camera views to test.
+struct OccluderSet
+{
+    /// Occluder triangle vertices in world space.
+    ea::vector<Vector3> vertices_;
+    /// Occludee bounding boxes.
+    ea::vector<BoundingBox> occludees_;
+    /// Camera positions.
+    ea::vector<Vector3> viewPositions_;
+    /// Camera rotations.
+    ea::vector<Quaternion> viewRotations_;
+};
+
+/// Results of one rasterizer summed over the views.
+struct RasterizerResults
+{
+    /// Time to draw the occluders in microseconds.
+    long long drawTime_{};
+    /// Time to build the depth hierarchy in microseconds.
+    long long hierarchyTime_{};
+    /// Time to test the occludees one at a time in microseconds.
+    long long singleTestTime_{};
+    /// Time to test the occludees as a batch in microseconds.
+    long long batchTestTime_{};
+    /// Number of occludees inside the view frustums.
+    unsigned numInFrustum_{};
+    /// Number of occludees in the view frustums reported as occluded.
+    unsigned numCulled_{};
+    /// Number of culled occludees with a sample point that is visible from the camera.
+    unsigned numWronglyCulled_{};
+    /// Number of occludees reported as visible with all sample points hidden.
+    unsigned numHiddenNotCulled_{};
+};
+
+/// File ID of recorded occluder sets.
+static const char* OCCLUDER_SET_ID = "OCCS";
+/// Number of buildings along each axis of the generated city.
+static const int CITY_SIZE = 12;
+/// Distance between neighbouring buildings.
+static const float CITY_SPACING = 25.0f;
+/// Number of generated occludees.
+static const unsigned NUM_OCCLUDEES = 5000;
+/// Number of generated views.
+static const unsigned NUM_VIEWS = 8;
+/// Camera far clip distance.
+static const float FAR_CLIP = 500.0f;
+
+/// Append the triangles of a box to a vertex list.
+static void AddBoxTriangles(const BoundingBox& box, ea::vector<Vector3>& vertices)
+{
+    static const unsigned faces[6][4] = {
+        { 0, 2, 3, 1 }, { 4, 5, 7, 6 }, { 0, 1, 5, 4 }, { 2, 6, 7, 3 }, { 0, 4, 6, 2 }, { 1, 3, 7, 5 }
+    };
+
+    Vector3 corners[8];
+    for (unsigned i = 0; i < 8; ++i)
+    {
+        corners[i] = Vector3(i & 1 ? box.max_.x_ : box.min_.x_, i & 2 ? box.max_.y_ : box.min_.y_,
+            i & 4 ? box.max_.z_ : box.min_.z_);
+    }
+
+    for (const auto& face : faces)
+    {
+        vertices.push_back(corners[face[0]]);
+        vertices.push_back(corners[face[1]]);
+        vertices.push_back(corners[face[2]]);
+        vertices.push_back(corners[face[0]]);
+        vertices.push_back(corners[face[2]]);
+        vertices.push_back(corners[face[3]]);
+    }
+}
+
+/// Return whether a point is visible from a position, that is, no occluder triangle is between them.
+static bool IsPointVisible(const Vector3& from, const Vector3& to, const ea::vector<Vector3>& vertices)
+{
+    const float distance = (to - from).Length();
+    const Ray ray(from, to - from);
+    for (unsigned i = 0; i + 2 < vertices.size(); i += 3)
+    {
+        // Test both windings, as the occluders are drawn without culling
+        if (ray.HitDistance(vertices[i], vertices[i + 1], vertices[i + 2]) < distance ||
+            ray.HitDistance(vertices[i], vertices[i + 2], vertices[i + 1]) < distance)
+            return false;
+    }
+    return true;
+}
+
+/// Return number of the center and the corners, moved slightly inside, of a box that are visible from a position.
+static unsigned GetNumVisibleSamples(const Vector3& from, const BoundingBox& box, const ea::vector<Vector3>& vertices)
+{
+    const Vector3 center = box.Center();
+    const Vector3 halfSize = box.HalfSize() * 0.99f;
+    unsigned numVisible = IsPointVisible(from, center, vertices) ? 1 : 0;
+    for (unsigned i = 0; i < 8; ++i)
+    {
+        const Vector3 corner(i & 1 ? halfSize.x_ : -halfSize.x_, i & 2 ? halfSize.y_ : -halfSize.y_,
+            i & 4 ? halfSize.z_ : -halfSize.z_);
+        if (IsPointVisible(from, center + corner, vertices))
+            ++numVisible;
+    }
+    return numVisible;
+}
+
+static void GenerateOccluderSet(OccluderSet& set)
+{
+    SetRandomSeed(1);
+
+    // Buildings of random size and height on a grid, with streets between them
+    ea::vector<BoundingBox> buildings;
+    const float halfExtent = 0.5f * CITY_SPACING * CITY_SIZE;
+    for (int x = 0; x < CITY_SIZE; ++x)
+    {
+        for (int z = 0; z < CITY_SIZE; ++z)
+        {
+            const Vector3 center((x + 0.5f) * CITY_SPACING - halfExtent, 0.0f, (z + 0.5f) * CITY_SPACING - halfExtent);
+            const Vector3 halfSize(Random(5.0f, 9.0f), 0.0f, Random(5.0f, 9.0f));
+            const BoundingBox building(center - halfSize, center + halfSize + Vector3(0.0f, Random(5.0f, 40.0f), 0.0f));
+            buildings.push_back(building);
+            AddBoxTriangles(building, set.vertices_);
+        }
+    }
+
+    // Small objects in the streets and on the roofs
+    while (set.occludees_.size() < NUM_OCCLUDEES)
+    {
+        const Vector3 center(Random(-halfExtent, halfExtent), Random(0.0f, 45.0f), Random(-halfExtent, halfExtent));
+        const Vector3 halfSize(Random(0.25f, 1.0f), Random(0.25f, 1.0f), Random(0.25f, 1.0f));
+        const BoundingBox box(center - halfSize, center + halfSize);
+
+        bool insideBuilding = false;
+        for (const BoundingBox& building : buildings)
+        {
+            if (building.IsInside(box) != OUTSIDE)
+            {
+                insideBuilding = true;
+                break;
+            }
+        }
+        if (!insideBuilding)
+            set.occludees_.push_back(box);
+    }
+
+    // Street level views at the crossings, looking along the streets and diagonally
+    for (unsigned i = 0; i < NUM_VIEWS; ++i)
+    {
+        const int crossingX = Rand() % (CITY_SIZE - 1) + 1;
+        const int crossingZ = Rand() % (CITY_SIZE - 1) + 1;
+        set.viewPositions_.push_back(Vector3(crossingX * CITY_SPACING - halfExtent, 2.0f, crossingZ * CITY_SPACING - halfExtent));
+        set.viewRotations_.push_back(Quaternion(-5.0f, 45.0f * i, 0.0f));
+    }
+}
+
+static bool LoadOccluderSet(Context* context, const ea::string& fileName, OccluderSet& set)
+{
+    File file(context, fileName, FILE_READ);
+    if (!file.IsOpen() || file.ReadFileID() != OCCLUDER_SET_ID)
+        return false;
+
+    set.vertices_.resize(file.ReadUInt());
+    for (Vector3& vertex : set.vertices_)
+        vertex = file.ReadVector3();
+    set.occludees_.resize(file.ReadUInt());
+    for (BoundingBox& box : set.occludees_)
+        box = file.ReadBoundingBox();
+    const unsigned numViews = file.ReadUInt();
+    for (unsigned i = 0; i < numViews; ++i)
+    {
+        set.viewPositions_.push_back(file.ReadVector3());
+        set.viewRotations_.push_back(file.ReadQuaternion());
+    }
+    return file.GetPosition() == file.GetSize();
+}
+
+static bool RecordOccluderSet(Context* context, const ea::string& fileName, const OccluderSet& set)
+{
+    File file(context, fileName, FILE_WRITE);
+    if (!file.IsOpen())
+        return false;
+
+    file.WriteFileID(OCCLUDER_SET_ID);
+    file.WriteUInt(set.vertices_.size());
+    for (const Vector3& vertex : set.vertices_)
+        file.WriteVector3(vertex);
+    file.WriteUInt(set.occludees_.size());
+    for (const BoundingBox& box : set.occludees_)
+        file.WriteBoundingBox(box);
+    file.WriteUInt(set.viewPositions_.size());
+    for (unsigned i = 0; i < set.viewPositions_.size(); ++i)
+    {
+        file.WriteVector3(set.viewPositions_[i]);
+        file.WriteQuaternion(set.viewRotations_[i]);
+    }
+    return true;
+}
+
+/// Draws a generated or recorded occluder set with the scanline and the tiled rasterizers, tests the occludees one at a time
+/// and as a batch, checks the culling against ray casts and prints the times per view.
+class OcclusionBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(OcclusionBenchmark, BenchmarkApplication);
+public:
+    explicit OcclusionBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--size", bufferSize_, "Occlusion buffer width. The height is half of it.");
+        cmd.add_option("--repeats", numRepeats_, "Number of repeats of each timed operation.");
+        cmd.add_option("--threads", numThreads_, "Number of worker threads.");
+        cmd.add_option("--load", loadFileName_, "File to load the occluder set from. Generated if empty.");
+        cmd.add_option("--record", recordFileName_, "File to record the occluder set to.");
+    }
+
+    void RunBenchmark() override
+    {
+        bufferSize_ = Max(bufferSize_, 16);
+        numRepeats_ = Max(numRepeats_, 1U);
+        CreateWorkQueue(numThreads_ + 1);
+
+        OccluderSet set;
+        if (!loadFileName_.empty())
+        {
+            if (!LoadOccluderSet(context_, loadFileName_, set))
+                ErrorExit("Could not load occluder set " + loadFileName_ + "\n");
+        }
+        else
+            GenerateOccluderSet(set);
+
+        if (!recordFileName_.empty() && !RecordOccluderSet(context_, recordFileName_, set))
+            ErrorExit("Could not record occluder set " + recordFileName_ + "\n");
+
+        PrintLine(Format("Occlusion benchmark: {} occluder triangles, {} occludees, {} views, {}x{} buffer, {} worker threads",
+            set.vertices_.size() / 3, set.occludees_.size(), set.viewPositions_.size(), bufferSize_, bufferSize_ / 2, numThreads_));
+
+        ea::vector<ea::vector<int> > visibleSamples;
+        RasterizerResults scanline;
+        RasterizerResults tiled;
+        RunRasterizer(set, OCCLUSION_RASTERIZER_SCANLINE, visibleSamples, scanline);
+        RunRasterizer(set, OCCLUSION_RASTERIZER_TILED, visibleSamples, tiled);
+
+        const double numViews = Max(set.viewPositions_.size(), 1U) * numRepeats_;
+        const auto ms = [numViews](long long usec) { return usec / numViews / 1000.0; };
+        PrintLine("Times are per view");
+        PrintLine("Rasterizer | Draw ms | Hierarchy ms | Single test ms | Batch test ms | Culled | Wrongly culled | Hidden not culled");
+        for (const RasterizerResults* results : { &scanline, &tiled })
+        {
+            PrintLine(Format("{:10} | {:7.3f} | {:12.3f} | {:14.3f} | {:13.3f} | {:5.1f}% | {:14} | {:17}",
+                results == &scanline ? "Scanline" : "Tiled", ms(results->drawTime_), ms(results->hierarchyTime_),
+                ms(results->singleTestTime_), ms(results->batchTestTime_),
+                100.0 * results->numCulled_ / Max(results->numInFrustum_, 1U), results->numWronglyCulled_, results->numHiddenNotCulled_));
+        }
+        PrintLine("Culled is the share of the occludees in the view frustums. An occludee is wrongly culled if a sample point on it is "
+            "visible from the camera, and hidden if none of its sample points are.");
+    }
+
+private:
+    void RunRasterizer(const OccluderSet& set, OcclusionRasterizer rasterizer, ea::vector<ea::vector<int> >& visibleSamples,
+        RasterizerResults& results)
+    {
+        // The visible sample counts do not depend on the rasterizer, so they are calculated once for each view and occludee
+        visibleSamples.resize(set.viewPositions_.size());
+
+        SharedPtr<Scene> scene(new Scene(context_));
+        Node* cameraNode = scene->CreateChild();
+        auto* camera = cameraNode->CreateComponent<Camera>();
+        camera->SetFov(60.0f);
+        camera->SetAspectRatio(2.0f);
+        camera->SetFarClip(FAR_CLIP);
+
+        SharedPtr<OcclusionBuffer> buffer(new OcclusionBuffer(context_));
+        buffer->SetRasterizer(rasterizer);
+        buffer->SetSize(bufferSize_, bufferSize_ / 2, numThreads_ > 0);
+        buffer->SetMaxTriangles(set.vertices_.size() / 3);
+        buffer->SetCullMode(CULL_NONE);
+
+        const unsigned numOccludees = set.occludees_.size();
+        ea::vector<bool> singleVisible(numOccludees);
+        ea::vector<bool> batchVisible(numOccludees);
+
+        for (unsigned view = 0; view < set.viewPositions_.size(); ++view)
+        {
+            cameraNode->SetPosition(set.viewPositions_[view]);
+            cameraNode->SetRotation(set.viewRotations_[view]);
+            buffer->SetView(camera);
+
+            for (unsigned repeat = 0; repeat < numRepeats_; ++repeat)
+            {
+                HiresTimer timer;
+                buffer->Clear();
+                buffer->AddTriangles(Matrix3x4::IDENTITY, set.vertices_.data(), sizeof(Vector3), 0, set.vertices_.size());
+                buffer->DrawTriangles();
+                results.drawTime_ += timer.GetUSec(true);
+                buffer->BuildDepthHierarchy();
+                results.hierarchyTime_ += timer.GetUSec(false);
+            }
+
+            for (unsigned repeat = 0; repeat < numRepeats_; ++repeat)
+            {
+                HiresTimer timer;
+                for (unsigned i = 0; i < numOccludees; ++i)
+                    singleVisible[i] = buffer->IsVisible(set.occludees_[i]);
+                results.singleTestTime_ += timer.GetUSec(false);
+            }
+
+            for (unsigned repeat = 0; repeat < numRepeats_; ++repeat)
+            {
+                HiresTimer timer;
+                buffer->IsVisible(set.occludees_.data(), numOccludees, batchVisible.data());
+                results.batchTestTime_ += timer.GetUSec(false);
+            }
+
+            // The batched test must give exactly the same results as testing each box
+            for (unsigned i = 0; i < numOccludees; ++i)
+            {
+                if (singleVisible[i] != batchVisible[i])
+                    ErrorExit(Format("Batched occlusion test differs from the single box test for occludee {} in view {}\n", i, view));
+            }
+
+            // Check the occludees in the frustum against rays cast to their sample points
+            const Frustum& frustum = camera->GetFrustum();
+            visibleSamples[view].resize(numOccludees, -1);
+            for (unsigned i = 0; i < numOccludees; ++i)
+            {
+                const BoundingBox& box = set.occludees_[i];
+                if (frustum.IsInsideFast(box) == OUTSIDE)
+                    continue;
+
+                ++results.numInFrustum_;
+                if (visibleSamples[view][i] < 0)
+                    visibleSamples[view][i] = GetNumVisibleSamples(set.viewPositions_[view], box, set.vertices_);
+                const int numVisibleSamples = visibleSamples[view][i];
+                if (!singleVisible[i])
+                {
+                    ++results.numCulled_;
+                    if (numVisibleSamples)
+                        ++results.numWronglyCulled_;
+                }
+                else if (!numVisibleSamples)
+                    ++results.numHiddenNotCulled_;
+            }
+        }
+    }
+
+    /// Occlusion buffer width. The height is half of it.
+    int bufferSize_ = 256;
+    /// Number of repeats of each timed operation.
+    unsigned numRepeats_ = 20;
+    /// Number of worker threads.
+    unsigned numThreads_ = GetNumLogicalCPUs() - 1;
+    /// File to load the occluder set from. Generated if empty.
+    ea::string loadFileName_;
+    /// File to record the occluder set to.
+    ea::string recordFileName_;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::OcclusionBenchmark);
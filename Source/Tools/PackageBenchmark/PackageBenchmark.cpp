@@ -0,0 +1,334 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/IO/PackageFile.h>
+
+#include <BenchmarkApplication.h>
+
+#include <EASTL/sort.h>
+
+namespace Urho3D
+{
+
+/// Size of blocks in which files are read and hashed.
+static const unsigned BLOCK_SIZE = 64 * 1024;
+/// Size of the buffer used to measure hashing speed.
+static const unsigned HASH_BUFFER_SIZE = 256 * 1024 * 1024;
+/// Size of each random access read.
+static const unsigned RANDOM_READ_SIZE = 4 * 1024;
+
+/// Ways of reading the packaged files.
+enum class ReadMode
+{
+    /// Read through the file handle of the package.
+    Stream,
+    /// Read from the memory-mapped package.
+    Mapped,
+    /// Seek by reading from the start of the file, as compressed files had to be before the block index.
+    FromStart
+};
+
+/// Fill buffer with pseudo-random data. Every other file mostly consists of repeated words, so that it compresses.
+static void FillData(ea::vector<unsigned char>& data, unsigned long long& seed, bool compressible)
+{
+    static const char* words[] = { "vertex ", "texture ", "material ", "node ", "scene ", "model ", "shader ", "light " };
+
+    unsigned pos = 0;
+    while (pos < data.size())
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        if (compressible)
+        {
+            const char* word = words[seed >> 61u];
+            for (; *word && pos < data.size(); ++word)
+                data[pos++] = static_cast<unsigned char>(*word);
+        }
+        else
+        {
+            for (unsigned i = 0; i < 8 && pos < data.size(); ++i)
+                data[pos++] = static_cast<unsigned char>(seed >> (i * 8u));
+        }
+    }
+}
+
+/// Return checksum of the file contents read in blocks, the same way PackageTool calculates it.
+static unsigned CalculateChecksum(File& file)
+{
+    unsigned char block[BLOCK_SIZE];
+    unsigned long long hash = HASH64_SEED;
+    unsigned long long totalSize = 0;
+    file.Seek(0);
+    while (!file.IsEof())
+    {
+        const unsigned readBytes = file.Read(block, BLOCK_SIZE);
+        if (!readBytes)
+            break;
+        hash = UpdateHash64(hash, block, readBytes);
+        totalSize += readBytes;
+    }
+    return static_cast<unsigned>(FinishHash64(hash, totalSize));
+}
+
+/// Return next pseudo-random number.
+static unsigned NextRandom(unsigned long long& seed)
+{
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<unsigned>(seed >> 32u);
+}
+
+/// Return throughput in megabytes per second.
+static double GetMBPerSecond(unsigned long long numBytes, long long usec)
+{
+    return numBytes / (1024.0 * 1024.0) * 1000000.0 / Max(usec, 1LL);
+}
+
+/// Measures the package checksum hash, packs generated files with PackageTool with and without compression, verifies the
+/// checksums of all entries and prints the throughput. Then measures sequential reads and random seeks with reads from the
+/// uncompressed package, the memory-mapped package and the block-indexed compressed package, compared with seeking in compressed
+/// files by reading from their start.
+class PackageBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(PackageBenchmark, BenchmarkApplication);
+public:
+    explicit PackageBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--size", totalSizeMB_, "Total size of the packaged files in megabytes.");
+        cmd.add_option("--file-size", fileSizeMB_, "Size of each packaged file in megabytes.");
+        cmd.add_option("--seeks", numSeeks_, "Number of random seeks with reads per package.");
+        cmd.add_option("--dir", workDir_, "Directory where source files and packages are created. Temporary directory if empty.");
+    }
+
+    void RunBenchmark() override
+    {
+        auto* fs = GetSubsystem<FileSystem>();
+        totalSizeMB_ = Max(totalSizeMB_, 1U);
+        fileSizeMB_ = Max(fileSizeMB_, 1U);
+        workDir_ = workDir_.empty() ? fs->GetTemporaryDir() + "PackageBenchmark/" : AddTrailingSlash(workDir_);
+
+        RunHashing();
+
+        CreateSourceFiles();
+        const ea::string uncompressedName = RunPackaging(false);
+        const ea::string compressedName = RunPackaging(true);
+
+        PrintLine(Format("Reading {} KB at {} random positions", RANDOM_READ_SIZE / 1024, numSeeks_));
+        PrintLine("Package                     | Sequential MB/s | Random reads/s");
+        const unsigned long long referenceHash = RunReading(uncompressedName, ReadMode::Stream);
+        if (RunReading(uncompressedName, ReadMode::Mapped) != referenceHash ||
+            RunReading(compressedName, ReadMode::Stream) != referenceHash ||
+            RunReading(compressedName, ReadMode::FromStart) != referenceHash)
+            ErrorExit("Random reads from the packages differ\n");
+
+        fs->RemoveDir(workDir_, true);
+    }
+
+private:
+    void RunHashing()
+    {
+        ea::vector<unsigned char> data(HASH_BUFFER_SIZE);
+        unsigned long long seed = 1;
+        FillData(data, seed, false);
+
+        HiresTimer timer;
+        const unsigned hash64 = static_cast<unsigned>(FinishHash64(UpdateHash64(HASH64_SEED, data.data(), data.size()), data.size()));
+        const long long hash64USec = timer.GetUSec(true);
+
+        unsigned sdbm = 0;
+        for (unsigned char c : data)
+            sdbm = SDBMHash(sdbm, c);
+        const long long sdbmUSec = timer.GetUSec(false);
+
+        PrintLine(Format("UpdateHash64: {:.0f} MB/s (checksum {:08x})", GetMBPerSecond(data.size(), hash64USec), hash64));
+        PrintLine(Format("SDBMHash:     {:.0f} MB/s (checksum {:08x})", GetMBPerSecond(data.size(), sdbmUSec), sdbm));
+
+        // Zero data of different length must not collide, zero state used to be a fixed point of the hash
+        const unsigned char zeros[16]{};
+        if (FinishHash64(UpdateHash64(HASH64_SEED, zeros, 8), 8) == FinishHash64(UpdateHash64(HASH64_SEED, zeros, 16), 16))
+            ErrorExit("Hashes of zero data of different length collide\n");
+    }
+
+    void CreateSourceFiles()
+    {
+        auto* fs = context_->GetSubsystem<FileSystem>();
+        const ea::string sourceDir = workDir_ + "Source/";
+        fs->RemoveDir(workDir_, true);
+        fs->CreateDirsRecursive(sourceDir);
+
+        ea::vector<unsigned char> data(fileSizeMB_ * 1024 * 1024);
+        unsigned long long seed = 1;
+        const unsigned numFiles = (totalSizeMB_ + fileSizeMB_ - 1) / fileSizeMB_;
+        for (unsigned i = 0; i < numFiles; ++i)
+        {
+            FillData(data, seed, i % 2 == 0);
+            File file(context_, Format("{}File{}.bin", sourceDir, i), FILE_WRITE);
+            if (file.Write(data.data(), data.size()) != data.size())
+                ErrorExit("Could not write source files to " + sourceDir);
+        }
+
+        // Same data apart from length
+        ea::vector<unsigned char> zeros(16);
+        File(context_, sourceDir + "Zeros8.bin", FILE_WRITE).Write(zeros.data(), 8);
+        File(context_, sourceDir + "Zeros16.bin", FILE_WRITE).Write(zeros.data(), 16);
+
+        PrintLine(Format("Created {} files, {} MB in {}", numFiles + 2, numFiles * fileSizeMB_, sourceDir));
+    }
+
+    ea::string RunPackaging(bool compress)
+    {
+        auto* fs = context_->GetSubsystem<FileSystem>();
+        const ea::string sourceDir = workDir_ + "Source";
+        const ea::string packageName = workDir_ + (compress ? "Compressed.pak" : "Uncompressed.pak");
+
+        ea::vector<ea::string> arguments{ sourceDir, packageName, "-q" };
+        if (compress)
+            arguments.push_back("-c");
+
+        HiresTimer timer;
+        if (fs->SystemRun(fs->GetProgramDir() + "PackageTool", arguments) != 0)
+            ErrorExit("PackageTool failed to create " + packageName);
+        const long long packUSec = timer.GetUSec(false);
+
+        SharedPtr<PackageFile> package(new PackageFile(context_));
+        if (!package->Open(packageName))
+            ErrorExit("Could not open " + packageName);
+
+        // Read every entry back and compare its stored checksum with the checksum of its data
+        unsigned long long numBytes = 0;
+        unsigned zeros8Checksum = 0;
+        unsigned zeros16Checksum = 0;
+        timer.Reset();
+        for (const auto& item : package->GetEntries())
+        {
+            File file(context_, package, item.first);
+            const unsigned checksum = CalculateChecksum(file);
+            if (checksum != file.GetChecksum())
+                ErrorExit("Checksum mismatch in " + item.first);
+
+            numBytes += file.GetSize();
+            if (item.first == "Zeros8.bin")
+                zeros8Checksum = checksum;
+            else if (item.first == "Zeros16.bin")
+                zeros16Checksum = checksum;
+        }
+        const long long verifyUSec = timer.GetUSec(false);
+
+        if (zeros8Checksum == zeros16Checksum)
+            ErrorExit("Checksums of zero files of different length collide\n");
+
+        PrintLine(Format("{}: {} MB packed to {} MB in {:.2f} s ({:.0f} MB/s), verified at {:.0f} MB/s",
+            compress ? "Compressed" : "Uncompressed", numBytes / (1024 * 1024), package->GetTotalSize() / (1024 * 1024),
+            packUSec / 1000000.0, GetMBPerSecond(numBytes, packUSec), GetMBPerSecond(numBytes, verifyUSec)));
+
+        return packageName;
+    }
+
+    unsigned long long RunReading(const ea::string& packageName, ReadMode mode)
+    {
+        SharedPtr<PackageFile> package(new PackageFile(context_));
+        if (!package->Open(packageName))
+            ErrorExit("Could not open " + packageName);
+        if (mode == ReadMode::Mapped && !package->MapMemory())
+            ErrorExit("Could not map " + packageName);
+
+        // Open every entry once, in the same order for every package
+        ea::vector<ea::string> names = package->GetEntryNames();
+        ea::quick_sort(names.begin(), names.end());
+        ea::vector<SharedPtr<File> > files;
+        ea::vector<bool> compressed;
+        for (const ea::string& name : names)
+        {
+            SharedPtr<File> file(new File(context_, package, name));
+            if (file->GetSize() >= RANDOM_READ_SIZE)
+            {
+                files.push_back(file);
+                compressed.push_back(package->GetEntry(name)->compressed_);
+            }
+        }
+
+        ea::vector<unsigned char> buffer(BLOCK_SIZE);
+        unsigned long long numBytes = 0;
+        HiresTimer timer;
+        for (File* file : files)
+        {
+            file->Seek(0);
+            while (!file->IsEof())
+                numBytes += file->Read(buffer.data(), BLOCK_SIZE);
+        }
+        const long long sequentialUSec = timer.GetUSec(true);
+
+        // The hash of the data read at random positions must be the same for every package and mode
+        unsigned long long seed = 1;
+        unsigned long long hash = HASH64_SEED;
+        for (unsigned i = 0; i < numSeeks_; ++i)
+        {
+            const unsigned index = NextRandom(seed) % files.size();
+            File* file = files[index];
+            const unsigned position = NextRandom(seed) % (file->GetSize() - RANDOM_READ_SIZE + 1);
+            if (mode == ReadMode::FromStart && compressed[index])
+            {
+                file->Seek(0);
+                while (file->Tell() < position)
+                    file->Read(buffer.data(), Min(position - file->Tell(), BLOCK_SIZE));
+            }
+            else
+                file->Seek(position);
+
+            if (file->Read(buffer.data(), RANDOM_READ_SIZE) != RANDOM_READ_SIZE)
+                ErrorExit("Random read failed in " + file->GetName());
+            hash = UpdateHash64(hash, buffer.data(), RANDOM_READ_SIZE);
+        }
+        const long long randomUSec = timer.GetUSec(false);
+
+        const char* modeNames[] = { "", ", memory-mapped", ", read from start" };
+        PrintLine(Format("{:27} | {:15.0f} | {:14.0f}", ea::string(package->IsCompressed() ? "Compressed" : "Uncompressed") +
+            modeNames[static_cast<unsigned>(mode)], GetMBPerSecond(numBytes, sequentialUSec), numSeeks_ * 1000000.0 / Max(randomUSec, 1LL)));
+        return hash;
+    }
+
+    /// Total size of the packaged files in megabytes.
+    unsigned totalSizeMB_ = 2048;
+    /// Size of each packaged file in megabytes.
+    unsigned fileSizeMB_ = 16;
+    /// Number of random seeks with reads per package.
+    unsigned numSeeks_ = 1000;
+    /// Directory where source files and packages are created.
+    ea::string workDir_;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::PackageBenchmark);
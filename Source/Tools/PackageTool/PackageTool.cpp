@@ -24,6 +24,7 @@
 
 #include <Urho3D/Core/Context.h>
 #include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
 #include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileSystem.h>
 #include <Urho3D/IO/PackageFile.h>
@@ -42,6 +43,7 @@
 using namespace Urho3D;
 
 static const unsigned COMPRESSED_BLOCK_SIZE = 32768;
+static const unsigned long long MAX_BATCH_DATA_SIZE = 256 * 1024 * 1024;
 
 struct FileEntry
 {
@@ -49,6 +51,11 @@ struct FileEntry
     unsigned offset_{};
     unsigned size_{};
     unsigned checksum_{};
+    unsigned long long hash_{};
+    bool compressed_{};
+    ea::vector<unsigned> blockSizes_;
+    ea::vector<unsigned char> data_;
+    ea::string error_;
 };
 
 Context* context_ = nullptr;
@@ -56,6 +63,7 @@ FileSystem* fileSystem_ = nullptr;
 ea::string basePath_;
 ea::vector<FileEntry> entries_;
 unsigned checksum_ = 0;
+unsigned fileListOffset_ = 0;
 bool compress_ = false;
 bool quiet_ = false;
 unsigned blockSize_ = COMPRESSED_BLOCK_SIZE;
@@ -68,8 +76,10 @@ ea::string ignoreExtensions_[] = {
 int main(int argc, char** argv);
 void Run(const ea::vector<ea::string>& arguments);
 void ProcessFile(const ea::string& fileName, const ea::string& rootDir);
+void PrepareFile(FileEntry& entry, const ea::string& rootDir);
 void WritePackageFile(const ea::string& fileName, const ea::string& rootDir);
 void WriteHeader(File& dest);
+void WriteFileList(File& dest);
 
 int main(int argc, char** argv)
 {
@@ -79,6 +89,13 @@ int main(int argc, char** argv)
     context_ = context;
     fileSystem_ = fileSystem;
 
+    // Files are compressed in parallel
+    context->RegisterSubsystem(new WorkQueue(context));
+#ifdef URHO3D_THREADING
+    if (GetNumLogicalCPUs() > 1)
+        context->GetWorkQueue()->CreateThreads(GetNumLogicalCPUs() - 1);
+#endif
+
     #ifdef WIN32
     arguments = ParseArguments(GetCommandLineW());
     #else
@@ -221,7 +238,9 @@ void Run(const ea::vector<ea::string>& arguments)
                     ea::string fileEntry(current->first);
                     if (outputCompressionRatio)
                     {
-                        unsigned compressedSize =
+                        // The block index knows the compressed size; older packages need the offset of the next entry
+                        unsigned compressedSize = !current->second.compressed_ ? current->second.size_ :
+                            !current->second.blockOffsets_.empty() ? current->second.blockOffsets_.back() :
                             (i == entries.end() ? packageFile->GetTotalSize() - sizeof(unsigned) : i->second.offset_) -
                             current->second.offset_;
                         fileEntry.append_sprintf("\tin: %u\tout: %u\tratio: %f", current->second.size_, compressedSize,
@@ -252,110 +271,146 @@ void ProcessFile(const ea::string& fileName, const ea::string& rootDir)
     entries_.push_back(newEntry);
 }
 
-void WritePackageFile(const ea::string& fileName, const ea::string& rootDir)
+void PrepareFile(FileEntry& entry, const ea::string& rootDir)
 {
-    if (!quiet_)
-        PrintLine("Writing package");
+    ea::string fileFullPath = rootDir + "/" + entry.name_;
 
-    File dest(context_);
-    if (!dest.Open(fileName, FILE_WRITE))
-        ErrorExit("Could not open output file " + fileName);
-
-    // Write ID, number of files & placeholder for checksum
-    WriteHeader(dest);
+    File srcFile(context_, fileFullPath);
+    if (!srcFile.IsOpen())
+    {
+        entry.error_ = "Could not open file " + fileFullPath;
+        return;
+    }
 
-    for (unsigned i = 0; i < entries_.size(); ++i)
+    unsigned dataSize = entry.size_;
+    ea::vector<unsigned char> buffer(dataSize);
+    if (srcFile.Read(buffer.data(), dataSize) != dataSize)
     {
-        // Write entry (correct offset is still unknown, will be filled in later)
-        dest.WriteString(basePath_ + entries_[i].name_);
-        dest.WriteUInt(entries_[i].offset_);
-        dest.WriteUInt(entries_[i].size_);
-        dest.WriteUInt(entries_[i].checksum_);
+        entry.error_ = "Could not read file " + fileFullPath;
+        return;
     }
+    srcFile.Close();
 
-    unsigned totalDataSize = 0;
-    unsigned lastOffset;
+    entry.hash_ = FinishHash64(UpdateHash64(HASH64_SEED, buffer.data(), dataSize), dataSize);
+    entry.checksum_ = (unsigned)entry.hash_;
 
-    // Write file data, calculate checksums & correct offsets
-    for (unsigned i = 0; i < entries_.size(); ++i)
+    if (compress_)
     {
-        lastOffset = entries_[i].offset_ = dest.GetSize();
-        ea::string fileFullPath = rootDir + "/" + entries_[i].name_;
+        entry.data_.reserve(dataSize);
+        unsigned pos = 0;
 
-        File srcFile(context_, fileFullPath);
-        if (!srcFile.IsOpen())
-            ErrorExit("Could not open file " + fileFullPath);
+        while (pos < dataSize)
+        {
+            unsigned unpackedSize = blockSize_;
+            if (pos + unpackedSize > dataSize)
+                unpackedSize = dataSize - pos;
 
-        unsigned dataSize = entries_[i].size_;
-        totalDataSize += dataSize;
-        ea::unique_ptr<unsigned char[]> buffer(new unsigned char[dataSize]);
+            // Block header is followed by compressed data
+            unsigned blockStart = entry.data_.size();
+            unsigned boundSize = LZ4_compressBound(unpackedSize);
+            entry.data_.resize(blockStart + 2 * sizeof(unsigned short) + boundSize);
 
-        if (srcFile.Read(&buffer[0], dataSize) != dataSize)
-            ErrorExit("Could not read file " + fileFullPath);
-        srcFile.Close();
+            auto packedSize = (unsigned)LZ4_compress_HC((const char*)&buffer[pos], (char*)&entry.data_[blockStart + 2 * sizeof(unsigned short)], unpackedSize, boundSize, 0);
+            if (!packedSize)
+            {
+                entry.error_ = "LZ4 compression failed for file " + entry.name_ + " at offset " + ea::to_string(pos);
+                return;
+            }
 
-        for (unsigned j = 0; j < dataSize; ++j)
-        {
-            checksum_ = SDBMHash(checksum_, buffer[j]);
-            entries_[i].checksum_ = SDBMHash(entries_[i].checksum_, buffer[j]);
-        }
+            unsigned short blockHeader[2] = { (unsigned short)unpackedSize, (unsigned short)packedSize };
+            memcpy(&entry.data_[blockStart], blockHeader, sizeof blockHeader);
+            entry.data_.resize(blockStart + sizeof blockHeader + packedSize);
+            entry.blockSizes_.push_back(packedSize + sizeof blockHeader);
 
-        if (!compress_)
-        {
-            if (!quiet_)
-                PrintLine(entries_[i].name_ + " size " + ea::to_string(dataSize));
-            dest.Write(&buffer[0], entries_[i].size_);
+            pos += unpackedSize;
         }
-        else
-        {
-            ea::unique_ptr<unsigned char[]> compressBuffer(new unsigned char[LZ4_compressBound(blockSize_)]);
 
-            unsigned pos = 0;
+        // Files that do not shrink (already compressed textures, audio) are stored as is
+        entry.compressed_ = entry.data_.size() < dataSize;
+        if (entry.compressed_)
+            return;
+        entry.blockSizes_.clear();
+    }
 
-            while (pos < dataSize)
-            {
-                unsigned unpackedSize = blockSize_;
-                if (pos + unpackedSize > dataSize)
-                    unpackedSize = dataSize - pos;
+    entry.data_ = ea::move(buffer);
+}
 
-                auto packedSize = (unsigned)LZ4_compress_HC((const char*)&buffer[pos], (char*)compressBuffer.get(), unpackedSize, LZ4_compressBound(unpackedSize), 0);
-                if (!packedSize)
-                    ErrorExit("LZ4 compression failed for file " + entries_[i].name_ + " at offset " + ea::to_string(pos));
+void WritePackageFile(const ea::string& fileName, const ea::string& rootDir)
+{
+    if (!quiet_)
+        PrintLine("Writing package");
 
-                dest.WriteUShort((unsigned short)unpackedSize);
-                dest.WriteUShort((unsigned short)packedSize);
-                dest.Write(compressBuffer.get(), packedSize);
+    File dest(context_);
+    if (!dest.Open(fileName, FILE_WRITE))
+        ErrorExit("Could not open output file " + fileName);
 
-                pos += unpackedSize;
-            }
+    // Write ID, number of files & placeholders for checksum and file list offset
+    WriteHeader(dest);
+
+    unsigned totalDataSize = 0;
+    unsigned long long packageHash = HASH64_SEED;
+    auto* workQueue = context_->GetWorkQueue();
+
+    // Read, hash & compress files in parallel batches, then write them in order and correct offsets
+    for (unsigned batchStart = 0; batchStart < entries_.size();)
+    {
+        unsigned batchEnd = batchStart;
+        unsigned long long batchDataSize = 0;
+        do
+            batchDataSize += entries_[batchEnd++].size_;
+        while (batchEnd < entries_.size() && batchDataSize < MAX_BATCH_DATA_SIZE);
+
+        workQueue->ParallelFor(batchEnd - batchStart, 1, [&](unsigned begin, unsigned end, unsigned)
+        {
+            for (unsigned i = begin; i < end; ++i)
+                PrepareFile(entries_[batchStart + i], rootDir);
+        });
+
+        for (unsigned i = batchStart; i < batchEnd; ++i)
+        {
+            FileEntry& entry = entries_[i];
+            if (!entry.error_.empty())
+                ErrorExit(entry.error_);
+
+            entry.offset_ = dest.GetSize();
+            dest.Write(entry.data_.data(), entry.data_.size());
+            packageHash = UpdateHash64(packageHash, &entry.hash_, sizeof entry.hash_);
+            totalDataSize += entry.size_;
 
             if (!quiet_)
             {
-                unsigned totalPackedBytes = dest.GetSize() - lastOffset;
-                ea::string fileEntry(entries_[i].name_);
-                fileEntry.append_sprintf("\tin: %u\tout: %u\tratio: %f", dataSize, totalPackedBytes,
-                    totalPackedBytes ? 1.f * dataSize / totalPackedBytes : 0.f);
-                PrintLine(fileEntry);
+                if (!entry.compressed_)
+                    PrintLine(entry.name_ + " size " + ea::to_string(entry.size_));
+                else
+                {
+                    unsigned totalPackedBytes = entry.data_.size();
+                    ea::string fileEntry(entry.name_);
+                    fileEntry.append_sprintf("\tin: %u\tout: %u\tratio: %f", entry.size_, totalPackedBytes,
+                        totalPackedBytes ? 1.f * entry.size_ / totalPackedBytes : 0.f);
+                    PrintLine(fileEntry);
+                }
             }
+
+            entry.data_.clear();
+            entry.data_.shrink_to_fit();
         }
+
+        batchStart = batchEnd;
     }
+    checksum_ = (unsigned)FinishHash64(packageHash, entries_.size() * sizeof(unsigned long long));
+
+    // The file list with the block index of each entry goes after the file data
+    fileListOffset_ = dest.GetSize();
+    WriteFileList(dest);
 
     // Write package size to the end of file to allow finding it linked to an executable file
     unsigned currentSize = dest.GetSize();
     dest.WriteUInt(currentSize + sizeof(unsigned));
 
-    // Write header again with correct offsets & checksums
+    // Write header again with correct checksum & file list offset
     dest.Seek(0);
     WriteHeader(dest);
 
-    for (unsigned i = 0; i < entries_.size(); ++i)
-    {
-        dest.WriteString(basePath_ + entries_[i].name_);
-        dest.WriteUInt(entries_[i].offset_);
-        dest.WriteUInt(entries_[i].size_);
-        dest.WriteUInt(entries_[i].checksum_);
-    }
-
     if (!quiet_)
     {
         PrintLine("Number of files: " + ea::to_string(entries_.size()));
@@ -369,9 +424,33 @@ void WritePackageFile(const ea::string& fileName, const ea::string& rootDir)
 void WriteHeader(File& dest)
 {
     if (!compress_)
-        dest.WriteFileID("UPAK");
+        dest.WriteFileID("RPAK");
     else
-        dest.WriteFileID("ULZ4");
+        dest.WriteFileID("RLZ4");
     dest.WriteUInt(entries_.size());
     dest.WriteUInt(checksum_);
+    dest.WriteUInt(PACKAGE_FORMAT_VERSION);
+    dest.WriteInt64(fileListOffset_);
+}
+
+void WriteFileList(File& dest)
+{
+    for (unsigned i = 0; i < entries_.size(); ++i)
+    {
+        dest.WriteString(basePath_ + entries_[i].name_);
+        dest.WriteUInt(entries_[i].offset_);
+        dest.WriteUInt(entries_[i].size_);
+        dest.WriteUInt(entries_[i].checksum_);
+        if (compress_)
+        {
+            // Zero block size marks a file stored uncompressed
+            dest.WriteVLE(entries_[i].compressed_ ? blockSize_ : 0);
+            if (entries_[i].compressed_)
+            {
+                dest.WriteVLE(entries_[i].blockSizes_.size());
+                for (unsigned blockSize : entries_[i].blockSizes_)
+                    dest.WriteVLE(blockSize);
+            }
+        }
+    }
 }
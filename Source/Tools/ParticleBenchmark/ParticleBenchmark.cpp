@@ -0,0 +1,175 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/ParticleEffect.h>
+#include <Urho3D/Graphics/ParticleEmitter.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <BenchmarkApplication.h>
+
+namespace Urho3D
+{
+
+/// Simulates many particle emitters on the main thread and prints the particle update throughput.
+class ParticleBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(ParticleBenchmark, BenchmarkApplication);
+public:
+    explicit ParticleBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--emitters", numEmitters_, "Number of particle emitters.");
+        cmd.add_option("--particles", numParticles_, "Maximum number of particles per emitter.");
+        cmd.add_option("--frames", numFrames_, "Number of measured frames.");
+        cmd.add_option("--warmup", numWarmupFrames_, "Number of frames simulated before measuring.");
+    }
+
+    void RunBenchmark() override
+    {
+        CreateScene();
+
+        FrameInfo frame{};
+        frame.timeStep_ = TIME_STEP;
+        long long updateTime = 0;
+        unsigned long long numUpdatedParticles = 0;
+        HiresTimer timer;
+        for (int i = 0; i < numWarmupFrames_ + numFrames_; ++i)
+        {
+            // Scene update marks the emitters for update, which is then done directly instead of through the octree
+            scene_->Update(TIME_STEP);
+            frame.frameNumber_ = static_cast<unsigned>(i + 1);
+
+            timer.Reset();
+            for (ParticleEmitter* emitter : emitters_)
+                emitter->Update(frame);
+            const long long frameTime = timer.GetUSec(false);
+
+            if (i >= numWarmupFrames_)
+            {
+                updateTime += frameTime;
+                numUpdatedParticles += CountActiveParticles();
+            }
+        }
+
+        const double frames = Max(numFrames_, 1);
+        const double usec = Max(updateTime, 1LL);
+#ifdef URHO3D_SSE
+        const char* simd = "SSE";
+#else
+        const char* simd = "scalar";
+#endif
+        PrintLine(Format("Particle benchmark: {} emitters x {} particles, {} frames after {} warmup frames, {} passes",
+            numEmitters_, numParticles_, numFrames_, numWarmupFrames_, simd));
+        PrintLine(Format("  Active particles       {:9.0f}", numUpdatedParticles / frames));
+        PrintLine(Format("  Update                 {:9.3f} ms", updateTime / frames / 1000.0));
+        PrintLine(Format("  Throughput             {:9.2f} M particles/s", numUpdatedParticles / usec));
+    }
+
+private:
+    void CreateScene()
+    {
+        // Every appearance pass is enabled, and lifetimes vary so that expired particles leave gaps for new ones
+        SharedPtr<ParticleEffect> effect(new ParticleEffect(context_));
+        effect->SetNumParticles(numParticles_);
+        effect->SetUpdateInvisible(true);
+        effect->SetMinEmissionRate(2000.0f);
+        effect->SetMaxEmissionRate(3000.0f);
+        effect->SetMinTimeToLive(1.0f);
+        effect->SetMaxTimeToLive(3.0f);
+        effect->SetMinVelocity(1.0f);
+        effect->SetMaxVelocity(4.0f);
+        effect->SetMinRotationSpeed(-90.0f);
+        effect->SetMaxRotationSpeed(90.0f);
+        effect->SetConstantForce(Vector3(0.0f, -9.81f, 0.0f));
+        effect->SetDampingForce(0.5f);
+        effect->SetSizeAdd(0.2f);
+        effect->SetSizeMul(1.05f);
+        effect->SetColorFrames({ColorFrame(Color::WHITE, 0.0f), ColorFrame(Color::YELLOW, 1.0f), ColorFrame(Color::TRANSPARENT_BLACK, 3.0f)});
+        effect->SetNumTextureFrames(4);
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            TextureFrame textureFrame;
+            textureFrame.uv_ = Rect(0.25f * i, 0.0f, 0.25f * (i + 1), 1.0f);
+            textureFrame.time_ = 0.5f * i;
+            effect->SetTextureFrame(i, textureFrame);
+        }
+
+        scene_ = new Scene(context_);
+        scene_->CreateComponent<Octree>();
+
+        SetRandomSeed(1);
+        for (int i = 0; i < numEmitters_; ++i)
+        {
+            Node* node = scene_->CreateChild("Emitter");
+            node->SetPosition(Vector3(Random(-100.0f, 100.0f), 0.0f, Random(-100.0f, 100.0f)));
+            auto* emitter = node->CreateComponent<ParticleEmitter>();
+            emitter->SetEffect(effect);
+            emitters_.push_back(emitter);
+        }
+    }
+
+    /// Return number of particles active in all emitters.
+    unsigned CountActiveParticles() const
+    {
+        unsigned count = 0;
+        for (ParticleEmitter* emitter : emitters_)
+        {
+            for (const Billboard& billboard : emitter->GetBillboards())
+                count += billboard.enabled_ ? 1 : 0;
+        }
+        return count;
+    }
+
+    /// Simulation time step.
+    static constexpr float TIME_STEP = 1.0f / 60.0f;
+
+    /// Number of particle emitters.
+    int numEmitters_ = 500;
+    /// Maximum number of particles per emitter.
+    int numParticles_ = 1000;
+    /// Number of measured frames.
+    int numFrames_ = 300;
+    /// Number of frames simulated before measuring.
+    int numWarmupFrames_ = 60;
+
+    /// Benchmark scene.
+    SharedPtr<Scene> scene_;
+    /// Particle emitters.
+    ea::vector<ParticleEmitter*> emitters_;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::ParticleBenchmark);
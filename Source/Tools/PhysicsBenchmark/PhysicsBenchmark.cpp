@@ -0,0 +1,308 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <EASTL/sort.h>
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsEvents.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <BenchmarkApplication.h>
+
+namespace Urho3D
+{
+
+/// Time step of a frame.
+static const float FRAME_TIME_STEP = 1.0f / 60.0f;
+/// Size of the boxes.
+static const float BOX_SIZE = 1.0f;
+/// Number of measurement rounds. Each round runs every delivery mode in turn and the fastest round of a mode is reported.
+static const unsigned NUM_ROUNDS = 5;
+
+/// Way collisions are delivered in a measured run.
+enum class DeliveryMode
+{
+    /// No collision delivery. Measures the simulation alone.
+    None,
+    /// Per-pair VariantMap collision events.
+    Events,
+    /// Batched contacts with a single event per step.
+    Batched
+};
+
+/// Return name of a delivery mode.
+static const char* GetDeliveryModeName(DeliveryMode mode)
+{
+    switch (mode)
+    {
+    case DeliveryMode::Events: return "Events";
+    case DeliveryMode::Batched: return "Batched";
+    default: return "None";
+    }
+}
+
+/// Piles up boxes on the ground until they come to rest, so that every step reports thousands of resting contacts. Then
+/// measures the frame time without collision delivery, with per-pair collision events and with batched contacts, checks
+/// that both ways report the same colliding bodies and prints the cost of the delivery.
+class PhysicsBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(PhysicsBenchmark, BenchmarkApplication);
+public:
+    explicit PhysicsBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--boxes", numBoxes_, "Number of boxes in the pile.");
+        cmd.add_option("--settle-frames", numSettleFrames_, "Number of frames simulated before measuring, so that the pile comes to rest.");
+        cmd.add_option("--frames", numFrames_, "Number of measured frames per delivery mode and round.");
+    }
+
+    void RunBenchmark() override
+    {
+        numBoxes_ = Max(numBoxes_, 1U);
+        numFrames_ = Max(numFrames_, 1U);
+
+        scene_ = new Scene(context_);
+        physicsWorld_ = scene_->CreateComponent<PhysicsWorld>();
+        CreatePile();
+
+        SubscribeToEvent(E_PHYSICSCOLLISION, [this](StringHash, VariantMap& eventData)
+        {
+            using namespace PhysicsCollision;
+            numDeliveredPoints_ += eventData[P_CONTACTS].GetBuffer().size() / (2 * sizeof(Vector3) + 2 * sizeof(float));
+        });
+        SubscribeToEvent(E_PHYSICSCONTACTS, [this](StringHash, VariantMap& eventData)
+        {
+            for (const PhysicsContactPair& pair : physicsWorld_->GetContactPairs())
+                numDeliveredPoints_ += pair.numPoints_;
+        });
+
+        SetDeliveryMode(DeliveryMode::None);
+        for (unsigned i = 0; i < numSettleFrames_; ++i)
+            physicsWorld_->Update(FRAME_TIME_STEP);
+
+        CheckContacts();
+
+        unsigned numSleeping = 0;
+        for (RigidBody* body : boxes_)
+        {
+            if (!body->IsActive())
+                ++numSleeping;
+        }
+
+        // Interleave the modes, so that a slow phase of the machine does not favour one of them
+        const DeliveryMode modes[] = { DeliveryMode::None, DeliveryMode::Events, DeliveryMode::Batched };
+        double frameTimes[] = { M_INFINITY, M_INFINITY, M_INFINITY };
+        unsigned numPoints[] = { 0, 0, 0 };
+        for (unsigned round = 0; round < NUM_ROUNDS; ++round)
+        {
+            for (unsigned i = 0; i < 3; ++i)
+                frameTimes[i] = Min(frameTimes[i], RunFrames(modes[i], numPoints[i]));
+        }
+
+        PrintLine(Format("Physics benchmark: {} boxes, {} asleep, {} contact pairs, best of {} rounds of {} frames", numBoxes_,
+            numSleeping, numContactPairs_, NUM_ROUNDS, numFrames_));
+        PrintLine("Mode    | Frame ms | Delivery ms | Points/frame");
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            const ea::string deliveryTime = i == 0 ? ea::string("-") : Format("{:.3f}", frameTimes[i] - frameTimes[0]);
+            PrintLine(Format("{:7} | {:8.3f} | {:>11} | {:12}", GetDeliveryModeName(modes[i]), frameTimes[i], deliveryTime,
+                numPoints[i]));
+        }
+
+        CheckRemoval();
+    }
+
+private:
+    /// Create the ground and a pile of boxes stacked in layers on top of it.
+    void CreatePile()
+    {
+        const unsigned side = Max(CeilToInt(Sqrt(numBoxes_ / 8.0f)), 1);
+        const float groundSize = side * BOX_SIZE * 4.0f;
+
+        Node* groundNode = scene_->CreateChild("Ground");
+        groundNode->SetPosition(Vector3(0.0f, -0.5f, 0.0f));
+        groundNode->CreateComponent<RigidBody>();
+        groundNode->CreateComponent<CollisionShape>()->SetBox(Vector3(groundSize, 1.0f, groundSize));
+
+        for (unsigned i = 0; i < numBoxes_; ++i)
+        {
+            const unsigned layer = i / (side * side);
+            const unsigned x = i % side;
+            const unsigned z = (i / side) % side;
+            // Offset every other layer, so that each box rests on several boxes below it
+            const float offset = (layer % 2) * BOX_SIZE * 0.5f;
+
+            Node* node = scene_->CreateChild("Box");
+            node->SetPosition(Vector3((x - side * 0.5f) * BOX_SIZE * 1.01f + offset, (layer + 0.5f) * BOX_SIZE * 1.01f,
+                (z - side * 0.5f) * BOX_SIZE * 1.01f + offset));
+            auto* body = node->CreateComponent<RigidBody>();
+            body->SetMass(1.0f);
+            // Report contacts of sleeping bodies too, otherwise a pile at rest has nothing to deliver
+            body->SetCollisionEventMode(COLLISION_ALWAYS);
+            node->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE * BOX_SIZE);
+            boxes_.push_back(body);
+        }
+    }
+
+    /// Enable the collision delivery of a mode.
+    void SetDeliveryMode(DeliveryMode mode)
+    {
+        physicsWorld_->SetCollisionEventsEnabled(mode == DeliveryMode::Events);
+        physicsWorld_->SetBatchedContactsEnabled(mode == DeliveryMode::Batched);
+    }
+
+    /// Simulate frames with the collision delivery of a mode and return the average frame time in milliseconds.
+    double RunFrames(DeliveryMode mode, unsigned& numPoints)
+    {
+        SetDeliveryMode(mode);
+        // The first frame after a mode change reports every pair as started
+        physicsWorld_->Update(FRAME_TIME_STEP);
+
+        numDeliveredPoints_ = 0;
+        HiresTimer timer;
+        for (unsigned i = 0; i < numFrames_; ++i)
+            physicsWorld_->Update(FRAME_TIME_STEP);
+        const double frameTime = timer.GetUSec(false) / 1000.0 / numFrames_;
+
+        numPoints = numDeliveredPoints_ / numFrames_;
+        return frameTime;
+    }
+
+    /// Simulate a frame with both ways of delivery and check that they report the same colliding bodies.
+    void CheckContacts()
+    {
+        physicsWorld_->SetCollisionEventsEnabled(true);
+        physicsWorld_->SetBatchedContactsEnabled(true);
+        physicsWorld_->Update(FRAME_TIME_STEP);
+
+        // GetCollidingBodies() reads the per-pair tracking while collision events are enabled
+        ea::vector<ea::vector<RigidBody*> > batchedBodies(boxes_.size());
+        for (const PhysicsContactPair& pair : physicsWorld_->GetContactPairs())
+        {
+            if (pair.state_ == CONTACT_END)
+                continue;
+
+            ++numContactPairs_;
+            RigidBody* bodyA = physicsWorld_->GetRigidBodyByIndex(pair.bodyA_);
+            RigidBody* bodyB = physicsWorld_->GetRigidBodyByIndex(pair.bodyB_);
+            if (!bodyA || !bodyB || bodyA->GetWorldIndex() != pair.bodyA_ || pair.bodyA_ >= pair.bodyB_)
+                ErrorExit("Batched contact pair refers to an invalid rigid body index\n");
+            if (pair.firstPoint_ + pair.numPoints_ > physicsWorld_->GetContactPoints().size())
+                ErrorExit("Batched contact pair refers to contact points out of range\n");
+
+            for (unsigned i = 0; i < boxes_.size(); ++i)
+            {
+                if (boxes_[i] == bodyA)
+                    batchedBodies[i].push_back(bodyB);
+                else if (boxes_[i] == bodyB)
+                    batchedBodies[i].push_back(bodyA);
+            }
+        }
+
+        ea::vector<RigidBody*> collidingBodies;
+        for (unsigned i = 0; i < boxes_.size(); ++i)
+        {
+            physicsWorld_->GetCollidingBodies(collidingBodies, boxes_[i]);
+            ea::quick_sort(collidingBodies.begin(), collidingBodies.end());
+            ea::quick_sort(batchedBodies[i].begin(), batchedBodies[i].end());
+            if (collidingBodies != batchedBodies[i])
+                ErrorExit(Format("Batched contacts of box {} differ from the collision events\n", i));
+        }
+    }
+
+    /// Remove some boxes and add new ones, which reuse the freed body indices, then check that the new boxes do not inherit
+    /// the contacts of the removed ones.
+    void CheckRemoval()
+    {
+        SetDeliveryMode(DeliveryMode::Batched);
+        physicsWorld_->Update(FRAME_TIME_STEP);
+
+        const unsigned numRemoved = Max(numBoxes_ / 10, 1U);
+        ea::vector<unsigned> removedIndices;
+        for (unsigned i = 0; i < numRemoved; ++i)
+        {
+            RigidBody* body = boxes_[i * boxes_.size() / numRemoved];
+            removedIndices.push_back(body->GetWorldIndex());
+            body->GetNode()->Remove();
+        }
+
+        // Contacts of the removed bodies must be marked invalid right away
+        for (const PhysicsContactPair& pair : physicsWorld_->GetContactPairs())
+        {
+            if (removedIndices.contains(pair.bodyA_) || removedIndices.contains(pair.bodyB_))
+                ErrorExit("Batched contact pair refers to a removed rigid body\n");
+        }
+
+        // Place the new bodies far away, so that they can not collide with anything
+        for (unsigned i = 0; i < numRemoved; ++i)
+        {
+            Node* node = scene_->CreateChild("Box");
+            node->SetPosition(Vector3(0.0f, 1000.0f + i * BOX_SIZE * 2.0f, 0.0f));
+            auto* body = node->CreateComponent<RigidBody>();
+            body->SetMass(1.0f);
+            body->SetCollisionEventMode(COLLISION_ALWAYS);
+            node->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE * BOX_SIZE);
+            if (!removedIndices.contains(body->GetWorldIndex()))
+                ErrorExit("Rigid body index of a removed body was not reused\n");
+        }
+
+        physicsWorld_->Update(FRAME_TIME_STEP);
+        for (const PhysicsContactPair& pair : physicsWorld_->GetContactPairs())
+        {
+            if (removedIndices.contains(pair.bodyA_) || removedIndices.contains(pair.bodyB_))
+                ErrorExit("New rigid body inherited batched contacts of a removed one\n");
+        }
+    }
+
+    /// Number of boxes in the pile.
+    unsigned numBoxes_ = 4000;
+    /// Number of frames simulated before measuring.
+    unsigned numSettleFrames_ = 300;
+    /// Number of measured frames per delivery mode.
+    unsigned numFrames_ = 100;
+    /// Scene.
+    SharedPtr<Scene> scene_;
+    /// Physics world.
+    PhysicsWorld* physicsWorld_{};
+    /// Rigid bodies of the boxes.
+    ea::vector<RigidBody*> boxes_;
+    /// Number of colliding body pairs after the pile has settled.
+    unsigned numContactPairs_{};
+    /// Number of contact points seen by the event handlers.
+    unsigned numDeliveredPoints_{};
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::PhysicsBenchmark);
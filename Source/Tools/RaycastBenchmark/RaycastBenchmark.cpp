@@ -0,0 +1,219 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Graphics/Drawable.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/OctreeQuery.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <BenchmarkApplication.h>
+
+namespace Urho3D
+{
+
+/// Half size of the world the boxes are placed in.
+static const float WORLD_HALF_SIZE = 500.0f;
+/// Maximum ray distance.
+static const float MAX_RAY_DISTANCE = 250.0f;
+/// Number of octree subdivision levels.
+static const unsigned OCTREE_LEVELS = 8;
+
+/// Drawable with an explicitly set world bounding box.
+class BenchmarkDrawable : public Drawable
+{
+    URHO3D_OBJECT(BenchmarkDrawable, Drawable);
+
+public:
+    /// Construct.
+    explicit BenchmarkDrawable(Context* context) :
+        Drawable(context, DRAWABLE_GEOMETRY)
+    {
+    }
+
+    /// Set world bounding box. Queues an octree update like a moved drawable would.
+    void SetBox(const BoundingBox& box)
+    {
+        box_ = box;
+        OnMarkedDirty(nullptr);
+    }
+
+protected:
+    /// Recalculate the world-space bounding box.
+    void OnWorldBoundingBoxUpdate() override { worldBoundingBox_ = box_; }
+
+private:
+    /// World bounding box.
+    BoundingBox box_;
+};
+
+/// Return a random position inside the world.
+static Vector3 CreateRandomPosition()
+{
+    return Vector3(Random(-WORLD_HALF_SIZE, WORLD_HALF_SIZE), Random(-WORLD_HALF_SIZE, WORLD_HALF_SIZE),
+        Random(-WORLD_HALF_SIZE, WORLD_HALF_SIZE));
+}
+
+/// Return a random box inside the world.
+static BoundingBox CreateRandomBox()
+{
+    const Vector3 center = CreateRandomPosition();
+    const Vector3 halfSize(Random(0.5f, 4.0f), Random(0.5f, 4.0f), Random(0.5f, 4.0f));
+    return BoundingBox(center - halfSize, center + halfSize);
+}
+
+/// Return whether two closest hits are the same.
+static bool CompareResults(const RayQueryResult& lhs, const RayQueryResult& rhs)
+{
+    return lhs.drawable_ == rhs.drawable_ && (lhs.distance_ == rhs.distance_ || (!lhs.drawable_ && !rhs.drawable_));
+}
+
+/// Cast each ray on its own and return the elapsed time in microseconds.
+static long long RunSingleRays(Octree* octree, const RayOctreeBatchQuery& batchQuery, ea::vector<RayQueryResult>& results)
+{
+    results.resize(batchQuery.rays_.size());
+    ea::vector<RayQueryResult> hits;
+    HiresTimer timer;
+    for (unsigned i = 0; i < batchQuery.rays_.size(); ++i)
+    {
+        RayOctreeQuery query(hits, batchQuery.rays_[i], batchQuery.level_, batchQuery.maxDistance_, batchQuery.drawableFlags_);
+        octree->RaycastSingle(query);
+        if (!hits.empty())
+            results[i] = hits.front();
+        else
+        {
+            results[i] = RayQueryResult();
+            results[i].distance_ = M_INFINITY;
+        }
+    }
+    return timer.GetUSec(false);
+}
+
+/// Cast all rays as a batch and return the elapsed time in microseconds.
+static long long RunBatchRays(Octree* octree, RayOctreeBatchQuery& batchQuery)
+{
+    HiresTimer timer;
+    octree->RaycastSingleBatch(batchQuery);
+    return timer.GetUSec(false);
+}
+
+/// Cast random rays one at a time and as a batch, check that the closest hits match and print the throughput.
+static void RunRays(Octree* octree, unsigned numRays)
+{
+    RayOctreeBatchQuery batchQuery(RAY_AABB, MAX_RAY_DISTANCE, DRAWABLE_GEOMETRY);
+    batchQuery.rays_.resize(numRays);
+    for (Ray& ray : batchQuery.rays_)
+        ray.Define(CreateRandomPosition(), Vector3(Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f)));
+
+    // The batch runs first, so that the single rays do not resolve the dirty bounding boxes for it
+    const long long batchTime = RunBatchRays(octree, batchQuery);
+    ea::vector<RayQueryResult> singleResults;
+    const long long singleTime = RunSingleRays(octree, batchQuery, singleResults);
+
+    unsigned numHits = 0;
+    for (unsigned i = 0; i < numRays; ++i)
+    {
+        if (!CompareResults(singleResults[i], batchQuery.results_[i]))
+            ErrorExit(Format("Batch raycast result {} differs from the single raycast\n", i));
+        if (singleResults[i].drawable_)
+            ++numHits;
+    }
+
+    PrintLine(Format("{:7} | {:7} | {:13.0f} | {:12.0f} | {:6.2f}x", numRays, numHits, numRays * 1000000.0 / Max(singleTime, 1LL),
+        numRays * 1000000.0 / Max(batchTime, 1LL), (double)singleTime / Max(batchTime, 1LL)));
+}
+
+/// Casts increasing numbers of random rays into an octree of boxes one at a time and as a batch, also with octree updates
+/// queued, checks that the closest hits match and prints the throughput.
+class RaycastBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(RaycastBenchmark, BenchmarkApplication);
+public:
+    explicit RaycastBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--boxes", numBoxes_, "Number of boxes in the octree.");
+        cmd.add_option("--min-rays", minRays_, "Smallest number of rays.");
+        cmd.add_option("--max-rays", maxRays_, "Largest number of rays.");
+        cmd.add_option("--threads", numThreads_, "Number of worker threads.");
+    }
+
+    void RunBenchmark() override
+    {
+        numBoxes_ = Max(numBoxes_, 1U);
+        minRays_ = Max(minRays_, 1U);
+        maxRays_ = Max(maxRays_, 1U);
+        CreateWorkQueue(numThreads_ + 1);
+
+        SetRandomSeed(1);
+        SharedPtr<Scene> scene(new Scene(context_));
+        auto* octree = scene->CreateComponent<Octree>();
+        octree->SetSize(BoundingBox(-WORLD_HALF_SIZE, WORLD_HALF_SIZE), OCTREE_LEVELS);
+
+        ea::vector<SharedPtr<BenchmarkDrawable> > drawables(numBoxes_);
+        for (SharedPtr<BenchmarkDrawable>& drawable : drawables)
+        {
+            drawable = new BenchmarkDrawable(context_);
+            // Set the box only after adding, so that the drawable gets queued for reinsertion from the root octant
+            octree->AddManualDrawable(drawable);
+            drawable->SetBox(CreateRandomBox());
+        }
+        FrameInfo frame{};
+        octree->Update(frame);
+
+        PrintLine(Format("Raycast benchmark: {} boxes, {} worker threads, closest hit by bounding box", numBoxes_, numThreads_));
+        PrintLine("Rays    | Hits    | Single rays/s | Batch rays/s | Speedup");
+        for (unsigned numRays = minRays_; numRays <= maxRays_; numRays *= 10)
+            RunRays(octree, numRays);
+
+        // Move some boxes without updating the octree. The batch must resolve their bounding boxes before the worker threads read them
+        for (unsigned i = 0; i < numBoxes_ / 100; ++i)
+            drawables[Rand() % numBoxes_]->SetBox(CreateRandomBox());
+        RunRays(octree, minRays_);
+        PrintLine("Last row was measured with 1% of the boxes queued for an octree update");
+    }
+
+private:
+    /// Number of boxes in the octree.
+    unsigned numBoxes_ = 100000;
+    /// Smallest number of rays.
+    unsigned minRays_ = 1000;
+    /// Largest number of rays.
+    unsigned maxRays_ = 100000;
+    /// Number of worker threads.
+    unsigned numThreads_ = GetNumLogicalCPUs() - 1;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::RaycastBenchmark);
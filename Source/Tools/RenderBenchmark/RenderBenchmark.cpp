@@ -0,0 +1,363 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Graphics/GraphicsEvents.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/Renderer.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/View.h>
+#include <Urho3D/Graphics/Viewport.h>
+#include <Urho3D/Graphics/Zone.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+#ifdef URHO3D_NULL
+#include <Urho3D/Graphics/GraphicsImpl.h>
+#endif
+
+#include <BenchmarkApplication.h>
+
+namespace Urho3D
+{
+
+/// Renders a procedural scene for a fixed number of frames and prints per-stage CPU timings.
+class RenderBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(RenderBenchmark, BenchmarkApplication);
+public:
+    explicit RenderBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+        runOverFrames_ = true;
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+        engineParameters_[EP_WINDOW_TITLE] = GetTypeName();
+        engineParameters_[EP_WINDOW_WIDTH] = 1280;
+        engineParameters_[EP_WINDOW_HEIGHT] = 720;
+        engineParameters_[EP_FULL_SCREEN] = false;
+        engineParameters_[EP_HEADLESS] = false;
+        engineParameters_[EP_VSYNC] = false;
+        engineParameters_[EP_FRAME_LIMITER] = false;
+        engineParameters_[EP_RESOURCE_PATHS] = "CoreData";
+        engineParameters_[EP_RESOURCE_PREFIX_PATHS] = ";..;../..";
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--frames", numFrames_, "Number of measured frames.");
+        cmd.add_option("--warmup", numWarmupFrames_, "Number of frames rendered before measuring.");
+        cmd.add_option("--grid", gridSize_, "Objects are placed on a grid of this size along each axis.");
+        cmd.add_option("--lights", numLights_, "Number of point lights.");
+        cmd.add_flag("--shadows", shadows_, "Enable shadows of the lights.");
+        cmd.add_flag("--no-instancing", noInstancing_, "Disable hardware instancing.");
+    }
+
+    void RunBenchmark() override
+    {
+        engine_->SetMaxFps(0);
+        engine_->SetMaxInactiveFps(0);
+
+        auto* renderer = GetSubsystem<Renderer>();
+        renderer->SetDrawShadows(shadows_);
+        renderer->SetDynamicInstancing(!noInstancing_);
+
+        CreateScene();
+
+        SubscribeToEvent(E_BEGINFRAME, std::bind(&RenderBenchmark::OnBeginFrame, this));
+        SubscribeToEvent(E_UPDATE, std::bind(&RenderBenchmark::OnUpdate, this));
+        SubscribeToEvent(E_BEGINVIEWUPDATE, [this](StringHash, VariantMap&) { stageTimer_.Reset(); });
+        SubscribeToEvent(E_ENDVIEWUPDATE, [this](StringHash, VariantMap&) { frameViewUpdateTime_ += stageTimer_.GetUSec(false); });
+        SubscribeToEvent(E_BEGINVIEWRENDER, [this](StringHash, VariantMap&) { stageTimer_.Reset(); });
+        SubscribeToEvent(E_ENDVIEWRENDER, [this](StringHash, VariantMap& eventData) { OnEndViewRender(eventData); });
+        SubscribeToEvent(E_BEGINRENDERING, [this](StringHash, VariantMap&) { renderTimer_.Reset(); });
+        SubscribeToEvent(E_ENDRENDERING, std::bind(&RenderBenchmark::OnEndRendering, this));
+        SubscribeToEvent(E_ENDFRAME, std::bind(&RenderBenchmark::OnEndFrame, this));
+    }
+
+private:
+    /// Timings and counters accumulated over the measured frames.
+    struct Totals
+    {
+        long long frame_{};
+        long long viewUpdate_{};
+        long long render_{};
+        long long viewRender_{};
+        ViewStageTimes stages_;
+        unsigned long long batches_{};
+        unsigned long long primitives_{};
+        unsigned long long geometries_{};
+        unsigned long long lights_{};
+        unsigned long long shadowMaps_{};
+#ifdef URHO3D_NULL
+        NullFrameStats graphics_;
+#endif
+    };
+
+    void CreateScene()
+    {
+        auto* cache = GetSubsystem<ResourceCache>();
+
+        scene_ = new Scene(context_);
+        scene_->CreateComponent<Octree>();
+
+        auto* zone = scene_->CreateComponent<Zone>();
+        zone->SetBoundingBox(BoundingBox(-1000.0f, 1000.0f));
+        zone->SetAmbientColor(Color(0.2f, 0.2f, 0.2f));
+
+        static const char* modelNames[] = { "Box", "Sphere", "Cone", "Cylinder", "Pyramid", "Torus", "TeaPot" };
+        const unsigned numModels = sizeof(modelNames) / sizeof(modelNames[0]);
+        Material* material = cache->GetResource<Material>("Materials/DefaultGrey.xml");
+
+        const float halfExtent = GetHalfExtent();
+        unsigned index = 0;
+        for (int x = 0; x < gridSize_; ++x)
+        {
+            for (int y = 0; y < gridSize_; ++y)
+            {
+                for (int z = 0; z < gridSize_; ++z)
+                {
+                    Node* node = scene_->CreateChild();
+                    node->SetPosition(Vector3(x * GRID_SPACING - halfExtent, y * GRID_SPACING - halfExtent, z * GRID_SPACING - halfExtent));
+                    node->SetRotation(Quaternion(index * 17.0f, index * 31.0f, 0.0f));
+
+                    auto* model = node->CreateComponent<StaticModel>();
+                    model->SetModel(cache->GetResource<Model>(ea::string("Models/") + modelNames[index % numModels] + ".mdl"));
+                    model->SetMaterial(material);
+                    model->SetCastShadows(true);
+                    ++index;
+                }
+            }
+        }
+
+        Node* sunNode = scene_->CreateChild("Sun");
+        sunNode->SetDirection(Vector3(0.3f, -1.0f, 0.5f));
+        auto* sun = sunNode->CreateComponent<Light>();
+        sun->SetLightType(LIGHT_DIRECTIONAL);
+        sun->SetCastShadows(true);
+
+        for (int i = 0; i < numLights_; ++i)
+        {
+            const float angle = 360.0f * i / numLights_;
+            Node* lightNode = scene_->CreateChild("Light");
+            lightNode->SetPosition(Vector3(Cos(angle) * halfExtent, 0.0f, Sin(angle) * halfExtent));
+            auto* light = lightNode->CreateComponent<Light>();
+            light->SetLightType(LIGHT_POINT);
+            light->SetRange(Max(halfExtent, 5.0f));
+            light->SetCastShadows(true);
+        }
+
+        cameraNode_ = scene_->CreateChild("Camera");
+        auto* camera = cameraNode_->CreateComponent<Camera>();
+        camera->SetFarClip(4.0f * halfExtent + 100.0f);
+
+        GetSubsystem<Renderer>()->SetViewport(0, new Viewport(context_, scene_, camera));
+    }
+
+    void OnBeginFrame()
+    {
+        frameTimer_.Reset();
+        frameViewUpdateTime_ = 0;
+        frameViewRenderTime_ = 0;
+        frameRenderTime_ = 0;
+        frameStageTimes_ = ViewStageTimes();
+    }
+
+    void OnUpdate()
+    {
+        // Orbit the camera with a fixed step so that every run culls the same sequence of views
+        const float distance = 1.5f * GetHalfExtent() + 10.0f;
+        const float angle = 360.0f * frameNumber_ / Max(numWarmupFrames_ + numFrames_, 1);
+        cameraNode_->SetPosition(Vector3(Cos(angle) * distance, 0.35f * distance, Sin(angle) * distance));
+        cameraNode_->LookAt(Vector3::ZERO);
+    }
+
+    void OnEndViewRender(VariantMap& eventData)
+    {
+        frameViewRenderTime_ += stageTimer_.GetUSec(false);
+
+        auto* view = static_cast<View*>(eventData[EndViewRender::P_VIEW].GetPtr());
+        const ViewStageTimes& stages = view->GetStageTimes();
+        frameStageTimes_.culling_ += stages.culling_;
+        frameStageTimes_.lightProcessing_ += stages.lightProcessing_;
+        frameStageTimes_.batchBuilding_ += stages.batchBuilding_;
+        frameStageTimes_.shadowSetup_ += stages.shadowSetup_;
+        frameStageTimes_.geometryUpdate_ += stages.geometryUpdate_;
+        frameStageTimes_.instancingFill_ += stages.instancingFill_;
+    }
+
+    void OnEndRendering()
+    {
+        frameRenderTime_ = renderTimer_.GetUSec(false);
+    }
+
+    void OnEndFrame()
+    {
+        const long long frameTime = frameTimer_.GetUSec(false);
+
+        if (frameNumber_ >= numWarmupFrames_)
+        {
+            auto* renderer = GetSubsystem<Renderer>();
+            totals_.frame_ += frameTime;
+            totals_.viewUpdate_ += frameViewUpdateTime_;
+            totals_.render_ += frameRenderTime_;
+            totals_.viewRender_ += frameViewRenderTime_;
+            ViewStageTimes& stages = totals_.stages_;
+            stages.culling_ += frameStageTimes_.culling_;
+            stages.lightProcessing_ += frameStageTimes_.lightProcessing_;
+            stages.batchBuilding_ += frameStageTimes_.batchBuilding_;
+            stages.shadowSetup_ += frameStageTimes_.shadowSetup_;
+            stages.geometryUpdate_ += frameStageTimes_.geometryUpdate_;
+            stages.instancingFill_ += frameStageTimes_.instancingFill_;
+            totals_.batches_ += renderer->GetNumBatches();
+            totals_.primitives_ += renderer->GetNumPrimitives();
+            totals_.geometries_ += renderer->GetNumGeometries();
+            totals_.lights_ += renderer->GetNumLights();
+            totals_.shadowMaps_ += renderer->GetNumShadowMaps();
+#ifdef URHO3D_NULL
+            const NullFrameStats& stats = GetSubsystem<Graphics>()->GetImpl()->GetLastFrameStats();
+            NullFrameStats& sum = totals_.graphics_;
+            sum.draws_ += stats.draws_;
+            sum.instancedDraws_ += stats.instancedDraws_;
+            sum.instances_ += stats.instances_;
+            sum.clears_ += stats.clears_;
+            sum.shaderChanges_ += stats.shaderChanges_;
+            sum.parameterUpdates_ += stats.parameterUpdates_;
+            sum.textureChanges_ += stats.textureChanges_;
+            sum.renderTargetChanges_ += stats.renderTargetChanges_;
+            sum.vertexBufferChanges_ += stats.vertexBufferChanges_;
+            sum.indexBufferChanges_ += stats.indexBufferChanges_;
+            sum.renderStateChanges_ += stats.renderStateChanges_;
+            sum.bufferUploadBytes_ += stats.bufferUploadBytes_;
+            sum.textureUploadBytes_ += stats.textureUploadBytes_;
+#endif
+        }
+
+        if (++frameNumber_ >= numWarmupFrames_ + numFrames_)
+        {
+            PrintResults();
+            FinishBenchmark();
+        }
+    }
+
+    void PrintResults()
+    {
+        const double frames = Max(numFrames_, 1);
+        const auto ms = [frames](long long usec) { return usec / frames / 1000.0; };
+        const auto avg = [frames](unsigned long long value) { return value / frames; };
+
+        PrintLine(Format("Render benchmark: {} graphics, {} objects, {} point lights, shadows {}, instancing {}",
+            GetSubsystem<Graphics>()->GetApiName(), gridSize_ * gridSize_ * gridSize_, numLights_, shadows_ ? "on" : "off",
+            noInstancing_ ? "off" : "on"));
+        PrintLine(Format("Measured {} frames after {} warmup frames, average per frame:", numFrames_, numWarmupFrames_));
+        PrintLine(Format("  Frame total            {:9.3f} ms", ms(totals_.frame_)));
+        PrintLine(Format("  Update (excl. views)   {:9.3f} ms", ms(totals_.frame_ - totals_.viewUpdate_ - totals_.render_)));
+        PrintLine(Format("  View update            {:9.3f} ms", ms(totals_.viewUpdate_)));
+        PrintLine(Format("    Culling              {:9.3f} ms", ms(totals_.stages_.culling_)));
+        PrintLine(Format("    Light processing     {:9.3f} ms", ms(totals_.stages_.lightProcessing_)));
+        PrintLine(Format("    Batch building       {:9.3f} ms", ms(totals_.stages_.batchBuilding_)));
+        PrintLine(Format("    Shadow setup         {:9.3f} ms", ms(totals_.stages_.shadowSetup_)));
+        PrintLine(Format("  Render                 {:9.3f} ms", ms(totals_.render_)));
+        PrintLine(Format("    View render          {:9.3f} ms", ms(totals_.viewRender_)));
+        PrintLine(Format("      Sort and geometry  {:9.3f} ms", ms(totals_.stages_.geometryUpdate_)));
+        PrintLine(Format("      Instancing fill    {:9.3f} ms", ms(totals_.stages_.instancingFill_)));
+        PrintLine(Format("  Batches                {:9.1f}", avg(totals_.batches_)));
+        PrintLine(Format("  Primitives             {:9.1f}", avg(totals_.primitives_)));
+        PrintLine(Format("  Geometries             {:9.1f}", avg(totals_.geometries_)));
+        PrintLine(Format("  Lights                 {:9.1f}", avg(totals_.lights_)));
+        PrintLine(Format("  Shadow maps            {:9.1f}", avg(totals_.shadowMaps_)));
+#ifdef URHO3D_NULL
+        const NullFrameStats& sum = totals_.graphics_;
+        PrintLine("Null graphics statistics, average per frame:");
+        PrintLine(Format("  Draws                  {:9.1f}", avg(sum.draws_)));
+        PrintLine(Format("  Instanced draws        {:9.1f}", avg(sum.instancedDraws_)));
+        PrintLine(Format("  Instances              {:9.1f}", avg(sum.instances_)));
+        PrintLine(Format("  Clears                 {:9.1f}", avg(sum.clears_)));
+        PrintLine(Format("  Shader changes         {:9.1f}", avg(sum.shaderChanges_)));
+        PrintLine(Format("  Parameter updates      {:9.1f}", avg(sum.parameterUpdates_)));
+        PrintLine(Format("  Texture changes        {:9.1f}", avg(sum.textureChanges_)));
+        PrintLine(Format("  Render target changes  {:9.1f}", avg(sum.renderTargetChanges_)));
+        PrintLine(Format("  Vertex buffer changes  {:9.1f}", avg(sum.vertexBufferChanges_)));
+        PrintLine(Format("  Index buffer changes   {:9.1f}", avg(sum.indexBufferChanges_)));
+        PrintLine(Format("  Render state changes   {:9.1f}", avg(sum.renderStateChanges_)));
+        PrintLine(Format("  Buffer uploads         {:9.1f} KB", avg(sum.bufferUploadBytes_) / 1024.0));
+        PrintLine(Format("  Texture uploads        {:9.1f} KB", avg(sum.textureUploadBytes_) / 1024.0));
+#endif
+    }
+
+    /// Return half of the grid extent along each axis.
+    float GetHalfExtent() const { return 0.5f * GRID_SPACING * (gridSize_ - 1); }
+
+    /// Distance between neighbouring objects.
+    static constexpr float GRID_SPACING = 2.0f;
+
+    /// Number of measured frames.
+    int numFrames_ = 300;
+    /// Number of frames rendered before measuring.
+    int numWarmupFrames_ = 30;
+    /// Grid size along each axis.
+    int gridSize_ = 16;
+    /// Number of point lights.
+    int numLights_ = 8;
+    /// Whether shadows are enabled.
+    bool shadows_ = false;
+    /// Whether hardware instancing is disabled.
+    bool noInstancing_ = false;
+
+    /// Benchmark scene.
+    SharedPtr<Scene> scene_;
+    /// Orbiting camera node.
+    WeakPtr<Node> cameraNode_;
+    /// Frames run so far, including warmup.
+    int frameNumber_ = 0;
+    /// Timer of the whole frame.
+    HiresTimer frameTimer_;
+    /// Timer of the graphics frame.
+    HiresTimer renderTimer_;
+    /// Timer of the current view update or render.
+    HiresTimer stageTimer_;
+    /// View update time of the current frame.
+    long long frameViewUpdateTime_ = 0;
+    /// View render time of the current frame.
+    long long frameViewRenderTime_ = 0;
+    /// Graphics frame time of the current frame.
+    long long frameRenderTime_ = 0;
+    /// View stage times of the current frame.
+    ViewStageTimes frameStageTimes_;
+    /// Accumulated results.
+    Totals totals_;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::RenderBenchmark);
@@ -0,0 +1,316 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Network/Connection.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Network/NetworkEvents.h>
+#include <Urho3D/Scene/Node.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <BenchmarkApplication.h>
+
+namespace Urho3D
+{
+
+/// Size of the square area the nodes move in.
+static const float AREA_SIZE = 500.0f;
+/// Maximum speed of the nodes.
+static const float MAX_SPEED = 4.0f;
+/// Maximum turning speed of the nodes in degrees per second.
+static const float MAX_TURN_SPEED = 90.0f;
+/// Time to wait for the client to connect and receive the scene.
+static const unsigned CONNECT_TIMEOUT_MSEC = 60000;
+/// Time to run before measuring, so that the initial scene transfer and acknowledgements are done.
+static const unsigned WARM_UP_MSEC = 2000;
+/// Margin outside the interest radius within which the server keeps nodes relevant. Matches the server's hysteresis.
+static const float INTEREST_HYSTERESIS = 1.1f;
+
+/// Replicates a scene of moving nodes from a server to a client in the same process over the loopback interface, with full precision and with quantized, delta compressed transforms, then with interest management around the client, and prints the bandwidth per client.
+class ReplicationBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(ReplicationBenchmark, BenchmarkApplication);
+public:
+    explicit ReplicationBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--nodes", numNodes_, "Number of replicated moving nodes.");
+        cmd.add_option("--seconds", numSeconds_, "Seconds measured per configuration.");
+        cmd.add_option("--update-fps", updateFps_, "Network updates per second.");
+        cmd.add_option("--interest-radius", interestRadius_, "Interest management radius around the client in the interest managed run.");
+        cmd.add_option("--port", port_, "Loopback port of the server.");
+    }
+
+    void RunBenchmark() override
+    {
+        auto* network = GetSubsystem<Network>();
+        CreateScene();
+
+        const AttributeInfo* positionInfo = context_->GetAttribute<Node>("Network Position");
+        const AttributeInfo* rotationInfo = context_->GetAttribute<Node>("Network Rotation");
+        gridCellSize_ = positionInfo->GetMetadata(AttributeMetadata::P_NET_GRID_CELL_SIZE);
+        positionBits_ = positionInfo->GetMetadata(AttributeMetadata::P_NET_QUANTIZE_BITS);
+        rotationBits_ = rotationInfo->GetMetadata(AttributeMetadata::P_NET_QUANTIZE_BITS);
+
+        SubscribeToEvent(E_CLIENTCONNECTED, [this](StringHash, VariantMap& eventData)
+        {
+            auto* connection = static_cast<Connection*>(eventData[ClientConnected::P_CONNECTION].GetPtr());
+            connection->SetInterestRadius(currentInterestRadius_);
+            connection->SetScene(serverScene_);
+        });
+        SubscribeToEvent(E_NETWORKUPDATESENT, [this](StringHash, VariantMap&) { ++numUpdates_; });
+
+        network->SetUpdateFps(updateFps_);
+        if (!network->StartServer(port_))
+            ErrorExit("Failed to start the server\n");
+
+        PrintLine(Format("Replication benchmark: {} moving nodes, {} network updates/s, {} s per configuration", numNodes_,
+            network->GetUpdateFps(), numSeconds_));
+        PrintLine("Configuration             | Nodes | Updates/s | Server out KB/s | Client in KB/s | Bytes per node update | Max error m | Max error deg");
+        RunConfiguration("Full precision", false, 0.0f);
+        RunConfiguration("Quantized, delta", true, 0.0f);
+        RunConfiguration(Format("Quantized, delta, {:g} m", interestRadius_), true, interestRadius_);
+
+        network->StopServer();
+    }
+
+private:
+    void CreateScene()
+    {
+        serverScene_ = new Scene(context_);
+
+        // Fixed seed, so that every run moves the nodes the same way
+        SetRandomSeed(1);
+        for (unsigned i = 0; i < numNodes_; ++i)
+        {
+            Node* node = serverScene_->CreateChild("Node");
+            node->SetPosition(Vector3(Random(-0.5f, 0.5f) * AREA_SIZE, Random(0.0f, 2.0f), Random(-0.5f, 0.5f) * AREA_SIZE));
+            node->SetRotation(Quaternion(Random(360.0f), Vector3::UP));
+            velocities_.push_back(Vector3(Random(-1.0f, 1.0f), 0.0f, Random(-1.0f, 1.0f)) * MAX_SPEED);
+            turnSpeeds_.push_back(Random(-1.0f, 1.0f) * MAX_TURN_SPEED);
+        }
+    }
+
+    void SetQuantization(bool enable)
+    {
+        // The node transform attributes are quantized only through metadata, removing it sends them at full precision
+        AttributeHandle position = context_->GetAttributeHandle<Node>("Network Position");
+        AttributeHandle rotation = context_->GetAttributeHandle<Node>("Network Rotation");
+        position.SetMetadata(AttributeMetadata::P_NET_GRID_CELL_SIZE, enable ? gridCellSize_ : Variant::EMPTY);
+        position.SetMetadata(AttributeMetadata::P_NET_QUANTIZE_BITS, enable ? positionBits_ : Variant::EMPTY);
+        rotation.SetMetadata(AttributeMetadata::P_NET_QUANTIZE_BITS, enable ? rotationBits_ : Variant::EMPTY);
+    }
+
+    void RunConfiguration(const ea::string& name, bool quantize, float interestRadius)
+    {
+        auto* network = GetSubsystem<Network>();
+        SetQuantization(quantize);
+        currentInterestRadius_ = interestRadius;
+
+        // A new connection for each configuration, so that no baselines are carried over
+        clientScene_ = new Scene(context_);
+        if (!network->Connect("127.0.0.1", port_, clientScene_))
+            ErrorExit("Failed to connect to the server\n");
+        // The client observes from the center of the area
+        network->GetServerConnection()->SetPosition(Vector3::ZERO);
+
+        // Keep the nodes still until the client has all the relevant ones
+        moving_ = false;
+        Timer timer;
+        while (!IsReplicated())
+        {
+            if (timer.GetMSec(false) > CONNECT_TIMEOUT_MSEC)
+                ErrorExit("Timed out waiting for the scene to replicate\n");
+            Step();
+        }
+        moving_ = true;
+
+        timer.Reset();
+        while (timer.GetMSec(false) < WARM_UP_MSEC)
+            Step();
+
+        // RakNet reports the bytes of the last second, so sample once per second
+        Connection* serverConnection = network->GetClientConnections().front();
+        Connection* clientConnection = network->GetServerConnection();
+        double bytesOut = 0.0;
+        double bytesIn = 0.0;
+        double numReplicatedNodes = 0.0;
+        unsigned numSamples = 0;
+        numUpdates_ = 0;
+        timer.Reset();
+        while (numSamples < numSeconds_)
+        {
+            Step();
+            if (timer.GetMSec(false) >= (numSamples + 1) * 1000)
+            {
+                bytesOut += serverConnection->GetBytesOutPerSec();
+                bytesIn += clientConnection->GetBytesInPerSec();
+                numReplicatedNodes += clientScene_->GetNumChildren();
+                ++numSamples;
+            }
+        }
+
+        const double seconds = timer.GetMSec(false) / 1000.0;
+        const double updatesPerSec = numUpdates_ / seconds;
+        const double bytesOutPerSec = bytesOut / numSamples;
+        const double averageNodes = numReplicatedNodes / numSamples;
+
+        // Stop the nodes and let the last updates arrive, then compare the client transforms against the server
+        moving_ = false;
+        timer.Reset();
+        while (timer.GetMSec(false) < WARM_UP_MSEC)
+            Step();
+        moving_ = true;
+
+        // The interest grid is updated incrementally from the moved nodes, so check the relevant set against the positions
+        if (interestRadius > 0.0f)
+        {
+            const Vector3 observerPosition = network->GetServerConnection()->GetPosition();
+            for (Node* serverNode : serverScene_->GetChildren())
+            {
+                const float distance = (serverNode->GetWorldPosition() - observerPosition).Length();
+                const bool replicated = clientScene_->GetNode(serverNode->GetID()) != nullptr;
+                // Nodes between the radius and the hysteresis margin may be either
+                if (distance <= interestRadius && !replicated)
+                    ErrorExit(Format("Node at {:.1f} m is within the interest radius but not replicated\n", distance));
+                if (distance > interestRadius * INTEREST_HYSTERESIS && replicated)
+                    ErrorExit(Format("Node at {:.1f} m is outside the interest radius but replicated\n", distance));
+            }
+        }
+
+        float maxDistance = 0.0f;
+        float maxAngle = 0.0f;
+        for (Node* clientNode : clientScene_->GetChildren())
+        {
+            Node* serverNode = serverScene_->GetNode(clientNode->GetID());
+            if (!serverNode)
+                ErrorExit("Node missing on the server\n");
+            maxDistance = Max(maxDistance, (clientNode->GetPosition() - serverNode->GetPosition()).Length());
+            // q and -q are the same rotation. The chord length is used, as acos is imprecise for small angles
+            const Quaternion& clientRotation = clientNode->GetRotation();
+            const Quaternion& serverRotation = serverNode->GetRotation();
+            const Quaternion difference = clientRotation.DotProduct(serverRotation) < 0.0f ?
+                clientRotation + serverRotation : clientRotation - serverRotation;
+            maxAngle = Max(maxAngle, 4.0f * Asin(Min(sqrtf(difference.LengthSquared()) * 0.5f, 1.0f)));
+        }
+
+        PrintLine(Format("{:25} | {:5.0f} | {:9.1f} | {:15.1f} | {:14.1f} | {:21.2f} | {:11.6f} | {:13.4f}", name, averageNodes,
+            updatesPerSec, bytesOutPerSec / 1024.0, bytesIn / numSamples / 1024.0,
+            bytesOutPerSec / Max(updatesPerSec * averageNodes, 1.0), maxDistance, maxAngle));
+
+        network->Disconnect();
+        timer.Reset();
+        while (!network->GetClientConnections().empty())
+        {
+            if (timer.GetMSec(false) > CONNECT_TIMEOUT_MSEC)
+                ErrorExit("Timed out waiting for the client to disconnect\n");
+            Step();
+        }
+    }
+
+    bool IsReplicated() const
+    {
+        auto* network = GetSubsystem<Network>();
+        const ea::vector<SharedPtr<Connection>> connections = network->GetClientConnections();
+        if (connections.empty() || !connections.front()->IsSceneLoaded())
+            return false;
+
+        // Relevant nodes are known after the first network update of the connection
+        const unsigned numRelevantNodes = connections.front()->IsInterestManaged() ?
+            connections.front()->GetNumRelevantNodes() : numNodes_;
+        return numRelevantNodes && clientScene_->GetNumChildren() == numRelevantNodes;
+    }
+
+    void Step()
+    {
+        if (!moving_)
+        {
+            engine_->RunFrame();
+            return;
+        }
+
+        const float timeStep = GetSubsystem<Time>()->GetTimeStep();
+        const float halfSize = AREA_SIZE * 0.5f;
+        const ea::vector<SharedPtr<Node>>& nodes = serverScene_->GetChildren();
+        for (unsigned i = 0; i < nodes.size(); ++i)
+        {
+            Node* node = nodes[i];
+            Vector3 position = node->GetPosition() + velocities_[i] * timeStep;
+            // Turn back at the area edges
+            if (Abs(position.x_) > halfSize)
+                velocities_[i].x_ = -velocities_[i].x_;
+            if (Abs(position.z_) > halfSize)
+                velocities_[i].z_ = -velocities_[i].z_;
+            node->SetPosition(position);
+            node->Yaw(turnSpeeds_[i] * timeStep);
+        }
+
+        engine_->RunFrame();
+    }
+
+    /// Number of replicated moving nodes.
+    unsigned numNodes_ = 5000;
+    /// Seconds measured per configuration.
+    unsigned numSeconds_ = 5;
+    /// Network updates per second.
+    int updateFps_ = 30;
+    /// Interest management radius around the client in the interest managed run.
+    float interestRadius_ = 100.0f;
+    /// Interest management radius of the current run, or 0 if not interest managed.
+    float currentInterestRadius_ = 0.0f;
+    /// Loopback port of the server.
+    unsigned short port_ = 2345;
+    /// Whether the nodes are moving.
+    bool moving_ = true;
+    /// Network updates sent during the measurement.
+    unsigned numUpdates_ = 0;
+    /// Registered grid cell size of the network position.
+    Variant gridCellSize_;
+    /// Registered quantization bits of the network position.
+    Variant positionBits_;
+    /// Registered quantization bits of the network rotation.
+    Variant rotationBits_;
+    /// Server scene.
+    SharedPtr<Scene> serverScene_;
+    /// Client scene.
+    SharedPtr<Scene> clientScene_;
+    /// Velocity of each node.
+    ea::vector<Vector3> velocities_;
+    /// Turning speed of each node in degrees per second.
+    ea::vector<float> turnSpeeds_;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::ReplicationBenchmark);
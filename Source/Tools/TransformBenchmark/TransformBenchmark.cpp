@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <BenchmarkApplication.h>
+
+namespace Urho3D
+{
+
+/// Scene with hierarchies of nodes and the nodes in creation order.
+struct TransformScene
+{
+    /// Scene.
+    SharedPtr<Scene> scene_;
+    /// Top-level nodes.
+    ea::vector<Node*> roots_;
+    /// All nodes except the scene.
+    ea::vector<Node*> nodes_;
+};
+
+/// Moves the roots of node hierarchies every frame and reads the world transform of every node, like a renderer would,
+/// once with the lazy world transform update on access and once with the batched update of the scene using increasing
+/// numbers of threads. Checks that both produce the same world transforms and prints the frame times.
+class TransformBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(TransformBenchmark, BenchmarkApplication);
+public:
+    explicit TransformBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--nodes", numNodes_, "Total number of nodes.");
+        cmd.add_option("--depth", depth_, "Number of levels in each hierarchy.");
+        cmd.add_option("--children", numChildren_, "Number of children of each node above the last level.");
+        cmd.add_option("--frames", numFrames_, "Number of measured frames.");
+    }
+
+    void RunBenchmark() override
+    {
+        depth_ = Max(depth_, 1U);
+        numChildren_ = Max(numChildren_, 1U);
+        numFrames_ = Max(numFrames_, 1U);
+
+        PrintLine(Format("Transform benchmark: {} nodes in hierarchies of {} levels with {} children per node, every root moved "
+            "each frame, {} frames", numNodes_, depth_, numChildren_, numFrames_));
+        PrintLine("Update                | Threads | ms per frame | Speedup");
+
+        TransformScene lazyScene = CreateScene(false);
+        const double lazyTime = RunFrames(lazyScene);
+        PrintLine(Format("Lazy on access        | {:7} | {:12.3f} | {:6.2f}x", 1, lazyTime, 1.0));
+
+        for (unsigned numThreads : GetThreadCounts())
+        {
+            CreateWorkQueue(numThreads);
+            TransformScene batchedScene = CreateScene(true);
+            const double batchedTime = RunFrames(batchedScene);
+            CompareScenes(lazyScene, batchedScene);
+            PrintLine(Format("Batched level arrays  | {:7} | {:12.3f} | {:6.2f}x", numThreads, batchedTime, lazyTime / batchedTime));
+        }
+    }
+
+private:
+    /// Create a scene with hierarchies until the node count is reached.
+    TransformScene CreateScene(bool batched)
+    {
+        TransformScene result;
+        result.scene_ = new Scene(context_);
+        result.scene_->SetBatchedTransformUpdate(batched);
+
+        while (result.nodes_.size() < numNodes_)
+        {
+            Node* root = result.scene_->CreateChild(EMPTY_STRING, LOCAL);
+            result.roots_.push_back(root);
+            result.nodes_.push_back(root);
+            CreateChildren(result, root, 1);
+        }
+        return result;
+    }
+
+    /// Create the children of a node down to the last level.
+    void CreateChildren(TransformScene& scene, Node* parent, unsigned level)
+    {
+        if (level >= depth_)
+            return;
+
+        for (unsigned i = 0; i < numChildren_ && scene.nodes_.size() < numNodes_; ++i)
+        {
+            Node* child = parent->CreateChild(EMPTY_STRING, LOCAL);
+            child->SetPosition(Vector3(1.0f + i, 0.5f, 0.0f));
+            child->SetRotation(Quaternion(15.0f * (i + 1), Vector3::UP));
+            child->SetScale(1.0f - 0.05f * level);
+            scene.nodes_.push_back(child);
+            CreateChildren(scene, child, level + 1);
+        }
+    }
+
+    /// Move the roots and read the world transform of every node for each frame. Return the average frame time in milliseconds.
+    double RunFrames(TransformScene& scene)
+    {
+        Scene* sceneNode = scene.scene_;
+        const bool batched = sceneNode->GetBatchedTransformUpdate();
+
+        // Settle the initial transforms, so that every measured frame does the same work
+        sceneNode->UpdateTransforms();
+        for (Node* node : scene.nodes_)
+            node->GetWorldTransform();
+
+        Vector3 sum;
+        HiresTimer timer;
+        for (unsigned frame = 0; frame < numFrames_; ++frame)
+        {
+            MoveRoots(scene, frame);
+            if (batched)
+                sceneNode->UpdateTransforms();
+
+            for (Node* node : scene.nodes_)
+                sum += node->GetWorldTransform().Translation();
+        }
+        const double frameTime = timer.GetUSec(false) / 1000.0 / numFrames_;
+
+        // Use the sum, so that the reads can not be optimized away
+        if (sum.IsNaN())
+            ErrorExit("World transforms are not finite\n");
+
+        // One more frame outside the measurement, checking that the batched update leaves nothing for the reads to do
+        MoveRoots(scene, numFrames_);
+        if (batched)
+        {
+            sceneNode->UpdateTransforms();
+            for (unsigned i = 0; i < scene.nodes_.size(); ++i)
+            {
+                if (scene.nodes_[i]->IsDirty())
+                    ErrorExit(Format("Node {} was left dirty by the batched update\n", i));
+            }
+        }
+        return frameTime;
+    }
+
+    /// Move and rotate the roots of the hierarchies for a frame.
+    void MoveRoots(TransformScene& scene, unsigned frame)
+    {
+        for (unsigned i = 0; i < scene.roots_.size(); ++i)
+        {
+            Node* root = scene.roots_[i];
+            root->SetPosition(Vector3(i * 0.1f, frame * 0.01f, (float)(i % 100)));
+            root->SetRotation(Quaternion(frame * 2.0f + i, Vector3::UP));
+        }
+    }
+
+    /// Check that the world transforms of two scenes built the same way and run for the same frames match.
+    void CompareScenes(const TransformScene& lhs, const TransformScene& rhs)
+    {
+        if (lhs.nodes_.size() != rhs.nodes_.size())
+            ErrorExit("Scenes have different numbers of nodes\n");
+
+        for (unsigned i = 0; i < lhs.nodes_.size(); ++i)
+        {
+            Node* lhsNode = lhs.nodes_[i];
+            Node* rhsNode = rhs.nodes_[i];
+            if (!lhsNode->GetWorldTransform().Equals(rhsNode->GetWorldTransform()) ||
+                !lhsNode->GetWorldRotation().Equals(rhsNode->GetWorldRotation()))
+                ErrorExit(Format("World transform of node {} differs between the lazy and the batched update\n", i));
+        }
+    }
+
+    /// Total number of nodes.
+    unsigned numNodes_ = 100000;
+    /// Number of levels in each hierarchy.
+    unsigned depth_ = 5;
+    /// Number of children of each node above the last level.
+    unsigned numChildren_ = 4;
+    /// Number of measured frames.
+    unsigned numFrames_ = 20;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::TransformBenchmark);
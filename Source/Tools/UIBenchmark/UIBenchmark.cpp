@@ -0,0 +1,153 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/UI/BorderImage.h>
+#include <Urho3D/UI/UI.h>
+
+#include <BenchmarkApplication.h>
+
+namespace Urho3D
+{
+
+/// Builds a large static UI layout and measures the batch generation with and without batch caching.
+class UIBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(UIBenchmark, BenchmarkApplication);
+public:
+    explicit UIBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--elements", numElements_, "Number of UI elements.");
+        cmd.add_option("--frames", numFrames_, "Number of measured frames per configuration.");
+        cmd.add_option("--animated", animatedPercent_, "Percentage of elements moved every frame in the animated runs.");
+    }
+
+    void RunBenchmark() override
+    {
+        // There is no window in headless mode, so use a fixed root size
+        GetSubsystem<UI>()->SetCustomSize(ROOT_WIDTH, ROOT_HEIGHT);
+        CreateUI();
+
+        PrintLine(Format("UI benchmark: {} elements, {} frames per configuration, average per frame:", numElements_, numFrames_));
+        PrintLine("  Caching  Animated  Update ms  Batches ms");
+        for (bool caching : {false, true})
+        {
+            RunFrames(caching, 0);
+            RunFrames(caching, animatedPercent_);
+        }
+    }
+
+private:
+    void CreateUI()
+    {
+        UIElement* root = GetSubsystem<UI>()->GetRoot();
+
+        // Panels of 50 elements each. Fonts have no faces in headless mode and texts would produce no batches, so the leaves
+        // are images of alternating sizes
+        const int numPanels = Max(numElements_ / ELEMENTS_PER_PANEL, 1);
+        const int panelsPerRow = Max(CeilToInt(Sqrt(static_cast<float>(numPanels))), 1);
+        const IntVector2 panelSize = root->GetSize() / panelsPerRow;
+        const IntVector2 cellSize = panelSize / 7;
+        for (int i = 0; i < numPanels; ++i)
+        {
+            auto* panel = root->CreateChild<BorderImage>();
+            panel->SetPosition(IntVector2(i % panelsPerRow, i / panelsPerRow) * panelSize);
+            panel->SetSize(panelSize);
+            panel->SetColor(Color(0.2f, 0.2f, 0.3f));
+
+            for (int j = 0; j < ELEMENTS_PER_PANEL - 1; ++j)
+            {
+                auto* image = panel->CreateChild<BorderImage>();
+                image->SetSize(j % 2 ? cellSize / 2 : cellSize - IntVector2::ONE);
+                image->SetColor(Color(0.5f, 0.5f, j / static_cast<float>(ELEMENTS_PER_PANEL)));
+                image->SetPosition(IntVector2(j % 7, j / 7) * cellSize);
+                leaves_.push_back(image);
+            }
+        }
+    }
+
+    void RunFrames(bool caching, int animatedPercent)
+    {
+        auto* ui = GetSubsystem<UI>();
+        ui->SetBatchCaching(caching);
+
+        // Every n-th leaf moves back and forth by one pixel each frame
+        const unsigned step = animatedPercent > 0 ? Max(100 / animatedPercent, 1) : 0;
+        long long updateTime = 0;
+        long long batchTime = 0;
+        HiresTimer timer;
+        for (int frame = -NUM_WARMUP_FRAMES; frame < numFrames_; ++frame)
+        {
+            timer.Reset();
+            for (unsigned i = 0; step && i < leaves_.size(); i += step)
+            {
+                const IntVector2 offset = frame % 2 ? IntVector2::RIGHT : IntVector2::LEFT;
+                leaves_[i]->SetPosition(leaves_[i]->GetPosition() + offset);
+            }
+            const long long frameUpdateTime = timer.GetUSec(true);
+
+            ui->RenderUpdate();
+            if (frame >= 0)
+            {
+                updateTime += frameUpdateTime;
+                batchTime += timer.GetUSec(false);
+            }
+        }
+
+        const double frames = Max(numFrames_, 1) * 1000.0;
+        PrintLine(Format("  {:7}  {:7}%  {:9.3f}  {:10.3f}", caching ? "on" : "off", animatedPercent, updateTime / frames,
+            batchTime / frames));
+    }
+
+    /// Width of the UI root element.
+    static const int ROOT_WIDTH = 1280;
+    /// Height of the UI root element.
+    static const int ROOT_HEIGHT = 720;
+    /// Number of elements in one panel, including the panel itself.
+    static const int ELEMENTS_PER_PANEL = 50;
+    /// Number of frames run before measuring each configuration.
+    static const int NUM_WARMUP_FRAMES = 10;
+
+    /// Number of UI elements.
+    int numElements_ = 5000;
+    /// Number of measured frames per configuration.
+    int numFrames_ = 200;
+    /// Percentage of elements moved every frame in the animated runs.
+    int animatedPercent_ = 10;
+    /// Leaf elements of the panels.
+    ea::vector<UIElement*> leaves_;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::UIBenchmark);
@@ -0,0 +1,244 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+
+#include <BenchmarkApplication.h>
+
+#include "BaselineWorkQueue.h"
+
+namespace Urho3D
+{
+
+/// Simulate a small unit of work.
+static unsigned RunTask(unsigned seed, unsigned work)
+{
+    unsigned value = seed;
+    for (unsigned i = 0; i < work; ++i)
+        value = value * 1664525u + 1013904223u;
+    return value;
+}
+
+/// Runs rounds of small tasks through the mutex-guarded WorkQueue from before work stealing and the work-stealing WorkQueue with increasing numbers of threads and prints the task throughput.
+class WorkQueueBenchmark : public BenchmarkApplication
+{
+    URHO3D_OBJECT(WorkQueueBenchmark, BenchmarkApplication);
+public:
+    explicit WorkQueueBenchmark(Context* context)
+        : BenchmarkApplication(context)
+    {
+    }
+
+    void Setup() override
+    {
+        BenchmarkApplication::Setup();
+
+        auto& cmd = GetCommandLineParser();
+        cmd.add_option("--tasks", numTasks_, "Number of tasks per round.");
+        cmd.add_option("--work", taskWork_, "Number of loop iterations in a single task.");
+        cmd.add_option("--rounds", numRounds_, "Number of rounds per measurement.");
+    }
+
+    void RunBenchmark() override
+    {
+        numTasks_ = Max(numTasks_, 1U);
+        numRounds_ = Max(numRounds_, 1U);
+        results_.resize(numTasks_);
+
+        if (!RunDependencyChecks())
+            ErrorExit("Work item dependency checks failed\n");
+
+        PrintLine(Format("Work queue benchmark: {} tasks x {} rounds, {} iterations per task", numTasks_, numRounds_, taskWork_));
+        PrintLine("Threads | Baseline queue tasks/s | WorkQueue tasks/s | ParallelFor tasks/s");
+        for (unsigned numThreads : GetThreadCounts())
+        {
+            const long long baselineUSec = RunBaseline(numThreads);
+
+            WorkQueue* queue = CreateWorkQueue(numThreads);
+            const long long workQueueUSec = RunWorkQueue(queue);
+            const long long parallelForUSec = RunParallelFor(queue);
+
+            PrintLine(Format("{:7} | {:22.0f} | {:17.0f} | {:19.0f}", numThreads, GetTasksPerSecond(baselineUSec),
+                GetTasksPerSecond(workQueueUSec), GetTasksPerSecond(parallelForUSec)));
+        }
+    }
+
+private:
+    /// Check that dependents are released by completed, pooled and removed dependencies, and run after all of them.
+    bool RunDependencyChecks()
+    {
+        bool success = true;
+
+        // Item depending on an item which has already completed and was returned to the pool must not wait for it
+        {
+            SharedPtr<WorkQueue> queue(new WorkQueue(context_));
+            queue->AddWorkItem([] {});
+            SharedPtr<WorkItem> dependency = queue->AddWorkItem([] {});
+            queue->Complete(0);
+
+            bool executed = false;
+            SharedPtr<WorkItem> dependent = queue->AddWorkItem([&executed] { executed = true; }, { dependency });
+            queue->Complete(0);
+
+            if (dependent == dependency || !executed)
+            {
+                PrintLine("Dependency on completed pooled item: FAILED", true);
+                success = false;
+            }
+        }
+
+        // Item depending on a removed item must be released
+        {
+            SharedPtr<WorkQueue> queue(new WorkQueue(context_));
+            SharedPtr<WorkItem> dependency = queue->AddWorkItem([] {});
+
+            bool executed = false;
+            queue->AddWorkItem([&executed] { executed = true; }, { dependency });
+            const bool removed = queue->RemoveWorkItem(dependency);
+            queue->Complete(0);
+
+            if (!removed || !executed)
+            {
+                PrintLine("Dependency on removed item: FAILED", true);
+                success = false;
+            }
+        }
+
+        // Same with batch removal
+        {
+            SharedPtr<WorkQueue> queue(new WorkQueue(context_));
+            ea::vector<SharedPtr<WorkItem> > dependencies;
+            dependencies.push_back(queue->AddWorkItem([] {}));
+            dependencies.push_back(queue->AddWorkItem([] {}));
+
+            bool executed = false;
+            queue->AddWorkItem([&executed] { executed = true; }, dependencies);
+            const unsigned removed = queue->RemoveWorkItems(dependencies);
+            queue->Complete(0);
+
+            if (removed != dependencies.size() || !executed)
+            {
+                PrintLine("Dependency on batch removed items: FAILED", true);
+                success = false;
+            }
+        }
+
+        // Continuations on worker threads: a chain must run in order, and an item depending on many items after all of them
+        {
+            SharedPtr<WorkQueue> queue(new WorkQueue(context_));
+            queue->CreateThreads(3);
+
+            const unsigned numItems = 256;
+            ea::vector<unsigned> chainOrder;
+            SharedPtr<WorkItem> previous = queue->AddWorkItem([&chainOrder] { chainOrder.push_back(0); });
+            for (unsigned i = 1; i < numItems; ++i)
+                previous = queue->AddWorkItem([&chainOrder, i] { chainOrder.push_back(i); }, { previous });
+
+            std::atomic<unsigned> numCompleted{};
+            ea::vector<SharedPtr<WorkItem> > dependencies;
+            for (unsigned i = 0; i < numItems; ++i)
+                dependencies.push_back(queue->AddWorkItem([&numCompleted] { ++numCompleted; }));
+            unsigned numCompletedBefore = 0;
+            queue->AddWorkItem([&numCompleted, &numCompletedBefore] { numCompletedBefore = numCompleted; }, dependencies);
+            queue->Complete(0);
+
+            bool ordered = chainOrder.size() == numItems;
+            for (unsigned i = 0; ordered && i < numItems; ++i)
+                ordered = chainOrder[i] == i;
+            if (!ordered)
+            {
+                PrintLine("Dependency chain order: FAILED", true);
+                success = false;
+            }
+            if (numCompletedBefore != numItems)
+            {
+                PrintLine("Dependency on many items: FAILED", true);
+                success = false;
+            }
+        }
+
+        return success;
+    }
+
+    long long RunBaseline(unsigned numThreads)
+    {
+        SharedPtr<Baseline::WorkQueue> queue(new Baseline::WorkQueue(context_));
+        queue->CreateThreads(numThreads - 1);
+
+        HiresTimer timer;
+        for (unsigned round = 0; round < numRounds_; ++round)
+        {
+            for (unsigned i = 0; i < numTasks_; ++i)
+                queue->AddWorkItem([this, i] { results_[i] = RunTask(i, taskWork_); });
+            queue->Complete(0);
+        }
+        return timer.GetUSec(false);
+    }
+
+    long long RunWorkQueue(WorkQueue* queue)
+    {
+        HiresTimer timer;
+        for (unsigned round = 0; round < numRounds_; ++round)
+        {
+            for (unsigned i = 0; i < numTasks_; ++i)
+                queue->AddWorkItem([this, i] { results_[i] = RunTask(i, taskWork_); });
+            queue->Complete(0);
+        }
+        return timer.GetUSec(false);
+    }
+
+    long long RunParallelFor(WorkQueue* queue)
+    {
+        HiresTimer timer;
+        for (unsigned round = 0; round < numRounds_; ++round)
+        {
+            queue->ParallelFor(numTasks_, 16, [this](unsigned begin, unsigned end, unsigned)
+            {
+                for (unsigned i = begin; i < end; ++i)
+                    results_[i] = RunTask(i, taskWork_);
+            });
+        }
+        return timer.GetUSec(false);
+    }
+
+    double GetTasksPerSecond(long long usec) const
+    {
+        return static_cast<double>(numTasks_) * numRounds_ * 1000000.0 / Max(usec, 1LL);
+    }
+
+    /// Number of tasks per round.
+    unsigned numTasks_ = 4000;
+    /// Number of loop iterations in a single task.
+    unsigned taskWork_ = 256;
+    /// Number of rounds per measurement.
+    unsigned numRounds_ = 20;
+    /// Task results, so that the work can not be optimized away.
+    ea::vector<unsigned> results_;
+};
+
+}
+
+URHO3D_DEFINE_APPLICATION_MAIN(Urho3D::WorkQueueBenchmark);
@@ -22,6 +22,8 @@
 
 #include "../Precompiled.h"
 
+#include <EASTL/sort.h>
+
 #include "../Audio/Audio.h"
 #include "../Audio/Sound.h"
 #include "../Audio/SoundListener.h"
@@ -34,6 +36,10 @@
 
 #include <SDL/SDL.h>
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 #ifdef _MSC_VER
@@ -50,6 +56,24 @@ static const int MIN_MIXRATE = 11025;
 static const int MAX_MIXRATE = 48000;
 static const StringHash SOUND_MASTER_HASH("Master");
 
+/// Convert the floating point clip buffer to 16-bit output with saturation.
+static void ClipToOutput(const float* src, short* dest, unsigned count)
+{
+    unsigned i = 0;
+#ifdef URHO3D_SSE
+    const __m128 minValue = _mm_set1_ps(-32768.0f);
+    const __m128 maxValue = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i lo = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), minValue), maxValue));
+        __m128i hi = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), minValue), maxValue));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < count; ++i)
+        dest[i] = (short)Clamp(src[i], -32768.0f, 32767.0f);
+}
+
 static void SDLAudioCallback(void* userdata, Uint8* stream, int len);
 
 Audio::Audio(Context* context) :
@@ -112,13 +136,7 @@ bool Audio::SetMode(int bufferLengthMSec, int mixRate, bool stereo, bool interpo
         return false;
     }
 
-    stereo_ = obtained.channels == 2;
-    sampleSize_ = (unsigned)(stereo_ ? sizeof(int) : sizeof(short));
-    // Guarantee a fragment size that is low enough so that Vorbis decoding buffers do not wrap
-    fragmentSize_ = Min(NextPowerOfTwo((unsigned)mixRate >> 6u), (unsigned)obtained.samples);
-    mixRate_ = obtained.freq;
-    interpolation_ = interpolation;
-    clipBuffer_.reset(new int[stereo ? fragmentSize_ << 1u : fragmentSize_]);
+    SetMixFormat(obtained.freq, obtained.channels == 2, interpolation, obtained.samples);
 
     URHO3D_LOGINFO("Set audio mode " + ea::to_string(mixRate_) + " Hz " + (stereo_ ? "stereo" : "mono") + " " +
             (interpolation_ ? "interpolated" : ""));
@@ -126,6 +144,35 @@ bool Audio::SetMode(int bufferLengthMSec, int mixRate, bool stereo, bool interpo
     return Play();
 }
 
+bool Audio::SetOfflineMode(int mixRate, bool stereo, bool interpolation)
+{
+    Release();
+
+    mixRate = Clamp(mixRate, MIN_MIXRATE, MAX_MIXRATE);
+    SetMixFormat(mixRate, stereo, interpolation, M_MAX_UNSIGNED);
+
+    URHO3D_LOGINFO("Set offline audio mode " + ea::to_string(mixRate_) + " Hz " + (stereo_ ? "stereo" : "mono") + " " +
+            (interpolation_ ? "interpolated" : ""));
+
+    // There is no device to resume, so just mark as playing to enable mixing
+    UpdateInternal(0.0f);
+    playing_ = true;
+    return true;
+}
+
+void Audio::SetMixFormat(int mixRate, bool stereo, bool interpolation, unsigned maxFragmentSize)
+{
+    stereo_ = stereo;
+    sampleSize_ = (unsigned)(stereo_ ? sizeof(int) : sizeof(short));
+    // Guarantee a fragment size that is low enough so that Vorbis decoding buffers do not wrap
+    fragmentSize_ = Min(NextPowerOfTwo((unsigned)mixRate >> 6u), maxFragmentSize);
+    mixRate_ = mixRate;
+    interpolation_ = interpolation;
+    clipBuffer_.reset(new float[stereo_ ? fragmentSize_ << 1u : fragmentSize_]);
+    // Sources may be stereo even if the output is not
+    resampleBuffer_.reset(new float[fragmentSize_ << 1u]);
+}
+
 void Audio::Update(float timeStep)
 {
     if (!playing_)
@@ -189,6 +236,12 @@ void Audio::ResumeAll()
     UpdateInternal(0.0f);
 }
 
+void Audio::SetMaxVoices(unsigned voices)
+{
+    MutexLock lock(audioMutex_);
+    maxVoices_ = voices;
+}
+
 void Audio::SetListener(SoundListener* listener)
 {
     listener_ = listener;
@@ -227,6 +280,9 @@ void Audio::AddSoundSource(SoundSource* soundSource)
 {
     MutexLock lock(audioMutex_);
     soundSources_.push_back(soundSource);
+    // Voice lists are filled in the mixing thread, which must not allocate
+    mixedVoices_.reserve(soundSources_.size());
+    virtualVoices_.reserve(soundSources_.size());
 }
 
 void Audio::RemoveSoundSource(SoundSource* soundSource)
@@ -271,6 +327,8 @@ void Audio::MixOutput(void* dest, unsigned samples)
         return;
     }
 
+    SelectVoices();
+
     while (samples)
     {
         // If sample count exceeds the fragment (clip buffer) size, split the work
@@ -280,32 +338,52 @@ void Audio::MixOutput(void* dest, unsigned samples)
             clipSamples <<= 1;
 
         // Clear clip buffer
-        int* clipPtr = clipBuffer_.get();
-        memset(clipPtr, 0, clipSamples * sizeof(int));
+        float* clipPtr = clipBuffer_.get();
+        memset(clipPtr, 0, clipSamples * sizeof(float));
 
         // Mix samples to clip buffer
-        for (auto i = soundSources_.begin(); i != soundSources_.end(); ++i)
-        {
-            SoundSource* source = *i;
-
-            // Check for pause if necessary
-            if (!pausedSoundTypes_.empty())
-            {
-                if (pausedSoundTypes_.contains(source->GetSoundType()))
-                    continue;
-            }
-
+        for (SoundSource* source : mixedVoices_)
             source->Mix(clipPtr, workSamples, mixRate_, stereo_, interpolation_);
-        }
+        for (SoundSource* source : virtualVoices_)
+            source->MixVirtual(workSamples, mixRate_);
+
         // Copy output from clip buffer to destination
-        auto* destPtr = (short*)dest;
-        while (clipSamples--)
-            *destPtr++ = (short)Clamp(*clipPtr++, -32768, 32767);
+        ClipToOutput(clipPtr, (short*)dest, clipSamples);
         samples -= workSamples;
         ((unsigned char*&)dest) += sampleSize_ * workSamples;
     }
 }
 
+void Audio::SelectVoices()
+{
+    mixedVoices_.clear();
+    virtualVoices_.clear();
+
+    for (SoundSource* source : soundSources_)
+    {
+        // Check for pause if necessary
+        if (!pausedSoundTypes_.empty())
+        {
+            if (pausedSoundTypes_.contains(source->GetSoundType()))
+                continue;
+        }
+
+        if (source->IsPlaying())
+            mixedVoices_.push_back(source);
+    }
+
+    // Keep the most audible voices mixed, virtualize the rest
+    if (maxVoices_ && mixedVoices_.size() > maxVoices_)
+    {
+        ea::nth_element(mixedVoices_.begin(), mixedVoices_.begin() + maxVoices_, mixedVoices_.end(),
+            [](SoundSource* lhs, SoundSource* rhs) { return lhs->GetAudibility() > rhs->GetAudibility(); });
+        virtualVoices_.assign(mixedVoices_.begin() + maxVoices_, mixedVoices_.end());
+        mixedVoices_.resize(maxVoices_);
+    }
+
+    numVirtualVoices_ = virtualVoices_.size();
+}
+
 void Audio::HandleRenderUpdate(StringHash eventType, VariantMap& eventData)
 {
     using namespace RenderUpdate;
@@ -321,8 +399,10 @@ void Audio::Release()
     {
         SDL_CloseAudioDevice(deviceID_);
         deviceID_ = 0;
-        clipBuffer_.reset();
     }
+
+    clipBuffer_.reset();
+    resampleBuffer_.reset();
 }
 
 void Audio::UpdateInternal(float timeStep)
@@ -50,6 +50,8 @@ public:
 
     /// Initialize sound output with specified buffer length and output mode.
     bool SetMode(int bufferLengthMSec, int mixRate, bool stereo, bool interpolation = true);
+    /// Initialize mixing without an output device. MixOutput can then be called directly, e.g. for offline rendering or mixer benchmarks.
+    bool SetOfflineMode(int mixRate, bool stereo, bool interpolation = true);
     /// Run update on sound sources. Not required for continued playback, but frees unused sound sources & sounds and updates 3D positions.
     void Update(float timeStep);
     /// Restart sound output.
@@ -68,6 +70,8 @@ public:
     void SetListener(SoundListener* listener);
     /// Stop any sound source playing a certain sound clip.
     void StopSound(Sound* sound);
+    /// Set maximum number of mixed voices. When more sound sources are playing, the least audible ones are virtualized: their playback advances without being mixed. Zero (default) is unlimited.
+    void SetMaxVoices(unsigned voices);
 
     /// Return byte size of one sample.
     unsigned GetSampleSize() const { return sampleSize_; }
@@ -78,6 +82,12 @@ public:
     /// Return whether output is interpolated.
     bool GetInterpolation() const { return interpolation_; }
 
+    /// Return maximum number of mixed voices.
+    unsigned GetMaxVoices() const { return maxVoices_; }
+
+    /// Return number of voices virtualized during the last mix.
+    unsigned GetNumVirtualVoices() const { return numVirtualVoices_; }
+
     /// Return whether output is stereo.
     bool IsStereo() const { return stereo_; }
 
@@ -107,13 +117,19 @@ public:
     /// Remove a sound source. Called by SoundSource.
     void RemoveSoundSource(SoundSource* soundSource);
 
+    /// Return clip buffer size in samples. Mixing is done in parts of at most this many samples.
+    unsigned GetFragmentSize() const { return fragmentSize_; }
+
+    /// Return scratch buffer for resampling sound source data in the mixing thread. Holds stereo data for one fragment.
+    float* GetResampleBuffer() const { return resampleBuffer_.get(); }
+
     /// Return audio thread mutex.
     Mutex& GetMutex() { return audioMutex_; }
 
     /// Return sound type specific gain multiplied by master gain.
     float GetSoundSourceMasterGain(StringHash typeHash) const;
 
-    /// Mix sound sources into the buffer.
+    /// Mix sound sources into the buffer. The audio mutex should be held by the caller.
     void MixOutput(void* dest, unsigned samples);
 
 private:
@@ -123,9 +139,15 @@ private:
     void Release();
     /// Actually update sound sources with the specific timestep. Called internally.
     void UpdateInternal(float timeStep);
+    /// Set mixing parameters and allocate the clipping and resampling buffers. Called internally.
+    void SetMixFormat(int mixRate, bool stereo, bool interpolation, unsigned maxFragmentSize);
+    /// Sort sound sources into mixed and virtualized voices. Called internally.
+    void SelectVoices();
 
     /// Clipping buffer for mixing.
-    ea::unique_ptr<int[]> clipBuffer_;
+    ea::unique_ptr<float[]> clipBuffer_;
+    /// Scratch buffer for resampling sound source data before mixing.
+    ea::unique_ptr<float[]> resampleBuffer_;
     /// Audio thread mutex.
     Mutex audioMutex_;
     /// SDL audio device ID.
@@ -148,6 +170,14 @@ private:
     ea::hash_set<StringHash> pausedSoundTypes_;
     /// Sound sources.
     ea::vector<SoundSource*> soundSources_;
+    /// Sound sources mixed during the current output.
+    ea::vector<SoundSource*> mixedVoices_;
+    /// Sound sources virtualized during the current output.
+    ea::vector<SoundSource*> virtualVoices_;
+    /// Maximum number of mixed voices, zero for unlimited.
+    unsigned maxVoices_{};
+    /// Number of voices virtualized during the last mix.
+    unsigned numVirtualVoices_{};
     /// Sound listener.
     WeakPtr<SoundListener> listener_;
 };
@@ -33,6 +33,10 @@
 #include "../Scene/Node.h"
 #include "../Scene/ReplicationState.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -96,6 +100,209 @@ namespace Urho3D
 
 static const int STREAM_SAFETY_SAMPLES = 4;
 
+/// Minimum total gain at which a sound source is mixed. Quieter sources only advance their playback position.
+static const float MIN_AUDIBLE_GAIN = 0.5f / 256.0f;
+
+/// Convert 16-bit source samples to float.
+static void ConvertSamples(const short* src, float* dest, unsigned count)
+{
+    unsigned i = 0;
+#ifdef URHO3D_SSE
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+        _mm_storeu_ps(dest + i, _mm_cvtepi32_ps(lo));
+        _mm_storeu_ps(dest + i + 4, _mm_cvtepi32_ps(hi));
+    }
+#endif
+    for (; i < count; ++i)
+        dest[i] = (float)src[i];
+}
+
+/// Convert 8-bit source samples to float in the 16-bit range.
+static void ConvertSamples(const signed char* src, float* dest, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i)
+        dest[i] = (float)src[i] * 256.0f;
+}
+
+/// Resample mono or interleaved stereo source data to float frames. Return number of frames written, which is less than requested if a one-shot sound ends.
+template <class T, bool Stereo, bool Looped, bool Interpolate>
+static unsigned ResampleSamples(T*& pos, int& fractPos, T* end, T* repeat, int intAdd, int fractAdd, float* dest, unsigned samples)
+{
+    const float scale = sizeof(T) == 1 ? 256.0f : 1.0f;
+    const unsigned channels = Stereo ? 2 : 1;
+    float* start = dest;
+
+    // Playback at the mixing rate is a plain conversion of contiguous source data
+    if (intAdd == 1 && fractAdd == 0 && fractPos == 0)
+    {
+        while (samples)
+        {
+            const unsigned count = Min(samples, (unsigned)(end - pos) / channels);
+            if (!count)
+                break;
+
+            ConvertSamples(pos, dest, count * channels);
+            pos += count * channels;
+            dest += count * channels;
+            samples -= count;
+
+            if (pos >= end)
+            {
+                if (!Looped)
+                {
+                    pos = nullptr;
+                    return (unsigned)(dest - start) / channels;
+                }
+                while (pos >= end)
+                    pos -= (end - repeat);
+            }
+        }
+    }
+
+    while (samples--)
+    {
+        if constexpr (Stereo)
+        {
+            if constexpr (Interpolate)
+            {
+                dest[0] = (float)GET_IP_SAMPLE_LEFT() * scale;
+                dest[1] = (float)GET_IP_SAMPLE_RIGHT() * scale;
+            }
+            else
+            {
+                dest[0] = (float)pos[0] * scale;
+                dest[1] = (float)pos[1] * scale;
+            }
+            dest += 2;
+
+            if constexpr (Looped)
+            {
+                INC_POS_STEREO_LOOPED();
+            }
+            else
+            {
+                INC_POS_STEREO_ONESHOT();
+            }
+        }
+        else
+        {
+            if constexpr (Interpolate)
+                *dest = (float)GET_IP_SAMPLE() * scale;
+            else
+                *dest = (float)*pos * scale;
+            ++dest;
+
+            if constexpr (Looped)
+            {
+                INC_POS_LOOPED();
+            }
+            else
+            {
+                INC_POS_ONESHOT();
+            }
+        }
+    }
+
+    return (unsigned)(dest - start) / channels;
+}
+
+/// Resample a sound from the playback position, advancing the position.
+template <class T>
+static unsigned ResampleSound(Sound* sound, volatile signed char*& position, int& fractPos, int intAdd, int fractAdd,
+    bool interpolation, float* dest, unsigned samples)
+{
+    auto* pos = (T*)position;
+    auto* end = (T*)sound->GetEnd();
+    auto* repeat = (T*)sound->GetRepeat();
+    unsigned frames;
+
+    if (sound->IsStereo())
+    {
+        if (sound->IsLooped())
+        {
+            frames = interpolation ? ResampleSamples<T, true, true, true>(pos, fractPos, end, repeat, intAdd, fractAdd, dest, samples) :
+                ResampleSamples<T, true, true, false>(pos, fractPos, end, repeat, intAdd, fractAdd, dest, samples);
+        }
+        else
+        {
+            frames = interpolation ? ResampleSamples<T, true, false, true>(pos, fractPos, end, repeat, intAdd, fractAdd, dest, samples) :
+                ResampleSamples<T, true, false, false>(pos, fractPos, end, repeat, intAdd, fractAdd, dest, samples);
+        }
+    }
+    else
+    {
+        if (sound->IsLooped())
+        {
+            frames = interpolation ? ResampleSamples<T, false, true, true>(pos, fractPos, end, repeat, intAdd, fractAdd, dest, samples) :
+                ResampleSamples<T, false, true, false>(pos, fractPos, end, repeat, intAdd, fractAdd, dest, samples);
+        }
+        else
+        {
+            frames = interpolation ? ResampleSamples<T, false, false, true>(pos, fractPos, end, repeat, intAdd, fractAdd, dest, samples) :
+                ResampleSamples<T, false, false, false>(pos, fractPos, end, repeat, intAdd, fractAdd, dest, samples);
+        }
+    }
+
+    position = (signed char*)pos;
+    return frames;
+}
+
+/// Accumulate samples multiplied by gain.
+static void AccumulateScaled(float* dest, const float* src, unsigned count, float gain)
+{
+    unsigned i = 0;
+#ifdef URHO3D_SSE
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+#endif
+    for (; i < count; ++i)
+        dest[i] += src[i] * gain;
+}
+
+/// Accumulate mono frames to an interleaved stereo buffer with separate left and right gains.
+static void AccumulateMonoToStereo(float* dest, const float* src, unsigned frames, float leftGain, float rightGain)
+{
+    unsigned i = 0;
+#ifdef URHO3D_SSE
+    const __m128 g = _mm_setr_ps(leftGain, rightGain, leftGain, rightGain);
+    for (; i + 4 <= frames; i += 4)
+    {
+        __m128 s = _mm_loadu_ps(src + i);
+        float* d = dest + (i << 1u);
+        _mm_storeu_ps(d, _mm_add_ps(_mm_loadu_ps(d), _mm_mul_ps(_mm_unpacklo_ps(s, s), g)));
+        _mm_storeu_ps(d + 4, _mm_add_ps(_mm_loadu_ps(d + 4), _mm_mul_ps(_mm_unpackhi_ps(s, s), g)));
+    }
+#endif
+    for (; i < frames; ++i)
+    {
+        dest[i << 1u] += src[i] * leftGain;
+        dest[(i << 1u) + 1] += src[i] * rightGain;
+    }
+}
+
+/// Accumulate interleaved stereo frames to a mono buffer. The gain should include the 0.5 channel averaging factor.
+static void AccumulateStereoToMono(float* dest, const float* src, unsigned frames, float gain)
+{
+    unsigned i = 0;
+#ifdef URHO3D_SSE
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= frames; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(src + (i << 1u));
+        __m128 b = _mm_loadu_ps(src + (i << 1u) + 4);
+        __m128 sum = _mm_add_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), _mm_mul_ps(sum, g)));
+    }
+#endif
+    for (; i < frames; ++i)
+        dest[i] += (src[i << 1u] + src[(i << 1u) + 1]) * gain;
+}
+
 extern const char* AUDIO_CATEGORY;
 
 extern const char* autoRemoveModeNames[];
@@ -363,7 +570,7 @@ void SoundSource::Update(float timeStep)
     }
 }
 
-void SoundSource::Mix(int dest[], unsigned samples, int mixRate, bool stereo, bool interpolation)
+void SoundSource::Mix(float dest[], unsigned samples, int mixRate, bool stereo, bool interpolation)
 {
     if (!position_ || (!sound_ && !soundStream_) || !IsEnabledEffective())
         return;
@@ -401,41 +608,12 @@ void SoundSource::Mix(int dest[], unsigned samples, int mixRate, bool stereo, bo
     if (!sound)
         return;
 
-    // Choose the correct mixing routine
-    if (!sound->IsStereo())
-    {
-        if (interpolation)
-        {
-            if (stereo)
-                MixMonoToStereoIP(sound, dest, samples, mixRate);
-            else
-                MixMonoToMonoIP(sound, dest, samples, mixRate);
-        }
-        else
-        {
-            if (stereo)
-                MixMonoToStereo(sound, dest, samples, mixRate);
-            else
-                MixMonoToMono(sound, dest, samples, mixRate);
-        }
-    }
+    // Sources that are too quiet to be heard, or virtualized by the audio subsystem, only advance their playback position
+    float totalGain = masterGain_ * attenuation_ * gain_;
+    if (dest && totalGain >= MIN_AUDIBLE_GAIN)
+        MixSamples(sound, dest, samples, mixRate, stereo, interpolation, totalGain);
     else
-    {
-        if (interpolation)
-        {
-            if (stereo)
-                MixStereoToStereoIP(sound, dest, samples, mixRate);
-            else
-                MixStereoToMonoIP(sound, dest, samples, mixRate);
-        }
-        else
-        {
-            if (stereo)
-                MixStereoToStereo(sound, dest, samples, mixRate);
-            else
-                MixStereoToMono(sound, dest, samples, mixRate);
-        }
-    }
+        MixZeroVolume(sound, samples, mixRate);
 
     // Update the time position. In stream mode, copy unused data back to the beginning of the stream buffer
     if (soundStream_)
@@ -457,6 +635,11 @@ void SoundSource::Mix(int dest[], unsigned samples, int mixRate, bool stereo, bo
         timePosition_ = ((float)(int)(size_t)(position_ - sound_->GetStart())) / (sound_->GetSampleSize() * sound_->GetFrequency());
 }
 
+void SoundSource::MixVirtual(unsigned samples, int mixRate)
+{
+    Mix(nullptr, samples, mixRate, false, false);
+}
+
 void SoundSource::UpdateMasterGain()
 {
     if (audio_)
@@ -602,632 +785,52 @@ void SoundSource::SetPlayPositionLockless(signed char* pos)
     timePosition_ = ((float)(int)(size_t)(pos - sound_->GetStart())) / (sound_->GetSampleSize() * sound_->GetFrequency());
 }
 
-void SoundSource::MixMonoToMono(Sound* sound, int dest[], unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto vol = RoundToInt(256.0f * totalGain);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
-    }
-
-    float add = frequency_ / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (*pos * vol) / 256;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (*pos * vol) / 256;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + *pos * vol;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + *pos * vol;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixMonoToStereo(Sound* sound, int dest[], unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto leftVol = (int)((-panning_ + 1.0f) * (256.0f * totalGain + 0.5f));
-    auto rightVol = (int)((panning_ + 1.0f) * (256.0f * totalGain + 0.5f));
-    if (!leftVol && !rightVol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
-    }
-
-    float add = frequency_ / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (*pos * leftVol) / 256;
-                ++dest;
-                *dest = *dest + (*pos * rightVol) / 256;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (*pos * leftVol) / 256;
-                ++dest;
-                *dest = *dest + (*pos * rightVol) / 256;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + *pos * leftVol;
-                ++dest;
-                *dest = *dest + *pos * rightVol;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + *pos * leftVol;
-                ++dest;
-                *dest = *dest + *pos * rightVol;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixMonoToMonoIP(Sound* sound, int dest[], unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto vol = RoundToInt(256.0f * totalGain);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
-    }
-
-    float add = frequency_ / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (GET_IP_SAMPLE() * vol) / 256;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (GET_IP_SAMPLE() * vol) / 256;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + GET_IP_SAMPLE() * vol;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + GET_IP_SAMPLE() * vol;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixMonoToStereoIP(Sound* sound, int dest[], unsigned samples, int mixRate)
+void SoundSource::MixSamples(Sound* sound, float dest[], unsigned samples, int mixRate, bool stereo, bool interpolation, float totalGain)
 {
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto leftVol = (int)((-panning_ + 1.0f) * (256.0f * totalGain + 0.5f));
-    auto rightVol = (int)((panning_ + 1.0f) * (256.0f * totalGain + 0.5f));
-    if (!leftVol && !rightVol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
-    }
-
     float add = frequency_ / (float)mixRate;
     auto intAdd = (int)add;
     auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
     int fractPos = fractPosition_;
 
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + (s * leftVol) / 256;
-                ++dest;
-                *dest = *dest + (s * rightVol) / 256;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + (s * leftVol) / 256;
-                ++dest;
-                *dest = *dest + (s * rightVol) / 256;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + s * leftVol;
-                ++dest;
-                *dest = *dest + s * rightVol;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + s * leftVol;
-                ++dest;
-                *dest = *dest + s * rightVol;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixStereoToMono(Sound* sound, int dest[], unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto vol = RoundToInt(256.0f * totalGain);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
+    // Resample to the scratch buffer of the audio subsystem first, then apply gain and panning with wide kernels.
+    // The buffer is allocated with the mix format and holds one fragment, so longer requests are mixed in parts
+    float* buffer = audio_->GetResampleBuffer();
+    const unsigned maxFrames = audio_->GetFragmentSize();
+    if (!buffer || !maxFrames)
         return;
-    }
 
-    float add = frequency_ / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
+    const bool sourceStereo = sound->IsStereo();
+    while (samples && position_)
     {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = ((int)pos[0] + (int)pos[1]) / 2;
-                *dest = *dest + (s * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
+        const unsigned partSamples = Min(samples, maxFrames);
+        unsigned frames;
+        if (sound->IsSixteenBit())
+            frames = ResampleSound<short>(sound, position_, fractPos, intAdd, fractAdd, interpolation, buffer, partSamples);
         else
-        {
-            while (samples--)
-            {
-                int s = ((int)pos[0] + (int)pos[1]) / 2;
-                *dest = *dest + (s * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
+            frames = ResampleSound<signed char>(sound, position_, fractPos, intAdd, fractAdd, interpolation, buffer, partSamples);
 
-        if (sound->IsLooped())
+        if (!sourceStereo)
         {
-            while (samples--)
-            {
-                int s = ((int)pos[0] + (int)pos[1]) / 2;
-                *dest = *dest + s * vol;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = ((int)pos[0] + (int)pos[1]) / 2;
-                *dest = *dest + s * vol;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixStereoToStereo(Sound* sound, int dest[], unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto vol = RoundToInt(256.0f * totalGain);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
-    }
-
-    float add = frequency_ / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (pos[0] * vol) / 256;
-                ++dest;
-                *dest = *dest + (pos[1] * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (pos[0] * vol) / 256;
-                ++dest;
-                *dest = *dest + (pos[1] * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + pos[0] * vol;
-                ++dest;
-                *dest = *dest + pos[1] * vol;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + pos[0] * vol;
-                ++dest;
-                *dest = *dest + pos[1] * vol;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixStereoToMonoIP(Sound* sound, int dest[], unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto vol = RoundToInt(256.0f * totalGain);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
-    }
-
-    float add = frequency_ / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
-                *dest = *dest + (s * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
-                *dest = *dest + (s * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
-                *dest = *dest + s * vol;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
+            if (stereo)
+                AccumulateMonoToStereo(dest, buffer, frames, (-panning_ + 1.0f) * totalGain, (panning_ + 1.0f) * totalGain);
+            else
+                AccumulateScaled(dest, buffer, frames, totalGain);
         }
         else
         {
-            while (samples--)
-            {
-                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
-                *dest = *dest + s * vol;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = pos;
+            if (stereo)
+                AccumulateScaled(dest, buffer, frames << 1u, totalGain);
+            else
+                AccumulateStereoToMono(dest, buffer, frames, 0.5f * totalGain);
         }
-    }
 
-    fractPosition_ = fractPos;
-}
+        // Non-looped sound ended
+        if (frames < partSamples)
+            break;
 
-void SoundSource::MixStereoToStereoIP(Sound* sound, int dest[], unsigned samples, int mixRate)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto vol = RoundToInt(256.0f * totalGain);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate);
-        return;
+        dest += stereo ? frames << 1u : frames;
+        samples -= partSamples;
     }
-
-    float add = frequency_ / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (GET_IP_SAMPLE_LEFT() * vol) / 256;
-                ++dest;
-                *dest = *dest + (GET_IP_SAMPLE_RIGHT() * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (GET_IP_SAMPLE_LEFT() * vol) / 256;
-                ++dest;
-                *dest = *dest + (GET_IP_SAMPLE_RIGHT() * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + GET_IP_SAMPLE_LEFT() * vol;
-                ++dest;
-                *dest = *dest + GET_IP_SAMPLE_RIGHT() * vol;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + GET_IP_SAMPLE_LEFT() * vol;
-                ++dest;
-                *dest = *dest + GET_IP_SAMPLE_RIGHT() * vol;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
     fractPosition_ = fractPos;
 }
 
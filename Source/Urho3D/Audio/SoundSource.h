@@ -106,11 +106,15 @@ public:
 
     /// Return whether is playing.
     bool IsPlaying() const;
+    /// Return total gain used for mixing (master gain, attenuation and gain combined), or zero if not playing. Used to rank voices for virtualization.
+    float GetAudibility() const { return IsPlaying() ? masterGain_ * attenuation_ * gain_ : 0.0f; }
 
     /// Update the sound source. Perform subclass specific operations. Called by Audio.
     virtual void Update(float timeStep);
-    /// Mix sound source output to a 32-bit clipping buffer. Called by Audio.
-    void Mix(int dest[], unsigned samples, int mixRate, bool stereo, bool interpolation);
+    /// Mix sound source output to a floating point clipping buffer. Called by Audio.
+    void Mix(float dest[], unsigned samples, int mixRate, bool stereo, bool interpolation);
+    /// Advance playback without producing output, as if mixed at zero volume. Called by Audio for virtualized voices.
+    void MixVirtual(unsigned samples, int mixRate);
     /// Update the effective master gain. Called internally and by Audio when the master gain changes.
     void UpdateMasterGain();
 
@@ -156,22 +160,8 @@ private:
     void StopLockless();
     /// Set new playback position without locking the audio mutex. Called internally.
     void SetPlayPositionLockless(signed char* pos);
-    /// Mix mono sample to mono buffer.
-    void MixMonoToMono(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix mono sample to stereo buffer.
-    void MixMonoToStereo(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix mono sample to mono buffer interpolated.
-    void MixMonoToMonoIP(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix mono sample to stereo buffer interpolated.
-    void MixMonoToStereoIP(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix stereo sample to mono buffer.
-    void MixStereoToMono(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix stereo sample to stereo buffer.
-    void MixStereoToStereo(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix stereo sample to mono buffer interpolated.
-    void MixStereoToMonoIP(Sound* sound, int dest[], unsigned samples, int mixRate);
-    /// Mix stereo sample to stereo buffer interpolated.
-    void MixStereoToStereoIP(Sound* sound, int dest[], unsigned samples, int mixRate);
+    /// Resample the sound and accumulate it to the clipping buffer with gain and panning applied.
+    void MixSamples(Sound* sound, float dest[], unsigned samples, int mixRate, bool stereo, bool interpolation, float totalGain);
     /// Advance playback pointer without producing audible output.
     void MixZeroVolume(Sound* sound, unsigned samples, int mixRate);
     /// Advance playback pointer to simulate audio playback in headless mode.
@@ -347,6 +347,8 @@ public:
 %interface_custom("%s", "I%s", Urho3D::AbstractFile);
 %include "Urho3D/IO/AbstractFile.h"
 %include "Urho3D/IO/Compression.h"
+%ignore Urho3D::File::GetMappedData;
+%ignore Urho3D::PackageFile::GetMappedData;
 %include "Urho3D/IO/File.h"
 %include "Urho3D/IO/Log.h"
 %include "Urho3D/IO/MemoryBuffer.h"
@@ -481,7 +483,6 @@ public:
 %ignore Urho3D::PointOctreeQuery::TestDrawables;
 %ignore Urho3D::BoxOctreeQuery::TestDrawables;
 %ignore Urho3D::OctreeQuery::TestDrawables;
-%ignore Urho3D::UpdateDrawablesWork;
 %ignore Urho3D::ProcessLightWork;
 %ignore Urho3D::CheckVisibilityWork;
 %ignore Urho3D::CheckDrawableVisibilityWork;
@@ -545,6 +546,7 @@ public:
 %include "Urho3D/Graphics/Texture2DArray.h"
 %include "Urho3D/Graphics/Texture3D.h"
 %include "Urho3D/Graphics/TextureCube.h"
+%include "Urho3D/Graphics/TextureStreaming.h"
 //%include "Urho3D/Graphics/Batch.h"
 %include "Urho3D/Graphics/Skeleton.h"
 %include "Urho3D/Graphics/Model.h"
@@ -638,6 +640,8 @@ public:
 %ignore Urho3D::Network::GetConnection;
 %ignore Urho3D::Network::OnServerConnect;
 %ignore Urho3D::Network::HandleIncomingPacket;
+%ignore Urho3D::Connection::SetRelevancyFilter;
+%ignore Urho3D::Network::GetInterestGrid;
 
 %include "Urho3D/Network/Connection.h"
 %include "Urho3D/Network/Network.h"
@@ -255,6 +255,7 @@
 %ignore Urho3D::MSG_PACKAGEINFO;
 %ignore Urho3D::CONTROLS_CONTENT_ID;
 %ignore Urho3D::PACKAGE_FRAGMENT_SIZE;
+%ignore Urho3D::NETWORK_PROTOCOL_VERSION;
 %ignore Urho3D::DEFAULT_FPS;
 %ignore Urho3D::DEFAULT_MAX_NETWORK_ANGULAR_VELOCITY;
 %ignore Urho3D::COLOR_LUT_SIZE;
@@ -60,6 +60,7 @@ URHO3D_REFCOUNTED(Urho3D::Texture2D);
 URHO3D_REFCOUNTED(Urho3D::Texture2DArray);
 URHO3D_REFCOUNTED(Urho3D::Texture3D);
 URHO3D_REFCOUNTED(Urho3D::TextureCube);
+URHO3D_REFCOUNTED(Urho3D::TextureStreaming);
 URHO3D_REFCOUNTED(Urho3D::VertexBuffer);
 URHO3D_REFCOUNTED(Urho3D::View);
 URHO3D_REFCOUNTED(Urho3D::Viewport);
@@ -58,6 +58,30 @@ URHO3D_FLAGSET(AttributeMode, AttributeModeFlags);
 
 class Serializable;
 
+/// Network quantization mode of an attribute.
+enum NetworkQuantizeMode : unsigned char
+{
+    NQM_NONE = 0,
+    NQM_RANGE,
+    NQM_GRID,
+    NQM_SMALLEST_THREE
+};
+
+/// Network quantization parameters of an attribute, resolved from the attribute metadata on first use by network replication.
+struct NetworkQuantization
+{
+    /// Whether the parameters were resolved from metadata.
+    bool resolved_{};
+    /// Quantization mode.
+    NetworkQuantizeMode mode_{NQM_NONE};
+    /// Bits per component.
+    unsigned bits_{};
+    /// Minimum component value (range mode) or cell size (grid mode).
+    float min_{};
+    /// Maximum component value (range mode).
+    float max_{};
+};
+
 /// Abstract base class for invoking attribute accessors.
 class URHO3D_API AttributeAccessor : public RefCounted
 {
@@ -173,6 +197,8 @@ struct AttributeInfo
     ea::vector<ea::string> enumNamesStorage_;
     /// List of enum name pointers. Front of this vector will be assigned to enumNames_ when enumNamesStorage_ is in use.
     ea::vector<const char*> enumNamesPointers_;
+    /// Network quantization parameters cached from metadata. Metadata set through AttributeHandle resets it.
+    mutable NetworkQuantization networkQuantization_;
 
 private:
     void InitializeEnumNamesFromStorage()
@@ -208,9 +234,15 @@ public:
     AttributeHandle& SetMetadata(StringHash key, const Variant& value)
     {
         if (attributeInfo_)
+        {
             attributeInfo_->metadata_[key] = value;
+            attributeInfo_->networkQuantization_.resolved_ = false;
+        }
         if (networkAttributeInfo_)
+        {
             networkAttributeInfo_->metadata_[key] = value;
+            networkAttributeInfo_->networkQuantization_.resolved_ = false;
+        }
         return *this;
     }
 };
@@ -469,6 +469,27 @@ AttributeInfo* Context::GetAttribute(StringHash objectType, const char* name)
     return nullptr;
 }
 
+AttributeHandle Context::GetAttributeHandle(StringHash objectType, const char* name)
+{
+    AttributeHandle handle;
+    handle.attributeInfo_ = GetAttribute(objectType, name);
+
+    auto i = networkAttributes_.find(objectType);
+    if (i != networkAttributes_.end())
+    {
+        for (AttributeInfo& attr : i->second)
+        {
+            if (!attr.name_.comparei(name))
+            {
+                handle.networkAttributeInfo_ = &attr;
+                break;
+            }
+        }
+    }
+
+    return handle;
+}
+
 void Context::AddEventReceiver(Object* receiver, StringHash eventType)
 {
     SharedPtr<EventReceiverGroup>& group = eventReceivers_[eventType];
@@ -505,6 +526,31 @@ void Context::RemoveEventSender(Object* sender)
     }
 }
 
+TypedEventChannelBase* Context::GetTypedEventChannel(const std::type_info& typeInfo) const
+{
+    // Typed event channels are not synchronized
+    assert(Thread::IsMainThread());
+
+    auto i = typedEventChannels_.find(std::type_index(typeInfo));
+    return i != typedEventChannels_.end() ? i->second.get() : nullptr;
+}
+
+TypedEventChannelBase* Context::GetOrCreateTypedEventChannel(const std::type_info& typeInfo, TypedEventChannelBase* (*create)())
+{
+    assert(Thread::IsMainThread());
+
+    ea::unique_ptr<TypedEventChannelBase>& channel = typedEventChannels_[std::type_index(typeInfo)];
+    if (!channel)
+        channel.reset(create());
+    return channel.get();
+}
+
+void Context::RemoveTypedEventReceiver(Object* receiver)
+{
+    for (auto& item : typedEventChannels_)
+        item.second->UnsubscribeReceiver(receiver);
+}
+
 void Context::RemoveEventReceiver(Object* receiver, StringHash eventType)
 {
     EventReceiverGroup* group = GetEventReceivers(eventType);
@@ -173,10 +173,14 @@ public:
     const ea::string& GetTypeName(StringHash objectType) const;
     /// Return a specific attribute description for an object, or null if not found.
     AttributeInfo* GetAttribute(StringHash objectType, const char* name);
+    /// Return handle of an already registered attribute, e.g. to add network quantization metadata. Handle is empty if not found.
+    AttributeHandle GetAttributeHandle(StringHash objectType, const char* name);
     /// Template version of returning a subsystem.
     template <class T> T* GetSubsystem() const;
     /// Template version of returning a specific attribute description.
     template <class T> AttributeInfo* GetAttribute(const char* name);
+    /// Template version of returning handle of an already registered attribute.
+    template <class T> AttributeHandle GetAttributeHandle(const char* name);
 
     /// Return attribute descriptions for an object type, or null if none defined.
     const ea::vector<AttributeInfo>* GetAttributes(StringHash type) const
@@ -217,6 +221,9 @@ public:
         return i != eventReceivers_.end() ? i->second : nullptr;
     }
 
+    /// Return channel of a typed event struct type, or null if it was never subscribed to. Main thread only.
+    TypedEventChannelBase* GetTypedEventChannel(const std::type_info& typeInfo) const;
+
     /// Return engine subsystem.
     inline Engine* GetEngine() const { return engine_; }
     /// Return time subsystem.
@@ -305,6 +312,10 @@ private:
 
     /// Set current event handler. Called by Object.
     void SetEventHandler(EventHandler* handler) { eventHandler_ = handler; }
+    /// Return channel of a typed event, create if it does not exist.
+    TypedEventChannelBase* GetOrCreateTypedEventChannel(const std::type_info& typeInfo, TypedEventChannelBase* (*create)());
+    /// Remove receiver from all typed events.
+    void RemoveTypedEventReceiver(Object* receiver);
 
     /// Object factories.
     ea::unordered_map<StringHash, SharedPtr<ObjectFactory> > factories_;
@@ -318,6 +329,8 @@ private:
     ea::unordered_map<StringHash, SharedPtr<EventReceiverGroup> > eventReceivers_;
     /// Event receivers for specific senders' events.
     ea::unordered_map<Object*, ea::unordered_map<StringHash, SharedPtr<EventReceiverGroup> > > specificEventReceivers_;
+    /// Typed event channels by event struct type.
+    ea::unordered_map<std::type_index, ea::unique_ptr<TypedEventChannelBase>, TypedEventTypeHash> typedEventChannels_;
     /// Event sender stack.
     ea::vector<Object*> eventSenders_;
     /// Event data stack.
@@ -417,6 +430,8 @@ template <class T> T* Context::GetSubsystem() const { return static_cast<T*>(Get
 
 template <class T> AttributeInfo* Context::GetAttribute(const char* name) { return GetAttribute(T::GetTypeStatic(), name); }
 
+template <class T> AttributeHandle Context::GetAttributeHandle(const char* name) { return GetAttributeHandle(T::GetTypeStatic(), name); }
+
 template <class T> void Context::UpdateAttributeDefaultValue(const char* name, const Variant& defaultValue)
 {
     UpdateAttributeDefaultValue(T::GetTypeStatic(), name, defaultValue);
@@ -63,4 +63,32 @@ URHO3D_EVENT(E_ENDFRAME, EndFrame)
 {
 }
 
+/// Typed application-wide logic update event. Sent right after E_UPDATE.
+URHO3D_TYPED_EVENT(UpdateArgs)
+{
+    /// Frame time step.
+    float timeStep_{};
+};
+
+/// Typed application-wide logic post-update event. Sent right after E_POSTUPDATE.
+URHO3D_TYPED_EVENT(PostUpdateArgs)
+{
+    /// Frame time step.
+    float timeStep_{};
+};
+
+/// Typed render update event. Sent right after E_RENDERUPDATE.
+URHO3D_TYPED_EVENT(RenderUpdateArgs)
+{
+    /// Frame time step.
+    float timeStep_{};
+};
+
+/// Typed post-render update event. Sent right after E_POSTRENDERUPDATE.
+URHO3D_TYPED_EVENT(PostRenderUpdateArgs)
+{
+    /// Frame time step.
+    float timeStep_{};
+};
+
 }
@@ -81,6 +81,7 @@ public:
             {
                 const T& otherFunctor = *static_cast<const T*>(other);
                 new(storage) T(otherFunctor);
+                break;
             }
             default:
                 assert(false);
@@ -90,6 +90,31 @@ Object::~Object()
     }
 }
 
+TypedEventChannelBase* Object::GetTypedEventChannel(const std::type_info& typeInfo) const
+{
+    return context_->GetTypedEventChannel(typeInfo);
+}
+
+TypedEventChannelBase* Object::GetOrCreateTypedEventChannel(const std::type_info& typeInfo, TypedEventChannelBase* (*create)())
+{
+    hasTypedEventHandlers_ = true;
+    return context_->GetOrCreateTypedEventChannel(typeInfo, create);
+}
+
+bool Object::HasEventReceivers(StringHash eventType)
+{
+    if (blockEvents_)
+        return false;
+
+    // Receivers may leave holes in the group while the event is being sent, this errs on the side of sending
+    EventReceiverGroup* group = context_->GetEventReceivers(this, eventType);
+    if (group && !group->receivers_.empty())
+        return true;
+
+    group = context_->GetEventReceivers(eventType);
+    return group && !group->receivers_.empty();
+}
+
 void Object::OnEvent(Object* sender, StringHash eventType, VariantMap& eventData)
 {
     if (blockEvents_)
@@ -267,6 +292,12 @@ void Object::UnsubscribeFromAllEvents()
         else
             break;
     }
+
+    if (hasTypedEventHandlers_)
+    {
+        context_->RemoveTypedEventReceiver(this);
+        hasTypedEventHandlers_ = false;
+    }
 }
 
 void Object::UnsubscribeFromAllEventsExcept(const ea::vector<StringHash>& exceptions, bool onlyUserData)
@@ -28,6 +28,7 @@
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
 #include "../Core/StringHashRegister.h"
+#include "../Core/TypedEvent.h"
 #include "../Core/Variant.h"
 #include <functional>
 #include <utility>
@@ -197,6 +198,19 @@ public:
 
     /// Return whether has subscribed to any event.
     bool HasEventHandlers() const { return !eventHandlers_.empty(); }
+    /// Return whether sending an event would reach any receiver. Used to skip filling event data.
+    bool HasEventReceivers(StringHash eventType);
+
+    /// Subscribe to a typed event.
+    template <class Receiver, class T> void SubscribeToTypedEvent(void (Receiver::*handler)(T&));
+    /// Subscribe to a typed event. Handler also receives the sender.
+    template <class Receiver, class T> void SubscribeToTypedEvent(void (Receiver::*handler)(Object*, T&));
+    /// Unsubscribe from a typed event.
+    template <class T> void UnsubscribeFromTypedEvent();
+    /// Send typed event to all subscribers. Does not allocate or convert the event to a VariantMap. Main thread only.
+    template <class T> void SendTypedEvent(T& event);
+    /// Return whether a typed event has any subscribers. Used to skip filling the event struct.
+    template <class T> bool HasTypedEventSubscribers() const;
 
     /// Template version of returning a subsystem.
     template <class T> T* GetSubsystem() const;
@@ -231,16 +245,55 @@ private:
     ea::intrusive_list<EventHandler>::iterator EraseEventHandler(ea::intrusive_list<EventHandler>::iterator handlerIter);
     /// Remove event handlers related to a specific sender.
     void RemoveEventSender(Object* sender);
+    /// Return channel of a typed event, or null if it was never subscribed to.
+    TypedEventChannelBase* GetTypedEventChannel(const std::type_info& typeInfo) const;
+    /// Return channel of a typed event for subscribing, create if it does not exist.
+    TypedEventChannelBase* GetOrCreateTypedEventChannel(const std::type_info& typeInfo, TypedEventChannelBase* (*create)());
 
     /// Event handlers. Sender is null for non-specific handlers.
     ea::intrusive_list<EventHandler> eventHandlers_;
 
     /// Block object from sending and receiving any events.
     bool blockEvents_;
+    /// Whether object has subscribed to any typed event.
+    bool hasTypedEventHandlers_{};
 };
 
 template <class T> T* Object::GetSubsystem() const { return static_cast<T*>(GetSubsystem(T::GetTypeStatic())); }
 
+template <class Receiver, class T> void Object::SubscribeToTypedEvent(void (Receiver::*handler)(T&))
+{
+    auto* channel = static_cast<TypedEventChannel<T>*>(GetOrCreateTypedEventChannel(typeid(T), &TypedEventChannel<T>::Create));
+    channel->Subscribe(static_cast<Receiver*>(this), handler);
+}
+
+template <class Receiver, class T> void Object::SubscribeToTypedEvent(void (Receiver::*handler)(Object*, T&))
+{
+    auto* channel = static_cast<TypedEventChannel<T>*>(GetOrCreateTypedEventChannel(typeid(T), &TypedEventChannel<T>::Create));
+    channel->Subscribe(static_cast<Receiver*>(this), handler);
+}
+
+template <class T> void Object::UnsubscribeFromTypedEvent()
+{
+    if (auto* channel = static_cast<TypedEventChannel<T>*>(GetTypedEventChannel(typeid(T))))
+        channel->Unsubscribe(this);
+}
+
+template <class T> void Object::SendTypedEvent(T& event)
+{
+    if (blockEvents_)
+        return;
+
+    if (auto* channel = static_cast<TypedEventChannel<T>*>(GetTypedEventChannel(typeid(T))))
+        (*channel)(this, event);
+}
+
+template <class T> bool Object::HasTypedEventSubscribers() const
+{
+    auto* channel = static_cast<TypedEventChannel<T>*>(GetTypedEventChannel(typeid(T)));
+    return channel && channel->HasSubscribers();
+}
+
 /// Base class for object factories.
 class URHO3D_API ObjectFactory : public RefCounted
 {
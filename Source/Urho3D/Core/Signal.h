@@ -97,28 +97,45 @@ public:
         {
             ea::pair<WeakPtr<RefCounted>, Handler>& pair = *it;
             if (pair.first.Expired() || pair.first == receiver)
-                it = handlers_.erase(it);
+            {
+                // Handlers are only erased by the outermost invocation, removed ones are skipped until then
+                if (invocationDepth_)
+                {
+                    pair.first.Reset();
+                    ++it;
+                }
+                else
+                    it = handlers_.erase(it);
+            }
             else
                 ++it;
         }
     }
 
-    /// Invoke event.
+    /// Invoke event. Handlers may subscribe and unsubscribe while the event is being invoked.
     void operator()(Sender* sender, T& args)
     {
-        for (auto it = handlers_.begin(); it != handlers_.end();)
+        ++invocationDepth_;
+        // Handlers subscribed during invocation are appended and invoked as well
+        for (unsigned i = 0; i < handlers_.size();)
         {
-            ea::pair<WeakPtr<RefCounted>, Handler>& pair = *it;
-            if (RefCounted* receiver = pair.first.Get())
+            RefCounted* receiver = handlers_[i].first.Get();
+            bool keep = false;
+            if (receiver)
             {
-                if (pair.second(receiver, sender, args))
-                    ++it;
-                else
-                    it = handlers_.erase(it);
+                // Copy the handler, the list may be reallocated while it is being executed
+                Handler handler = handlers_[i].second;
+                keep = handler(receiver, sender, args);
             }
+
+            if (keep)
+                ++i;
+            else if (invocationDepth_ == 1)
+                handlers_.erase(handlers_.begin() + i);
             else
-                it = handlers_.erase(it);
+                handlers_[i++].first.Reset();
         }
+        --invocationDepth_;
     }
 
     /// Returns true when event has at least one subscriber.
@@ -127,6 +144,8 @@ public:
 protected:
     /// A collection of event handlers.
     ea::vector<ea::pair<WeakPtr<RefCounted>, Handler>> handlers_;
+    /// Number of nested invocations in progress.
+    unsigned invocationDepth_{};
 };
 
 template<typename Sender>
@@ -193,28 +212,45 @@ public:
         {
             ea::pair<WeakPtr<RefCounted>, Handler>& pair = *it;
             if (pair.first.Expired() || pair.first == receiver)
-                it = handlers_.erase(it);
+            {
+                // Handlers are only erased by the outermost invocation, removed ones are skipped until then
+                if (invocationDepth_)
+                {
+                    pair.first.Reset();
+                    ++it;
+                }
+                else
+                    it = handlers_.erase(it);
+            }
             else
                 ++it;
         }
     }
 
-    /// Invoke event.
+    /// Invoke event. Handlers may subscribe and unsubscribe while the event is being invoked.
     void operator()(Sender* sender)
     {
-        for (auto it = handlers_.begin(); it != handlers_.end();)
+        ++invocationDepth_;
+        // Handlers subscribed during invocation are appended and invoked as well
+        for (unsigned i = 0; i < handlers_.size();)
         {
-            ea::pair<WeakPtr<RefCounted>, Handler>& pair = *it;
-            if (RefCounted* receiver = pair.first.Get())
+            RefCounted* receiver = handlers_[i].first.Get();
+            bool keep = false;
+            if (receiver)
             {
-                if (pair.second(receiver, sender))
-                    ++it;
-                else
-                    it = handlers_.erase(it);
+                // Copy the handler, the list may be reallocated while it is being executed
+                Handler handler = handlers_[i].second;
+                keep = handler(receiver, sender);
             }
+
+            if (keep)
+                ++i;
+            else if (invocationDepth_ == 1)
+                handlers_.erase(handlers_.begin() + i);
             else
-                it = handlers_.erase(it);
+                handlers_[i++].first.Reset();
         }
+        --invocationDepth_;
     }
 
     /// Returns true when event has at least one subscriber.
@@ -223,6 +259,8 @@ public:
 protected:
     /// A collection of event handlers.
     ea::vector<ea::pair<WeakPtr<RefCounted>, Handler>> handlers_;
+    /// Number of nested invocations in progress.
+    unsigned invocationDepth_{};
 };
 
 }
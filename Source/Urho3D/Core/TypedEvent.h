@@ -0,0 +1,81 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "../Core/Signal.h"
+
+#include <typeindex>
+#include <typeinfo>
+
+namespace Urho3D
+{
+
+class Object;
+
+/// Base of typed event structs.
+struct TypedEvent
+{
+};
+
+/// Base class of typed event channels.
+class TypedEventChannelBase
+{
+public:
+    /// Construct.
+    explicit TypedEventChannelBase(const std::type_info& typeInfo) : typeInfo_(typeInfo) { }
+    /// Destruct.
+    virtual ~TypedEventChannelBase() = default;
+    /// Unsubscribe all handlers of specified receiver.
+    virtual void UnsubscribeReceiver(RefCounted* receiver) = 0;
+    /// Return type of the event struct.
+    const std::type_info& GetTypeInfo() const { return typeInfo_; }
+
+private:
+    /// Type of the event struct.
+    const std::type_info& typeInfo_;
+};
+
+/// Hash function of typed event struct types, for use as a key of EASTL containers.
+struct TypedEventTypeHash
+{
+    /// Return hash of the type.
+    size_t operator()(const std::type_index& type) const { return type.hash_code(); }
+};
+
+/// Subscribers of a typed event, stored in a flat array. Event struct is passed to handlers by reference together with the sender.
+template <class T>
+class TypedEventChannel : public TypedEventChannelBase, public Signal<T, Object>
+{
+public:
+    /// Construct.
+    TypedEventChannel() : TypedEventChannelBase(typeid(T)) { }
+    /// Create new channel.
+    static TypedEventChannelBase* Create() { return new TypedEventChannel<T>(); }
+
+    /// Unsubscribe all handlers of specified receiver.
+    void UnsubscribeReceiver(RefCounted* receiver) override { this->Unsubscribe(receiver); }
+};
+
+}
+
+/// Describe a statically typed event. Struct members are event parameters. Unlike events described with URHO3D_EVENT, sending it does not fill a VariantMap. Events are identified by their type, so structs of the same name in different namespaces are different events.
+#define URHO3D_TYPED_EVENT(structName) struct structName : public Urho3D::TypedEvent
@@ -30,9 +30,174 @@
 #include "../Core/WorkQueue.h"
 #include "../IO/Log.h"
 
+#include <condition_variable>
+#include <mutex>
+
 namespace Urho3D
 {
 
+/// Index of the thread executing the code: 0 for main thread, 1+ for worker threads.
+static thread_local unsigned currentThreadIndex = 0;
+
+/// Fixed capacity lock-free work-stealing deque (Chase-Lev). Owner thread pushes and pops at the bottom, other threads steal from the top.
+class WorkStealingDeque
+{
+public:
+    /// Maximum number of items. Must be power of two.
+    static const unsigned CAPACITY = 4096;
+
+    /// Push item to the bottom. Owner thread only. Return false if the deque is full.
+    bool Push(WorkItem* item)
+    {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const int64_t top = top_.load(std::memory_order_acquire);
+        if (bottom - top >= static_cast<int64_t>(CAPACITY))
+            return false;
+
+        items_[bottom & (CAPACITY - 1)].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Pop item from the bottom. Owner thread only.
+    WorkItem* Pop()
+    {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            // Deque was empty
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        WorkItem* item = items_[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (top == bottom)
+        {
+            // Last item, race against thieves
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                item = nullptr;
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    /// Steal item from the top. Any thread.
+    WorkItem* Steal()
+    {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom)
+            return nullptr;
+
+        WorkItem* item = items_[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return item;
+    }
+
+    /// Return whether the deque looks empty. May be out of date as soon as it returns.
+    bool IsEmpty() const { return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed); }
+
+private:
+    /// Index of the next item to steal. Kept on separate cache line from bottom index.
+    alignas(64) std::atomic<int64_t> top_{};
+    /// Index of the next item to push.
+    alignas(64) std::atomic<int64_t> bottom_{};
+    /// Ring buffer of items.
+    std::atomic<WorkItem*> items_[CAPACITY]{};
+};
+
+/// Worker threads waiting for work. Waking is skipped entirely while no worker is waiting.
+class IdleWorkers
+{
+public:
+    /// Block the calling worker thread for as long as the predicate returns true.
+    template <class T> void Wait(T shouldWait)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        numWaiting_.fetch_add(1, std::memory_order_relaxed);
+        // Pairs with the fence in WakeOne: either the waker sees this thread waiting or this thread sees the new work
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (shouldWait())
+            condition_.wait(lock);
+        numWaiting_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /// Wake one waiting worker thread, if any.
+    void WakeOne()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (numWaiting_.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            condition_.notify_one();
+        }
+    }
+
+    /// Wake all waiting worker threads.
+    void WakeAll()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        condition_.notify_all();
+    }
+
+private:
+    /// Mutex for the condition.
+    std::mutex mutex_;
+    /// Condition signaled when work is queued.
+    std::condition_variable condition_;
+    /// Number of waiting worker threads.
+    std::atomic<unsigned> numWaiting_{};
+};
+
+/// Number of times an idle worker thread yields before it starts waiting for work.
+static const unsigned MAX_IDLE_SPINS = 64;
+
+/// Shared state of single WorkQueue::ParallelFor invocation.
+struct ParallelForContext
+{
+    /// Function to execute.
+    const ParallelForFunction* function_{};
+    /// Total number of elements.
+    unsigned count_{};
+    /// Number of elements per batch.
+    unsigned batchSize_{};
+    /// Number of batches.
+    unsigned numBatches_{};
+    /// Next batch to execute.
+    std::atomic<unsigned> nextBatch_{};
+};
+
+/// Maximum number of work items a single ParallelFor distributes to worker threads.
+static const unsigned MAX_PARALLEL_FOR_HELPERS = 64;
+
+/// Execute ParallelFor batches until none are left.
+static void ProcessParallelForBatches(ParallelForContext& context, unsigned threadIndex)
+{
+    for (;;)
+    {
+        const unsigned batch = context.nextBatch_.fetch_add(1, std::memory_order_relaxed);
+        if (batch >= context.numBatches_)
+            break;
+
+        const unsigned begin = batch * context.batchSize_;
+        const unsigned end = Min(begin + context.batchSize_, context.count_);
+        (*context.function_)(begin, end, threadIndex);
+    }
+}
+
+/// ParallelFor helper work function.
+static void ParallelForWork(const WorkItem* item, unsigned threadIndex)
+{
+    ProcessParallelForBatches(*reinterpret_cast<ParallelForContext*>(item->aux_), threadIndex);
+}
+
 /// Worker thread managed by the work queue.
 class WorkerThread : public Thread, public RefCounted
 {
@@ -65,14 +230,18 @@ private:
 
 WorkQueue::WorkQueue(Context* context) :
     Object(context),
+    queueSize_(0),
+    idleWorkers_(new IdleWorkers()),
     shutDown_(false),
-    pausing_(false),
     paused_(false),
     completing_(false),
     tolerance_(10),
     lastSize_(0),
     maxNonThreadedWorkMs_(5)
 {
+    // Main thread deque always exists
+    deques_.emplace_back(new WorkStealingDeque());
+
     SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(WorkQueue, HandleBeginFrame));
 }
 
@@ -80,7 +249,8 @@ WorkQueue::~WorkQueue()
 {
     // Stop the worker threads. First make sure they are not waiting for work items
     shutDown_ = true;
-    Resume();
+    paused_ = false;
+    idleWorkers_->WakeAll();
 
     for (unsigned i = 0; i < threads_.size(); ++i)
         threads_[i]->Stop();
@@ -94,8 +264,9 @@ void WorkQueue::CreateThreads(unsigned numThreads)
     if (!threads_.empty())
         return;
 
-    // Start threads in paused mode
-    Pause();
+    // Create all deques before any thread starts, so that stealing threads never see the container change
+    for (unsigned i = 0; i < numThreads; ++i)
+        deques_.emplace_back(new WorkStealingDeque());
 
     for (unsigned i = 0; i < numThreads; ++i)
     {
@@ -127,6 +298,12 @@ SharedPtr<WorkItem> WorkQueue::GetFreeItem()
 }
 
 void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
+{
+    static const ea::vector<SharedPtr<WorkItem> > noDependencies;
+    AddWorkItem(item, noDependencies);
+}
+
+void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item, const ea::vector<SharedPtr<WorkItem> >& dependencies)
 {
     if (!item)
     {
@@ -137,124 +314,139 @@ void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
     // Check for duplicate items.
     assert(ea::find(workItems_.begin(), workItems_.end(), item) == workItems_.end());
 
-    // Push to the main thread list to keep item alive
+    // Push to the main thread list to keep item alive. Removed item may still wait there for its deque references to go
+    // away, it must not be recycled while in use again
     // Clear completed flag in case item is reused
     workItems_.push_back(item);
+    if (!removedItems_.empty())
+        removedItems_.erase(ea::remove(removedItems_.begin(), removedItems_.end(), item), removedItems_.end());
     item->completed_ = false;
+    item->dependentsReleased_ = false;
 
-    // Make sure worker threads' list is safe to modify
-    if (threads_.size() && !paused_)
-        queueMutex_.Acquire();
-
-    // Find position for new item
-    if (queue_.empty())
-        queue_.push_back(item.Get());
-    else
+    // Hold one extra dependency while registering, so that the item can not be scheduled by a dependency completing
+    // in the meantime
+    item->pendingDependencies_ = 1;
+    for (const SharedPtr<WorkItem>& dependency : dependencies)
     {
-        bool inserted = false;
+        if (!dependency || dependency == item)
+            continue;
 
-        for (auto i = queue_.begin(); i != queue_.end(); ++i)
+        MutexLock lock(dependency->dependentsMutex_);
+        if (!dependency->dependentsReleased_)
         {
-            if ((*i)->priority_ <= item->priority_)
-            {
-                queue_.insert(i, item.Get());
-                inserted = true;
-                break;
-            }
+            ++item->pendingDependencies_;
+            dependency->dependents_.push_back(item.Get());
         }
-
-        if (!inserted)
-            queue_.push_back(item.Get());
     }
 
-    if (threads_.size())
-    {
-        queueMutex_.Release();
-        paused_ = false;
-    }
+    // Make sure worker threads are running
+    Resume();
+
+    if (--item->pendingDependencies_ == 0)
+        ScheduleItem(item.Get(), 0);
 }
 
 SharedPtr<WorkItem> WorkQueue::AddWorkItem(std::function<void()> workFunction, unsigned priority)
+{
+    static const ea::vector<SharedPtr<WorkItem> > noDependencies;
+    return AddWorkItem(std::move(workFunction), noDependencies, priority);
+}
+
+SharedPtr<WorkItem> WorkQueue::AddWorkItem(std::function<void()> workFunction,
+    const ea::vector<SharedPtr<WorkItem> >& dependencies, unsigned priority)
 {
     SharedPtr<WorkItem> item = GetFreeItem();
     item->workLambda_ = std::move(workFunction);
     item->workFunction_ = [](const WorkItem* item, unsigned) { item->workLambda_(); };
     item->priority_ = priority;
-    AddWorkItem(item);
+    AddWorkItem(item, dependencies);
     return item;
 }
 
-bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
+void WorkQueue::ParallelFor(unsigned count, unsigned batchSize, const ParallelForFunction& function)
 {
-    if (!item)
-        return false;
+    if (!count)
+        return;
 
-    MutexLock lock(queueMutex_);
+    batchSize = Max(batchSize, 1U);
+    const unsigned numBatches = (count + batchSize - 1) / batchSize;
 
-    // Can only remove successfully if the item was not yet taken by threads for execution
-    auto i = ea::find(queue_.begin(), queue_.end(), item.Get());
-    if (i != queue_.end())
+    // Nothing to distribute, or not called from the main thread: execute inline
+    if (numBatches == 1 || threads_.empty() || !Thread::IsMainThread())
     {
-        auto j = ea::find(workItems_.begin(), workItems_.end(), item);
-        if (j != workItems_.end())
-        {
-            queue_.erase(i);
-            ReturnToPool(item);
-            workItems_.erase(j);
-            return true;
-        }
+        function(0, count, currentThreadIndex);
+        return;
     }
 
-    return false;
+    ParallelForContext context;
+    context.function_ = &function;
+    context.count_ = count;
+    context.batchSize_ = batchSize;
+    context.numBatches_ = numBatches;
+
+    // Main thread takes part as well, so one helper item less is needed than there are batches
+    const unsigned numHelpers = Min(numBatches - 1, GetNumThreads());
+    SharedPtr<WorkItem> helpers[MAX_PARALLEL_FOR_HELPERS];
+    unsigned numQueuedHelpers = 0;
+    for (unsigned i = 0; i < numHelpers && i < MAX_PARALLEL_FOR_HELPERS; ++i)
+    {
+        SharedPtr<WorkItem> item = GetFreeItem();
+        item->workFunction_ = ParallelForWork;
+        item->aux_ = &context;
+        item->priority_ = M_MAX_UNSIGNED;
+        item->completed_ = false;
+        PushItem(item.Get(), 0);
+        helpers[numQueuedHelpers++] = item;
+        WakeWorker();
+    }
+
+    // Process batches in the main thread too. Helpers still sitting in the own deque are popped and finished quickly
+    ProcessParallelForBatches(context, 0);
+
+    for (unsigned i = 0; i < numQueuedHelpers; ++i)
+    {
+        while (!helpers[i]->completed_)
+            TryExecuteItem(0, M_MAX_UNSIGNED);
+        ReturnToPool(helpers[i]);
+    }
 }
 
-unsigned WorkQueue::RemoveWorkItems(const ea::vector<SharedPtr<WorkItem> >& items)
+bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
 {
-    MutexLock lock(queueMutex_);
-    unsigned removed = 0;
+    if (!item || !TryRemoveItem(item))
+        return false;
+
+    // Removed item never executes, let its dependents proceed as if it had completed
+    ReleaseDependents(item.Get(), 0);
+    return true;
+}
 
-    for (auto i = items.begin(); i != items.end(); ++i)
+unsigned WorkQueue::RemoveWorkItems(const ea::vector<SharedPtr<WorkItem> >& items)
+{
+    unsigned numRemoved = 0;
+    for (const SharedPtr<WorkItem>& item : items)
     {
-        auto j = ea::find(queue_.begin(), queue_.end(), i->Get());
-        if (j != queue_.end())
+        if (item && TryRemoveItem(item))
         {
-            auto k = ea::find(workItems_.begin(), workItems_.end(), *i);
-            if (k != workItems_.end())
-            {
-                queue_.erase(j);
-                ReturnToPool(*k);
-                workItems_.erase(k);
-                ++removed;
-            }
+            ReleaseDependents(item.Get(), 0);
+            ++numRemoved;
         }
     }
 
-    return removed;
+    return numRemoved;
 }
 
 void WorkQueue::Pause()
 {
-    if (!paused_)
-    {
-        pausing_ = true;
-
-        queueMutex_.Acquire();
-        paused_ = true;
-
-        pausing_ = false;
-    }
+    paused_ = true;
 }
 
 void WorkQueue::Resume()
 {
-    if (paused_)
-    {
-        queueMutex_.Release();
-        paused_ = false;
-    }
+    if (paused_.exchange(false))
+        idleWorkers_->WakeAll();
 }
 
-
 void WorkQueue::Complete(unsigned priority)
 {
     completing_ = true;
@@ -263,43 +455,17 @@ void WorkQueue::Complete(unsigned priority)
     {
         Resume();
 
-        // Take work items also in the main thread until queue empty or no high-priority items anymore
-        while (!queue_.empty())
-        {
-            queueMutex_.Acquire();
-            if (!queue_.empty() && queue_.front()->priority_ >= priority)
-            {
-                WorkItem* item = queue_.front();
-                queue_.pop_front();
-                queueMutex_.Release();
-                item->workFunction_(item, 0);
-                item->completed_ = true;
-            }
-            else
-            {
-                queueMutex_.Release();
-                break;
-            }
-        }
-
-        // Wait for threaded work to complete
-        while (!IsCompleted(priority))
+        // Take work items also in the main thread until no high-priority items are left, then wait for threaded
+        // work to complete. Completion is checked only when out of work, as it walks all the items
+        while (TryExecuteItem(0, priority) || !IsCompleted(priority))
         {
         }
-
-        // If no work at all remaining, pause worker threads by leaving the mutex locked
-        if (queue_.empty())
-            Pause();
     }
     else
     {
         // No worker threads: ensure all high-priority items are completed in the main thread
-        while (!queue_.empty() && queue_.front()->priority_ >= priority)
+        while (TryExecuteItem(0, priority))
         {
-            WorkItem* item = queue_.front();
-            queue_.pop_front();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
         }
     }
 
@@ -332,37 +498,175 @@ bool WorkQueue::IsCompleted(unsigned priority) const
 
 void WorkQueue::ProcessItems(unsigned threadIndex)
 {
-    bool wasActive = false;
+    currentThreadIndex = threadIndex;
+    unsigned numIdleSpins = 0;
 
-    for (;;)
+    while (!shutDown_)
     {
-        if (shutDown_)
-            return;
-
-        if (pausing_ && !wasActive)
+        if (!paused_ && TryExecuteItem(threadIndex, 0))
+            numIdleSpins = 0;
+        else if (++numIdleSpins < MAX_IDLE_SPINS)
             Time::Sleep(0);
         else
         {
-            queueMutex_.Acquire();
-            if (!queue_.empty())
-            {
-                wasActive = true;
+            // Block until more work is queued, so that idle workers do not spin on the shared state
+            idleWorkers_->Wait([this] { return !shutDown_ && (paused_ || !HasQueuedItems()); });
+            numIdleSpins = 0;
+        }
+    }
+}
 
-                WorkItem* item = queue_.front();
-                queue_.pop_front();
-                queueMutex_.Release();
-                item->workFunction_(item, threadIndex);
-                item->completed_ = true;
-            }
-            else
-            {
-                wasActive = false;
+void WorkQueue::ScheduleItem(WorkItem* item, unsigned threadIndex)
+{
+    PushItem(item, threadIndex);
+    WakeWorker();
+}
 
-                queueMutex_.Release();
-                Time::Sleep(0);
-            }
+void WorkQueue::PushItem(WorkItem* item, unsigned threadIndex)
+{
+    item->scheduled_ = true;
+    ++item->numQueuedRefs_;
+
+    if (!deques_[threadIndex]->Push(item))
+        PushSharedItem(item);
+}
+
+void WorkQueue::PushSharedItem(WorkItem* item)
+{
+    MutexLock lock(queueMutex_);
+
+    // Find position for new item
+    auto i = queue_.begin();
+    while (i != queue_.end() && (*i)->priority_ > item->priority_)
+        ++i;
+    queue_.insert(i, item);
+    ++queueSize_;
+}
+
+bool WorkQueue::TryExecuteItem(unsigned threadIndex, unsigned priority)
+{
+    const unsigned numDeques = deques_.size();
+    for (;;)
+    {
+        // Prefer own deque, most recently pushed items are most likely to be hot in cache. Then steal from other
+        // threads, starting from the next one to spread the thieves
+        WorkItem* item = deques_[threadIndex]->Pop();
+        for (unsigned i = 1; !item && i < numDeques; ++i)
+            item = deques_[(threadIndex + i) % numDeques]->Steal();
+
+        if (!item)
+            break;
+
+        // Main thread does not execute work below the priority it is completing, as user submitted work could then
+        // manipulate the scene in the middle of the render update. Leave such items to the worker threads in priority
+        // order. The item keeps its reference count, as it is still queued
+        if (item->priority_ < priority)
+        {
+            PushSharedItem(item);
+            WakeWorker();
+            continue;
+        }
+
+        if (TakeItem(item))
+        {
+            ExecuteItem(item, threadIndex);
+            return true;
+        }
+    }
+
+    // Fall back to the shared prioritized queue
+    while (queueSize_.load(std::memory_order_relaxed) > 0)
+    {
+        WorkItem* item = nullptr;
+        {
+            MutexLock lock(queueMutex_);
+            if (queue_.empty() || queue_.front()->priority_ < priority)
+                break;
+
+            item = queue_.front();
+            queue_.pop_front();
+            --queueSize_;
+        }
+
+        if (TakeItem(item))
+        {
+            ExecuteItem(item, threadIndex);
+            return true;
         }
     }
+
+    return false;
+}
+
+bool WorkQueue::TakeItem(WorkItem* item)
+{
+    const bool taken = item->scheduled_.exchange(false);
+    // Must be the last access to an item which was not taken, as the main thread recycles removed items as soon as
+    // no references are left
+    --item->numQueuedRefs_;
+    return taken;
+}
+
+bool WorkQueue::TryRemoveItem(const SharedPtr<WorkItem>& item)
+{
+    auto i = ea::find(workItems_.begin(), workItems_.end(), item);
+    if (i == workItems_.end())
+        return false;
+
+    // Can only remove successfully if the item was queued and not yet taken by threads for execution
+    if (!item->scheduled_.exchange(false))
+        return false;
+
+    // Deques may still point to the item, keep it alive until they have been drained
+    removedItems_.push_back(item);
+    workItems_.erase(i);
+    return true;
+}
+
+bool WorkQueue::HasQueuedItems() const
+{
+    if (queueSize_.load(std::memory_order_relaxed) > 0)
+        return true;
+
+    for (const auto& deque : deques_)
+    {
+        if (!deque->IsEmpty())
+            return true;
+    }
+
+    return false;
+}
+
+void WorkQueue::WakeWorker()
+{
+    if (!threads_.empty())
+        idleWorkers_->WakeOne();
+}
+
+void WorkQueue::ExecuteItem(WorkItem* item, unsigned threadIndex)
+{
+    item->workFunction_(item, threadIndex);
+    ReleaseDependents(item, threadIndex);
+
+    // Must be the last access to the item, as the main thread may recycle it as soon as it's marked completed
+    item->completed_ = true;
+}
+
+void WorkQueue::ReleaseDependents(WorkItem* item, unsigned threadIndex)
+{
+    // Schedule the dependents which were waiting only for this item. Do it outside of the lock to not hold two locks
+    ea::vector<WorkItem*> dependents;
+    {
+        MutexLock lock(item->dependentsMutex_);
+        item->dependentsReleased_ = true;
+        dependents.swap(item->dependents_);
+    }
+
+    for (WorkItem* dependent : dependents)
+    {
+        if (--dependent->pendingDependencies_ == 0)
+            ScheduleItem(dependent, threadIndex);
+    }
 }
 
 void WorkQueue::PurgeCompleted(unsigned priority)
@@ -383,12 +687,32 @@ void WorkQueue::PurgeCompleted(unsigned priority)
                 SendEvent(E_WORKITEMCOMPLETED, eventData);
             }
 
-            ReturnToPool(*i);
+            // Item which was removed and added again may still be referenced from a deque
+            if ((*i)->numQueuedRefs_ > 0)
+                removedItems_.push_back(*i);
+            else
+                ReturnToPool(*i);
             i = workItems_.erase(i);
         }
         else
             ++i;
     }
+
+    PurgeRemoved();
+}
+
+void WorkQueue::PurgeRemoved()
+{
+    for (auto i = removedItems_.begin(); i != removedItems_.end();)
+    {
+        if ((*i)->numQueuedRefs_ == 0)
+        {
+            ReturnToPool(*i);
+            i = removedItems_.erase(i);
+        }
+        else
+            ++i;
+    }
 }
 
 void WorkQueue::PurgePool()
@@ -419,6 +743,8 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
         item->priority_ = M_MAX_UNSIGNED;
         item->sendEvent_ = false;
         item->completed_ = false;
+        // Item stays released until it is queued again, so that late dependents added on it do not wait forever
+        item->dependentsReleased_ = true;
 
         poolItems_.push_back(item);
     }
@@ -427,18 +753,14 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
 void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
     // If no worker threads, complete low-priority work here
-    if (threads_.empty() && !queue_.empty())
+    if (threads_.empty() && HasQueuedItems())
     {
         URHO3D_PROFILE("CompleteWorkNonthreaded");
 
         HiresTimer timer;
 
-        while (!queue_.empty() && timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000LL)
+        while (timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000LL && TryExecuteItem(0, 0))
         {
-            WorkItem* item = queue_.front();
-            queue_.pop_front();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
         }
     }
 
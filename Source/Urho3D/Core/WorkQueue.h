@@ -23,6 +23,7 @@
 #pragma once
 
 #include <EASTL/list.h>
+#include <EASTL/unique_ptr.h>
 #include <atomic>
 
 #include "../Core/Mutex.h"
@@ -37,7 +38,9 @@ URHO3D_EVENT(E_WORKITEMCOMPLETED, WorkItemCompleted)
     URHO3D_PARAM(P_ITEM, Item);                        // WorkItem ptr
 }
 
+class IdleWorkers;
 class WorkerThread;
+class WorkStealingDeque;
 
 /// Work queue item.
 struct WorkItem : public RefCounted
@@ -64,8 +67,23 @@ private:
     bool pooled_{};
     /// Work function. Called without any parameters.
     std::function<void()> workLambda_;
+    /// Number of dependencies that have not completed yet. Item is scheduled when this reaches zero.
+    std::atomic<int> pendingDependencies_{};
+    /// Whether the item is queued and was not yet taken for execution or removed. Whoever clears the flag owns the item.
+    std::atomic<bool> scheduled_{};
+    /// Number of references to the item from the work-stealing deques and the shared queue.
+    std::atomic<int> numQueuedRefs_{};
+    /// Items waiting for this item to complete. Guarded by dependentsMutex_.
+    ea::vector<WorkItem*> dependents_;
+    /// Whether dependents were already released. True unless the item is queued and not yet executed or removed. Guarded by dependentsMutex_.
+    bool dependentsReleased_{true};
+    /// Dependents list mutex.
+    Mutex dependentsMutex_;
 };
 
+/// Function executed by WorkQueue::ParallelFor. Called with range begin, range end and thread index (0 = main thread) as parameters.
+using ParallelForFunction = std::function<void(unsigned, unsigned, unsigned)>;
+
 /// Work queue subsystem for multithreading.
 class URHO3D_API WorkQueue : public Object
 {
@@ -87,7 +105,13 @@ public:
     void AddWorkItem(const SharedPtr<WorkItem>& item);
     /// Add a work item and resume worker threads.
     SharedPtr<WorkItem> AddWorkItem(std::function<void()> workFunction, unsigned priority = 0);
-    /// Remove a work item before it has started executing. Return true if successfully removed.
+    /// Add a work item which is scheduled only after all dependencies have completed. Dependencies must have been added to the queue already.
+    void AddWorkItem(const SharedPtr<WorkItem>& item, const ea::vector<SharedPtr<WorkItem> >& dependencies);
+    /// Add a work item which is scheduled only after all dependencies have completed. Dependencies must have been added to the queue already.
+    SharedPtr<WorkItem> AddWorkItem(std::function<void()> workFunction, const ea::vector<SharedPtr<WorkItem> >& dependencies, unsigned priority = 0);
+    /// Execute function over range [0, count) split into batches of at least batchSize elements. Batches are distributed over worker threads and the calling thread, and the call returns when all of them are done. When called from a worker thread the function is executed inline.
+    void ParallelFor(unsigned count, unsigned batchSize, const ParallelForFunction& function);
+    /// Remove a work item before it has started executing. Return true if successfully removed. Items waiting for their dependencies can not be removed. Items depending on the removed item are released as if it had completed.
     bool RemoveWorkItem(SharedPtr<WorkItem> item);
     /// Remove a number of work items before they have started executing. Return the number of items successfully removed.
     unsigned RemoveWorkItems(const ea::vector<SharedPtr<WorkItem> >& items);
@@ -123,8 +147,30 @@ public:
 private:
     /// Process work items until shut down. Called by the worker threads.
     void ProcessItems(unsigned threadIndex);
+    /// Queue work item whose dependencies are complete to the work-stealing deque of the thread and wake an idle worker thread.
+    void ScheduleItem(WorkItem* item, unsigned threadIndex);
+    /// Push work item to the work-stealing deque of the thread. Fall back to the shared queue if the deque is full.
+    void PushItem(WorkItem* item, unsigned threadIndex);
+    /// Insert work item to the shared queue in priority order.
+    void PushSharedItem(WorkItem* item);
+    /// Try to execute one work item which has at least the specified priority from own deque, other threads' deques or the shared queue. Lower priority items found in the deques are moved to the shared queue. Return true if an item was executed.
+    bool TryExecuteItem(unsigned threadIndex, unsigned priority);
+    /// Take ownership of an item popped from a deque or the shared queue. Return false if the item was removed or already taken through another reference.
+    bool TakeItem(WorkItem* item);
+    /// Try to remove a queued work item. Keep it alive until no deque references it anymore.
+    bool TryRemoveItem(const SharedPtr<WorkItem>& item);
+    /// Return whether any deque or the shared queue may contain items.
+    bool HasQueuedItems() const;
+    /// Wake one idle worker thread if there are any.
+    void WakeWorker();
+    /// Execute work item, release its dependents and mark it completed.
+    void ExecuteItem(WorkItem* item, unsigned threadIndex);
+    /// Mark item dependents released and schedule the ones which have no more pending dependencies.
+    void ReleaseDependents(WorkItem* item, unsigned threadIndex);
     /// Purge completed work items which have at least the specified priority, and send completion events as necessary.
     void PurgeCompleted(unsigned priority);
+    /// Return removed items to the pool once no deque references them anymore.
+    void PurgeRemoved();
     /// Purge the pool to reduce allocation where its unneeded.
     void PurgePool();
     /// Return a work item to the pool.
@@ -134,20 +180,26 @@ private:
 
     /// Worker threads.
     ea::vector<SharedPtr<WorkerThread> > threads_;
+    /// Work-stealing deques, one per thread (index 0 = main thread). Pushed and popped by owning thread, stolen from by others.
+    ea::vector<ea::unique_ptr<WorkStealingDeque> > deques_;
     /// Work item pool for reuse to cut down on allocation. The bool is a flag for item pooling and whether it is available or not.
     ea::list<SharedPtr<WorkItem> > poolItems_;
     /// Work item collection. Accessed only by the main thread.
     ea::list<SharedPtr<WorkItem> > workItems_;
-    /// Work item prioritized queue for worker threads. Pointers are guaranteed to be valid (point to workItems.)
+    /// Removed work items which may still be referenced from the deques. Accessed only by the main thread.
+    ea::vector<SharedPtr<WorkItem> > removedItems_;
+    /// Prioritized queue for items skipped by the main thread due to their low priority, and for deque overflow. Pointers are guaranteed to be valid (point to workItems.)
     ea::list<WorkItem*> queue_;
-    /// Worker queue mutex.
+    /// Number of items in the shared queue. Checked before taking the mutex.
+    std::atomic<unsigned> queueSize_;
+    /// Shared queue mutex.
     Mutex queueMutex_;
+    /// Idle worker threads waiting for work.
+    ea::unique_ptr<IdleWorkers> idleWorkers_;
     /// Shutting down flag.
     std::atomic<bool> shutDown_;
-    /// Pausing flag. Indicates the worker threads should not contend for the queue mutex.
-    std::atomic<bool> pausing_;
-    /// Paused flag. Indicates the queue mutex being locked to prevent worker threads using up CPU time.
-    bool paused_;
+    /// Paused flag. Worker threads do not take work items while set.
+    std::atomic<bool> paused_;
     /// Completing work in the main thread flag.
     bool completing_;
     /// Tolerance for the shared pool before it begins to deallocate.
@@ -175,6 +175,8 @@ bool Engine::Initialize(const VariantMap& parameters)
             log->SetLevel(static_cast<LogLevel>(GetParameter(parameters, EP_LOG_LEVEL).GetInt()));
         log->SetQuiet(GetParameter(parameters, EP_LOG_QUIET, false).GetBool());
         log->Open(GetParameter(parameters, EP_LOG_NAME, "Urho3D.log").GetString());
+        if (GetParameter(parameters, EP_LOG_ASYNC, false).GetBool())
+            log->SetAsync(true);
     }
 
     // Set headless mode
@@ -710,15 +712,27 @@ void Engine::Update()
     VariantMap& eventData = GetEventDataMap();
     eventData[P_TIMESTEP] = timeStep_;
     SendEvent(E_UPDATE, eventData);
+    UpdateArgs updateArgs;
+    updateArgs.timeStep_ = timeStep_;
+    SendTypedEvent(updateArgs);
 
     // Logic post-update event
     SendEvent(E_POSTUPDATE, eventData);
+    PostUpdateArgs postUpdateArgs;
+    postUpdateArgs.timeStep_ = timeStep_;
+    SendTypedEvent(postUpdateArgs);
 
     // Rendering update event
     SendEvent(E_RENDERUPDATE, eventData);
+    RenderUpdateArgs renderUpdateArgs;
+    renderUpdateArgs.timeStep_ = timeStep_;
+    SendTypedEvent(renderUpdateArgs);
 
     // Post-render update event
     SendEvent(E_POSTRENDERUPDATE, eventData);
+    PostRenderUpdateArgs postRenderUpdateArgs;
+    postRenderUpdateArgs.timeStep_ = timeStep_;
+    SendTypedEvent(postRenderUpdateArgs);
 }
 
 void Engine::Render()
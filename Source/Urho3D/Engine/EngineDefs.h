@@ -40,6 +40,7 @@ static const ea::string EP_FRAME_LIMITER = "FrameLimiter";
 static const ea::string EP_FULL_SCREEN = "FullScreen";
 static const ea::string EP_HEADLESS = "Headless";
 static const ea::string EP_HIGH_DPI = "HighDPI";
+static const ea::string EP_LOG_ASYNC = "LogAsync";
 static const ea::string EP_LOG_LEVEL = "LogLevel";
 static const ea::string EP_LOG_NAME = "LogName";
 static const ea::string EP_LOG_QUIET = "LogQuiet";
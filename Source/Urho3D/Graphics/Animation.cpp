@@ -50,12 +50,76 @@ inline bool CompareKeyFrames(const AnimationKeyFrame& lhs, const AnimationKeyFra
     return lhs.time_ < rhs.time_;
 }
 
+/// Find the last keyframe at or before the time. The previous index is used as a hint for sequential playback; on jumps the
+/// keyframe is found with a binary search.
+template <class T> void FindKeyFrameIndex(float time, unsigned numKeyFrames, const T& getTime, unsigned& index)
+{
+    if (!numKeyFrames)
+    {
+        index = 0;
+        return;
+    }
+
+    if (time < 0.0f)
+        time = 0.0f;
+
+    if (index >= numKeyFrames)
+        index = numKeyFrames - 1;
+
+    // Check the previous keyframe and the one after it first, which covers sequential playback
+    const auto containsTime = [&](unsigned i)
+    {
+        return (!i || time >= getTime(i)) && (i == numKeyFrames - 1 || time < getTime(i + 1));
+    };
+
+    if (containsTime(index))
+        return;
+    if (index < numKeyFrames - 1 && containsTime(index + 1))
+    {
+        ++index;
+        return;
+    }
+
+    // Time jumped: find the first keyframe after the time and step back
+    unsigned first = 0;
+    unsigned count = numKeyFrames;
+    while (count > 0)
+    {
+        const unsigned step = count / 2;
+        if (time >= getTime(first + step))
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+            count = step;
+    }
+    index = first ? first - 1 : 0;
+}
+
+/// Components stored for each keyframe in AnimationTrackArrays.
+enum AnimationTrackComponent
+{
+    COMPONENT_POSITION_X = 0,
+    COMPONENT_POSITION_Y,
+    COMPONENT_POSITION_Z,
+    COMPONENT_ROTATION_W,
+    COMPONENT_ROTATION_X,
+    COMPONENT_ROTATION_Y,
+    COMPONENT_ROTATION_Z,
+    COMPONENT_SCALE_X,
+    COMPONENT_SCALE_Y,
+    COMPONENT_SCALE_Z,
+    MAX_ANIMATION_TRACK_COMPONENTS
+};
+
 void AnimationTrack::SetKeyFrame(unsigned index, const AnimationKeyFrame& keyFrame)
 {
     if (index < keyFrames_.size())
     {
         keyFrames_[index] = keyFrame;
         ea::quick_sort(keyFrames_.begin(), keyFrames_.end(), CompareKeyFrames);
+        ++keyFramesVersion_;
     }
     else if (index == keyFrames_.size())
         AddKeyFrame(keyFrame);
@@ -67,22 +131,26 @@ void AnimationTrack::AddKeyFrame(const AnimationKeyFrame& keyFrame)
     keyFrames_.push_back(keyFrame);
     if (needSort)
         ea::quick_sort(keyFrames_.begin(), keyFrames_.end(), CompareKeyFrames);
+    ++keyFramesVersion_;
 }
 
 void AnimationTrack::InsertKeyFrame(unsigned index, const AnimationKeyFrame& keyFrame)
 {
     keyFrames_.insert_at(index, keyFrame);
     ea::quick_sort(keyFrames_.begin(), keyFrames_.end(), CompareKeyFrames);
+    ++keyFramesVersion_;
 }
 
 void AnimationTrack::RemoveKeyFrame(unsigned index)
 {
     keyFrames_.erase_at(index);
+    ++keyFramesVersion_;
 }
 
 void AnimationTrack::RemoveAllKeyFrames()
 {
     keyFrames_.clear();
+    ++keyFramesVersion_;
 }
 
 AnimationKeyFrame* AnimationTrack::GetKeyFrame(unsigned index)
@@ -92,19 +160,173 @@ AnimationKeyFrame* AnimationTrack::GetKeyFrame(unsigned index)
 
 void AnimationTrack::GetKeyFrameIndex(float time, unsigned& index) const
 {
-    if (time < 0.0f)
-        time = 0.0f;
+    FindKeyFrameIndex(time, keyFrames_.size(), [this](unsigned i) { return keyFrames_[i].time_; }, index);
+}
 
-    if (index >= keyFrames_.size())
-        index = keyFrames_.size() - 1;
+void AnimationTrack::Sample(float time, float animationLength, bool looped, unsigned& index, Vector3& position, Quaternion& rotation,
+    Vector3& scale) const
+{
+    GetKeyFrameIndex(time, index);
 
-    // Check for being too far ahead
-    while (index && time < keyFrames_[index].time_)
-        --index;
+    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
+    unsigned nextIndex = index + 1;
+    bool interpolate = true;
+    if (nextIndex >= keyFrames_.size())
+    {
+        if (!looped)
+        {
+            nextIndex = index;
+            interpolate = false;
+        }
+        else
+            nextIndex = 0;
+    }
 
-    // Check for being too far behind
-    while (index < keyFrames_.size() - 1 && time >= keyFrames_[index + 1].time_)
-        ++index;
+    const AnimationKeyFrame* keyFrame = &keyFrames_[index];
+
+    if (interpolate)
+    {
+        const AnimationKeyFrame* nextKeyFrame = &keyFrames_[nextIndex];
+        float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
+        if (timeInterval < 0.0f)
+            timeInterval += animationLength;
+        float t = timeInterval > 0.0f ? (time - keyFrame->time_) / timeInterval : 1.0f;
+
+        if (channelMask_ & CHANNEL_POSITION)
+            position = keyFrame->position_.Lerp(nextKeyFrame->position_, t);
+        if (channelMask_ & CHANNEL_ROTATION)
+            rotation = keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t);
+        if (channelMask_ & CHANNEL_SCALE)
+            scale = keyFrame->scale_.Lerp(nextKeyFrame->scale_, t);
+    }
+    else
+    {
+        if (channelMask_ & CHANNEL_POSITION)
+            position = keyFrame->position_;
+        if (channelMask_ & CHANNEL_ROTATION)
+            rotation = keyFrame->rotation_;
+        if (channelMask_ & CHANNEL_SCALE)
+            scale = keyFrame->scale_;
+    }
+}
+
+bool AnimationTrackArrays::Build(const ea::unordered_map<StringHash, AnimationTrack>& tracks)
+{
+    Clear();
+    if (tracks.empty())
+        return false;
+
+    const ea::vector<AnimationKeyFrame>& firstKeyFrames = tracks.begin()->second.keyFrames_;
+    const unsigned numKeyFrames = firstKeyFrames.size();
+    if (!numKeyFrames)
+        return false;
+
+    for (auto i = tracks.begin(); i != tracks.end(); ++i)
+    {
+        const ea::vector<AnimationKeyFrame>& keyFrames = i->second.keyFrames_;
+        if (keyFrames.size() != numKeyFrames)
+            return false;
+        for (unsigned j = 0; j < numKeyFrames; ++j)
+        {
+            if (keyFrames[j].time_ != firstKeyFrames[j].time_)
+                return false;
+        }
+    }
+
+    const unsigned numTracks = tracks.size();
+    times_.resize(numKeyFrames);
+    values_.resize(numKeyFrames * MAX_ANIMATION_TRACK_COMPONENTS * numTracks);
+    tracks_.reserve(numTracks);
+
+    for (unsigned i = 0; i < numKeyFrames; ++i)
+        times_[i] = firstKeyFrames[i].time_;
+
+    for (auto i = tracks.begin(); i != tracks.end(); ++i)
+    {
+        const unsigned trackIndex = tracks_.size();
+        tracks_.push_back(&i->second);
+
+        const ea::vector<AnimationKeyFrame>& keyFrames = i->second.keyFrames_;
+        for (unsigned j = 0; j < numKeyFrames; ++j)
+        {
+            const AnimationKeyFrame& keyFrame = keyFrames[j];
+            float* row = &values_[j * MAX_ANIMATION_TRACK_COMPONENTS * numTracks + trackIndex];
+            row[COMPONENT_POSITION_X * numTracks] = keyFrame.position_.x_;
+            row[COMPONENT_POSITION_Y * numTracks] = keyFrame.position_.y_;
+            row[COMPONENT_POSITION_Z * numTracks] = keyFrame.position_.z_;
+            row[COMPONENT_ROTATION_W * numTracks] = keyFrame.rotation_.w_;
+            row[COMPONENT_ROTATION_X * numTracks] = keyFrame.rotation_.x_;
+            row[COMPONENT_ROTATION_Y * numTracks] = keyFrame.rotation_.y_;
+            row[COMPONENT_ROTATION_Z * numTracks] = keyFrame.rotation_.z_;
+            row[COMPONENT_SCALE_X * numTracks] = keyFrame.scale_.x_;
+            row[COMPONENT_SCALE_Y * numTracks] = keyFrame.scale_.y_;
+            row[COMPONENT_SCALE_Z * numTracks] = keyFrame.scale_.z_;
+        }
+    }
+
+    return true;
+}
+
+void AnimationTrackArrays::Clear()
+{
+    tracks_.clear();
+    times_.clear();
+    values_.clear();
+}
+
+void AnimationTrackArrays::Sample(float time, float animationLength, bool looped, unsigned& index, Vector3* positions,
+    Quaternion* rotations, Vector3* scales) const
+{
+    const unsigned numKeyFrames = times_.size();
+    const unsigned numTracks = tracks_.size();
+    FindKeyFrameIndex(time, numKeyFrames, [this](unsigned i) { return times_[i]; }, index);
+
+    // Same keyframe pair and interpolation factor as AnimationTrack::Sample, but found once for all tracks
+    unsigned nextIndex = index + 1;
+    if (nextIndex >= numKeyFrames)
+        nextIndex = looped ? 0 : index;
+
+    float t = 0.0f;
+    if (nextIndex != index)
+    {
+        float timeInterval = times_[nextIndex] - times_[index];
+        if (timeInterval < 0.0f)
+            timeInterval += animationLength;
+        t = timeInterval > 0.0f ? (time - times_[index]) / timeInterval : 1.0f;
+    }
+
+    const unsigned rowSize = MAX_ANIMATION_TRACK_COMPONENTS * numTracks;
+    const float* from = &values_[index * rowSize];
+    const float* to = &values_[nextIndex * rowSize];
+    const auto getVector3 = [numTracks](const float* row, unsigned component, unsigned i)
+    {
+        return Vector3(row[component * numTracks + i], row[(component + 1) * numTracks + i], row[(component + 2) * numTracks + i]);
+    };
+    const auto getQuaternion = [numTracks](const float* row, unsigned i)
+    {
+        return Quaternion(row[COMPONENT_ROTATION_W * numTracks + i], row[COMPONENT_ROTATION_X * numTracks + i],
+            row[COMPONENT_ROTATION_Y * numTracks + i], row[COMPONENT_ROTATION_Z * numTracks + i]);
+    };
+
+    // Interpolate with the same functions as the per-track path, so that both give the same poses on every platform
+    if (nextIndex != index)
+    {
+        for (unsigned i = 0; i < numTracks; ++i)
+        {
+            positions[i] = getVector3(from, COMPONENT_POSITION_X, i).Lerp(getVector3(to, COMPONENT_POSITION_X, i), t);
+            rotations[i] = getQuaternion(from, i).Slerp(getQuaternion(to, i), t);
+            scales[i] = getVector3(from, COMPONENT_SCALE_X, i).Lerp(getVector3(to, COMPONENT_SCALE_X, i), t);
+        }
+    }
+    else
+    {
+        for (unsigned i = 0; i < numTracks; ++i)
+        {
+            positions[i] = getVector3(from, COMPONENT_POSITION_X, i);
+            rotations[i] = getQuaternion(from, i);
+            scales[i] = getVector3(from, COMPONENT_SCALE_X, i);
+        }
+    }
 }
 
 Animation::Animation(Context* context) :
@@ -136,6 +358,7 @@ bool Animation::BeginLoad(Deserializer& source)
     animationNameHash_ = animationName_;
     length_ = source.ReadFloat();
     tracks_.clear();
+    trackArraysDirty_ = true;
 
     unsigned tracks = source.ReadUInt();
     memoryUse += tracks * sizeof(AnimationTrack);
@@ -301,6 +524,7 @@ AnimationTrack* Animation::CreateTrack(const ea::string& name)
     if (oldTrack)
         return oldTrack;
 
+    trackArraysDirty_ = true;
     AnimationTrack& newTrack = tracks_[nameHash];
     newTrack.name_ = name;
     newTrack.nameHash_ = nameHash;
@@ -312,6 +536,7 @@ bool Animation::RemoveTrack(const ea::string& name)
     auto i = tracks_.find(StringHash(name));
     if (i != tracks_.end())
     {
+        trackArraysDirty_ = true;
         tracks_.erase(i);
         return true;
     }
@@ -321,6 +546,7 @@ bool Animation::RemoveTrack(const ea::string& name)
 
 void Animation::RemoveAllTracks()
 {
+    trackArraysDirty_ = true;
     tracks_.clear();
 }
 
@@ -375,6 +601,7 @@ SharedPtr<Animation> Animation::Clone(const ea::string& cloneName) const
     ret->SetAnimationName(animationName_);
     ret->length_ = length_;
     ret->tracks_ = tracks_;
+    ret->useTrackArrays_ = useTrackArrays_;
     ret->triggers_ = triggers_;
     ret->CopyMetadata(*this);
     ret->SetMemoryUse(GetMemoryUse());
@@ -391,7 +618,11 @@ AnimationTrack* Animation::GetTrack(unsigned index)
     for(auto i = tracks_.begin(); i != tracks_.end(); ++i)
     {
         if (j == index)
+        {
+            // The track may be edited through the returned pointer
+            trackArraysDirty_ = true;
             return &i->second;
+        }
 
         ++j;
     }
@@ -401,14 +632,18 @@ AnimationTrack* Animation::GetTrack(unsigned index)
 
 AnimationTrack* Animation::GetTrack(const ea::string& name)
 {
-    auto i = tracks_.find(StringHash(name));
-    return i != tracks_.end() ? &i->second : nullptr;
+    return GetTrack(StringHash(name));
 }
 
 AnimationTrack* Animation::GetTrack(StringHash nameHash)
 {
     auto i = tracks_.find(nameHash);
-    return i != tracks_.end() ? &i->second : nullptr;
+    if (i == tracks_.end())
+        return nullptr;
+
+    // The track may be edited through the returned pointer
+    trackArraysDirty_ = true;
+    return &i->second;
 }
 
 AnimationTriggerPoint* Animation::GetTrigger(unsigned index)
@@ -419,6 +654,7 @@ AnimationTriggerPoint* Animation::GetTrigger(unsigned index)
 void Animation::SetTracks(const ea::vector<AnimationTrack>& tracks)
 {
     tracks_.clear();
+    trackArraysDirty_ = true;
 
     for (auto itr = tracks.begin(); itr != tracks.end(); itr++)
     {
@@ -426,4 +662,34 @@ void Animation::SetTracks(const ea::vector<AnimationTrack>& tracks)
     }
 }
 
+const AnimationTrackArrays* Animation::GetTrackArrays() const
+{
+    if (!useTrackArrays_)
+        return nullptr;
+
+    // Several animation states may sample this animation at once in worker threads, so rebuild under the mutex
+    const unsigned version = GetKeyFramesVersion();
+    if (trackArraysDirty_ || version != trackArraysVersion_)
+    {
+        MutexLock lock(trackArraysMutex_);
+        if (trackArraysDirty_ || version != trackArraysVersion_)
+        {
+            URHO3D_PROFILE("BuildAnimationTrackArrays");
+            trackArrays_.Build(tracks_);
+            trackArraysVersion_ = version;
+            trackArraysDirty_ = false;
+        }
+    }
+
+    return !trackArrays_.IsEmpty() ? &trackArrays_ : nullptr;
+}
+
+unsigned Animation::GetKeyFramesVersion() const
+{
+    unsigned version = 0;
+    for (auto i = tracks_.begin(); i != tracks_.end(); ++i)
+        version += i->second.keyFramesVersion_;
+    return version;
+}
+
 }
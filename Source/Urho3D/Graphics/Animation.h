@@ -24,8 +24,11 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "../Container/FlagSet.h"
 #include "../Container/Ptr.h"
+#include "../Core/Mutex.h"
 #include "../Math/Quaternion.h"
 #include "../Math/Vector3.h"
 #include "../Resource/Resource.h"
@@ -97,8 +100,10 @@ struct URHO3D_API AnimationTrack
     AnimationKeyFrame* GetKeyFrame(unsigned index);
     /// Return number of keyframes.
     unsigned GetNumKeyFrames() const { return keyFrames_.size(); }
-    /// Return keyframe index based on time and previous index.
+    /// Return keyframe index based on time and previous index. The previous index is used as a hint for sequential playback; on jumps the keyframe is found with a binary search.
     void GetKeyFrameIndex(float time, unsigned& index) const;
+    /// Sample the channels included in the channel mask at time, updating the keyframe index hint. Track must not be empty.
+    void Sample(float time, float animationLength, bool looped, unsigned& index, Vector3& position, Quaternion& rotation, Vector3& scale) const;
 
     /// Bone or scene node name.
     ea::string name_;
@@ -108,6 +113,8 @@ struct URHO3D_API AnimationTrack
     AnimationChannelFlags channelMask_{};
     /// Keyframes.
     ea::vector<AnimationKeyFrame> keyFrames_;
+    /// Keyframe change counter, incremented by the keyframe setters so that the animation rebuilds its keyframe arrays.
+    unsigned keyFramesVersion_{};
 
     /// Instance equality operator.
     bool operator ==(const AnimationTrack& rhs) const
@@ -122,6 +129,31 @@ struct URHO3D_API AnimationTrack
     }
 };
 
+/// Keyframes of all tracks of an animation in structure of arrays layout, so that all tracks are sampled in one pass over
+/// contiguous memory with a single keyframe lookup. Only built when all tracks have keyframes at the same times.
+struct URHO3D_API AnimationTrackArrays
+{
+    /// Build from tracks. Return false and leave empty if the tracks do not share keyframe times.
+    bool Build(const ea::unordered_map<StringHash, AnimationTrack>& tracks);
+    /// Clear.
+    void Clear();
+    /// Sample all tracks at time into arrays indexed like tracks_, updating the keyframe index hint. Gives the same results
+    /// as AnimationTrack::Sample.
+    void Sample(float time, float animationLength, bool looped, unsigned& index, Vector3* positions, Quaternion* rotations,
+        Vector3* scales) const;
+
+    /// Return whether built.
+    bool IsEmpty() const { return tracks_.empty(); }
+
+    /// Tracks in array order.
+    ea::vector<const AnimationTrack*> tracks_;
+    /// Keyframe times shared by all tracks.
+    ea::vector<float> times_;
+    /// Keyframe values. For each keyframe there is one row per position, rotation and scale component, holding that
+    /// component of all tracks.
+    ea::vector<float> values_;
+};
+
 /// %Animation trigger point.
 struct AnimationTriggerPoint
 {
@@ -226,7 +258,21 @@ public:
 
     /// Set all animation tracks.
     void SetTracks(const ea::vector<AnimationTrack>& tracks);
+    /// Set whether to sample all tracks at once from the structure of arrays keyframe layout when they share keyframe times. Default true.
+    void SetUseTrackArrays(bool enable) { useTrackArrays_ = enable; }
+    /// Mark the structure of arrays keyframe layout to be rebuilt on the next sample. Changing tracks through the animation
+    /// and the keyframe setters of a track do this already; only needed after writing keyFrames_ of a track directly.
+    void MarkTrackArraysDirty() { trackArraysDirty_ = true; }
+
+    /// Return whether to sample all tracks at once from the structure of arrays keyframe layout.
+    bool GetUseTrackArrays() const { return useTrackArrays_; }
+    /// Return the structure of arrays keyframe layout, rebuilding it first if the tracks have changed. Return null if disabled or the tracks do not share keyframe times.
+    const AnimationTrackArrays* GetTrackArrays() const;
+
 private:
+    /// Return the sum of the keyframe change counters of all tracks.
+    unsigned GetKeyFramesVersion() const;
+
     /// Animation name.
     ea::string animationName_;
     /// Animation name hash.
@@ -237,6 +283,16 @@ private:
     ea::unordered_map<StringHash, AnimationTrack> tracks_;
     /// Animation trigger points.
     ea::vector<AnimationTriggerPoint> triggers_;
+    /// Keyframes of all tracks in structure of arrays layout. Rebuilt on demand.
+    mutable AnimationTrackArrays trackArrays_;
+    /// Keyframe change counter sum of the tracks when the structure of arrays layout was built.
+    mutable std::atomic<unsigned> trackArraysVersion_{};
+    /// Structure of arrays layout needs rebuild flag.
+    mutable std::atomic<bool> trackArraysDirty_{true};
+    /// Mutex for rebuilding the structure of arrays layout, as animation states may sample in worker threads.
+    mutable Mutex trackArraysMutex_;
+    /// Sample from the structure of arrays layout flag.
+    bool useTrackArrays_{true};
 };
 
 }
@@ -37,7 +37,8 @@ AnimationStateTrack::AnimationStateTrack() :
     track_(nullptr),
     bone_(nullptr),
     weight_(1.0f),
-    keyFrame_(0)
+    keyFrame_(0),
+    arrayIndex_(M_MAX_UNSIGNED)
 {
 }
 
@@ -47,6 +48,8 @@ AnimationState::AnimationState(AnimatedModel* model, Animation* animation) :
     model_(model),
     animation_(animation),
     startBone_(nullptr),
+    sampledFromArrays_(false),
+    arrayKeyFrame_(0),
     looped_(false),
     weight_(0.0f),
     time_(0.0f),
@@ -61,6 +64,8 @@ AnimationState::AnimationState(Node* node, Animation* animation) :
     node_(node),
     animation_(animation),
     startBone_(nullptr),
+    sampledFromArrays_(false),
+    arrayKeyFrame_(0),
     looped_(false),
     weight_(1.0f),
     time_(0.0f),
@@ -447,90 +452,107 @@ void AnimationState::Apply()
     if (!animation_ || !IsEnabled())
         return;
 
+    SampleTracks();
+
     if (model_)
         ApplyToModel();
     else
         ApplyToNodes();
 }
 
-void AnimationState::ApplyToModel()
+void AnimationState::SampleTracks()
 {
-    for (auto i = stateTracks_.begin(); i != stateTracks_.end(); ++i)
+    const float length = animation_->GetLength();
+
+    // Sampling all tracks of the animation in one pass only pays off when most of them are played, which is not the case
+    // with a start bone deep in the skeleton
+    const AnimationTrackArrays* trackArrays = animation_->GetTrackArrays();
+    sampledFromArrays_ = trackArrays && stateTracks_.size() * 2 >= trackArrays->tracks_.size() && MapArrayTracks(*trackArrays);
+    if (sampledFromArrays_)
     {
-        AnimationStateTrack& stateTrack = *i;
-        float finalWeight = weight_ * stateTrack.weight_;
+        const unsigned numArrayTracks = trackArrays->tracks_.size();
+        sampledPositions_.resize(numArrayTracks);
+        sampledRotations_.resize(numArrayTracks);
+        sampledScales_.resize(numArrayTracks);
+        trackArrays->Sample(time_, length, looped_, arrayKeyFrame_, sampledPositions_.data(), sampledRotations_.data(),
+            sampledScales_.data());
+        return;
+    }
+
+    const unsigned numTracks = stateTracks_.size();
+    sampledPositions_.resize(numTracks);
+    sampledRotations_.resize(numTracks);
+    sampledScales_.resize(numTracks);
 
-        // Do not apply if zero effective weight or the bone has animation disabled
-        if (Equals(finalWeight, 0.0f) || !stateTrack.bone_->animated_)
+    for (unsigned i = 0; i < numTracks; ++i)
+    {
+        AnimationStateTrack& stateTrack = stateTracks_[i];
+        if (!IsTrackActive(stateTrack))
             continue;
 
-        ApplyTrack(stateTrack, finalWeight, true);
+        stateTrack.track_->Sample(time_, length, looped_, stateTrack.keyFrame_,
+            sampledPositions_[i], sampledRotations_[i], sampledScales_[i]);
     }
 }
 
-void AnimationState::ApplyToNodes()
+bool AnimationState::MapArrayTracks(const AnimationTrackArrays& trackArrays)
 {
-    // When applying to a node hierarchy, can only use full weight (nothing to blend to)
-    for (auto i = stateTracks_.begin(); i != stateTracks_.end(); ++i)
-        ApplyTrack(*i, 1.0f, false);
+    const ea::vector<const AnimationTrack*>& arrayTracks = trackArrays.tracks_;
+    for (AnimationStateTrack& stateTrack : stateTracks_)
+    {
+        if (stateTrack.arrayIndex_ < arrayTracks.size() && arrayTracks[stateTrack.arrayIndex_] == stateTrack.track_)
+            continue;
+
+        const auto iter = ea::find(arrayTracks.begin(), arrayTracks.end(), stateTrack.track_);
+        if (iter == arrayTracks.end())
+            return false;
+        stateTrack.arrayIndex_ = (unsigned)(iter - arrayTracks.begin());
+    }
+    return true;
 }
 
-void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, bool silent)
+bool AnimationState::IsTrackActive(const AnimationStateTrack& stateTrack) const
 {
-    const AnimationTrack* track = stateTrack.track_;
-    Node* node = stateTrack.node_;
+    if (stateTrack.track_->keyFrames_.empty() || !stateTrack.node_)
+        return false;
 
-    if (track->keyFrames_.empty() || !node)
-        return;
+    // Do not apply if zero effective weight or the bone has animation disabled
+    if (model_)
+        return !Equals(weight_ * stateTrack.weight_, 0.0f) && stateTrack.bone_->animated_;
 
-    unsigned& frame = stateTrack.keyFrame_;
-    track->GetKeyFrameIndex(time_, frame);
+    return true;
+}
 
-    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
-    unsigned nextFrame = frame + 1;
-    bool interpolate = true;
-    if (nextFrame >= track->keyFrames_.size())
+void AnimationState::ApplyToModel()
+{
+    for (unsigned i = 0; i < stateTracks_.size(); ++i)
     {
-        if (!looped_)
-        {
-            nextFrame = frame;
-            interpolate = false;
-        }
-        else
-            nextFrame = 0;
+        AnimationStateTrack& stateTrack = stateTracks_[i];
+        if (IsTrackActive(stateTrack))
+            ApplyTrack(stateTrack, i, weight_ * stateTrack.weight_, true);
     }
+}
 
-    const AnimationKeyFrame* keyFrame = &track->keyFrames_[frame];
-    const AnimationChannelFlags channelMask = track->channelMask_;
-
-    Vector3 newPosition;
-    Quaternion newRotation;
-    Vector3 newScale;
-
-    if (interpolate)
-    {
-        const AnimationKeyFrame* nextKeyFrame = &track->keyFrames_[nextFrame];
-        float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
-        if (timeInterval < 0.0f)
-            timeInterval += animation_->GetLength();
-        float t = timeInterval > 0.0f ? (time_ - keyFrame->time_) / timeInterval : 1.0f;
-
-        if (channelMask & CHANNEL_POSITION)
-            newPosition = keyFrame->position_.Lerp(nextKeyFrame->position_, t);
-        if (channelMask & CHANNEL_ROTATION)
-            newRotation = keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t);
-        if (channelMask & CHANNEL_SCALE)
-            newScale = keyFrame->scale_.Lerp(nextKeyFrame->scale_, t);
-    }
-    else
+void AnimationState::ApplyToNodes()
+{
+    // When applying to a node hierarchy, can only use full weight (nothing to blend to)
+    for (unsigned i = 0; i < stateTracks_.size(); ++i)
     {
-        if (channelMask & CHANNEL_POSITION)
-            newPosition = keyFrame->position_;
-        if (channelMask & CHANNEL_ROTATION)
-            newRotation = keyFrame->rotation_;
-        if (channelMask & CHANNEL_SCALE)
-            newScale = keyFrame->scale_;
+        AnimationStateTrack& stateTrack = stateTracks_[i];
+        if (IsTrackActive(stateTrack))
+            ApplyTrack(stateTrack, i, 1.0f, false);
     }
+}
+
+void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, unsigned index, float weight, bool silent)
+{
+    const AnimationChannelFlags channelMask = stateTrack.track_->channelMask_;
+    Node* node = stateTrack.node_;
+
+    const unsigned sampleIndex = sampledFromArrays_ ? stateTrack.arrayIndex_ : index;
+    Vector3 newPosition = sampledPositions_[sampleIndex];
+    Quaternion newRotation = sampledRotations_[sampleIndex];
+    Vector3 newScale = sampledScales_[sampleIndex];
 
     if (blendingMode_ == ABM_ADDITIVE) // not ABM_LERP
     {
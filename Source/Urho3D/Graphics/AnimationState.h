@@ -39,6 +39,7 @@ class Node;
 class Serializer;
 class Skeleton;
 struct AnimationTrack;
+struct AnimationTrackArrays;
 struct Bone;
 
 /// %Animation blending mode.
@@ -80,6 +81,8 @@ struct URHO3D_API AnimationStateTrack
     float weight_;
     /// Last key frame.
     unsigned keyFrame_;
+    /// Track index in the keyframe arrays of the animation.
+    unsigned arrayIndex_;
 };
 
 /// %Animation instance.
@@ -167,8 +170,14 @@ private:
     void ApplyToModel();
     /// Apply animation to a scene node hierarchy.
     void ApplyToNodes();
-    /// Apply track.
-    void ApplyTrack(AnimationStateTrack& stateTrack, float weight, bool silent);
+    /// Sample all tracks at the current time position into the sampled pose buffers. Uses the keyframe arrays of the animation when available and most of its tracks are played.
+    void SampleTracks();
+    /// Map tracks to the keyframe arrays of the animation. Return false if a track is not found.
+    bool MapArrayTracks(const AnimationTrackArrays& trackArrays);
+    /// Return whether track should be sampled and applied.
+    bool IsTrackActive(const AnimationStateTrack& stateTrack) const;
+    /// Apply sampled track.
+    void ApplyTrack(AnimationStateTrack& stateTrack, unsigned index, float weight, bool silent);
 
     /// Animated model (model mode.)
     WeakPtr<AnimatedModel> model_;
@@ -180,6 +189,16 @@ private:
     Bone* startBone_;
     /// Per-track data.
     ea::vector<AnimationStateTrack> stateTracks_;
+    /// Sampled positions per track.
+    ea::vector<Vector3> sampledPositions_;
+    /// Sampled rotations per track.
+    ea::vector<Quaternion> sampledRotations_;
+    /// Sampled scales per track.
+    ea::vector<Vector3> sampledScales_;
+    /// Whether the sampled pose buffers are indexed like the keyframe arrays of the animation.
+    bool sampledFromArrays_;
+    /// Last key frame in the keyframe arrays of the animation.
+    unsigned arrayKeyFrame_;
     /// Looped flag.
     bool looped_;
     /// Blending weight.
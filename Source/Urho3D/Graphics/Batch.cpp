@@ -43,44 +43,123 @@
 namespace Urho3D
 {
 
-inline bool CompareBatchesState(const Batch* lhs, const Batch* rhs)
+inline bool CompareInstancesFrontToBack(const InstanceData& lhs, const InstanceData& rhs)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->sortKey_ != rhs->sortKey_)
-        return lhs->sortKey_ < rhs->sortKey_;
-    else
-        return lhs->distance_ < rhs->distance_;
+    return lhs.distance_ < rhs.distance_;
 }
 
-inline bool CompareBatchesFrontToBack(const Batch* lhs, const Batch* rhs)
+inline bool CompareBatchGroupOrder(const BatchGroup* lhs, const BatchGroup* rhs)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ < rhs->distance_;
-    else
-        return lhs->sortKey_ < rhs->sortKey_;
+    return lhs->renderOrder_ < rhs->renderOrder_;
 }
 
-inline bool CompareBatchesBackToFront(const Batch* lhs, const Batch* rhs)
+/// Return the bits of a float that compare as unsigned integers in the same order as the floats.
+inline unsigned GetSortableFloatBits(float value)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ > rhs->distance_;
-    else
-        return lhs->sortKey_ < rhs->sortKey_;
+    unsigned bits;
+    memcpy(&bits, &value, sizeof bits);
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
 }
 
-inline bool CompareInstancesFrontToBack(const InstanceData& lhs, const InstanceData& rhs)
+/// Sort keys with 8-bit least significant digit radix sort, using the render order as the most significant digit. The sort is stable. Digits that are equal in all keys are skipped.
+void RadixSortKeys(ea::vector<BatchSortKey>& keys, ea::vector<BatchSortKey>& scratch)
 {
-    return lhs.distance_ < rhs.distance_;
+    static const unsigned NUM_DIGITS = 9;
+
+    const unsigned count = keys.size();
+    if (count < 2)
+        return;
+
+    unsigned histograms[NUM_DIGITS][256] = {};
+    for (const BatchSortKey& key : keys)
+    {
+        for (unsigned digit = 0; digit < NUM_DIGITS - 1; ++digit)
+            ++histograms[digit][(key.key_ >> (digit * 8u)) & 0xffu];
+        ++histograms[NUM_DIGITS - 1][key.renderOrder_ & 0xffu];
+    }
+
+    scratch.resize(count);
+    for (unsigned digit = 0; digit < NUM_DIGITS; ++digit)
+    {
+        unsigned* histogram = histograms[digit];
+        const unsigned shift = digit * 8u;
+        const auto getDigit = [&](const BatchSortKey& key)
+        {
+            return digit < NUM_DIGITS - 1 ? (unsigned)(key.key_ >> shift) & 0xffu : key.renderOrder_ & 0xffu;
+        };
+
+        if (histogram[getDigit(keys[0])] == count)
+            continue;
+
+        unsigned offset = 0;
+        for (unsigned i = 0; i < 256; ++i)
+        {
+            const unsigned num = histogram[i];
+            histogram[i] = offset;
+            offset += num;
+        }
+
+        for (const BatchSortKey& key : keys)
+            scratch[histogram[getDigit(key)]++] = key;
+        keys.swap(scratch);
+    }
 }
 
-inline bool CompareBatchGroupOrder(const BatchGroup* lhs, const BatchGroup* rhs)
+/// Fill radix sort keys of batches, together with the keys of the second sort pass. The batches are read in order, as random access would miss the cache on large queues.
+template <class T, class KeyFunction, class SecondKeyFunction> void GetBatchSortKeys(const ea::vector<T>& batches,
+    ea::vector<BatchSortKey>& keys, ea::vector<unsigned long long>& secondKeys, KeyFunction getKey, SecondKeyFunction getSecondKey)
 {
-    return lhs->renderOrder_ < rhs->renderOrder_;
+    keys.resize(batches.size());
+    secondKeys.resize(batches.size());
+    for (unsigned i = 0; i < batches.size(); ++i)
+    {
+        keys[i] = BatchSortKey{getKey(batches[i]), i, batches[i]->renderOrder_};
+        secondKeys[i] = getSecondKey(batches[i]);
+    }
+}
+
+/// Sort keys, then replace them with the second keys and sort again. The second sort is stable, so the first keys break its ties.
+void RadixSortKeysTwoPass(ea::vector<BatchSortKey>& keys, const ea::vector<unsigned long long>& secondKeys, ea::vector<BatchSortKey>& scratch)
+{
+    RadixSortKeys(keys, scratch);
+    for (BatchSortKey& key : keys)
+        key.key_ = secondKeys[key.index_];
+    RadixSortKeys(keys, scratch);
+}
+
+/// Reorder batches to the order of sorted keys.
+template <class T> void ApplyBatchSortOrder(ea::vector<T>& batches, const ea::vector<BatchSortKey>& keys, ea::vector<Batch*>& scratch)
+{
+    scratch.resize(batches.size());
+    for (unsigned i = 0; i < batches.size(); ++i)
+        scratch[i] = batches[keys[i].index_];
+    for (unsigned i = 0; i < batches.size(); ++i)
+        batches[i] = static_cast<T>(scratch[i]);
+}
+
+/// Replace a 16-bit ID in the keys with IDs assigned in the order of appearance. Bits outside the mask are kept.
+void RemapSortKeyIDs(ea::vector<BatchSortKey>& keys, unsigned shift, unsigned mask)
+{
+    // Table entries hold the stamp of the last remapping in the high bits, so the table needs to be cleared only when the stamp wraps
+    static thread_local ea::vector<unsigned> remapping;
+    static thread_local unsigned stamp = 0;
+    if (remapping.empty() || ++stamp > 0xffffu)
+    {
+        remapping.assign(0x10000, 0);
+        stamp = 1;
+    }
+
+    unsigned freeID = 0;
+    for (BatchSortKey& key : keys)
+    {
+        const auto id = (unsigned)(key.key_ >> shift) & 0xffffu;
+        unsigned& entry = remapping[id];
+        if ((entry >> 16u) != stamp)
+            entry = (stamp << 16u) | Min(freeID++, mask);
+
+        const unsigned newID = (entry & mask) | (id & ~mask);
+        key.key_ = (key.key_ & ~(0xffffull << shift)) | ((unsigned long long)newID << shift);
+    }
 }
 
 void CalculateShadowMatrix(Matrix4& dest, LightBatchQueue* queue, unsigned split, Renderer* renderer)
@@ -726,7 +805,22 @@ void BatchQueue::Clear(int maxSortedInstances)
 {
     batches_.clear();
     sortedBatches_.clear();
-    batchGroups_.clear();
+    sortedBatchGroups_.clear();
+
+    // Keep the groups used on the previous frame and their instance storage, as they are likely to be used again
+    for (auto i = batchGroups_.begin(); i != batchGroups_.end();)
+    {
+        if (i->second.instances_.empty())
+            i = batchGroups_.erase(i);
+        else
+        {
+            i->second.instances_.clear();
+            i->second.startIndex_ = M_MAX_UNSIGNED;
+            ++i;
+        }
+    }
+
+    numBatchGroups_ = 0;
     maxSortedInstances_ = (unsigned)maxSortedInstances;
 }
 
@@ -737,13 +831,20 @@ void BatchQueue::SortBackToFront()
     for (unsigned i = 0; i < batches_.size(); ++i)
         sortedBatches_[i] = &batches_[i];
 
-    ea::quick_sort(sortedBatches_.begin(), sortedBatches_.end(), CompareBatchesBackToFront);
+    // Sort by state first, so that it breaks the ties of the distance sort
+    GetBatchSortKeys(sortedBatches_, sortKeys_, sortSecondKeys_,
+        [](const Batch* batch) { return batch->sortKey_; },
+        [](const Batch* batch) { return (unsigned long long)~GetSortableFloatBits(batch->distance_); });
+    RadixSortKeysTwoPass(sortKeys_, sortSecondKeys_, sortScratch_);
+    ApplyBatchSortOrder(sortedBatches_, sortKeys_, sortBatches_);
 
-    sortedBatchGroups_.resize(batchGroups_.size());
+    sortedBatchGroups_.clear();
 
-    unsigned index = 0;
     for (auto i = batchGroups_.begin(); i != batchGroups_.end(); ++i)
-        sortedBatchGroups_[index++] = &i->second;
+    {
+        if (!i->second.instances_.empty())
+            sortedBatchGroups_.push_back(&i->second);
+    }
 
     ea::quick_sort(sortedBatchGroups_.begin(), sortedBatchGroups_.end(), CompareBatchGroupOrder);
 }
@@ -757,14 +858,18 @@ void BatchQueue::SortFrontToBack()
 
     SortFrontToBack2Pass(sortedBatches_);
 
+    sortedBatchGroups_.clear();
+
     // Sort each group front to back
     for (auto i = batchGroups_.begin(); i != batchGroups_.end(); ++i)
     {
+        if (i->second.instances_.empty())
+            continue;
+
         if (i->second.instances_.size() <= maxSortedInstances_)
         {
             ea::quick_sort(i->second.instances_.begin(), i->second.instances_.end(), CompareInstancesFrontToBack);
-            if (i->second.instances_.size())
-                i->second.distance_ = i->second.instances_[0].distance_;
+            i->second.distance_ = i->second.instances_[0].distance_;
         }
         else
         {
@@ -774,14 +879,9 @@ void BatchQueue::SortFrontToBack()
                 minDistance = Min(minDistance, j->distance_);
             i->second.distance_ = minDistance;
         }
-    }
-
-    sortedBatchGroups_.resize(batchGroups_.size());
-
-    unsigned index = 0;
-    for (auto i = batchGroups_.begin(); i != batchGroups_.end(); ++i)
-        sortedBatchGroups_[index++] = &i->second;
 
+        sortedBatchGroups_.push_back(&i->second);
+    }
 
     SortFrontToBack2Pass(sortedBatchGroups_);
 }
@@ -789,67 +889,46 @@ void BatchQueue::SortFrontToBack()
 template <class T> void BatchQueue::SortFrontToBack2Pass(ea::vector<T>& batches)
 {
     // Mobile devices likely use a tiled deferred approach, with which front-to-back sorting is irrelevant. The 2-pass
-    // method is also time consuming, so just sort with state having priority
+    // method is also time consuming, so just sort with state having priority and distance breaking the ties
 #ifdef GL_ES_VERSION_2_0
-    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesState);
+    GetBatchSortKeys(batches, sortKeys_, sortSecondKeys_,
+        [](const Batch* batch) { return (unsigned long long)GetSortableFloatBits(batch->distance_); },
+        [](const Batch* batch) { return batch->sortKey_; });
+    RadixSortKeysTwoPass(sortKeys_, sortSecondKeys_, sortScratch_);
 #else
-    // For desktop, first sort by distance and remap shader/material/geometry IDs in the sort key
-    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesFrontToBack);
-
-    unsigned freeShaderID = 0;
-    unsigned short freeMaterialID = 0;
-    unsigned short freeGeometryID = 0;
-
-    for (auto i = batches.begin(); i != batches.end(); ++i)
-    {
-        Batch* batch = *i;
-
-        auto shaderID = (unsigned)(batch->sortKey_ >> 32u);
-        auto j = shaderRemapping_.find(shaderID);
-        if (j != shaderRemapping_.end())
-            shaderID = j->second;
-        else
-        {
-            shaderID = shaderRemapping_[shaderID] = freeShaderID | (shaderID & 0x80000000);
-            ++freeShaderID;
-        }
-
-        auto materialID = (unsigned short)((batch->sortKey_ & 0xffff0000) >> 16u);
-        auto k = materialRemapping_.find(materialID);
-        if (k != materialRemapping_.end())
-            materialID = k->second;
-        else
-        {
-            materialID = materialRemapping_[materialID] = freeMaterialID;
-            ++freeMaterialID;
-        }
-
-        auto geometryID = (unsigned short)(batch->sortKey_ & 0xffffu);
-        auto l = geometryRemapping_.find(geometryID);
-        if (l != geometryRemapping_.end())
-            geometryID = l->second;
-        else
-        {
-            geometryID = geometryRemapping_[geometryID] = freeGeometryID;
-            ++freeGeometryID;
-        }
-
-        batch->sortKey_ = (((unsigned long long)shaderID) << 32u) | (((unsigned long long)materialID) << 16u) | geometryID;
-    }
-
-    shaderRemapping_.clear();
-    materialRemapping_.clear();
-    geometryRemapping_.clear();
-
-    // Finally sort again with the rewritten ID's
-    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesState);
+    // For desktop, first sort by distance and remap shader/light/material/geometry IDs in the sort key in the order of
+    // appearance, so that the closest states are drawn first. Batches at equal distance are ordered by state
+    GetBatchSortKeys(batches, sortKeys_, sortSecondKeys_,
+        [](const Batch* batch) { return batch->sortKey_; },
+        [](const Batch* batch) { return (unsigned long long)GetSortableFloatBits(batch->distance_); });
+    sortStateKeys_.resize(batches.size());
+    for (unsigned i = 0; i < batches.size(); ++i)
+        sortStateKeys_[i] = sortKeys_[i].key_;
+    RadixSortKeysTwoPass(sortKeys_, sortSecondKeys_, sortScratch_);
+
+    for (BatchSortKey& key : sortKeys_)
+        key.key_ = sortStateKeys_[key.index_];
+
+    // Keep the base flag of the shader ID
+    RemapSortKeyIDs(sortKeys_, 48, 0x7fffu);
+    RemapSortKeyIDs(sortKeys_, 32, 0xffffu);
+    RemapSortKeyIDs(sortKeys_, 16, 0xffffu);
+    RemapSortKeyIDs(sortKeys_, 0, 0xffffu);
+
+    // Finally sort again with the rewritten IDs. The sort is stable, so batches with equal state stay in distance order
+    RadixSortKeys(sortKeys_, sortScratch_);
 #endif
+
+    ApplyBatchSortOrder(batches, sortKeys_, sortBatches_);
 }
 
 void BatchQueue::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
 {
     for (auto i = batchGroups_.begin(); i != batchGroups_.end(); ++i)
-        i->second.SetInstancingData(lockedData, stride, freeIndex);
+    {
+        if (!i->second.instances_.empty())
+            i->second.SetInstancingData(lockedData, stride, freeIndex);
+    }
 }
 
 void BatchQueue::Draw(View* view, Camera* camera, bool markToStencil, bool usingLightOptimization, bool allowDepthWrite) const
@@ -222,11 +222,22 @@ struct BatchGroupKey
     unsigned ToHash() const;
 };
 
+/// Radix sorting key of a batch.
+struct BatchSortKey
+{
+    /// Sort key.
+    unsigned long long key_;
+    /// Index of the batch being sorted.
+    unsigned index_;
+    /// Render order of the batch. Sorted with priority over the key.
+    unsigned renderOrder_;
+};
+
 /// Queue that contains both instanced and non-instanced draw calls.
 struct BatchQueue
 {
 public:
-    /// Clear for new frame by clearing all groups and batches.
+    /// Clear for new frame by clearing all batches and the instances of the groups. Groups that were not used on the previous frame are removed.
     void Clear(int maxSortedInstances);
     /// Sort non-instanced draw calls back to front.
     void SortBackToFront();
@@ -242,16 +253,22 @@ public:
     unsigned GetNumInstances() const;
 
     /// Return whether the batch group is empty.
-    bool IsEmpty() const { return batches_.empty() && batchGroups_.empty(); }
+    bool IsEmpty() const { return batches_.empty() && !numBatchGroups_; }
 
-    /// Instanced draw calls.
+    /// Instanced draw calls. Persist across frames, so groups without instances are unused on the current frame.
     ea::unordered_map<BatchGroupKey, BatchGroup> batchGroups_;
-    /// Shader remapping table for 2-pass state and distance sort.
-    ea::unordered_map<unsigned, unsigned> shaderRemapping_;
-    /// Material remapping table for 2-pass state and distance sort.
-    ea::unordered_map<unsigned short, unsigned short> materialRemapping_;
-    /// Geometry remapping table for 2-pass state and distance sort.
-    ea::unordered_map<unsigned short, unsigned short> geometryRemapping_;
+    /// Number of batch groups with instances on the current frame.
+    unsigned numBatchGroups_{};
+    /// Radix sort keys.
+    ea::vector<BatchSortKey> sortKeys_;
+    /// Radix sort scratch buffer.
+    ea::vector<BatchSortKey> sortScratch_;
+    /// Second pass radix sort keys of the batches being sorted.
+    ea::vector<unsigned long long> sortSecondKeys_;
+    /// State sorting keys of the batches being sorted.
+    ea::vector<unsigned long long> sortStateKeys_;
+    /// Batches being reordered after radix sort.
+    ea::vector<Batch*> sortBatches_;
 
     /// Unsorted non-instanced draw calls.
     ea::vector<Batch> batches_;
@@ -813,6 +813,8 @@ void BillboardSet::CalculateFixedScreenSize(const FrameInfo& frame)
         bufferDirty_ = true;
         forceUpdate_ = true;
         worldBoundingBoxDirty_ = true;
+        // Queue an octree update so that the octree refreshes its copy of the bounds
+        MarkForUpdate();
     }
 }
 
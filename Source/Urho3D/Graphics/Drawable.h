@@ -59,7 +59,6 @@ class Octant;
 class RayOctreeQuery;
 class Zone;
 struct RayQueryResult;
-struct WorkItem;
 
 /// Geometry update type.
 enum UpdateGeometryType
@@ -134,7 +133,6 @@ class URHO3D_API Drawable : public Component
 
     friend class Octant;
     friend class Octree;
-    friend void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex);
 
 public:
     /// Construct.
@@ -270,6 +268,8 @@ public:
 
     /// Return octree octant.
     Octant* GetOctant() const { return octant_; }
+    /// Return whether the drawable is queued for an octree update, in which case its packed octant bounds may be out of date.
+    bool IsUpdateQueued() const { return updateQueued_; }
 
     /// Return current zone.
     Zone* GetZone() const { return zone_; }
@@ -368,6 +368,8 @@ protected:
     bool zoneDirty_;
     /// Octree octant.
     Octant* octant_;
+    /// Index within the octant's drawable objects.
+    unsigned octantIndex_{};
     /// Current zone.
     Zone* zone_;
     /// View mask.
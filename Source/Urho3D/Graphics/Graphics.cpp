@@ -48,7 +48,7 @@
 #include "../Graphics/Technique.h"
 #include "../Graphics/Terrain.h"
 #include "../Graphics/TerrainPatch.h"
-#ifdef _WIN32
+#if defined(_WIN32) || defined(URHO3D_NULL)
 #include "../Graphics/Texture2D.h"
 #endif
 #include "../Graphics/Texture2DArray.h"
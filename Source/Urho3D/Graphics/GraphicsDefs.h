@@ -102,6 +102,15 @@ enum CullMode
     MAX_CULLMODES
 };
 
+/// Occlusion buffer rasterization backend.
+enum OcclusionRasterizer
+{
+    /// Scanline rasterization. When threaded, each thread renders to its own full size buffer and the buffers are merged.
+    OCCLUSION_RASTERIZER_SCANLINE = 0,
+    /// Triangles are binned to screen tiles and each tile is rasterized by one thread using SIMD edge functions.
+    OCCLUSION_RASTERIZER_TILED
+};
+
 /// Fill mode.
 enum FillMode
 {
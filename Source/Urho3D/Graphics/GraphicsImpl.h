@@ -29,6 +29,8 @@
 #include "OpenGL/OGLGraphicsImpl.h"
 #elif defined(URHO3D_D3D11)
 #include "Direct3D11/D3D11GraphicsImpl.h"
+#elif defined(URHO3D_NULL)
+#include "Null/NullGraphicsImpl.h"
 #else
 #include "Direct3D9/D3D9GraphicsImpl.h"
 #endif
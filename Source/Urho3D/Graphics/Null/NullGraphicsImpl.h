@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../../Graphics/GraphicsDefs.h"
+
+namespace Urho3D
+{
+
+class Image;
+
+/// Texture formats of the null graphics backend. They only tell the formats apart and define the data sizes.
+enum NullTextureFormat : unsigned
+{
+    NULL_FORMAT_UNKNOWN = 0,
+    NULL_FORMAT_A8,
+    NULL_FORMAT_R8,
+    NULL_FORMAT_RG8,
+    NULL_FORMAT_RGBA8,
+    NULL_FORMAT_RGBA16,
+    NULL_FORMAT_RGBA16F,
+    NULL_FORMAT_RGBA32F,
+    NULL_FORMAT_RG16,
+    NULL_FORMAT_RG16F,
+    NULL_FORMAT_RG32F,
+    NULL_FORMAT_R16F,
+    NULL_FORMAT_R32F,
+    NULL_FORMAT_D16,
+    NULL_FORMAT_D24S8,
+    NULL_FORMAT_D32,
+    NULL_FORMAT_DXT1,
+    NULL_FORMAT_DXT3,
+    NULL_FORMAT_DXT5
+};
+
+/// Draw call and state change counters recorded by the null graphics backend. State changes are counted when requested
+/// by the renderer, without the filtering a real backend does before each draw.
+struct URHO3D_API NullFrameStats
+{
+    /// Non-instanced draw calls.
+    unsigned draws_{};
+    /// Instanced draw calls.
+    unsigned instancedDraws_{};
+    /// Instances drawn by the instanced draw calls.
+    unsigned instances_{};
+    /// Primitives drawn.
+    unsigned primitives_{};
+    /// Clear calls.
+    unsigned clears_{};
+    /// Shader changes.
+    unsigned shaderChanges_{};
+    /// Shader parameter updates.
+    unsigned parameterUpdates_{};
+    /// Texture binding changes, counted per texture unit.
+    unsigned textureChanges_{};
+    /// Render target and depth-stencil binding changes.
+    unsigned renderTargetChanges_{};
+    /// Vertex buffer binding changes, counted per stream.
+    unsigned vertexBufferChanges_{};
+    /// Index buffer binding changes.
+    unsigned indexBufferChanges_{};
+    /// Viewport, blend, depth, stencil, rasterizer and scissor state changes.
+    unsigned renderStateChanges_{};
+    /// Bytes written to vertex and index buffers.
+    unsigned long long bufferUploadBytes_{};
+    /// Bytes written to textures.
+    unsigned long long textureUploadBytes_{};
+};
+
+class URHO3D_API GraphicsImpl
+{
+    friend class Graphics;
+
+public:
+    /// Return counters of the frame currently being recorded.
+    const NullFrameStats& GetFrameStats() const { return frameStats_; }
+
+    /// Return counters of the last completed frame.
+    const NullFrameStats& GetLastFrameStats() const { return lastFrameStats_; }
+
+    /// Return a new unique name for a null GPU object.
+    unsigned AllocateObjectName() { return ++lastObjectName_; }
+
+    /// Record bytes written to a vertex or index buffer.
+    void RecordBufferUpload(unsigned size) { frameStats_.bufferUploadBytes_ += size; }
+
+    /// Record bytes written to a texture.
+    void RecordTextureUpload(unsigned size) { frameStats_.textureUploadBytes_ += size; }
+
+    /// Return data size of one row of the given texture format, or of a row of blocks if compressed.
+    static unsigned GetRowDataSize(unsigned format, int width);
+
+    /// Return the texture format used for an image. Images without a matching compressed format are loaded as RGBA.
+    static unsigned GetImageFormat(const Image* image, bool useAlpha);
+
+private:
+    /// Whether a screen mode has been set.
+    bool initialized_{};
+    /// Last allocated GPU object name.
+    unsigned lastObjectName_{};
+    /// Counters of the frame currently being recorded.
+    NullFrameStats frameStats_;
+    /// Counters of the last completed frame.
+    NullFrameStats lastFrameStats_;
+};
+
+}
@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../../Precompiled.h"
+
+#include "../../Graphics/Graphics.h"
+#include "../../Graphics/GraphicsImpl.h"
+#include "../../Graphics/Renderer.h"
+#include "../../Graphics/Texture2D.h"
+#include "../../IO/Log.h"
+#include "../../Resource/Image.h"
+
+#include "../../DebugNew.h"
+
+namespace Urho3D
+{
+
+void Texture2D::OnDeviceLost()
+{
+}
+
+void Texture2D::OnDeviceReset()
+{
+}
+
+void Texture2D::Release()
+{
+    if (graphics_)
+    {
+        for (unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+        {
+            if (graphics_->GetTexture(i) == this)
+                graphics_->SetTexture(i, nullptr);
+        }
+    }
+
+    if (renderSurface_)
+        renderSurface_->Release();
+
+    object_.ptr_ = nullptr;
+}
+
+bool Texture2D::SetData(unsigned level, int x, int y, int width, int height, const void* data)
+{
+    if (!object_.name_ || !data || level >= levels_)
+    {
+        URHO3D_LOGERROR("No texture created, null source or illegal mip level for setting data");
+        return false;
+    }
+
+    graphics_->GetImpl()->RecordTextureUpload(GetDataSize(width, height));
+    return true;
+}
+
+bool Texture2D::SetData(Image* image, bool useAlpha)
+{
+    if (!image)
+    {
+        URHO3D_LOGERROR("Null image, can not load texture");
+        return false;
+    }
+
+    MaterialQuality quality = QUALITY_HIGH;
+    Renderer* renderer = GetSubsystem<Renderer>();
+    if (renderer)
+        quality = renderer->GetTextureQuality();
+
+    // Texel data is not kept. Size the texture like the other backends would and record the upload of every level
+    unsigned mipsToSkip = GetImageMipsToSkip(quality, image);
+    if (image->IsCompressed())
+    {
+        mipsToSkip = Min(mipsToSkip, Max(image->GetNumCompressedLevels(), 1U) - 1);
+        SetNumLevels(Max(image->GetNumCompressedLevels() - mipsToSkip, 1U));
+    }
+
+    const int width = Max(image->GetWidth() >> mipsToSkip, 1);
+    const int height = Max(image->GetHeight() >> mipsToSkip, 1);
+    const unsigned format = GraphicsImpl::GetImageFormat(image, useAlpha);
+    if (width_ != width || height_ != height || format != format_)
+        SetSize(width, height, format, usage_);
+    if (!object_.name_)
+        return false;
+
+    unsigned memoryUse = sizeof(Texture2D);
+    for (unsigned i = 0; i < levels_; ++i)
+        memoryUse += GetDataSize(GetLevelWidth(i), GetLevelHeight(i));
+    graphics_->GetImpl()->RecordTextureUpload(memoryUse - sizeof(Texture2D));
+
+    SetMemoryUse(memoryUse);
+    return true;
+}
+
+bool Texture2D::GetData(unsigned level, void* dest) const
+{
+    if (!object_.name_ || !dest || level >= levels_)
+    {
+        URHO3D_LOGERROR("No texture created, null destination or illegal mip level for getting data");
+        return false;
+    }
+
+    // There is no texel data, return cleared contents
+    memset(dest, 0, GetDataSize(GetLevelWidth(level), GetLevelHeight(level)));
+    return true;
+}
+
+bool Texture2D::Create()
+{
+    Release();
+
+    if (!graphics_ || !width_ || !height_)
+        return false;
+
+    levels_ = usage_ == TEXTURE_DEPTHSTENCIL ? 1 : CheckMaxLevels(width_, height_, requestedLevels_);
+    object_.name_ = graphics_->GetImpl()->AllocateObjectName();
+    return true;
+}
+
+}
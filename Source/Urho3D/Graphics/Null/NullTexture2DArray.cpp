@@ -0,0 +1,145 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../../Precompiled.h"
+
+#include "../../Core/Context.h"
+#include "../../Graphics/Graphics.h"
+#include "../../Graphics/GraphicsImpl.h"
+#include "../../Graphics/Texture2DArray.h"
+#include "../../IO/Log.h"
+#include "../../Resource/Image.h"
+
+#include "../../DebugNew.h"
+
+namespace Urho3D
+{
+
+void Texture2DArray::OnDeviceLost()
+{
+}
+
+void Texture2DArray::OnDeviceReset()
+{
+}
+
+void Texture2DArray::Release()
+{
+    if (graphics_)
+    {
+        for (unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
+        {
+            if (graphics_->GetTexture(i) == this)
+                graphics_->SetTexture(i, nullptr);
+        }
+    }
+
+    if (renderSurface_)
+        renderSurface_->Release();
+
+    object_.ptr_ = nullptr;
+}
+
+bool Texture2DArray::SetData(unsigned layer, unsigned level, int x, int y, int width, int height, const void* data)
+{
+    if (!object_.name_ || !data || layer >= layers_ || level >= levels_)
+    {
+        URHO3D_LOGERROR("No texture array created, null source or illegal layer or mip level for setting data");
+        return false;
+    }
+
+    graphics_->GetImpl()->RecordTextureUpload(GetDataSize(width, height));
+    return true;
+}
+
+bool Texture2DArray::SetData(unsigned layer, Deserializer& source)
+{
+    SharedPtr<Image> image(context_->CreateObject<Image>());
+    if (!image->Load(source))
+        return false;
+
+    return SetData(layer, image);
+}
+
+bool Texture2DArray::SetData(unsigned layer, Image* image, bool useAlpha)
+{
+    if (!image || layer >= layers_)
+    {
+        URHO3D_LOGERROR("Null image or illegal layer, can not set texture array data");
+        return false;
+    }
+
+    // Texel data is not kept. Create the texture when layer 0 is loaded and record the upload of every level
+    const unsigned format = GraphicsImpl::GetImageFormat(image, useAlpha);
+    if (!layer)
+    {
+        if (image->IsCompressed())
+            SetNumLevels(Max(image->GetNumCompressedLevels(), 1U));
+        SetSize(layers_, image->GetWidth(), image->GetHeight(), format, usage_);
+    }
+    else if (!object_.name_ || image->GetWidth() != width_ || image->GetHeight() != height_ || format != format_)
+    {
+        URHO3D_LOGERROR("Texture array layer does not match size or format of layer 0");
+        return false;
+    }
+    if (!object_.name_)
+        return false;
+
+    unsigned memoryUse = 0;
+    for (unsigned i = 0; i < levels_; ++i)
+        memoryUse += GetDataSize(GetLevelWidth(i), GetLevelHeight(i));
+    graphics_->GetImpl()->RecordTextureUpload(memoryUse);
+
+    layerMemoryUse_[layer] = memoryUse;
+    unsigned totalMemoryUse = sizeof(Texture2DArray) + layerMemoryUse_.capacity() * sizeof(unsigned);
+    for (unsigned i = 0; i < layers_; ++i)
+        totalMemoryUse += layerMemoryUse_[i];
+    SetMemoryUse(totalMemoryUse);
+    return true;
+}
+
+bool Texture2DArray::GetData(unsigned layer, unsigned level, void* dest) const
+{
+    if (!object_.name_ || !dest || layer >= layers_ || level >= levels_)
+    {
+        URHO3D_LOGERROR("No texture array created, null destination or illegal layer or mip level for getting data");
+        return false;
+    }
+
+    // There is no texel data, return cleared contents
+    memset(dest, 0, GetDataSize(GetLevelWidth(level), GetLevelHeight(level)));
+    return true;
+}
+
+bool Texture2DArray::Create()
+{
+    Release();
+
+    if (!graphics_ || !width_ || !height_ || !layers_)
+        return false;
+
+    levels_ = CheckMaxLevels(width_, height_, requestedLevels_);
+    object_.name_ = graphics_->GetImpl()->AllocateObjectName();
+    return true;
+}
+
+}
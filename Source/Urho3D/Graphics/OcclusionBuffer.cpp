@@ -29,6 +29,10 @@
 #include "../Graphics/OcclusionBuffer.h"
 #include "../IO/Log.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -86,8 +90,10 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     width_ = width;
     height_ = height;
 
-    // Build work buffers for threading
-    unsigned numThreadBuffers = threaded ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 1;
+    // Build work buffers for threading. The tiled rasterizer renders the triangles of all threads directly to the first buffer
+    const unsigned numThreads = threaded ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 1;
+    const unsigned numThreadBuffers = rasterizer_ == OCCLUSION_RASTERIZER_TILED ? 1 : numThreads;
+    threaded_ = numThreads > 1;
     buffers_.resize(numThreadBuffers);
     for (unsigned i = 0; i < numThreadBuffers; ++i)
     {
@@ -98,6 +104,21 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
         buffer.used_ = false;
     }
 
+    // Build triangle bins for the tiled rasterizer
+    tileTriangles_.clear();
+    tileBins_.clear();
+    tileMaxDepths_.clear();
+    numTilesX_ = 0;
+    numTilesY_ = 0;
+    if (rasterizer_ == OCCLUSION_RASTERIZER_TILED)
+    {
+        numTilesX_ = (width_ + OCCLUSION_TILE_WIDTH - 1) / OCCLUSION_TILE_WIDTH;
+        numTilesY_ = (height_ + OCCLUSION_TILE_HEIGHT - 1) / OCCLUSION_TILE_HEIGHT;
+        tileTriangles_.resize(numThreads);
+        tileBins_.resize(numThreads * numTilesX_ * numTilesY_);
+        tileMaxDepths_.resize(numTilesX_ * numTilesY_, (int)OCCLUSION_Z_SCALE);
+    }
+
     mipBuffers_.clear();
 
     // Build buffers for mip levels
@@ -150,6 +171,17 @@ void OcclusionBuffer::SetCullMode(CullMode mode)
     cullMode_ = mode;
 }
 
+void OcclusionBuffer::SetRasterizer(OcclusionRasterizer rasterizer)
+{
+    if (rasterizer != rasterizer_)
+    {
+        rasterizer_ = rasterizer;
+        // Force the buffers to be rebuilt on the next SetSize()
+        width_ = 0;
+        height_ = 0;
+    }
+}
+
 void OcclusionBuffer::Reset()
 {
     numTriangles_ = 0;
@@ -164,6 +196,7 @@ void OcclusionBuffer::Clear()
     ClearBuffer(0);
     for (unsigned i = 1; i < buffers_.size(); ++i)
         buffers_[i].used_ = false;
+    ea::fill(tileMaxDepths_.begin(), tileMaxDepths_.end(), (int)OCCLUSION_Z_SCALE);
 
     depthHierarchyDirty_ = true;
 }
@@ -206,7 +239,29 @@ bool OcclusionBuffer::AddTriangles(const Matrix3x4& model, const void* vertexDat
 
 void OcclusionBuffer::DrawTriangles()
 {
-    if (buffers_.size() == 1)
+    if (rasterizer_ == OCCLUSION_RASTERIZER_TILED && !buffers_.empty())
+    {
+        // Transform, clip and bin the triangles, then rasterize them tile by tile
+        if (threaded_)
+        {
+            auto* queue = GetSubsystem<WorkQueue>();
+            queue->ParallelFor(batches_.size(), 1, [this](unsigned begin, unsigned end, unsigned threadIndex)
+            {
+                URHO3D_PROFILE("DrawOcclusionBatchWork");
+                for (unsigned i = begin; i < end; ++i)
+                    DrawBatch(batches_[i], threadIndex);
+            });
+        }
+        else
+        {
+            for (auto i = batches_.begin(); i != batches_.end(); ++i)
+                DrawBatch(*i, 0);
+        }
+
+        RasterizeTiles();
+        depthHierarchyDirty_ = true;
+    }
+    else if (buffers_.size() == 1)
     {
         // Not threaded
         for (auto i = batches_.begin(); i != batches_.end(); ++i)
@@ -345,121 +400,78 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
     if (buffers_.empty())
         return true;
 
-    // Transform corners to projection space
-    Vector4 vertices[8];
-    vertices[0] = ModelTransform(viewProj_, worldSpaceBox.min_);
-    vertices[1] = ModelTransform(viewProj_, Vector3(worldSpaceBox.max_.x_, worldSpaceBox.min_.y_, worldSpaceBox.min_.z_));
-    vertices[2] = ModelTransform(viewProj_, Vector3(worldSpaceBox.min_.x_, worldSpaceBox.max_.y_, worldSpaceBox.min_.z_));
-    vertices[3] = ModelTransform(viewProj_, Vector3(worldSpaceBox.max_.x_, worldSpaceBox.max_.y_, worldSpaceBox.min_.z_));
-    vertices[4] = ModelTransform(viewProj_, Vector3(worldSpaceBox.min_.x_, worldSpaceBox.min_.y_, worldSpaceBox.max_.z_));
-    vertices[5] = ModelTransform(viewProj_, Vector3(worldSpaceBox.max_.x_, worldSpaceBox.min_.y_, worldSpaceBox.max_.z_));
-    vertices[6] = ModelTransform(viewProj_, Vector3(worldSpaceBox.min_.x_, worldSpaceBox.max_.y_, worldSpaceBox.max_.z_));
-    vertices[7] = ModelTransform(viewProj_, worldSpaceBox.max_);
-
-    // Apply a far clip relative bias
-    for (auto& vertice : vertices)
-        vertice.z_ -= OCCLUSION_RELATIVE_BIAS;
-
-    // Transform to screen space. If any of the corners cross the near plane, assume visible
-    float minX, maxX, minY, maxY, minZ;
-
-    if (vertices[0].z_ <= 0.0f)
+    IntRect rect;
+    int z;
+    if (!GetOccludeeRect(worldSpaceBox, rect, z))
         return true;
 
-    Vector3 projected = ViewportTransform(vertices[0]);
-    minX = maxX = projected.x_;
-    minY = maxY = projected.y_;
-    minZ = projected.z_;
-
-    // Project the rest
-    for (unsigned i = 1; i < 8; ++i)
+    if (!depthHierarchyDirty_)
     {
-        if (vertices[i].z_ <= 0.0f)
-            return true;
-
-        projected = ViewportTransform(vertices[i]);
-
-        if (projected.x_ < minX) minX = projected.x_;
-        if (projected.x_ > maxX) maxX = projected.x_;
-        if (projected.y_ < minY) minY = projected.y_;
-        if (projected.y_ > maxY) maxY = projected.y_;
-        if (projected.z_ < minZ) minZ = projected.z_;
+        // Start from lowest mip level and check if a conclusive result can be found
+        for (int i = mipBuffers_.size() - 1; i >= 0; --i)
+        {
+            bool visible;
+            if (TestMipLevel(i, rect, z, visible))
+                return visible;
+        }
     }
 
-    // Expand the bounding box 1 pixel in each direction to be conservative and correct rasterization offset
-    IntRect rect((int)(minX - 1.5f), (int)(minY - 1.5f), RoundToInt(maxX), RoundToInt(maxY));
-
-    // If the rect is outside, let frustum culling handle
-    if (rect.right_ < 0 || rect.bottom_ < 0)
-        return true;
-    if (rect.left_ >= width_ || rect.top_ >= height_)
-        return true;
+    // If no conclusive result, finally check the pixel-level data
+    return TestPixels(rect, z);
+}
 
-    // Clipping of rect
-    if (rect.left_ < 0)
-        rect.left_ = 0;
-    if (rect.top_ < 0)
-        rect.top_ = 0;
-    if (rect.right_ >= width_)
-        rect.right_ = width_ - 1;
-    if (rect.bottom_ >= height_)
-        rect.bottom_ = height_ - 1;
+void OcclusionBuffer::IsVisible(const BoundingBox* worldSpaceBoxes, unsigned count, bool* visible) const
+{
+    if (buffers_.empty())
+    {
+        for (unsigned i = 0; i < count; ++i)
+            visible[i] = true;
+        return;
+    }
 
-    // Convert depth to integer and apply final bias
-    int z = RoundToInt(minZ) - OCCLUSION_FIXED_BIAS;
+    IntRect rects[OCCLUSION_TEST_CHUNK_SIZE];
+    int depths[OCCLUSION_TEST_CHUNK_SIZE];
+    unsigned pending[OCCLUSION_TEST_CHUNK_SIZE];
 
-    if (!depthHierarchyDirty_)
+    for (unsigned chunkStart = 0; chunkStart < count; chunkStart += OCCLUSION_TEST_CHUNK_SIZE)
     {
-        // Start from lowest mip level and check if a conclusive result can be found
-        for (int i = mipBuffers_.size() - 1; i >= 0; --i)
-        {
-            int shift = i + 1;
-            int width = width_ >> shift;
-            int left = rect.left_ >> shift;
-            int right = rect.right_ >> shift;
+        const unsigned chunkEnd = Min(chunkStart + OCCLUSION_TEST_CHUNK_SIZE, count);
 
-            DepthValue* buffer = mipBuffers_[i].get();
-            DepthValue* row = buffer + (rect.top_ >> shift) * width;
-            DepthValue* endRow = buffer + (rect.bottom_ >> shift) * width;
-            bool allOccluded = true;
+        // Project all boxes of the chunk first. Boxes crossing the near plane or outside the screen are visible right away
+        unsigned numPending = 0;
+        for (unsigned i = chunkStart; i < chunkEnd; ++i)
+        {
+            if (GetOccludeeRect(worldSpaceBoxes[i], rects[numPending], depths[numPending]))
+                pending[numPending++] = i;
+            else
+                visible[i] = true;
+        }
 
-            while (row <= endRow)
+        // Then test the remaining boxes one mip level at a time from the lowest, so that each level is read for all of them
+        // while it is in cache. Boxes with a conclusive result drop out. Gives the same result as testing each box on its own
+        if (!depthHierarchyDirty_)
+        {
+            for (int level = mipBuffers_.size() - 1; level >= 0 && numPending; --level)
             {
-                DepthValue* src = row + left;
-                DepthValue* end = row + right;
-                while (src <= end)
+                unsigned numUnresolved = 0;
+                for (unsigned j = 0; j < numPending; ++j)
                 {
-                    if (z <= src->min_)
-                        return true;
-                    if (z <= src->max_)
-                        allOccluded = false;
-                    ++src;
+                    if (!TestMipLevel(level, rects[j], depths[j], visible[pending[j]]))
+                    {
+                        rects[numUnresolved] = rects[j];
+                        depths[numUnresolved] = depths[j];
+                        pending[numUnresolved] = pending[j];
+                        ++numUnresolved;
+                    }
                 }
-                row += width;
+                numPending = numUnresolved;
             }
-
-            if (allOccluded)
-                return false;
         }
-    }
 
-    // If no conclusive result, finally check the pixel-level data
-    int* row = buffers_[0].data_ + rect.top_ * width_;
-    int* endRow = buffers_[0].data_ + rect.bottom_ * width_;
-    while (row <= endRow)
-    {
-        int* src = row + rect.left_;
-        int* end = row + rect.right_;
-        while (src <= end)
-        {
-            if (z <= *src)
-                return true;
-            ++src;
-        }
-        row += width_;
+        // Check the pixel-level data for the boxes without a conclusive result
+        for (unsigned j = 0; j < numPending; ++j)
+            visible[pending[j]] = TestPixels(rects[j], depths[j]);
     }
-
-    return false;
 }
 
 unsigned OcclusionBuffer::GetUseTimer()
@@ -470,8 +482,8 @@ unsigned OcclusionBuffer::GetUseTimer()
 
 void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadIndex)
 {
-    // If buffer not yet used, clear it
-    if (threadIndex > 0 && !buffers_[threadIndex].used_)
+    // If buffer not yet used, clear it. The tiled rasterizer only uses the first buffer
+    if (rasterizer_ == OCCLUSION_RASTERIZER_SCANLINE && threadIndex > 0 && !buffers_[threadIndex].used_)
     {
         ClearBuffer(threadIndex);
         buffers_[threadIndex].used_ = true;
@@ -557,6 +569,149 @@ inline Vector4 OcclusionBuffer::ModelTransform(const Matrix4& transform, const V
     );
 }
 
+inline void OcclusionBuffer::ProjectBox(const BoundingBox& worldSpaceBox, Vector4* vertices) const
+{
+    // Each corner is the sum of the transformed minimum or maximum coordinate on each axis
+    const Vector4 axisX(viewProj_.m00_, viewProj_.m10_, viewProj_.m20_, viewProj_.m30_);
+    const Vector4 axisY(viewProj_.m01_, viewProj_.m11_, viewProj_.m21_, viewProj_.m31_);
+    const Vector4 axisZ(viewProj_.m02_, viewProj_.m12_, viewProj_.m22_, viewProj_.m32_);
+    const Vector4 translation(viewProj_.m03_, viewProj_.m13_, viewProj_.m23_, viewProj_.m33_);
+
+    const Vector4 minX = axisX * worldSpaceBox.min_.x_;
+    const Vector4 maxX = axisX * worldSpaceBox.max_.x_;
+    const Vector4 minY = axisY * worldSpaceBox.min_.y_;
+    const Vector4 maxY = axisY * worldSpaceBox.max_.y_;
+    const Vector4 minZ = axisZ * worldSpaceBox.min_.z_ + translation;
+    const Vector4 maxZ = axisZ * worldSpaceBox.max_.z_ + translation;
+
+    vertices[0] = minX + minY + minZ;
+    vertices[1] = maxX + minY + minZ;
+    vertices[2] = minX + maxY + minZ;
+    vertices[3] = maxX + maxY + minZ;
+    vertices[4] = minX + minY + maxZ;
+    vertices[5] = maxX + minY + maxZ;
+    vertices[6] = minX + maxY + maxZ;
+    vertices[7] = maxX + maxY + maxZ;
+}
+
+bool OcclusionBuffer::GetOccludeeRect(const BoundingBox& worldSpaceBox, IntRect& rect, int& z) const
+{
+    // Transform corners to projection space
+    Vector4 vertices[8];
+    ProjectBox(worldSpaceBox, vertices);
+
+    // Apply a far clip relative bias
+    for (auto& vertice : vertices)
+        vertice.z_ -= OCCLUSION_RELATIVE_BIAS;
+
+    // Transform to screen space. If any of the corners cross the near plane, assume visible
+    float minX, maxX, minY, maxY, minZ;
+
+    if (vertices[0].z_ <= 0.0f)
+        return false;
+
+    Vector3 projected = ViewportTransform(vertices[0]);
+    minX = maxX = projected.x_;
+    minY = maxY = projected.y_;
+    minZ = projected.z_;
+
+    // Project the rest
+    for (unsigned i = 1; i < 8; ++i)
+    {
+        if (vertices[i].z_ <= 0.0f)
+            return false;
+
+        projected = ViewportTransform(vertices[i]);
+
+        if (projected.x_ < minX) minX = projected.x_;
+        if (projected.x_ > maxX) maxX = projected.x_;
+        if (projected.y_ < minY) minY = projected.y_;
+        if (projected.y_ > maxY) maxY = projected.y_;
+        if (projected.z_ < minZ) minZ = projected.z_;
+    }
+
+    // Expand the bounding box 1 pixel in each direction to be conservative and correct rasterization offset
+    rect = IntRect((int)(minX - 1.5f), (int)(minY - 1.5f), RoundToInt(maxX), RoundToInt(maxY));
+
+    // If the rect is outside, let frustum culling handle
+    if (rect.right_ < 0 || rect.bottom_ < 0)
+        return false;
+    if (rect.left_ >= width_ || rect.top_ >= height_)
+        return false;
+
+    // Clipping of rect
+    if (rect.left_ < 0)
+        rect.left_ = 0;
+    if (rect.top_ < 0)
+        rect.top_ = 0;
+    if (rect.right_ >= width_)
+        rect.right_ = width_ - 1;
+    if (rect.bottom_ >= height_)
+        rect.bottom_ = height_ - 1;
+
+    // Convert depth to integer and apply final bias
+    z = RoundToInt(minZ) - OCCLUSION_FIXED_BIAS;
+    return true;
+}
+
+bool OcclusionBuffer::TestMipLevel(int level, const IntRect& rect, int z, bool& visible) const
+{
+    int shift = level + 1;
+    int width = width_ >> shift;
+    int left = rect.left_ >> shift;
+    int right = rect.right_ >> shift;
+
+    DepthValue* buffer = mipBuffers_[level].get();
+    DepthValue* row = buffer + (rect.top_ >> shift) * width;
+    DepthValue* endRow = buffer + (rect.bottom_ >> shift) * width;
+    bool allOccluded = true;
+
+    while (row <= endRow)
+    {
+        DepthValue* src = row + left;
+        DepthValue* end = row + right;
+        while (src <= end)
+        {
+            if (z <= src->min_)
+            {
+                visible = true;
+                return true;
+            }
+            if (z <= src->max_)
+                allOccluded = false;
+            ++src;
+        }
+        row += width;
+    }
+
+    if (allOccluded)
+    {
+        visible = false;
+        return true;
+    }
+    return false;
+}
+
+bool OcclusionBuffer::TestPixels(const IntRect& rect, int z) const
+{
+    int* row = buffers_[0].data_ + rect.top_ * width_;
+    int* endRow = buffers_[0].data_ + rect.bottom_ * width_;
+    while (row <= endRow)
+    {
+        int* src = row + rect.left_;
+        int* end = row + rect.right_;
+        while (src <= end)
+        {
+            if (z <= *src)
+                return true;
+            ++src;
+        }
+        row += width_;
+    }
+
+    return false;
+}
+
 inline Vector3 OcclusionBuffer::ViewportTransform(const Vector4& vertex) const
 {
     float invW = 1.0f / vertex.w_;
@@ -640,7 +795,10 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
         bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
         if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
         {
-            DrawTriangle2D(projected, clockwise, threadIndex);
+            if (rasterizer_ == OCCLUSION_RASTERIZER_TILED)
+                BinTriangle2D(projected, threadIndex);
+            else
+                DrawTriangle2D(projected, clockwise, threadIndex);
             drawOk = true;
         }
     }
@@ -678,7 +836,10 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
                 bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
                 if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
                 {
-                    DrawTriangle2D(projected, clockwise, threadIndex);
+                    if (rasterizer_ == OCCLUSION_RASTERIZER_TILED)
+                        BinTriangle2D(projected, threadIndex);
+                    else
+                        DrawTriangle2D(projected, clockwise, threadIndex);
                     drawOk = true;
                 }
             }
@@ -1008,6 +1169,194 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
     }
 }
 
+void OcclusionBuffer::BinTriangle2D(const Vector3* vertices, unsigned threadIndex)
+{
+    const float area = (vertices[1].x_ - vertices[0].x_) * (vertices[2].y_ - vertices[0].y_) -
+        (vertices[1].y_ - vertices[0].y_) * (vertices[2].x_ - vertices[0].x_);
+    if (area == 0.0f)
+        return;
+
+    // Pixel centers are at integer coordinates plus one due to the half pixel viewport offset, so that pixel x is covered
+    // if x + 1 is within the triangle
+    float minX = Min(Min(vertices[0].x_, vertices[1].x_), vertices[2].x_);
+    float maxX = Max(Max(vertices[0].x_, vertices[1].x_), vertices[2].x_);
+    float minY = Min(Min(vertices[0].y_, vertices[1].y_), vertices[2].y_);
+    float maxY = Max(Max(vertices[0].y_, vertices[1].y_), vertices[2].y_);
+    IntRect rect(Max(CeilToInt(minX) - 1, 0), Max(CeilToInt(minY) - 1, 0), Min(FloorToInt(maxX) - 1, width_ - 1),
+        Min(FloorToInt(maxY) - 1, height_ - 1));
+    if (rect.left_ > rect.right_ || rect.top_ > rect.bottom_)
+        return;
+
+    OcclusionTriangle triangle;
+    triangle.rect_ = rect;
+
+    // Orient the edge functions so that the inside is non-negative regardless of winding
+    const float sign = area > 0.0f ? 1.0f : -1.0f;
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        const Vector3& start = vertices[i];
+        const Vector3& end = vertices[(i + 1) % 3];
+        triangle.edgeA_[i] = sign * (start.y_ - end.y_);
+        triangle.edgeB_[i] = sign * (end.x_ - start.x_);
+        triangle.edgeC_[i] = sign * (start.x_ * end.y_ - end.x_ * start.y_);
+    }
+
+    const float dX1 = vertices[1].x_ - vertices[0].x_;
+    const float dY1 = vertices[1].y_ - vertices[0].y_;
+    const float dZ1 = vertices[1].z_ - vertices[0].z_;
+    const float dX2 = vertices[2].x_ - vertices[0].x_;
+    const float dY2 = vertices[2].y_ - vertices[0].y_;
+    const float dZ2 = vertices[2].z_ - vertices[0].z_;
+    triangle.depthA_ = (dZ1 * dY2 - dZ2 * dY1) / area;
+    triangle.depthB_ = (dZ2 * dX1 - dZ1 * dX2) / area;
+    triangle.depthC_ = vertices[0].z_ - triangle.depthA_ * vertices[0].x_ - triangle.depthB_ * vertices[0].y_;
+    triangle.minDepth_ = RoundToInt(Min(Min(vertices[0].z_, vertices[1].z_), vertices[2].z_));
+
+    ea::vector<OcclusionTriangle>& triangles = tileTriangles_[threadIndex];
+    const unsigned triangleIndex = triangles.size();
+    bool binned = false;
+
+    // Add to the bins of the overlapped tiles, unless already rendered occluders are closer everywhere in the tile
+    const int numTiles = numTilesX_ * numTilesY_;
+    for (int tileY = rect.top_ / OCCLUSION_TILE_HEIGHT; tileY <= rect.bottom_ / OCCLUSION_TILE_HEIGHT; ++tileY)
+    {
+        for (int tileX = rect.left_ / OCCLUSION_TILE_WIDTH; tileX <= rect.right_ / OCCLUSION_TILE_WIDTH; ++tileX)
+        {
+            const int tileIndex = tileY * numTilesX_ + tileX;
+            if (triangle.minDepth_ >= tileMaxDepths_[tileIndex])
+                continue;
+
+            tileBins_[threadIndex * numTiles + tileIndex].push_back(triangleIndex);
+            binned = true;
+        }
+    }
+
+    if (binned)
+        triangles.push_back(triangle);
+}
+
+/// Rasterize pixels from left to right of a row of a binned triangle. Pixels closer than the existing depth are written.
+static inline void RasterizeTriangleRow(const OcclusionTriangle& triangle, int* row, int left, int right, int y)
+{
+    const float sampleY = (float)(y + 1);
+    const float edge0 = triangle.edgeB_[0] * sampleY + triangle.edgeC_[0];
+    const float edge1 = triangle.edgeB_[1] * sampleY + triangle.edgeC_[1];
+    const float edge2 = triangle.edgeB_[2] * sampleY + triangle.edgeC_[2];
+    const float depth = triangle.depthB_ * sampleY + triangle.depthC_;
+
+#ifdef URHO3D_SSE
+    // Test four pixels at a time. The caller guarantees that the aligned groups of four pixels belong to the same tile
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 sampleOffsets = _mm_setr_ps(1.0f, 2.0f, 3.0f, 4.0f);
+    const __m128 edgeA0 = _mm_set1_ps(triangle.edgeA_[0]);
+    const __m128 edgeA1 = _mm_set1_ps(triangle.edgeA_[1]);
+    const __m128 edgeA2 = _mm_set1_ps(triangle.edgeA_[2]);
+    const __m128 rowEdge0 = _mm_set1_ps(edge0);
+    const __m128 rowEdge1 = _mm_set1_ps(edge1);
+    const __m128 rowEdge2 = _mm_set1_ps(edge2);
+    const __m128 depthA = _mm_set1_ps(triangle.depthA_);
+    const __m128 rowDepth = _mm_set1_ps(depth);
+
+    for (int x = left & ~3; x <= right; x += 4)
+    {
+        const __m128 sampleX = _mm_add_ps(_mm_set1_ps((float)x), sampleOffsets);
+        __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA0, sampleX), rowEdge0), zero);
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA1, sampleX), rowEdge1), zero));
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA2, sampleX), rowEdge2), zero));
+        if (!_mm_movemask_ps(inside))
+            continue;
+
+        auto* dest = reinterpret_cast<__m128i*>(row + x);
+        const __m128i pixelDepth = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(depthA, sampleX), rowDepth));
+        const __m128i oldDepth = _mm_loadu_si128(dest);
+        const __m128i write = _mm_and_si128(_mm_castps_si128(inside), _mm_cmplt_epi32(pixelDepth, oldDepth));
+        _mm_storeu_si128(dest, _mm_or_si128(_mm_and_si128(write, pixelDepth), _mm_andnot_si128(write, oldDepth)));
+    }
+#else
+    for (int x = left; x <= right; ++x)
+    {
+        const float sampleX = (float)(x + 1);
+        if (triangle.edgeA_[0] * sampleX + edge0 >= 0.0f && triangle.edgeA_[1] * sampleX + edge1 >= 0.0f &&
+            triangle.edgeA_[2] * sampleX + edge2 >= 0.0f)
+        {
+            const int pixelDepth = RoundToInt(triangle.depthA_ * sampleX + depth);
+            if (pixelDepth < row[x])
+                row[x] = pixelDepth;
+        }
+    }
+#endif
+}
+
+void OcclusionBuffer::RasterizeTile(int tileIndex)
+{
+    const int tileLeft = (tileIndex % numTilesX_) * OCCLUSION_TILE_WIDTH;
+    const int tileTop = (tileIndex / numTilesX_) * OCCLUSION_TILE_HEIGHT;
+    const int tileRight = Min(tileLeft + OCCLUSION_TILE_WIDTH, width_) - 1;
+    const int tileBottom = Min(tileTop + OCCLUSION_TILE_HEIGHT, height_) - 1;
+    const int numTiles = numTilesX_ * numTilesY_;
+    int* bufferData = buffers_[0].data_;
+    bool rendered = false;
+
+    for (unsigned i = 0; i < tileTriangles_.size(); ++i)
+    {
+        ea::vector<unsigned>& bin = tileBins_[i * numTiles + tileIndex];
+        const ea::vector<OcclusionTriangle>& triangles = tileTriangles_[i];
+
+        for (unsigned triangleIndex : bin)
+        {
+            const OcclusionTriangle& triangle = triangles[triangleIndex];
+            const int left = Max(triangle.rect_.left_, tileLeft);
+            const int right = Min(triangle.rect_.right_, tileRight);
+            const int top = Max(triangle.rect_.top_, tileTop);
+            const int bottom = Min(triangle.rect_.bottom_, tileBottom);
+
+            for (int y = top; y <= bottom; ++y)
+                RasterizeTriangleRow(triangle, bufferData + y * width_, left, right, y);
+        }
+
+        rendered |= !bin.empty();
+        bin.clear();
+    }
+
+    // Update the farthest depth of the tile for rejecting triangles of later occluders
+    if (rendered)
+    {
+        int maxDepth = 0;
+        for (int y = tileTop; y <= tileBottom; ++y)
+        {
+            const int* row = bufferData + y * width_;
+            for (int x = tileLeft; x <= tileRight; ++x)
+                maxDepth = Max(maxDepth, row[x]);
+        }
+        tileMaxDepths_[tileIndex] = maxDepth;
+    }
+}
+
+void OcclusionBuffer::RasterizeTiles()
+{
+    URHO3D_PROFILE("RasterizeOcclusionTiles");
+
+    const int numTiles = numTilesX_ * numTilesY_;
+    if (threaded_)
+    {
+        auto* queue = GetSubsystem<WorkQueue>();
+        queue->ParallelFor(numTiles, 4, [this](unsigned begin, unsigned end, unsigned)
+        {
+            URHO3D_PROFILE("RasterizeOcclusionTilesWork");
+            for (unsigned i = begin; i < end; ++i)
+                RasterizeTile(i);
+        });
+    }
+    else
+    {
+        for (int i = 0; i < numTiles; ++i)
+            RasterizeTile(i);
+    }
+
+    for (auto& triangles : tileTriangles_)
+        triangles.clear();
+}
+
 void OcclusionBuffer::MergeBuffers()
 {
     URHO3D_PROFILE("MergeBuffers");
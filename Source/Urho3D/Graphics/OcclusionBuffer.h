@@ -81,8 +81,32 @@ struct OcclusionBatch
     unsigned drawCount_;
 };
 
+/// Screen space triangle binned by the tiled occlusion rasterizer.
+struct OcclusionTriangle
+{
+    /// Edge function X coefficients. A pixel is inside when all edge functions are non-negative.
+    float edgeA_[3];
+    /// Edge function Y coefficients.
+    float edgeB_[3];
+    /// Edge function constants.
+    float edgeC_[3];
+    /// Depth plane X coefficient.
+    float depthA_;
+    /// Depth plane Y coefficient.
+    float depthB_;
+    /// Depth plane constant.
+    float depthC_;
+    /// Nearest depth of the vertices.
+    int minDepth_;
+    /// Covered pixel rectangle, inclusive.
+    IntRect rect_;
+};
+
 static const int OCCLUSION_MIN_SIZE = 8;
+static const int OCCLUSION_TILE_WIDTH = 32;
+static const int OCCLUSION_TILE_HEIGHT = 8;
 static const int OCCLUSION_DEFAULT_MAX_TRIANGLES = 5000;
+static const unsigned OCCLUSION_TEST_CHUNK_SIZE = 64;
 static const float OCCLUSION_RELATIVE_BIAS = 0.00001f;
 static const int OCCLUSION_FIXED_BIAS = 16;
 static const float OCCLUSION_X_SCALE = 65536.0f;
@@ -110,6 +134,8 @@ public:
     void SetMaxTriangles(unsigned triangles);
     /// Set culling mode.
     void SetCullMode(CullMode mode);
+    /// Set rasterization backend. Takes effect on the next SetSize().
+    void SetRasterizer(OcclusionRasterizer rasterizer);
     /// Reset number of triangles.
     void Reset();
     /// Clear the buffer.
@@ -150,11 +176,16 @@ public:
     /// Return culling mode.
     CullMode GetCullMode() const { return cullMode_; }
 
+    /// Return rasterization backend.
+    OcclusionRasterizer GetRasterizer() const { return rasterizer_; }
+
     /// Return whether is using threads to speed up rendering.
-    bool IsThreaded() const { return buffers_.size() > 1; }
+    bool IsThreaded() const { return threaded_; }
 
     /// Test a bounding box for visibility. For best performance, build depth hierarchy first.
     bool IsVisible(const BoundingBox& worldSpaceBox) const;
+    /// Test bounding boxes for visibility and write the results to the visible array. The boxes are projected first and then tested against one depth hierarchy level at a time, with the same results as testing each box on its own. For best performance, build depth hierarchy first.
+    void IsVisible(const BoundingBox* worldSpaceBoxes, unsigned count, bool* visible) const;
     /// Return time since last use in milliseconds.
     unsigned GetUseTimer();
 
@@ -178,6 +209,20 @@ private:
     void ClipVertices(const Vector4& plane, Vector4* vertices, bool* triangles, unsigned& numTriangles);
     /// Draw a clipped triangle.
     void DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
+    /// Set up a clipped triangle for the tiled rasterizer and add it to the bins of the tiles it overlaps.
+    void BinTriangle2D(const Vector3* vertices, unsigned threadIndex);
+    /// Rasterize the binned triangles of a tile.
+    void RasterizeTile(int tileIndex);
+    /// Rasterize the binned triangles of all tiles and clear the bins. Uses worker threads if threaded.
+    void RasterizeTiles();
+    /// Return transformed corners of a bounding box in projection space.
+    inline void ProjectBox(const BoundingBox& worldSpaceBox, Vector4* vertices) const;
+    /// Calculate the screen rectangle and nearest depth of a bounding box for the visibility test. Return false if the box is visible without testing the depth, because it crosses the near plane or is outside the screen.
+    bool GetOccludeeRect(const BoundingBox& worldSpaceBox, IntRect& rect, int& z) const;
+    /// Test a screen rectangle against a depth hierarchy level. Return true and set visible if the result is conclusive.
+    bool TestMipLevel(int level, const IntRect& rect, int z, bool& visible) const;
+    /// Test a screen rectangle against the pixel-level depth. Return true if visible.
+    bool TestPixels(const IntRect& rect, int z) const;
     /// Clear a thread work buffer.
     void ClearBuffer(unsigned threadIndex);
     /// Merge thread work buffers into the first buffer.
@@ -189,6 +234,16 @@ private:
     ea::vector<ea::shared_array<DepthValue> > mipBuffers_;
     /// Submitted render jobs.
     ea::vector<OcclusionBatch> batches_;
+    /// Binned triangles of the tiled rasterizer per thread.
+    ea::vector<ea::vector<OcclusionTriangle> > tileTriangles_;
+    /// Binned triangle indices of the tiled rasterizer, per thread and tile. Indexed by thread index * number of tiles + tile index.
+    ea::vector<ea::vector<unsigned> > tileBins_;
+    /// Farthest depth of each tile after the last rasterization. Used to reject triangles behind already rendered occluders.
+    ea::vector<int> tileMaxDepths_;
+    /// Number of tiles horizontally.
+    int numTilesX_{};
+    /// Number of tiles vertically.
+    int numTilesY_{};
     /// Buffer width.
     int width_{};
     /// Buffer height.
@@ -199,6 +254,10 @@ private:
     unsigned maxTriangles_{OCCLUSION_DEFAULT_MAX_TRIANGLES};
     /// Culling mode.
     CullMode cullMode_{CULL_CCW};
+    /// Rasterization backend.
+    OcclusionRasterizer rasterizer_{OCCLUSION_RASTERIZER_SCANLINE};
+    /// Threaded rendering flag.
+    bool threaded_{};
     /// Depth hierarchy needs update flag.
     bool depthHierarchyDirty_{true};
     /// Culling reverse flag.
@@ -47,28 +47,19 @@ namespace Urho3D
 
 static const float DEFAULT_OCTREE_SIZE = 1000.0f;
 static const int DEFAULT_OCTREE_LEVELS = 8;
+static const unsigned DRAWABLE_UPDATE_BATCH_SIZE = 64;
+static const unsigned RAYCAST_BATCH_SIZE = 16;
 
 extern const char* SUBSYSTEM_CATEGORY;
 
-void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex)
+inline bool CompareRayQueryResults(const RayQueryResult& lhs, const RayQueryResult& rhs)
 {
-    URHO3D_PROFILE("UpdateDrawablesWork");
-    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
-    auto** start = reinterpret_cast<Drawable**>(item->start_);
-    auto** end = reinterpret_cast<Drawable**>(item->end_);
-
-    while (start != end)
-    {
-        Drawable* drawable = *start;
-        if (drawable)
-            drawable->Update(frame);
-        ++start;
-    }
+    return lhs.distance_ < rhs.distance_;
 }
 
-inline bool CompareRayQueryResults(const RayQueryResult& lhs, const RayQueryResult& rhs)
+inline bool CompareRayCandidates(const ea::pair<float, Drawable*>& lhs, const ea::pair<float, Drawable*>& rhs)
 {
-    return lhs.distance_ < rhs.distance_;
+    return lhs.first < rhs.first;
 }
 
 Octant::Octant(const BoundingBox& box, unsigned level, Octant* parent, Octree* root, unsigned index) :
@@ -87,11 +78,11 @@ Octant::~Octant()
         // Remove the drawables (if any) from this octant to the root octant
         for (auto i = drawables_.begin(); i != drawables_.end(); ++i)
         {
-            (*i)->SetOctant(root_);
-            root_->drawables_.push_back(*i);
+            root_->PushDrawable(*i);
             root_->QueueUpdate(*i);
         }
         drawables_.clear();
+        packedBounds_.Clear();
         numDrawables_ = 0;
     }
 
@@ -151,11 +142,15 @@ void Octant::InsertDrawable(Drawable* drawable)
         Octant* oldOctant = drawable->octant_;
         if (oldOctant != this)
         {
-            // Add first, then remove, because drawable count going to zero deletes the octree branch in question
+            // Add first, then remove, because drawable count going to zero deletes the octree branch in question.
+            // Adding overwrites the index of the drawable, so the index in the old octant is kept for the removal
+            const unsigned oldIndex = drawable->octantIndex_;
             AddDrawable(drawable);
             if (oldOctant)
-                oldOctant->RemoveDrawable(drawable, false);
+                oldOctant->RemoveDrawable(drawable, oldIndex, false);
         }
+        else
+            UpdateDrawable(drawable);
     }
     else
     {
@@ -244,11 +239,7 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
     }
 
     if (drawables_.size())
-    {
-        auto** start = const_cast<Drawable**>(&drawables_[0]);
-        Drawable** end = start + drawables_.size();
-        query.TestDrawables(start, end, inside);
-    }
+        query.TestPackedDrawables(const_cast<Drawable**>(&drawables_[0]), packedBounds_, inside);
 
     for (auto child : children_)
     {
@@ -284,30 +275,30 @@ void Octant::GetDrawablesInternal(RayOctreeQuery& query) const
     }
 }
 
-void Octant::GetDrawablesOnlyInternal(RayOctreeQuery& query, ea::vector<Drawable*>& drawables) const
+void Octant::GetRayCandidatesInternal(const RayOctreeQuery& query, ea::vector<ea::pair<float, Drawable*> >& candidates) const
 {
     float octantDist = query.ray_.HitDistance(cullingBox_);
     if (octantDist >= query.maxDistance_)
         return;
 
-    if (drawables_.size())
+    // Reject by the packed flags and view masks before touching the drawables
+    const unsigned drawableFlags = query.drawableFlags_.AsInteger();
+    const unsigned numDrawables = drawables_.size();
+    for (unsigned i = 0; i < numDrawables; ++i)
     {
-        auto** start = const_cast<Drawable**>(&drawables_[0]);
-        Drawable** end = start + drawables_.size();
-
-        while (start != end)
+        if ((packedBounds_.drawableFlags_[i] & drawableFlags) && (packedBounds_.viewMasks_[i] & query.viewMask_))
         {
-            Drawable* drawable = *start++;
-
-            if ((drawable->GetDrawableFlags() & query.drawableFlags_) && (drawable->GetViewMask() & query.viewMask_))
-                drawables.push_back(drawable);
+            Drawable* drawable = drawables_[i];
+            float distance = query.ray_.HitDistance(drawable->GetWorldBoundingBox());
+            if (distance < query.maxDistance_)
+                candidates.emplace_back(distance, drawable);
         }
     }
 
     for (auto child : children_)
     {
         if (child)
-            child->GetDrawablesOnlyInternal(query, drawables);
+            child->GetRayCandidatesInternal(query, candidates);
     }
 }
 
@@ -372,6 +363,10 @@ void Octree::Update(const FrameInfo& frame)
         return;
     }
 
+    // Resolve the world transforms changed after the scene update in a batch, before drawables start reading them
+    if (Scene* scene = GetScene())
+        scene->UpdateTransforms();
+
     // Let drawables update themselves before reinsertion. This can be used for animation
     if (!drawableUpdates_.empty())
     {
@@ -383,30 +378,16 @@ void Octree::Update(const FrameInfo& frame)
         auto* queue = GetSubsystem<WorkQueue>();
         scene->BeginThreadedUpdate();
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = Max((int)(drawableUpdates_.size() / numWorkItems), 1);
-
-        auto start = drawableUpdates_.begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
+        // Split into small batches, so that threads which finish early can take over the remaining work
+        queue->ParallelFor(drawableUpdates_.size(), DRAWABLE_UPDATE_BATCH_SIZE, [&](unsigned begin, unsigned end, unsigned)
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = UpdateDrawablesWork;
-            item->aux_ = const_cast<FrameInfo*>(&frame);
-
-            auto end = drawableUpdates_.end();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
-
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
-
-        queue->Complete(M_MAX_UNSIGNED);
+            URHO3D_PROFILE("UpdateDrawablesWork");
+            for (unsigned i = begin; i < end; ++i)
+            {
+                if (Drawable* drawable = drawableUpdates_[i])
+                    drawable->Update(frame);
+            }
+        });
         scene->EndThreadedUpdate();
     }
 
@@ -457,9 +438,12 @@ void Octree::Update(const FrameInfo& frame)
             // Skip if no octant or does not belong to this octree anymore
             if (!octant || octant->GetRoot() != this)
                 continue;
-            // Skip if still fits the current octant
+            // Skip if still fits the current octant, but refresh the packed bounds
             if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
+            {
+                octant->UpdateDrawable(drawable);
                 continue;
+            }
 
             InsertDrawable(drawable);
 
@@ -476,6 +460,10 @@ void Octree::Update(const FrameInfo& frame)
     }
 
     drawableUpdates_.clear();
+
+    // Drawables may have been queued from other threads during the reinsertion
+    MutexLock lock(octreeMutex_);
+    hasQueuedUpdates_ = !threadedDrawableUpdates_.empty();
 }
 
 void Octree::AddManualDrawable(Drawable* drawable)
@@ -499,6 +487,7 @@ void Octree::RemoveManualDrawable(Drawable* drawable)
 void Octree::GetDrawables(OctreeQuery& query) const
 {
     query.result_.clear();
+    query.testQueuedUpdates_ = hasQueuedUpdates_;
     GetDrawablesInternal(query, false);
 }
 
@@ -515,25 +504,92 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
 {
     URHO3D_PROFILE("Raycast");
 
-    query.result_.clear();
-    rayQueryDrawables_.clear();
-    GetDrawablesOnlyInternal(query, rayQueryDrawables_);
+    RaycastSingleInternal(query, rayQueryDrawables_);
+}
 
-    // Sort by increasing hit distance to AABB
-    for (auto i = rayQueryDrawables_.begin(); i != rayQueryDrawables_.end(); ++i)
+void Octree::RaycastSingleBatch(RayOctreeBatchQuery& query) const
+{
+    URHO3D_PROFILE("RaycastBatch");
+
+    if (!Thread::IsMainThread())
     {
-        Drawable* drawable = *i;
-        drawable->SetSortValue(query.ray_.HitDistance(drawable->GetWorldBoundingBox()));
+        URHO3D_LOGERROR("Octree::RaycastSingleBatch() can not be called from worker threads");
+        return;
     }
 
-    ea::quick_sort(rayQueryDrawables_.begin(), rayQueryDrawables_.end(), CompareDrawables);
+    const unsigned numRays = query.rays_.size();
+    query.results_.resize(numRays);
+    if (!numRays)
+        return;
+
+    // Resolve dirty world transforms and bounding boxes up front, so that the worker threads only read them
+    if (Scene* scene = GetScene())
+        scene->UpdateTransforms();
+    ResolveQueuedBoundingBoxes();
+
+    // Process rays with nearby origins and similar directions together, so that they visit the same octants
+    GetCoherentRayOrder(query.rays_, query.order_);
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    queue->ParallelFor(numRays, RAYCAST_BATCH_SIZE, [&](unsigned begin, unsigned end, unsigned)
+    {
+        URHO3D_PROFILE("RaycastBatchWork");
+
+        // Per-thread temporary storage is kept between batches to avoid allocation
+        static thread_local ea::vector<ea::pair<float, Drawable*> > candidates;
+        static thread_local ea::vector<RayQueryResult> hits;
+
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const unsigned index = query.order_[i];
+            RayOctreeQuery rayQuery(hits, query.rays_[index], query.level_, query.maxDistance_, query.drawableFlags_,
+                query.viewMask_);
+            RaycastSingleInternal(rayQuery, candidates);
+
+            RayQueryResult& result = query.results_[index];
+            if (!hits.empty())
+                result = hits.front();
+            else
+            {
+                result = RayQueryResult();
+                result.distance_ = M_INFINITY;
+            }
+        }
+    });
+}
+
+void Octree::ResolveQueuedBoundingBoxes() const
+{
+    // Drawables mark their bounding box dirty only together with queuing an octree update
+    for (Drawable* drawable : drawableUpdates_)
+    {
+        if (drawable)
+            drawable->GetWorldBoundingBox();
+    }
+
+    MutexLock lock(octreeMutex_);
+    for (Drawable* drawable : threadedDrawableUpdates_)
+    {
+        if (drawable)
+            drawable->GetWorldBoundingBox();
+    }
+}
+
+void Octree::RaycastSingleInternal(RayOctreeQuery& query, ea::vector<ea::pair<float, Drawable*> >& candidates) const
+{
+    query.result_.clear();
+    candidates.clear();
+    GetRayCandidatesInternal(query, candidates);
+
+    // Sort by increasing hit distance to AABB
+    ea::quick_sort(candidates.begin(), candidates.end(), CompareRayCandidates);
 
     // Then do the actual test according to the query, and early-out as possible
     float closestHit = M_INFINITY;
-    for (auto i = rayQueryDrawables_.begin(); i != rayQueryDrawables_.end(); ++i)
+    for (auto i = candidates.begin(); i != candidates.end(); ++i)
     {
-        Drawable* drawable = *i;
-        if (drawable->GetSortValue() < Min(closestHit, query.maxDistance_))
+        Drawable* drawable = i->second;
+        if (i->first < Min(closestHit, query.maxDistance_))
         {
             unsigned oldSize = query.result_.size();
             drawable->ProcessRayQuery(query, query.result_);
@@ -553,8 +609,9 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
 
 void Octree::QueueUpdate(Drawable* drawable)
 {
+    // Drawables may also change their bounds while views are being processed in worker threads
     Scene* scene = GetScene();
-    if (scene && scene->IsThreadedUpdate())
+    if ((scene && scene->IsThreadedUpdate()) || !Thread::IsMainThread())
     {
         MutexLock lock(octreeMutex_);
         threadedDrawableUpdates_.push_back(drawable);
@@ -563,13 +620,16 @@ void Octree::QueueUpdate(Drawable* drawable)
         drawableUpdates_.push_back(drawable);
 
     drawable->updateQueued_ = true;
+    hasQueuedUpdates_ = true;
 }
 
 void Octree::CancelUpdate(Drawable* drawable)
 {
     // This doesn't have to take into account scene being in threaded update, because it is called only
     // when removing a drawable from octree, which should only ever happen from the main thread.
+    // The drawable may still be queued from view processing in the previous frame
     drawableUpdates_.erase_first(drawable);
+    threadedDrawableUpdates_.erase_first(drawable);
     drawable->updateQueued_ = false;
 }
 
@@ -26,6 +26,8 @@
 #include "../Graphics/Drawable.h"
 #include "../Graphics/OctreeQuery.h"
 
+#include <atomic>
+
 namespace Urho3D
 {
 
@@ -55,24 +57,44 @@ public:
     /// Add a drawable object to this octant.
     void AddDrawable(Drawable* drawable)
     {
-        drawable->SetOctant(this);
-        drawables_.push_back(drawable);
+        PushDrawable(drawable);
         IncDrawableCount();
     }
 
-    /// Remove a drawable object from this octant.
+    /// Remove a drawable object from this octant. The last drawable object takes its place.
     void RemoveDrawable(Drawable* drawable, bool resetOctant = true)
     {
-        auto it = drawables_.find(drawable);
-        if (it != drawables_.end())
+        RemoveDrawable(drawable, drawable->octantIndex_, resetOctant);
+    }
+
+    /// Remove a drawable object stored at the specified index of this octant. The last drawable object takes its place.
+    void RemoveDrawable(Drawable* drawable, unsigned index, bool resetOctant)
+    {
+        if (index < drawables_.size() && drawables_[index] == drawable)
         {
-            drawables_.erase(it);
+            // The drawable object may already be in another octant, so its index is not touched when it is the last one
+            Drawable* last = drawables_.back();
+            if (last != drawable)
+            {
+                drawables_[index] = last;
+                last->octantIndex_ = index;
+            }
+            drawables_.pop_back();
+            packedBounds_.RemoveSwap(index);
             if (resetOctant)
                 drawable->SetOctant(nullptr);
             DecDrawableCount();
         }
     }
 
+    /// Refresh the packed bounding box, flags and view mask of a drawable object in this octant.
+    void UpdateDrawable(Drawable* drawable)
+    {
+        const unsigned index = drawable->octantIndex_;
+        if (index < drawables_.size() && drawables_[index] == drawable)
+            packedBounds_.Set(index, drawable);
+    }
+
     /// Return world-space bounding box.
     const BoundingBox& GetWorldBoundingBox() const { return worldBoundingBox_; }
 
@@ -106,8 +128,17 @@ protected:
     void GetDrawablesInternal(OctreeQuery& query, bool inside) const;
     /// Return drawable objects by a ray query, called internally.
     void GetDrawablesInternal(RayOctreeQuery& query) const;
-    /// Return drawable objects only for a threaded ray query, called internally.
-    void GetDrawablesOnlyInternal(RayOctreeQuery& query, ea::vector<Drawable*>& drawables) const;
+    /// Return drawable objects hit by the bounding box test of a single hit ray query and their hit distances, called internally. Reads the world bounding boxes, which must already be resolved when called from worker threads.
+    void GetRayCandidatesInternal(const RayOctreeQuery& query, ea::vector<ea::pair<float, Drawable*> >& candidates) const;
+
+    /// Append a drawable object and its packed bounds without changing the drawable object count.
+    void PushDrawable(Drawable* drawable)
+    {
+        drawable->SetOctant(this);
+        drawable->octantIndex_ = drawables_.size();
+        drawables_.push_back(drawable);
+        packedBounds_.Push(drawable);
+    }
 
     /// Increase drawable object count recursively.
     void IncDrawableCount()
@@ -139,6 +170,8 @@ protected:
     BoundingBox cullingBox_;
     /// Drawable objects.
     ea::vector<Drawable*> drawables_;
+    /// World bounding boxes, flags and view masks of the drawable objects, in the same order.
+    PackedDrawableBounds packedBounds_;
     /// Child octants.
     Octant* children_[NUM_OCTANTS]{};
     /// World bounding box center.
@@ -188,6 +221,8 @@ public:
     void Raycast(RayOctreeQuery& query) const;
     /// Return the closest drawable object by a ray query.
     void RaycastSingle(RayOctreeQuery& query) const;
+    /// Return the closest drawable object for each ray of a batched ray query. Must be called from the main thread. Dirty world transforms and bounding boxes are resolved first, then the rays are processed in worker threads, so the scene must not be modified concurrently.
+    void RaycastSingleBatch(RayOctreeBatchQuery& query) const;
 
     /// Return subdivision levels.
     unsigned GetNumLevels() const { return numLevels_; }
@@ -204,15 +239,21 @@ private:
     void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
     /// Update octree size.
     void UpdateOctreeSize() { SetSize(worldBoundingBox_, numLevels_); }
+    /// Calculate the dirty world bounding boxes of the drawables queued for update, so that worker threads can read them without writing.
+    void ResolveQueuedBoundingBoxes() const;
+    /// Return the closest drawable object by a ray query using the specified temporary list of candidates. Safe to call from worker threads once the bounding boxes have been resolved.
+    void RaycastSingleInternal(RayOctreeQuery& query, ea::vector<ea::pair<float, Drawable*> >& candidates) const;
 
     /// Drawable objects that require update.
     ea::vector<Drawable*> drawableUpdates_;
     /// Drawable objects that were inserted during threaded update phase.
     ea::vector<Drawable*> threadedDrawableUpdates_;
     /// Mutex for octree reinsertions.
-    Mutex octreeMutex_;
-    /// Ray query temporary list of drawables.
-    mutable ea::vector<Drawable*> rayQueryDrawables_;
+    mutable Mutex octreeMutex_;
+    /// Whether drawables have been queued for update since the last reinsertion, so that their packed bounds may be out of date.
+    std::atomic<bool> hasQueuedUpdates_{};
+    /// Ray query temporary list of drawables and their hit distances.
+    mutable ea::vector<ea::pair<float, Drawable*> > rayQueryDrawables_;
     /// Subdivision level.
     unsigned numLevels_;
 };
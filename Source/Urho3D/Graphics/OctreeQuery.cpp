@@ -24,11 +24,317 @@
 
 #include "../Graphics/OctreeQuery.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
 {
 
+/// Maximum number of drawables passed to TestDrawables() at once from a packed test.
+static const unsigned MAX_PASSED_DRAWABLES = 64;
+
+/// Return bounding box of a packed drawable.
+static BoundingBox GetPackedBoundingBox(const PackedDrawableBounds& bounds, unsigned index)
+{
+    return BoundingBox(Vector3(bounds.minX_[index], bounds.minY_[index], bounds.minZ_[index]),
+        Vector3(bounds.maxX_[index], bounds.maxY_[index], bounds.maxZ_[index]));
+}
+
+/// Test packed drawables for flags, view mask and bounds, four at a time if possible, and pass the ones that pass to the per-drawable test as inside.
+/// The bounds test provides TestFour() returning a bit mask of the four drawables starting at index that are not outside, and Test() for a single drawable.
+/// Drawables queued for an octree update may have moved since their bounds were packed, so they are passed to the per-drawable test instead.
+template <class T> static void TestPackedDrawablesImpl(OctreeQuery& query, Drawable** drawables, const PackedDrawableBounds& bounds,
+    bool inside, const T& boundsTest)
+{
+    Drawable* passed[MAX_PASSED_DRAWABLES];
+    unsigned numPassed = 0;
+    Drawable* queued[MAX_PASSED_DRAWABLES];
+    unsigned numQueued = 0;
+    const unsigned size = bounds.Size();
+    const unsigned drawableFlags = query.drawableFlags_.AsInteger();
+    const unsigned viewMask = query.viewMask_;
+    const bool testQueued = query.testQueuedUpdates_;
+    unsigned i = 0;
+
+#ifdef URHO3D_SSE
+    const __m128i queryFlags = _mm_set1_epi32(drawableFlags);
+    const __m128i queryViewMask = _mm_set1_epi32(viewMask);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m128i flags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&bounds.drawableFlags_[i]));
+        const __m128i viewMasks = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&bounds.viewMasks_[i]));
+        const __m128i rejected = _mm_or_si128(_mm_cmpeq_epi32(_mm_and_si128(flags, queryFlags), zero),
+            _mm_cmpeq_epi32(_mm_and_si128(viewMasks, queryViewMask), zero));
+        unsigned mask = ~(unsigned)_mm_movemask_ps(_mm_castsi128_ps(rejected)) & 0xfu;
+        if (mask && testQueued)
+        {
+            for (unsigned j = 0; j < 4; ++j)
+            {
+                if ((mask & (1u << j)) && drawables[i + j]->IsUpdateQueued())
+                {
+                    queued[numQueued++] = drawables[i + j];
+                    mask &= ~(1u << j);
+                }
+            }
+            if (numQueued + 4 > MAX_PASSED_DRAWABLES)
+            {
+                query.TestDrawables(queued, queued + numQueued, inside);
+                numQueued = 0;
+            }
+        }
+        if (mask && !inside)
+            mask &= boundsTest.TestFour(bounds, i);
+        if (!mask)
+            continue;
+
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            if (mask & (1u << j))
+                passed[numPassed++] = drawables[i + j];
+        }
+        if (numPassed + 4 > MAX_PASSED_DRAWABLES)
+        {
+            query.TestDrawables(passed, passed + numPassed, true);
+            numPassed = 0;
+        }
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        if (!(bounds.drawableFlags_[i] & drawableFlags) || !(bounds.viewMasks_[i] & viewMask))
+            continue;
+
+        if (testQueued && drawables[i]->IsUpdateQueued())
+        {
+            queued[numQueued++] = drawables[i];
+            if (numQueued == MAX_PASSED_DRAWABLES)
+            {
+                query.TestDrawables(queued, queued + numQueued, inside);
+                numQueued = 0;
+            }
+        }
+        else if (inside || boundsTest.Test(bounds, i))
+        {
+            passed[numPassed++] = drawables[i];
+            if (numPassed == MAX_PASSED_DRAWABLES)
+            {
+                query.TestDrawables(passed, passed + numPassed, true);
+                numPassed = 0;
+            }
+        }
+    }
+
+    if (numPassed)
+        query.TestDrawables(passed, passed + numPassed, true);
+    if (numQueued)
+        query.TestDrawables(queued, queued + numQueued, inside);
+}
+
+/// Packed point test.
+struct PackedPointTest
+{
+#ifdef URHO3D_SSE
+    unsigned TestFour(const PackedDrawableBounds& bounds, unsigned i) const
+    {
+        const __m128 x = _mm_set1_ps(point_.x_);
+        const __m128 y = _mm_set1_ps(point_.y_);
+        const __m128 z = _mm_set1_ps(point_.z_);
+        __m128 outside = _mm_or_ps(_mm_cmplt_ps(x, _mm_loadu_ps(&bounds.minX_[i])), _mm_cmpgt_ps(x, _mm_loadu_ps(&bounds.maxX_[i])));
+        outside = _mm_or_ps(outside, _mm_or_ps(_mm_cmplt_ps(y, _mm_loadu_ps(&bounds.minY_[i])), _mm_cmpgt_ps(y, _mm_loadu_ps(&bounds.maxY_[i]))));
+        outside = _mm_or_ps(outside, _mm_or_ps(_mm_cmplt_ps(z, _mm_loadu_ps(&bounds.minZ_[i])), _mm_cmpgt_ps(z, _mm_loadu_ps(&bounds.maxZ_[i]))));
+        return ~(unsigned)_mm_movemask_ps(outside) & 0xfu;
+    }
+#endif
+
+    bool Test(const PackedDrawableBounds& bounds, unsigned i) const
+    {
+        return GetPackedBoundingBox(bounds, i).IsInside(point_) != OUTSIDE;
+    }
+
+    /// Point.
+    const Vector3& point_;
+};
+
+/// Packed sphere test.
+struct PackedSphereTest
+{
+#ifdef URHO3D_SSE
+    unsigned TestFour(const PackedDrawableBounds& bounds, unsigned i) const
+    {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 x = _mm_set1_ps(sphere_.center_.x_);
+        const __m128 y = _mm_set1_ps(sphere_.center_.y_);
+        const __m128 z = _mm_set1_ps(sphere_.center_.z_);
+        // Distance to the box along each axis. Only one of the terms is nonzero
+        const __m128 dx = _mm_add_ps(_mm_min_ps(_mm_sub_ps(x, _mm_loadu_ps(&bounds.minX_[i])), zero),
+            _mm_max_ps(_mm_sub_ps(x, _mm_loadu_ps(&bounds.maxX_[i])), zero));
+        const __m128 dy = _mm_add_ps(_mm_min_ps(_mm_sub_ps(y, _mm_loadu_ps(&bounds.minY_[i])), zero),
+            _mm_max_ps(_mm_sub_ps(y, _mm_loadu_ps(&bounds.maxY_[i])), zero));
+        const __m128 dz = _mm_add_ps(_mm_min_ps(_mm_sub_ps(z, _mm_loadu_ps(&bounds.minZ_[i])), zero),
+            _mm_max_ps(_mm_sub_ps(z, _mm_loadu_ps(&bounds.maxZ_[i])), zero));
+        const __m128 distSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        const __m128 radiusSquared = _mm_set1_ps(sphere_.radius_ * sphere_.radius_);
+        return (unsigned)_mm_movemask_ps(_mm_cmplt_ps(distSquared, radiusSquared));
+    }
+#endif
+
+    bool Test(const PackedDrawableBounds& bounds, unsigned i) const
+    {
+        return sphere_.IsInsideFast(GetPackedBoundingBox(bounds, i)) != OUTSIDE;
+    }
+
+    /// Sphere.
+    const Sphere& sphere_;
+};
+
+/// Packed bounding box test.
+struct PackedBoxTest
+{
+#ifdef URHO3D_SSE
+    unsigned TestFour(const PackedDrawableBounds& bounds, unsigned i) const
+    {
+        __m128 outside = _mm_or_ps(_mm_cmplt_ps(_mm_loadu_ps(&bounds.maxX_[i]), _mm_set1_ps(box_.min_.x_)),
+            _mm_cmpgt_ps(_mm_loadu_ps(&bounds.minX_[i]), _mm_set1_ps(box_.max_.x_)));
+        outside = _mm_or_ps(outside, _mm_or_ps(_mm_cmplt_ps(_mm_loadu_ps(&bounds.maxY_[i]), _mm_set1_ps(box_.min_.y_)),
+            _mm_cmpgt_ps(_mm_loadu_ps(&bounds.minY_[i]), _mm_set1_ps(box_.max_.y_))));
+        outside = _mm_or_ps(outside, _mm_or_ps(_mm_cmplt_ps(_mm_loadu_ps(&bounds.maxZ_[i]), _mm_set1_ps(box_.min_.z_)),
+            _mm_cmpgt_ps(_mm_loadu_ps(&bounds.minZ_[i]), _mm_set1_ps(box_.max_.z_))));
+        return ~(unsigned)_mm_movemask_ps(outside) & 0xfu;
+    }
+#endif
+
+    bool Test(const PackedDrawableBounds& bounds, unsigned i) const
+    {
+        return box_.IsInsideFast(GetPackedBoundingBox(bounds, i)) != OUTSIDE;
+    }
+
+    /// Bounding box.
+    const BoundingBox& box_;
+};
+
+/// Packed frustum test.
+struct PackedFrustumTest
+{
+#ifdef URHO3D_SSE
+    unsigned TestFour(const PackedDrawableBounds& bounds, unsigned i) const
+    {
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 minX = _mm_loadu_ps(&bounds.minX_[i]);
+        const __m128 minY = _mm_loadu_ps(&bounds.minY_[i]);
+        const __m128 minZ = _mm_loadu_ps(&bounds.minZ_[i]);
+        const __m128 centerX = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&bounds.maxX_[i]), minX), half);
+        const __m128 centerY = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&bounds.maxY_[i]), minY), half);
+        const __m128 centerZ = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&bounds.maxZ_[i]), minZ), half);
+        const __m128 edgeX = _mm_sub_ps(centerX, minX);
+        const __m128 edgeY = _mm_sub_ps(centerY, minY);
+        const __m128 edgeZ = _mm_sub_ps(centerZ, minZ);
+
+        __m128 outside = _mm_setzero_ps();
+        for (const Plane& plane : frustum_.planes_)
+        {
+            const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal_.x_), centerX),
+                _mm_mul_ps(_mm_set1_ps(plane.normal_.y_), centerY)), _mm_mul_ps(_mm_set1_ps(plane.normal_.z_), centerZ)),
+                _mm_set1_ps(plane.d_));
+            const __m128 absDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.absNormal_.x_), edgeX),
+                _mm_mul_ps(_mm_set1_ps(plane.absNormal_.y_), edgeY)), _mm_mul_ps(_mm_set1_ps(plane.absNormal_.z_), edgeZ));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_sub_ps(_mm_setzero_ps(), absDist)));
+        }
+        return ~(unsigned)_mm_movemask_ps(outside) & 0xfu;
+    }
+#endif
+
+    bool Test(const PackedDrawableBounds& bounds, unsigned i) const
+    {
+        return frustum_.IsInsideFast(GetPackedBoundingBox(bounds, i)) != OUTSIDE;
+    }
+
+    /// Frustum.
+    const Frustum& frustum_;
+};
+
+/// Packed test that passes all drawables.
+struct PackedAllTest
+{
+#ifdef URHO3D_SSE
+    unsigned TestFour(const PackedDrawableBounds& bounds, unsigned i) const { return 0xfu; }
+#endif
+
+    bool Test(const PackedDrawableBounds& bounds, unsigned i) const { return true; }
+};
+
+void PackedDrawableBounds::Push(Drawable* drawable)
+{
+    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    minX_.push_back(box.min_.x_);
+    minY_.push_back(box.min_.y_);
+    minZ_.push_back(box.min_.z_);
+    maxX_.push_back(box.max_.x_);
+    maxY_.push_back(box.max_.y_);
+    maxZ_.push_back(box.max_.z_);
+    drawableFlags_.push_back(drawable->GetDrawableFlags().AsInteger());
+    viewMasks_.push_back(drawable->GetViewMask());
+}
+
+void PackedDrawableBounds::Set(unsigned index, Drawable* drawable)
+{
+    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    minX_[index] = box.min_.x_;
+    minY_[index] = box.min_.y_;
+    minZ_[index] = box.min_.z_;
+    maxX_[index] = box.max_.x_;
+    maxY_[index] = box.max_.y_;
+    maxZ_[index] = box.max_.z_;
+    drawableFlags_[index] = drawable->GetDrawableFlags().AsInteger();
+    viewMasks_[index] = drawable->GetViewMask();
+}
+
+void PackedDrawableBounds::RemoveSwap(unsigned index)
+{
+    const unsigned last = Size() - 1;
+    if (index != last)
+    {
+        minX_[index] = minX_[last];
+        minY_[index] = minY_[last];
+        minZ_[index] = minZ_[last];
+        maxX_[index] = maxX_[last];
+        maxY_[index] = maxY_[last];
+        maxZ_[index] = maxZ_[last];
+        drawableFlags_[index] = drawableFlags_[last];
+        viewMasks_[index] = viewMasks_[last];
+    }
+
+    minX_.pop_back();
+    minY_.pop_back();
+    minZ_.pop_back();
+    maxX_.pop_back();
+    maxY_.pop_back();
+    maxZ_.pop_back();
+    drawableFlags_.pop_back();
+    viewMasks_.pop_back();
+}
+
+void PackedDrawableBounds::Clear()
+{
+    minX_.clear();
+    minY_.clear();
+    minZ_.clear();
+    maxX_.clear();
+    maxY_.clear();
+    maxZ_.clear();
+    drawableFlags_.clear();
+    viewMasks_.clear();
+}
+
+void OctreeQuery::TestPackedDrawables(Drawable** drawables, const PackedDrawableBounds& bounds, bool inside)
+{
+    TestDrawables(drawables, drawables + bounds.Size(), inside);
+}
+
 Intersection PointOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
     if (inside)
@@ -51,6 +357,11 @@ void PointOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool insi
     }
 }
 
+void PointOctreeQuery::TestPackedDrawables(Drawable** drawables, const PackedDrawableBounds& bounds, bool inside)
+{
+    TestPackedDrawablesImpl(*this, drawables, bounds, inside, PackedPointTest{point_});
+}
+
 Intersection SphereOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
     if (inside)
@@ -73,6 +384,11 @@ void SphereOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool ins
     }
 }
 
+void SphereOctreeQuery::TestPackedDrawables(Drawable** drawables, const PackedDrawableBounds& bounds, bool inside)
+{
+    TestPackedDrawablesImpl(*this, drawables, bounds, inside, PackedSphereTest{sphere_});
+}
+
 Intersection BoxOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
     if (inside)
@@ -95,6 +411,11 @@ void BoxOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool inside
     }
 }
 
+void BoxOctreeQuery::TestPackedDrawables(Drawable** drawables, const PackedDrawableBounds& bounds, bool inside)
+{
+    TestPackedDrawablesImpl(*this, drawables, bounds, inside, PackedBoxTest{box_});
+}
+
 Intersection FrustumOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
     if (inside)
@@ -117,6 +438,10 @@ void FrustumOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool in
     }
 }
 
+void FrustumOctreeQuery::TestPackedDrawables(Drawable** drawables, const PackedDrawableBounds& bounds, bool inside)
+{
+    TestPackedDrawablesImpl(*this, drawables, bounds, inside, PackedFrustumTest{frustum_});
+}
 
 Intersection AllContentOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
@@ -134,4 +459,9 @@ void AllContentOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool
     }
 }
 
+void AllContentOctreeQuery::TestPackedDrawables(Drawable** drawables, const PackedDrawableBounds& bounds, bool inside)
+{
+    TestPackedDrawablesImpl(*this, drawables, bounds, inside, PackedAllTest{});
+}
+
 }
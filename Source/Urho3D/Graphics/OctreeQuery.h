@@ -37,6 +37,39 @@ namespace Urho3D
 class Drawable;
 class Node;
 
+/// World bounding boxes, flags and view masks of the drawables in an octant, packed into separate arrays for vectorized queries.
+struct URHO3D_API PackedDrawableBounds
+{
+    /// Return number of drawables.
+    unsigned Size() const { return viewMasks_.size(); }
+
+    /// Add a drawable to the end.
+    void Push(Drawable* drawable);
+    /// Refresh the bounding box, flags and view mask at index from a drawable.
+    void Set(unsigned index, Drawable* drawable);
+    /// Remove the drawable at index by moving the last one in its place.
+    void RemoveSwap(unsigned index);
+    /// Remove all drawables.
+    void Clear();
+
+    /// Bounding box minimum X coordinates.
+    ea::vector<float> minX_;
+    /// Bounding box minimum Y coordinates.
+    ea::vector<float> minY_;
+    /// Bounding box minimum Z coordinates.
+    ea::vector<float> minZ_;
+    /// Bounding box maximum X coordinates.
+    ea::vector<float> maxX_;
+    /// Bounding box maximum Y coordinates.
+    ea::vector<float> maxY_;
+    /// Bounding box maximum Z coordinates.
+    ea::vector<float> maxZ_;
+    /// Drawable flags.
+    ea::vector<unsigned> drawableFlags_;
+    /// View masks.
+    ea::vector<unsigned> viewMasks_;
+};
+
 /// Base class for octree queries.
 class URHO3D_API OctreeQuery : private NonCopyable
 {
@@ -56,6 +89,8 @@ public:
     virtual Intersection TestOctant(const BoundingBox& box, bool inside) = 0;
     /// Intersection test for drawables.
     virtual void TestDrawables(Drawable** start, Drawable** end, bool inside) = 0;
+    /// Intersection test for drawables with packed bounds. Built-in queries test the packed flags, view masks and bounds first and pass only the drawables that pass to TestDrawables() as inside. By default passes all drawables.
+    virtual void TestPackedDrawables(Drawable** drawables, const PackedDrawableBounds& bounds, bool inside);
 
     /// Result vector reference.
     ea::vector<Drawable*>& result_;
@@ -63,6 +98,8 @@ public:
     DrawableFlags drawableFlags_;
     /// Drawable layers to include.
     unsigned viewMask_;
+    /// Whether drawables queued for an octree update are tested by their current bounding box instead of the packed one. Set by Octree before the query.
+    bool testQueuedUpdates_{};
 };
 
 /// Point octree query.
@@ -81,6 +118,8 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Intersection test for drawables with packed bounds.
+    void TestPackedDrawables(Drawable** drawables, const PackedDrawableBounds& bounds, bool inside) override;
 
     /// Point.
     Vector3 point_;
@@ -102,6 +141,8 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Intersection test for drawables with packed bounds.
+    void TestPackedDrawables(Drawable** drawables, const PackedDrawableBounds& bounds, bool inside) override;
 
     /// Sphere.
     Sphere sphere_;
@@ -123,6 +164,8 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Intersection test for drawables with packed bounds.
+    void TestPackedDrawables(Drawable** drawables, const PackedDrawableBounds& bounds, bool inside) override;
 
     /// Bounding box.
     BoundingBox box_;
@@ -144,6 +187,8 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Intersection test for drawables with packed bounds.
+    void TestPackedDrawables(Drawable** drawables, const PackedDrawableBounds& bounds, bool inside) override;
 
     /// Frustum.
     Frustum frustum_;
@@ -259,6 +304,36 @@ private:
     ea::vector<RayQueryResult> resultStorage_;
 };
 
+/// Batched raycast octree query returning the closest hit of each ray. Reuse the query object to avoid allocating the result and ray vectors each time.
+class URHO3D_API RayOctreeBatchQuery : private NonCopyable
+{
+public:
+    /// Construct with query parameters shared by all rays.
+    explicit RayOctreeBatchQuery(RayQueryLevel level = RAY_TRIANGLE, float maxDistance = M_INFINITY,
+        DrawableFlags drawableFlags = DRAWABLE_ANY, unsigned viewMask = DEFAULT_VIEWMASK) :
+        drawableFlags_(drawableFlags),
+        viewMask_(viewMask),
+        maxDistance_(maxDistance),
+        level_(level)
+    {
+    }
+
+    /// Rays to test.
+    ea::vector<Ray> rays_;
+    /// Closest hit of each ray, in the same order as the rays. Drawable is null and distance infinite if the ray did not hit anything.
+    ea::vector<RayQueryResult> results_;
+    /// Drawable flags to include.
+    DrawableFlags drawableFlags_;
+    /// Drawable layers to include.
+    unsigned viewMask_;
+    /// Maximum ray distance.
+    float maxDistance_;
+    /// Raycast detail level.
+    RayQueryLevel level_;
+    /// Order in which the rays are processed. Kept between queries to avoid allocation.
+    ea::vector<unsigned> order_;
+};
+
 class URHO3D_API AllContentOctreeQuery : public OctreeQuery
 {
 public:
@@ -272,6 +347,8 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Intersection test for drawables with packed bounds.
+    void TestPackedDrawables(Drawable** drawables, const PackedDrawableBounds& bounds, bool inside) override;
 };
 
 }
@@ -32,6 +32,10 @@
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -43,6 +47,69 @@ static const unsigned MAX_PARTICLES_IN_FRAME = 100;
 
 extern const char* autoRemoveModeNames[];
 
+/// Add a value to each of the floats.
+static void AddToFloats(float* values, unsigned count, float add)
+{
+    unsigned i = 0;
+#ifdef URHO3D_SSE
+    const __m128 add4 = _mm_set1_ps(add);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(values + i, _mm_add_ps(_mm_loadu_ps(values + i), add4));
+#endif
+    for (; i < count; ++i)
+        values[i] += add;
+}
+
+/// Apply velocity = (velocity + add) * mul to each of the velocities.
+static void DampVelocities(Vector3* velocities, unsigned count, const Vector3& add, float mul)
+{
+    unsigned i = 0;
+#ifdef URHO3D_SSE
+    // Four velocities are twelve floats, so the add vector repeats with a period of three SSE registers
+    auto* values = reinterpret_cast<float*>(velocities);
+    const __m128 add0 = _mm_setr_ps(add.x_, add.y_, add.z_, add.x_);
+    const __m128 add1 = _mm_setr_ps(add.y_, add.z_, add.x_, add.y_);
+    const __m128 add2 = _mm_setr_ps(add.z_, add.x_, add.y_, add.z_);
+    const __m128 mul4 = _mm_set1_ps(mul);
+    for (; i + 4 <= count; i += 4)
+    {
+        float* block = values + i * 3;
+        _mm_storeu_ps(block, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(block), add0), mul4));
+        _mm_storeu_ps(block + 4, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(block + 4), add1), mul4));
+        _mm_storeu_ps(block + 8, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(block + 8), add2), mul4));
+    }
+#endif
+    for (; i < count; ++i)
+        velocities[i] = (velocities[i] + add) * mul;
+}
+
+/// Apply scale = max(scale + add, 0) * mul to each of the scales.
+static void UpdateScales(float* scales, unsigned count, float add, float mul)
+{
+    unsigned i = 0;
+#ifdef URHO3D_SSE
+    const __m128 add4 = _mm_set1_ps(add);
+    const __m128 mul4 = _mm_set1_ps(mul);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(scales + i, _mm_mul_ps(_mm_max_ps(_mm_add_ps(_mm_loadu_ps(scales + i), add4), zero), mul4));
+#endif
+    for (; i < count; ++i)
+        scales[i] = Max(scales[i] + add, 0.0f) * mul;
+}
+
+void ParticleData::Resize(unsigned num)
+{
+    velocities_.resize(num);
+    sizes_.resize(num);
+    timers_.resize(num);
+    timesToLive_.resize(num);
+    scales_.resize(num);
+    rotationSpeeds_.resize(num);
+    colorIndices_.resize(num);
+    texIndices_.resize(num);
+}
+
 ParticleEmitter::ParticleEmitter(Context* context) :
     BillboardSet(context),
     periodTimer_(0.0f),
@@ -108,8 +175,8 @@ void ParticleEmitter::Update(const FrameInfo& frame)
         return;
 
     // If there is an amount mismatch between particles and billboards, correct it
-    if (particles_.size() != billboards_.size())
-        SetNumBillboards(particles_.size());
+    if (particles_.Size() != billboards_.size())
+        SetNumBillboards(particles_.Size());
 
     bool needCommit = false;
 
@@ -165,93 +232,13 @@ void ParticleEmitter::Update(const FrameInfo& frame)
         }
     }
 
-    // Update existing particles
-    Vector3 relativeConstantForce = node_->GetWorldRotation().Inverse() * effect_->GetConstantForce();
-    // If billboards are not relative, apply scaling to the position update
-    Vector3 scaleVector = Vector3::ONE;
-    if (scaled_ && !relative_)
-        scaleVector = node_->GetWorldScale();
-
-    for (unsigned i = 0; i < particles_.size(); ++i)
+    // Update existing particles. Each pass streams over one or a few property arrays of the active particles only
+    if (UpdateParticleLifetimes(lastTimeStep_))
+        needCommit = true;
+    if (!activeRanges_.empty())
     {
-        Particle& particle = particles_[i];
-        Billboard& billboard = billboards_[i];
-
-        if (billboard.enabled_)
-        {
-            needCommit = true;
-
-            // Time to live
-            if (particle.timer_ >= particle.timeToLive_)
-            {
-                billboard.enabled_ = false;
-                continue;
-            }
-            particle.timer_ += lastTimeStep_;
-
-            // Velocity & position
-            const Vector3& constantForce = effect_->GetConstantForce();
-            if (constantForce != Vector3::ZERO)
-            {
-                if (relative_)
-                    particle.velocity_ += lastTimeStep_ * relativeConstantForce;
-                else
-                    particle.velocity_ += lastTimeStep_ * constantForce;
-            }
-
-            float dampingForce = effect_->GetDampingForce();
-            if (dampingForce != 0.0f)
-            {
-                Vector3 force = -dampingForce * particle.velocity_;
-                particle.velocity_ += lastTimeStep_ * force;
-            }
-            billboard.position_ += lastTimeStep_ * particle.velocity_ * scaleVector;
-            billboard.direction_ = particle.velocity_.Normalized();
-
-            // Rotation
-            billboard.rotation_ += lastTimeStep_ * particle.rotationSpeed_;
-
-            // Scaling
-            float sizeAdd = effect_->GetSizeAdd();
-            float sizeMul = effect_->GetSizeMul();
-            if (sizeAdd != 0.0f || sizeMul != 1.0f)
-            {
-                particle.scale_ += lastTimeStep_ * sizeAdd;
-                if (particle.scale_ < 0.0f)
-                    particle.scale_ = 0.0f;
-                if (sizeMul != 1.0f)
-                    particle.scale_ *= (lastTimeStep_ * (sizeMul - 1.0f)) + 1.0f;
-                billboard.size_ = particle.size_ * particle.scale_;
-            }
-
-            // Color interpolation
-            unsigned& index = particle.colorIndex_;
-            const ea::vector<ColorFrame>& colorFrames_ = effect_->GetColorFrames();
-            if (index < colorFrames_.size())
-            {
-                if (index < colorFrames_.size() - 1)
-                {
-                    if (particle.timer_ >= colorFrames_[index + 1].time_)
-                        ++index;
-                }
-                if (index < colorFrames_.size() - 1)
-                    billboard.color_ = colorFrames_[index].Interpolate(colorFrames_[index + 1], particle.timer_);
-                else
-                    billboard.color_ = colorFrames_[index].color_;
-            }
-
-            // Texture animation
-            unsigned& texIndex = particle.texIndex_;
-            const ea::vector<TextureFrame>& textureFrames_ = effect_->GetTextureFrames();
-            if (textureFrames_.size() && texIndex < textureFrames_.size() - 1)
-            {
-                if (particle.timer_ >= textureFrames_[texIndex + 1].time_)
-                {
-                    billboard.uv_ = textureFrames_[texIndex + 1].uv_;
-                    ++texIndex;
-                }
-            }
-        }
+        UpdateParticleMotion(lastTimeStep_);
+        UpdateParticleAppearance(lastTimeStep_);
     }
 
     if (needCommit)
@@ -286,7 +273,7 @@ void ParticleEmitter::SetNumParticles(unsigned num)
     if (num > M_MAX_INT)
         num = 0;
 
-    particles_.resize(num);
+    particles_.Resize(num);
     SetNumBillboards(num);
 }
 
@@ -371,16 +358,16 @@ void ParticleEmitter::SetParticlesAttr(const VariantVector& value)
     unsigned index = 0;
     SetNumParticles(index < value.size() ? value[index++].GetUInt() : 0);
 
-    for (auto i = particles_.begin(); i != particles_.end() && index < value.size(); ++i)
+    for (unsigned i = 0; i < particles_.Size() && index < value.size(); ++i)
     {
-        i->velocity_ = value[index++].GetVector3();
-        i->size_ = value[index++].GetVector2();
-        i->timer_ = value[index++].GetFloat();
-        i->timeToLive_ = value[index++].GetFloat();
-        i->scale_ = value[index++].GetFloat();
-        i->rotationSpeed_ = value[index++].GetFloat();
-        i->colorIndex_ = (unsigned)value[index++].GetInt();
-        i->texIndex_ = (unsigned)value[index++].GetInt();
+        particles_.velocities_[i] = value[index++].GetVector3();
+        particles_.sizes_[i] = value[index++].GetVector2();
+        particles_.timers_[i] = value[index++].GetFloat();
+        particles_.timesToLive_[i] = value[index++].GetFloat();
+        particles_.scales_[i] = value[index++].GetFloat();
+        particles_.rotationSpeeds_[i] = value[index++].GetFloat();
+        particles_.colorIndices_[i] = (unsigned)value[index++].GetInt();
+        particles_.texIndices_[i] = (unsigned)value[index++].GetInt();
     }
 }
 
@@ -389,22 +376,22 @@ VariantVector ParticleEmitter::GetParticlesAttr() const
     VariantVector ret;
     if (!serializeParticles_)
     {
-        ret.push_back((int)particles_.size());
+        ret.push_back((int)particles_.Size());
         return ret;
     }
 
-    ret.reserve(particles_.size() * 8 + 1);
-    ret.push_back((int)particles_.size());
-    for (auto i = particles_.begin(); i != particles_.end(); ++i)
+    ret.reserve(particles_.Size() * 8 + 1);
+    ret.push_back((int)particles_.Size());
+    for (unsigned i = 0; i < particles_.Size(); ++i)
     {
-        ret.push_back(i->velocity_);
-        ret.push_back(i->size_);
-        ret.push_back(i->timer_);
-        ret.push_back(i->timeToLive_);
-        ret.push_back(i->scale_);
-        ret.push_back(i->rotationSpeed_);
-        ret.push_back(i->colorIndex_);
-        ret.push_back(i->texIndex_);
+        ret.push_back(particles_.velocities_[i]);
+        ret.push_back(particles_.sizes_[i]);
+        ret.push_back(particles_.timers_[i]);
+        ret.push_back(particles_.timesToLive_[i]);
+        ret.push_back(particles_.scales_[i]);
+        ret.push_back(particles_.rotationSpeeds_[i]);
+        ret.push_back(particles_.colorIndices_[i]);
+        ret.push_back(particles_.texIndices_[i]);
     }
     return ret;
 }
@@ -450,8 +437,7 @@ bool ParticleEmitter::EmitNewParticle()
     unsigned index = GetFreeParticle();
     if (index == M_MAX_UNSIGNED)
         return false;
-    assert(index < particles_.size());
-    Particle& particle = particles_[index];
+    assert(index < particles_.Size());
     Billboard& billboard = billboards_[index];
 
     Vector3 startDir;
@@ -513,17 +499,18 @@ bool ParticleEmitter::EmitNewParticle()
         break;
     }
 
-    particle.size_ = effect_->GetRandomSize();
-    particle.timer_ = 0.0f;
-    particle.timeToLive_ = effect_->GetRandomTimeToLive();
-    particle.scale_ = 1.0f;
-    particle.rotationSpeed_ = effect_->GetRandomRotationSpeed();
-    particle.colorIndex_ = 0;
-    particle.texIndex_ = 0;
+    const Vector2 size = effect_->GetRandomSize();
+    particles_.sizes_[index] = size;
+    particles_.timers_[index] = 0.0f;
+    particles_.timesToLive_[index] = effect_->GetRandomTimeToLive();
+    particles_.scales_[index] = 1.0f;
+    particles_.rotationSpeeds_[index] = effect_->GetRandomRotationSpeed();
+    particles_.colorIndices_[index] = 0;
+    particles_.texIndices_[index] = 0;
 
     if (faceCameraMode_ == FC_DIRECTION)
     {
-        startPos += startDir * particle.size_.y_;
+        startPos += startDir * size.y_;
     }
 
     if (!relative_)
@@ -532,10 +519,10 @@ bool ParticleEmitter::EmitNewParticle()
         startDir = node_->GetWorldRotation() * startDir;
     };
 
-    particle.velocity_ = effect_->GetRandomVelocity() * startDir;
+    particles_.velocities_[index] = effect_->GetRandomVelocity() * startDir;
 
     billboard.position_ = startPos;
-    billboard.size_ = particles_[index].size_;
+    billboard.size_ = size;
     const ea::vector<TextureFrame>& textureFrames_ = effect_->GetTextureFrames();
     billboard.uv_ = textureFrames_.size() ? textureFrames_[0].uv_ : Rect::POSITIVE;
     billboard.rotation_ = effect_->GetRandomRotation();
@@ -572,6 +559,150 @@ bool ParticleEmitter::CheckActiveParticles() const
     return false;
 }
 
+bool ParticleEmitter::UpdateParticleLifetimes(float timeStep)
+{
+    bool anyEnabled = false;
+    const unsigned numParticles = particles_.Size();
+    float* timers = particles_.timers_.data();
+    const float* timesToLive = particles_.timesToLive_.data();
+
+    // Free particles are reused from the lowest index, so the active ones mostly form a few long runs
+    activeRanges_.clear();
+    unsigned rangeStart = M_MAX_UNSIGNED;
+    for (unsigned i = 0; i < numParticles; ++i)
+    {
+        Billboard& billboard = billboards_[i];
+        if (billboard.enabled_)
+        {
+            anyEnabled = true;
+            if (timers[i] >= timesToLive[i])
+                billboard.enabled_ = false;
+        }
+
+        if (billboard.enabled_)
+        {
+            if (rangeStart == M_MAX_UNSIGNED)
+                rangeStart = i;
+        }
+        else if (rangeStart != M_MAX_UNSIGNED)
+        {
+            activeRanges_.emplace_back(rangeStart, i);
+            rangeStart = M_MAX_UNSIGNED;
+        }
+    }
+    if (rangeStart != M_MAX_UNSIGNED)
+        activeRanges_.emplace_back(rangeStart, numParticles);
+
+    for (const auto& range : activeRanges_)
+        AddToFloats(timers + range.first, range.second - range.first, timeStep);
+
+    return anyEnabled;
+}
+
+void ParticleEmitter::UpdateParticleMotion(float timeStep)
+{
+    Vector3* velocities = particles_.velocities_.data();
+    const float* rotationSpeeds = particles_.rotationSpeeds_.data();
+
+    // Constant force and damping are the same for every particle, so fold them into a single multiply-add
+    const Vector3& constantForce = effect_->GetConstantForce();
+    const Vector3 velocityAdd = timeStep * (relative_ ? node_->GetWorldRotation().Inverse() * constantForce : constantForce);
+    const float velocityMul = 1.0f - timeStep * effect_->GetDampingForce();
+
+    if (velocityAdd != Vector3::ZERO || velocityMul != 1.0f)
+    {
+        for (const auto& range : activeRanges_)
+            DampVelocities(velocities + range.first, range.second - range.first, velocityAdd, velocityMul);
+    }
+
+    // If billboards are not relative, apply scaling to the position update
+    Vector3 positionScale = Vector3(timeStep, timeStep, timeStep);
+    if (scaled_ && !relative_)
+        positionScale *= node_->GetWorldScale();
+
+    // Billboards are stored as structures, so the integration stays scalar
+    for (const auto& range : activeRanges_)
+    {
+        for (unsigned index = range.first; index < range.second; ++index)
+        {
+            const Vector3& velocity = velocities[index];
+            Billboard& billboard = billboards_[index];
+
+            billboard.position_ += velocity * positionScale;
+            billboard.direction_ = velocity.Normalized();
+            billboard.rotation_ += timeStep * rotationSpeeds[index];
+        }
+    }
+}
+
+void ParticleEmitter::UpdateParticleAppearance(float timeStep)
+{
+    const float* timers = particles_.timers_.data();
+
+    // Scaling
+    const float sizeAdd = effect_->GetSizeAdd();
+    const float sizeMul = effect_->GetSizeMul();
+    if (sizeAdd != 0.0f || sizeMul != 1.0f)
+    {
+        const float scaleAdd = timeStep * sizeAdd;
+        const float scaleMul = sizeMul != 1.0f ? (timeStep * (sizeMul - 1.0f)) + 1.0f : 1.0f;
+        float* scales = particles_.scales_.data();
+        const Vector2* sizes = particles_.sizes_.data();
+
+        for (const auto& range : activeRanges_)
+        {
+            UpdateScales(scales + range.first, range.second - range.first, scaleAdd, scaleMul);
+            for (unsigned index = range.first; index < range.second; ++index)
+                billboards_[index].size_ = sizes[index] * scales[index];
+        }
+    }
+
+    // Color interpolation
+    const ea::vector<ColorFrame>& colorFrames = effect_->GetColorFrames();
+    const auto numColorFrames = static_cast<unsigned>(colorFrames.size());
+    if (numColorFrames)
+    {
+        unsigned* colorIndices = particles_.colorIndices_.data();
+        for (const auto& range : activeRanges_)
+        {
+            for (unsigned index = range.first; index < range.second; ++index)
+            {
+                unsigned& frame = colorIndices[index];
+                if (frame >= numColorFrames)
+                    continue;
+
+                const float timer = timers[index];
+                if (frame < numColorFrames - 1 && timer >= colorFrames[frame + 1].time_)
+                    ++frame;
+                if (frame < numColorFrames - 1)
+                    billboards_[index].color_ = colorFrames[frame].Interpolate(colorFrames[frame + 1], timer);
+                else
+                    billboards_[index].color_ = colorFrames[frame].color_;
+            }
+        }
+    }
+
+    // Texture animation
+    const ea::vector<TextureFrame>& textureFrames = effect_->GetTextureFrames();
+    const auto numTextureFrames = static_cast<unsigned>(textureFrames.size());
+    if (numTextureFrames > 1)
+    {
+        unsigned* texIndices = particles_.texIndices_.data();
+        for (const auto& range : activeRanges_)
+        {
+            for (unsigned index = range.first; index < range.second; ++index)
+            {
+                unsigned& frame = texIndices[index];
+                if (frame < numTextureFrames - 1 && timers[index] >= textureFrames[frame + 1].time_)
+                {
+                    billboards_[index].uv_ = textureFrames[frame + 1].uv_;
+                    ++frame;
+                }
+            }
+        }
+    }
+}
+
 void ParticleEmitter::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
 {
     // Store scene's timestep and use it instead of global timestep, as time scale may be other than 1
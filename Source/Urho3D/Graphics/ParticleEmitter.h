@@ -29,25 +29,30 @@ namespace Urho3D
 
 class ParticleEffect;
 
-/// One particle in the particle system.
-struct Particle
+/// Simulation state of the particles in a particle system. Each property is stored in its own array, indexed like the billboards.
+struct URHO3D_API ParticleData
 {
-    /// Velocity.
-    Vector3 velocity_;
-    /// Original billboard size.
-    Vector2 size_;
-    /// Time elapsed from creation.
-    float timer_;
-    /// Lifetime.
-    float timeToLive_;
-    /// Size scaling value.
-    float scale_;
-    /// Rotation speed.
-    float rotationSpeed_;
-    /// Current color animation index.
-    unsigned colorIndex_;
-    /// Current texture animation index.
-    unsigned texIndex_;
+    /// Resize all property arrays.
+    void Resize(unsigned num);
+    /// Return number of particles.
+    unsigned Size() const { return timers_.size(); }
+
+    /// Velocities.
+    ea::vector<Vector3> velocities_;
+    /// Original billboard sizes.
+    ea::vector<Vector2> sizes_;
+    /// Times elapsed from creation.
+    ea::vector<float> timers_;
+    /// Lifetimes.
+    ea::vector<float> timesToLive_;
+    /// Size scaling values.
+    ea::vector<float> scales_;
+    /// Rotation speeds.
+    ea::vector<float> rotationSpeeds_;
+    /// Current color animation indices.
+    ea::vector<unsigned> colorIndices_;
+    /// Current texture animation indices.
+    ea::vector<unsigned> texIndices_;
 };
 
 /// %Particle emitter component.
@@ -91,7 +96,7 @@ public:
     ParticleEffect* GetEffect() const;
 
     /// Return maximum number of particles.
-    unsigned GetNumParticles() const { return particles_.size(); }
+    unsigned GetNumParticles() const { return particles_.Size(); }
 
     /// Return whether is currently emitting.
     bool IsEmitting() const { return emitting_; }
@@ -123,6 +128,12 @@ protected:
     unsigned GetFreeParticle() const;
     /// Return whether has active particles.
     bool CheckActiveParticles() const;
+    /// Advance the particle timers, disable expired particles and collect the ranges of the remaining active ones. Return true if any particle was enabled.
+    bool UpdateParticleLifetimes(float timeStep);
+    /// Integrate the velocities, positions and rotations of the active particles.
+    void UpdateParticleMotion(float timeStep);
+    /// Update the sizes, colors and texture frames of the active particles.
+    void UpdateParticleAppearance(float timeStep);
 
 private:
     /// Handle scene post-update event.
@@ -133,7 +144,9 @@ private:
     /// Particle effect.
     SharedPtr<ParticleEffect> effect_;
     /// Particles.
-    ea::vector<Particle> particles_;
+    ParticleData particles_;
+    /// Contiguous index ranges [first, second) of the particles active during the current update.
+    ea::vector<ea::pair<unsigned, unsigned> > activeRanges_;
     /// Active/inactive period timer.
     float periodTimer_;
     /// New particle emission timer.
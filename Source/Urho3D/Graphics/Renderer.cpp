@@ -41,6 +41,7 @@
 #include "../Graphics/Technique.h"
 #include "../Graphics/Texture2D.h"
 #include "../Graphics/TextureCube.h"
+#include "../Graphics/TextureStreaming.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/View.h"
 #include "../Graphics/Zone.h"
@@ -270,7 +271,8 @@ inline ea::vector<VertexElement> CreateInstancingBufferElements(unsigned numExtr
 
 Renderer::Renderer(Context* context) :
     Object(context),
-    defaultZone_(context->CreateObject<Zone>())
+    defaultZone_(context->CreateObject<Zone>()),
+    textureStreaming_(MakeShared<TextureStreaming>(context))
 {
     SubscribeToEvent(E_SCREENMODE, URHO3D_HANDLER(Renderer, HandleScreenMode));
 
@@ -556,6 +558,15 @@ void Renderer::SetThreadedOcclusion(bool enable)
     }
 }
 
+void Renderer::SetOcclusionRasterizer(OcclusionRasterizer rasterizer)
+{
+    if (rasterizer != occlusionRasterizer_)
+    {
+        occlusionRasterizer_ = rasterizer;
+        occlusionBuffers_.clear();
+    }
+}
+
 void Renderer::ReloadShaders()
 {
     shadersDirty_ = true;
@@ -720,6 +731,9 @@ void Renderer::Update(float timeStep)
 
     queuedViewports_.clear();
     resetViews_ = false;
+
+    // Stream texture mip levels for the on-screen sizes gathered by the views
+    textureStreaming_->Update(frame_.frameNumber_);
 }
 
 void Renderer::Render()
@@ -1149,6 +1163,7 @@ OcclusionBuffer* Renderer::GetOcclusionBuffer(Camera* camera)
     auto height = RoundToInt(occlusionBufferSize_ / camera->GetAspectRatio());
 
     OcclusionBuffer* buffer = occlusionBuffers_[numOcclusionBuffers_++];
+    buffer->SetRasterizer(occlusionRasterizer_);
     buffer->SetSize(width, height, threadedOcclusion_);
     buffer->SetView(camera);
     buffer->ResetUseTimer();
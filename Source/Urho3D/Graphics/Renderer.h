@@ -54,6 +54,7 @@ class Technique;
 class Texture;
 class Texture2D;
 class TextureCube;
+class TextureStreaming;
 class View;
 class Zone;
 struct BatchQueue;
@@ -244,6 +245,8 @@ public:
     void SetOccluderSizeThreshold(float screenSize);
     /// Set whether to thread occluder rendering. Default false.
     void SetThreadedOcclusion(bool enable);
+    /// Set occlusion buffer rasterization backend. Default scanline.
+    void SetOcclusionRasterizer(OcclusionRasterizer rasterizer);
     /// Set shadow depth bias multiplier for mobile platforms to counteract possible worse shadow map precision. Default 1.0 (no effect.)
     void SetMobileShadowBiasMul(float mul);
     /// Set shadow depth bias addition for mobile platforms to counteract possible worse shadow map precision. Default 0.0 (no effect.)
@@ -334,6 +337,9 @@ public:
     /// Return whether occlusion rendering is threaded.
     bool GetThreadedOcclusion() const { return threadedOcclusion_; }
 
+    /// Return occlusion buffer rasterization backend.
+    OcclusionRasterizer GetOcclusionRasterizer() const { return occlusionRasterizer_; }
+
     /// Return shadow depth bias multiplier for mobile platforms.
     float GetMobileShadowBiasMul() const { return mobileShadowBiasMul_; }
 
@@ -364,6 +370,9 @@ public:
     /// Return the default zone.
     Zone* GetDefaultZone() const { return defaultZone_; }
 
+    /// Return texture mip streaming.
+    TextureStreaming* GetTextureStreaming() const { return textureStreaming_; }
+
     /// Return the default material.
     Material* GetDefaultMaterial() const { return defaultMaterial_; }
 
@@ -482,6 +491,8 @@ private:
     SharedPtr<Technique> defaultTechnique_;
     /// Default zone.
     SharedPtr<Zone> defaultZone_;
+    /// Texture mip streaming.
+    SharedPtr<TextureStreaming> textureStreaming_;
     /// Directional light quad geometry.
     SharedPtr<Geometry> dirLightGeometry_;
     /// Spot light volume geometry.
@@ -572,6 +583,8 @@ private:
     int occlusionBufferSize_{256};
     /// Occluder screen size threshold.
     float occluderSizeThreshold_{0.025f};
+    /// Occlusion buffer rasterization backend.
+    OcclusionRasterizer occlusionRasterizer_{OCCLUSION_RASTERIZER_SCANLINE};
     /// Mobile platform shadow depth bias multiplier.
     float mobileShadowBiasMul_{1.0f};
     /// Mobile platform shadow depth bias addition.
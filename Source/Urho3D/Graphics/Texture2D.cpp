@@ -29,6 +29,7 @@
 #include "../Graphics/GraphicsImpl.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Texture2D.h"
+#include "../Graphics/TextureStreaming.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
@@ -71,11 +72,18 @@ bool Texture2D::BeginLoad(Deserializer& source)
         return true;
     }
 
-    // Load the image data for EndLoad()
+    // Load the optional parameters file first, as it decides whether the mip levels are streamed
+    auto* cache = GetSubsystem<ResourceCache>();
+    ea::string xmlName = ReplaceExtension(GetName(), ".xml");
+    loadParameters_ = cache->GetTempResource<XMLFile>(xmlName, false);
+
+    // Load the image data for EndLoad(). When streaming, only the smallest mip levels are read if the format allows
     loadImage_ = context_->CreateObject<Image>();
+    loadImage_->SetLoadMaxSize(GetStreamingLoadSize(loadParameters_));
     if (!loadImage_->Load(source))
     {
         loadImage_.Reset();
+        loadParameters_.Reset();
         return false;
     }
 
@@ -83,11 +91,6 @@ bool Texture2D::BeginLoad(Deserializer& source)
     if (GetAsyncLoadState() == ASYNC_LOADING)
         loadImage_->PrecalculateLevels();
 
-    // Load the optional parameters file
-    auto* cache = GetSubsystem<ResourceCache>();
-    ea::string xmlName = ReplaceExtension(GetName(), ".xml");
-    loadParameters_ = cache->GetTempResource<XMLFile>(xmlName, false);
-
     return true;
 }
 
@@ -101,6 +104,20 @@ bool Texture2D::EndLoad()
     CheckTextureBudget(GetTypeStatic());
 
     SetParameters(loadParameters_);
+
+    // Stream the mip levels if enabled, starting from the smallest ones. Textures without mipmaps are loaded as is.
+    // An image that was read without its largest mip levels is always streamed, so that they can be loaded later
+    auto* renderer = GetSubsystem<Renderer>();
+    TextureStreaming* textureStreaming = renderer ? renderer->GetTextureStreaming() : nullptr;
+    if (textureStreaming && ((textureStreaming->IsEnabled() && streaming_ && usage_ == TEXTURE_STATIC && requestedLevels_ != 1) ||
+        loadImage_->GetNumSkippedLevels()))
+        textureStreaming->AddTexture(this, loadImage_);
+    else
+    {
+        streamingMipsToSkip_ = 0;
+        streamed_ = false;
+    }
+
     bool success = SetData(loadImage_);
 
     loadImage_.Reset();
@@ -160,6 +177,49 @@ bool Texture2D::SetSize(int width, int height, unsigned format, TextureUsage usa
     return Create();
 }
 
+bool Texture2D::SetStreamingData(Image* image, unsigned mipsToSkip)
+{
+    const unsigned oldMipsToSkip = streamingMipsToSkip_;
+    streamingMipsToSkip_ = mipsToSkip;
+    if (SetData(image))
+        return true;
+
+    streamingMipsToSkip_ = oldMipsToSkip;
+    return false;
+}
+
+unsigned Texture2D::GetImageMipsToSkip(MaterialQuality quality, const Image* image) const
+{
+    const unsigned qualityMipsToSkip = quality < MAX_TEXTURE_QUALITY_LEVELS ? mipsToSkip_[quality] : 0;
+    const unsigned mipsToSkip = Max(qualityMipsToSkip, streamingMipsToSkip_);
+    const unsigned skippedLevels = image->GetNumSkippedLevels();
+    return mipsToSkip > skippedLevels ? mipsToSkip - skippedLevels : 0;
+}
+
+int Texture2D::GetStreamingLoadSize(XMLFile* parameters)
+{
+    bool mipmaps = requestedLevels_ != 1;
+    if (parameters)
+    {
+        XMLElement root = parameters->GetRoot();
+        XMLElement streamingElem = root.GetChild("streaming");
+        if (streamingElem)
+            streaming_ = streamingElem.GetBool("enable");
+        XMLElement mipmapElem = root.GetChild("mipmap");
+        if (mipmapElem)
+            mipmaps = mipmapElem.GetBool("enable");
+    }
+
+    auto* renderer = GetSubsystem<Renderer>();
+    TextureStreaming* textureStreaming = renderer ? renderer->GetTextureStreaming() : nullptr;
+    if (!textureStreaming || !textureStreaming->IsEnabled() || !streaming_ || usage_ != TEXTURE_STATIC || !mipmaps)
+        return 0;
+
+    // A reloaded texture keeps its resident mip levels
+    const int initialSize = textureStreaming->GetInitialSize();
+    return streamed_ ? Max(initialSize, Max(width_, height_)) : initialSize;
+}
+
 bool Texture2D::GetImage(Image& image) const
 {
     if (format_ != Graphics::GetRGBAFormat() && format_ != Graphics::GetRGBFormat())
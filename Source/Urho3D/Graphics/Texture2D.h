@@ -30,12 +30,14 @@ namespace Urho3D
 {
 
 class Image;
+class TextureStreaming;
 class XMLFile;
 
 /// 2D texture resource.
 class URHO3D_API Texture2D : public Texture
 {
     URHO3D_OBJECT(Texture2D, Texture);
+    friend class TextureStreaming;
 
 public:
     /// Construct.
@@ -73,8 +75,19 @@ public:
     /// Get image data from zero mip level. Only RGB and RGBA textures are supported.
     SharedPtr<Image> GetImage() const;
 
+    /// Set whether mip levels may be streamed when texture streaming is enabled in Renderer. Takes effect on next load. Default true.
+    void SetStreaming(bool enable) { streaming_ = enable; }
+    /// Set image data with the given number of mip levels skipped for streaming. Return true if successful.
+    bool SetStreamingData(Image* image, unsigned mipsToSkip);
+
     /// Return render surface.
     RenderSurface* GetRenderSurface() const { return renderSurface_; }
+    /// Return whether mip levels may be streamed.
+    bool GetStreaming() const { return streaming_; }
+    /// Return whether mip levels are currently streamed.
+    bool IsStreamed() const { return streamed_; }
+    /// Return number of mip levels currently skipped for streaming.
+    unsigned GetStreamingMipsToSkip() const { return streamingMipsToSkip_; }
 
 protected:
     /// Create the GPU texture.
@@ -83,6 +96,10 @@ protected:
 private:
     /// Handle render surface update event.
     void HandleRenderSurfaceUpdate(StringHash eventType, VariantMap& eventData);
+    /// Return number of mip levels to skip when setting data from an image, for both texture quality and streaming. Mip levels the image skipped on load are not counted again.
+    unsigned GetImageMipsToSkip(MaterialQuality quality, const Image* image) const;
+    /// Return largest dimension of the first mip level to read when loading, or zero to read all levels.
+    int GetStreamingLoadSize(XMLFile* parameters);
 
     /// Render surface.
     SharedPtr<RenderSurface> renderSurface_;
@@ -90,6 +107,14 @@ private:
     SharedPtr<Image> loadImage_;
     /// Parameter file acquired during BeginLoad.
     SharedPtr<XMLFile> loadParameters_;
+    /// Mip levels skipped for streaming.
+    unsigned streamingMipsToSkip_{};
+    /// Largest on-screen size in pixels requested since the last streaming update.
+    float streamingScreenSize_{};
+    /// Streaming allowed flag.
+    bool streaming_{true};
+    /// Streamed flag.
+    bool streamed_{};
 };
 
 }
@@ -0,0 +1,335 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Renderer.h"
+#include "../Graphics/Texture2D.h"
+#include "../Graphics/TextureStreaming.h"
+#include "../IO/File.h"
+#include "../IO/Log.h"
+#include "../Resource/Image.h"
+#include "../Resource/ResourceCache.h"
+
+#include <EASTL/sort.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Estimate memory use of a texture after changing the number of skipped mip levels. Each mip level has a quarter of the texels of the previous one.
+static unsigned long long EstimateMemoryUse(unsigned long long memoryUse, unsigned mipsToSkip, unsigned newMipsToSkip)
+{
+    if (newMipsToSkip < mipsToSkip)
+        return memoryUse << (2 * (mipsToSkip - newMipsToSkip));
+    else
+        return memoryUse >> (2 * (newMipsToSkip - mipsToSkip));
+}
+
+TextureStreaming::TextureStreaming(Context* context) :
+    Object(context)
+{
+}
+
+TextureStreaming::~TextureStreaming() = default;
+
+void TextureStreaming::SetEnabled(bool enable)
+{
+    enabled_ = enable;
+}
+
+void TextureStreaming::SetInitialSize(int size)
+{
+    initialSize_ = Max(size, 1);
+}
+
+void TextureStreaming::SetEvictionFrames(unsigned frames)
+{
+    evictionFrames_ = frames;
+}
+
+void TextureStreaming::SetMaxPendingLoads(unsigned count)
+{
+    maxPendingLoads_ = Max(count, 1U);
+}
+
+void TextureStreaming::SetMipBias(float bias)
+{
+    mipBias_ = bias;
+}
+
+void TextureStreaming::AddTexture(Texture2D* texture, Image* image)
+{
+    // The image may have been read without its largest mip levels
+    const unsigned skippedLevels = image->GetNumSkippedLevels();
+    const int size = Max(image->GetWidth(), image->GetHeight()) << skippedLevels;
+    const unsigned levels = (image->IsCompressed() ? image->GetNumCompressedLevels() :
+        Texture::CheckMaxLevels(image->GetWidth(), image->GetHeight(), 0)) + skippedLevels;
+
+    unsigned tailMipsToSkip = 0;
+    while (tailMipsToSkip + 1 < levels && (size >> tailMipsToSkip) > initialSize_)
+        ++tailMipsToSkip;
+
+    StreamedTexture& entry = textures_[texture];
+    if (entry.texture_ != texture)
+    {
+        // New texture, or the texture was reloaded after streaming had been disabled: start from the tail mip levels
+        entry = StreamedTexture();
+        entry.texture_ = texture;
+        texture->streamingMipsToSkip_ = Max(tailMipsToSkip, skippedLevels);
+    }
+    else
+    {
+        // Reloaded texture keeps its resident mip levels
+        texture->streamingMipsToSkip_ = Max(Min(texture->streamingMipsToSkip_, tailMipsToSkip), skippedLevels);
+        entry.failed_ = false;
+    }
+
+    entry.size_ = size;
+    entry.levels_ = levels;
+    entry.tailMipsToSkip_ = tailMipsToSkip;
+    texture->streamed_ = true;
+}
+
+void TextureStreaming::RequestMaterialTextures(Material* material, float screenSize)
+{
+    for (const auto& item : material->GetTextures())
+    {
+        Texture* texture = item.second;
+        if (texture && texture->GetType() == Texture2D::GetTypeStatic())
+        {
+            auto* texture2D = static_cast<Texture2D*>(texture);
+            if (texture2D->streamed_)
+                texture2D->streamingScreenSize_ = Max(texture2D->streamingScreenSize_, screenSize);
+        }
+    }
+}
+
+void TextureStreaming::Update(unsigned frameNumber)
+{
+    stats_ = TextureStreamingStats();
+    if (textures_.empty())
+        return;
+
+    URHO3D_PROFILE("UpdateTextureStreaming");
+
+    auto* renderer = GetSubsystem<Renderer>();
+    auto* cache = GetSubsystem<ResourceCache>();
+    const MaterialQuality quality = renderer ? renderer->GetTextureQuality() : QUALITY_HIGH;
+
+    unsigned numPendingLoads = 0;
+    for (auto i = textures_.begin(); i != textures_.end();)
+    {
+        StreamedTexture& entry = i->second;
+        if (entry.pendingLoad_ && entry.pendingLoad_->done_)
+            FinishLoad(entry);
+
+        Texture2D* texture = entry.texture_;
+        // Remove destroyed textures and textures that were reloaded without streaming, once their loads have finished
+        if (entry.pendingLoad_)
+            ++numPendingLoads;
+        else if (!texture || !texture->streamed_ || (!enabled_ && !texture->streamingMipsToSkip_))
+        {
+            if (texture)
+            {
+                texture->streamed_ = false;
+                texture->streamingScreenSize_ = 0.0f;
+            }
+            i = textures_.erase(i);
+            continue;
+        }
+        ++i;
+    }
+
+    // Choose the mip levels to skip from the on-screen size reported since the last update
+    unsigned long long totalMemoryUse = cache->GetMemoryUse(Texture2D::GetTypeStatic());
+    const unsigned long long budget = cache->GetMemoryBudget(Texture2D::GetTypeStatic());
+    for (auto& item : textures_)
+    {
+        StreamedTexture& entry = item.second;
+        Texture2D* texture = entry.texture_;
+        if (!texture)
+            continue;
+
+        if (texture->streamingScreenSize_ > 0.0f)
+        {
+            entry.screenSize_ = texture->streamingScreenSize_;
+            entry.lastSeenFrame_ = frameNumber;
+            entry.seen_ = true;
+            texture->streamingScreenSize_ = 0.0f;
+        }
+
+        const unsigned residentMipsToSkip = texture->streamingMipsToSkip_;
+        const bool recentlySeen = entry.seen_ && frameNumber - entry.lastSeenFrame_ <= evictionFrames_;
+        if (recentlySeen)
+        {
+            const float texelsPerPixel = (float)entry.size_ / Max(entry.screenSize_, 1.0f);
+            const int level = FloorToInt(log2f(texelsPerPixel) + mipBias_);
+            entry.requestedMipsToSkip_ = (unsigned)Clamp(level, 0, (int)entry.tailMipsToSkip_);
+        }
+        else
+            entry.requestedMipsToSkip_ = entry.tailMipsToSkip_;
+
+        if (!enabled_)
+            entry.targetMipsToSkip_ = 0;
+        else if (entry.failed_)
+            entry.targetMipsToSkip_ = residentMipsToSkip;
+        else if (recentlySeen)
+        {
+            // Do not drop resident mip levels while the texture stays visible, to avoid reloading on small changes of distance
+            entry.targetMipsToSkip_ = Min(entry.requestedMipsToSkip_, residentMipsToSkip);
+        }
+        else
+            entry.targetMipsToSkip_ = entry.tailMipsToSkip_;
+
+        // Mip levels skipped by texture quality are never loaded
+        const unsigned qualityMipsToSkip = (unsigned)texture->GetMipsToSkip(quality);
+        const unsigned effectiveMipsToSkip = Max(residentMipsToSkip, qualityMipsToSkip);
+        entry.targetMipsToSkip_ = Max(entry.targetMipsToSkip_, qualityMipsToSkip);
+        entry.requestedMipsToSkip_ = Max(entry.requestedMipsToSkip_, qualityMipsToSkip);
+
+        const unsigned long long memoryUse = texture->GetMemoryUse();
+        totalMemoryUse += EstimateMemoryUse(memoryUse, effectiveMipsToSkip, entry.targetMipsToSkip_) - memoryUse;
+
+        ++stats_.numTextures_;
+        stats_.residentLevels_ += entry.levels_ - Min(effectiveMipsToSkip, entry.levels_);
+        stats_.requestedLevels_ += entry.levels_ - Min(entry.requestedMipsToSkip_, entry.levels_);
+        stats_.residentMemory_ += memoryUse;
+        stats_.requestedMemory_ += EstimateMemoryUse(memoryUse, effectiveMipsToSkip, entry.requestedMipsToSkip_);
+    }
+
+    ea::vector<StreamedTexture*> candidates;
+    candidates.reserve(textures_.size());
+    for (auto& item : textures_)
+    {
+        if (item.second.texture_)
+            candidates.push_back(&item.second);
+    }
+
+    // If over the memory budget, lower the resolution of the least recently seen and smallest textures first
+    if (enabled_ && budget && totalMemoryUse > budget)
+    {
+        ea::sort(candidates.begin(), candidates.end(), [](const StreamedTexture* lhs, const StreamedTexture* rhs)
+        {
+            if (lhs->lastSeenFrame_ != rhs->lastSeenFrame_)
+                return lhs->lastSeenFrame_ < rhs->lastSeenFrame_;
+            return lhs->screenSize_ < rhs->screenSize_;
+        });
+
+        for (StreamedTexture* entry : candidates)
+        {
+            const unsigned long long memoryUse = entry->texture_->GetMemoryUse();
+            const unsigned mipsToSkip = Max(entry->texture_->streamingMipsToSkip_,
+                (unsigned)entry->texture_->GetMipsToSkip(quality));
+            while (totalMemoryUse > budget && entry->targetMipsToSkip_ < entry->tailMipsToSkip_)
+            {
+                totalMemoryUse -= EstimateMemoryUse(memoryUse, mipsToSkip, entry->targetMipsToSkip_) -
+                    EstimateMemoryUse(memoryUse, mipsToSkip, entry->targetMipsToSkip_ + 1);
+                ++entry->targetMipsToSkip_;
+            }
+            if (totalMemoryUse <= budget)
+                break;
+        }
+    }
+
+    // Start loads of textures whose resolution changes. Evictions go first to free memory, then the largest textures on screen
+    candidates.erase(ea::remove_if(candidates.begin(), candidates.end(), [quality](const StreamedTexture* entry)
+    {
+        const unsigned mipsToSkip = Max(entry->texture_->streamingMipsToSkip_, (unsigned)entry->texture_->GetMipsToSkip(quality));
+        return entry->pendingLoad_ || entry->failed_ || entry->targetMipsToSkip_ == mipsToSkip;
+    }), candidates.end());
+
+    ea::sort(candidates.begin(), candidates.end(), [](const StreamedTexture* lhs, const StreamedTexture* rhs)
+    {
+        const bool lhsEvict = lhs->targetMipsToSkip_ > lhs->texture_->streamingMipsToSkip_;
+        const bool rhsEvict = rhs->targetMipsToSkip_ > rhs->texture_->streamingMipsToSkip_;
+        if (lhsEvict != rhsEvict)
+            return lhsEvict;
+        return lhs->screenSize_ > rhs->screenSize_;
+    });
+
+    for (StreamedTexture* entry : candidates)
+    {
+        if (numPendingLoads >= maxPendingLoads_)
+            break;
+        StartLoad(*entry, entry->targetMipsToSkip_);
+        ++numPendingLoads;
+    }
+
+    stats_.numPendingLoads_ = numPendingLoads;
+}
+
+void TextureStreaming::FinishLoad(StreamedTexture& entry)
+{
+    SharedPtr<StreamingLoad> load = entry.pendingLoad_;
+    entry.pendingLoad_.Reset();
+
+    Texture2D* texture = entry.texture_;
+    if (!texture || !texture->streamed_)
+        return;
+
+    if (!load->image_ || !texture->SetStreamingData(load->image_, load->mipsToSkip_))
+    {
+        URHO3D_LOGWARNING("Failed to stream mip levels of texture " + load->name_);
+        entry.failed_ = true;
+    }
+}
+
+void TextureStreaming::StartLoad(StreamedTexture& entry, unsigned mipsToSkip)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    WorkQueue* workQueue = context_->GetWorkQueue();
+
+    SharedPtr<StreamingLoad> load(new StreamingLoad());
+    load->name_ = entry.texture_->GetName();
+    load->mipsToSkip_ = mipsToSkip;
+    load->maxSize_ = Max(entry.size_ >> mipsToSkip, 1);
+    entry.pendingLoad_ = load;
+
+    // The work item keeps the load alive. It is only copied and destroyed on the main thread
+    Context* context = context_;
+    workQueue->AddWorkItem([load, cache, context]()
+    {
+        SharedPtr<File> file = cache->GetFile(load->name_, false);
+        if (file)
+        {
+            // Read only the mip levels that are uploaded, if the image format allows
+            SharedPtr<Image> image(new Image(context));
+            image->SetLoadMaxSize(load->maxSize_);
+            if (image->Load(*file))
+            {
+                // Generate the mip levels here so that the main thread only uploads them
+                if (!image->IsCompressed())
+                    image->PrecalculateLevels();
+                load->image_ = image;
+            }
+        }
+        load->done_ = true;
+    });
+}
+
+}
@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Object.h"
+
+#include <EASTL/unordered_map.h>
+
+#include <atomic>
+
+namespace Urho3D
+{
+
+class Image;
+class Material;
+class Texture2D;
+
+/// Texture mip streaming statistics.
+struct TextureStreamingStats
+{
+    /// Number of streamed textures.
+    unsigned numTextures_{};
+    /// Number of background loads in progress.
+    unsigned numPendingLoads_{};
+    /// Number of mip levels resident on the GPU in all streamed textures.
+    unsigned residentLevels_{};
+    /// Number of mip levels requested by the on-screen size of all streamed textures.
+    unsigned requestedLevels_{};
+    /// Memory use of the resident mip levels in bytes.
+    unsigned long long residentMemory_{};
+    /// Estimated memory use of the requested mip levels in bytes.
+    unsigned long long requestedMemory_{};
+};
+
+/// Streams mip levels of 2D textures in the background. Textures start with their smallest mip levels and are raised to the resolution requested by their on-screen size, within the Texture2D memory budget of the resource cache.
+class URHO3D_API TextureStreaming : public Object
+{
+    URHO3D_OBJECT(TextureStreaming, Object);
+
+public:
+    /// Construct.
+    explicit TextureStreaming(Context* context);
+    /// Destruct.
+    ~TextureStreaming() override;
+
+    /// Enable or disable streaming of textures loaded afterwards. When disabled, streamed textures are restored to full resolution. Default false.
+    void SetEnabled(bool enable);
+    /// Set largest dimension of the mip levels loaded before a texture has been seen. Default 64.
+    void SetInitialSize(int size);
+    /// Set number of frames a texture may stay unseen before its higher mip levels are evicted. Default 300.
+    void SetEvictionFrames(unsigned frames);
+    /// Set maximum number of simultaneous background loads. Default 2.
+    void SetMaxPendingLoads(unsigned count);
+    /// Set bias added to the requested mip level. Positive values stream lower resolution. Default 0.
+    void SetMipBias(float bias);
+
+    /// Return whether streaming is enabled.
+    bool IsEnabled() const { return enabled_; }
+    /// Return largest dimension of the mip levels loaded before a texture has been seen.
+    int GetInitialSize() const { return initialSize_; }
+    /// Return number of frames a texture may stay unseen before its higher mip levels are evicted.
+    unsigned GetEvictionFrames() const { return evictionFrames_; }
+    /// Return maximum number of simultaneous background loads.
+    unsigned GetMaxPendingLoads() const { return maxPendingLoads_; }
+    /// Return bias added to the requested mip level.
+    float GetMipBias() const { return mipBias_; }
+    /// Return statistics of the last update.
+    const TextureStreamingStats& GetStats() const { return stats_; }
+
+    /// Start streaming a texture loaded from an image file. Called by Texture2D before the image data is set.
+    void AddTexture(Texture2D* texture, Image* image);
+    /// Request the streamed textures of a material for the given on-screen size in pixels. Called by View once per visible material with its largest on-screen size.
+    void RequestMaterialTextures(Material* material, float screenSize);
+    /// Finish completed loads, update requested mip levels, evict under the memory budget and start new loads. Called by Renderer each frame.
+    void Update(unsigned frameNumber);
+
+private:
+    /// Background load of a texture image.
+    struct StreamingLoad : public RefCounted
+    {
+        /// Resource name of the texture.
+        ea::string name_;
+        /// Mip levels to skip when setting the loaded image.
+        unsigned mipsToSkip_{};
+        /// Largest dimension of the first mip level to read.
+        int maxSize_{};
+        /// Loaded image, null if loading failed.
+        SharedPtr<Image> image_;
+        /// Set by the worker thread when the load has finished.
+        std::atomic<bool> done_{};
+    };
+
+    /// Streaming state of a texture.
+    struct StreamedTexture
+    {
+        /// Texture.
+        WeakPtr<Texture2D> texture_;
+        /// Largest dimension of the full resolution image.
+        int size_{};
+        /// Number of mip levels in the full resolution image.
+        unsigned levels_{};
+        /// Mip levels to skip before the texture has been seen.
+        unsigned tailMipsToSkip_{};
+        /// Mip levels to skip for the on-screen size.
+        unsigned requestedMipsToSkip_{};
+        /// Mip levels to skip after this update.
+        unsigned targetMipsToSkip_{};
+        /// Largest on-screen size in pixels during the last frame the texture was seen.
+        float screenSize_{};
+        /// Frame number the texture was last seen on.
+        unsigned lastSeenFrame_{};
+        /// Whether the texture has been seen at all.
+        bool seen_{};
+        /// Whether loading the texture has failed. No further loads are attempted.
+        bool failed_{};
+        /// Background load in progress.
+        SharedPtr<StreamingLoad> pendingLoad_;
+    };
+
+    /// Finish a completed background load on the main thread.
+    void FinishLoad(StreamedTexture& entry);
+    /// Start a background load of a texture with the given number of mip levels to skip.
+    void StartLoad(StreamedTexture& entry, unsigned mipsToSkip);
+
+    /// Streamed textures.
+    ea::unordered_map<Texture2D*, StreamedTexture> textures_;
+    /// Statistics of the last update.
+    TextureStreamingStats stats_;
+    /// Largest dimension of the mip levels loaded before a texture has been seen.
+    int initialSize_{64};
+    /// Number of frames a texture may stay unseen before its higher mip levels are evicted.
+    unsigned evictionFrames_{300};
+    /// Maximum number of simultaneous background loads.
+    unsigned maxPendingLoads_{2};
+    /// Bias added to the requested mip level.
+    float mipBias_{};
+    /// Enabled flag.
+    bool enabled_{};
+};
+
+}
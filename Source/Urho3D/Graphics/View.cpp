@@ -26,6 +26,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
 #include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/DebugRenderer.h"
@@ -45,6 +46,7 @@
 #include "../Graphics/Texture2DArray.h"
 #include "../Graphics/Texture3D.h"
 #include "../Graphics/TextureCube.h"
+#include "../Graphics/TextureStreaming.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/View.h"
 #include "../IO/FileSystem.h"
@@ -60,6 +62,9 @@
 namespace Urho3D
 {
 
+/// Number of drawables whose occlusion is tested in one batch.
+static const unsigned OCCLUSION_TEST_BATCH_SIZE = 64;
+
 /// %Frustum octree query for shadowcasters.
 class ShadowCasterOctreeQuery : public FrustumOctreeQuery
 {
@@ -176,57 +181,77 @@ void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
     bool cameraZoneOverride = view->cameraZoneOverride_;
     PerThreadSceneResult& result = view->sceneResults_[threadIndex];
 
+    BoundingBox occludeeBoxes[OCCLUSION_TEST_BATCH_SIZE];
+    bool occludeeVisible[OCCLUSION_TEST_BATCH_SIZE];
+
     while (start != end)
     {
-        Drawable* drawable = *start++;
-
-        if (!buffer || !drawable->IsOccludee() || buffer->IsVisible(drawable->GetWorldBoundingBox()))
+        // Test the occludees of the next drawables against the occlusion buffer in one batch
+        Drawable** batchEnd = start + Min(end - start, (ptrdiff_t)OCCLUSION_TEST_BATCH_SIZE);
+        unsigned occludeeIndex = 0;
+        if (buffer)
         {
-            drawable->UpdateBatches(view->frame_);
-            // If draw distance non-zero, update and check it
-            float maxDistance = drawable->GetDrawDistance();
-            if (maxDistance > 0.0f)
+            unsigned numOccludees = 0;
+            for (Drawable** i = start; i != batchEnd; ++i)
             {
-                if (drawable->GetDistance() > maxDistance)
-                    continue;
+                if ((*i)->IsOccludee())
+                    occludeeBoxes[numOccludees++] = (*i)->GetWorldBoundingBox();
             }
+            buffer->IsVisible(occludeeBoxes, numOccludees, occludeeVisible);
+        }
 
-            drawable->MarkInView(view->frame_);
+        while (start != batchEnd)
+        {
+            Drawable* drawable = *start++;
 
-            // For geometries, find zone, clear lights and calculate view space Z range
-            if (drawable->GetDrawableFlags() & DRAWABLE_GEOMETRY)
+            if (!buffer || !drawable->IsOccludee() || occludeeVisible[occludeeIndex++])
             {
-                Zone* drawableZone = drawable->GetZone();
-                if (!cameraZoneOverride &&
-                    (drawable->IsZoneDirty() || !drawableZone || (drawableZone->GetViewMask() & cameraViewMask) == 0))
-                    view->FindZone(drawable);
+                drawable->UpdateBatches(view->frame_);
+                // If draw distance non-zero, update and check it
+                float maxDistance = drawable->GetDrawDistance();
+                if (maxDistance > 0.0f)
+                {
+                    if (drawable->GetDistance() > maxDistance)
+                        continue;
+                }
 
-                const BoundingBox& geomBox = drawable->GetWorldBoundingBox();
-                Vector3 center = geomBox.Center();
-                Vector3 edge = geomBox.Size() * 0.5f;
+                drawable->MarkInView(view->frame_);
 
-                // Do not add "infinite" objects like skybox to prevent shadow map focusing behaving erroneously
-                if (edge.LengthSquared() < M_LARGE_VALUE * M_LARGE_VALUE)
+                // For geometries, find zone, clear lights and calculate view space Z range
+                if (drawable->GetDrawableFlags() & DRAWABLE_GEOMETRY)
                 {
-                    float viewCenterZ = viewZ.DotProduct(center) + viewMatrix.m23_;
-                    float viewEdgeZ = absViewZ.DotProduct(edge);
-                    float minZ = viewCenterZ - viewEdgeZ;
-                    float maxZ = viewCenterZ + viewEdgeZ;
-                    drawable->SetMinMaxZ(viewCenterZ - viewEdgeZ, viewCenterZ + viewEdgeZ);
-                    result.minZ_ = Min(result.minZ_, minZ);
-                    result.maxZ_ = Max(result.maxZ_, maxZ);
-                }
-                else
-                    drawable->SetMinMaxZ(M_LARGE_VALUE, M_LARGE_VALUE);
+                    Zone* drawableZone = drawable->GetZone();
+                    if (!cameraZoneOverride &&
+                        (drawable->IsZoneDirty() || !drawableZone || (drawableZone->GetViewMask() & cameraViewMask) == 0))
+                        view->FindZone(drawable);
 
-                result.geometries_.push_back(drawable);
-            }
-            else if (drawable->GetDrawableFlags() & DRAWABLE_LIGHT)
-            {
-                auto* light = static_cast<Light*>(drawable);
-                // Skip lights with zero brightness or black color
-                if (!light->GetEffectiveColor().Equals(Color::BLACK))
-                    result.lights_.push_back(light);
+                    const BoundingBox& geomBox = drawable->GetWorldBoundingBox();
+                    Vector3 center = geomBox.Center();
+                    Vector3 edge = geomBox.Size() * 0.5f;
+
+                    // Do not add "infinite" objects like skybox to prevent shadow map focusing behaving erroneously
+                    if (edge.LengthSquared() < M_LARGE_VALUE * M_LARGE_VALUE)
+                    {
+                        float viewCenterZ = viewZ.DotProduct(center) + viewMatrix.m23_;
+                        float viewEdgeZ = absViewZ.DotProduct(edge);
+                        float minZ = viewCenterZ - viewEdgeZ;
+                        float maxZ = viewCenterZ + viewEdgeZ;
+                        drawable->SetMinMaxZ(viewCenterZ - viewEdgeZ, viewCenterZ + viewEdgeZ);
+                        result.minZ_ = Min(result.minZ_, minZ);
+                        result.maxZ_ = Max(result.maxZ_, maxZ);
+                    }
+                    else
+                        drawable->SetMinMaxZ(M_LARGE_VALUE, M_LARGE_VALUE);
+
+                    result.geometries_.push_back(drawable);
+                }
+                else if (drawable->GetDrawableFlags() & DRAWABLE_LIGHT)
+                {
+                    auto* light = static_cast<Light*>(drawable);
+                    // Skip lights with zero brightness or black color
+                    if (!light->GetEffectiveColor().Equals(Color::BLACK))
+                        result.lights_.push_back(light);
+                }
             }
         }
     }
@@ -547,6 +572,7 @@ void View::Update(const FrameInfo& frame)
 
     SendViewEvent(E_BEGINVIEWUPDATE);
 
+    stageTimes_ = ViewStageTimes();
     int maxSortedInstances = renderer_->GetMaxSortedInstances();
 
     // Clear buffers, geometry, light, occluder & batch list
@@ -570,7 +596,9 @@ void View::Update(const FrameInfo& frame)
     if (cullCamera_ && cullCamera_->GetAutoAspectRatio())
         cullCamera_->SetAspectRatioInternal((float)frame_.viewSize_.x_ / (float)frame_.viewSize_.y_);
 
+    HiresTimer stageTimer;
     GetDrawables();
+    stageTimes_.culling_ = stageTimer.GetUSec(false);
     GetBatches();
     renderer_->StorePreparedView(this, cullCamera_);
 
@@ -587,7 +615,9 @@ void View::Render()
         return;
     }
 
+    HiresTimer stageTimer;
     UpdateGeometries();
+    stageTimes_.geometryUpdate_ = stageTimer.GetUSec(true);
 
     // Allocate screen buffers as necessary
     AllocateScreenBuffers();
@@ -596,8 +626,10 @@ void View::Render()
     // Forget parameter sources from the previous view
     graphics_->ClearParameterSources();
 
+    stageTimer.Reset();
     if (renderer_->GetDynamicInstancing() && graphics_->GetInstancingSupport())
         PrepareInstancingBuffer();
+    stageTimes_.instancingFill_ = stageTimer.GetUSec(false);
 
     // It is possible, though not recommended, that the same camera is used for multiple main views. Set automatic aspect ratio
     // to ensure correct projection will be used
@@ -968,9 +1000,12 @@ void View::GetBatches()
     nonThreadedGeometries_.clear();
     threadedGeometries_.clear();
 
+    HiresTimer stageTimer;
     ProcessLights();
+    stageTimes_.lightProcessing_ = stageTimer.GetUSec(true);
     GetLightBatches();
     GetBaseBatches();
+    stageTimes_.batchBuilding_ = stageTimer.GetUSec(false) - stageTimes_.shadowSetup_;
 }
 
 void View::ProcessLights()
@@ -1057,6 +1092,7 @@ void View::GetLightBatches()
                 lightQueue.volumeBatches_.clear();
 
                 // Allocate shadow map now
+                HiresTimer shadowTimer;
                 if (shadowSplits > 0)
                 {
                     lightQueue.shadowMap_ = renderer_->GetShadowMap(light, cullCamera_, (unsigned)viewSize_.x_, (unsigned)viewSize_.y_);
@@ -1079,6 +1115,7 @@ void View::GetLightBatches()
                     // Setup the shadow split viewport and finalize shadow camera parameters
                     shadowQueue.shadowViewport_ = GetShadowMapViewport(light, j, lightQueue.shadowMap_);
                     FinalizeShadowCamera(shadowCamera, light, shadowQueue.shadowViewport_, query.shadowCasterBox_[j]);
+                    stageTimes_.shadowSetup_ += shadowTimer.GetUSec(true);
 
                     // Loop through shadow casters
                     for (auto k = query.shadowCasters_.begin() + query.shadowCasterBegin_[j];
@@ -1118,7 +1155,9 @@ void View::GetLightBatches()
                             AddBatchToQueue(shadowQueue.shadowBatches_, destBatch, tech);
                         }
                     }
+                    shadowTimer.Reset();
                 }
+                stageTimes_.shadowSetup_ += shadowTimer.GetUSec(false);
 
                 // Process lit geometries
                 for (auto j = query.litGeometries_.begin(); j !=
@@ -1195,6 +1234,14 @@ void View::GetBaseBatches()
 {
     URHO3D_PROFILE("GetBaseBatches");
 
+    // Pixels per world unit at unit distance, for reporting the on-screen size of textures to mip streaming
+    TextureStreaming* textureStreaming = renderer_->GetTextureStreaming();
+    if (!textureStreaming->IsEnabled())
+        textureStreaming = nullptr;
+    const float screenScale = camera_->GetProjection().m11_ * 0.5f * viewSize_.y_;
+    const bool orthographic = camera_->IsOrthographic();
+    streamingScreenSizes_.clear();
+
     for (auto i = geometries_.begin(); i != geometries_.end(); ++i)
     {
         Drawable* drawable = *i;
@@ -1207,6 +1254,17 @@ void View::GetBaseBatches()
         const ea::vector<SourceBatch>& batches = drawable->GetBatches();
         bool vertexLightsProcessed = false;
 
+        float screenSize = 0.0f;
+        if (textureStreaming)
+        {
+            const float worldSize = drawable->GetWorldBoundingBox().Size().Length();
+            const float distance = drawable->GetDistance();
+            if (orthographic)
+                screenSize = worldSize * screenScale;
+            else
+                screenSize = distance > M_EPSILON ? worldSize * screenScale / distance : M_LARGE_VALUE;
+        }
+
         for (unsigned j = 0; j < batches.size(); ++j)
         {
             const SourceBatch& srcBatch = batches[j];
@@ -1216,6 +1274,12 @@ void View::GetBaseBatches()
             if (srcBatch.material_ && srcBatch.material_->GetAuxViewFrameNumber() != frame_.frameNumber_ && !renderTarget_)
                 CheckMaterialForAuxView(srcBatch.material_);
 
+            if (textureStreaming && srcBatch.material_)
+            {
+                float& materialScreenSize = streamingScreenSizes_[srcBatch.material_];
+                materialScreenSize = Max(materialScreenSize, screenSize);
+            }
+
             Technique* tech = GetTechnique(drawable, srcBatch.material_);
             if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
                 continue;
@@ -1278,6 +1342,13 @@ void View::GetBaseBatches()
             }
         }
     }
+
+    // Request the textures of each visible material once, with the largest on-screen size it was drawn at
+    if (textureStreaming)
+    {
+        for (const auto& item : streamingScreenSizes_)
+            textureStreaming->RequestMaterialTextures(item.first, item.second);
+    }
 }
 
 void View::UpdateGeometries()
@@ -1758,7 +1829,7 @@ void View::SetRenderTargets(RenderPathCommand& command)
             {
                 useColorWrite = false;
                 useCustomDepth = true;
-#if !defined(URHO3D_OPENGL) && !defined(URHO3D_D3D11)
+#if !defined(URHO3D_OPENGL) && !defined(URHO3D_D3D11) && !defined(URHO3D_NULL)
                 // On D3D9 actual depth-only rendering is illegal, we need a color rendertarget
                 if (!depthOnlyDummyTexture_)
                 {
@@ -2918,14 +2989,18 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
 
         auto i = queue.batchGroups_.find(key);
         if (i == queue.batchGroups_.end())
+            i = queue.batchGroups_.emplace(key, BatchGroup()).first;
+
+        if (i->second.instances_.empty())
         {
-            // Create a new group based on the batch
+            // Set up the group from the batch when first used on this frame. Groups persist across frames to reuse their
+            // instance storage, but shaders depend on per-frame state
             // In case the group remains below the instancing limit, do not enable instancing shaders yet
-            BatchGroup newGroup(batch);
-            newGroup.geometryType_ = GEOM_STATIC;
-            renderer_->SetBatchShaders(newGroup, tech, allowShadows, queue);
-            newGroup.CalculateSortKey();
-            i = queue.batchGroups_.insert(ea::make_pair(key, newGroup)).first;
+            static_cast<Batch&>(i->second) = batch;
+            i->second.geometryType_ = GEOM_STATIC;
+            renderer_->SetBatchShaders(i->second, tech, allowShadows, queue);
+            i->second.CalculateSortKey();
+            ++queue.numBatchGroups_;
         }
 
         int oldSize = i->second.instances_.size();
@@ -104,6 +104,23 @@ struct PerThreadSceneResult
     float maxZ_;
 };
 
+/// Time spent in the stages of the last view update and render, in microseconds. Threaded stages are measured on the main thread, which waits for the worker threads.
+struct ViewStageTimes
+{
+    /// Octree query, occlusion and visibility checks.
+    long long culling_{};
+    /// Lit geometry and shadow caster queries of the lights.
+    long long lightProcessing_{};
+    /// Light, base and shadow batch building, excluding shadow setup.
+    long long batchBuilding_{};
+    /// Shadow map allocation and shadow camera setup.
+    long long shadowSetup_{};
+    /// Batch sorting and geometry updates.
+    long long geometryUpdate_{};
+    /// Filling the instancing buffer.
+    long long instancingFill_{};
+};
+
 static const unsigned MAX_VIEWPORT_TEXTURES = 2;
 
 /// Internal structure for 3D rendering work. Created for each backbuffer and texture viewport, but not for shadow cameras.
@@ -175,6 +192,9 @@ public:
     /// Return number of occluders that were actually rendered. Occluders may be rejected if running out of triangles or if behind other occluders.
     unsigned GetNumActiveOccluders() const { return activeOccluders_; }
 
+    /// Return the time spent in the stages of the last update and render.
+    const ViewStageTimes& GetStageTimes() const { return stageTimes_; }
+
     /// Return the source view that was already prepared. Used when viewports specify the same culling camera.
     View* GetSourceView() const;
 
@@ -415,6 +435,10 @@ private:
     ea::unordered_map<unsigned long long, LightBatchQueue> vertexLightQueues_;
     /// Batch queues by pass index.
     ea::unordered_map<unsigned, BatchQueue> batchQueues_;
+    /// Largest on-screen size of each visible material, reported to texture mip streaming.
+    ea::unordered_map<Material*, float> streamingScreenSizes_;
+    /// Time spent in the stages of the last update and render.
+    ViewStageTimes stageTimes_;
     /// Index of the GBuffer pass.
     unsigned gBufferPassIndex_{};
     /// Index of the opaque forward base pass.
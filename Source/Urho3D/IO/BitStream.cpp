@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../IO/BitStream.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+BitWriter::BitWriter(Serializer& dest) :
+    dest_(dest)
+{
+}
+
+BitWriter::~BitWriter()
+{
+    Flush();
+}
+
+void BitWriter::WriteBits(unsigned value, unsigned numBits)
+{
+    if (!numBits)
+        return;
+    if (numBits > 32)
+        numBits = 32;
+
+    const unsigned long long mask = (1ull << numBits) - 1;
+    pendingBits_ |= ((unsigned long long)value & mask) << numPendingBits_;
+    numPendingBits_ += numBits;
+
+    // Write out complete bytes
+    while (numPendingBits_ >= 8)
+    {
+        dest_.WriteUByte((unsigned char)(pendingBits_ & 0xffu));
+        pendingBits_ >>= 8u;
+        numPendingBits_ -= 8;
+    }
+}
+
+void BitWriter::Flush()
+{
+    if (numPendingBits_)
+    {
+        dest_.WriteUByte((unsigned char)(pendingBits_ & 0xffu));
+        pendingBits_ = 0;
+        numPendingBits_ = 0;
+    }
+}
+
+BitReader::BitReader(Deserializer& source) :
+    source_(source)
+{
+}
+
+unsigned BitReader::ReadBits(unsigned numBits)
+{
+    if (!numBits)
+        return 0;
+    if (numBits > 32)
+        numBits = 32;
+
+    while (numBufferedBits_ < numBits)
+    {
+        bufferedBits_ |= (unsigned long long)source_.ReadUByte() << numBufferedBits_;
+        numBufferedBits_ += 8;
+    }
+
+    const unsigned long long mask = (1ull << numBits) - 1;
+    const auto value = (unsigned)(bufferedBits_ & mask);
+    bufferedBits_ >>= numBits;
+    numBufferedBits_ -= numBits;
+    return value;
+}
+
+}
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../IO/Deserializer.h"
+#include "../IO/Serializer.h"
+
+namespace Urho3D
+{
+
+/// Writes values of arbitrary bit width to a serializer, least significant bit first. Pending bits are written on Flush() or destruction.
+class URHO3D_API BitWriter
+{
+public:
+    /// Construct with destination serializer.
+    explicit BitWriter(Serializer& dest);
+    /// Destruct. Write pending bits.
+    ~BitWriter();
+
+    /// Write the lowest bits of a value. At most 32 bits can be written at once.
+    void WriteBits(unsigned value, unsigned numBits);
+    /// Write a single bit.
+    void WriteBool(bool value) { WriteBits(value ? 1u : 0u, 1); }
+    /// Write pending bits, padding the last byte with zeros.
+    void Flush();
+
+private:
+    /// Destination serializer.
+    Serializer& dest_;
+    /// Pending bits.
+    unsigned long long pendingBits_{};
+    /// Number of pending bits.
+    unsigned numPendingBits_{};
+};
+
+/// Reads values written by BitWriter from a deserializer. Unused bits of the last read byte are discarded on destruction.
+class URHO3D_API BitReader
+{
+public:
+    /// Construct with source deserializer.
+    explicit BitReader(Deserializer& source);
+
+    /// Read a value of specified bit width. At most 32 bits can be read at once.
+    unsigned ReadBits(unsigned numBits);
+    /// Read a single bit.
+    bool ReadBool() { return ReadBits(1) != 0; }
+
+private:
+    /// Source deserializer.
+    Deserializer& source_;
+    /// Buffered bits.
+    unsigned long long bufferedBits_{};
+    /// Number of buffered bits.
+    unsigned numBufferedBits_{};
+};
+
+}
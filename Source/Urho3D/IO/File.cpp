@@ -147,7 +147,10 @@ bool File::Open(PackageFile* package, const ea::string& fileName)
     offset_ = entry->offset_;
     checksum_ = entry->checksum_;
     size_ = entry->size_;
-    compressed_ = package->IsCompressed();
+    compressed_ = package->IsCompressed() && entry->compressed_;
+    package_ = package;
+    packageEntry_ = entry;
+    mappedData_ = package->GetMappedData(entry);
 
     // Seek to beginning of package entry's file data
     SeekInternal(offset_);
@@ -208,6 +211,13 @@ unsigned File::Read(void* dest, unsigned size)
     }
 #endif
 
+    if (mappedData_)
+    {
+        memcpy(dest, mappedData_ + position_, size);
+        position_ += size;
+        return size;
+    }
+
     if (compressed_)
     {
         unsigned sizeLeft = size;
@@ -216,27 +226,7 @@ unsigned File::Read(void* dest, unsigned size)
         while (sizeLeft)
         {
             if (!readBuffer_ || readBufferOffset_ >= readBufferSize_)
-            {
-                unsigned char blockHeaderBytes[4];
-                ReadInternal(blockHeaderBytes, sizeof blockHeaderBytes);
-
-                MemoryBuffer blockHeader(&blockHeaderBytes[0], sizeof blockHeaderBytes);
-                unsigned unpackedSize = blockHeader.ReadUShort();
-                unsigned packedSize = blockHeader.ReadUShort();
-
-                if (!readBuffer_)
-                {
-                    readBuffer_ = new unsigned char[unpackedSize];
-                    inputBuffer_ = new unsigned char[LZ4_compressBound(unpackedSize)];
-                }
-
-                /// \todo Handle errors
-                ReadInternal(inputBuffer_.get(), packedSize);
-                LZ4_decompress_fast((const char*)inputBuffer_.get(), (char*)readBuffer_.get(), unpackedSize);
-
-                readBufferSize_ = unpackedSize;
-                readBufferOffset_ = 0;
-            }
+                ReadCompressedBlock();
 
             unsigned copySize = Min((readBufferSize_ - readBufferOffset_), sizeLeft);
             memcpy(destPtr, readBuffer_.get() + readBufferOffset_, copySize);
@@ -281,10 +271,19 @@ unsigned File::Seek(unsigned position)
     if (mode_ == FILE_READ && position > size_)
         position = size_;
 
+    if (mappedData_)
+    {
+        position_ = position;
+        return position_;
+    }
+
     if (compressed_)
     {
+        // Jump directly to the block containing the position if the package has a block index
+        if (packageEntry_ && !packageEntry_->blockOffsets_.empty())
+            SeekCompressedBlock(position);
         // Start over from the beginning
-        if (position == 0)
+        else if (position == 0)
         {
             position_ = 0;
             readBufferOffset_ = 0;
@@ -353,7 +352,8 @@ unsigned File::Write(const void* data, unsigned size)
 
 unsigned File::GetChecksum()
 {
-    if (offset_ || checksum_)
+    // Package entries carry their checksum, unless the package predates the current checksum algorithm
+    if (checksum_)
         return checksum_;
 #ifdef __ANDROID__
     if ((!handle_ && !assetHandle_) || mode_ == FILE_WRITE)
@@ -365,16 +365,17 @@ unsigned File::GetChecksum()
     URHO3D_PROFILE("CalculateFileChecksum");
 
     unsigned oldPos = position_;
-    checksum_ = 0;
+    unsigned long long hash = HASH64_SEED;
 
+    // Block size is a multiple of eight, so the result matches a checksum of the whole data hashed at once
     Seek(0);
     while (!IsEof())
     {
-        unsigned char block[1024];
-        unsigned readBytes = Read(block, 1024);
-        for (unsigned i = 0; i < readBytes; ++i)
-            checksum_ = SDBMHash(checksum_, block[i]);
+        unsigned char block[4096];
+        unsigned readBytes = Read(block, sizeof block);
+        hash = UpdateHash64(hash, block, readBytes);
     }
+    checksum_ = (unsigned)FinishHash64(hash, size_);
 
     Seek(oldPos);
     return checksum_;
@@ -392,6 +393,10 @@ void File::Close()
 
     readBuffer_.reset();
     inputBuffer_.reset();
+    readBufferCapacity_ = 0;
+    package_.Reset();
+    packageEntry_ = nullptr;
+    mappedData_ = nullptr;
 
     if (handle_)
     {
@@ -549,6 +554,59 @@ void File::SeekInternal(unsigned newPosition)
         fseek((FILE*)handle_, newPosition, SEEK_SET);
 }
 
+void File::ReadCompressedBlock()
+{
+    unsigned char blockHeaderBytes[4];
+    ReadInternal(blockHeaderBytes, sizeof blockHeaderBytes);
+
+    MemoryBuffer blockHeader(&blockHeaderBytes[0], sizeof blockHeaderBytes);
+    unsigned unpackedSize = blockHeader.ReadUShort();
+    unsigned packedSize = blockHeader.ReadUShort();
+
+    // After a seek the first decompressed block may be the last, smaller one, so grow the buffers as needed
+    if (!readBuffer_ || unpackedSize > readBufferCapacity_)
+    {
+        readBufferCapacity_ = Max(unpackedSize, packageEntry_ ? packageEntry_->blockSize_ : 0u);
+        readBuffer_ = new unsigned char[readBufferCapacity_];
+        inputBuffer_ = new unsigned char[LZ4_compressBound(readBufferCapacity_)];
+    }
+
+    /// \todo Handle errors
+    ReadInternal(inputBuffer_.get(), packedSize);
+    LZ4_decompress_fast((const char*)inputBuffer_.get(), (char*)readBuffer_.get(), unpackedSize);
+
+    readBufferSize_ = unpackedSize;
+    readBufferOffset_ = 0;
+}
+
+void File::SeekCompressedBlock(unsigned position)
+{
+    const unsigned blockSize = packageEntry_->blockSize_;
+    const unsigned block = position / blockSize;
+
+    // Stay within the current block if possible
+    const unsigned bufferStart = position_ - readBufferOffset_;
+    if (readBufferSize_ && position >= bufferStart && position < bufferStart + readBufferSize_)
+    {
+        readBufferOffset_ = position - bufferStart;
+        position_ = position;
+        return;
+    }
+
+    const ea::vector<unsigned>& blockOffsets = packageEntry_->blockOffsets_;
+    SeekInternal(offset_ + blockOffsets[Min(block, blockOffsets.size() - 1)]);
+    readBufferOffset_ = 0;
+    readBufferSize_ = 0;
+
+    // At the end of the entry there is no block to decompress
+    if (block < blockOffsets.size() - 1)
+    {
+        ReadCompressedBlock();
+        readBufferOffset_ = position - block * blockSize;
+    }
+    position_ = position;
+}
+
 void File::ReadBinary(ea::vector<unsigned char>& buffer)
 {
     buffer.clear();
@@ -28,6 +28,7 @@
 
 #include "../Core/Object.h"
 #include "../IO/AbstractFile.h"
+#include "../IO/PackageFile.h"
 
 #ifdef __ANDROID__
 struct SDL_RWops;
@@ -58,8 +59,6 @@ enum FileMode
     FILE_READWRITE
 };
 
-class PackageFile;
-
 /// %File opened either through the filesystem or from within a package file.
 class URHO3D_API File : public Object, public AbstractFile
 {
@@ -85,7 +84,7 @@ public:
     /// Return the file name.
     const ea::string& GetName() const override { return fileName_; }
 
-    /// Return a checksum of the file contents using the SDBM hash algorithm.
+    /// Return a checksum of the file contents, the lower 32 bits of the UpdateHash64() hash. Calculated on first use, also for entries of packages older than format version 1.
     unsigned GetChecksum() override;
 
     /// Open a filesystem file. Return true if successful.
@@ -111,6 +110,9 @@ public:
     /// Return whether the file originates from a package.
     bool IsPackaged() const { return offset_ != 0; }
 
+    /// Return the file data when read from a memory-mapped package, or null otherwise. Can be wrapped in a MemoryBuffer to avoid copying.
+    const unsigned char* GetMappedData() const { return mappedData_; }
+
     /// Reads a binary file to buffer.
     void ReadBinary(ea::vector<unsigned char>& buffer);
 
@@ -134,6 +136,10 @@ private:
     bool ReadInternal(void* dest, unsigned size);
     /// Seek in file internally using either C standard IO functions or SDL RWops for Android asset files.
     void SeekInternal(unsigned newPosition);
+    /// Read and decompress the next block of a compressed package entry into the read buffer.
+    void ReadCompressedBlock();
+    /// Seek in a compressed package entry using its block index.
+    void SeekCompressedBlock(unsigned position);
 
     /// File name.
     ea::string fileName_;
@@ -149,6 +155,14 @@ private:
     ea::shared_array<unsigned char> readBuffer_;
     /// Decompression input buffer for compressed file loading.
     ea::shared_array<unsigned char> inputBuffer_;
+    /// Package the file was opened from. Keeps the entry and the memory mapping alive.
+    SharedPtr<PackageFile> package_;
+    /// Package entry the file was opened from.
+    const PackageEntry* packageEntry_{};
+    /// File data within a memory-mapped package.
+    const unsigned char* mappedData_{};
+    /// Allocated size of the read buffer for compressed file loading.
+    unsigned readBufferCapacity_{};
     /// Read buffer position.
     unsigned readBufferOffset_;
     /// Bytes in the current read buffer.
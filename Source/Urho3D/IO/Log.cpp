@@ -37,9 +37,14 @@
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/dist_sink.h>
 #include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/log_msg_buffer.h>
 #include <spdlog/details/null_mutex.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <cstdio>
 
 #ifdef __ANDROID__
@@ -59,6 +64,9 @@ namespace Urho3D
 
 static Log* logInstance = nullptr;
 
+/// Time the asynchronous log writer sleeps at most when the queue is empty.
+static const unsigned ASYNC_LOG_WRITER_TIMEOUT_MS = 10;
+
 #if defined(IOS) || defined(TVOS)
 template<typename Mutex>
 class IOSSink : public spdlog::sinks::base_sink<Mutex>
@@ -175,6 +183,128 @@ void Logger::Write(LogLevel level, const ea::string& message) const
     }
 }
 
+/// Bounded queue of log messages with multiple lock-free producers and a single consumer.
+class AsyncLogQueue
+{
+public:
+    /// Construct with capacity, rounded up to a power of two.
+    explicit AsyncLogQueue(unsigned capacity) :
+        capacity_(NextPowerOfTwo(Max(capacity, 2U))),
+        mask_(capacity_ - 1),
+        cells_(new Cell[capacity_])
+    {
+        for (unsigned i = 0; i < capacity_; ++i)
+            cells_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+
+    /// Copy a message into the queue. Return false if the queue is full. May be called from any thread.
+    bool TryPush(const spdlog::details::log_msg& msg)
+    {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;)
+        {
+            cell = &cells_[pos & mask_];
+            const size_t sequence = cell->sequence_.load(std::memory_order_acquire);
+            const auto diff = static_cast<ptrdiff_t>(sequence - pos);
+            if (diff == 0)
+            {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+
+        cell->message_ = spdlog::details::log_msg_buffer(msg);
+        cell->sequence_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Move the oldest message out of the queue. Return false if the queue is empty. Must be called from the consumer thread only.
+    bool TryPop(spdlog::details::log_msg_buffer& msg)
+    {
+        Cell& cell = cells_[dequeuePos_ & mask_];
+        if (cell.sequence_.load(std::memory_order_acquire) != dequeuePos_ + 1)
+            return false;
+
+        msg = std::move(cell.message_);
+        cell.sequence_.store(dequeuePos_ + capacity_, std::memory_order_release);
+        ++dequeuePos_;
+        return true;
+    }
+
+    /// Return whether the next message is not yet available. Must be called from the consumer thread only.
+    bool IsEmpty() const { return cells_[dequeuePos_ & mask_].sequence_.load(std::memory_order_acquire) != dequeuePos_ + 1; }
+
+    /// Return number of queue positions claimed by producers so far.
+    size_t GetNumPushed() const { return enqueuePos_.load(std::memory_order_acquire); }
+
+    /// Return capacity.
+    unsigned GetCapacity() const { return capacity_; }
+
+private:
+    /// Queue slot.
+    struct Cell
+    {
+        /// Sequence number telling whether the slot is free for the producer or filled for the consumer.
+        std::atomic<size_t> sequence_{};
+        /// Stored message.
+        spdlog::details::log_msg_buffer message_;
+    };
+
+    /// Capacity.
+    const unsigned capacity_;
+    /// Mask to wrap positions to slot indices.
+    const size_t mask_;
+    /// Slots.
+    std::unique_ptr<Cell[]> cells_;
+    /// Next position to be claimed by a producer.
+    alignas(64) std::atomic<size_t> enqueuePos_{};
+    /// Next position to be read by the consumer.
+    alignas(64) size_t dequeuePos_{};
+};
+
+class LogImpl;
+
+/// Entry sink of all loggers. Writes messages to the sink proxy directly, or queues them for the writer thread in asynchronous mode.
+class LogFrontSink : public spdlog::sinks::sink
+{
+public:
+    /// Construct.
+    explicit LogFrontSink(LogImpl* impl) : impl_(impl) { }
+
+    /// Write or queue a message.
+    void log(const spdlog::details::log_msg& msg) override;
+    /// Flush the underlying sinks.
+    void flush() override;
+    /// Formatting is done by the underlying sinks.
+    void set_pattern(const eastl::string& pattern) override { }
+    /// Formatting is done by the underlying sinks.
+    void set_formatter(std::unique_ptr<spdlog::formatter> sinkFormatter) override { }
+
+private:
+    /// Log implementation.
+    LogImpl* impl_;
+};
+
+/// Thread writing queued messages in asynchronous mode.
+class AsyncLogWriter : public Thread
+{
+public:
+    /// Construct.
+    explicit AsyncLogWriter(LogImpl* impl) : Thread("LogWriter"), impl_(impl) { }
+
+    /// Write messages until stopped.
+    void ThreadFunction() override;
+
+private:
+    /// Log implementation.
+    LogImpl* impl_;
+};
+
 class LogImpl : public Object
 {
     URHO3D_OBJECT(LogImpl, Object);
@@ -182,6 +312,7 @@ public:
     explicit LogImpl(Context* context) : Object(context)
     {
         sinkProxy_ = std::make_shared<spdlog::sinks::dist_sink_mt>();
+        frontSink_ = std::make_shared<LogFrontSink>(this);
 #if defined(__ANDROID__)
         platformSink_ = std::make_shared<spdlog::sinks::android_sink_mt>("Urho3D");
 #elif defined(IOS) || defined(TVOS)
@@ -197,6 +328,175 @@ public:
         sinkProxy_->add_sink(std::make_shared<MessageForwarderSink_mt>());
     }
 
+    ~LogImpl() override
+    {
+        StopAsync();
+    }
+
+    /// Write a message to the sinks, or queue it in asynchronous mode.
+    void Dispatch(const spdlog::details::log_msg& msg)
+    {
+        // Register as a producer before checking the mode. Pairs with StopAsync() clearing the flag before waiting for the producers
+        numProducers_.fetch_add(1, std::memory_order_seq_cst);
+        if (!async_.load(std::memory_order_seq_cst))
+        {
+            numProducers_.fetch_sub(1, std::memory_order_release);
+            sinkProxy_->log(msg);
+            return;
+        }
+
+        // Errors are never dropped. The writer thread must not wait for itself, e.g. when a sink logs
+        const bool isError = msg.level >= spdlog::level::err;
+        const bool isWriter = std::this_thread::get_id() == writerThreadID_.load(std::memory_order_relaxed);
+        while (!queue_->TryPush(msg))
+        {
+            if ((!isError && overflowPolicy_ != LOG_OVERFLOW_BLOCK) || isWriter)
+            {
+                numDropped_.fetch_add(1, std::memory_order_relaxed);
+                numProducers_.fetch_sub(1, std::memory_order_release);
+                return;
+            }
+
+            WakeWriter();
+            std::this_thread::yield();
+        }
+
+        // Pairs with the writer announcing that it goes to sleep before checking the queue for the last time
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (writerSleeping_.load(std::memory_order_relaxed))
+            WakeWriter();
+
+        // Errors are written and flushed before returning, so that they are not lost if the application crashes right after
+        if (isError && !isWriter)
+        {
+            const size_t numPushed = queue_->GetNumPushed();
+            while (numWritten_.load(std::memory_order_acquire) < numPushed)
+            {
+                WakeWriter();
+                std::this_thread::yield();
+            }
+            sinkProxy_->flush();
+        }
+
+        numProducers_.fetch_sub(1, std::memory_order_release);
+    }
+
+    /// Start the writer thread and route messages through the queue. Return true on success.
+    bool StartAsync(unsigned queueSize, LogOverflowPolicy overflowPolicy)
+    {
+        StopAsync();
+
+        // The queue is never released while the log exists, as a producer may still be pushing into it after asynchronous mode ends
+        if (!queue_ || queue_->GetCapacity() != NextPowerOfTwo(Max(queueSize, 2U)))
+            queue_ = std::make_unique<AsyncLogQueue>(queueSize);
+        overflowPolicy_ = overflowPolicy;
+        numWritten_.store(queue_->GetNumPushed(), std::memory_order_relaxed);
+
+        writer_ = std::make_unique<AsyncLogWriter>(this);
+        if (!writer_->Run())
+        {
+            writer_.reset();
+            return false;
+        }
+
+        async_.store(true, std::memory_order_release);
+        return true;
+    }
+
+    /// Stop the writer thread after writing out all queued messages.
+    void StopAsync()
+    {
+        if (!writer_)
+            return;
+
+        async_.store(false, std::memory_order_seq_cst);
+        writer_->Stop();
+        writer_.reset();
+        writerThreadID_.store(std::thread::id(), std::memory_order_relaxed);
+
+        // Producers that saw asynchronous mode may still be pushing, or waiting for their errors to be written. Keep writing
+        // until all of them are done, then write whatever they pushed last
+        while (numProducers_.load(std::memory_order_seq_cst) > 0)
+        {
+            WriteQueuedMessages();
+            std::this_thread::yield();
+        }
+        WriteQueuedMessages();
+        sinkProxy_->flush();
+    }
+
+    /// Wait until all queued messages are written, then flush the sinks.
+    void Flush()
+    {
+        if (writer_)
+        {
+            const size_t numPushed = queue_->GetNumPushed();
+            while (numWritten_.load(std::memory_order_acquire) < numPushed)
+            {
+                WakeWriter();
+                std::this_thread::yield();
+            }
+        }
+
+        sinkProxy_->flush();
+    }
+
+    /// Write queued messages until the queue is empty. Return true if any message was written. Must be called from one thread at a time.
+    bool WriteQueuedMessages()
+    {
+        if (!queue_)
+            return false;
+
+        bool written = false;
+        while (queue_->TryPop(writeBuffer_))
+        {
+            sinkProxy_->log(writeBuffer_);
+            numWritten_.fetch_add(1, std::memory_order_release);
+            written = true;
+        }
+
+        if (overflowPolicy_ == LOG_OVERFLOW_COUNT)
+        {
+            const unsigned numDropped = numDropped_.load(std::memory_order_relaxed);
+            if (numDropped != numDroppedReported_)
+            {
+                const eastl::string text = Format("{} log messages were dropped because the asynchronous log queue was full",
+                    numDropped - numDroppedReported_);
+                sinkProxy_->log(spdlog::details::log_msg("Log", spdlog::level::warn, spdlog::string_view_t(text.data(), text.size())));
+                numDroppedReported_ = numDropped;
+            }
+        }
+
+        return written;
+    }
+
+    /// Writer thread loop.
+    void RunWriter(const volatile bool& shouldRun)
+    {
+        writerThreadID_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        while (shouldRun)
+        {
+            if (WriteQueuedMessages())
+                continue;
+
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            writerSleeping_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (queue_->IsEmpty())
+                wakeCondition_.wait_for(lock, std::chrono::milliseconds(ASYNC_LOG_WRITER_TIMEOUT_MS));
+            writerSleeping_.store(false, std::memory_order_relaxed);
+        }
+
+        WriteQueuedMessages();
+    }
+
+    /// Wake up the writer thread.
+    void WakeWriter()
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wakeCondition_.notify_one();
+    }
+
 #ifdef __ANDROID__
     /// Android adb logcat sink
     std::shared_ptr<spdlog::sinks::android_sink_mt> platformSink_;
@@ -215,8 +515,51 @@ public:
 #endif
     /// Sink that forwards messages to all other sinks.
     std::shared_ptr<spdlog::sinks::dist_sink_mt> sinkProxy_;
+    /// Sink used by all loggers.
+    std::shared_ptr<LogFrontSink> frontSink_;
+    /// Asynchronous message queue.
+    std::unique_ptr<AsyncLogQueue> queue_;
+    /// Asynchronous writer thread.
+    std::unique_ptr<AsyncLogWriter> writer_;
+    /// Message being written by the consumer.
+    spdlog::details::log_msg_buffer writeBuffer_;
+    /// Asynchronous mode flag.
+    std::atomic<bool> async_{};
+    /// Behaviour when the queue is full.
+    LogOverflowPolicy overflowPolicy_{LOG_OVERFLOW_BLOCK};
+    /// Number of messages dropped because the queue was full.
+    std::atomic<unsigned> numDropped_{};
+    /// Number of dropped messages already reported.
+    unsigned numDroppedReported_{};
+    /// Number of queued messages written so far, counted in queue positions.
+    std::atomic<size_t> numWritten_{};
+    /// Number of threads currently inside Dispatch().
+    std::atomic<unsigned> numProducers_{};
+    /// Writer thread identifier.
+    std::atomic<std::thread::id> writerThreadID_{};
+    /// Writer sleeping flag.
+    std::atomic<bool> writerSleeping_{};
+    /// Mutex for waking up the writer.
+    std::mutex wakeMutex_;
+    /// Condition for waking up the writer.
+    std::condition_variable wakeCondition_;
 };
 
+void LogFrontSink::log(const spdlog::details::log_msg& msg)
+{
+    impl_->Dispatch(msg);
+}
+
+void LogFrontSink::flush()
+{
+    impl_->sinkProxy_->flush();
+}
+
+void AsyncLogWriter::ThreadFunction()
+{
+    impl_->RunWriter(shouldRun_);
+}
+
 Log::Log(Context* context) :
     Object(context),
     impl_(new LogImpl(context)),
@@ -229,6 +572,7 @@ Log::Log(Context* context) :
 
 Log::~Log()
 {
+    impl_->StopAsync();
     logInstance = nullptr;
 }
 
@@ -278,6 +622,40 @@ void Log::SetQuiet(bool quiet)
     impl_->platformSink_->set_level(ConvertLogLevel(quiet ? LOG_NONE : level_));
 }
 
+void Log::SetAsync(bool enable, unsigned queueSize, LogOverflowPolicy overflowPolicy)
+{
+    if (!Thread::IsMainThread())
+    {
+        URHO3D_LOGERROR("Asynchronous logging may only be toggled from the main thread");
+        return;
+    }
+
+    if (enable)
+    {
+        if (!impl_->StartAsync(queueSize, overflowPolicy))
+        {
+            async_ = false;
+            URHO3D_LOGERROR("Failed to start asynchronous log writer thread");
+            return;
+        }
+    }
+    else
+        impl_->StopAsync();
+
+    async_ = enable;
+    overflowPolicy_ = overflowPolicy;
+}
+
+void Log::Flush()
+{
+    impl_->Flush();
+}
+
+unsigned Log::GetNumDroppedMessages() const
+{
+    return impl_->numDropped_.load(std::memory_order_relaxed);
+}
+
 void Log::SetLogFormat(const ea::string& format)
 {
     formatPattern_ = format;
@@ -305,7 +683,7 @@ Logger Log::GetLogger(const ea::string& name)
 
     if (!logger)
     {
-        logger = std::make_shared<spdlog::logger>(name, logInstance->impl_->sinkProxy_);
+        logger = std::make_shared<spdlog::logger>(name, logInstance->impl_->frontSink_);
         spdlog::register_logger(logger);
     }
 
@@ -66,6 +66,20 @@ static Color LOG_LEVEL_COLORS[] = {
 };
 static_assert(URHO3D_ARRAYSIZE(LOG_LEVEL_COLORS) == MAX_LOGLEVELS, "Inconsistent number of log levels and log colors.");
 
+/// Behaviour of asynchronous logging when the message queue is full.
+enum LogOverflowPolicy
+{
+    /// Wait until the writer thread frees space in the queue.
+    LOG_OVERFLOW_BLOCK = 0,
+    /// Discard the message.
+    LOG_OVERFLOW_DROP,
+    /// Discard the message and log the number of discarded messages once the queue has space again.
+    LOG_OVERFLOW_COUNT,
+};
+
+/// Default capacity of the asynchronous log message queue.
+static const unsigned DEFAULT_ASYNC_LOG_QUEUE_SIZE = 8192;
+
 static const char* logLevelNames[] =
 {
     "TRACE",
@@ -161,6 +175,10 @@ public:
     void SetLogFormat(const ea::string& format);
     /// Set quiet mode ie. only print error entries to standard error stream (which is normally redirected to console also). Output to log file is not affected by this mode.
     void SetQuiet(bool quiet);
+    /// Set asynchronous mode. Messages are then queued into a bounded lock-free queue and written to the console and file by a dedicated thread. Should be set from the main thread before other threads start logging.
+    void SetAsync(bool enable, unsigned queueSize = DEFAULT_ASYNC_LOG_QUEUE_SIZE, LogOverflowPolicy overflowPolicy = LOG_OVERFLOW_BLOCK);
+    /// Wait until all queued messages have been written and flush the console and file.
+    void Flush();
 
     /// Return logging level.
     LogLevel GetLevel() const { return level_; }
@@ -168,6 +186,15 @@ public:
     /// Return whether log is in quiet mode (only errors printed to standard error stream).
     bool IsQuiet() const { return quiet_; }
 
+    /// Return whether log is in asynchronous mode.
+    bool IsAsync() const { return async_; }
+
+    /// Return behaviour of asynchronous mode when the message queue is full.
+    LogOverflowPolicy GetOverflowPolicy() const { return overflowPolicy_; }
+
+    /// Return number of messages discarded because the asynchronous message queue was full.
+    unsigned GetNumDroppedMessages() const;
+
     /// Returns a logger with specified name.
     static Logger GetLogger(const ea::string& name);
     /// Returns default logger.
@@ -198,6 +225,10 @@ private:
     bool inWrite_ = false;
     /// Quiet mode flag.
     bool quiet_ = false;
+    /// Asynchronous mode flag.
+    bool async_ = false;
+    /// Behaviour of asynchronous mode when the message queue is full.
+    LogOverflowPolicy overflowPolicy_ = LOG_OVERFLOW_BLOCK;
 };
 
 #ifdef URHO3D_LOGGING
@@ -27,6 +27,15 @@
 #include "../IO/PackageFile.h"
 #include "../IO/FileSystem.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace Urho3D
 {
 
@@ -49,10 +58,15 @@ PackageFile::PackageFile(Context* context, const ea::string& fileName, unsigned
     Open(fileName, startOffset);
 }
 
-PackageFile::~PackageFile() = default;
+PackageFile::~PackageFile()
+{
+    UnmapMemory();
+}
 
 bool PackageFile::Open(const ea::string& fileName, unsigned startOffset)
 {
+    UnmapMemory();
+
     SharedPtr<File> file(new File(context_, fileName));
     if (!file->IsOpen())
         return false;
@@ -91,14 +105,21 @@ bool PackageFile::Open(const ea::string& fileName, unsigned startOffset)
     unsigned numFiles = file->ReadUInt();
     checksum_ = file->ReadUInt();
 
+    unsigned version = 0;
     if (id == "RPAK" || id == "RLZ4")
     {
         // New PAK file format includes two extra PAK header fields:
-        // * Version. At this time this field is unused and is always 0. It will be used in the future if PAK format needs to be extended.
+        // * Version. 0 for the original entry layout with SDBM checksums. 1 adds a block index to each entry of a compressed package,
+        //   so that seeks can jump to the right block, marks entries that are stored uncompressed with a zero block size, and uses
+        //   UpdateHash64() checksums.
         // * File list offset. New format writes file list in the end of the file. This allows PAK creation without knowing entire file list
         //   beforehand.
-        unsigned version = file->ReadUInt();                        // Reserved for future use.
-        assert(version == 0);
+        version = file->ReadUInt();
+        if (version > PACKAGE_FORMAT_VERSION)
+        {
+            URHO3D_LOGERROR(fileName + " has unsupported package format version " + ea::to_string(version));
+            return false;
+        }
         int64_t fileListOffset = file->ReadInt64();                 // New format has file list at the end of the file.
         file->Seek(fileListOffset);                                 // TODO: Serializer/Deserializer do not support files bigger than 4 GB
     }
@@ -110,7 +131,39 @@ bool PackageFile::Open(const ea::string& fileName, unsigned startOffset)
         newEntry.offset_ = file->ReadUInt() + startOffset;
         totalDataSize_ += (newEntry.size_ = file->ReadUInt());
         newEntry.checksum_ = file->ReadUInt();
-        if (!compressed_ && newEntry.offset_ + newEntry.size_ > totalSize_)
+        newEntry.compressed_ = compressed_;
+        if (!version)
+        {
+            // Checksums of version 0 use the SDBM hash. Clear them, so File::GetChecksum() calculates a consistent one
+            newEntry.checksum_ = 0;
+        }
+        else if (compressed_)
+        {
+            // Block index: uncompressed block size, then the compressed size of each block including its header.
+            // A zero block size marks an entry that is stored uncompressed
+            newEntry.blockSize_ = file->ReadVLE();
+            if (!newEntry.blockSize_)
+                newEntry.compressed_ = false;
+        }
+        if (newEntry.compressed_ && version)
+        {
+            unsigned numBlocks = file->ReadVLE();
+            newEntry.blockOffsets_.resize(numBlocks + 1);
+            unsigned blockOffset = 0;
+            for (unsigned j = 0; j < numBlocks; ++j)
+            {
+                newEntry.blockOffsets_[j] = blockOffset;
+                blockOffset += file->ReadVLE();
+            }
+            newEntry.blockOffsets_[numBlocks] = blockOffset;
+
+            if (!newEntry.blockSize_ || (unsigned long long)numBlocks * newEntry.blockSize_ < newEntry.size_)
+            {
+                URHO3D_LOGERROR("File entry " + entryName + " has an invalid block index");
+                return false;
+            }
+        }
+        if (!newEntry.compressed_ && newEntry.offset_ + newEntry.size_ > totalSize_)
         {
             URHO3D_LOGERROR("File entry " + entryName + " outside package file");
             return false;
@@ -122,6 +175,82 @@ bool PackageFile::Open(const ea::string& fileName, unsigned startOffset)
     return true;
 }
 
+bool PackageFile::MapMemory()
+{
+    if (mappedData_)
+        return true;
+    if (fileName_.empty())
+        return false;
+
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileW(GetWideNativePath(fileName_).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    // The mapping keeps the file open
+    CloseHandle(fileHandle);
+    if (!mappingHandle)
+        return false;
+
+    void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (!data)
+    {
+        CloseHandle(mappingHandle);
+        return false;
+    }
+
+    mappingHandle_ = mappingHandle;
+#else
+    int fd = open(GetNativePath(fileName_).c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) != 0 || (unsigned long long)fileStat.st_size != totalSize_)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, totalSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file open
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+#endif
+
+    mappedData_ = static_cast<unsigned char*>(data);
+    mappedSize_ = totalSize_;
+    return true;
+}
+
+void PackageFile::UnmapMemory()
+{
+    if (!mappedData_)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(mappedData_);
+    CloseHandle(mappingHandle_);
+    mappingHandle_ = nullptr;
+#else
+    munmap(mappedData_, mappedSize_);
+#endif
+
+    mappedData_ = nullptr;
+    mappedSize_ = 0;
+}
+
+const unsigned char* PackageFile::GetMappedData(const PackageEntry* entry) const
+{
+    if (!mappedData_ || !entry || entry->compressed_ || entry->offset_ + entry->size_ > mappedSize_)
+        return nullptr;
+
+    return mappedData_ + entry->offset_;
+}
+
 bool PackageFile::Exists(const ea::string& fileName) const
 {
     bool found = entries_.find(fileName) != entries_.end();
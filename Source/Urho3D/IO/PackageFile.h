@@ -27,6 +27,9 @@
 namespace Urho3D
 {
 
+/// Latest revision of the RPAK/RLZ4 package format. Revision 1 adds a block index to the entries of compressed packages, stores entries that do not shrink uncompressed and uses UpdateHash64() based checksums.
+static const unsigned PACKAGE_FORMAT_VERSION = 1;
+
 /// %File entry within the package file.
 struct PackageEntry
 {
@@ -36,6 +39,12 @@ struct PackageEntry
     unsigned size_;
     /// File checksum.
     unsigned checksum_;
+    /// Uncompressed size of each compressed block except the last. Zero if the entry has no block index.
+    unsigned blockSize_;
+    /// Offsets of the compressed blocks relative to the entry offset, followed by the total compressed size. Empty if the entry has no block index.
+    ea::vector<unsigned> blockOffsets_;
+    /// Whether the file data is compressed. Compressed packages may store data that does not compress well as is.
+    bool compressed_;
 };
 
 /// Stores files of a directory tree sequentially for convenient access.
@@ -53,6 +62,8 @@ public:
 
     /// Open the package file. Return true if successful.
     bool Open(const ea::string& fileName, unsigned startOffset = 0);
+    /// Map the package file to memory, so that uncompressed entries are read without copying through the file handle. Return true if successful.
+    bool MapMemory();
     /// Check if a file exists within the package file. This will be case-insensitive on Windows and case-sensitive on other platforms.
     bool Exists(const ea::string& fileName) const;
     /// Return the file entry corresponding to the name, or null if not found. This will be case-insensitive on Windows and case-sensitive on other platforms.
@@ -82,6 +93,12 @@ public:
     /// Return whether the files are compressed.
     bool IsCompressed() const { return compressed_; }
 
+    /// Return whether the package file is mapped to memory.
+    bool IsMemoryMapped() const { return mappedData_ != nullptr; }
+
+    /// Return the data of an uncompressed entry from the memory-mapped package, or null if not available. Remains valid while the package exists.
+    const unsigned char* GetMappedData(const PackageEntry* entry) const;
+
     /// Return list of file names in the package.
     const ea::vector<ea::string> GetEntryNames() const { return entries_.keys(); }
 
@@ -101,6 +118,9 @@ public:
     void Scan(ea::vector<ea::string>& result, const ea::string& pathName, const ea::string& filter, bool recursive) const;
 
 private:
+    /// Unmap the package file from memory.
+    void UnmapMemory();
+
     /// File entries.
     ea::unordered_map<ea::string, PackageEntry> entries_;
     /// File name.
@@ -113,6 +133,14 @@ private:
     unsigned totalDataSize_;
     /// Package file checksum.
     unsigned checksum_;
+    /// Memory-mapped package file data.
+    unsigned char* mappedData_{};
+    /// Size of the memory-mapped data.
+    unsigned mappedSize_{};
+#ifdef _WIN32
+    /// File mapping object handle.
+    void* mappingHandle_{};
+#endif
     /// Compressed flag.
     bool compressed_;
 };
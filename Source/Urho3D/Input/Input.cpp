@@ -2438,7 +2438,7 @@ void Input::HandleScreenMode(StringHash eventType, VariantMap& eventData)
     minimized_ = (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED) != 0;
 
     // Calculate input coordinate scaling from SDL window to backbuffer ratio
-    int winWidth, winHeight;
+    int winWidth = 0, winHeight = 0;
     int gfxWidth = graphics_->GetWidth();
     int gfxHeight = graphics_->GetHeight();
     SDL_GetWindowSize(window, &winWidth, &winHeight);
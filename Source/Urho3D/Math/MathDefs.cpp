@@ -24,6 +24,8 @@
 
 #include "../Math/MathDefs.h"
 
+#include <cstring>
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -42,4 +44,28 @@ void SinCos(float angle, float& sin, float& cos)
 #endif
 }
 
+unsigned long long UpdateHash64(unsigned long long hash, const void* data, unsigned size)
+{
+    static const unsigned long long prime1 = 0x9e3779b185ebca87ULL;
+    static const unsigned long long prime2 = 0xc2b2ae3d27d4eb4fULL;
+
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    const unsigned char* end = bytes + (size & ~7u);
+    for (; bytes != end; bytes += 8)
+    {
+        unsigned long long word;
+        memcpy(&word, bytes, sizeof word);
+        hash ^= word * prime2;
+        hash = ((hash << 31u) | (hash >> 33u)) * prime1;
+    }
+
+    // Remaining bytes, if any, are only hashed at the very end of the data
+    for (unsigned i = 0; i < (size & 7u); ++i)
+    {
+        hash ^= bytes[i] * prime1;
+        hash = ((hash << 11u) | (hash >> 53u)) * prime2;
+    }
+    return hash;
+}
+
 }
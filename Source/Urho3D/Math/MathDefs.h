@@ -280,6 +280,24 @@ inline unsigned CountSetBits(unsigned value)
 /// Update a hash with the given 8-bit value using the SDBM algorithm.
 inline constexpr unsigned SDBMHash(unsigned hash, unsigned char c) { return c + (hash << 6u) + (hash << 16u) - hash; }
 
+/// Initial value of a 64-bit hash. Zero must not be used, since zero data would leave a zero hash unchanged.
+static const unsigned long long HASH64_SEED = 0x27d4eb2f165667c5ULL;
+
+/// Update a 64-bit hash with a block of memory, eight bytes at a time. Start from HASH64_SEED. Hashing the data in pieces gives the same result as hashing it at once when every piece except the last is a multiple of eight bytes long. Pass the result to FinishHash64() before use.
+URHO3D_API unsigned long long UpdateHash64(unsigned long long hash, const void* data, unsigned size);
+
+/// Mix the total number of hashed bytes and all bits of a 64-bit hash returned by UpdateHash64(). Lower 32 bits of the result are suitable as a checksum.
+inline constexpr unsigned long long FinishHash64(unsigned long long hash, unsigned long long totalSize)
+{
+    hash ^= totalSize * 0x9e3779b185ebca87ULL;
+    hash ^= hash >> 33u;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33u;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33u;
+    return hash;
+}
+
 /// Return a random float between 0.0 (inclusive) and 1.0 (exclusive.)
 inline float Random() { return Rand() / 32768.0f; }
 
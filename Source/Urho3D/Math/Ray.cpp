@@ -22,6 +22,8 @@
 
 #include "../Precompiled.h"
 
+#include <EASTL/sort.h>
+
 #include "../Math/BoundingBox.h"
 #include "../Math/Frustum.h"
 #include "../Math/Ray.h"
@@ -467,4 +469,51 @@ Ray Ray::Transformed(const Matrix3x4& transform) const
     return ret;
 }
 
+/// Spread the lower 10 bits of a value so that there are two zero bits between each bit.
+static unsigned SpreadBits(unsigned value)
+{
+    value &= 0x3ffu;
+    value = (value | (value << 16u)) & 0x030000ffu;
+    value = (value | (value << 8u)) & 0x0300f00fu;
+    value = (value | (value << 4u)) & 0x030c30c3u;
+    value = (value | (value << 2u)) & 0x09249249u;
+    return value;
+}
+
+void GetCoherentRayOrder(const ea::vector<Ray>& rays, ea::vector<unsigned>& order)
+{
+    // Sort keys are stored with the ray index in the lower bits, kept between calls to avoid allocation
+    static thread_local ea::vector<unsigned long long> keys;
+
+    const unsigned numRays = rays.size();
+    order.resize(numRays);
+    if (!numRays)
+        return;
+
+    BoundingBox origins;
+    for (const Ray& ray : rays)
+        origins.Merge(ray.origin_);
+    const Vector3 size = origins.Size();
+    const Vector3 scale(size.x_ > M_EPSILON ? 511.0f / size.x_ : 0.0f, size.y_ > M_EPSILON ? 511.0f / size.y_ : 0.0f,
+        size.z_ > M_EPSILON ? 511.0f / size.z_ : 0.0f);
+
+    // Group the rays by direction octant first, then by the Morton code of the origin quantized to 9 bits per axis within
+    // the bounds of all origins
+    keys.resize(numRays);
+    for (unsigned i = 0; i < numRays; ++i)
+    {
+        const Ray& ray = rays[i];
+        const Vector3 cell = (ray.origin_ - origins.min_) * scale;
+        const unsigned morton = SpreadBits((unsigned)cell.x_) | (SpreadBits((unsigned)cell.y_) << 1u) |
+            (SpreadBits((unsigned)cell.z_) << 2u);
+        const unsigned octant = (ray.direction_.x_ < 0.0f ? 1u : 0u) | (ray.direction_.y_ < 0.0f ? 2u : 0u) |
+            (ray.direction_.z_ < 0.0f ? 4u : 0u);
+        keys[i] = ((unsigned long long)((octant << 27u) | morton) << 32u) | i;
+    }
+
+    ea::sort(keys.begin(), keys.end());
+    for (unsigned i = 0; i < numRays; ++i)
+        order[i] = (unsigned)keys[i];
+}
+
 }
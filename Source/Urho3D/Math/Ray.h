@@ -112,4 +112,7 @@ public:
     Vector3 direction_;
 };
 
+/// Fill order with the indices of the rays, sorted so that rays with nearby origins and similar directions are adjacent. Used to improve cache coherence of batched ray queries.
+URHO3D_API void GetCoherentRayOrder(const ea::vector<Ray>& rays, ea::vector<unsigned>& order);
+
 }
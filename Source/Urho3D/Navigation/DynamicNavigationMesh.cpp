@@ -27,6 +27,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
@@ -429,28 +430,8 @@ bool DynamicNavigationMesh::Build()
         }
 
         // Build each tile
-        unsigned numTiles = 0;
-
-        for (int z = 0; z < numTilesZ_; ++z)
-        {
-            for (int x = 0; x < numTilesX_; ++x)
-            {
-                TileCacheData tiles[TILECACHE_MAXLAYERS];
-                int layerCt = BuildTile(geometryList, x, z, tiles);
-                for (int i = 0; i < layerCt; ++i)
-                {
-                    dtCompressedTileRef tileRef;
-                    int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
-                    if (dtStatusFailed((dtStatus)status))
-                    {
-                        dtFree(tiles[i].data);
-                        tiles[i].data = nullptr;
-                    }
-                }
-                tileCache_->buildNavMeshTilesAt(x, z, navMesh_);
-                ++numTiles;
-            }
-        }
+        BuildTiles(geometryList, IntVector2::ZERO, IntVector2(numTilesX_ - 1, numTilesZ_ - 1));
+        const unsigned numTiles = numTilesX_ * numTilesZ_;
 
         // For a full build it's necessary to update the nav mesh
         // not doing so will cause dependent components to crash, like CrowdManager
@@ -825,6 +806,19 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
 
     tileCache_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
 
+    const int numLayers = BuildTileLayers(geometryList, x, z, tiles);
+    if (numLayers < 0)
+        return 0;
+
+    // Send a notification of the rebuild of this tile to anyone interested
+    SendTileRebuiltEvent(IntVector2(x, z));
+    return numLayers;
+}
+
+int DynamicNavigationMesh::BuildTileLayers(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles)
+{
+    URHO3D_PROFILE("BuildNavigationMeshTileLayers");
+
     const BoundingBox tileBoundingBox = GetTileBoundingBox(IntVector2(x, z));
 
     DynamicNavBuildData build(allocator_.get());
@@ -860,20 +854,20 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
     GetTileGeometry(&build, geometryList, expandedBox);
 
     if (build.vertices_.empty() || build.indices_.empty())
-        return 0; // Nothing to do
+        return -1; // Nothing to do
 
     build.heightField_ = rcAllocHeightfield();
     if (!build.heightField_)
     {
         URHO3D_LOGERROR("Could not allocate heightfield");
-        return 0;
+        return -1;
     }
 
     if (!rcCreateHeightfield(build.ctx_, *build.heightField_, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs,
         cfg.ch))
     {
         URHO3D_LOGERROR("Could not create heightfield");
-        return 0;
+        return -1;
     }
 
     unsigned numTriangles = build.indices_.size() / 3;
@@ -893,18 +887,18 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
     if (!build.compactHeightField_)
     {
         URHO3D_LOGERROR("Could not allocate create compact heightfield");
-        return 0;
+        return -1;
     }
     if (!rcBuildCompactHeightfield(build.ctx_, cfg.walkableHeight, cfg.walkableClimb, *build.heightField_,
         *build.compactHeightField_))
     {
         URHO3D_LOGERROR("Could not build compact heightfield");
-        return 0;
+        return -1;
     }
     if (!rcErodeWalkableArea(build.ctx_, cfg.walkableRadius, *build.compactHeightField_))
     {
         URHO3D_LOGERROR("Could not erode compact heightfield");
-        return 0;
+        return -1;
     }
 
     // area volumes
@@ -917,13 +911,13 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
         if (!rcBuildDistanceField(build.ctx_, *build.compactHeightField_))
         {
             URHO3D_LOGERROR("Could not build distance field");
-            return 0;
+            return -1;
         }
         if (!rcBuildRegions(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea,
             cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build regions");
-            return 0;
+            return -1;
         }
     }
     else
@@ -931,7 +925,7 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
         if (!rcBuildRegionsMonotone(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build monotone regions");
-            return 0;
+            return -1;
         }
     }
 
@@ -939,14 +933,14 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
     if (!build.heightFieldLayers_)
     {
         URHO3D_LOGERROR("Could not allocate height field layer set");
-        return 0;
+        return -1;
     }
 
     if (!rcBuildHeightfieldLayers(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.walkableHeight,
         *build.heightFieldLayers_))
     {
         URHO3D_LOGERROR("Could not build height field layers");
-        return 0;
+        return -1;
     }
 
     int retCt = 0;
@@ -978,61 +972,89 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
                 &(tiles[retCt].data), &tiles[retCt].dataSize)))
         {
             URHO3D_LOGERROR("Failed to build tile cache layers");
-            return 0;
+            for (int j = 0; j < retCt; ++j)
+                dtFree(tiles[j].data);
+            return -1;
         }
         else
             ++retCt;
     }
 
-    // Send a notification of the rebuild of this tile to anyone interested
-    {
-        using namespace NavigationAreaRebuilt;
-        VariantMap& eventData = GetContext()->GetEventDataMap();
-        eventData[P_NODE] = GetNode();
-        eventData[P_MESH] = this;
-        eventData[P_BOUNDSMIN] = Variant(tileBoundingBox.min_);
-        eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
-        SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
-    }
-
     return retCt;
 }
 
 unsigned DynamicNavigationMesh::BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
 {
-    unsigned numTiles = 0;
+    const IntVector2 size = to - from + IntVector2::ONE;
+    if (size.x_ <= 0 || size.y_ <= 0)
+        return 0;
+
+    struct TileLayers
+    {
+        ea::vector<TileCacheData> layers_;
+        bool built_{};
+    };
+
+    // Recast passes and compression of each tile use own build data and context, so tiles are built in parallel
+    ea::vector<TileLayers> tiles(size.x_ * size.y_);
+    const auto buildTiles = [&](unsigned begin, unsigned end, unsigned)
+    {
+        TileCacheData layers[TILECACHE_MAXLAYERS];
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const int x = from.x_ + static_cast<int>(i) % size.x_;
+            const int z = from.y_ + static_cast<int>(i) / size.x_;
+            const int numLayers = BuildTileLayers(geometryList, x, z, layers);
+            tiles[i].built_ = numLayers >= 0;
+            if (numLayers > 0)
+                tiles[i].layers_.assign(layers, layers + numLayers);
+        }
+    };
+
+    if (auto* queue = GetSubsystem<WorkQueue>())
+    {
+        UpdateGeometryTransforms(geometryList);
+        queue->ParallelFor(tiles.size(), 1, buildTiles);
+    }
+    else
+        buildTiles(0, tiles.size(), 0);
 
-    for (int z = from.y_; z <= to.y_; ++z)
+    // Modification of the tile cache and the Detour navigation mesh is serialized
+    URHO3D_PROFILE("AddNavigationMeshTiles");
+    unsigned numTiles = 0;
+    for (unsigned i = 0; i < tiles.size(); ++i)
     {
-        for (int x = from.x_; x <= to.x_; ++x)
+        const int x = from.x_ + static_cast<int>(i) % size.x_;
+        const int z = from.y_ + static_cast<int>(i) / size.x_;
+
+        dtCompressedTileRef existing[TILECACHE_MAXLAYERS];
+        const int existingCt = tileCache_->getTilesAt(x, z, existing, maxLayers_);
+        for (int j = 0; j < existingCt; ++j)
         {
-            dtCompressedTileRef existing[TILECACHE_MAXLAYERS];
-            const int existingCt = tileCache_->getTilesAt(x, z, existing, maxLayers_);
-            for (int i = 0; i < existingCt; ++i)
+            unsigned char* data = nullptr;
+            if (!dtStatusFailed(tileCache_->removeTile(existing[j], &data, nullptr)) && data != nullptr)
+                dtFree(data);
+        }
+
+        for (TileCacheData& layer : tiles[i].layers_)
+        {
+            dtCompressedTileRef tileRef;
+            int status = tileCache_->addTile(layer.data, layer.dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
+            if (dtStatusFailed((dtStatus)status))
             {
-                unsigned char* data = nullptr;
-                if (!dtStatusFailed(tileCache_->removeTile(existing[i], &data, nullptr)) && data != nullptr)
-                    dtFree(data);
+                dtFree(layer.data);
+                layer.data = nullptr;
             }
-
-            TileCacheData tiles[TILECACHE_MAXLAYERS];
-            int layerCt = BuildTile(geometryList, x, z, tiles);
-            for (int i = 0; i < layerCt; ++i)
+            else
             {
-                dtCompressedTileRef tileRef;
-                int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
-                if (dtStatusFailed((dtStatus)status))
-                {
-                    dtFree(tiles[i].data);
-                    tiles[i].data = nullptr;
-                }
-                else
-                {
-                    tileCache_->buildNavMeshTile(tileRef, navMesh_);
-                    ++numTiles;
-                }
+                tileCache_->buildNavMeshTile(tileRef, navMesh_);
+                ++numTiles;
             }
         }
+
+        // Send a notification of the rebuild of this tile to anyone interested
+        if (tiles[i].built_)
+            SendTileRebuiltEvent(IntVector2(x, z));
     }
 
     return numTiles;
@@ -117,7 +117,9 @@ protected:
 
     /// Build one tile of the navigation mesh. Return true if successful.
     int BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles);
-    /// Build tiles in the rectangular area. Return number of built tiles.
+    /// Build compressed tile cache layers of one tile without modifying the tile cache. May be called from a worker thread. Return number of layers, or -1 if the tile is empty or the build failed.
+    int BuildTileLayers(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles);
+    /// Build tiles in the rectangular area. Tile layers are built concurrently in the work queue, only adding them to the tile cache is serialized. Return number of built tile layers.
     unsigned BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
     /// Off-mesh connections to be rebuilt in the mesh processor.
     ea::vector<OffMeshConnection*> CollectOffMeshConnections(const BoundingBox& bounds);
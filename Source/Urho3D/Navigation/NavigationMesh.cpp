@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Geometry.h"
@@ -1299,6 +1300,36 @@ bool NavigationMesh::ReadTile(Deserializer& source, bool silent)
     return true;
 }
 
+void NavigationMesh::UpdateGeometryTransforms(ea::vector<NavigationGeometryInfo>& geometryList)
+{
+    // Node world transforms are evaluated lazily, which is not safe to happen concurrently
+    node_->GetWorldTransform();
+
+    for (const NavigationGeometryInfo& info : geometryList)
+    {
+        info.component_->GetNode()->GetWorldTransform();
+        if (info.component_->GetType() == OffMeshConnection::GetTypeStatic())
+        {
+            auto* connection = static_cast<OffMeshConnection*>(info.component_);
+            if (Node* endPoint = connection->GetEndPoint())
+                endPoint->GetWorldTransform();
+        }
+    }
+}
+
+void NavigationMesh::SendTileRebuiltEvent(const IntVector2& tile)
+{
+    const BoundingBox tileBoundingBox = GetTileBoundingBox(tile);
+
+    using namespace NavigationAreaRebuilt;
+    VariantMap& eventData = GetContext()->GetEventDataMap();
+    eventData[P_NODE] = GetNode();
+    eventData[P_MESH] = this;
+    eventData[P_BOUNDSMIN] = Variant(tileBoundingBox.min_);
+    eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
+    SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
+}
+
 bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z)
 {
     URHO3D_PROFILE("BuildNavigationMeshTile");
@@ -1306,6 +1337,39 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
     // Remove previous tile (if any)
     navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
 
+    unsigned char* navData = nullptr;
+    int navDataSize = 0;
+    if (!BuildTileData(geometryList, x, z, navData, navDataSize))
+        return false;
+
+    if (!navData)
+        return true; // Nothing to do
+
+    return AddTileData(x, z, navData, navDataSize);
+}
+
+bool NavigationMesh::AddTileData(int x, int z, unsigned char* navData, int navDataSize)
+{
+    if (dtStatusFailed(navMesh_->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, nullptr)))
+    {
+        URHO3D_LOGERROR("Failed to add navigation mesh tile");
+        dtFree(navData);
+        return false;
+    }
+
+    // Send a notification of the rebuild of this tile to anyone interested
+    SendTileRebuiltEvent(IntVector2(x, z));
+    return true;
+}
+
+bool NavigationMesh::BuildTileData(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z,
+    unsigned char*& navData, int& navDataSize)
+{
+    URHO3D_PROFILE("BuildNavigationMeshTileData");
+
+    navData = nullptr;
+    navDataSize = 0;
+
     const BoundingBox tileBoundingBox = GetTileBoundingBox(IntVector2(x, z));
 
     SimpleNavBuildData build;
@@ -1462,9 +1526,6 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
             build.polyMesh_->flags[i] = 0x1;
     }
 
-    unsigned char* navData = nullptr;
-    int navDataSize = 0;
-
     dtNavMeshCreateParams params;       // NOLINT(hicpp-member-init)
     memset(&params, 0, sizeof params);
     params.verts = build.polyMesh_->verts;
@@ -1507,38 +1568,68 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
         return false;
     }
 
-    if (dtStatusFailed(navMesh_->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, nullptr)))
-    {
-        URHO3D_LOGERROR("Failed to add navigation mesh tile");
-        dtFree(navData);
-        return false;
-    }
-
-    // Send a notification of the rebuild of this tile to anyone interested
-    {
-        using namespace NavigationAreaRebuilt;
-        VariantMap& eventData = GetContext()->GetEventDataMap();
-        eventData[P_NODE] = GetNode();
-        eventData[P_MESH] = this;
-        eventData[P_BOUNDSMIN] = Variant(tileBoundingBox.min_);
-        eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
-        SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
-    }
     return true;
 }
 
 unsigned NavigationMesh::BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
 {
+    const IntVector2 size = to - from + IntVector2::ONE;
+    if (size.x_ <= 0 || size.y_ <= 0)
+        return 0;
+
     unsigned numTiles = 0;
 
-    for (int z = from.y_; z <= to.y_; ++z)
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue)
     {
-        for (int x = from.x_; x <= to.x_; ++x)
+        for (int z = from.y_; z <= to.y_; ++z)
         {
-            if (BuildTile(geometryList, x, z))
-                ++numTiles;
+            for (int x = from.x_; x <= to.x_; ++x)
+            {
+                if (BuildTile(geometryList, x, z))
+                    ++numTiles;
+            }
         }
+        return numTiles;
     }
+
+    struct TileData
+    {
+        unsigned char* data_{};
+        int dataSize_{};
+        bool success_{};
+    };
+
+    // Recast passes of each tile use own build data and context, so tiles are built in parallel
+    UpdateGeometryTransforms(geometryList);
+    ea::vector<TileData> tiles(size.x_ * size.y_);
+    queue->ParallelFor(tiles.size(), 1, [&](unsigned begin, unsigned end, unsigned)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            TileData& tile = tiles[i];
+            const int x = from.x_ + static_cast<int>(i) % size.x_;
+            const int z = from.y_ + static_cast<int>(i) / size.x_;
+            tile.success_ = BuildTileData(geometryList, x, z, tile.data_, tile.dataSize_);
+        }
+    });
+
+    // Modification of the Detour navigation mesh is serialized
+    URHO3D_PROFILE("AddNavigationMeshTiles");
+    for (unsigned i = 0; i < tiles.size(); ++i)
+    {
+        const TileData& tile = tiles[i];
+        const int x = from.x_ + static_cast<int>(i) % size.x_;
+        const int z = from.y_ + static_cast<int>(i) / size.x_;
+
+        navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+        if (!tile.success_)
+            continue;
+
+        if (!tile.data_ || AddTileData(x, z, tile.data_, tile.dataSize_))
+            ++numTiles;
+    }
+
     return numTiles;
 }
 
@@ -289,9 +289,17 @@ protected:
     void GetTileGeometry(NavBuildData* build, ea::vector<NavigationGeometryInfo>& geometryList, BoundingBox& box);
     /// Add a triangle mesh to the geometry data.
     void AddTriMeshGeometry(NavBuildData* build, Geometry* geometry, const Matrix3x4& transform);
+    /// Make sure that world transforms read when building tiles are up to date, so that tiles can be built from worker threads.
+    void UpdateGeometryTransforms(ea::vector<NavigationGeometryInfo>& geometryList);
+    /// Send a notification of the rebuild of the tile.
+    void SendTileRebuiltEvent(const IntVector2& tile);
     /// Build one tile of the navigation mesh. Return true if successful.
     virtual bool BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z);
-    /// Build tiles in the rectangular area. Return number of built tiles.
+    /// Build Detour data of one tile without modifying the navigation mesh. May be called from a worker thread. Return true if successful. Data is null if the tile is empty.
+    bool BuildTileData(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, unsigned char*& navData, int& navDataSize);
+    /// Add Detour data of one tile to the navigation mesh and send the rebuild notification. Takes ownership of the data. Return true if successful.
+    bool AddTileData(int x, int z, unsigned char* navData, int navDataSize);
+    /// Build tiles in the rectangular area. Tile data is built concurrently in the work queue, only adding it to the navigation mesh is serialized. Return number of built tiles.
     unsigned BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
     /// Ensure that the navigation mesh query is initialized. Return true if successful.
     bool InitializeQuery();
@@ -22,6 +22,8 @@
 
 #include "../Precompiled.h"
 
+#include <EASTL/sort.h>
+
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
 #include "../IO/File.h"
@@ -57,6 +59,16 @@ namespace Urho3D
 {
 
 static const int STATS_INTERVAL_MSEC = 2000;
+/// Relevant nodes stay relevant until this far outside the interest radius, to avoid creating and removing nodes repeatedly at the boundary.
+static const float INTEREST_HYSTERESIS = 1.1f;
+
+/// Return the top-level ancestor of a node, which decides the relevance of the whole hierarchy.
+static Node* GetInterestRoot(Node* node)
+{
+    while (node->GetParent() && node->GetParent()->GetParent())
+        node = node->GetParent();
+    return node;
+}
 
 PackageDownload::PackageDownload() :
     totalFragments_(0),
@@ -103,6 +115,17 @@ void Connection::Initialize(bool isClient, const SLNet::AddressOrGUID& address,
     SetAddressOrGUID(address);
 }
 
+/// Send a message with RakNet packet reliability. Return the receipt number.
+static uint32_t SendPacket(SLNet::RakPeerInterface* peer, const SLNet::AddressOrGUID& address, int msgID,
+    PacketReliability reliability, const unsigned char* data, unsigned numBytes)
+{
+    VectorBuffer buffer;
+    buffer.WriteUByte((unsigned char)DefaultMessageIDTypes::ID_USER_PACKET_ENUM);
+    buffer.WriteUInt((unsigned int)msgID);
+    buffer.Write(data, numBytes);
+    return peer->Send((const char *) buffer.GetData(), (int) buffer.GetSize(), HIGH_PRIORITY, reliability, (char) 0, address, false);
+}
+
 void Connection::RegisterObject(Context* context)
 {
     context->RegisterFactory<Connection>();
@@ -122,13 +145,9 @@ void Connection::SendMessage(int msgID, bool reliable, bool inOrder, const unsig
         return;
     }
     
-    VectorBuffer buffer;
-    buffer.WriteUByte((unsigned char)DefaultMessageIDTypes::ID_USER_PACKET_ENUM);
-    buffer.WriteUInt((unsigned int)msgID);
-    buffer.Write(data, numBytes);
     PacketReliability reliability = reliable ? (inOrder ? RELIABLE_ORDERED : RELIABLE) : (inOrder ? UNRELIABLE_SEQUENCED : UNRELIABLE);
     if (peer_) {
-        peer_->Send((const char *) buffer.GetData(), (int) buffer.GetSize(), HIGH_PRIORITY, reliability, (char) 0, *address_, false);
+        SendPacket(peer_, *address_, msgID, reliability, data, numBytes);
         tempPacketCounter_.y_++;
     }
 }
@@ -187,11 +206,14 @@ void Connection::SetScene(Scene* newScene)
     if (isClient_)
     {
         sceneState_.Clear();
+        relevantNodes_.clear();
+        interestActive_ = false;
 
         // When scene is assigned on the server, instruct the client to load it. This may require downloading packages
         const ea::vector<SharedPtr<PackageFile> >& packages = scene_->GetRequiredPackageFiles();
         unsigned numPackages = packages.size();
         msg_.Clear();
+        msg_.WriteVLE(NETWORK_PROTOCOL_VERSION);
         msg_.WriteString(scene_->GetFileName());
         msg_.WriteVLE(numPackages);
         for (unsigned i = 0; i < numPackages; ++i)
@@ -235,6 +257,16 @@ void Connection::SetRotation(const Quaternion& rotation)
         sendMode_ = OPSM_POSITION_ROTATION;
 }
 
+void Connection::SetInterestRadius(float radius)
+{
+    interestRadius_ = Max(radius, 0.0f);
+}
+
+void Connection::SetRelevancyFilter(const RelevancyFilter& filter)
+{
+    relevancyFilter_ = filter;
+}
+
 void Connection::SetConnectPending(bool connectPending)
 {
     connectPending_ = connectPending;
@@ -255,6 +287,8 @@ void Connection::SendServerUpdate()
     if (!scene_ || !sceneLoaded_)
         return;
 
+    UpdateRelevantNodes();
+
     // Always check the root node (scene) first so that the scene-wide components get sent first,
     // and all other replicated nodes get added to the dirty set for sending the initial state
     unsigned sceneID = scene_->GetID();
@@ -369,6 +403,18 @@ void Connection::SendPackages()
     }
 }
 
+/// Queue a latest data update of an object that has not been received yet. Later updates can only be delta compressed against
+/// updates within the baseline window, so older ones are dropped and the queue stays bounded if the object never arrives.
+static void QueuePendingLatestData(ea::vector<ea::vector<unsigned char> >& pending, MemoryBuffer& msg)
+{
+    if (pending.size() >= NETWORK_BASELINE_WINDOW)
+        pending.erase(pending.begin());
+
+    ea::vector<unsigned char>& data = pending.emplace_back();
+    data.resize(msg.GetSize());
+    memcpy(&data[0], msg.GetData(), msg.GetSize());
+}
+
 void Connection::ProcessPendingLatestData()
 {
     if (!scene_ || !sceneLoaded_)
@@ -381,9 +427,13 @@ void Connection::ProcessPendingLatestData()
         Node* node = scene_->GetNode(current->first);
         if (node)
         {
-            MemoryBuffer msg(current->second);
-            msg.ReadNetID(); // Skip the node ID
-            node->ReadLatestDataUpdate(msg);
+            NetworkBaseline& baseline = nodeBaselines_[current->first];
+            for (const ea::vector<unsigned char>& data : current->second)
+            {
+                MemoryBuffer msg(data);
+                msg.ReadNetID(); // Skip the node ID
+                node->ReadLatestDataUpdate(msg, &baseline);
+            }
             // ApplyAttributes() is deliberately skipped, as Node has no attributes that require late applying.
             // Furthermore it would propagate to components and child nodes, which is not desired in this case
             nodeLatestData_.erase(current);
@@ -397,9 +447,15 @@ void Connection::ProcessPendingLatestData()
         Component* component = scene_->GetComponent(current->first);
         if (component)
         {
-            MemoryBuffer msg(current->second);
-            msg.ReadNetID(); // Skip the component ID
-            if (component->ReadLatestDataUpdate(msg))
+            NetworkBaseline& baseline = componentBaselines_[current->first];
+            bool changed = false;
+            for (const ea::vector<unsigned char>& data : current->second)
+            {
+                MemoryBuffer msg(data);
+                msg.ReadNetID(); // Skip the component ID
+                changed |= component->ReadLatestDataUpdate(msg, &baseline);
+            }
+            if (changed)
                 component->ApplyAttributes();
             componentLatestData_.erase(current);
         }
@@ -468,6 +524,40 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& msg)
     return processed;
 }
 
+void Connection::ProcessLatestDataReceipt(unsigned receipt, bool delivered)
+{
+    auto i = latestDataReceipts_.find(receipt);
+    if (i == latestDataReceipts_.end())
+        return;
+
+    const LatestDataReceipt latestData = i->second;
+    latestDataReceipts_.erase(i);
+    if (!delivered)
+        return;
+
+    auto j = sceneState_.nodeStates_.find(latestData.nodeID_);
+    if (j == sceneState_.nodeStates_.end())
+        return;
+
+    NetworkBaseline* baseline = &j->second.latestDataBaseline_;
+    if (latestData.componentID_)
+    {
+        auto k = j->second.componentStates_.find(latestData.componentID_);
+        if (k == j->second.componentStates_.end())
+            return;
+        baseline = &k->second.latestDataBaseline_;
+    }
+
+    // Receipts may arrive out of order, or for a replication state that has been replaced since
+    if (baseline->id_ == latestData.baselineID_ && (!baseline->hasAcked_ || (int)(latestData.sequence_ - baseline->ackedSequence_) > 0))
+    {
+        // Updates older than the acknowledged one are no longer compared against
+        baseline->ackedSequence_ = latestData.sequence_;
+        baseline->hasAcked_ = true;
+        baseline->DiscardOlder(latestData.sequence_);
+    }
+}
+
 void Connection::Ban()
 {
     if (peer_)
@@ -490,12 +580,23 @@ void Connection::ProcessLoadScene(int msgID, MemoryBuffer& msg)
         return;
     }
 
+    // Servers from before the protocol versioning start the message with the scene file name, which does not read as a valid version
+    const unsigned protocolVersion = msg.ReadVLE();
+    if (protocolVersion != NETWORK_PROTOCOL_VERSION)
+    {
+        URHO3D_LOGERROR("Server uses network protocol version {}, expected {}", protocolVersion, NETWORK_PROTOCOL_VERSION);
+        OnSceneLoadFailed();
+        return;
+    }
+
     // Store the scene file name we need to eventually load
     sceneFileName_ = msg.ReadString();
 
     // Clear previous pending latest data and package downloads if any
     nodeLatestData_.clear();
     componentLatestData_.clear();
+    nodeBaselines_.clear();
+    componentBaselines_.clear();
     downloads_.clear();
 
     // In case we have joined other scenes in this session, remove first all downloaded package files from the resource system
@@ -639,16 +740,14 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             Node* node = scene_->GetNode(nodeID);
             if (node)
             {
-                node->ReadLatestDataUpdate(msg);
+                node->ReadLatestDataUpdate(msg, &nodeBaselines_[nodeID]);
                 // ApplyAttributes() is deliberately skipped, as Node has no attributes that require late applying.
                 // Furthermore it would propagate to components and child nodes, which is not desired in this case
             }
             else
             {
                 // Latest data messages may be received out-of-order relative to node creation, so cache if necessary
-                ea::vector<unsigned char>& data = nodeLatestData_[nodeID];
-                data.resize(msg.GetSize());
-                memcpy(&data[0], msg.GetData(), msg.GetSize());
+                QueuePendingLatestData(nodeLatestData_[nodeID], msg);
             }
         }
         break;
@@ -660,6 +759,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             if (node)
                 node->Remove();
             nodeLatestData_.erase(nodeID);
+            nodeBaselines_.erase(nodeID);
         }
         break;
 
@@ -717,15 +817,13 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             Component* component = scene_->GetComponent(componentID);
             if (component)
             {
-                if (component->ReadLatestDataUpdate(msg))
+                if (component->ReadLatestDataUpdate(msg, &componentBaselines_[componentID]))
                     component->ApplyAttributes();
             }
             else
             {
                 // Latest data messages may be received out-of-order relative to component creation, so cache if necessary
-                ea::vector<unsigned char>& data = componentLatestData_[componentID];
-                data.resize(msg.GetSize());
-                memcpy(&data[0], msg.GetData(), msg.GetSize());
+                QueuePendingLatestData(componentLatestData_[componentID], msg);
             }
         }
         break;
@@ -737,6 +835,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             if (component)
                 component->Remove();
             componentLatestData_.erase(componentID);
+            componentBaselines_.erase(componentID);
         }
         break;
 
@@ -895,6 +994,15 @@ void Connection::ProcessIdentity(int msgID, MemoryBuffer& msg)
 
     identity_ = msg.ReadVariantMap();
 
+    // Clients from before the protocol versioning end the message after the identity
+    const unsigned protocolVersion = msg.IsEof() ? 0 : msg.ReadVLE();
+    if (protocolVersion != NETWORK_PROTOCOL_VERSION)
+    {
+        URHO3D_LOGERROR("Client {} uses network protocol version {}, expected {}", ToString(), protocolVersion, NETWORK_PROTOCOL_VERSION);
+        Disconnect();
+        return;
+    }
+
     using namespace ClientIdentity;
 
     VariantMap eventData = identity_;
@@ -1167,6 +1275,11 @@ void Connection::ProcessNode(unsigned nodeID)
             SendMessage(MSG_REMOVENODE, true, true, msg_);
             sceneState_.nodeStates_.erase(nodeID);
         }
+        else if (!IsNodeRelevant(node))
+        {
+            // The node was moved into an irrelevant hierarchy
+            RemoveIrrelevantNode(node);
+        }
         else
             ProcessExistingNode(node, i->second);
     }
@@ -1174,16 +1287,159 @@ void Connection::ProcessNode(unsigned nodeID)
     {
         // Replication state not found: this is a new node
         Node* node = scene_->GetNode(nodeID);
-        if (node)
+        if (node && IsNodeRelevant(node))
             ProcessNewNode(node);
         else
         {
-            // Did not find the new node (may have been created, then removed immediately): erase from dirty set.
+            // Did not find the new node (may have been created, then removed immediately), or it is not relevant
+            // to this connection: erase from dirty set. Irrelevant nodes are marked dirty again once they become relevant
             sceneState_.dirtyNodes_.erase(nodeID);
         }
     }
 }
 
+bool Connection::IsNodeRelevant(Node* node) const
+{
+    if (!interestActive_ || !node)
+        return true;
+
+    Node* root = GetInterestRoot(node);
+    return root == scene_.Get() || ea::binary_search(relevantNodes_.begin(), relevantNodes_.end(), root->GetID());
+}
+
+void Connection::UpdateRelevantNodes()
+{
+    const bool interestManaged = IsInterestManaged();
+    if (!interestManaged && !interestActive_)
+        return;
+
+    URHO3D_PROFILE("UpdateRelevantNodes");
+
+    const ea::vector<SharedPtr<Node> >& children = scene_->GetChildren();
+
+    if (!interestManaged)
+    {
+        // Interest management was disabled: every node is relevant again
+        for (auto i = children.begin(); i != children.end(); ++i)
+        {
+            if (!ea::binary_search(relevantNodes_.begin(), relevantNodes_.end(), (*i)->GetID()))
+                MarkRelevantNodeDirty(*i);
+        }
+        relevantNodes_.clear();
+        interestActive_ = false;
+        return;
+    }
+
+    // Gather candidates. Use the interest grid shared by all connections of the scene if it was updated for this update
+    interestCandidates_.clear();
+    const float queryRadius = interestRadius_ * INTEREST_HYSTERESIS;
+    const InterestGrid* grid = interestRadius_ > 0.0f ? GetSubsystem<Network>()->GetInterestGrid(scene_) : nullptr;
+    if (grid)
+        grid->Query(position_, queryRadius, interestCandidates_);
+    else
+    {
+        for (auto i = children.begin(); i != children.end(); ++i)
+        {
+            Node* node = *i;
+            if (node->IsReplicated() && (interestRadius_ <= 0.0f ||
+                (node->GetWorldPosition() - position_).LengthSquared() <= queryRadius * queryRadius))
+                interestCandidates_.push_back(node);
+        }
+    }
+
+    newRelevantNodes_.clear();
+    for (Node* node : interestCandidates_)
+    {
+        // Nodes entering the interest radius must come closer than the radius, the hysteresis only keeps relevant nodes
+        if (interestRadius_ > 0.0f && interestActive_ &&
+            (node->GetWorldPosition() - position_).LengthSquared() > interestRadius_ * interestRadius_ &&
+            !ea::binary_search(relevantNodes_.begin(), relevantNodes_.end(), node->GetID()))
+            continue;
+        if (relevancyFilter_ && !relevancyFilter_(this, node))
+            continue;
+
+        newRelevantNodes_.push_back(node->GetID());
+    }
+    ea::sort(newRelevantNodes_.begin(), newRelevantNodes_.end());
+
+    if (interestActive_)
+    {
+        // Diff against the previous update: create the entering hierarchies and remove the leaving ones. Nodes that were
+        // removed from the scene are handled by ProcessNode
+        auto oldIter = relevantNodes_.begin();
+        auto newIter = newRelevantNodes_.begin();
+        while (oldIter != relevantNodes_.end() || newIter != newRelevantNodes_.end())
+        {
+            if (newIter == newRelevantNodes_.end() || (oldIter != relevantNodes_.end() && *oldIter < *newIter))
+            {
+                if (Node* node = scene_->GetNode(*oldIter))
+                    RemoveIrrelevantNode(node);
+                ++oldIter;
+            }
+            else if (oldIter == relevantNodes_.end() || *newIter < *oldIter)
+            {
+                if (Node* node = scene_->GetNode(*newIter))
+                    MarkRelevantNodeDirty(node);
+                ++newIter;
+            }
+            else
+            {
+                ++oldIter;
+                ++newIter;
+            }
+        }
+    }
+    else
+    {
+        // Before interest management was enabled, all nodes were relevant
+        for (auto i = children.begin(); i != children.end(); ++i)
+        {
+            if (!ea::binary_search(newRelevantNodes_.begin(), newRelevantNodes_.end(), (*i)->GetID()))
+                RemoveIrrelevantNode(*i);
+        }
+    }
+
+    relevantNodes_.swap(newRelevantNodes_);
+    interestActive_ = true;
+}
+
+void Connection::MarkRelevantNodeDirty(Node* node)
+{
+    if (node->IsReplicated())
+        sceneState_.dirtyNodes_.insert(node->GetID());
+
+    const ea::vector<SharedPtr<Node> >& children = node->GetChildren();
+    for (auto i = children.begin(); i != children.end(); ++i)
+        MarkRelevantNodeDirty(*i);
+}
+
+void Connection::RemoveIrrelevantNode(Node* node)
+{
+    const unsigned nodeID = node->GetID();
+    sceneState_.dirtyNodes_.erase(nodeID);
+
+    auto i = sceneState_.nodeStates_.find(nodeID);
+    if (i != sceneState_.nodeStates_.end())
+    {
+        NodeReplicationState& nodeState = i->second;
+        for (auto j = nodeState.componentStates_.begin(); j != nodeState.componentStates_.end(); ++j)
+        {
+            if (Component* component = j->second.component_)
+                component->RemoveReplicationState(&j->second);
+        }
+        node->RemoveReplicationState(&nodeState);
+        sceneState_.nodeStates_.erase(i);
+
+        msg_.Clear();
+        msg_.WriteNetID(nodeID);
+        SendMessage(MSG_REMOVENODE, true, true, msg_);
+    }
+
+    const ea::vector<SharedPtr<Node> >& children = node->GetChildren();
+    for (auto j = children.begin(); j != children.end(); ++j)
+        RemoveIrrelevantNode(*j);
+}
+
 void Connection::ProcessNewNode(Node* node)
 {
     // Process depended upon nodes first, if they are dirty
@@ -1283,11 +1539,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
         // Send latestdata message if necessary
         if (hasLatestData)
         {
-            msg_.Clear();
-            msg_.WriteNetID(node->GetID());
-            node->WriteLatestDataUpdate(msg_, timeStamp_);
-
-            SendMessage(MSG_NODELATESTDATA, true, false, msg_, node->GetID());
+            SendLatestData(MSG_NODELATESTDATA, node, node->GetID(), 0, nodeState.latestDataBaseline_);
         }
 
         // Send deltaupdate if remaining dirty bits, or vars have changed
@@ -1361,11 +1613,8 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 // Send latestdata message if necessary
                 if (hasLatestData)
                 {
-                    msg_.Clear();
-                    msg_.WriteNetID(component->GetID());
-                    component->WriteLatestDataUpdate(msg_, timeStamp_);
-
-                    SendMessage(MSG_COMPONENTLATESTDATA, true, false, msg_, component->GetID());
+                    SendLatestData(MSG_COMPONENTLATESTDATA, component, node->GetID(), component->GetID(),
+                        componentState.latestDataBaseline_);
                 }
 
                 // Send deltaupdate if remaining dirty bits
@@ -1420,6 +1669,26 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     sceneState_.dirtyNodes_.erase(node->GetID());
 }
 
+void Connection::SendLatestData(int msgID, Serializable* serializable, unsigned nodeID, unsigned componentID,
+    NetworkBaseline& baseline)
+{
+    if (!baseline.id_)
+        baseline.id_ = nextBaselineID_++;
+
+    msg_.Clear();
+    msg_.WriteNetID(componentID ? componentID : nodeID);
+    serializable->WriteLatestDataUpdate(msg_, timeStamp_, &baseline);
+
+    if (peer_)
+    {
+        // The client acknowledges the update on delivery, after which it can be used as a delta compression baseline
+        const uint32_t receipt = SendPacket(peer_, *address_, msgID, RELIABLE_WITH_ACK_RECEIPT, msg_.GetData(), msg_.GetSize());
+        tempPacketCounter_.y_++;
+        if (baseline.hasSequence_)
+            latestDataReceipts_[receipt] = LatestDataReceipt{ nodeID, componentID, baseline.sequence_, baseline.id_ };
+    }
+}
+
 bool Connection::RequestNeededPackages(unsigned numPackages, MemoryBuffer& msg)
 {
     auto* cache = GetSubsystem<ResourceCache>();
@@ -45,6 +45,7 @@ namespace SLNet
 namespace Urho3D
 {
 
+class Connection;
 class File;
 class MemoryBuffer;
 class Node;
@@ -99,6 +100,19 @@ struct PackageUpload
     unsigned totalFragments_;
 };
 
+/// Latest data update sent with a delivery receipt. Delivered updates become delta compression baselines.
+struct LatestDataReceipt
+{
+    /// Node ID.
+    unsigned nodeID_;
+    /// Component ID, or 0 for the node itself.
+    unsigned componentID_;
+    /// Update sequence number.
+    unsigned sequence_;
+    /// Identifier of the baseline the update was written with.
+    unsigned baselineID_;
+};
+
 /// Send modes for observer position/rotation. Activated by the client setting either position or rotation.
 enum ObserverPositionSendMode
 {
@@ -107,6 +121,9 @@ enum ObserverPositionSendMode
     OPSM_POSITION_ROTATION
 };
 
+/// Custom relevancy filter for network interest management. Called on the server for each candidate top-level replicated node; return false to not replicate the node and its children to the connection.
+using RelevancyFilter = std::function<bool(Connection* connection, Node* node)>;
+
 /// %Connection to a remote network host.
 class URHO3D_API Connection : public Object
 {
@@ -141,6 +158,10 @@ public:
     void SetPosition(const Vector3& position);
     /// Set the observer rotation for interest management, to be sent to the server. Note: not used by the NetworkPriority component.
     void SetRotation(const Quaternion& rotation);
+    /// Set the interest management radius around the observer position. Top-level nodes further away are not replicated to this connection, along with their children. Zero (default) disables the distance test.
+    void SetInterestRadius(float radius);
+    /// Set custom relevancy filter for interest management. Pass an empty function to disable.
+    void SetRelevancyFilter(const RelevancyFilter& filter);
     /// Set the connection pending status. Called by Network.
     void SetConnectPending(bool connectPending);
     /// Set whether to log data in/out statistics.
@@ -159,6 +180,8 @@ public:
     void ProcessPendingLatestData();
     /// Process a message from the server or client. Called by Network.
     bool ProcessMessage(int msgID, MemoryBuffer& msg);
+    /// Process a delivery receipt of a latest data update. Called by Network.
+    void ProcessLatestDataReceipt(unsigned receipt, bool delivered);
     /// Ban this connections IP address.
     void Ban();
     /// Return the RakNet address/guid.
@@ -184,6 +207,18 @@ public:
     /// Return the observer rotation sent by the client for interest management.
     const Quaternion& GetRotation() const { return rotation_; }
 
+    /// Return the interest management radius.
+    float GetInterestRadius() const { return interestRadius_; }
+
+    /// Return whether interest management is enabled for this connection.
+    bool IsInterestManaged() const { return interestRadius_ > 0.0f || relevancyFilter_; }
+
+    /// Return whether a node is currently replicated to this connection according to interest management.
+    bool IsNodeRelevant(Node* node) const;
+
+    /// Return number of top-level nodes currently relevant to this connection. Only valid while interest management is enabled.
+    unsigned GetNumRelevantNodes() const { return relevantNodes_.size(); }
+
     /// Return whether is a client connection.
     bool IsClient() const { return isClient_; }
 
@@ -269,6 +304,14 @@ private:
     void ProcessNewNode(Node* node);
     /// Process a node that the client has already received.
     void ProcessExistingNode(Node* node, NodeReplicationState& nodeState);
+    /// Send a latest data update of a node or component with a delivery receipt.
+    void SendLatestData(int msgID, Serializable* serializable, unsigned nodeID, unsigned componentID, NetworkBaseline& baseline);
+    /// Update the set of relevant top-level nodes. Entering nodes are marked dirty for creation, leaving nodes are removed from the client.
+    void UpdateRelevantNodes();
+    /// Mark a node and its children dirty so that they get created on the client.
+    void MarkRelevantNodeDirty(Node* node);
+    /// Remove a node and its children from the client along with their replication states.
+    void RemoveIrrelevantNode(Node* node);
     /// Process a SyncPackagesInfo message from server.
     void ProcessPackageInfo(int msgID, MemoryBuffer& msg);
     /// Check a package list received from server and initiate package downloads as necessary. Return true on success, or false if failed to initialze downloads (cache dir not set)
@@ -292,12 +335,32 @@ private:
     ea::unordered_map<StringHash, PackageDownload> downloads_;
     /// Ongoing package send transfers.
     ea::unordered_map<StringHash, PackageUpload> uploads_;
-    /// Pending latest data for not yet received nodes.
-    ea::unordered_map<unsigned, ea::vector<unsigned char> > nodeLatestData_;
+    /// Pending latest data for not yet received nodes. The last updates within the baseline window are kept in order of arrival, as later ones may be delta compressed against earlier ones.
+    ea::unordered_map<unsigned, ea::vector<ea::vector<unsigned char> > > nodeLatestData_;
     /// Pending latest data for not yet received components.
-    ea::unordered_map<unsigned, ea::vector<unsigned char> > componentLatestData_;
+    ea::unordered_map<unsigned, ea::vector<ea::vector<unsigned char> > > componentLatestData_;
+    /// Latest data updates received for nodes. Used for delta compression.
+    ea::unordered_map<unsigned, NetworkBaseline> nodeBaselines_;
+    /// Latest data updates received for components. Used for delta compression.
+    ea::unordered_map<unsigned, NetworkBaseline> componentBaselines_;
+    /// Latest data updates sent and not yet acknowledged, by receipt number.
+    ea::unordered_map<unsigned, LatestDataReceipt> latestDataReceipts_;
+    /// Next baseline identifier.
+    unsigned nextBaselineID_{1};
     /// Node ID's to process during a replication update.
     ea::hash_set<unsigned> nodesToProcess_;
+    /// Sorted top-level node ID's relevant to this connection.
+    ea::vector<unsigned> relevantNodes_;
+    /// Sorted top-level node ID's relevant during the current update, diffed against the previous ones. Reused to avoid allocations.
+    ea::vector<unsigned> newRelevantNodes_;
+    /// Candidate nodes for interest management. Reused to avoid allocations.
+    ea::vector<Node*> interestCandidates_;
+    /// Custom relevancy filter.
+    RelevancyFilter relevancyFilter_;
+    /// Interest management radius.
+    float interestRadius_{};
+    /// Whether the relevant node set is in use.
+    bool interestActive_{};
     /// Reusable message buffer.
     VectorBuffer msg_;
     /// Queued remote events.
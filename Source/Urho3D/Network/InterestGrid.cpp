@@ -0,0 +1,200 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Network/InterestGrid.h"
+#include "../Scene/Scene.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Bias added to cell coordinates to keep them positive within the 21 bits reserved per axis.
+static const int CELL_COORDINATE_BIAS = 1 << 20;
+
+void InterestGrid::SetCellSize(float cellSize)
+{
+    cellSize = Max(cellSize, M_EPSILON);
+    if (cellSize != cellSize_)
+    {
+        cellSize_ = cellSize;
+        rebuild_ = true;
+    }
+}
+
+void InterestGrid::Update(Scene* scene)
+{
+    if (scene != scene_)
+    {
+        scene_ = scene;
+        rebuild_ = true;
+    }
+
+    if (!scene_)
+        return;
+
+    if (rebuild_)
+    {
+        Rebuild();
+        return;
+    }
+
+    // Nodes that moved, were created, reparented or removed since the last network update are marked for the update
+    const ea::hash_set<unsigned>& updateNodes = scene_->GetNetworkUpdateNodes();
+    for (auto i = updateNodes.begin(); i != updateNodes.end(); ++i)
+    {
+        Node* node = scene_->GetNode(*i);
+        if (node && node->GetParent() == scene_ && node->IsReplicated())
+            UpdateNode(node);
+        else
+            RemoveNode(*i);
+    }
+}
+
+void InterestGrid::Query(const Vector3& position, float radius, ea::vector<Node*>& result) const
+{
+    const float radiusSquared = radius * radius;
+
+    const int minX = GetCellCoordinate(position.x_ - radius);
+    const int minY = GetCellCoordinate(position.y_ - radius);
+    const int minZ = GetCellCoordinate(position.z_ - radius);
+    const int maxX = GetCellCoordinate(position.x_ + radius);
+    const int maxY = GetCellCoordinate(position.y_ + radius);
+    const int maxZ = GetCellCoordinate(position.z_ + radius);
+    const unsigned long long numCells = (unsigned long long)(maxX - minX + 1) * (maxY - minY + 1) * (maxZ - minZ + 1);
+
+    // When the query box spans more cells than are occupied, testing every entry is cheaper than probing cells
+    if (numCells >= cells_.size())
+    {
+        for (auto i = cells_.begin(); i != cells_.end(); ++i)
+        {
+            for (const Entry& entry : i->second)
+            {
+                if ((entry.position_ - position).LengthSquared() <= radiusSquared)
+                    result.push_back(entry.node_);
+            }
+        }
+        return;
+    }
+
+    for (int x = minX; x <= maxX; ++x)
+    {
+        for (int y = minY; y <= maxY; ++y)
+        {
+            for (int z = minZ; z <= maxZ; ++z)
+            {
+                auto cell = cells_.find(GetCellKey(x, y, z));
+                if (cell == cells_.end())
+                    continue;
+
+                for (const Entry& entry : cell->second)
+                {
+                    if ((entry.position_ - position).LengthSquared() <= radiusSquared)
+                        result.push_back(entry.node_);
+                }
+            }
+        }
+    }
+}
+
+void InterestGrid::Rebuild()
+{
+    cells_.clear();
+    nodes_.clear();
+    rebuild_ = false;
+
+    const ea::vector<SharedPtr<Node> >& children = scene_->GetChildren();
+    for (auto i = children.begin(); i != children.end(); ++i)
+    {
+        Node* node = *i;
+        if (node->IsReplicated())
+            UpdateNode(node);
+    }
+}
+
+void InterestGrid::UpdateNode(Node* node)
+{
+    const Vector3 position = node->GetWorldPosition();
+    const unsigned long long key = GetCellKey(position);
+
+    auto i = nodes_.find(node->GetID());
+    if (i != nodes_.end())
+    {
+        if (i->second.key_ == key)
+        {
+            Entry& entry = cells_[key][i->second.index_];
+            entry.position_ = position;
+            entry.node_ = node;
+            return;
+        }
+        RemoveNode(node->GetID());
+    }
+
+    ea::vector<Entry>& cell = cells_[key];
+    nodes_[node->GetID()] = Location{key, cell.size()};
+    cell.push_back(Entry{position, node, node->GetID()});
+}
+
+void InterestGrid::RemoveNode(unsigned nodeID)
+{
+    auto i = nodes_.find(nodeID);
+    if (i == nodes_.end())
+        return;
+
+    auto cell = cells_.find(i->second.key_);
+    ea::vector<Entry>& entries = cell->second;
+    const unsigned index = i->second.index_;
+    nodes_.erase(i);
+
+    // Move the last entry of the cell into the freed slot
+    if (index + 1 != entries.size())
+    {
+        entries[index] = entries.back();
+        nodes_[entries[index].nodeID_].index_ = index;
+    }
+    entries.pop_back();
+    if (entries.empty())
+        cells_.erase(cell);
+}
+
+unsigned long long InterestGrid::GetCellKey(const Vector3& position) const
+{
+    return GetCellKey(GetCellCoordinate(position.x_), GetCellCoordinate(position.y_), GetCellCoordinate(position.z_));
+}
+
+int InterestGrid::GetCellCoordinate(float value) const
+{
+    const float maxCoordinate = static_cast<float>(CELL_COORDINATE_BIAS - 1);
+    return FloorToInt(Clamp(value / cellSize_, -maxCoordinate, maxCoordinate));
+}
+
+unsigned long long InterestGrid::GetCellKey(int x, int y, int z)
+{
+    const auto ux = (unsigned long long)(x + CELL_COORDINATE_BIAS);
+    const auto uy = (unsigned long long)(y + CELL_COORDINATE_BIAS);
+    const auto uz = (unsigned long long)(z + CELL_COORDINATE_BIAS);
+    return ux | (uy << 21u) | (uz << 42u);
+}
+
+}
@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../Math/Vector3.h"
+
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Node;
+class Scene;
+
+/// Uniform spatial hash of the top-level replicated nodes of a scene, shared by all connections for network interest management. Child nodes inherit the relevance of their top-level ancestor. The grid is kept between network updates and only the nodes marked for a network update are moved between cells.
+class URHO3D_API InterestGrid
+{
+public:
+    /// Set cell size. Should be in the order of the typical interest radius. The grid is rebuilt on the next update if the size changes.
+    void SetCellSize(float cellSize);
+    /// Bring the grid up to date with a scene. Rebuilds the grid on the first update of a scene, otherwise only updates the nodes the scene has marked for a network update. Must be called before Scene::PrepareNetworkUpdate() clears them.
+    void Update(Scene* scene);
+    /// Append nodes within radius of a position to the result vector.
+    void Query(const Vector3& position, float radius, ea::vector<Node*>& result) const;
+
+    /// Return cell size.
+    float GetCellSize() const { return cellSize_; }
+    /// Return number of nodes in the grid.
+    unsigned GetNumNodes() const { return nodes_.size(); }
+
+private:
+    /// Grid entry.
+    struct Entry
+    {
+        /// World position of the node.
+        Vector3 position_;
+        /// Node.
+        Node* node_;
+        /// Node ID.
+        unsigned nodeID_;
+    };
+
+    /// Location of a node in the grid.
+    struct Location
+    {
+        /// Cell key.
+        unsigned long long key_;
+        /// Index of the entry in the cell.
+        unsigned index_;
+    };
+
+    /// Rebuild from the current positions of all top-level replicated nodes of the scene.
+    void Rebuild();
+    /// Insert a node or move it to the cell of its current position.
+    void UpdateNode(Node* node);
+    /// Remove a node if it is in the grid.
+    void RemoveNode(unsigned nodeID);
+    /// Return cell key of a world position.
+    unsigned long long GetCellKey(const Vector3& position) const;
+    /// Return cell coordinate of a world position component.
+    int GetCellCoordinate(float value) const;
+    /// Return cell key from cell coordinates.
+    static unsigned long long GetCellKey(int x, int y, int z);
+
+    /// Scene the grid was built from.
+    WeakPtr<Scene> scene_;
+    /// Entries by cell key.
+    ea::unordered_map<unsigned long long, ea::vector<Entry> > cells_;
+    /// Locations of the nodes by node ID.
+    ea::unordered_map<unsigned, Location> nodes_;
+    /// Cell size.
+    float cellSize_{64.0f};
+    /// Whether the grid must be rebuilt on the next update.
+    bool rebuild_{true};
+};
+
+}
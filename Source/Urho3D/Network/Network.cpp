@@ -586,6 +586,11 @@ void Network::SetUpdateFps(int fps)
     updateAcc_ = 0.0f;
 }
 
+void Network::SetInterestCellSize(float cellSize)
+{
+    interestCellSize_ = Max(cellSize, M_EPSILON);
+}
+
 void Network::SetSimulatedLatency(int ms)
 {
     simulatedLatency_ = Max(ms, 0);
@@ -673,6 +678,12 @@ Connection* Network::GetConnection(const SLNet::AddressOrGUID& connection) const
     }
 }
 
+const InterestGrid* Network::GetInterestGrid(Scene* scene) const
+{
+    auto i = interestGrids_.find(scene);
+    return i != interestGrids_.end() ? &i->second : nullptr;
+}
+
 Connection* Network::GetServerConnection() const
 {
     return serverConnection_;
@@ -832,6 +843,20 @@ void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
         SendEvent(E_NETWORKINVALIDPASSWORD);
         packetHandled = true;
     }
+    else if (packetID == ID_SND_RECEIPT_ACKED || packetID == ID_SND_RECEIPT_LOSS) // Delivery receipt of a latest data update
+    {
+        if (isServer && packet->length >= dataStart + sizeof(uint32_t))
+        {
+            Connection* connection = GetConnection(packet->systemAddress);
+            if (connection)
+            {
+                uint32_t receipt;
+                memcpy(&receipt, packet->data + dataStart, sizeof(receipt));
+                connection->ProcessLatestDataReceipt(receipt, packetID == ID_SND_RECEIPT_ACKED);
+            }
+        }
+        packetHandled = true;
+    }
     else if (packetID == ID_DOWNLOAD_PROGRESS) // Part of a file transfer
     {
         //URHO3D_LOGINFO("101010");
@@ -938,11 +963,38 @@ void Network::PostUpdate(float timeStep)
                 URHO3D_PROFILE("PrepareServerUpdate");
 
                 networkScenes_.clear();
+                interestScenes_.clear();
                 for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
                 {
                     Scene* scene = i->second->GetScene();
                     if (scene)
+                    {
                         networkScenes_.insert(scene);
+                        if (i->second->GetInterestRadius() > 0.0f)
+                            interestScenes_.insert(scene);
+                    }
+                }
+
+
+                // Update the spatial grids once per scene, to be shared by all connections of that scene. The grids read the
+                // nodes marked for the network update, so this must happen before preparing the update clears them
+                {
+                    URHO3D_PROFILE("UpdateInterestGrids");
+
+                    for (auto i = interestGrids_.begin(); i != interestGrids_.end();)
+                    {
+                        if (!interestScenes_.contains(i->first))
+                            i = interestGrids_.erase(i);
+                        else
+                            ++i;
+                    }
+
+                    for (auto i = interestScenes_.begin(); i != interestScenes_.end(); ++i)
+                    {
+                        InterestGrid& grid = interestGrids_[*i];
+                        grid.SetCellSize(interestCellSize_);
+                        grid.Update(*i);
+                    }
                 }
 
                 for (auto i = networkScenes_.begin(); i != networkScenes_.end(); ++i)
@@ -997,6 +1049,7 @@ void Network::OnServerConnected(const SLNet::AddressOrGUID& address)
     // Send the identity map now
     VectorBuffer msg;
     msg.WriteVariantMap(serverConnection_->GetIdentity());
+    msg.WriteVLE(NETWORK_PROTOCOL_VERSION);
     serverConnection_->SendMessage(MSG_IDENTITY, true, true, msg);
 
     SendEvent(E_SERVERCONNECTED);
@@ -27,6 +27,7 @@
 #include "../Core/Object.h"
 #include "../IO/VectorBuffer.h"
 #include "../Network/Connection.h"
+#include "../Network/InterestGrid.h"
 
 namespace Urho3D
 {
@@ -87,6 +88,8 @@ public:
     void BroadcastRemoteEvent(Node* node, StringHash eventType, bool inOrder, const VariantMap& eventData = Variant::emptyVariantMap);
     /// Set network update FPS.
     void SetUpdateFps(int fps);
+    /// Set cell size of the spatial grids used for distance-based interest management. Should be in the order of the connections' interest radius.
+    void SetInterestCellSize(float cellSize);
     /// Set simulated latency in milliseconds. This adds a fixed delay before sending each packet.
     void SetSimulatedLatency(int ms);
     /// Set simulated packet loss probability between 0.0 - 1.0.
@@ -108,6 +111,12 @@ public:
     /// Return network update FPS.
     int GetUpdateFps() const { return updateFps_; }
 
+    /// Return cell size of the interest management grids.
+    float GetInterestCellSize() const { return interestCellSize_; }
+
+    /// Return the interest management grid of a scene updated for the current server update, or null if no connection in the scene uses an interest radius.
+    const InterestGrid* GetInterestGrid(Scene* scene) const;
+
     /// Return simulated latency in milliseconds.
     int GetSimulatedLatency() const { return simulatedLatency_; }
 
@@ -163,6 +172,12 @@ private:
     ea::hash_set<StringHash> blacklistedRemoteEvents_;
     /// Networked scenes.
     ea::hash_set<Scene*> networkScenes_;
+    /// Networked scenes with distance-based interest management.
+    ea::hash_set<Scene*> interestScenes_;
+    /// Interest management grids by scene.
+    ea::unordered_map<Scene*, InterestGrid> interestGrids_;
+    /// Interest management grid cell size.
+    float interestCellSize_{64.0f};
     /// Update FPS.
     int updateFps_;
     /// Simulated latency (send delay) in milliseconds.
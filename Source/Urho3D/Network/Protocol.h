@@ -64,6 +64,10 @@ static const int MSG_REMOTENODEEVENT = 0x97;
 /// Server->client: info about package.
 static const int MSG_PACKAGEINFO = 0x98;
 
+/// Version of the scene replication protocol. The client sends it after its identity and the server at the start of LoadScene, so
+/// that peers of different versions refuse each other. Peers from before the versioning do not send it. Covers the latest data
+/// format, the types of the network attributes, and the File::GetChecksum() algorithm that scene checksums are compared with.
+static const unsigned NETWORK_PROTOCOL_VERSION = 1;
 /// Fixed content ID for client controls update.
 static const unsigned CONTROLS_CONTENT_ID = 1;
 /// Package file fragment size.
@@ -27,6 +27,10 @@
 namespace Urho3D
 {
 
+class Node;
+class PhysicsWorld;
+class RigidBody;
+
 /// Physics world is about to be stepped.
 URHO3D_EVENT(E_PHYSICSPRESTEP, PhysicsPreStep)
 {
@@ -65,6 +69,25 @@ URHO3D_EVENT(E_PHYSICSCOLLISION, PhysicsCollision)
     URHO3D_PARAM(P_CONTACTS, Contacts);            // Buffer containing position (Vector3), normal (Vector3), distance (float), impulse (float) for each contact
 }
 
+/// Typed physics collision ongoing. Sent right after E_PHYSICSCOLLISION.
+URHO3D_TYPED_EVENT(PhysicsCollisionArgs)
+{
+    /// Physics world.
+    PhysicsWorld* world_{};
+    /// First node.
+    Node* nodeA_{};
+    /// Second node.
+    Node* nodeB_{};
+    /// First rigid body.
+    RigidBody* bodyA_{};
+    /// Second rigid body.
+    RigidBody* bodyB_{};
+    /// Whether either body is a trigger.
+    bool trigger_{};
+    /// Contacts in the same layout as the P_CONTACTS buffer of E_PHYSICSCOLLISION. Valid only during the event.
+    const ea::vector<unsigned char>* contacts_{};
+};
+
 /// Physics collision ended. Global event sent by the PhysicsWorld.
 URHO3D_EVENT(E_PHYSICSCOLLISIONEND, PhysicsCollisionEnd)
 {
@@ -76,6 +99,14 @@ URHO3D_EVENT(E_PHYSICSCOLLISIONEND, PhysicsCollisionEnd)
     URHO3D_PARAM(P_TRIGGER, Trigger);              // bool
 }
 
+/// Batched contacts of the physics step are available from PhysicsWorld::GetContactPairs() and GetContactPoints(). Sent by the PhysicsWorld once per step when batched contacts are enabled.
+URHO3D_EVENT(E_PHYSICSCONTACTS, PhysicsContacts)
+{
+    URHO3D_PARAM(P_WORLD, World);                  // PhysicsWorld pointer
+    URHO3D_PARAM(P_NUMPAIRS, NumPairs);            // unsigned
+    URHO3D_PARAM(P_NUMPOINTS, NumPoints);          // unsigned
+}
+
 /// Node's physics collision started. Sent by scene nodes participating in a collision.
 URHO3D_EVENT(E_NODECOLLISIONSTART, NodeCollisionStart)
 {
@@ -27,6 +27,7 @@
 #include "../Core/Context.h"
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Model.h"
 #include "../IO/Log.h"
@@ -61,14 +62,145 @@ extern const char* SUBSYSTEM_CATEGORY;
 
 static const int MAX_SOLVER_ITERATIONS = 256;
 static const Vector3 DEFAULT_GRAVITY = Vector3(0.0f, -9.81f, 0.0f);
+static const unsigned RAYCAST_BATCH_SIZE = 16;
 
 PhysicsWorldConfig PhysicsWorld::config;
 
+/// Contact manifold of a rigid body pair, collected when building the batched contact data.
+struct ContactManifoldInfo
+{
+    /// Key of the body pair: lower body index in the high bits, higher body index in the low bits.
+    unsigned long long pairKey_;
+    /// Bullet manifold.
+    btPersistentManifold* manifold_;
+    /// Whether the manifold bodies are in reverse order.
+    bool flipped_;
+};
+
 static bool CompareRaycastResults(const PhysicsRaycastResult& lhs, const PhysicsRaycastResult& rhs)
 {
     return lhs.distance_ < rhs.distance_;
 }
 
+/// Return key of a rigid body pair in the batched contact data. The lower index must come first.
+static unsigned long long MakeContactPairKey(unsigned indexA, unsigned indexB)
+{
+    return (static_cast<unsigned long long>(indexA) << 32u) | indexB;
+}
+
+/// Broadphase callback of batched raycasts. Tests the ray against each collision object whose bounding box it overlaps, like btCollisionWorld::rayTest().
+struct BatchRayCallback : public btBroadphaseRayCallback
+{
+    /// Construct.
+    explicit BatchRayCallback(btCollisionWorld::ClosestRayResultCallback& resultCallback) :
+        resultCallback_(resultCallback)
+    {
+        rayFromTrans_.setIdentity();
+        rayFromTrans_.setOrigin(resultCallback.m_rayFromWorld);
+        rayToTrans_.setIdentity();
+        rayToTrans_.setOrigin(resultCallback.m_rayToWorld);
+    }
+
+    /// Test collision object of a broadphase proxy.
+    bool process(const btBroadphaseProxy* proxy) override
+    {
+        // Terminate once the ray can not get any closer
+        if (resultCallback_.m_closestHitFraction == 0.0f)
+            return false;
+
+        auto* collisionObject = static_cast<btCollisionObject*>(proxy->m_clientObject);
+        if (resultCallback_.needsCollision(collisionObject->getBroadphaseHandle()))
+        {
+            btCollisionWorld::rayTestSingle(rayFromTrans_, rayToTrans_, collisionObject, collisionObject->getCollisionShape(),
+                collisionObject->getWorldTransform(), resultCallback_);
+        }
+        return true;
+    }
+
+    /// Result callback.
+    btCollisionWorld::ClosestRayResultCallback& resultCallback_;
+    /// Ray start transform.
+    btTransform rayFromTrans_;
+    /// Ray end transform.
+    btTransform rayToTrans_;
+};
+
+/// Broadphase callback of batched convex sweeps. Tests the shape against each collision object whose bounding box the sweep overlaps, like btCollisionWorld::convexSweepTest().
+struct BatchSweepCallback : public btBroadphaseRayCallback
+{
+    /// Construct.
+    BatchSweepCallback(const btConvexShape* castShape, btCollisionWorld::ClosestConvexResultCallback& resultCallback) :
+        castShape_(castShape),
+        resultCallback_(resultCallback),
+        convexFromTrans_(btQuaternion::getIdentity(), resultCallback.m_convexFromWorld),
+        convexToTrans_(btQuaternion::getIdentity(), resultCallback.m_convexToWorld)
+    {
+    }
+
+    /// Test collision object of a broadphase proxy.
+    bool process(const btBroadphaseProxy* proxy) override
+    {
+        // Terminate once the sweep can not get any closer
+        if (resultCallback_.m_closestHitFraction == 0.0f)
+            return false;
+
+        auto* collisionObject = static_cast<btCollisionObject*>(proxy->m_clientObject);
+        if (resultCallback_.needsCollision(collisionObject->getBroadphaseHandle()))
+        {
+            btCollisionWorld::objectQuerySingle(castShape_, convexFromTrans_, convexToTrans_, collisionObject,
+                collisionObject->getCollisionShape(), collisionObject->getWorldTransform(), resultCallback_, 0.0f);
+        }
+        return true;
+    }
+
+    /// Swept shape.
+    const btConvexShape* castShape_;
+    /// Result callback.
+    btCollisionWorld::ClosestConvexResultCallback& resultCallback_;
+    /// Sweep start transform.
+    btTransform convexFromTrans_;
+    /// Sweep end transform.
+    btTransform convexToTrans_;
+};
+
+/// Dbvt leaf callback forwarding broadphase proxies to a ray callback.
+struct BatchLeafCollider : public btDbvt::ICollide
+{
+    /// Construct.
+    explicit BatchLeafCollider(btBroadphaseRayCallback& callback) :
+        callback_(callback)
+    {
+    }
+
+    /// Process a leaf node.
+    void Process(const btDbvtNode* leaf) override { callback_.process(static_cast<btBroadphaseProxy*>(leaf->data)); }
+
+    /// Ray callback.
+    btBroadphaseRayCallback& callback_;
+};
+
+/// Traverse the broadphase trees along a ray. Unlike btDbvtBroadphase::rayTest() this uses a per-thread traversal stack, so it may be called from several threads at once.
+static void BatchBroadphaseRayTest(const btDbvtBroadphase* broadphase, const btVector3& rayFrom, const btVector3& rayTo,
+    btBroadphaseRayCallback& callback, const btVector3& aabbMin, const btVector3& aabbMax)
+{
+    static thread_local btAlignedObjectArray<const btDbvtNode*> stack;
+
+    const btVector3 rayDir = (rayTo - rayFrom).normalized();
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        callback.m_rayDirectionInverse[i] = rayDir[i] == 0.0f ? btScalar(BT_LARGE_FLOAT) : 1.0f / rayDir[i];
+        callback.m_signs[i] = callback.m_rayDirectionInverse[i] < 0.0f;
+    }
+    callback.m_lambda_max = rayDir.dot(rayTo - rayFrom);
+
+    BatchLeafCollider collider(callback);
+    for (const btDbvt& set : broadphase->m_sets)
+    {
+        set.rayTestInternal(set.m_root, rayFrom, rayTo, callback.m_rayDirectionInverse, callback.m_signs,
+            callback.m_lambda_max, aabbMin, aabbMax, stack, collider);
+    }
+}
+
 void InternalPreTickCallback(btDynamicsWorld* world, btScalar timeStep)
 {
     static_cast<PhysicsWorld*>(world->getWorldUserInfo())->PreStep(timeStep);
@@ -213,6 +345,8 @@ void PhysicsWorld::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Interpolation", bool, interpolation_, true, AM_FILE);
     URHO3D_ATTRIBUTE("Internal Edge Utility", bool, internalEdge_, true, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Split Impulse", GetSplitImpulse, SetSplitImpulse, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Collision Events", GetCollisionEventsEnabled, SetCollisionEventsEnabled, bool, true, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Batched Contacts", GetBatchedContactsEnabled, SetBatchedContactsEnabled, bool, false, AM_DEFAULT);
 }
 
 bool PhysicsWorld::isVisible(const btVector3& aabbMin, const btVector3& aabbMax)
@@ -372,6 +506,32 @@ void PhysicsWorld::SetMaxNetworkAngularVelocity(float velocity)
     MarkNetworkUpdate();
 }
 
+void PhysicsWorld::SetCollisionEventsEnabled(bool enable)
+{
+    collisionEventsEnabled_ = enable;
+
+    // Forget the collision pairs, so that start events are sent again once re-enabled
+    if (!enable)
+    {
+        currentCollisions_.clear();
+        previousCollisions_.clear();
+    }
+}
+
+void PhysicsWorld::SetBatchedContactsEnabled(bool enable)
+{
+    batchedContactsEnabled_ = enable;
+
+    if (!enable)
+    {
+        contactPairs_.clear();
+        contactPoints_.clear();
+        contactManifolds_.clear();
+        previousContactPairs_.clear();
+        currentContactPairs_.clear();
+    }
+}
+
 void PhysicsWorld::Raycast(ea::vector<PhysicsRaycastResult>& result, const Ray& ray, float maxDistance, unsigned collisionMask)
 {
     URHO3D_PROFILE("PhysicsRaycast");
@@ -520,6 +680,123 @@ void PhysicsWorld::SphereCast(PhysicsRaycastResult& result, const Ray& ray, floa
     }
 }
 
+void PhysicsWorld::RaycastSingleBatch(ea::vector<PhysicsRaycastResult>& result, const ea::vector<Ray>& rays, float maxDistance,
+    unsigned collisionMask)
+{
+    URHO3D_PROFILE("PhysicsRaycastSingleBatch");
+
+    if (maxDistance >= M_INFINITY)
+        URHO3D_LOGWARNING("Infinite maxDistance in physics raycast is not supported");
+
+    const unsigned numRays = rays.size();
+    result.resize(numRays);
+    if (!numRays)
+        return;
+
+    // Process rays with nearby origins and similar directions together, so that they visit the same broadphase nodes
+    GetCoherentRayOrder(rays, batchOrder_);
+
+    const auto* broadphase = static_cast<const btDbvtBroadphase*>(broadphase_.get());
+    auto* queue = GetSubsystem<WorkQueue>();
+    queue->ParallelFor(numRays, RAYCAST_BATCH_SIZE, [&](unsigned begin, unsigned end, unsigned)
+    {
+        URHO3D_PROFILE("PhysicsRaycastSingleBatchWork");
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const unsigned index = batchOrder_[i];
+            const Ray& ray = rays[index];
+
+            btCollisionWorld::ClosestRayResultCallback
+                rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
+            rayCallback.m_collisionFilterGroup = (short)0xffff;
+            rayCallback.m_collisionFilterMask = (short)collisionMask;
+
+            BatchRayCallback broadphaseCallback(rayCallback);
+            BatchBroadphaseRayTest(broadphase, rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, broadphaseCallback,
+                btVector3(0.0f, 0.0f, 0.0f), btVector3(0.0f, 0.0f, 0.0f));
+
+            PhysicsRaycastResult& rayResult = result[index];
+            if (rayCallback.hasHit())
+            {
+                rayResult.position_ = ToVector3(rayCallback.m_hitPointWorld);
+                rayResult.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
+                rayResult.distance_ = (rayResult.position_ - ray.origin_).Length();
+                rayResult.hitFraction_ = rayCallback.m_closestHitFraction;
+                rayResult.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
+            }
+            else
+            {
+                rayResult.position_ = Vector3::ZERO;
+                rayResult.normal_ = Vector3::ZERO;
+                rayResult.distance_ = M_INFINITY;
+                rayResult.hitFraction_ = 0.0f;
+                rayResult.body_ = nullptr;
+            }
+        }
+    });
+}
+
+void PhysicsWorld::SphereCastBatch(ea::vector<PhysicsRaycastResult>& result, const ea::vector<Ray>& rays, float radius,
+    float maxDistance, unsigned collisionMask)
+{
+    URHO3D_PROFILE("PhysicsSphereCastBatch");
+
+    if (maxDistance >= M_INFINITY)
+        URHO3D_LOGWARNING("Infinite maxDistance in physics sphere cast is not supported");
+
+    const unsigned numRays = rays.size();
+    result.resize(numRays);
+    if (!numRays)
+        return;
+
+    GetCoherentRayOrder(rays, batchOrder_);
+
+    // The shape is only read by the worker threads
+    btSphereShape shape(radius);
+    btVector3 shapeAabbMin, shapeAabbMax;
+    shape.getAabb(btTransform::getIdentity(), shapeAabbMin, shapeAabbMax);
+
+    const auto* broadphase = static_cast<const btDbvtBroadphase*>(broadphase_.get());
+    auto* queue = GetSubsystem<WorkQueue>();
+    queue->ParallelFor(numRays, RAYCAST_BATCH_SIZE, [&](unsigned begin, unsigned end, unsigned)
+    {
+        URHO3D_PROFILE("PhysicsSphereCastBatchWork");
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const unsigned index = batchOrder_[i];
+            const Ray& ray = rays[index];
+            const Vector3 endPos = ray.origin_ + maxDistance * ray.direction_;
+
+            btCollisionWorld::ClosestConvexResultCallback
+                convexCallback(ToBtVector3(ray.origin_), ToBtVector3(endPos));
+            convexCallback.m_collisionFilterGroup = (short)0xffff;
+            convexCallback.m_collisionFilterMask = (short)collisionMask;
+
+            BatchSweepCallback broadphaseCallback(&shape, convexCallback);
+            BatchBroadphaseRayTest(broadphase, convexCallback.m_convexFromWorld, convexCallback.m_convexToWorld,
+                broadphaseCallback, shapeAabbMin, shapeAabbMax);
+
+            PhysicsRaycastResult& rayResult = result[index];
+            if (convexCallback.hasHit())
+            {
+                rayResult.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
+                rayResult.position_ = ToVector3(convexCallback.m_hitPointWorld);
+                rayResult.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
+                rayResult.distance_ = convexCallback.m_closestHitFraction * (endPos - ray.origin_).Length();
+                rayResult.hitFraction_ = convexCallback.m_closestHitFraction;
+            }
+            else
+            {
+                rayResult.body_ = nullptr;
+                rayResult.position_ = Vector3::ZERO;
+                rayResult.normal_ = Vector3::ZERO;
+                rayResult.distance_ = M_INFINITY;
+                rayResult.hitFraction_ = 0.0f;
+            }
+        }
+    });
+}
+
 void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, CollisionShape* shape, const Vector3& startPos,
     const Quaternion& startRot, const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask)
 {
@@ -687,6 +964,24 @@ void PhysicsWorld::GetCollidingBodies(ea::vector<RigidBody*>& result, const Rigi
 
     result.clear();
 
+    // Per-pair collision tracking is skipped when only batched contacts are enabled
+    if (!collisionEventsEnabled_)
+    {
+        for (const PhysicsContactPair& pair : contactPairs_)
+        {
+            if (pair.state_ == CONTACT_END)
+                continue;
+            RigidBody* other = nullptr;
+            if (pair.bodyA_ == body->GetWorldIndex())
+                other = GetRigidBodyByIndex(pair.bodyB_);
+            else if (pair.bodyB_ == body->GetWorldIndex())
+                other = GetRigidBodyByIndex(pair.bodyA_);
+            if (other)
+                result.push_back(other);
+        }
+        return;
+    }
+
     for (auto i = currentCollisions_.begin();
          i != currentCollisions_.end(); ++i)
     {
@@ -721,6 +1016,21 @@ bool PhysicsWorld::GetSplitImpulse() const
 void PhysicsWorld::AddRigidBody(RigidBody* body)
 {
     rigidBodies_.push_back(body);
+
+    // Reuse indices of removed bodies to keep the index range compact
+    unsigned index;
+    if (!freeRigidBodyIndices_.empty())
+    {
+        index = freeRigidBodyIndices_.back();
+        freeRigidBodyIndices_.pop_back();
+        rigidBodyIndices_[index] = body;
+    }
+    else
+    {
+        index = rigidBodyIndices_.size();
+        rigidBodyIndices_.push_back(body);
+    }
+    body->SetWorldIndex(index);
 }
 
 void PhysicsWorld::RemoveRigidBody(RigidBody* body)
@@ -728,6 +1038,29 @@ void PhysicsWorld::RemoveRigidBody(RigidBody* body)
     rigidBodies_.erase_first(body);
     // Remove possible dangling pointer from the delayedWorldTransforms structure
     delayedWorldTransforms_.erase(body);
+
+    const unsigned index = body->GetWorldIndex();
+    if (index >= rigidBodyIndices_.size() || rigidBodyIndices_[index] != body)
+        return;
+
+    // Forget the pairs of the body before its index is reused, so that a new body does not inherit them
+    if (!previousContactPairs_.empty())
+    {
+        previousContactPairs_.erase(ea::remove_if(previousContactPairs_.begin(), previousContactPairs_.end(),
+            [index](unsigned long long key) { return (key >> 32u) == index || (key & M_MAX_UNSIGNED) == index; }),
+            previousContactPairs_.end());
+    }
+    for (PhysicsContactPair& pair : contactPairs_)
+    {
+        if (pair.bodyA_ == index)
+            pair.bodyA_ = M_MAX_UNSIGNED;
+        if (pair.bodyB_ == index)
+            pair.bodyB_ = M_MAX_UNSIGNED;
+    }
+
+    rigidBodyIndices_[index] = nullptr;
+    freeRigidBodyIndices_.push_back(index);
+    body->SetWorldIndex(M_MAX_UNSIGNED);
 }
 
 void PhysicsWorld::AddCollisionShape(CollisionShape* shape)
@@ -829,10 +1162,56 @@ void PhysicsWorld::PostStep(float timeStep)
     SendEvent(E_PHYSICSPOSTSTEP, eventData);
 }
 
+static void WriteCollisionContacts(VectorBuffer& contacts, const ManifoldPair& manifolds, bool perspectiveB)
+{
+    contacts.Clear();
+
+    // "Pointers not flipped"-manifold, send unmodified normals from the perspective of body A
+    if (btPersistentManifold* contactManifold = manifolds.manifold_)
+    {
+        for (int j = 0; j < contactManifold->getNumContacts(); ++j)
+        {
+            btManifoldPoint& point = contactManifold->getContactPoint(j);
+            contacts.WriteVector3(ToVector3(point.m_positionWorldOnB));
+            contacts.WriteVector3(perspectiveB ? -ToVector3(point.m_normalWorldOnB) : ToVector3(point.m_normalWorldOnB));
+            contacts.WriteFloat(point.m_distance1);
+            contacts.WriteFloat(point.m_appliedImpulse);
+        }
+    }
+    // "Pointers flipped"-manifold, flip normals also
+    if (btPersistentManifold* contactManifold = manifolds.flippedManifold_)
+    {
+        for (int j = 0; j < contactManifold->getNumContacts(); ++j)
+        {
+            btManifoldPoint& point = contactManifold->getContactPoint(j);
+            contacts.WriteVector3(ToVector3(point.m_positionWorldOnB));
+            contacts.WriteVector3(perspectiveB ? ToVector3(point.m_normalWorldOnB) : -ToVector3(point.m_normalWorldOnB));
+            contacts.WriteFloat(point.m_distance1);
+            contacts.WriteFloat(point.m_appliedImpulse);
+        }
+    }
+}
+
 void PhysicsWorld::SendCollisionEvents()
 {
     URHO3D_PROFILE("SendCollisionEvents");
 
+    if (batchedContactsEnabled_)
+    {
+        CollectBatchedContacts();
+
+        using namespace PhysicsContacts;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_WORLD] = this;
+        eventData[P_NUMPAIRS] = contactPairs_.size();
+        eventData[P_NUMPOINTS] = contactPoints_.size();
+        SendEvent(E_PHYSICSCONTACTS, eventData);
+    }
+
+    if (!collisionEventsEnabled_)
+        return;
+
     currentCollisions_.clear();
     physicsCollisionData_.clear();
     nodeCollisionData_.clear();
@@ -902,46 +1281,15 @@ void PhysicsWorld::SendCollisionEvents()
             bool trigger = bodyA->IsTrigger() || bodyB->IsTrigger();
             bool newCollision = !previousCollisions_.contains(i->first);
 
-            physicsCollisionData_[PhysicsCollision::P_NODEA] = nodeA;
-            physicsCollisionData_[PhysicsCollision::P_NODEB] = nodeB;
-            physicsCollisionData_[PhysicsCollision::P_BODYA] = bodyA;
-            physicsCollisionData_[PhysicsCollision::P_BODYB] = bodyB;
-            physicsCollisionData_[PhysicsCollision::P_TRIGGER] = trigger;
-
-            contacts_.Clear();
-
-            // "Pointers not flipped"-manifold, send unmodified normals
-            btPersistentManifold* contactManifold = i->second.manifold_;
-            if (contactManifold)
-            {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
-                {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
-                }
-            }
-            // "Pointers flipped"-manifold, flip normals also
-            contactManifold = i->second.flippedManifold_;
-            if (contactManifold)
+            // Event data is only filled for the events that have receivers. Receivers may change while the events are sent,
+            // so each check happens right before the event
+            bool contactsWritten = false;
+            if (newCollision && HasEventReceivers(E_PHYSICSCOLLISIONSTART))
             {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
-                {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(-ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
-                }
-            }
+                WriteCollisionContacts(contacts_, i->second, false);
+                contactsWritten = true;
+                FillPhysicsCollisionData(nodeA, nodeB, bodyA, bodyB, trigger);
 
-            physicsCollisionData_[PhysicsCollision::P_CONTACTS] = contacts_.GetBuffer();
-
-            // Send separate collision start event if collision is new
-            if (newCollision)
-            {
                 SendEvent(E_PHYSICSCOLLISIONSTART, physicsCollisionData_);
                 // Skip rest of processing if either of the nodes or bodies is removed as a response to the event
                 if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
@@ -949,67 +1297,84 @@ void PhysicsWorld::SendCollisionEvents()
             }
 
             // Then send the ongoing collision event
-            SendEvent(E_PHYSICSCOLLISION, physicsCollisionData_);
-            if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
-                continue;
-
-            nodeCollisionData_[NodeCollision::P_BODY] = bodyA;
-            nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeB;
-            nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyB;
-            nodeCollisionData_[NodeCollision::P_TRIGGER] = trigger;
-            nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
-
-            if (newCollision)
+            if (HasEventReceivers(E_PHYSICSCOLLISION))
             {
-                nodeA->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
+                if (!contactsWritten)
+                {
+                    WriteCollisionContacts(contacts_, i->second, false);
+                    contactsWritten = true;
+                }
+                FillPhysicsCollisionData(nodeA, nodeB, bodyA, bodyB, trigger);
+
+                SendEvent(E_PHYSICSCOLLISION, physicsCollisionData_);
                 if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
                     continue;
             }
 
-            nodeA->SendEvent(E_NODECOLLISION, nodeCollisionData_);
-            if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
-                continue;
-
-            // Flip perspective to body B
-            contacts_.Clear();
-            contactManifold = i->second.manifold_;
-            if (contactManifold)
+            if (HasTypedEventSubscribers<PhysicsCollisionArgs>())
             {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
+                if (!contactsWritten)
                 {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(-ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
+                    WriteCollisionContacts(contacts_, i->second, false);
+                    contactsWritten = true;
                 }
+
+                PhysicsCollisionArgs collisionArgs;
+                collisionArgs.world_ = this;
+                collisionArgs.nodeA_ = nodeA;
+                collisionArgs.nodeB_ = nodeB;
+                collisionArgs.bodyA_ = bodyA;
+                collisionArgs.bodyB_ = bodyB;
+                collisionArgs.trigger_ = trigger;
+                collisionArgs.contacts_ = &contacts_.GetBuffer();
+                SendTypedEvent(collisionArgs);
+                if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+                    continue;
             }
-            contactManifold = i->second.flippedManifold_;
-            if (contactManifold)
+
+            if ((newCollision && nodeA->HasEventReceivers(E_NODECOLLISIONSTART)) || nodeA->HasEventReceivers(E_NODECOLLISION))
             {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
+                if (!contactsWritten)
+                    WriteCollisionContacts(contacts_, i->second, false);
+
+                nodeCollisionData_[NodeCollision::P_BODY] = bodyA;
+                nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeB;
+                nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyB;
+                nodeCollisionData_[NodeCollision::P_TRIGGER] = trigger;
+                nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
+
+                if (newCollision)
                 {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
+                    nodeA->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
+                    if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+                        continue;
                 }
-            }
 
-            nodeCollisionData_[NodeCollision::P_BODY] = bodyB;
-            nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeA;
-            nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyA;
-            nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
-
-            if (newCollision)
-            {
-                nodeB->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
+                nodeA->SendEvent(E_NODECOLLISION, nodeCollisionData_);
                 if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
                     continue;
             }
 
-            nodeB->SendEvent(E_NODECOLLISION, nodeCollisionData_);
+            if ((newCollision && nodeB->HasEventReceivers(E_NODECOLLISIONSTART)) || nodeB->HasEventReceivers(E_NODECOLLISION))
+            {
+                // Flip perspective to body B
+                WriteCollisionContacts(contacts_, i->second, true);
+
+                nodeCollisionData_[NodeCollision::P_BODY] = bodyB;
+                nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeA;
+                nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyA;
+                nodeCollisionData_[NodeCollision::P_TRIGGER] = trigger;
+                nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
+
+                if (newCollision)
+                {
+                    nodeB->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
+                    if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+                        continue;
+                }
+
+                nodeB->SendEvent(E_NODECOLLISION, nodeCollisionData_);
+            }
         }
     }
 
@@ -1075,6 +1440,112 @@ void PhysicsWorld::SendCollisionEvents()
     previousCollisions_ = currentCollisions_;
 }
 
+void PhysicsWorld::FillPhysicsCollisionData(Node* nodeA, Node* nodeB, RigidBody* bodyA, RigidBody* bodyB, bool trigger)
+{
+    physicsCollisionData_[PhysicsCollision::P_NODEA] = nodeA;
+    physicsCollisionData_[PhysicsCollision::P_NODEB] = nodeB;
+    physicsCollisionData_[PhysicsCollision::P_BODYA] = bodyA;
+    physicsCollisionData_[PhysicsCollision::P_BODYB] = bodyB;
+    physicsCollisionData_[PhysicsCollision::P_TRIGGER] = trigger;
+    physicsCollisionData_[PhysicsCollision::P_CONTACTS] = contacts_.GetBuffer();
+}
+
+void PhysicsWorld::CollectBatchedContacts()
+{
+    URHO3D_PROFILE("CollectBatchedContacts");
+
+    contactPairs_.clear();
+    contactPoints_.clear();
+    contactManifolds_.clear();
+    currentContactPairs_.clear();
+
+    const int numManifolds = collisionDispatcher_->getNumManifolds();
+    for (int i = 0; i < numManifolds; ++i)
+    {
+        btPersistentManifold* contactManifold = collisionDispatcher_->getManifoldByIndexInternal(i);
+        if (!contactManifold->getNumContacts())
+            continue;
+
+        auto* bodyA = static_cast<RigidBody*>(contactManifold->getBody0()->getUserPointer());
+        auto* bodyB = static_cast<RigidBody*>(contactManifold->getBody1()->getUserPointer());
+        if (!bodyA || !bodyB)
+            continue;
+
+        // Same filtering as with collision events
+        if (bodyA->GetMass() == 0.0f && bodyB->GetMass() == 0.0f)
+            continue;
+        if (bodyA->GetCollisionEventMode() == COLLISION_NEVER || bodyB->GetCollisionEventMode() == COLLISION_NEVER)
+            continue;
+        if (bodyA->GetCollisionEventMode() == COLLISION_ACTIVE && bodyB->GetCollisionEventMode() == COLLISION_ACTIVE &&
+            !bodyA->IsActive() && !bodyB->IsActive())
+            continue;
+
+        const unsigned indexA = bodyA->GetWorldIndex();
+        const unsigned indexB = bodyB->GetWorldIndex();
+        if (indexA < indexB)
+            contactManifolds_.push_back(ContactManifoldInfo{ MakeContactPairKey(indexA, indexB), contactManifold, false });
+        else
+            contactManifolds_.push_back(ContactManifoldInfo{ MakeContactPairKey(indexB, indexA), contactManifold, true });
+    }
+
+    // Sort by body pair, so that manifolds of the same pair are adjacent and pairs can be compared with the previous step
+    ea::sort(contactManifolds_.begin(), contactManifolds_.end(),
+        [](const ContactManifoldInfo& lhs, const ContactManifoldInfo& rhs) { return lhs.pairKey_ < rhs.pairKey_; });
+
+    const auto addPair = [&](unsigned long long key, PhysicsContactState state)
+    {
+        PhysicsContactPair pair;
+        pair.bodyA_ = static_cast<unsigned>(key >> 32u);
+        pair.bodyB_ = static_cast<unsigned>(key & M_MAX_UNSIGNED);
+        pair.firstPoint_ = contactPoints_.size();
+        pair.state_ = state;
+        pair.trigger_ = rigidBodyIndices_[pair.bodyA_]->IsTrigger() || rigidBodyIndices_[pair.bodyB_]->IsTrigger();
+        contactPairs_.push_back(pair);
+    };
+
+    // Pairs of the previous step that are not found in this step have ended. Removed bodies were already erased from them
+    auto previousIter = previousContactPairs_.begin();
+    for (unsigned i = 0; i < contactManifolds_.size();)
+    {
+        const unsigned long long key = contactManifolds_[i].pairKey_;
+        for (; previousIter != previousContactPairs_.end() && *previousIter < key; ++previousIter)
+            addPair(*previousIter, CONTACT_END);
+
+        if (previousIter != previousContactPairs_.end() && *previousIter == key)
+        {
+            addPair(key, CONTACT_STAY);
+            ++previousIter;
+        }
+        else
+            addPair(key, CONTACT_BEGIN);
+
+        for (; i < contactManifolds_.size() && contactManifolds_[i].pairKey_ == key; ++i)
+        {
+            btPersistentManifold* contactManifold = contactManifolds_[i].manifold_;
+            const float normalSign = contactManifolds_[i].flipped_ ? -1.0f : 1.0f;
+            for (int j = 0; j < contactManifold->getNumContacts(); ++j)
+            {
+                const btManifoldPoint& point = contactManifold->getContactPoint(j);
+
+                PhysicsContactPoint contactPoint;
+                contactPoint.position_ = ToVector3(contactManifolds_[i].flipped_ ? point.m_positionWorldOnA : point.m_positionWorldOnB);
+                contactPoint.normal_ = ToVector3(point.m_normalWorldOnB) * normalSign;
+                contactPoint.distance_ = point.m_distance1;
+                contactPoint.impulse_ = point.m_appliedImpulse;
+                contactPoints_.push_back(contactPoint);
+            }
+        }
+
+        PhysicsContactPair& pair = contactPairs_.back();
+        pair.numPoints_ = contactPoints_.size() - pair.firstPoint_;
+        currentContactPairs_.push_back(key);
+    }
+    for (; previousIter != previousContactPairs_.end(); ++previousIter)
+        addPair(*previousIter, CONTACT_END);
+
+    ea::swap(previousContactPairs_, currentContactPairs_);
+}
+
 void RegisterPhysicsLibrary(Context* context)
 {
     CollisionShape::RegisterObject(context);
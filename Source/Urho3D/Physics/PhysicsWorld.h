@@ -56,6 +56,7 @@ class Serializer;
 class XMLElement;
 
 struct CollisionGeometryData;
+struct ContactManifoldInfo;
 
 /// Physics raycast hit.
 struct URHO3D_API PhysicsRaycastResult
@@ -107,6 +108,47 @@ struct ManifoldPair
     btPersistentManifold* flippedManifold_;
 };
 
+/// State of a colliding rigid body pair in the batched contact data.
+enum PhysicsContactState : unsigned char
+{
+    /// Bodies started colliding on this step.
+    CONTACT_BEGIN = 0,
+    /// Bodies were colliding already on the previous step.
+    CONTACT_STAY,
+    /// Bodies stopped colliding on this step. There are no contact points.
+    CONTACT_END
+};
+
+/// Colliding rigid body pair of the last simulation step, as stored in the batched contact data.
+struct URHO3D_API PhysicsContactPair
+{
+    /// Index of the first rigid body, see PhysicsWorld::GetRigidBodyByIndex(). The lower index comes first. M_MAX_UNSIGNED if the body was removed after the step.
+    unsigned bodyA_{M_MAX_UNSIGNED};
+    /// Index of the second rigid body. M_MAX_UNSIGNED if the body was removed after the step.
+    unsigned bodyB_{M_MAX_UNSIGNED};
+    /// Index of the first contact point in the contact point array.
+    unsigned firstPoint_{};
+    /// Number of contact points.
+    unsigned numPoints_{};
+    /// Collision state.
+    PhysicsContactState state_{};
+    /// Whether either of the bodies is a trigger.
+    bool trigger_{};
+};
+
+/// Contact point of the last simulation step, as stored in the batched contact data. Normal points from the second body towards the first one.
+struct URHO3D_API PhysicsContactPoint
+{
+    /// Worldspace position on the second body.
+    Vector3 position_;
+    /// Worldspace normal.
+    Vector3 normal_;
+    /// Distance between the bodies. Negative when penetrating.
+    float distance_{};
+    /// Applied impulse.
+    float impulse_{};
+};
+
 /// Custom overrides of physics internals. To use overrides, must be set before the physics component is created.
 struct PhysicsWorldConfig
 {
@@ -184,6 +226,10 @@ public:
     void SetSplitImpulse(bool enable);
     /// Set maximum angular velocity for network replication.
     void SetMaxNetworkAngularVelocity(float velocity);
+    /// Set whether to send per-pair collision events with VariantMap data. Enabled by default.
+    void SetCollisionEventsEnabled(bool enable);
+    /// Set whether to collect contacts of each step into contiguous arrays and send E_PHYSICSCONTACTS. Disabled by default.
+    void SetBatchedContactsEnabled(bool enable);
     /// Perform a physics world raycast and return all hits.
     void Raycast
         (ea::vector<PhysicsRaycastResult>& result, const Ray& ray, float maxDistance, unsigned collisionMask = M_MAX_UNSIGNED);
@@ -195,6 +241,12 @@ public:
     /// Perform a physics world swept sphere test and return the closest hit.
     void SphereCast
         (PhysicsRaycastResult& result, const Ray& ray, float radius, float maxDistance, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform a physics world raycast for each ray and return the closest hits in the same order as the rays. The rays are processed in worker threads.
+    void RaycastSingleBatch(ea::vector<PhysicsRaycastResult>& result, const ea::vector<Ray>& rays, float maxDistance,
+        unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform a physics world swept sphere test for each ray and return the closest hits in the same order as the rays. The rays are processed in worker threads.
+    void SphereCastBatch(ea::vector<PhysicsRaycastResult>& result, const ea::vector<Ray>& rays, float radius, float maxDistance,
+        unsigned collisionMask = M_MAX_UNSIGNED);
     /// Perform a physics world swept convex test using a user-supplied collision shape and return the first hit.
     void ConvexCast(PhysicsRaycastResult& result, CollisionShape* shape, const Vector3& startPos, const Quaternion& startRot,
         const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask = M_MAX_UNSIGNED);
@@ -239,6 +291,21 @@ public:
     /// Return maximum angular velocity for network replication.
     float GetMaxNetworkAngularVelocity() const { return maxNetworkAngularVelocity_; }
 
+    /// Return whether per-pair collision events are sent.
+    bool GetCollisionEventsEnabled() const { return collisionEventsEnabled_; }
+
+    /// Return whether batched contacts are collected.
+    bool GetBatchedContactsEnabled() const { return batchedContactsEnabled_; }
+
+    /// Return colliding rigid body pairs of the last simulation step, including pairs that stopped colliding. Only collected when batched contacts are enabled.
+    const ea::vector<PhysicsContactPair>& GetContactPairs() const { return contactPairs_; }
+
+    /// Return contact points of the last simulation step, referenced by the contact pairs. Only collected when batched contacts are enabled.
+    const ea::vector<PhysicsContactPoint>& GetContactPoints() const { return contactPoints_; }
+
+    /// Return rigid body by the index used in the batched contact data, or null if the index is not in use.
+    RigidBody* GetRigidBodyByIndex(unsigned index) const { return index < rigidBodyIndices_.size() ? rigidBodyIndices_[index] : nullptr; }
+
     /// Add a rigid body to keep track of. Called by RigidBody.
     void AddRigidBody(RigidBody* body);
     /// Remove a rigid body. Called by RigidBody.
@@ -300,6 +367,10 @@ private:
     void PostStep(float timeStep);
     /// Send accumulated collision events.
     void SendCollisionEvents();
+    /// Fill event data of physics collision events from the collision pair and the contacts buffer.
+    void FillPhysicsCollisionData(Node* nodeA, Node* nodeB, RigidBody* bodyA, RigidBody* bodyB, bool trigger);
+    /// Collect contacts of the step into the batched contact arrays.
+    void CollectBatchedContacts();
 
     /// Bullet collision configuration.
     btCollisionConfiguration* collisionConfiguration_{};
@@ -315,6 +386,10 @@ private:
     WeakPtr<Scene> scene_;
     /// Rigid bodies in the world.
     ea::vector<RigidBody*> rigidBodies_;
+    /// Rigid bodies by the index used in the batched contact data. Null for unused indices.
+    ea::vector<RigidBody*> rigidBodyIndices_;
+    /// Unused rigid body indices.
+    ea::vector<unsigned> freeRigidBodyIndices_;
     /// Collision shapes in the world.
     ea::vector<CollisionShape*> collisionShapes_;
     /// Constraints in the world.
@@ -337,6 +412,18 @@ private:
     VariantMap nodeCollisionData_;
     /// Preallocated buffer for physics collision contact data.
     VectorBuffer contacts_;
+    /// Batched contact pairs of the last step.
+    ea::vector<PhysicsContactPair> contactPairs_;
+    /// Batched contact points of the last step.
+    ea::vector<PhysicsContactPoint> contactPoints_;
+    /// Contact manifolds of the last step sorted by body pair. Used to build batched contacts.
+    ea::vector<ContactManifoldInfo> contactManifolds_;
+    /// Colliding body pairs of the previous step as sorted keys of body indices. Used to detect begin and end of batched contacts.
+    ea::vector<unsigned long long> previousContactPairs_;
+    /// Colliding body pairs of the current step as sorted keys of body indices.
+    ea::vector<unsigned long long> currentContactPairs_;
+    /// Order in which the rays of batched queries are processed. Kept between queries to avoid allocation.
+    ea::vector<unsigned> batchOrder_;
     /// Simulation substeps per second.
     unsigned fps_{DEFAULT_FPS};
     /// Maximum number of simulation substeps per frame. 0 (default) unlimited, or negative values for adaptive timestep.
@@ -347,6 +434,10 @@ private:
     float maxNetworkAngularVelocity_{DEFAULT_MAX_NETWORK_ANGULAR_VELOCITY};
     /// Automatic simulation update enabled flag.
     bool updateEnabled_{true};
+    /// Per-pair collision events enabled flag.
+    bool collisionEventsEnabled_{true};
+    /// Batched contacts enabled flag.
+    bool batchedContactsEnabled_{};
     /// Interpolation flag.
     bool interpolation_{true};
     /// Use internal edge utility flag.
@@ -69,6 +69,7 @@ RigidBody::RigidBody(Context* context) :
     collisionLayer_(DEFAULT_COLLISION_LAYER),
     collisionMask_(DEFAULT_COLLISION_MASK),
     collisionEventMode_(COLLISION_ACTIVE),
+    worldIndex_(M_MAX_UNSIGNED),
     lastPosition_(Vector3::ZERO),
     lastRotation_(Quaternion::IDENTITY),
     kinematic_(false),
@@ -152,6 +152,11 @@ public:
     /// Return physics world.
     PhysicsWorld* GetPhysicsWorld() const { return physicsWorld_; }
 
+    /// Return index of the rigid body in the batched contact data of the physics world, or M_MAX_UNSIGNED if not in a physics world.
+    unsigned GetWorldIndex() const { return worldIndex_; }
+    /// Set index of the rigid body in the batched contact data. Called by PhysicsWorld.
+    void SetWorldIndex(unsigned index) { worldIndex_ = index; }
+
     /// Return Bullet rigid body.
     btRigidBody* GetBody() const { return body_.get(); }
 
@@ -291,6 +296,8 @@ private:
     unsigned collisionMask_;
     /// Collision event signaling mode.
     CollisionEventMode collisionEventMode_;
+    /// Index in the batched contact data of the physics world.
+    unsigned worldIndex_;
     /// Last interpolated position from the simulation.
     mutable Vector3 lastPosition_;
     /// Last interpolated rotation from the simulation.
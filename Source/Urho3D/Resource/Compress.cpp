@@ -0,0 +1,669 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/WorkQueue.h"
+#include "../Resource/Compress.h"
+
+namespace Urho3D
+{
+
+/// Minimum number of blocks for splitting image compression between worker threads.
+static const unsigned MIN_PARALLEL_COMPRESS_BLOCKS = 256;
+
+/// ETC1 intensity modifier tables. Pixel indices 0 and 1 add the modifiers, 2 and 3 subtract them.
+static const int ETC1_MODIFIERS[8][2] = {{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+
+/// Compress rows of blocks in batches. Large images are split between worker threads.
+template <class T> static void CompressBlockRows(WorkQueue* workQueue, unsigned numRows, unsigned blocksPerRow, const T& compressRows)
+{
+    if (workQueue && workQueue->GetNumThreads() > 0 && numRows > 1 && numRows * blocksPerRow >= MIN_PARALLEL_COMPRESS_BLOCKS)
+    {
+        const unsigned rowsPerBatch = Max(1u, MIN_PARALLEL_COMPRESS_BLOCKS / 4 / Max(1u, blocksPerRow));
+        workQueue->ParallelFor(numRows, rowsPerBatch, [&](unsigned begin, unsigned end, unsigned /*threadIndex*/)
+        {
+            compressRows(begin, end);
+        });
+    }
+    else
+        compressRows(0, numRows);
+}
+
+/// Gather a 4x4 block of RGBA pixels. Edge pixels are replicated if the image size is not a multiple of four.
+static void LoadBlockRGBA(unsigned char* block, const unsigned char* rgba, int width, int height, int x, int y)
+{
+    for (int py = 0; py < 4; ++py)
+    {
+        const unsigned char* row = rgba + 4 * width * Min(y + py, height - 1);
+        if (x + 4 <= width)
+            memcpy(block + 16 * py, row + 4 * x, 16);
+        else
+        {
+            for (int px = 0; px < 4; ++px)
+                memcpy(block + 16 * py + 4 * px, row + 4 * Min(x + px, width - 1), 4);
+        }
+    }
+}
+
+/// Return squared distance between two RGB colors.
+static inline int ColorDistance(const unsigned char* pixel, const int* color)
+{
+    const int r = pixel[0] - color[0];
+    const int g = pixel[1] - color[1];
+    const int b = pixel[2] - color[2];
+    return r * r + g * g + b * b;
+}
+
+/// Quantize RGB color to 565.
+static unsigned short Pack565(const int* color)
+{
+    const int r = (Clamp(color[0], 0, 255) * 31 + 127) / 255;
+    const int g = (Clamp(color[1], 0, 255) * 63 + 127) / 255;
+    const int b = (Clamp(color[2], 0, 255) * 31 + 127) / 255;
+    return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+/// Expand 565 color to 8 bits per channel like the decoder does.
+static void Unpack565(unsigned short value, int* color)
+{
+    const int r = (value >> 11) & 0x1f;
+    const int g = (value >> 5) & 0x3f;
+    const int b = value & 0x1f;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+/// Select the nearest four color codebook entry of each pixel for the given endpoints. Return the total squared error.
+static int SelectColorIndicesDXT(const unsigned char* rgba, unsigned short color0, unsigned short color1, unsigned& indices)
+{
+    int codes[4][3];
+    Unpack565(color0, codes[0]);
+    Unpack565(color1, codes[1]);
+    for (int c = 0; c < 3; ++c)
+    {
+        codes[2][c] = (2 * codes[0][c] + codes[1][c]) / 3;
+        codes[3][c] = (codes[0][c] + 2 * codes[1][c]) / 3;
+    }
+
+    int error = 0;
+    indices = 0;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        const unsigned char* pixel = rgba + 4 * i;
+        unsigned bestIndex = 0;
+        int bestDistance = ColorDistance(pixel, codes[0]);
+        for (unsigned j = 1; j < 4; ++j)
+        {
+            const int distance = ColorDistance(pixel, codes[j]);
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                bestIndex = j;
+            }
+        }
+        error += bestDistance;
+        indices |= bestIndex << (2 * i);
+    }
+    return error;
+}
+
+/// Find color endpoints along the principal axis of the block colors.
+static void FindPrincipalEndpointsDXT(const unsigned char* rgba, int* maxColor, int* minColor)
+{
+    float mean[3] = {};
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+            mean[c] += rgba[4 * i + c];
+    }
+    for (float& value : mean)
+        value /= 16.0f;
+
+    // Covariance matrix: rr, rg, rb, gg, gb, bb
+    float covariance[6] = {};
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        const float r = rgba[4 * i] - mean[0];
+        const float g = rgba[4 * i + 1] - mean[1];
+        const float b = rgba[4 * i + 2] - mean[2];
+        covariance[0] += r * r;
+        covariance[1] += r * g;
+        covariance[2] += r * b;
+        covariance[3] += g * g;
+        covariance[4] += g * b;
+        covariance[5] += b * b;
+    }
+
+    // Power iteration towards the principal axis, starting from the luminance direction
+    float axis[3] = {0.299f, 0.587f, 0.114f};
+    for (int iteration = 0; iteration < 4; ++iteration)
+    {
+        const float r = axis[0] * covariance[0] + axis[1] * covariance[1] + axis[2] * covariance[2];
+        const float g = axis[0] * covariance[1] + axis[1] * covariance[3] + axis[2] * covariance[4];
+        const float b = axis[0] * covariance[2] + axis[1] * covariance[4] + axis[2] * covariance[5];
+        const float length = Max(Max(Abs(r), Abs(g)), Abs(b));
+        // Keep the previous axis for blocks of a single color
+        if (length < M_EPSILON)
+            break;
+        axis[0] = r / length;
+        axis[1] = g / length;
+        axis[2] = b / length;
+    }
+
+    // Use the pixels with the extreme projections as endpoints
+    float minDot = M_INFINITY;
+    float maxDot = -M_INFINITY;
+    unsigned minIndex = 0;
+    unsigned maxIndex = 0;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        const float dot = rgba[4 * i] * axis[0] + rgba[4 * i + 1] * axis[1] + rgba[4 * i + 2] * axis[2];
+        if (dot < minDot)
+        {
+            minDot = dot;
+            minIndex = i;
+        }
+        if (dot > maxDot)
+        {
+            maxDot = dot;
+            maxIndex = i;
+        }
+    }
+
+    for (int c = 0; c < 3; ++c)
+    {
+        maxColor[c] = rgba[4 * maxIndex + c];
+        minColor[c] = rgba[4 * minIndex + c];
+    }
+}
+
+/// Refine color endpoints by least squares fit to the pixels for the given indices. Return false if the fit is degenerate.
+static bool RefineEndpointsDXT(const unsigned char* rgba, unsigned indices, int* color0, int* color1)
+{
+    // Weight of the first endpoint for each codebook index
+    static const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[3] = {}, bx[3] = {};
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        const float a = weights[(indices >> (2 * i)) & 3];
+        const float b = 1.0f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < 3; ++c)
+        {
+            ax[c] += a * rgba[4 * i + c];
+            bx[c] += b * rgba[4 * i + c];
+        }
+    }
+
+    const float determinant = aa * bb - ab * ab;
+    if (Abs(determinant) < M_EPSILON)
+        return false;
+
+    const float invDeterminant = 1.0f / determinant;
+    for (int c = 0; c < 3; ++c)
+    {
+        color0[c] = Clamp(RoundToInt((ax[c] * bb - bx[c] * ab) * invDeterminant), 0, 255);
+        color1[c] = Clamp(RoundToInt((bx[c] * aa - ax[c] * ab) * invDeterminant), 0, 255);
+    }
+    return true;
+}
+
+/// Compress the color part of a DXT block. Always uses the four color mode.
+static void CompressColorDXT(unsigned char* block, const unsigned char* rgba, CompressionQuality quality)
+{
+    int maxColor[3];
+    int minColor[3];
+
+    if (quality == COMPRESSION_FAST)
+    {
+        // Bounding box of the colors, inset slightly to reduce the error of the interpolated colors
+        for (int c = 0; c < 3; ++c)
+        {
+            maxColor[c] = 0;
+            minColor[c] = 255;
+            for (unsigned i = 0; i < 16; ++i)
+            {
+                maxColor[c] = Max(maxColor[c], (int)rgba[4 * i + c]);
+                minColor[c] = Min(minColor[c], (int)rgba[4 * i + c]);
+            }
+            const int inset = (maxColor[c] - minColor[c]) >> 4;
+            maxColor[c] -= inset;
+            minColor[c] += inset;
+        }
+    }
+    else
+        FindPrincipalEndpointsDXT(rgba, maxColor, minColor);
+
+    unsigned short color0 = Pack565(maxColor);
+    unsigned short color1 = Pack565(minColor);
+    unsigned indices = 0;
+    int error = SelectColorIndicesDXT(rgba, color0, color1, indices);
+
+    if (quality == COMPRESSION_HIGH)
+    {
+        for (int iteration = 0; iteration < 2 && error > 0; ++iteration)
+        {
+            int refined0[3];
+            int refined1[3];
+            if (!RefineEndpointsDXT(rgba, indices, refined0, refined1))
+                break;
+
+            const unsigned short refinedColor0 = Pack565(refined0);
+            const unsigned short refinedColor1 = Pack565(refined1);
+            unsigned refinedIndices = 0;
+            const int refinedError = SelectColorIndicesDXT(rgba, refinedColor0, refinedColor1, refinedIndices);
+            if (refinedError >= error)
+                break;
+
+            color0 = refinedColor0;
+            color1 = refinedColor1;
+            indices = refinedIndices;
+            error = refinedError;
+        }
+    }
+
+    // The four color mode requires the first endpoint to be greater. Swapping the endpoints swaps indices 0-1 and 2-3
+    if (color0 < color1)
+    {
+        ea::swap(color0, color1);
+        indices ^= 0x55555555;
+    }
+    else if (color0 == color1)
+        indices = 0;
+
+    block[0] = (unsigned char)(color0 & 0xff);
+    block[1] = (unsigned char)(color0 >> 8);
+    block[2] = (unsigned char)(color1 & 0xff);
+    block[3] = (unsigned char)(color1 >> 8);
+    for (unsigned i = 0; i < 4; ++i)
+        block[4 + i] = (unsigned char)(indices >> (8 * i));
+}
+
+/// Compress the alpha part of a DXT3 block.
+static void CompressAlphaDXT3(unsigned char* block, const unsigned char* rgba)
+{
+    for (unsigned i = 0; i < 8; ++i)
+    {
+        // Round to the nearest 4-bit value, which the decoder expands by multiplying with 17
+        const unsigned lo = (rgba[8 * i + 3] + 8) / 17;
+        const unsigned hi = (rgba[8 * i + 7] + 8) / 17;
+        block[i] = (unsigned char)(lo | (hi << 4));
+    }
+}
+
+/// Select the nearest DXT5 alpha codebook entry of each pixel for the given endpoints. Return the total squared error.
+static int SelectAlphaIndicesDXT5(const unsigned char* rgba, int alpha0, int alpha1, unsigned long long& indices)
+{
+    int codes[8];
+    codes[0] = alpha0;
+    codes[1] = alpha1;
+    if (alpha0 <= alpha1)
+    {
+        for (int i = 1; i < 5; ++i)
+            codes[1 + i] = ((5 - i) * alpha0 + i * alpha1) / 5;
+        codes[6] = 0;
+        codes[7] = 255;
+    }
+    else
+    {
+        for (int i = 1; i < 7; ++i)
+            codes[1 + i] = ((7 - i) * alpha0 + i * alpha1) / 7;
+    }
+
+    int error = 0;
+    indices = 0;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        const int alpha = rgba[4 * i + 3];
+        unsigned bestIndex = 0;
+        int bestDistance = (alpha - codes[0]) * (alpha - codes[0]);
+        for (unsigned j = 1; j < 8; ++j)
+        {
+            const int distance = (alpha - codes[j]) * (alpha - codes[j]);
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                bestIndex = j;
+            }
+        }
+        error += bestDistance;
+        indices |= (unsigned long long)bestIndex << (3 * i);
+    }
+    return error;
+}
+
+/// Compress the alpha part of a DXT5 block.
+static void CompressAlphaDXT5(unsigned char* block, const unsigned char* rgba, CompressionQuality quality)
+{
+    int minAlpha = 255;
+    int maxAlpha = 0;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        minAlpha = Min(minAlpha, (int)rgba[4 * i + 3]);
+        maxAlpha = Max(maxAlpha, (int)rgba[4 * i + 3]);
+    }
+
+    // Eight alpha codebook spanning the whole range
+    int alpha0 = maxAlpha;
+    int alpha1 = minAlpha;
+    unsigned long long indices = 0;
+    int error = SelectAlphaIndicesDXT5(rgba, alpha0, alpha1, indices);
+
+    // Six alpha codebook with explicit 0 and 255 spanning the remaining values, good for cutouts
+    if (quality == COMPRESSION_HIGH && error > 0)
+    {
+        int innerMin = 255;
+        int innerMax = 0;
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            const int alpha = rgba[4 * i + 3];
+            if (alpha != 0 && alpha != 255)
+            {
+                innerMin = Min(innerMin, alpha);
+                innerMax = Max(innerMax, alpha);
+            }
+        }
+        if (innerMin > innerMax)
+            innerMin = innerMax = 0;
+
+        unsigned long long innerIndices = 0;
+        const int innerError = SelectAlphaIndicesDXT5(rgba, innerMin, innerMax, innerIndices);
+        if (innerError < error)
+        {
+            alpha0 = innerMin;
+            alpha1 = innerMax;
+            indices = innerIndices;
+        }
+    }
+
+    block[0] = (unsigned char)alpha0;
+    block[1] = (unsigned char)alpha1;
+    for (unsigned i = 0; i < 6; ++i)
+        block[2 + i] = (unsigned char)(indices >> (8 * i));
+}
+
+void CompressImageDXT(unsigned char* blocks, const unsigned char* rgba, int width, int height, CompressedFormat format,
+    CompressionQuality quality, WorkQueue* workQueue)
+{
+    const unsigned bytesPerBlock = format == CF_DXT1 ? 8 : 16;
+    const unsigned blocksPerRow = (width + 3) / 4;
+    const unsigned numRows = (height + 3) / 4;
+
+    CompressBlockRows(workQueue, numRows, blocksPerRow, [&](unsigned begin, unsigned end)
+    {
+        unsigned char sourceRgba[4 * 16];
+        for (unsigned row = begin; row < end; ++row)
+        {
+            unsigned char* targetBlock = blocks + row * blocksPerRow * bytesPerBlock;
+            for (unsigned column = 0; column < blocksPerRow; ++column)
+            {
+                LoadBlockRGBA(sourceRgba, rgba, width, height, column * 4, row * 4);
+                if (format == CF_DXT3)
+                    CompressAlphaDXT3(targetBlock, sourceRgba);
+                else if (format == CF_DXT5)
+                    CompressAlphaDXT5(targetBlock, sourceRgba, quality);
+                CompressColorDXT(format == CF_DXT1 ? targetBlock : targetBlock + 8, sourceRgba, quality);
+                targetBlock += bytesPerBlock;
+            }
+        }
+    });
+}
+
+/// Candidate encoding of an ETC1 subblock.
+struct ETC1Subblock
+{
+    /// Total squared error.
+    int error_;
+    /// Modifier table index.
+    unsigned table_;
+    /// Pixel indices of the subblock pixels.
+    unsigned char indices_[8];
+};
+
+/// Find the best modifier table and pixel indices for a subblock of eight pixels with the given base color.
+static ETC1Subblock EncodeSubblockETC1(const unsigned char* const pixels[8], const int* baseColor)
+{
+    ETC1Subblock best;
+    best.error_ = M_MAX_INT;
+    best.table_ = 0;
+
+    for (unsigned table = 0; table < 8; ++table)
+    {
+        ETC1Subblock candidate;
+        candidate.error_ = 0;
+        candidate.table_ = table;
+
+        const int modifiers[4] = {ETC1_MODIFIERS[table][0], ETC1_MODIFIERS[table][1], -ETC1_MODIFIERS[table][0],
+            -ETC1_MODIFIERS[table][1]};
+        for (unsigned i = 0; i < 8 && candidate.error_ < best.error_; ++i)
+        {
+            int bestDistance = M_MAX_INT;
+            for (unsigned j = 0; j < 4; ++j)
+            {
+                const int color[3] = {Clamp(baseColor[0] + modifiers[j], 0, 255), Clamp(baseColor[1] + modifiers[j], 0, 255),
+                    Clamp(baseColor[2] + modifiers[j], 0, 255)};
+                const int distance = ColorDistance(pixels[i], color);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    candidate.indices_[i] = (unsigned char)j;
+                }
+            }
+            candidate.error_ += bestDistance;
+        }
+
+        if (candidate.error_ < best.error_)
+            best = candidate;
+    }
+
+    return best;
+}
+
+/// Compress a block to ETC1 in individual or differential mode, trying both subblock orientations.
+static void CompressBlockETC1(unsigned char* block, const unsigned char* rgba, CompressionQuality quality)
+{
+    int bestError = M_MAX_INT;
+    unsigned bestPart1 = 0;
+    unsigned bestPart2 = 0;
+
+    for (unsigned flip = 0; flip < 2; ++flip)
+    {
+        // Subblocks are the left and right halves, or the top and bottom halves if flipped
+        const unsigned char* pixels[2][8];
+        unsigned char pixelPositions[2][8];
+        unsigned counts[2] = {};
+        for (unsigned y = 0; y < 4; ++y)
+        {
+            for (unsigned x = 0; x < 4; ++x)
+            {
+                const unsigned subblock = flip ? y / 2 : x / 2;
+                pixels[subblock][counts[subblock]] = rgba + 4 * (y * 4 + x);
+                // Pixel indices are stored in column-major order
+                pixelPositions[subblock][counts[subblock]] = (unsigned char)(x * 4 + y);
+                ++counts[subblock];
+            }
+        }
+
+        float average[2][3] = {};
+        for (unsigned s = 0; s < 2; ++s)
+        {
+            for (unsigned i = 0; i < 8; ++i)
+            {
+                for (int c = 0; c < 3; ++c)
+                    average[s][c] += pixels[s][i][c] / 8.0f;
+            }
+        }
+
+        for (unsigned differential = 0; differential < 2; ++differential)
+        {
+            // Base colors are 4-bit per channel in individual mode, 5-bit with a 3-bit delta in differential mode
+            const int maxValue = differential ? 31 : 15;
+            int quantized[2][3];
+            for (unsigned s = 0; s < 2; ++s)
+            {
+                for (int c = 0; c < 3; ++c)
+                    quantized[s][c] = Clamp(RoundToInt(average[s][c] * maxValue / 255.0f), 0, maxValue);
+            }
+
+            if (differential)
+            {
+                // Clamp the second base color so that it is representable as a delta from the first
+                for (int c = 0; c < 3; ++c)
+                    quantized[1][c] = Clamp(quantized[1][c], quantized[0][c] - 4, quantized[0][c] + 3);
+            }
+            else if (quality == COMPRESSION_FAST)
+            {
+                // Prefer differential mode if the base colors are close enough, otherwise use individual mode
+                bool deltaFits = true;
+                for (int c = 0; c < 3; ++c)
+                {
+                    const int delta = RoundToInt(average[1][c] * 31 / 255.0f) - RoundToInt(average[0][c] * 31 / 255.0f);
+                    deltaFits &= delta >= -4 && delta <= 3;
+                }
+                if (deltaFits)
+                    continue;
+            }
+
+            ETC1Subblock subblocks[2];
+            for (unsigned s = 0; s < 2; ++s)
+            {
+                const auto expand = [&](const int* values, int* color)
+                {
+                    for (int c = 0; c < 3; ++c)
+                        color[c] = differential ? (values[c] << 3) | (values[c] >> 2) : values[c] | (values[c] << 4);
+                };
+
+                int baseColor[3];
+                expand(quantized[s], baseColor);
+                subblocks[s] = EncodeSubblockETC1(pixels[s], baseColor);
+
+                // Search neighboring base colors. The first base color of differential mode is kept to preserve the delta
+                if (quality == COMPRESSION_HIGH && !(differential && s == 0))
+                {
+                    // Step one channel at a time while the error decreases
+                    bool improved = true;
+                    for (int round = 0; round < 2 && improved; ++round)
+                    {
+                        improved = false;
+                        for (int step = 0; step < 6; ++step)
+                        {
+                            int candidate[3] = {quantized[s][0], quantized[s][1], quantized[s][2]};
+                            const int channel = step / 2;
+                            candidate[channel] += step % 2 ? 1 : -1;
+                            if (candidate[channel] < 0 || candidate[channel] > maxValue)
+                                continue;
+                            if (differential && (candidate[channel] - quantized[0][channel] < -4 || candidate[channel] - quantized[0][channel] > 3))
+                                continue;
+
+                            expand(candidate, baseColor);
+                            const ETC1Subblock result = EncodeSubblockETC1(pixels[s], baseColor);
+                            if (result.error_ < subblocks[s].error_)
+                            {
+                                subblocks[s] = result;
+                                quantized[s][channel] = candidate[channel];
+                                improved = true;
+                            }
+                        }
+                    }
+                }
+            }
+
+            const int error = subblocks[0].error_ + subblocks[1].error_;
+            if (error >= bestError)
+                continue;
+
+            // Pack base colors, in differential mode the second one as a 3-bit two's complement delta
+            unsigned colors[2][3];
+            for (int c = 0; c < 3; ++c)
+            {
+                colors[0][c] = (unsigned)quantized[0][c];
+                colors[1][c] = differential ? (unsigned)(quantized[1][c] - quantized[0][c]) & 7 : (unsigned)quantized[1][c];
+            }
+
+            unsigned part1;
+            if (differential)
+            {
+                part1 = (colors[0][0] << 27) | (colors[1][0] << 24) | (colors[0][1] << 19) | (colors[1][1] << 16) |
+                    (colors[0][2] << 11) | (colors[1][2] << 8);
+            }
+            else
+            {
+                part1 = (colors[0][0] << 28) | (colors[1][0] << 24) | (colors[0][1] << 20) | (colors[1][1] << 16) |
+                    (colors[0][2] << 12) | (colors[1][2] << 8);
+            }
+            part1 |= (subblocks[0].table_ << 5) | (subblocks[1].table_ << 2) | (differential << 1) | flip;
+
+            // Most significant bits of the pixel indices in the upper half, least significant bits in the lower half
+            unsigned part2 = 0;
+            for (unsigned s = 0; s < 2; ++s)
+            {
+                for (unsigned i = 0; i < 8; ++i)
+                {
+                    const unsigned index = subblocks[s].indices_[i];
+                    const unsigned position = pixelPositions[s][i];
+                    part2 |= ((index >> 1) << (16 + position)) | ((index & 1) << position);
+                }
+            }
+
+            bestError = error;
+            bestPart1 = part1;
+            bestPart2 = part2;
+        }
+    }
+
+    // Blocks are stored big-endian
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        block[i] = (unsigned char)(bestPart1 >> (24 - 8 * i));
+        block[4 + i] = (unsigned char)(bestPart2 >> (24 - 8 * i));
+    }
+}
+
+void CompressImageETC1(unsigned char* blocks, const unsigned char* rgba, int width, int height, CompressionQuality quality,
+    WorkQueue* workQueue)
+{
+    const unsigned blocksPerRow = (width + 3) / 4;
+    const unsigned numRows = (height + 3) / 4;
+
+    CompressBlockRows(workQueue, numRows, blocksPerRow, [&](unsigned begin, unsigned end)
+    {
+        unsigned char sourceRgba[4 * 16];
+        for (unsigned row = begin; row < end; ++row)
+        {
+            unsigned char* targetBlock = blocks + row * blocksPerRow * 8;
+            for (unsigned column = 0; column < blocksPerRow; ++column)
+            {
+                LoadBlockRGBA(sourceRgba, rgba, width, height, column * 4, row * 4);
+                CompressBlockETC1(targetBlock, sourceRgba, quality);
+                targetBlock += 8;
+            }
+        }
+    });
+}
+
+}
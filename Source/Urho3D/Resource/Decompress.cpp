@@ -22,8 +22,13 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/WorkQueue.h"
 #include "../Resource/Decompress.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 // ETC2 decompress
 typedef unsigned char uint8;
 typedef unsigned short uint16;
@@ -116,6 +121,23 @@ static void DecompressColourDXT(unsigned char* rgba, void const* block, bool isD
     codes[8 + 3] = 255;
     codes[12 + 3] = (unsigned char)((isDxt1 && a <= b) ? 0 : 255);
 
+#ifdef URHO3D_SSE
+    // select the codebook entry of a row of four pixels at once by comparing their indices
+    int palette[4];
+    memcpy(palette, codes, sizeof palette);
+    const __m128i indexMask = _mm_setr_epi32(0x03, 0x0c, 0x30, 0xc0);
+    const __m128i indexOne = _mm_setr_epi32(0x01, 0x04, 0x10, 0x40);
+    const __m128i indexTwo = _mm_setr_epi32(0x02, 0x08, 0x20, 0x80);
+    for (int i = 0; i < 4; ++i)
+    {
+        const __m128i indices = _mm_and_si128(_mm_set1_epi32(bytes[4 + i]), indexMask);
+        __m128i row = _mm_and_si128(_mm_cmpeq_epi32(indices, _mm_setzero_si128()), _mm_set1_epi32(palette[0]));
+        row = _mm_or_si128(row, _mm_and_si128(_mm_cmpeq_epi32(indices, indexOne), _mm_set1_epi32(palette[1])));
+        row = _mm_or_si128(row, _mm_and_si128(_mm_cmpeq_epi32(indices, indexTwo), _mm_set1_epi32(palette[2])));
+        row = _mm_or_si128(row, _mm_and_si128(_mm_cmpeq_epi32(indices, indexMask), _mm_set1_epi32(palette[3])));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + 16 * i), row);
+    }
+#else
     // unpack the indices
     unsigned char indices[16];
     for (int i = 0; i < 4; ++i)
@@ -136,6 +158,7 @@ static void DecompressColourDXT(unsigned char* rgba, void const* block, bool isD
         for (int j = 0; j < 4; ++j)
             rgba[4 * i + j] = codes[offset + j];
     }
+#endif
 }
 
 static void DecompressAlphaDXT3(unsigned char* rgba, void const* block)
@@ -229,54 +252,62 @@ static void DecompressDXT(unsigned char* rgba, const void* block, CompressedForm
         DecompressAlphaDXT5(rgba, alphaBock);
 }
 
-void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format)
+/// Minimum number of blocks for splitting image decompression between worker threads.
+static const unsigned MIN_PARALLEL_DECOMPRESS_BLOCKS = 4096;
+
+/// Decompress rows of blocks in batches. Large images are split between worker threads.
+template <class T> static void DecompressBlockRows(WorkQueue* workQueue, unsigned numRows, unsigned blocksPerRow, const T& decompressRows)
+{
+    if (workQueue && workQueue->GetNumThreads() > 0 && numRows > 1 && numRows * blocksPerRow >= MIN_PARALLEL_DECOMPRESS_BLOCKS)
+    {
+        const unsigned rowsPerBatch = Max(1u, MIN_PARALLEL_DECOMPRESS_BLOCKS / 4 / Max(1u, blocksPerRow));
+        workQueue->ParallelFor(numRows, rowsPerBatch, [&](unsigned begin, unsigned end, unsigned /*threadIndex*/)
+        {
+            decompressRows(begin, end);
+        });
+    }
+    else
+        decompressRows(0, numRows);
+}
+
+/// Copy a decompressed 4x4 RGBA block to the image, skipping pixels outside it.
+static void StoreBlockRGBA(unsigned char* rgba, const unsigned char* block, int width, int height, int x, int y)
+{
+    const int blockWidth = Min(width - x, 4);
+    const int blockHeight = Min(height - y, 4);
+    for (int py = 0; py < blockHeight; ++py)
+        memcpy(rgba + 4 * (width * (y + py) + x), block + 16 * py, 4 * blockWidth);
+}
+
+void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format,
+    WorkQueue* workQueue)
 {
     // initialise the block input
-    auto const* sourceBlock = reinterpret_cast< unsigned char const* >( blocks );
-    int bytesPerBlock = format == CF_DXT1 ? 8 : 16;
+    auto const* sourceBlocks = reinterpret_cast< unsigned char const* >( blocks );
+    const unsigned bytesPerBlock = format == CF_DXT1 ? 8 : 16;
+    const unsigned blocksPerRow = (width + 3) / 4;
+    const unsigned rowsPerSlice = (height + 3) / 4;
 
-    // loop over blocks
-    for (int z = 0; z < depth; ++z)
+    // loop over rows of blocks of all slices
+    DecompressBlockRows(workQueue, rowsPerSlice * depth, blocksPerRow, [&](unsigned begin, unsigned end)
     {
-        int sz = width * height * 4 * z;
-        for (int y = 0; y < height; y += 4)
+        for (unsigned row = begin; row < end; ++row)
         {
+            unsigned char* slice = rgba + width * height * 4 * (row / rowsPerSlice);
+            const int y = (row % rowsPerSlice) * 4;
+            unsigned char const* sourceBlock = sourceBlocks + row * blocksPerRow * bytesPerBlock;
             for (int x = 0; x < width; x += 4)
             {
-                // decompress the block
+                // decompress the block and write the pixels inside the image
                 unsigned char targetRgba[4 * 16];
                 DecompressDXT(targetRgba, sourceBlock, format);
-
-                // write the decompressed pixels to the correct image locations
-                unsigned char const* sourcePixel = targetRgba;
-                for (int py = 0; py < 4; ++py)
-                {
-                    for (int px = 0; px < 4; ++px)
-                    {
-                        // get the target location
-                        int sx = x + px;
-                        int sy = y + py;
-                        if (sx < width && sy < height)
-                        {
-                            unsigned char* targetPixel = rgba + sz + 4 * (width * sy + sx);
-
-                            // copy the rgba value
-                            for (int i = 0; i < 4; ++i)
-                                *targetPixel++ = *sourcePixel++;
-                        }
-                        else
-                        {
-                            // skip this pixel as its outside the image
-                            sourcePixel += 4;
-                        }
-                    }
-                }
+                StoreBlockRGBA(slice, targetRgba, width, height, x, y);
 
                 // advance
                 sourceBlock += bytesPerBlock;
             }
         }
-    }
+    });
 }
 
 // PVRTC decompression based on the Oolong Engine, modified for Urho3D
@@ -907,54 +938,46 @@ static void ReadBigEndian4byteWord(uint32_t* pBlock, const unsigned char *s)
 }
 
 // Use ETCPACK to decompress ETC texture.
-void DecompressImageETC(unsigned char* dstImage, const void* blocks, int width, int height, bool hasAlpha)
+void DecompressImageETC(unsigned char* dstImage, const void* blocks, int width, int height, bool hasAlpha, WorkQueue* workQueue)
 {
-    // ETCPACK initialization.
+    // ETCPACK initialization. Must be done before decompressing on worker threads.
     static const bool placeholder = []() { setupAlphaTable(); return true; }();
 
     const int channelCount = hasAlpha ? 4 : 3;
-    unsigned char* src = (unsigned char*)blocks;
-    unsigned int blockPart1, blockPart2;
+    const unsigned bytesPerBlock = hasAlpha ? 16 : 8;
+    auto* sourceBlocks = (unsigned char*)blocks;
 
     // ETCPACK write 4x4 blocks, so it needs padding.
     int w4 = ((width + 3) / 4);
     int h4 = ((height + 3) / 4);
 
-    unsigned char buffer4x4[4 * 4 * 4];
-
-    for (int y = 0; y < h4; ++y) 
+    DecompressBlockRows(workQueue, h4, w4, [&](unsigned begin, unsigned end)
     {
-        for (int x = 0; x < w4; ++x) 
-        {
-            memset(&buffer4x4[0], 0xFF, 4 * 4 * 4);
-            if (hasAlpha)
-            {
-                decompressBlockAlphaC(src, &buffer4x4[3], 4, 4, 0, 0, channelCount);
-                src += 8;
-            }
+        unsigned char buffer4x4[4 * 4 * 4];
+        unsigned int blockPart1, blockPart2;
 
-            ReadBigEndian4byteWord(&blockPart1, src);
-            src += 4;
-            ReadBigEndian4byteWord(&blockPart2, src);
-            src += 4;
-            decompressBlockETC2c(blockPart1, blockPart2, &buffer4x4[0], 4, 4, 0, 0, 4);
-
-            int wbuf = Min(width - x * 4, 4);
-            int hbuf = Min(height - y * 4, 4);
-            for(int dy = 0; dy < hbuf; ++dy)
+        for (int y = begin; y < (int)end; ++y)
+        {
+            unsigned char* src = sourceBlocks + y * w4 * bytesPerBlock;
+            for (int x = 0; x < w4; ++x)
             {
-                for (int dx = 0; dx < wbuf; ++dx)
+                memset(&buffer4x4[0], 0xFF, 4 * 4 * 4);
+                if (hasAlpha)
                 {
-                    int idst = ((y * 4 + dy) * width + x * 4 + dx) * 4;
-                    int ibuf = (dy * 4 + dx) * 4;
-                    dstImage[idst] = buffer4x4[ibuf];
-                    dstImage[idst + 1] = buffer4x4[ibuf + 1];
-                    dstImage[idst + 2] = buffer4x4[ibuf + 2];
-                    dstImage[idst + 3] = buffer4x4[ibuf + 3];
+                    decompressBlockAlphaC(src, &buffer4x4[3], 4, 4, 0, 0, channelCount);
+                    src += 8;
                 }
+
+                ReadBigEndian4byteWord(&blockPart1, src);
+                src += 4;
+                ReadBigEndian4byteWord(&blockPart2, src);
+                src += 4;
+                decompressBlockETC2c(blockPart1, blockPart2, &buffer4x4[0], 4, 4, 0, 0, 4);
+
+                StoreBlockRGBA(dstImage, buffer4x4, width, height, x * 4, y * 4);
             }
         }
-    }
+    });
 }
 
 }
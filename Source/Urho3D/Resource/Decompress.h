@@ -27,11 +27,14 @@
 namespace Urho3D
 {
 
-/// Decompress a DXT compressed image to RGBA.
-URHO3D_API void
-    DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format);
-/// Decompress an ETC1/ETC2 compressed image to RGBA.
-URHO3D_API void DecompressImageETC(unsigned char* dstImage, const void* blocks, int width, int height, bool hasAlpha);
+class WorkQueue;
+
+/// Decompress a DXT compressed image to RGBA. Rows of blocks are decompressed on the worker threads of the work queue if given.
+URHO3D_API void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format,
+    WorkQueue* workQueue = nullptr);
+/// Decompress an ETC1/ETC2 compressed image to RGBA. Rows of blocks are decompressed on the worker threads of the work queue if given.
+URHO3D_API void DecompressImageETC(unsigned char* dstImage, const void* blocks, int width, int height, bool hasAlpha,
+    WorkQueue* workQueue = nullptr);
 /// Decompress a PVRTC compressed image to RGBA.
 URHO3D_API void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, int height, CompressedFormat format);
 /// Flip a compressed block vertically.
@@ -24,9 +24,11 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../Resource/Compress.h"
 #include "../Resource/Decompress.h"
 
 #include <SDL/SDL_surface.h>
@@ -37,6 +39,9 @@
 #include <webp/encode.h>
 #include <webp/mux.h>
 #endif
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
 
 #include "../DebugNew.h"
 
@@ -214,7 +219,187 @@ struct DDSurfaceDesc2
     unsigned dwTextureStage_;
 };
 
-bool CompressedLevel::Decompress(unsigned char* dest)
+/// Minimum number of output pixels for splitting image processing between worker threads.
+static const unsigned MIN_PARALLEL_IMAGE_PIXELS = 256 * 256;
+
+/// Process rows of an image in batches. Large images are split between worker threads.
+template <class T> static void ProcessImageRows(Context* context, unsigned numRows, unsigned rowPixels, const T& processRows)
+{
+    WorkQueue* workQueue = context->GetWorkQueue();
+    if (workQueue && workQueue->GetNumThreads() > 0 && numRows > 1 && numRows * rowPixels >= MIN_PARALLEL_IMAGE_PIXELS)
+    {
+        const unsigned rowsPerBatch = Max(1u, MIN_PARALLEL_IMAGE_PIXELS / 4 / Max(1u, rowPixels));
+        workQueue->ParallelFor(numRows, rowsPerBatch, [&](unsigned begin, unsigned end, unsigned /*threadIndex*/)
+        {
+            processRows(begin, end);
+        });
+    }
+    else
+        processRows(0, numRows);
+}
+
+/// Average 2x2 pixel blocks of two rows into one row of half width. Each output channel is floor of the average.
+static void DownsampleRow2D(unsigned char* out, const unsigned char* inUpper, const unsigned char* inLower, int widthOut, unsigned components)
+{
+    int x = 0;
+#ifdef URHO3D_SSE
+    // Channels are widened to 16 bits so that the four-sample sums cannot overflow
+    const __m128i zero = _mm_setzero_si128();
+    switch (components)
+    {
+    case 1:
+    {
+        const __m128i ones = _mm_set1_epi16(1);
+        for (; x + 8 <= widthOut; x += 8)
+        {
+            const __m128i upper = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inUpper[x * 2]));
+            const __m128i lower = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inLower[x * 2]));
+            const __m128i sumLo = _mm_add_epi16(_mm_unpacklo_epi8(upper, zero), _mm_unpacklo_epi8(lower, zero));
+            const __m128i sumHi = _mm_add_epi16(_mm_unpackhi_epi8(upper, zero), _mm_unpackhi_epi8(lower, zero));
+            // Add horizontally adjacent pixels
+            const __m128i sum = _mm_packs_epi32(_mm_madd_epi16(sumLo, ones), _mm_madd_epi16(sumHi, ones));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[x]), _mm_packus_epi16(_mm_srli_epi16(sum, 2), zero));
+        }
+        break;
+    }
+
+    case 2:
+        for (; x + 4 <= widthOut; x += 4)
+        {
+            const __m128i upper = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inUpper[x * 4]));
+            const __m128i lower = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inLower[x * 4]));
+            const __m128i sumLo = _mm_add_epi16(_mm_unpacklo_epi8(upper, zero), _mm_unpacklo_epi8(lower, zero));
+            const __m128i sumHi = _mm_add_epi16(_mm_unpackhi_epi8(upper, zero), _mm_unpackhi_epi8(lower, zero));
+            // Each 32-bit lane holds one pixel, add even and odd lanes
+            const __m128i pairLo = _mm_add_epi16(_mm_shuffle_epi32(sumLo, _MM_SHUFFLE(2, 0, 2, 0)),
+                _mm_shuffle_epi32(sumLo, _MM_SHUFFLE(3, 1, 3, 1)));
+            const __m128i pairHi = _mm_add_epi16(_mm_shuffle_epi32(sumHi, _MM_SHUFFLE(2, 0, 2, 0)),
+                _mm_shuffle_epi32(sumHi, _MM_SHUFFLE(3, 1, 3, 1)));
+            const __m128i sum = _mm_unpacklo_epi64(pairLo, pairHi);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[x * 2]), _mm_packus_epi16(_mm_srli_epi16(sum, 2), zero));
+        }
+        break;
+
+    case 4:
+        for (; x + 2 <= widthOut; x += 2)
+        {
+            const __m128i upper = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inUpper[x * 8]));
+            const __m128i lower = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inLower[x * 8]));
+            const __m128i sumLo = _mm_add_epi16(_mm_unpacklo_epi8(upper, zero), _mm_unpacklo_epi8(lower, zero));
+            const __m128i sumHi = _mm_add_epi16(_mm_unpackhi_epi8(upper, zero), _mm_unpackhi_epi8(lower, zero));
+            // Each 64-bit half holds one pixel, add the halves of adjacent pixels
+            const __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(sumLo, sumHi), _mm_unpackhi_epi64(sumLo, sumHi));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[x * 4]), _mm_packus_epi16(_mm_srli_epi16(sum, 2), zero));
+        }
+        break;
+
+    default:
+        break;
+    }
+#endif
+
+    // Remaining pixels, and RGB images which do not map well to SSE2 lanes
+    for (unsigned i = x * components; i < widthOut * components; i += components)
+    {
+        for (unsigned c = 0; c < components; ++c)
+        {
+            out[i + c] = (unsigned char)(((unsigned)inUpper[i * 2 + c] + inUpper[i * 2 + components + c] +
+                                          inLower[i * 2 + c] + inLower[i * 2 + components + c]) >> 2);
+        }
+    }
+}
+
+/// Source pixel offsets and interpolation weight for one output column or row of Image::Resize.
+struct ResampleCoord
+{
+    /// Offset of the first source pixel.
+    unsigned offset0_;
+    /// Offset of the second source pixel.
+    unsigned offset1_;
+    /// Weight of the second source pixel.
+    float weight_;
+};
+
+/// Calculate resampling coordinates along one axis. Uses exactly the math of Image::GetPixelBilinear.
+static ea::vector<ResampleCoord> CalculateResampleCoords(int sizeIn, int sizeOut, unsigned stride)
+{
+    ea::vector<ResampleCoord> coords(sizeOut);
+    for (int i = 0; i < sizeOut; ++i)
+    {
+        // Calculate float coordinates between 0 - 1 for resampling
+        const float normalized = (sizeIn > 1) ? (float)i / (float)(sizeOut - 1) : 0.0f;
+        const float coord = Clamp(normalized * sizeIn - 0.5f, 0.0f, (float)(sizeIn - 1));
+        const auto index = (int)coord;
+        coords[i].offset0_ = Clamp(index, 0, sizeIn - 1) * stride;
+        coords[i].offset1_ = Clamp(index + 1, 0, sizeIn - 1) * stride;
+        coords[i].weight_ = Fract(coord);
+    }
+    return coords;
+}
+
+#ifdef URHO3D_SSE
+/// Load RGBA pixel as normalized floats.
+static inline __m128 LoadPixelRGBA(const unsigned char* src)
+{
+    int packed;
+    memcpy(&packed, src, sizeof packed);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i pixel = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+    // Divide rather than multiply by reciprocal to match Image::GetPixel exactly
+    return _mm_div_ps(_mm_cvtepi32_ps(pixel), _mm_set1_ps(255.0f));
+}
+#endif
+
+/// Bilinearly interpolate one output row of Image::Resize. Matches Color::Lerp and Color::ToUInt bit-exactly.
+static void ResampleRow(unsigned char* out, const unsigned char* inUpper, const unsigned char* inLower, float yWeight,
+    const ResampleCoord* columns, int width, unsigned components)
+{
+    const float invYWeight = 1.0f - yWeight;
+    int x = 0;
+#ifdef URHO3D_SSE
+    if (components == 4)
+    {
+        const __m128 scale = _mm_set1_ps(255.0f);
+        const __m128 weightY = _mm_set1_ps(yWeight);
+        const __m128 invWeightY = _mm_set1_ps(invYWeight);
+        for (; x < width; ++x)
+        {
+            const ResampleCoord& column = columns[x];
+            const __m128 weightX = _mm_set1_ps(column.weight_);
+            const __m128 invWeightX = _mm_set1_ps(1.0f - column.weight_);
+            const __m128 top = _mm_add_ps(_mm_mul_ps(LoadPixelRGBA(inUpper + column.offset0_), invWeightX),
+                _mm_mul_ps(LoadPixelRGBA(inUpper + column.offset1_), weightX));
+            const __m128 bottom = _mm_add_ps(_mm_mul_ps(LoadPixelRGBA(inLower + column.offset0_), invWeightX),
+                _mm_mul_ps(LoadPixelRGBA(inLower + column.offset1_), weightX));
+            const __m128 value = _mm_add_ps(_mm_mul_ps(top, invWeightY), _mm_mul_ps(bottom, weightY));
+            // Saturating packs clamp to 0 - 255 like Color::ToUInt
+            __m128i result = _mm_cvttps_epi32(_mm_mul_ps(value, scale));
+            result = _mm_packs_epi32(result, result);
+            result = _mm_packus_epi16(result, result);
+            const int packed = _mm_cvtsi128_si32(result);
+            memcpy(&out[x * 4], &packed, sizeof packed);
+        }
+    }
+#endif
+
+    for (; x < width; ++x)
+    {
+        const ResampleCoord& column = columns[x];
+        const float invXWeight = 1.0f - column.weight_;
+        unsigned char* dest = &out[x * components];
+        for (unsigned c = 0; c < components; ++c)
+        {
+            const float top = (float)inUpper[column.offset0_ + c] / 255.0f * invXWeight +
+                (float)inUpper[column.offset1_ + c] / 255.0f * column.weight_;
+            const float bottom = (float)inLower[column.offset0_ + c] / 255.0f * invXWeight +
+                (float)inLower[column.offset1_ + c] / 255.0f * column.weight_;
+            const float value = top * invYWeight + bottom * yWeight;
+            dest[c] = (unsigned char)Clamp((int)(value * 255.0f), 0, 255);
+        }
+    }
+}
+
+bool CompressedLevel::Decompress(unsigned char* dest, WorkQueue* workQueue)
 {
     if (!data_)
         return false;
@@ -224,16 +409,16 @@ bool CompressedLevel::Decompress(unsigned char* dest)
     case CF_DXT1:
     case CF_DXT3:
     case CF_DXT5:
-        DecompressImageDXT(dest, data_, width_, height_, depth_, format_);
+        DecompressImageDXT(dest, data_, width_, height_, depth_, format_, workQueue);
         return true;
 	
     // ETC2 format is compatible with ETC1, so we just use the same function.
     case CF_ETC1:
     case CF_ETC2_RGB:
-        DecompressImageETC(dest, data_, width_, height_, false);
+        DecompressImageETC(dest, data_, width_, height_, false, workQueue);
         return true;
     case CF_ETC2_RGBA:
-        DecompressImageETC(dest, data_, width_, height_, true);
+        DecompressImageETC(dest, data_, width_, height_, true, workQueue);
         return true;
 
     case CF_PVRTC_RGB_2BPP:
@@ -249,6 +434,19 @@ bool CompressedLevel::Decompress(unsigned char* dest)
     }
 }
 
+/// Return number of largest mip levels to skip so that the first level read is no larger than the maximum size. Levels smaller than 4 pixels are never made the first level, as the texture classes do not use them either.
+static unsigned GetLoadMipsToSkip(unsigned width, unsigned height, unsigned levels, int maxSize)
+{
+    if (maxSize <= 0)
+        return 0;
+
+    unsigned mipsToSkip = 0;
+    while (mipsToSkip + 1 < levels && Max(width >> mipsToSkip, height >> mipsToSkip) > (unsigned)maxSize &&
+        (width >> (mipsToSkip + 1)) >= 4 && (height >> (mipsToSkip + 1)) >= 4)
+        ++mipsToSkip;
+    return mipsToSkip;
+}
+
 Image::Image(Context* context) :
     Resource(context)
 {
@@ -265,6 +463,7 @@ bool Image::BeginLoad(Deserializer& source)
 {
     // Check for DDS, KTX or PVR compressed format
     ea::string fileID = source.ReadFileID();
+    numSkippedLevels_ = 0;
 
     if (fileID == "DDS ")
     {
@@ -376,6 +575,8 @@ bool Image::BeginLoad(Deserializer& source)
 
         // Calculate the size of the data
         unsigned dataSize = 0;
+        unsigned mipsToSkip = 0;
+        unsigned skippedDataSize = 0;
         if (compressedFormat_ != CF_RGBA)
         {
             const unsigned blockSize = (compressedFormat_ == CF_DXT1 || compressedFormat_ == CF_ETC1 || compressedFormat_ == CF_ETC2_RGB) ? 8 : 16; //DXT1/BC1, ETC1 and ETC2 are 8 bytes, DXT3/BC2, DXT5/BC3 and ETC2A are 16 bytes
@@ -394,6 +595,18 @@ bool Image::BeginLoad(Deserializer& source)
                 blocksHeight = (Max(y, 1U) + 3) / 4;
                 dataSize += blockSize * blocksWide * blocksHeight * Max(z, 1U);
             }
+
+            // Skip the largest mip levels of a 2D texture if requested
+            if (imageChainCount == 1 && ddsd.dwDepth_ <= 1)
+            {
+                mipsToSkip = GetLoadMipsToSkip(ddsd.dwWidth_, ddsd.dwHeight_, ddsd.dwMipMapCount_, loadMaxSize_);
+                for (unsigned level = 0; level < mipsToSkip; ++level)
+                {
+                    blocksWide = (Max(ddsd.dwWidth_ >> level, 1U) + 3) / 4;
+                    blocksHeight = (Max(ddsd.dwHeight_ >> level, 1U) + 3) / 4;
+                    skippedDataSize += blockSize * blocksWide * blocksHeight;
+                }
+            }
         }
         else
         {
@@ -406,6 +619,13 @@ bool Image::BeginLoad(Deserializer& source)
                 dataSize += (ddsd.ddpfPixelFormat_.dwRGBBitCount_ / 8) * Max(x, 1U) * Max(y, 1U) * Max(z, 1U);
         }
 
+        if (mipsToSkip)
+        {
+            source.Seek(source.GetPosition() + skippedDataSize);
+            dataSize -= skippedDataSize;
+            numSkippedLevels_ = mipsToSkip;
+        }
+
         // Do not use a shared ptr here, in case nothing is refcounting the image outside this function.
         // A raw pointer is fine as the image chain (if needed) uses shared ptr's properly
         Image* currentImage = this;
@@ -417,11 +637,11 @@ bool Image::BeginLoad(Deserializer& source)
             currentImage->array_ = array_;
             currentImage->components_ = components_;
             currentImage->compressedFormat_ = compressedFormat_;
-            currentImage->width_ = ddsd.dwWidth_;
-            currentImage->height_ = ddsd.dwHeight_;
+            currentImage->width_ = ddsd.dwWidth_ >> mipsToSkip;
+            currentImage->height_ = ddsd.dwHeight_ >> mipsToSkip;
             currentImage->depth_ = ddsd.dwDepth_;
 
-            currentImage->numCompressedLevels_ = ddsd.dwMipMapCount_;
+            currentImage->numCompressedLevels_ = ddsd.dwMipMapCount_ - mipsToSkip;
             if (!currentImage->numCompressedLevels_)
                 currentImage->numCompressedLevels_ = 1;
 
@@ -642,11 +862,24 @@ bool Image::BeginLoad(Deserializer& source)
         }
 
         source.Seek(source.GetPosition() + keyValueBytes);
+
+        // Skip the largest mip levels if requested
+        const unsigned mipsToSkip = GetLoadMipsToSkip(width, height, mipmaps, loadMaxSize_);
+        for (unsigned i = 0; i < mipsToSkip; ++i)
+        {
+            unsigned levelSize = source.ReadUInt();
+            source.Seek(source.GetPosition() + levelSize);
+            if (source.GetPosition() & 3)
+                source.Seek((source.GetPosition() + 3) & 0xfffffffc);
+        }
+        numSkippedLevels_ = mipsToSkip;
+        mipmaps -= mipsToSkip;
+
         auto dataSize = (unsigned)(source.GetSize() - source.GetPosition() - mipmaps * sizeof(unsigned));
 
         data_ = new unsigned char[dataSize];
-        width_ = width;
-        height_ = height;
+        width_ = width >> mipsToSkip;
+        height_ = height >> mipsToSkip;
         numCompressedLevels_ = mipmaps;
 
         unsigned dataOffset = 0;
@@ -1059,11 +1292,22 @@ bool Image::FlipHorizontal()
 
         for (int y = 0; y < height_; ++y)
         {
-            for (int x = 0; x < width_; ++x)
+            const unsigned char* src = &data_[y * rowSize];
+            unsigned char* dest = &newData[y * rowSize];
+            int x = 0;
+#ifdef URHO3D_SSE
+            // Reverse the order of four RGBA pixels at a time
+            if (components_ == 4)
             {
-                for (unsigned c = 0; c < components_; ++c)
-                    newData[y * rowSize + x * components_ + c] = data_[y * rowSize + (width_ - x - 1) * components_ + c];
+                for (; x + 4 <= width_; x += 4)
+                {
+                    const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[(width_ - x - 4) * 4]));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(&dest[x * 4]), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(0, 1, 2, 3)));
+                }
             }
+#endif
+            for (; x < width_; ++x)
+                memcpy(&dest[x * components_], &src[(width_ - x - 1) * components_], components_);
         }
 
         data_ = newData;
@@ -1189,34 +1433,19 @@ bool Image::Resize(int width, int height)
 
     /// \todo Reducing image size does not sample all needed pixels
     ea::shared_array<unsigned char> newData(new unsigned char[width * height * components_]);
-    for (int y = 0; y < height; ++y)
+    const ea::vector<ResampleCoord> columns = CalculateResampleCoords(width_, width, components_);
+    const ea::vector<ResampleCoord> rows = CalculateResampleCoords(height_, height, width_ * components_);
+    const unsigned char* pixelDataIn = data_.get();
+    unsigned char* pixelDataOut = newData.get();
+
+    ProcessImageRows(context_, height, width, [&](unsigned begin, unsigned end)
     {
-        for (int x = 0; x < width; ++x)
+        for (unsigned y = begin; y < end; ++y)
         {
-            // Calculate float coordinates between 0 - 1 for resampling
-            float xF = (width_ > 1) ? (float)x / (float)(width - 1) : 0.0f;
-            float yF = (height_ > 1) ? (float)y / (float)(height - 1) : 0.0f;
-            unsigned uintColor = GetPixelBilinear(xF, yF).ToUInt();
-            unsigned char* dest = newData.get() + (y * width + x) * components_;
-            auto* src = (unsigned char*)&uintColor;
-
-            switch (components_)
-            {
-            case 4:
-                dest[3] = src[3];
-                // Fall through
-            case 3:
-                dest[2] = src[2];
-                // Fall through
-            case 2:
-                dest[1] = src[1];
-                // Fall through
-            default:
-                dest[0] = src[0];
-                break;
-            }
+            ResampleRow(&pixelDataOut[y * width * components_], &pixelDataIn[rows[y].offset0_], &pixelDataIn[rows[y].offset1_],
+                rows[y].weight_, columns.data(), width, components_);
         }
-    }
+    });
 
     width_ = width;
     height_ = height;
@@ -1225,6 +1454,78 @@ bool Image::Resize(int width, int height)
     return true;
 }
 
+bool Image::Compress(CompressedFormat format, CompressionQuality quality, bool generateMips)
+{
+    URHO3D_PROFILE("CompressImage");
+
+    if (IsCompressed())
+    {
+        URHO3D_LOGERROR("Image is already compressed");
+        return false;
+    }
+
+    if (depth_ > 1)
+    {
+        URHO3D_LOGERROR("Compress not supported for 3D images");
+        return false;
+    }
+
+    if (format != CF_DXT1 && format != CF_DXT3 && format != CF_DXT5 && format != CF_ETC1)
+    {
+        URHO3D_LOGERROR("Unsupported format for image compression");
+        return false;
+    }
+
+    if (!data_ || components_ < 1 || components_ > 4)
+        return false;
+
+    // Collect the RGBA source of each level. Mip levels are generated from the previous level
+    SharedPtr<Image> rgbaImage;
+    if (components_ != 4)
+    {
+        rgbaImage = ConvertToRGBA();
+        if (!rgbaImage)
+            return false;
+    }
+
+    ea::vector<SharedPtr<Image>> mipImages;
+    ea::vector<const Image*> levels{rgbaImage ? rgbaImage.Get() : this};
+    while (generateMips && (levels.back()->GetWidth() > 1 || levels.back()->GetHeight() > 1))
+    {
+        SharedPtr<Image> mipImage = levels.back()->GetNextLevel();
+        if (!mipImage)
+            return false;
+        mipImages.push_back(mipImage);
+        levels.push_back(mipImage);
+    }
+
+    const unsigned blockSize = format == CF_DXT1 || format == CF_ETC1 ? 8 : 16;
+    unsigned dataSize = 0;
+    for (const Image* levelImage : levels)
+        dataSize += ((levelImage->GetWidth() + 3) / 4) * ((levelImage->GetHeight() + 3) / 4) * blockSize;
+
+    ea::shared_array<unsigned char> newData(new unsigned char[dataSize]);
+    unsigned offset = 0;
+    for (const Image* levelImage : levels)
+    {
+        const int width = levelImage->GetWidth();
+        const int height = levelImage->GetHeight();
+        if (format == CF_ETC1)
+            CompressImageETC1(newData.get() + offset, levelImage->GetData(), width, height, quality, context_->GetWorkQueue());
+        else
+            CompressImageDXT(newData.get() + offset, levelImage->GetData(), width, height, format, quality, context_->GetWorkQueue());
+        offset += ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+    }
+
+    data_ = newData;
+    compressedFormat_ = format;
+    components_ = format == CF_DXT1 || format == CF_ETC1 ? 3 : 4;
+    numCompressedLevels_ = levels.size();
+    nextLevel_.Reset();
+    SetMemoryUse(dataSize);
+    return true;
+}
+
 void Image::Clear(const Color& color)
 {
     ClearInt(color.ToUInt());
@@ -1689,84 +1990,16 @@ SharedPtr<Image> Image::GetNextLevel() const
     // 2D case
     else if (depth_ == 1)
     {
-        switch (components_)
+        const unsigned rowSizeIn = width_ * components_;
+        const unsigned rowSizeOut = widthOut * components_;
+        ProcessImageRows(context_, heightOut, widthOut, [&](unsigned begin, unsigned end)
         {
-        case 1:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_];
-                unsigned char* out = &pixelDataOut[y * widthOut];
-
-                for (int x = 0; x < widthOut; ++x)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 1] +
-                                              inLower[x * 2] + inLower[x * 2 + 1]) >> 2);
-                }
-            }
-            break;
-
-        case 2:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 2];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 2];
-                unsigned char* out = &pixelDataOut[y * widthOut * 2];
-
-                for (int x = 0; x < widthOut * 2; x += 2)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 2] +
-                                              inLower[x * 2] + inLower[x * 2 + 2]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 3] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 3]) >> 2);
-                }
-            }
-            break;
-
-        case 3:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 3];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 3];
-                unsigned char* out = &pixelDataOut[y * widthOut * 3];
-
-                for (int x = 0; x < widthOut * 3; x += 3)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 3] +
-                                              inLower[x * 2] + inLower[x * 2 + 3]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 4] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 5]) >> 2);
-                }
-            }
-            break;
-
-        case 4:
-            for (int y = 0; y < heightOut; ++y)
+            for (unsigned y = begin; y < end; ++y)
             {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 4];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 4];
-                unsigned char* out = &pixelDataOut[y * widthOut * 4];
-
-                for (int x = 0; x < widthOut * 4; x += 4)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 4] +
-                                              inLower[x * 2] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 5]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 6] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 6]) >> 2);
-                    out[x + 3] = (unsigned char)(((unsigned)inUpper[x * 2 + 3] + inUpper[x * 2 + 7] +
-                                                  inLower[x * 2 + 3] + inLower[x * 2 + 7]) >> 2);
-                }
+                DownsampleRow2D(&pixelDataOut[y * rowSizeOut], &pixelDataIn[(y * 2) * rowSizeIn],
+                    &pixelDataIn[(y * 2 + 1) * rowSizeIn], widthOut, components_);
             }
-            break;
-
-        default:
-            assert(false);  // Should never reach here
-            break;
-        }
+        });
     }
     // 3D case
     else
@@ -1888,6 +2121,10 @@ SharedPtr<Image> Image::GetNextLevel() const
                                                       inOuterLower[x * 2 + 2] + inOuterLower[x * 2 + 6] +
                                                       inInnerUpper[x * 2 + 2] + inInnerUpper[x * 2 + 6] +
                                                       inInnerLower[x * 2 + 2] + inInnerLower[x * 2 + 6]) >> 3);
+                        out[x + 3] = (unsigned char)(((unsigned)inOuterUpper[x * 2 + 3] + inOuterUpper[x * 2 + 7] +
+                                                      inOuterLower[x * 2 + 3] + inOuterLower[x * 2 + 7] +
+                                                      inInnerUpper[x * 2 + 3] + inInnerUpper[x * 2 + 7] +
+                                                      inInnerLower[x * 2 + 3] + inInnerLower[x * 2 + 7]) >> 3);
                     }
                 }
             }
@@ -1929,38 +2166,68 @@ SharedPtr<Image> Image::ConvertToRGBA() const
 
     const unsigned char* src = data_.get();
     unsigned char* dest = ret->GetData();
+    const auto numPixels = static_cast<unsigned>(width_ * height_ * depth_);
+    unsigned i = 0;
 
     switch (components_)
     {
     case 1:
-        for (unsigned i = 0; i < static_cast<unsigned>(width_ * height_ * depth_); ++i)
+#ifdef URHO3D_SSE
+        for (; i + 16 <= numPixels; i += 16)
+        {
+            const __m128i gray = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i]));
+            const __m128i alpha = _mm_set1_epi8(-1);
+            const __m128i grayGrayLo = _mm_unpacklo_epi8(gray, gray);
+            const __m128i grayGrayHi = _mm_unpackhi_epi8(gray, gray);
+            const __m128i grayAlphaLo = _mm_unpacklo_epi8(gray, alpha);
+            const __m128i grayAlphaHi = _mm_unpackhi_epi8(gray, alpha);
+            auto* out = reinterpret_cast<__m128i*>(&dest[i * 4]);
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(grayGrayLo, grayAlphaLo));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(grayGrayLo, grayAlphaLo));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(grayGrayHi, grayAlphaHi));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(grayGrayHi, grayAlphaHi));
+        }
+#endif
+        for (; i < numPixels; ++i)
         {
-            unsigned char pixel = *src++;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = 255;
+            unsigned char pixel = src[i];
+            dest[i * 4] = pixel;
+            dest[i * 4 + 1] = pixel;
+            dest[i * 4 + 2] = pixel;
+            dest[i * 4 + 3] = 255;
         }
         break;
 
     case 2:
-        for (unsigned i = 0; i < static_cast<unsigned>(width_ * height_ * depth_); ++i)
+#ifdef URHO3D_SSE
+        for (; i + 8 <= numPixels; i += 8)
+        {
+            // Each 16-bit lane holds gray and alpha, expand it to gray-gray, gray-alpha
+            const __m128i grayAlpha = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i * 2]));
+            const __m128i gray = _mm_and_si128(grayAlpha, _mm_set1_epi16(0xff));
+            const __m128i grayGray = _mm_or_si128(gray, _mm_slli_epi16(gray, 8));
+            auto* out = reinterpret_cast<__m128i*>(&dest[i * 4]);
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(grayGray, grayAlpha));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(grayGray, grayAlpha));
+        }
+#endif
+        for (; i < numPixels; ++i)
         {
-            unsigned char pixel = *src++;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = *src++;
+            unsigned char pixel = src[i * 2];
+            dest[i * 4] = pixel;
+            dest[i * 4 + 1] = pixel;
+            dest[i * 4 + 2] = pixel;
+            dest[i * 4 + 3] = src[i * 2 + 1];
         }
         break;
 
     case 3:
-        for (unsigned i = 0; i < static_cast<unsigned>(width_ * height_ * depth_); ++i)
+        for (; i < numPixels; ++i)
         {
-            *dest++ = *src++;
-            *dest++ = *src++;
-            *dest++ = *src++;
-            *dest++ = 255;
+            dest[i * 4] = src[i * 3];
+            dest[i * 4 + 1] = src[i * 3 + 1];
+            dest[i * 4 + 2] = src[i * 3 + 2];
+            dest[i * 4 + 3] = 255;
         }
         break;
 
@@ -33,6 +33,8 @@ struct SDL_Surface;
 namespace Urho3D
 {
 
+class WorkQueue;
+
 static const int COLOR_LUT_SIZE = 16;
 
 /// Supported compressed image formats.
@@ -52,11 +54,22 @@ enum CompressedFormat
     CF_PVRTC_RGBA_4BPP,
 };
 
+/// Quality preset of runtime image compression, trading encoding speed for quality.
+enum CompressionQuality
+{
+    /// Endpoints from the color bounding box. Fastest.
+    COMPRESSION_FAST = 0,
+    /// Endpoints along the principal axis of the colors.
+    COMPRESSION_NORMAL,
+    /// Refined endpoints and a wider search of ETC1 base colors. Slowest.
+    COMPRESSION_HIGH,
+};
+
 /// Compressed image mip level.
 struct URHO3D_API CompressedLevel
 {
-    /// Decompress to RGBA. The destination buffer required is width * height * 4 bytes. Return true if successful.
-    bool Decompress(unsigned char* dest);
+    /// Decompress to RGBA. The destination buffer required is width * height * 4 bytes. DXT and ETC levels are decompressed on the worker threads of the work queue if given. Return true if successful.
+    bool Decompress(unsigned char* dest, WorkQueue* workQueue = nullptr);
 
     /// Compressed image data.
     unsigned char* data_{};
@@ -114,12 +127,16 @@ public:
     void SetPixelInt(int x, int y, int z, unsigned uintColor);
     /// Load as color LUT. Return true if successful.
     bool LoadColorLUT(Deserializer& source);
+    /// Set largest dimension of the first mip level read by subsequent loads. Larger mip levels of compressed 2D DDS and KTX images are skipped without reading them. Zero reads all mip levels. Default 0.
+    void SetLoadMaxSize(int size) { loadMaxSize_ = Max(size, 0); }
     /// Flip image horizontally. Return true if successful.
     bool FlipHorizontal();
     /// Flip image vertically. Return true if successful.
     bool FlipVertical();
     /// Resize image by bilinear resampling. Return true if successful.
     bool Resize(int width, int height);
+    /// Compress a 2D image to DXT1, DXT3, DXT5 or ETC1, optionally including a full mip chain. Textures upload the compressed levels directly if the format is supported. DXT1 and ETC1 discard alpha. Return true if successful.
+    bool Compress(CompressedFormat format, CompressionQuality quality = COMPRESSION_NORMAL, bool generateMips = true);
     /// Clear the image with a color.
     void Clear(const Color& color);
     /// Clear the image with an integer color. R component is in the 8 lowest bits.
@@ -180,6 +197,12 @@ public:
     /// Return number of compressed mip levels. Returns 0 if the image is has not been loaded from a source file containing multiple mip levels.
     unsigned GetNumCompressedLevels() const { return numCompressedLevels_; }
 
+    /// Return largest dimension of the first mip level read by subsequent loads.
+    int GetLoadMaxSize() const { return loadMaxSize_; }
+
+    /// Return number of largest mip levels skipped by the last load.
+    unsigned GetNumSkippedLevels() const { return numSkippedLevels_; }
+
     /// Return next mip level by bilinear filtering. Note that if the image is already 1x1x1, will keep returning an image of that size.
     SharedPtr<Image> GetNextLevel() const;
     /// Return the next sibling image of an array or cubemap.
@@ -221,6 +244,10 @@ private:
     unsigned components_{};
     /// Number of compressed mip levels.
     unsigned numCompressedLevels_{};
+    /// Largest dimension of the first mip level read by subsequent loads, zero reads all levels.
+    int loadMaxSize_{};
+    /// Number of largest mip levels skipped by the last load.
+    unsigned numSkippedLevels_{};
     /// Cubemap status if DDS.
     bool cubemap_{};
     /// Texture array status if DDS.
@@ -165,6 +165,12 @@ void Component::AddReplicationState(ComponentReplicationState* state)
     networkState_->replicationStates_.push_back(state);
 }
 
+void Component::RemoveReplicationState(ComponentReplicationState* state)
+{
+    if (networkState_)
+        networkState_->replicationStates_.erase_first(state);
+}
+
 void Component::PrepareNetworkUpdate()
 {
     if (!networkState_)
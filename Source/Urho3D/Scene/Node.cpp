@@ -47,6 +47,13 @@
 namespace Urho3D
 {
 
+/// Grid cell size of the network position. Positions are sent as cell index and offset within the cell.
+static const float NET_POSITION_CELL_SIZE = 16.0f;
+/// Bits per component of the network position offset within the grid cell.
+static const unsigned NET_POSITION_QUANTIZE_BITS = 16;
+/// Bits per component of the network rotation, sent as the smallest three components.
+static const unsigned NET_ROTATION_QUANTIZE_BITS = 16;
+
 Node::Node(Context* context) :
     Animatable(context),
     worldTransform_(Matrix3x4::IDENTITY),
@@ -88,9 +95,12 @@ void Node::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Scale", GetScale, SetScale, Vector3, Vector3::ONE, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Variables", VariantMap, vars_, Variant::emptyVariantMap, AM_FILE); // Network replication of vars uses custom data
     URHO3D_ACCESSOR_ATTRIBUTE("Network Position", GetNetPositionAttr, SetNetPositionAttr, Vector3, Vector3::ZERO,
-        AM_NET | AM_LATESTDATA | AM_NOEDIT);
-    URHO3D_ACCESSOR_ATTRIBUTE("Network Rotation", GetNetRotationAttr, SetNetRotationAttr, ea::vector<unsigned char>, Variant::emptyBuffer,
-        AM_NET | AM_LATESTDATA | AM_NOEDIT);
+        AM_NET | AM_LATESTDATA | AM_NOEDIT)
+        .SetMetadata(AttributeMetadata::P_NET_GRID_CELL_SIZE, NET_POSITION_CELL_SIZE)
+        .SetMetadata(AttributeMetadata::P_NET_QUANTIZE_BITS, NET_POSITION_QUANTIZE_BITS);
+    URHO3D_ACCESSOR_ATTRIBUTE("Network Rotation", GetNetRotationAttr, SetNetRotationAttr, Quaternion, Quaternion::IDENTITY,
+        AM_NET | AM_LATESTDATA | AM_NOEDIT)
+        .SetMetadata(AttributeMetadata::P_NET_QUANTIZE_BITS, NET_ROTATION_QUANTIZE_BITS);
     URHO3D_ACCESSOR_ATTRIBUTE("Network Parent Node", GetNetParentAttr, SetNetParentAttr, ea::vector<unsigned char>, Variant::emptyBuffer,
         AM_NET | AM_NOEDIT);
 }
@@ -440,6 +450,12 @@ void Node::AddReplicationState(NodeReplicationState* state)
     networkState_->replicationStates_.push_back(state);
 }
 
+void Node::RemoveReplicationState(NodeReplicationState* state)
+{
+    if (networkState_)
+        networkState_->replicationStates_.erase_first(state);
+}
+
 bool Node::SaveXML(Serializer& dest, const ea::string& indentation) const
 {
     SharedPtr<XMLFile> xml(context_->CreateObject<XMLFile>());
@@ -883,6 +899,22 @@ void Node::SetOwner(Connection* owner)
 }
 
 void Node::MarkDirty()
+{
+    // Let the scene walk the hierarchy, notify the listeners and recalculate the world transforms in a batch. Until then
+    // the pending flag makes the world transforms recalculate on access
+    if (pendingTransformUpdate_)
+    {
+        scene_->MarkTransformDirty(this);
+        return;
+    }
+
+    if (dirty_)
+        return;
+
+    MarkDirtyHierarchy();
+}
+
+void Node::MarkDirtyHierarchy()
 {
     Node *cur = this;
     for (;;)
@@ -899,22 +931,7 @@ void Node::MarkDirty()
         cur->dirty_ = true;
 
         // Notify listener components first, then mark child nodes
-        for (auto i = cur->listeners_.begin(); i !=
-            cur->listeners_.end();)
-        {
-            Component *c = i->Get();
-            if (c)
-            {
-                c->OnMarkedDirty(cur);
-                ++i;
-            }
-            // If listener has expired, erase from list (swap with the last element to avoid O(n^2) behavior)
-            else
-            {
-                *i = cur->listeners_.back();
-                cur->listeners_.pop_back();
-            }
-        }
+        cur->NotifyListeners();
 
         // Tail call optimization: Don't recurse to mark the first child dirty, but
         // instead process it in the context of the current function. If there are more
@@ -924,7 +941,7 @@ void Node::MarkDirty()
         {
             Node *next = i->Get();
             for (++i; i != cur->children_.end(); ++i)
-                (*i)->MarkDirty();
+                (*i)->MarkDirtyHierarchy();
             cur = next;
         }
         else
@@ -932,6 +949,25 @@ void Node::MarkDirty()
     }
 }
 
+void Node::NotifyListeners()
+{
+    for (auto i = listeners_.begin(); i != listeners_.end();)
+    {
+        Component *c = i->Get();
+        if (c)
+        {
+            c->OnMarkedDirty(this);
+            ++i;
+        }
+        // If listener has expired, erase from list (swap with the last element to avoid O(n^2) behavior)
+        else
+        {
+            *i = listeners_.back();
+            listeners_.pop_back();
+        }
+    }
+}
+
 Node* Node::CreateChild(const ea::string& name, CreateMode mode, unsigned id, bool temporary)
 {
     Node* newNode = CreateChild(id, mode, temporary);
@@ -1592,7 +1628,13 @@ void Node::SetEntity(entt::entity entity)
 
 void Node::SetScene(Scene* scene)
 {
+    // When leaving a scene with a pending batched transform update, the world transform may be stale. Mark it dirty, as the
+    // whole subtree leaves the scene, which keeps the dirty hierarchy valid
+    if (NeedWorldTransformUpdate())
+        dirty_ = true;
+
     scene_ = scene;
+    pendingTransformUpdate_ = scene_ ? scene_->GetPendingTransformUpdate() : nullptr;
 }
 
 void Node::ResetScene()
@@ -1611,14 +1653,13 @@ void Node::SetNetPositionAttr(const Vector3& value)
         SetPosition(value);
 }
 
-void Node::SetNetRotationAttr(const ea::vector<unsigned char>& value)
+void Node::SetNetRotationAttr(const Quaternion& value)
 {
-    MemoryBuffer buf(value);
     auto* transform = GetComponent<SmoothedTransform>();
     if (transform)
-        transform->SetTargetRotation(buf.ReadPackedQuaternion());
+        transform->SetTargetRotation(value);
     else
-        SetRotation(buf.ReadPackedQuaternion());
+        SetRotation(value);
 }
 
 void Node::SetNetParentAttr(const ea::vector<unsigned char>& value)
@@ -1663,11 +1704,9 @@ const Vector3& Node::GetNetPositionAttr() const
     return position_;
 }
 
-const ea::vector<unsigned char>& Node::GetNetRotationAttr() const
+const Quaternion& Node::GetNetRotationAttr() const
 {
-    impl_->attrBuffer_.Clear();
-    impl_->attrBuffer_.WritePackedQuaternion(rotation_);
-    return impl_->attrBuffer_.GetBuffer();
+    return rotation_;
 }
 
 const ea::vector<unsigned char>& Node::GetNetParentAttr() const
@@ -31,6 +31,8 @@
 #include <entt/entity/entity.hpp>
 #include <entt/entity/fwd.hpp>
 
+#include <atomic>
+
 namespace Urho3D
 {
 
@@ -117,6 +119,8 @@ public:
     void MarkNetworkUpdate() override;
     /// Add a replication state that is tracking this node.
     virtual void AddReplicationState(NodeReplicationState* state);
+    /// Remove a replication state that is tracking this node.
+    void RemoveReplicationState(NodeReplicationState* state);
 
     /// Save to an XML file. Return true if successful.
     bool SaveXML(Serializer& dest, const ea::string& indentation = "\t") const;
@@ -417,7 +421,7 @@ public:
     /// Return position in world space.
     Vector3 GetWorldPosition() const
     {
-        if (dirty_)
+        if (NeedWorldTransformUpdate())
             UpdateWorldTransform();
 
         return worldTransform_.Translation();
@@ -433,7 +437,7 @@ public:
     /// Return rotation in world space.
     Quaternion GetWorldRotation() const
     {
-        if (dirty_)
+        if (NeedWorldTransformUpdate())
             UpdateWorldTransform();
 
         return worldRotation_;
@@ -448,7 +452,7 @@ public:
     /// Return direction in world space.
     Vector3 GetWorldDirection() const
     {
-        if (dirty_)
+        if (NeedWorldTransformUpdate())
             UpdateWorldTransform();
 
         return worldRotation_ * Vector3::FORWARD;
@@ -457,7 +461,7 @@ public:
     /// Return node's up vector in world space.
     Vector3 GetWorldUp() const
     {
-        if (dirty_)
+        if (NeedWorldTransformUpdate())
             UpdateWorldTransform();
 
         return worldRotation_ * Vector3::UP;
@@ -466,7 +470,7 @@ public:
     /// Return node's right vector in world space.
     Vector3 GetWorldRight() const
     {
-        if (dirty_)
+        if (NeedWorldTransformUpdate())
             UpdateWorldTransform();
 
         return worldRotation_ * Vector3::RIGHT;
@@ -475,7 +479,7 @@ public:
     /// Return scale in world space.
     Vector3 GetWorldScale() const
     {
-        if (dirty_)
+        if (NeedWorldTransformUpdate())
             UpdateWorldTransform();
 
         return worldTransform_.Scale();
@@ -494,7 +498,7 @@ public:
     /// Return world space transform matrix.
     const Matrix3x4& GetWorldTransform() const
     {
-        if (dirty_)
+        if (NeedWorldTransformUpdate())
             UpdateWorldTransform();
 
         return worldTransform_;
@@ -514,7 +518,7 @@ public:
     Vector2 WorldToLocal2D(const Vector2& vector) const;
 
     /// Return whether transform has changed and world transform needs recalculation.
-    bool IsDirty() const { return dirty_; }
+    bool IsDirty() const { return NeedWorldTransformUpdate(); }
 
     /// Return number of child scene nodes.
     unsigned GetNumChildren(bool recursive = false) const;
@@ -595,16 +599,31 @@ public:
     void SetScene(Scene* scene);
     /// Reset scene, ID and owner. Called by Scene.
     void ResetScene();
+    /// Set index in the batched transform update queue of the scene. Called by Scene.
+    void SetTransformUpdateIndex(unsigned index) { transformUpdateIndex_ = index; }
+    /// Return index in the batched transform update queue of the scene, or M_MAX_UNSIGNED if not queued.
+    unsigned GetTransformUpdateIndex() const { return transformUpdateIndex_; }
+    /// Set world transform calculated by the batched transform update of the scene and clear the dirty flag. Called by Scene.
+    void SetBatchedWorldTransform(const Matrix3x4& transform, const Quaternion& rotation) const
+    {
+        worldTransform_ = transform;
+        worldRotation_ = rotation;
+        dirty_ = false;
+    }
+    /// Set pending batched transform update flag of the scene, or null if the scene does not batch transform updates. Called by Scene.
+    void SetPendingTransformUpdate(const std::atomic<bool>* pending) { pendingTransformUpdate_ = pending; }
+    /// Notify listener components that the world transform has changed. Called by Scene.
+    void NotifyListeners();
     /// Set network position attribute.
     void SetNetPositionAttr(const Vector3& value);
     /// Set network rotation attribute.
-    void SetNetRotationAttr(const ea::vector<unsigned char>& value);
+    void SetNetRotationAttr(const Quaternion& value);
     /// Set network parent attribute.
     void SetNetParentAttr(const ea::vector<unsigned char>& value);
     /// Return network position attribute.
     const Vector3& GetNetPositionAttr() const;
     /// Return network rotation attribute.
-    const ea::vector<unsigned char>& GetNetRotationAttr() const;
+    const Quaternion& GetNetRotationAttr() const;
     /// Return network parent attribute.
     const ea::vector<unsigned char>& GetNetParentAttr() const;
     /// Load components and optionally load child nodes.
@@ -662,8 +681,16 @@ private:
     void SetEnabled(bool enable, bool recursive, bool storeSelf);
     /// Create component, allowing UnknownComponent if actual type is not supported. Leave typeName empty if not known.
     Component* SafeCreateComponent(const ea::string& typeName, StringHash type, CreateMode mode, unsigned id);
+    /// Return whether the world transform needs recalculation on access. While the scene has a pending batched transform
+    /// update, any ancestor may have moved, so the world transform is recalculated along the parent chain.
+    bool NeedWorldTransformUpdate() const
+    {
+        return dirty_ || (pendingTransformUpdate_ && pendingTransformUpdate_->load(std::memory_order_relaxed));
+    }
     /// Recalculate the world transform.
     void UpdateWorldTransform() const;
+    /// Mark node and child nodes dirty without notifying the scene.
+    void MarkDirtyHierarchy();
     /// Remove child node by iterator.
     void RemoveChild(ea::vector<SharedPtr<Node> >::iterator i);
     /// Return child nodes recursively.
@@ -703,6 +730,10 @@ private:
     entt::entity entity_{ entt::null };
     /// Unique ID within the scene.
     unsigned id_;
+    /// Index in the batched transform update queue of the scene.
+    unsigned transformUpdateIndex_{M_MAX_UNSIGNED};
+    /// Pending batched transform update flag of the scene, or null if the scene does not batch transform updates.
+    const std::atomic<bool>* pendingTransformUpdate_{};
     /// Position.
     Vector3 position_;
     /// Rotation.
@@ -34,6 +34,8 @@ namespace Urho3D
 {
 
 static const unsigned MAX_NETWORK_ATTRIBUTES = 64;
+/// Largest difference of update sequence numbers between a latest data update and the acknowledged update it is delta compressed against. Must stay below 128, as only the lowest byte of sequence numbers is sent.
+static const unsigned NETWORK_BASELINE_WINDOW = 32;
 
 class Component;
 class Connection;
@@ -134,6 +136,90 @@ struct URHO3D_API NetworkState
     unsigned long long interceptMask_{};
 };
 
+/// Quantized network attribute value. Kept as integers, so that delta compression against it gives the same result on both ends.
+struct QuantizedNetworkValue
+{
+    /// Quantized components. Grid positions keep the offsets within the cells. Smallest three quaternions keep the index of the omitted component last.
+    unsigned components_[4]{};
+    /// Cell indices of grid positions.
+    int cells_[3]{};
+};
+
+/// Quantized latest data attribute values of the updates of one object that the other end of a connection may still compare against:
+/// the newest acknowledged update and the updates sent after it (server), or the newest baseline referred to and the updates received
+/// after it (client). Used for delta compression.
+struct URHO3D_API NetworkBaseline
+{
+    /// Return whether an update sequence number is newer than another. Only the lowest byte is compared.
+    static bool IsNewerSequence(unsigned sequence, unsigned other) { return (signed char)(sequence - other) > 0; }
+
+    /// Return stored values of an update, or null if not stored.
+    QuantizedNetworkValue* GetValues(unsigned sequence, unsigned numValues)
+    {
+        if (values_.size() != sequences_.size() * numValues)
+            return nullptr;
+        for (unsigned i = 0; i < sequences_.size(); ++i)
+        {
+            if (sequences_[i] == sequence)
+                return &values_[i * numValues];
+        }
+        return nullptr;
+    }
+
+    /// Return storage for the values of an update newer than all stored ones. Updates too old to be compared against are discarded.
+    QuantizedNetworkValue* StoreValues(unsigned sequence, unsigned numValues)
+    {
+        if (values_.size() != sequences_.size() * numValues)
+        {
+            values_.clear();
+            sequences_.clear();
+        }
+
+        unsigned numOld = 0;
+        while (numOld < sequences_.size() && (unsigned char)(sequence - sequences_[numOld]) >= NETWORK_BASELINE_WINDOW)
+            ++numOld;
+        Discard(numOld);
+
+        sequences_.push_back(sequence);
+        values_.resize(values_.size() + numValues);
+        return &values_[values_.size() - numValues];
+    }
+
+    /// Discard the updates older than the specified one, which the other end no longer compares against.
+    void DiscardOlder(unsigned sequence)
+    {
+        unsigned numOld = 0;
+        while (numOld < sequences_.size() && IsNewerSequence(sequence, sequences_[numOld]))
+            ++numOld;
+        Discard(numOld);
+    }
+
+    /// Discard the specified number of oldest updates.
+    void Discard(unsigned count)
+    {
+        if (!count)
+            return;
+        const unsigned numValues = values_.size() / sequences_.size();
+        sequences_.erase(sequences_.begin(), sequences_.begin() + count);
+        values_.erase(values_.begin(), values_.begin() + count * numValues);
+    }
+
+    /// Stored values of all quantized latest data attributes of each stored update, oldest update first.
+    ea::vector<QuantizedNetworkValue> values_;
+    /// Sequence numbers of the stored updates, oldest first.
+    ea::vector<unsigned> sequences_;
+    /// Sequence number of the newest update sent (server) or applied (client). Only the lowest byte is sent, so the client keeps sequence numbers modulo 256.
+    unsigned sequence_{};
+    /// Whether any update was sent or applied.
+    bool hasSequence_{};
+    /// Sequence number of the newest update acknowledged by the client. Used on the server only.
+    unsigned ackedSequence_{};
+    /// Whether any update was acknowledged. Used on the server only.
+    bool hasAcked_{};
+    /// Identifier of this baseline within the connection, so that late acknowledgements are not applied to a replaced object. Used on the server only.
+    unsigned id_{};
+};
+
 /// Base class for per-user network replication states.
 struct URHO3D_API ReplicationState
 {
@@ -150,6 +236,8 @@ struct URHO3D_API ComponentReplicationState : public ReplicationState
     WeakPtr<Component> component_;
     /// Dirty attribute bits.
     DirtyBits dirtyAttributes_;
+    /// Latest data updates sent to the connection.
+    NetworkBaseline latestDataBaseline_;
 };
 
 /// Per-user node network replication state.
@@ -163,6 +251,8 @@ struct URHO3D_API NodeReplicationState : public ReplicationState
     DirtyBits dirtyAttributes_;
     /// Dirty user vars.
     ea::hash_set<StringHash> dirtyVars_;
+    /// Latest data updates sent to the connection.
+    NetworkBaseline latestDataBaseline_;
     /// Components by ID.
     ea::unordered_map<unsigned, ComponentReplicationState> componentStates_;
     /// Interest management priority accumulator.
@@ -57,6 +57,8 @@ const char* SUBSYSTEM_CATEGORY = "Subsystem";
 
 static const float DEFAULT_SMOOTHING_CONSTANT = 50.0f;
 static const float DEFAULT_SNAP_THRESHOLD = 5.0f;
+/// Number of nodes per work item in the batched transform update. Smaller levels are updated on the main thread.
+static const unsigned TRANSFORM_UPDATE_BATCH_SIZE = 256;
 
 Scene::Scene(Context* context) :
     Node(context),
@@ -724,6 +726,24 @@ void Scene::SetSnapThreshold(float threshold)
     Node::MarkNetworkUpdate();
 }
 
+void Scene::SetBatchedTransformUpdate(bool enable)
+{
+    if (enable == batchedTransformUpdate_)
+        return;
+
+    // Nodes rely on the dirty hierarchy again once disabled, so resolve the queued hierarchies first
+    if (!enable)
+        UpdateTransforms();
+
+    batchedTransformUpdate_ = enable;
+    const std::atomic<bool>* pending = GetPendingTransformUpdate();
+    SetPendingTransformUpdate(pending);
+    for (const auto& item : replicatedNodes_)
+        item.second->SetPendingTransformUpdate(pending);
+    for (const auto& item : localNodes_)
+        item.second->SetPendingTransformUpdate(pending);
+}
+
 void Scene::SetAsyncLoadingMs(int ms)
 {
     asyncLoadingMs_ = Max(ms, 1);
@@ -839,6 +859,10 @@ void Scene::Update(float timeStep)
 
     // Update variable timestep logic
     SendEvent(E_SCENEUPDATE, eventData);
+    SceneUpdateArgs sceneUpdateArgs;
+    sceneUpdateArgs.scene_ = this;
+    sceneUpdateArgs.timeStep_ = timeStep;
+    SendTypedEvent(sceneUpdateArgs);
 
     // Update scene attribute animation.
     SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
@@ -863,6 +887,8 @@ void Scene::Update(float timeStep)
     // Post-update variable timestep logic
     SendEvent(E_SCENEPOSTUPDATE, eventData);
 
+    UpdateTransforms();
+
     // Note: using a float for elapsed time accumulation is inherently inaccurate. The purpose of this value is
     // primarily to update material animation effects, as it is available to shaders. It can be reset by calling
     // SetElapsedTime()
@@ -900,6 +926,147 @@ void Scene::DelayedMarkedDirty(Component* component)
     delayedDirtyComponents_.push_back(component);
 }
 
+void Scene::MarkTransformDirty(Node* node)
+{
+    if (!threadedUpdate_)
+        QueueTransformUpdate(node);
+    else
+    {
+        MutexLock lock(sceneMutex_);
+        QueueTransformUpdate(node);
+    }
+}
+
+void Scene::QueueTransformUpdate(Node* node)
+{
+    if (node->GetTransformUpdateIndex() != M_MAX_UNSIGNED)
+        return;
+
+    node->SetTransformUpdateIndex(dirtyTransformNodes_.size());
+    dirtyTransformNodes_.push_back(node);
+    pendingTransformUpdate_ = true;
+}
+
+void Scene::UpdateTransforms()
+{
+    if (dirtyTransformNodes_.empty())
+        return;
+
+    URHO3D_PROFILE("UpdateTransforms");
+
+    // Gather the roots of the queued hierarchies: a node with a queued ancestor is part of the ancestor's hierarchy. The
+    // parents of the roots are not part of the batch, so calculate the root world transforms right away, recalculating the
+    // parent chains on access while the update is still pending
+    if (transformLevels_.empty())
+        transformLevels_.resize(1);
+    TransformUpdateLevel& roots = transformLevels_[0];
+    for (Node* node : dirtyTransformNodes_)
+    {
+        Node* parent = node->GetParent();
+        while (parent && parent->GetTransformUpdateIndex() == M_MAX_UNSIGNED)
+            parent = parent->GetParent();
+        if (!parent)
+            roots.nodes_.push_back(node);
+    }
+    for (Node* node : dirtyTransformNodes_)
+        node->SetTransformUpdateIndex(M_MAX_UNSIGNED);
+    dirtyTransformNodes_.clear();
+
+    roots.worldTransforms_.resize(roots.nodes_.size());
+    roots.worldRotations_.resize(roots.nodes_.size());
+    for (unsigned i = 0; i < roots.nodes_.size(); ++i)
+    {
+        Node* node = roots.nodes_[i];
+        Node* parent = node->GetParent();
+        // Assume the root node (scene) has identity transform
+        if (parent == this || !parent)
+        {
+            roots.worldTransforms_[i] = node->GetTransform();
+            roots.worldRotations_[i] = node->GetRotation();
+        }
+        else
+        {
+            roots.worldTransforms_[i] = parent->GetWorldTransform() * node->GetTransform();
+            roots.worldRotations_[i] = parent->GetWorldRotation() * node->GetRotation();
+        }
+    }
+
+    // Then walk the hierarchies level by level, so that parents are always updated before their children, and notify the
+    // listeners on the way. Each node refers to its parent by index into the previous level
+    unsigned numLevels = 1;
+    while (!transformLevels_[numLevels - 1].nodes_.empty())
+    {
+        if (transformLevels_.size() <= numLevels)
+            transformLevels_.resize(numLevels + 1);
+
+        const TransformUpdateLevel& parents = transformLevels_[numLevels - 1];
+        TransformUpdateLevel& children = transformLevels_[numLevels];
+        for (unsigned i = 0; i < parents.nodes_.size(); ++i)
+        {
+            Node* parent = parents.nodes_[i];
+            parent->NotifyListeners();
+            for (const SharedPtr<Node>& child : parent->GetChildren())
+            {
+                children.nodes_.push_back(child);
+                children.parentIndices_.push_back(i);
+            }
+        }
+        ++numLevels;
+    }
+
+    // Calculate the world transforms into the level arrays, then store them to the nodes where GetWorldTransform() reads
+    // them. The nodes are not recalculated on access during this, as no other node reads its world transform meanwhile
+    pendingTransformUpdate_.store(false, std::memory_order_relaxed);
+    const auto updateNodes = [this](unsigned levelIndex, unsigned begin, unsigned end)
+    {
+        TransformUpdateLevel& level = transformLevels_[levelIndex];
+        if (levelIndex == 0)
+        {
+            for (unsigned i = begin; i < end; ++i)
+                level.nodes_[i]->SetBatchedWorldTransform(level.worldTransforms_[i], level.worldRotations_[i]);
+        }
+        else
+        {
+            const TransformUpdateLevel& parents = transformLevels_[levelIndex - 1];
+            for (unsigned i = begin; i < end; ++i)
+            {
+                Node* node = level.nodes_[i];
+                const unsigned parentIndex = level.parentIndices_[i];
+                level.worldTransforms_[i] = parents.worldTransforms_[parentIndex] * node->GetTransform();
+                level.worldRotations_[i] = parents.worldRotations_[parentIndex] * node->GetRotation();
+                node->SetBatchedWorldTransform(level.worldTransforms_[i], level.worldRotations_[i]);
+            }
+        }
+    };
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    for (unsigned i = 0; i < numLevels; ++i)
+    {
+        TransformUpdateLevel& level = transformLevels_[i];
+        const unsigned numNodes = level.nodes_.size();
+        level.worldTransforms_.resize(numNodes);
+        level.worldRotations_.resize(numNodes);
+
+        if (numNodes > TRANSFORM_UPDATE_BATCH_SIZE && queue && queue->GetNumThreads())
+        {
+            queue->ParallelFor(numNodes, TRANSFORM_UPDATE_BATCH_SIZE,
+                [&](unsigned begin, unsigned end, unsigned) { updateNodes(i, begin, end); });
+        }
+        else
+            updateNodes(i, 0, numNodes);
+    }
+
+    // Listeners may have marked more nodes dirty meanwhile, which stay queued for the next update
+    pendingTransformUpdate_ = !dirtyTransformNodes_.empty();
+
+    // The previous level is needed until the next level is done, so clear only at the end
+    for (unsigned i = 0; i < numLevels; ++i)
+    {
+        transformLevels_[i].nodes_.clear();
+        transformLevels_[i].parentIndices_.clear();
+    }
+}
+
 unsigned Scene::GetFreeNodeID(CreateMode mode)
 {
     if (mode == REPLICATED)
@@ -1054,10 +1221,23 @@ void Scene::NodeRemoved(Node* node)
     {
         replicatedNodes_.erase(id);
         MarkReplicationDirty(node);
+        // Let network interest management see the removal on the next network update
+        MarkNetworkUpdate(node);
     }
     else
         localNodes_.erase(id);
 
+    // Remove node from the batched transform update
+    const unsigned transformUpdateIndex = node->GetTransformUpdateIndex();
+    if (transformUpdateIndex != M_MAX_UNSIGNED)
+    {
+        Node* lastNode = dirtyTransformNodes_.back();
+        dirtyTransformNodes_[transformUpdateIndex] = lastNode;
+        lastNode->SetTransformUpdateIndex(transformUpdateIndex);
+        dirtyTransformNodes_.pop_back();
+        node->SetTransformUpdateIndex(M_MAX_UNSIGNED);
+    }
+
     node->ResetScene();
 
     // Remove node from tag cache
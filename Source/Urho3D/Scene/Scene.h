@@ -87,6 +87,19 @@ struct AsyncProgress
     unsigned totalNodes_;
 };
 
+/// Dirty nodes of one hierarchy level in the batched world transform update, with the calculated world transforms in contiguous arrays.
+struct TransformUpdateLevel
+{
+    /// Nodes.
+    ea::vector<Node*> nodes_;
+    /// Index of the parent of each node in the previous level. Unused in the first level, where the parents are up to date.
+    ea::vector<unsigned> parentIndices_;
+    /// World transforms.
+    ea::vector<Matrix3x4> worldTransforms_;
+    /// World rotations.
+    ea::vector<Quaternion> worldRotations_;
+};
+
 /// Root scene node, represents the whole scene.
 class URHO3D_API Scene : public Node
 {
@@ -176,6 +189,8 @@ public:
     void SetSnapThreshold(float threshold);
     /// Set maximum milliseconds per frame to spend on async scene loading.
     void SetAsyncLoadingMs(int ms);
+    /// Enable or disable batched world transform update. When enabled, marking a node dirty only queues it. The world transforms of the queued hierarchies are recalculated and their listeners notified once per frame level by level, in worker threads for large levels. Until then the world transforms are recalculated along the parent chain on access.
+    void SetBatchedTransformUpdate(bool enable);
     /// Add a required package file for networking. To be called on the server.
     void AddRequiredPackageFile(PackageFile* package);
     /// Clear required package files.
@@ -227,6 +242,11 @@ public:
     /// Return maximum milliseconds per frame to spend on async loading.
     int GetAsyncLoadingMs() const { return asyncLoadingMs_; }
 
+    /// Return whether batched world transform update is enabled.
+    bool GetBatchedTransformUpdate() const { return batchedTransformUpdate_; }
+    /// Return pending batched transform update flag for the nodes, or null if batched world transform update is disabled.
+    const std::atomic<bool>* GetPendingTransformUpdate() const { return batchedTransformUpdate_ ? &pendingTransformUpdate_ : nullptr; }
+
     /// Return required package files.
     const ea::vector<SharedPtr<PackageFile> >& GetRequiredPackageFiles() const { return requiredPackageFiles_; }
 
@@ -241,6 +261,10 @@ public:
     void EndThreadedUpdate();
     /// Add a component to the delayed dirty notify queue. Is thread-safe.
     void DelayedMarkedDirty(Component* component);
+    /// Add a node that was marked dirty to the batched transform update. Called by Node. Is thread-safe.
+    void MarkTransformDirty(Node* node);
+    /// Recalculate world transforms and notify listeners of all queued hierarchies. Called at the end of the scene update and by Octree before updating drawables when batched transform update is enabled.
+    void UpdateTransforms();
 
     /// Return threaded update flag.
     bool IsThreadedUpdate() const { return threadedUpdate_; }
@@ -275,6 +299,8 @@ public:
     void CleanupConnection(Connection* connection);
     /// Mark a node for attribute check on the next network update.
     void MarkNetworkUpdate(Node* node);
+    /// Return IDs of the nodes marked for the next network update. Includes the IDs of replicated nodes removed since the last update.
+    const ea::hash_set<unsigned>& GetNetworkUpdateNodes() const { return networkUpdateNodes_; }
     /// Mark a component for attribute check on the next network update.
     void MarkNetworkUpdate(Component* component);
     /// Mark a node dirty in scene replication states. The node does not need to have own replication state yet.
@@ -293,6 +319,8 @@ private:
     void FinishLoading(Deserializer* source);
     /// Finish saving. Sets the scene filename and checksum.
     void FinishSaving(Serializer* dest) const;
+    /// Add a node to the batched transform update queue unless already queued.
+    void QueueTransformUpdate(Node* node);
     /// Preload resources from a binary scene or object prefab file.
     void PreloadResources(File* file, bool isSceneFile);
     /// Preload resources from an XML scene or object prefab file.
@@ -337,6 +365,10 @@ private:
     ea::hash_set<unsigned> networkUpdateComponents_;
     /// Delayed dirty notification queue for components.
     ea::vector<Component*> delayedDirtyComponents_;
+    /// Nodes marked dirty since the last batched transform update. Nodes store their index and are removed when they leave the scene.
+    ea::vector<Node*> dirtyTransformNodes_;
+    /// Nodes of the queued hierarchies and their world transforms by hierarchy level, parents before children. Reused to avoid allocations.
+    ea::vector<TransformUpdateLevel> transformLevels_;
     /// Mutex for the delayed dirty notification queue.
     Mutex sceneMutex_;
     /// Preallocated event data map for smoothing update events.
@@ -367,6 +399,10 @@ private:
     bool asyncLoading_;
     /// Threaded update flag.
     bool threadedUpdate_;
+    /// Batched world transform update flag.
+    bool batchedTransformUpdate_{};
+    /// Pending batched transform update flag. Nodes of the scene recalculate their world transforms on access while it is set.
+    std::atomic<bool> pendingTransformUpdate_{};
 };
 
 /// Register Scene library objects.
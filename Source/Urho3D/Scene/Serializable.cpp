@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../IO/Archive.h"
 #include "../IO/ArchiveSerialization.h"
+#include "../IO/BitStream.h"
 #include "../IO/Deserializer.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
@@ -46,6 +47,384 @@ namespace Urho3D
 {
 
 static const unsigned MAX_STACK_ATTRIBUTE_COUNT = 128;
+static const unsigned MAX_QUANTIZE_BITS = 24;
+static const unsigned DEFAULT_GRID_QUANTIZE_BITS = 16;
+/// Largest magnitude of grid cell indices. Zigzag encoded cell indices fit the 29 bits of a VLE, and the limit is exact as a float.
+static const int MAX_GRID_CELL = 1 << 27;
+/// Maximum magnitude of the three smallest components of a unit quaternion.
+static const float SMALLEST_THREE_RANGE = 0.70710678f;
+/// Delta compressed latest data value is written in full.
+static const unsigned char NETWORK_DELTA_FULL = 0;
+/// Delta compressed latest data value is equal to the baseline value. Larger modes are followed by differences to the baseline value of (mode - 1) bits each.
+static const unsigned char NETWORK_DELTA_UNCHANGED = 1;
+
+/// Return network quantization parameters of an attribute. Parameters are resolved from metadata once and cached in the attribute.
+static const NetworkQuantization& GetNetworkQuantization(const AttributeInfo& attr)
+{
+    NetworkQuantization& result = attr.networkQuantization_;
+    if (result.resolved_)
+        return result;
+
+    result = NetworkQuantization{};
+    result.resolved_ = true;
+    if (attr.metadata_.empty())
+        return result;
+
+    const Variant& bitsValue = attr.GetMetadata(AttributeMetadata::P_NET_QUANTIZE_BITS);
+    const unsigned bits = bitsValue.IsEmpty() ? 0 : Clamp(bitsValue.GetUInt(), 1u, MAX_QUANTIZE_BITS);
+
+    if (attr.type_ == VAR_QUATERNION)
+    {
+        if (bits)
+        {
+            result.mode_ = NQM_SMALLEST_THREE;
+            result.bits_ = bits;
+        }
+        return result;
+    }
+
+    const float cellSize = attr.GetMetadata(AttributeMetadata::P_NET_GRID_CELL_SIZE).GetFloat();
+    if (attr.type_ == VAR_VECTOR3 && cellSize > 0.0f)
+    {
+        result.mode_ = NQM_GRID;
+        result.bits_ = bits ? bits : DEFAULT_GRID_QUANTIZE_BITS;
+        result.min_ = cellSize;
+        return result;
+    }
+
+    const Variant& rangeValue = attr.GetMetadata(AttributeMetadata::P_NET_QUANTIZE_RANGE);
+    if (bits && rangeValue.GetType() == VAR_VECTOR2 && (attr.type_ == VAR_FLOAT || attr.type_ == VAR_VECTOR2 ||
+        attr.type_ == VAR_VECTOR3 || attr.type_ == VAR_VECTOR4))
+    {
+        const Vector2& range = rangeValue.GetVector2();
+        if (range.y_ > range.x_)
+        {
+            result.mode_ = NQM_RANGE;
+            result.bits_ = bits;
+            result.min_ = range.x_;
+            result.max_ = range.y_;
+        }
+    }
+
+    return result;
+}
+
+static unsigned GetNumQuantizedComponents(VariantType type)
+{
+    switch (type)
+    {
+    case VAR_VECTOR2:
+        return 2;
+    case VAR_VECTOR3:
+        return 3;
+    case VAR_VECTOR4:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+static unsigned QuantizeFloat(float value, float min, float max, unsigned bits)
+{
+    const auto maxValue = (unsigned)((1u << bits) - 1);
+    const float t = Clamp((value - min) / (max - min), 0.0f, 1.0f);
+    return (unsigned)RoundToInt(t * (float)maxValue);
+}
+
+static float DequantizeFloat(unsigned value, float min, float max, unsigned bits)
+{
+    const auto maxValue = (unsigned)((1u << bits) - 1);
+    return min + (max - min) * ((float)value / (float)maxValue);
+}
+
+/// Zigzag encode a signed value, so that small negative values stay small.
+static unsigned long long EncodeZigZag(long long value)
+{
+    return ((unsigned long long)value << 1u) ^ (unsigned long long)(value >> 63);
+}
+
+/// Decode a zigzag encoded value.
+static long long DecodeZigZag(unsigned long long value)
+{
+    return (long long)(value >> 1u) ^ (0ll - (long long)(value & 1u));
+}
+
+/// Return number of quantized components of an attribute. Omitted component index of smallest three quaternions is not counted.
+static unsigned GetNumQuantizedComponents(const AttributeInfo& attr, const NetworkQuantization& quantization)
+{
+    switch (quantization.mode_)
+    {
+    case NQM_SMALLEST_THREE:
+    case NQM_GRID:
+        return 3;
+    default:
+        return GetNumQuantizedComponents(attr.type_);
+    }
+}
+
+/// Return quantized component for delta compression. Grid position components combine the cell index and the offset within the cell.
+static long long GetDeltaComponent(const QuantizedNetworkValue& value, unsigned index, const NetworkQuantization& quantization)
+{
+    if (quantization.mode_ == NQM_GRID)
+        return value.cells_[index] * (1ll << quantization.bits_) + value.components_[index];
+    return value.components_[index];
+}
+
+/// Set quantized component from delta compression. Grid cell indices out of range are clamped.
+static void SetDeltaComponent(QuantizedNetworkValue& value, unsigned index, long long component, const NetworkQuantization& quantization)
+{
+    if (quantization.mode_ == NQM_GRID)
+    {
+        const long long cellRange = 1ll << quantization.bits_;
+        const long long offset = component & (cellRange - 1);
+        value.cells_[index] = (int)Clamp((component - offset) / cellRange, (long long)-MAX_GRID_CELL, (long long)MAX_GRID_CELL);
+        value.components_[index] = (unsigned)offset;
+    }
+    else
+        value.components_[index] = (unsigned)component;
+}
+
+/// Quantize network attribute value with quantization metadata.
+static QuantizedNetworkValue QuantizeNetworkValue(const Variant& value, const NetworkQuantization& quantization,
+    unsigned numComponents)
+{
+    QuantizedNetworkValue result;
+    switch (quantization.mode_)
+    {
+    case NQM_SMALLEST_THREE:
+    {
+        const Quaternion norm = value.GetQuaternion().Normalized();
+        const float components[4] = { norm.w_, norm.x_, norm.y_, norm.z_ };
+
+        // Omit the largest component, it is reconstructed from the others. Its sign is made positive, as q and -q are the same rotation
+        unsigned largest = 0;
+        for (unsigned i = 1; i < 4; ++i)
+        {
+            if (Abs(components[i]) > Abs(components[largest]))
+                largest = i;
+        }
+        const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+        unsigned index = 0;
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            if (i != largest)
+                result.components_[index++] = QuantizeFloat(components[i] * sign, -SMALLEST_THREE_RANGE, SMALLEST_THREE_RANGE, quantization.bits_);
+        }
+        result.components_[3] = largest;
+        break;
+    }
+
+    case NQM_GRID:
+    {
+        const float cellSize = quantization.min_;
+        const float* components = value.GetVector3().Data();
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            // Positions outside the range of cell indices are clamped to the outermost cells
+            const auto cell = (int)Clamp(floorf(components[i] / cellSize), (float)-MAX_GRID_CELL, (float)MAX_GRID_CELL);
+            const float offset = components[i] - (float)cell * cellSize;
+            result.cells_[i] = cell;
+            result.components_[i] = QuantizeFloat(offset, 0.0f, cellSize, quantization.bits_);
+        }
+        break;
+    }
+
+    default:
+    {
+        const Vector4 components = value.GetType() == VAR_FLOAT ? Vector4(value.GetFloat(), 0.0f, 0.0f, 0.0f) :
+            value.GetType() == VAR_VECTOR2 ? Vector4(value.GetVector2().x_, value.GetVector2().y_, 0.0f, 0.0f) :
+            value.GetType() == VAR_VECTOR3 ? Vector4(value.GetVector3(), 0.0f) : value.GetVector4();
+        for (unsigned i = 0; i < numComponents; ++i)
+            result.components_[i] = QuantizeFloat(components.Data()[i], quantization.min_, quantization.max_, quantization.bits_);
+        break;
+    }
+    }
+    return result;
+}
+
+/// Return network attribute value from quantized value.
+static Variant DequantizeNetworkValue(const QuantizedNetworkValue& value, const AttributeInfo& attr,
+    const NetworkQuantization& quantization)
+{
+    switch (quantization.mode_)
+    {
+    case NQM_SMALLEST_THREE:
+    {
+        float components[4];
+        float sumSquares = 0.0f;
+
+        const unsigned largest = value.components_[3] & 3u;
+        unsigned index = 0;
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            if (i != largest)
+            {
+                components[i] = DequantizeFloat(value.components_[index++], -SMALLEST_THREE_RANGE, SMALLEST_THREE_RANGE, quantization.bits_);
+                sumSquares += components[i] * components[i];
+            }
+        }
+        components[largest] = sqrtf(Max(1.0f - sumSquares, 0.0f));
+
+        return Quaternion(components[0], components[1], components[2], components[3]).Normalized();
+    }
+
+    case NQM_GRID:
+    {
+        const float cellSize = quantization.min_;
+        float components[3];
+        for (unsigned i = 0; i < 3; ++i)
+            components[i] = (float)value.cells_[i] * cellSize + DequantizeFloat(value.components_[i], 0.0f, cellSize, quantization.bits_);
+        return Vector3(components);
+    }
+
+    default:
+    {
+        float components[4]{};
+        for (unsigned i = 0; i < GetNumQuantizedComponents(attr.type_); ++i)
+            components[i] = DequantizeFloat(value.components_[i], quantization.min_, quantization.max_, quantization.bits_);
+        switch (attr.type_)
+        {
+        case VAR_FLOAT:
+            return components[0];
+        case VAR_VECTOR2:
+            return Vector2(components);
+        case VAR_VECTOR3:
+            return Vector3(components);
+        default:
+            return Vector4(components);
+        }
+    }
+    }
+}
+
+/// Write quantized value in full.
+static void WriteQuantizedValue(Serializer& dest, const QuantizedNetworkValue& value, const NetworkQuantization& quantization,
+    unsigned numComponents)
+{
+    // Grid positions write the cell indices separately and the offsets within the cells as bits
+    if (quantization.mode_ == NQM_GRID)
+    {
+        // Cell indices are zigzag encoded so that small negative indices stay small. They are within MAX_GRID_CELL, so the
+        // encoded value fits a VLE
+        for (unsigned i = 0; i < 3; ++i)
+            dest.WriteVLE((unsigned)EncodeZigZag(value.cells_[i]));
+    }
+
+    BitWriter writer(dest);
+    if (quantization.mode_ == NQM_SMALLEST_THREE)
+        writer.WriteBits(value.components_[3], 2);
+    for (unsigned i = 0; i < numComponents; ++i)
+        writer.WriteBits(value.components_[i], quantization.bits_);
+}
+
+/// Read quantized value written by WriteQuantizedValue.
+static QuantizedNetworkValue ReadQuantizedValue(Deserializer& source, const NetworkQuantization& quantization,
+    unsigned numComponents)
+{
+    QuantizedNetworkValue result;
+    if (quantization.mode_ == NQM_GRID)
+    {
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            const long long cell = DecodeZigZag(source.ReadVLE());
+            result.cells_[i] = (int)Clamp(cell, (long long)-MAX_GRID_CELL, (long long)MAX_GRID_CELL);
+        }
+    }
+
+    BitReader reader(source);
+    if (quantization.mode_ == NQM_SMALLEST_THREE)
+        result.components_[3] = reader.ReadBits(2);
+    for (unsigned i = 0; i < numComponents; ++i)
+        result.components_[i] = reader.ReadBits(quantization.bits_);
+    return result;
+}
+
+/// Write quantized value as difference to a baseline value. Differences that need as many bits as the value itself are written in full.
+static void WriteQuantizedDelta(Serializer& dest, const QuantizedNetworkValue& value, const QuantizedNetworkValue& baselineValue,
+    const NetworkQuantization& quantization, unsigned numComponents)
+{
+    // Differences of smallest three quaternions are meaningful only if the same component is omitted
+    if (quantization.mode_ != NQM_SMALLEST_THREE || value.components_[3] == baselineValue.components_[3])
+    {
+        unsigned long long differences[4];
+        unsigned long long combined = 0;
+        for (unsigned i = 0; i < numComponents; ++i)
+        {
+            differences[i] = EncodeZigZag(GetDeltaComponent(value, i, quantization) - GetDeltaComponent(baselineValue, i, quantization));
+            combined |= differences[i];
+        }
+
+        if (!combined)
+        {
+            dest.WriteUByte(NETWORK_DELTA_UNCHANGED);
+            return;
+        }
+
+        unsigned numBits = 0;
+        while (numBits < 64 && (combined >> numBits))
+            ++numBits;
+
+        if (numBits < quantization.bits_)
+        {
+            dest.WriteUByte((unsigned char)(NETWORK_DELTA_UNCHANGED + numBits));
+            BitWriter writer(dest);
+            for (unsigned i = 0; i < numComponents; ++i)
+                writer.WriteBits((unsigned)differences[i], numBits);
+            return;
+        }
+    }
+
+    dest.WriteUByte(NETWORK_DELTA_FULL);
+    WriteQuantizedValue(dest, value, quantization, numComponents);
+}
+
+/// Read quantized value written by WriteQuantizedDelta.
+static QuantizedNetworkValue ReadQuantizedDelta(Deserializer& source, const QuantizedNetworkValue& baselineValue,
+    const NetworkQuantization& quantization, unsigned numComponents)
+{
+    const unsigned char mode = source.ReadUByte();
+    if (mode == NETWORK_DELTA_FULL)
+        return ReadQuantizedValue(source, quantization, numComponents);
+
+    QuantizedNetworkValue result = baselineValue;
+    const unsigned numBits = Min((unsigned)(mode - NETWORK_DELTA_UNCHANGED), MAX_QUANTIZE_BITS);
+    if (numBits)
+    {
+        BitReader reader(source);
+        for (unsigned i = 0; i < numComponents; ++i)
+        {
+            const long long component = GetDeltaComponent(baselineValue, i, quantization) + DecodeZigZag(reader.ReadBits(numBits));
+            SetDeltaComponent(result, i, component, quantization);
+        }
+    }
+    return result;
+}
+
+/// Write network attribute value, quantized if the attribute has quantization metadata.
+static void WriteNetworkValue(Serializer& dest, const AttributeInfo& attr, const Variant& value)
+{
+    const NetworkQuantization& quantization = GetNetworkQuantization(attr);
+    if (quantization.mode_ == NQM_NONE)
+    {
+        dest.WriteVariantData(value);
+        return;
+    }
+
+    const unsigned numComponents = GetNumQuantizedComponents(attr, quantization);
+    WriteQuantizedValue(dest, QuantizeNetworkValue(value, quantization, numComponents), quantization, numComponents);
+}
+
+/// Read network attribute value written by WriteNetworkValue.
+static Variant ReadNetworkValue(Deserializer& source, const AttributeInfo& attr)
+{
+    const NetworkQuantization& quantization = GetNetworkQuantization(attr);
+    if (quantization.mode_ == NQM_NONE)
+        return source.ReadVariant(attr.type_);
+
+    const unsigned numComponents = GetNumQuantizedComponents(attr, quantization);
+    return DequantizeNetworkValue(ReadQuantizedValue(source, quantization, numComponents), attr, quantization);
+}
 
 static unsigned RemapAttributeIndex(const ea::vector<AttributeInfo>* attributes, const AttributeInfo& netAttr, unsigned netAttrIndex)
 {
@@ -1031,7 +1410,7 @@ void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeS
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteNetworkValue(dest, attributes->at(i), networkState_->currentValues_[i]);
     }
 }
 
@@ -1057,11 +1436,11 @@ void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attribute
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteNetworkValue(dest, attributes->at(i), networkState_->currentValues_[i]);
     }
 }
 
-void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp)
+void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp, NetworkBaseline* baseline)
 {
     if (!networkState_)
     {
@@ -1074,13 +1453,66 @@ void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeSta
         return;
 
     unsigned numAttributes = attributes->size();
+    unsigned numQuantized = 0;
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        const AttributeInfo& attr = attributes->at(i);
+        if ((attr.mode_ & AM_LATESTDATA) && GetNetworkQuantization(attr).mode_ != NQM_NONE)
+            ++numQuantized;
+    }
+
+    // Only quantized values are delta compressed, as they compare equal on both ends
+    unsigned sequence = 0;
+    unsigned char baselineAge = 0;
+    QuantizedNetworkValue* values = nullptr;
+    const QuantizedNetworkValue* baselineValues = nullptr;
+    if (baseline && numQuantized)
+    {
+        sequence = baseline->hasSequence_ ? baseline->sequence_ + 1 : 0;
+        values = baseline->StoreValues(sequence, numQuantized);
+        baseline->sequence_ = sequence;
+        baseline->hasSequence_ = true;
+
+        // Compare against the newest update acknowledged by the connection, if it is recent enough to be remembered on both ends
+        if (baseline->hasAcked_ && sequence - baseline->ackedSequence_ < NETWORK_BASELINE_WINDOW)
+        {
+            baselineValues = baseline->GetValues(baseline->ackedSequence_, numQuantized);
+            if (baselineValues)
+                baselineAge = (unsigned char)(sequence - baseline->ackedSequence_);
+        }
+    }
 
     dest.WriteUByte(timeStamp);
+    if (numQuantized)
+    {
+        dest.WriteUByte((unsigned char)sequence);
+        dest.WriteUByte(baselineAge);
+    }
 
+    unsigned quantizedIndex = 0;
     for (unsigned i = 0; i < numAttributes; ++i)
     {
-        if (attributes->at(i).mode_ & AM_LATESTDATA)
+        const AttributeInfo& attr = attributes->at(i);
+        if (!(attr.mode_ & AM_LATESTDATA))
+            continue;
+
+        const NetworkQuantization& quantization = GetNetworkQuantization(attr);
+        if (quantization.mode_ == NQM_NONE)
+        {
             dest.WriteVariantData(networkState_->currentValues_[i]);
+            continue;
+        }
+
+        const unsigned numComponents = GetNumQuantizedComponents(attr, quantization);
+        const QuantizedNetworkValue value = QuantizeNetworkValue(networkState_->currentValues_[i], quantization, numComponents);
+        if (values)
+            values[quantizedIndex] = value;
+
+        if (baselineValues)
+            WriteQuantizedDelta(dest, value, baselineValues[quantizedIndex], quantization, numComponents);
+        else
+            WriteQuantizedValue(dest, value, quantization, numComponents);
+        ++quantizedIndex;
     }
 }
 
@@ -1105,7 +1537,7 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
             const AttributeInfo& attr = attributes->at(i);
             if (!(interceptMask & (1ULL << i)))
             {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
+                OnSetAttribute(attr, ReadNetworkValue(source, attr));
                 changed = true;
             }
             else
@@ -1117,7 +1549,7 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
                 eventData[P_TIMESTAMP] = (unsigned)timeStamp;
                 eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
                 eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
+                eventData[P_VALUE] = ReadNetworkValue(source, attr);
                 SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
             }
         }
@@ -1126,40 +1558,95 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
     return changed;
 }
 
-bool Serializable::ReadLatestDataUpdate(Deserializer& source)
+bool Serializable::ReadLatestDataUpdate(Deserializer& source, NetworkBaseline* baseline)
 {
     const ea::vector<AttributeInfo>* attributes = GetNetworkAttributes();
     if (!attributes)
         return false;
 
     unsigned numAttributes = attributes->size();
+    unsigned numQuantized = 0;
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        const AttributeInfo& attr = attributes->at(i);
+        if ((attr.mode_ & AM_LATESTDATA) && GetNetworkQuantization(attr).mode_ != NQM_NONE)
+            ++numQuantized;
+    }
+
     bool changed = false;
 
     unsigned long long interceptMask = networkState_ ? networkState_->interceptMask_ : 0;
     unsigned char timeStamp = source.ReadUByte();
+    const unsigned char sequence = numQuantized ? source.ReadUByte() : 0;
+    const unsigned char baselineAge = numQuantized ? source.ReadUByte() : 0;
+    const auto baselineSequence = (unsigned char)(sequence - baselineAge);
+
+    // Updates are sent unordered. Updates older than the newest applied one are dropped, so that they do not replace newer values
+    // or the stored baselines. The server normally receives their acknowledgement after the newer one and ignores it. Otherwise the
+    // updates compared against them are dropped as well, until a newer acknowledgement arrives
+    if (baseline && numQuantized && baseline->hasSequence_ && !NetworkBaseline::IsNewerSequence(sequence, baseline->sequence_))
+        return false;
+
+    if (baselineAge && (!baseline || baselineAge >= NETWORK_BASELINE_WINDOW || !baseline->GetValues(baselineSequence, numQuantized)))
+    {
+        URHO3D_LOGWARNING("Latest data update received without its baseline");
+        return false;
+    }
 
+    // The server compares only against acknowledged updates, and the acknowledged update only gets newer, so older updates are no
+    // longer needed
+    QuantizedNetworkValue* values = nullptr;
+    const QuantizedNetworkValue* baselineValues = nullptr;
+    if (baseline && numQuantized)
+    {
+        if (baselineAge)
+            baseline->DiscardOlder(baselineSequence);
+        values = baseline->StoreValues(sequence, numQuantized);
+        if (baselineAge)
+            baselineValues = baseline->GetValues(baselineSequence, numQuantized);
+        baseline->sequence_ = sequence;
+        baseline->hasSequence_ = true;
+    }
+
+    unsigned quantizedIndex = 0;
     for (unsigned i = 0; i < numAttributes && !source.IsEof(); ++i)
     {
         const AttributeInfo& attr = attributes->at(i);
-        if (attr.mode_ & AM_LATESTDATA)
+        if (!(attr.mode_ & AM_LATESTDATA))
+            continue;
+
+        Variant value;
+        const NetworkQuantization& quantization = GetNetworkQuantization(attr);
+        if (quantization.mode_ == NQM_NONE)
+            value = source.ReadVariant(attr.type_);
+        else
         {
-            if (!(interceptMask & (1ULL << i)))
-            {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
-                changed = true;
-            }
-            else
-            {
-                using namespace InterceptNetworkUpdate;
+            const unsigned numComponents = GetNumQuantizedComponents(attr, quantization);
+            const QuantizedNetworkValue quantized = baselineValues ?
+                ReadQuantizedDelta(source, baselineValues[quantizedIndex], quantization, numComponents) :
+                ReadQuantizedValue(source, quantization, numComponents);
+            if (values)
+                values[quantizedIndex] = quantized;
+            value = DequantizeNetworkValue(quantized, attr, quantization);
+            ++quantizedIndex;
+        }
 
-                VariantMap& eventData = GetEventDataMap();
-                eventData[P_SERIALIZABLE] = this;
-                eventData[P_TIMESTAMP] = (unsigned)timeStamp;
-                eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
-                eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
-                SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
-            }
+        if (!(interceptMask & (1ULL << i)))
+        {
+            OnSetAttribute(attr, value);
+            changed = true;
+        }
+        else
+        {
+            using namespace InterceptNetworkUpdate;
+
+            VariantMap& eventData = GetEventDataMap();
+            eventData[P_SERIALIZABLE] = this;
+            eventData[P_TIMESTAMP] = (unsigned)timeStamp;
+            eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
+            eventData[P_NAME] = attr.name_;
+            eventData[P_VALUE] = value;
+            SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
         }
     }
 
@@ -39,6 +39,7 @@ class XMLElement;
 class JSONValue;
 
 struct DirtyBits;
+struct NetworkBaseline;
 struct NetworkState;
 struct ReplicationState;
 
@@ -121,12 +122,12 @@ public:
     void WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeStamp);
     /// Write a delta network update according to dirty attribute bits.
     void WriteDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp);
-    /// Write a latest data network update.
-    void WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp);
+    /// Write a latest data network update. With a baseline, quantized attributes are delta compressed against the newest update acknowledged by the connection, and the update is remembered as a future baseline.
+    void WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp, NetworkBaseline* baseline = nullptr);
     /// Read and apply a network delta update. Return true if attributes were changed.
     bool ReadDeltaUpdate(Deserializer& source);
-    /// Read and apply a network latest data update. Return true if attributes were changed.
-    bool ReadLatestDataUpdate(Deserializer& source);
+    /// Read and apply a network latest data update. Return true if attributes were changed. Delta compressed updates require the baseline of received updates. Updates older than the newest applied one are remembered but not applied.
+    bool ReadLatestDataUpdate(Deserializer& source, NetworkBaseline* baseline = nullptr);
 
     /// Return attribute value by index. Return empty if illegal index.
     Variant GetAttribute(unsigned index) const;
@@ -243,6 +244,13 @@ namespace AttributeMetadata
 {
     /// Names of vector struct elements. StringVector.
     static const StringHash P_VECTOR_STRUCT_ELEMENTS = "VectorStructElements";
+    /// Bits per component for quantized network replication of Float, Vector2, Vector3, Vector4 and Quaternion attributes. Int.
+    /// Quaternions are sent as the smallest three components. Other types also require P_NET_QUANTIZE_RANGE or P_NET_GRID_CELL_SIZE.
+    static const StringHash P_NET_QUANTIZE_BITS = "NetQuantizeBits";
+    /// Value range of each component of quantized Float and Vector attributes. Vector2 (min, max).
+    static const StringHash P_NET_QUANTIZE_RANGE = "NetQuantizeRange";
+    /// Grid cell size of Vector3 attributes sent as cell index and quantized offset within the cell. Float.
+    static const StringHash P_NET_GRID_CELL_SIZE = "NetGridCellSize";
 }
 
 // The following macros need to be used within a class member function such as ClassName::RegisterObject().
@@ -46,6 +46,8 @@ public:
     void ApplyAttributes() override;
     /// Return UI rendering batches.
     void GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, const IntRect& currentScissor) override;
+    /// Return whether rendering batches may be cached. Always false, as the batches include the selected item.
+    bool IsBatchCacheable() const override { return false; }
     /// React to the popup being shown.
     void OnShowPopup() override;
     /// React to the popup being hidden.
@@ -74,7 +74,7 @@ void Slider::RegisterObject(Context* context)
 void Slider::Update(float timeStep)
 {
     if (dragSlider_)
-        hovering_ = true;
+        SetHovering(true);
 
     // Propagate hover effect to the slider knob
     knob_->SetHovering(hovering_);
@@ -86,7 +86,7 @@ void Slider::OnHover(const IntVector2& position, const IntVector2& screenPositio
     BorderImage::OnHover(position, screenPosition, buttons, qualifiers, cursor);
 
     // Show hover effect if inside the slider knob
-    hovering_ = knob_->IsInside(screenPosition, true);
+    SetHovering(knob_->IsInside(screenPosition, true));
 
     // If not hovering on the knob, send it as page event
     if (!hovering_)
@@ -96,8 +96,8 @@ void Slider::OnHover(const IntVector2& position, const IntVector2& screenPositio
 void Slider::OnClickBegin(const IntVector2& position, const IntVector2& screenPosition, int button, int buttons, int qualifiers,
     Cursor* cursor)
 {
-    selected_ = true;
-    hovering_ = knob_->IsInside(screenPosition, true);
+    SetSelected(true);
+    SetHovering(knob_->IsInside(screenPosition, true));
     if (!hovering_ && button == MOUSEB_LEFT)
         Page(position, true);
 }
@@ -105,7 +105,7 @@ void Slider::OnClickBegin(const IntVector2& position, const IntVector2& screenPo
 void Slider::OnClickEnd(const IntVector2& position, const IntVector2& screenPosition, int button, int buttons, int qualifiers,
     Cursor* cursor, UIElement* beginElement)
 {
-    hovering_ = knob_->IsInside(screenPosition, true);
+    SetHovering(knob_->IsInside(screenPosition, true));
     if (!hovering_ && button == MOUSEB_LEFT)
         Page(position, false);
 }
@@ -154,7 +154,7 @@ void Slider::OnDragEnd(const IntVector2& position, const IntVector2& screenPosit
     if (dragButtons == MOUSEB_LEFT)
     {
         dragSlider_ = false;
-        selected_ = false;
+        SetSelected(false);
     }
 }
 
@@ -237,6 +237,12 @@ void Text::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexDat
     }
 }
 
+bool Text::IsBatchCacheable() const
+{
+    // The face is remembered when the char locations are updated, so there is no need to look it up from the font
+    return fontFace_ && !charLocationsDirty_ && !fontFace_->HasMutableGlyphs();
+}
+
 void Text::OnResize(const IntVector2& newSize, const IntVector2& delta)
 {
     if (wordWrap_)
@@ -248,6 +254,7 @@ void Text::OnResize(const IntVector2& newSize, const IntVector2& delta)
 void Text::OnIndentSet()
 {
     charLocationsDirty_ = true;
+    MarkBatchesDirty();
 }
 
 bool Text::SetFont(const ea::string& fontName, float size)
@@ -314,6 +321,7 @@ void Text::SetTextAlignment(HorizontalAlignment align)
     {
         textAlignment_ = align;
         charLocationsDirty_ = true;
+        MarkBatchesDirty();
     }
 }
 
@@ -373,42 +381,50 @@ void Text::SetSelection(unsigned start, unsigned length)
     selectionStart_ = start;
     selectionLength_ = length;
     ValidateSelection();
+    MarkBatchesDirty();
 }
 
 void Text::ClearSelection()
 {
     selectionStart_ = 0;
     selectionLength_ = 0;
+    MarkBatchesDirty();
 }
 
 void Text::SetTextEffect(TextEffect textEffect)
 {
     textEffect_ = textEffect;
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectShadowOffset(const IntVector2& offset)
 {
     shadowOffset_ = offset;
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectStrokeThickness(int thickness)
 {
     strokeThickness_ = Abs(thickness);
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectRoundStroke(bool roundStroke)
 {
     roundStroke_ = roundStroke;
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectColor(const Color& effectColor)
 {
     effectColor_ = effectColor;
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectDepthBias(float bias)
 {
     effectDepthBias_ = bias;
+    MarkBatchesDirty();
 }
 
 float Text::GetRowWidth(unsigned index) const
@@ -665,6 +681,7 @@ void Text::UpdateText(bool onResize)
         // No font, nothing to render
         pageGlyphLocations_.clear();
     }
+    MarkBatchesDirty();
 
     // If wordwrap is on, parent may need layout update to correct for overshoot in size. However, do not do this when the
     // update is a response to resize, as that could cause infinite recursion
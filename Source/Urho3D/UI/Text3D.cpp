@@ -755,6 +755,8 @@ void Text3D::CalculateFixedScreenSize(const FrameInfo& frame)
     customWorldTransform_ = Matrix3x4(worldPosition, frame.camera_->GetFaceCameraRotation(
         worldPosition, node_->GetWorldRotation(), faceCameraMode_, minAngle_), worldScale);
     worldBoundingBoxDirty_ = true;
+    // Queue an octree update so that the octree refreshes its copy of the bounds
+    MarkForUpdate();
 }
 
 }
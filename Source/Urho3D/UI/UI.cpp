@@ -22,6 +22,8 @@
 
 #include "../Precompiled.h"
 
+#include <EASTL/algorithm.h>
+
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
@@ -41,6 +43,7 @@
 #include "../IO/Log.h"
 #include "../Math/Matrix3x4.h"
 #include "../Resource/ResourceCache.h"
+#include "../Resource/ResourceEvents.h"
 #include "../UI/CheckBox.h"
 #include "../UI/Cursor.h"
 #include "../UI/DropDownList.h"
@@ -78,6 +81,15 @@ static MouseButton MakeTouchIDMask(int id)
     return static_cast<MouseButton>(1u << static_cast<MouseButtonFlags::Integer>(id)); // NOLINT(misc-misplaced-widening-cast)
 }
 
+/// Return a new identifier for UI batches and vertex data. Unique across UI subsystems, never zero.
+static unsigned GetNextBatchLayout()
+{
+    static unsigned lastBatchLayout = 0;
+    if (++lastBatchLayout == 0)
+        ++lastBatchLayout;
+    return lastBatchLayout;
+}
+
 StringHash VAR_ORIGIN("Origin");
 const StringHash VAR_ORIGINAL_PARENT("OriginalParent");
 const StringHash VAR_ORIGINAL_CHILD_INDEX("OriginalChildIndex");
@@ -144,6 +156,7 @@ UI::UI(Context* context) :
     SubscribeToEvent(E_TEXTINPUT, URHO3D_HANDLER(UI, HandleTextInput));
     SubscribeToEvent(E_DROPFILE, URHO3D_HANDLER(UI, HandleDropFile));
     SubscribeToEvent(E_FOCUSED, URHO3D_HANDLER(UI, HandleFocused));
+    SubscribeToEvent(E_RELOADFINISHED, URHO3D_HANDLER(UI, HandleReloadFinished));
 
     // Try to initialize right now, but skip if screen mode is not yet set
     Initialize();
@@ -209,6 +222,7 @@ void UI::SetFocusElement(UIElement* element, bool byKey)
     {
         UIElement* oldFocusElement = focusElement_;
         focusElement_.Reset();
+        oldFocusElement->MarkBatchesDirty();
 
         VariantMap& focusEventData = GetEventDataMap();
         focusEventData[Defocused::P_ELEMENT] = oldFocusElement;
@@ -219,6 +233,7 @@ void UI::SetFocusElement(UIElement* element, bool byKey)
     if (element && element->GetFocusMode() >= FM_FOCUSABLE)
     {
         focusElement_ = element;
+        element->MarkBatchesDirty();
 
         VariantMap& focusEventData = GetEventDataMap();
         focusEventData[Focused::P_ELEMENT] = element;
@@ -429,7 +444,8 @@ void UI::Update(float timeStep)
 
 void UI::RenderUpdate()
 {
-    assert(rootElement_ && rootModalElement_ && graphics_);
+    // Batches are only generated here, so graphics are not required and this also works in headless mode
+    assert(rootElement_ && rootModalElement_);
 
     URHO3D_PROFILE("GetUIBatches");
 
@@ -438,21 +454,49 @@ void UI::RenderUpdate()
     // If the OS cursor is visible, do not render the UI's own cursor
     bool osCursorVisible = GetSubsystem<Input>()->IsMouseVisible();
 
-    // Get rendering batches from the non-modal UI elements
-    batches_.clear();
-    vertexData_.clear();
     const IntVector2& rootSize = rootElement_->GetSize();
     const IntVector2& rootPos = rootElement_->GetPosition();
     // Note: the scissors operate on unscaled coordinates. Scissor scaling is only performed during render
     IntRect currentScissor = IntRect(rootPos.x_, rootPos.y_, rootPos.x_ + rootSize.x_, rootPos.y_ + rootSize.y_);
-    if (rootElement_->IsVisible())
-        GetBatches(batches_, vertexData_, rootElement_, currentScissor);
 
-    // Save the batch size of the non-modal batches for later use
-    nonModalBatchSize_ = batches_.size();
+    // If no element has changed since the batches were generated, keep them in place and only regenerate the cursor
+    if (batchCaching_ && rootElement_->IsVisible() && IsChildBatchRangeValid(rootElement_, currentScissor) &&
+        IsChildBatchRangeValid(rootModalElement_, currentScissor))
+    {
+        batches_.resize(treeBatchCount_);
+        vertexData_.resize(treeVertexCount_);
+        // The cursor batch may have been merged into the last batch
+        if (!batches_.empty())
+            batches_.back().vertexEnd_ = Min(batches_.back().vertexEnd_, treeVertexCount_);
+    }
+    else
+    {
+        if (batchCaching_)
+        {
+            // Keep the previous batches for copying the batches of unchanged elements from
+            batches_.swap(previousBatches_);
+            vertexData_.swap(previousVertexData_);
+            previousBatchLayout_ = batchLayout_;
+            batchLayout_ = GetNextBatchLayout();
+            reuseBatches_ = true;
+        }
+
+        // Get rendering batches from the non-modal UI elements
+        batches_.clear();
+        vertexData_.clear();
+        if (rootElement_->IsVisible())
+            GetBatches(batches_, vertexData_, rootElement_, currentScissor);
+
+        // Save the batch size of the non-modal batches for later use
+        nonModalBatchSize_ = batches_.size();
+
+        // Get rendering batches from the modal UI elements
+        GetBatches(batches_, vertexData_, rootModalElement_, currentScissor);
 
-    // Get rendering batches from the modal UI elements
-    GetBatches(batches_, vertexData_, rootModalElement_, currentScissor);
+        reuseBatches_ = false;
+        treeBatchCount_ = batches_.size();
+        treeVertexCount_ = vertexData_.size();
+    }
 
     // Get batches from the cursor (and its possible children) last to draw it on top of everything
     if (cursor_ && cursor_->IsVisible() && !osCursorVisible)
@@ -681,6 +725,7 @@ void UI::SetFontOversampling(int oversampling)
 void UI::SetScale(float scale)
 {
     uiScale_ = Max(scale, M_EPSILON);
+    MarkBatchCacheDirty();
     ResizeRootElement();
 }
 
@@ -1083,8 +1128,36 @@ void UI::Render(VertexBuffer* buffer, const ea::vector<UIBatch>& batches, unsign
 
 void UI::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, UIElement* element, IntRect currentScissor)
 {
-    // Set clipping scissor for child elements. No need to draw if zero size
+    // Set clipping scissor for child elements
     element->AdjustScissor(currentScissor);
+
+    if (!reuseBatches_)
+    {
+        GetChildBatches(batches, vertexData, element, currentScissor);
+        return;
+    }
+
+    // Skip the whole subtree if none of the children has changed since the previous frame
+    UIBatchRange& range = element->GetChildBatchRange();
+    if (range.layout_ == previousBatchLayout_ && range.scissor_ == currentScissor)
+    {
+        CopyPreviousBatches(batches, vertexData, element, range);
+        return;
+    }
+
+    range.layout_ = batchLayout_;
+    range.vertexStart_ = vertexData.size();
+    range.scissor_ = currentScissor;
+    GetChildBatches(batches, vertexData, element, currentScissor);
+    // The range stays invalid if a child was invalidated meanwhile, e.g. because it is hovered or cannot be cached
+    if (range.layout_ == batchLayout_)
+        range.vertexEnd_ = vertexData.size();
+}
+
+void UI::GetChildBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, UIElement* element,
+    const IntRect& currentScissor)
+{
+    // No need to draw if zero size
     if (currentScissor.left_ == currentScissor.right_ || currentScissor.top_ == currentScissor.bottom_)
         return;
 
@@ -1105,7 +1178,7 @@ void UI::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData,
             while (j != children.end() && (*j)->GetPriority() == currentPriority)
             {
                 if ((*j)->IsWithinScissor(currentScissor) && (*j) != cursor_)
-                    (*j)->GetBatches(batches, vertexData, currentScissor);
+                    GetElementBatches(batches, vertexData, *j, currentScissor);
                 ++j;
             }
             // Now recurse into the children
@@ -1125,7 +1198,7 @@ void UI::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData,
             if ((*i) != cursor_)
             {
                 if ((*i)->IsWithinScissor(currentScissor))
-                    (*i)->GetBatches(batches, vertexData, currentScissor);
+                    GetElementBatches(batches, vertexData, *i, currentScissor);
                 if ((*i)->IsVisible())
                     GetBatches(batches, vertexData, *i, currentScissor);
             }
@@ -1134,6 +1207,75 @@ void UI::GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData,
     }
 }
 
+void UI::GetElementBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, UIElement* element,
+    const IntRect& currentScissor)
+{
+    if (!reuseBatches_)
+    {
+        element->GetBatches(batches, vertexData, currentScissor);
+        return;
+    }
+
+    if (!element->IsBatchCacheable())
+    {
+        element->GetBatches(batches, vertexData, currentScissor);
+        // Keep the parents invalid so that the element is visited again next frame
+        element->MarkBatchesDirty();
+        return;
+    }
+
+    UIBatchRange& range = element->GetBatchRange();
+    if (range.layout_ == previousBatchLayout_ && range.scissor_ == currentScissor)
+    {
+        CopyPreviousBatches(batches, vertexData, element, range);
+        return;
+    }
+
+    // GetBatches() resets hovering, so a hovered element is regenerated next frame to catch the end of hovering
+    const bool hovering = element->IsHovering();
+    range.layout_ = batchLayout_;
+    range.vertexStart_ = vertexData.size();
+    range.scissor_ = currentScissor;
+    element->GetBatches(batches, vertexData, currentScissor);
+    if (range.layout_ == batchLayout_)
+        range.vertexEnd_ = vertexData.size();
+    if (hovering)
+        element->MarkBatchesDirty();
+}
+
+void UI::CopyPreviousBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, UIElement* element,
+    UIBatchRange& range)
+{
+    const auto vertexStart = static_cast<unsigned>(vertexData.size());
+    vertexData.insert(vertexData.end(), previousVertexData_.begin() + range.vertexStart_,
+        previousVertexData_.begin() + range.vertexEnd_);
+
+    // Batches are ordered by their vertex ranges, so find the first one ending past the range start
+    auto i = ea::upper_bound(previousBatches_.begin(), previousBatches_.end(), range.vertexStart_,
+        [](unsigned vertex, const UIBatch& batch) { return vertex < batch.vertexEnd_; });
+    for (; i != previousBatches_.end() && i->vertexStart_ < range.vertexEnd_; ++i)
+    {
+        // Batches may have been merged across elements, so clip them to the range
+        UIBatch batch = *i;
+        batch.element_ = element;
+        batch.vertexData_ = &vertexData;
+        batch.vertexStart_ = Max(i->vertexStart_, range.vertexStart_) - range.vertexStart_ + vertexStart;
+        batch.vertexEnd_ = Min(i->vertexEnd_, range.vertexEnd_) - range.vertexStart_ + vertexStart;
+        UIBatch::AddOrMerge(batch, batches);
+    }
+
+    range.layout_ = batchLayout_;
+    range.vertexStart_ = vertexStart;
+    range.vertexEnd_ = vertexData.size();
+}
+
+bool UI::IsChildBatchRangeValid(UIElement* element, IntRect currentScissor) const
+{
+    element->AdjustScissor(currentScissor);
+    const UIBatchRange& range = element->GetChildBatchRange();
+    return range.layout_ == batchLayout_ && range.scissor_ == currentScissor;
+}
+
 void UI::GetElementAt(UIElement*& result, UIElement* current, const IntVector2& position, bool enabledOnly)
 {
     if (!current)
@@ -1269,6 +1411,8 @@ void UI::ReleaseFontFaces()
 
     for (unsigned i = 0; i < fonts.size(); ++i)
         fonts[i]->ReleaseFaces();
+
+    MarkBatchCacheDirty();
 }
 
 void UI::ProcessHover(const IntVector2& windowCursorPos, MouseButtonFlags buttons, QualifierFlags qualifiers, Cursor* cursor)
@@ -2069,6 +2213,14 @@ void UI::HandleFocused(StringHash eventType, VariantMap& eventData)
     }
 }
 
+void UI::HandleReloadFinished(StringHash eventType, VariantMap& eventData)
+{
+    // Reloading a font releases its faces, whose textures cached text batches may refer to
+    Object* sender = GetEventSender();
+    if (sender && sender->IsInstanceOf<Font>())
+        MarkBatchCacheDirty();
+}
+
 void UI::HandleEndAllViewsRender(StringHash eventType, VariantMap& eventData)
 {
     if (texture_)
@@ -2211,6 +2363,21 @@ void UI::SetRenderTarget(Texture2D* texture, Color clearColor)
     }
 }
 
+void UI::SetBatchCaching(bool enable)
+{
+    if (enable != batchCaching_)
+    {
+        batchCaching_ = enable;
+        MarkBatchCacheDirty();
+    }
+}
+
+void UI::MarkBatchCacheDirty()
+{
+    // The cached batch ranges of all elements refer to the current identifier, so switching to a new one invalidates them
+    batchLayout_ = GetNextBatchLayout();
+}
+
 void UI::SetRoot(UIElement* root)
 {
     rootElement_ = root;
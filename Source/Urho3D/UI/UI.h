@@ -236,6 +236,13 @@ public:
     /// Return true when UI is set to render as part of SystemUI.
     bool GetRenderInSystemUI() const { return partOfSystemUI_; }
 
+    /// Set whether to cache rendering batches of unchanged elements between frames. Default false.
+    void SetBatchCaching(bool enable);
+    /// Return whether rendering batches of unchanged elements are cached between frames.
+    bool GetBatchCaching() const { return batchCaching_; }
+    /// Invalidate all cached rendering batches.
+    void MarkBatchCacheDirty();
+
     /// Data structure used to represent the drag data associated to a UIElement.
     struct DragData
     {
@@ -264,6 +271,14 @@ private:
     void Render(VertexBuffer* buffer, const ea::vector<UIBatch>& batches, unsigned batchStart, unsigned batchEnd);
     /// Generate batches from an UI element recursively. Skip the cursor element.
     void GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, UIElement* element, IntRect currentScissor);
+    /// Generate batches from the children of an UI element recursively, with the element's scissor already applied.
+    void GetChildBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, UIElement* element, const IntRect& currentScissor);
+    /// Generate batches of a single UI element, copying its batches from the previous frame if batch caching is enabled.
+    void GetElementBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, UIElement* element, const IntRect& currentScissor);
+    /// Copy cached batches and their vertex data from the previous frame and update the range to refer to the copy.
+    void CopyPreviousBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, UIElement* element, UIBatchRange& range);
+    /// Return whether the cached batches of an UI element's children are up to date in the current batches.
+    bool IsChildBatchRangeValid(UIElement* element, IntRect currentScissor) const;
     /// Return UI element at global screen coordinates. Return position converted to element's screen coordinates.
     UIElement* GetElementAt(const IntVector2& position, bool enabledOnly, IntVector2* elementScreenPosition);
     /// Return UI element at screen position recursively.
@@ -329,6 +344,8 @@ private:
     void HandleDropFile(StringHash eventType, VariantMap& eventData);
     /// Handle off-screen UI subsystems gaining focus.
     void HandleFocused(StringHash eventType, VariantMap& eventData);
+    /// Handle a resource being reloaded. Invalidates cached batches when a font is reloaded.
+    void HandleReloadFinished(StringHash eventType, VariantMap& eventData);
     /// Handle rendering to a texture.
     void HandleEndAllViewsRender(StringHash eventType, VariantMap& eventData);
     /// Remove drag data and return next iterator.
@@ -440,6 +457,22 @@ private:
     Color clearColor_ = Color::TRANSPARENT_BLACK;
     /// Flag indicating that UI should process input when mouse cursor hovers SystemUI elements.
     bool partOfSystemUI_ = false;
+    /// Flag for caching rendering batches of unchanged elements.
+    bool batchCaching_ = false;
+    /// Identifier of the current batches and vertex data. The cached batch ranges of the elements refer to it.
+    unsigned batchLayout_ = 0;
+    /// Identifier of the previous frame's batches and vertex data, which unchanged elements copy their batches from.
+    unsigned previousBatchLayout_ = 0;
+    /// Flag for generating batches with batch caching. Not set while generating the cursor batches.
+    bool reuseBatches_ = false;
+    /// Number of batches before the cursor batches.
+    unsigned treeBatchCount_ = 0;
+    /// Vertex data size before the cursor batches.
+    unsigned treeVertexCount_ = 0;
+    /// UI rendering batches of the previous frame.
+    ea::vector<UIBatch> previousBatches_;
+    /// UI rendering vertex data of the previous frame.
+    ea::vector<float> previousVertexData_;
 };
 
 /// Register UI library objects.
@@ -100,4 +100,20 @@ public:
     static Vector3 posAdjust;
 };
 
+/// Vertex range of cached %UI batches within the batches and vertex data of one frame.
+struct UIBatchRange
+{
+    /// Invalidate so that the batches are regenerated.
+    void Invalidate() { layout_ = 0; }
+
+    /// Identifier of the batches and vertex data the range refers to. Zero when invalid.
+    unsigned layout_{};
+    /// Vertex data start index.
+    unsigned vertexStart_{};
+    /// Vertex data end index.
+    unsigned vertexEnd_{};
+    /// Scissor the batches were generated with.
+    IntRect scissor_;
+};
+
 }
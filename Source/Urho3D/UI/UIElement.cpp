@@ -446,6 +446,7 @@ const IntVector2& UIElement::GetScreenPosition() const
 void UIElement::OnHover(const IntVector2& position, const IntVector2& screenPosition, int buttons, int qualifiers, Cursor* cursor)
 {
     hovering_ = true;
+    MarkBatchesDirty();
 }
 
 void UIElement::OnDragBegin(const IntVector2& position, const IntVector2& screenPosition, int buttons, int qualifiers,
@@ -842,6 +843,7 @@ void UIElement::SetClipBorder(const IntRect& rect)
     clipBorder_.top_ = Max(rect.top_, 0);
     clipBorder_.right_ = Max(rect.right_, 0);
     clipBorder_.bottom_ = Max(rect.bottom_, 0);
+    MarkBatchesDirty();
 }
 
 void UIElement::SetColor(const Color& color)
@@ -850,6 +852,7 @@ void UIElement::SetColor(const Color& color)
         cornerColor = color;
     colorGradient_ = false;
     derivedColorDirty_ = true;
+    MarkBatchesDirty();
 }
 
 void UIElement::SetColor(Corner corner, const Color& color)
@@ -857,6 +860,7 @@ void UIElement::SetColor(Corner corner, const Color& color)
     colors_[corner] = color;
     colorGradient_ = false;
     derivedColorDirty_ = true;
+    MarkBatchesDirty();
 
     for (unsigned i = 0; i < MAX_UIELEMENT_CORNERS; ++i)
     {
@@ -873,6 +877,7 @@ void UIElement::SetPriority(int priority)
     priority_ = priority;
     if (parent_)
         parent_->sortOrderDirty_ = true;
+    MarkBatchesDirty();
 }
 
 void UIElement::SetOpacity(float opacity)
@@ -894,12 +899,16 @@ void UIElement::SetBringToBack(bool enable)
 void UIElement::SetClipChildren(bool enable)
 {
     clipChildren_ = enable;
+    MarkBatchesDirty();
 }
 
 void UIElement::SetSortChildren(bool enable)
 {
     if (!sortChildren_ && enable)
+    {
         sortOrderDirty_ = true;
+        childBatchRange_.Invalidate();
+    }
 
     sortChildren_ = enable;
 }
@@ -913,11 +922,13 @@ void UIElement::SetEnabled(bool enable)
 {
     enabled_ = enable;
     enabledPrev_ = enable;
+    MarkBatchesDirty();
 }
 
 void UIElement::SetDeepEnabled(bool enable)
 {
     enabled_ = enable;
+    MarkBatchesDirty();
 
     for (auto i = children_.begin(); i != children_.end(); ++i)
         (*i)->SetDeepEnabled(enable);
@@ -926,6 +937,7 @@ void UIElement::SetDeepEnabled(bool enable)
 void UIElement::ResetDeepEnabled()
 {
     enabled_ = enabledPrev_;
+    MarkBatchesDirty();
 
     for (auto i = children_.begin(); i != children_.end(); ++i)
         (*i)->ResetDeepEnabled();
@@ -935,6 +947,7 @@ void UIElement::SetEnabledRecursive(bool enable)
 {
     enabled_ = enable;
     enabledPrev_ = enable;
+    MarkBatchesDirty();
 
     for (auto i = children_.begin(); i != children_.end(); ++i)
         (*i)->SetEnabledRecursive(enable);
@@ -976,7 +989,11 @@ void UIElement::SetFocus(bool enable)
 
 void UIElement::SetSelected(bool enable)
 {
-    selected_ = enable;
+    if (enable != selected_)
+    {
+        selected_ = enable;
+        MarkBatchesDirty();
+    }
 }
 
 void UIElement::SetVisible(bool enable)
@@ -989,6 +1006,8 @@ void UIElement::SetVisible(bool enable)
     if (enable != visible_)
     {
         visible_ = enable;
+        childBatchRange_.Invalidate();
+        MarkBatchesDirty();
 
         // Parent's layout may change as a result of visibility change
         if (parent_)
@@ -1475,6 +1494,8 @@ void UIElement::SetInternal(bool enable)
 void UIElement::SetTraversalMode(TraversalMode traversalMode)
 {
     traversalMode_ = traversalMode;
+    childBatchRange_.Invalidate();
+    MarkBatchesDirty();
 }
 
 void UIElement::SetElementEventSender(bool flag)
@@ -1833,7 +1854,11 @@ void UIElement::SetChildOffset(const IntVector2& offset)
 
 void UIElement::SetHovering(bool enable)
 {
-    hovering_ = enable;
+    if (enable != hovering_)
+    {
+        hovering_ = enable;
+        MarkBatchesDirty();
+    }
 }
 
 void UIElement::AdjustScissor(IntRect& currentScissor)
@@ -1874,6 +1899,15 @@ void UIElement::GetBatchesWithOffset(IntVector2& offset, ea::vector<UIBatch>& ba
     }
 }
 
+void UIElement::MarkBatchesDirty()
+{
+    batchRange_.Invalidate();
+
+    // The cursor is rendered after the rest of the UI, so its changes do not invalidate the batches of its parents
+    for (UIElement* element = this; element->parent_ && !element->IsInstanceOf<Cursor>(); element = element->parent_)
+        element->parent_->childBatchRange_.Invalidate();
+}
+
 UIElement* UIElement::GetElementEventSender() const
 {
     auto* element = const_cast<UIElement*>(this);
@@ -1956,11 +1990,18 @@ Animatable* UIElement::FindAttributeAnimationTarget(const ea::string& name, ea::
     }
 }
 
+void UIElement::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
+{
+    Animatable::OnSetAttribute(attr, src);
+    MarkBatchesDirty();
+}
+
 void UIElement::MarkDirty()
 {
     positionDirty_ = true;
     opacityDirty_ = true;
     derivedColorDirty_ = true;
+    MarkBatchesDirty();
 
     for (auto i = children_.begin(); i != children_.end(); ++i)
         (*i)->MarkDirty();
@@ -2246,6 +2287,8 @@ IntVector2 UIElement::GetLayoutChildPosition(UIElement* child)
 
 void UIElement::Detach()
 {
+    // The former parent's children batches no longer contain this element
+    MarkBatchesDirty();
     parent_ = nullptr;
     MarkDirty();
 }
@@ -150,6 +150,8 @@ public:
     virtual const IntVector2& GetScreenPosition() const;
     /// Return UI rendering batches.
     virtual void GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, const IntRect& currentScissor);
+    /// Return whether rendering batches may be cached between frames. Elements whose batches depend on state outside of themselves should return false.
+    virtual bool IsBatchCacheable() const { return true; }
     /// Return UI rendering batches for debug draw.
     virtual void GetDebugDrawBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, const IntRect& currentScissor);
     /// React to mouse hover.
@@ -632,6 +634,12 @@ public:
     void AdjustScissor(IntRect& currentScissor);
     /// Get UI rendering batches with a specified offset. Also recurse to child elements.
     void GetBatchesWithOffset(IntVector2& offset, ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, IntRect currentScissor);
+    /// Mark cached rendering batches of the element and of all its parents' children as needing regeneration.
+    void MarkBatchesDirty();
+    /// Return vertex range of the cached rendering batches of the element itself. Used internally.
+    UIBatchRange& GetBatchRange() { return batchRange_; }
+    /// Return vertex range of the cached rendering batches of the element's children. Used internally.
+    UIBatchRange& GetChildBatchRange() { return childBatchRange_; }
 
     /// Return color attribute. Uses just the top-left color.
     const Color& GetColorAttr() const { return colors_[0]; }
@@ -655,6 +663,8 @@ protected:
     void OnAttributeAnimationRemoved() override;
     /// Find target of an attribute animation from object hierarchy by name.
     Animatable* FindAttributeAnimationTarget(const ea::string& name, ea::string& outName) override;
+    /// Handle attribute write access.
+    void OnSetAttribute(const AttributeInfo& attr, const Variant& src) override;
     /// Mark screen position as needing an update.
     void MarkDirty();
     /// Remove child XML element by matching attribute name.
@@ -815,6 +825,10 @@ private:
     static XPathQuery styleXPathQuery_;
     /// Tag list.
     StringVector tags_;
+    /// Vertex range of the element's own rendering batches in the latest UI vertex data.
+    UIBatchRange batchRange_;
+    /// Vertex range of the rendering batches of the element's children in the latest UI vertex data.
+    UIBatchRange childBatchRange_;
 };
 
 template <class T> T* UIElement::CreateChild(const ea::string& name, unsigned index)
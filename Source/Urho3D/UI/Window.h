@@ -59,6 +59,8 @@ public:
 
     /// Return UI rendering batches.
     void GetBatches(ea::vector<UIBatch>& batches, ea::vector<float>& vertexData, const IntRect& currentScissor) override;
+    /// Return whether rendering batches may be cached. Modal windows draw the shade over the whole root element and are not cached.
+    bool IsBatchCacheable() const override { return !modal_; }
 
     /// React to mouse hover.
     void OnHover(const IntVector2& position, const IntVector2& screenPosition, int buttons, int qualifiers, Cursor* cursor) override;
@@ -304,6 +304,7 @@ void AnimatedSprite2D::UpdateSpineAnimation(float timeStep)
 
     sourceBatchesDirty_ = true;
     worldBoundingBoxDirty_ = true;
+    MarkForUpdate();
 }
 
 void AnimatedSprite2D::UpdateSourceBatchesSpine()
@@ -432,6 +433,7 @@ void AnimatedSprite2D::UpdateSpriterAnimation(float timeStep)
     spriterInstance_->Update(timeStep * speed_);
     sourceBatchesDirty_ = true;
     worldBoundingBoxDirty_ = true;
+    MarkForUpdate();
 }
 
 void AnimatedSprite2D::UpdateSourceBatchesSpriter()